@@ -0,0 +1,94 @@
+// JNI bindings for com.meridianmaps.AssetBundle
+
+#include <jni.h>
+
+#include <android/log.h>
+
+#include <memory>
+#include <string>
+
+#include "AssetBundle.h"
+
+using meridianmaps::AssetBundle;
+using meridianmaps::AssetBundleStats;
+
+namespace {
+
+constexpr const char* kTag = "AssetBundle";
+
+AssetBundle* bundleFrom(jlong handle) {
+  return reinterpret_cast<AssetBundle*>(handle);
+}
+
+std::string toStdString(JNIEnv* env, jstring value) {
+  if (!value) {
+    return std::string();
+  }
+  const char* chars = env->GetStringUTFChars(value, nullptr);
+  std::string result(chars);
+  env->ReleaseStringUTFChars(value, chars);
+  return result;
+}
+
+}  // namespace
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_AssetBundle_nativeOpen(JNIEnv* env, jclass, jstring path,
+                                                                     jobjectArray errorOut) {
+  std::string error;
+  std::unique_ptr<AssetBundle> bundle = AssetBundle::open(toStdString(env, path), &error);
+  if (!bundle) {
+    jstring message = env->NewStringUTF(error.c_str());
+    env->SetObjectArrayElement(errorOut, 0, message);
+    env->DeleteLocalRef(message);
+    return 0;
+  }
+  return reinterpret_cast<jlong>(bundle.release());
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_AssetBundle_nativeClose(JNIEnv*, jclass, jlong handle) {
+  delete bundleFrom(handle);
+}
+
+// Null when the URL is not in the bundle or its asset fails to inflate or verify
+JNIEXPORT jbyteArray JNICALL Java_com_meridianmaps_AssetBundle_nativeRead(JNIEnv* env, jclass, jlong handle,
+                                                                          jstring url) {
+  const AssetBundle* bundle = bundleFrom(handle);
+  const AssetBundle::Entry* entry = bundle->findUrl(toStdString(env, url));
+  if (!entry) {
+    return nullptr;
+  }
+  std::string bytes;
+  std::string error;
+  if (!bundle->read(*entry, &bytes, &error)) {
+    __android_log_print(ANDROID_LOG_WARN, kTag, "%s", error.c_str());
+    return nullptr;
+  }
+  jbyteArray result = env->NewByteArray(static_cast<jsize>(bytes.size()));
+  env->SetByteArrayRegion(result, 0, static_cast<jsize>(bytes.size()), reinterpret_cast<const jbyte*>(bytes.data()));
+  return result;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_AssetBundle_nativeContains(JNIEnv* env, jclass, jlong handle,
+                                                                            jstring url) {
+  return bundleFrom(handle)->findUrl(toStdString(env, url)) ? JNI_TRUE : JNI_FALSE;
+}
+
+// In AssetBundle.STATS_NAMES order
+JNIEXPORT jlongArray JNICALL Java_com_meridianmaps_AssetBundle_nativeStats(JNIEnv* env, jclass, jlong handle) {
+  const AssetBundle* bundle = bundleFrom(handle);
+  const AssetBundleStats stats = bundle->stats();
+  const jlong counters[] = {
+      static_cast<jlong>(bundle->entries().size()),
+      static_cast<jlong>(bundle->byteSize()),
+      static_cast<jlong>(stats.served),
+      static_cast<jlong>(stats.bytesServed),
+      static_cast<jlong>(stats.failures),
+  };
+  jlongArray result = env->NewLongArray(5);
+  env->SetLongArrayRegion(result, 0, 5, counters);
+  return result;
+}
+
+}  // extern "C"
@@ -0,0 +1,118 @@
+// JNI bindings for com.meridianmaps.AssetCache
+
+#include <jni.h>
+
+#include <android/log.h>
+
+#include <memory>
+#include <string>
+
+#include "AssetCache.h"
+
+using meridianmaps::AssetCache;
+using meridianmaps::AssetCacheStats;
+
+namespace {
+
+constexpr const char* kTag = "AssetCache";
+
+AssetCache* cacheFrom(jlong handle) {
+  return reinterpret_cast<AssetCache*>(handle);
+}
+
+std::string toStdString(JNIEnv* env, jstring value) {
+  if (!value) {
+    return std::string();
+  }
+  const char* chars = env->GetStringUTFChars(value, nullptr);
+  std::string result(chars);
+  env->ReleaseStringUTFChars(value, chars);
+  return result;
+}
+
+}  // namespace
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_AssetCache_nativeCreate(JNIEnv* env, jclass, jstring directory,
+                                                                      jlong maxBytes, jobjectArray errorOut) {
+  auto cache = std::make_unique<AssetCache>(toStdString(env, directory), static_cast<uint64_t>(maxBytes));
+  std::string error;
+  if (!cache->open(&error)) {
+    jstring message = env->NewStringUTF(error.c_str());
+    env->SetObjectArrayElement(errorOut, 0, message);
+    env->DeleteLocalRef(message);
+    return 0;
+  }
+  return reinterpret_cast<jlong>(cache.release());
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_AssetCache_nativeSetMaxBytes(JNIEnv*, jclass, jlong handle,
+                                                                          jlong maxBytes) {
+  cacheFrom(handle)->setMaxBytes(static_cast<uint64_t>(maxBytes));
+}
+
+// Null on a miss
+JNIEXPORT jbyteArray JNICALL Java_com_meridianmaps_AssetCache_nativeGet(JNIEnv* env, jclass, jlong handle,
+                                                                        jstring url) {
+  std::string bytes;
+  if (!cacheFrom(handle)->get(toStdString(env, url), &bytes)) {
+    return nullptr;
+  }
+  jbyteArray result = env->NewByteArray(static_cast<jsize>(bytes.size()));
+  env->SetByteArrayRegion(result, 0, static_cast<jsize>(bytes.size()), reinterpret_cast<const jbyte*>(bytes.data()));
+  return result;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_AssetCache_nativePut(JNIEnv* env, jclass, jlong handle,
+                                                                      jstring url, jstring contentType,
+                                                                      jbyteArray body) {
+  const jsize length = env->GetArrayLength(body);
+  std::string bytes(static_cast<size_t>(length), '\0');
+  env->GetByteArrayRegion(body, 0, length, reinterpret_cast<jbyte*>(&bytes[0]));
+  std::string error;
+  const bool stored = cacheFrom(handle)->put(toStdString(env, url), toStdString(env, contentType), bytes, &error);
+  if (!stored && !error.empty()) {
+    __android_log_print(ANDROID_LOG_WARN, kTag, "Not caching %s: %s", toStdString(env, url).c_str(), error.c_str());
+  }
+  return stored ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_AssetCache_nativeContains(JNIEnv* env, jclass, jlong handle,
+                                                                           jstring url) {
+  return cacheFrom(handle)->contains(toStdString(env, url)) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_AssetCache_nativeClear(JNIEnv*, jclass, jlong handle) {
+  cacheFrom(handle)->clear();
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_AssetCache_nativeFlush(JNIEnv*, jclass, jlong handle) {
+  std::string error;
+  if (!cacheFrom(handle)->flush(&error)) {
+    __android_log_print(ANDROID_LOG_WARN, kTag, "Failed to write the index: %s", error.c_str());
+  }
+}
+
+// In AssetCache.STATS_NAMES order
+JNIEXPORT jlongArray JNICALL Java_com_meridianmaps_AssetCache_nativeStats(JNIEnv* env, jclass, jlong handle) {
+  const AssetCache* cache = cacheFrom(handle);
+  const AssetCacheStats stats = cache->stats();
+  const jlong counters[] = {
+      static_cast<jlong>(cache->size()),
+      static_cast<jlong>(cache->byteSize()),
+      static_cast<jlong>(cache->maxBytes()),
+      static_cast<jlong>(stats.hits),
+      static_cast<jlong>(stats.bytesServed),
+      static_cast<jlong>(stats.misses),
+      static_cast<jlong>(stats.stores),
+      static_cast<jlong>(stats.dedupStores),
+      static_cast<jlong>(stats.evictions),
+      static_cast<jlong>(stats.bytesEvicted),
+  };
+  jlongArray result = env->NewLongArray(10);
+  env->SetLongArrayRegion(result, 0, 10, counters);
+  return result;
+}
+
+}  // extern "C"
@@ -0,0 +1,362 @@
+// JNI bindings for com.meridianmaps.PlacemarkStore
+
+#include <jni.h>
+
+#include <android/log.h>
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "PlacemarkStore.h"
+#include "PlacemarkSync.h"
+
+using meridianmaps::HttpRequest;
+using meridianmaps::HttpResponse;
+using meridianmaps::PlacemarkDiff;
+using meridianmaps::PlacemarkInput;
+using meridianmaps::PlacemarkSnapshot;
+using meridianmaps::PlacemarkStore;
+using meridianmaps::PlacemarkSync;
+using meridianmaps::PlacemarkTable;
+using meridianmaps::Rect;
+using meridianmaps::SearchResult;
+using meridianmaps::SpatialHit;
+using meridianmaps::SpatialQuery;
+using meridianmaps::SyncManifest;
+using meridianmaps::SyncStats;
+
+namespace {
+
+constexpr const char* kTag = "PlacemarkStore";
+
+PlacemarkStore* storeFrom(jlong handle) {
+  return reinterpret_cast<PlacemarkStore*>(handle);
+}
+
+std::string toStdString(JNIEnv* env, jstring value) {
+  if (!value) {
+    return std::string();
+  }
+  const char* chars = env->GetStringUTFChars(value, nullptr);
+  std::string result(chars);
+  env->ReleaseStringUTFChars(value, chars);
+  return result;
+}
+
+jstring toJString(JNIEnv* env, std::string_view value) {
+  return env->NewStringUTF(std::string(value).c_str());
+}
+
+std::string elementAt(JNIEnv* env, jobjectArray array, jsize index) {
+  auto element = static_cast<jstring>(env->GetObjectArrayElement(array, index));
+  std::string result = toStdString(env, element);
+  env->DeleteLocalRef(element);
+  return result;
+}
+
+// Blocking GET through PlacemarkStore.HttpFetcher, so the platform HTTP stack
+// (proxies, TLS, cookies) is used instead of a socket client in C++.
+HttpResponse fetchThroughJava(JNIEnv* env, jobject fetcher, const HttpRequest& request) {
+  static const char* kResultClass = "com/meridianmaps/PlacemarkStore$HttpResult";
+  jclass fetcherClass = env->FindClass("com/meridianmaps/PlacemarkStore$HttpFetcher");
+  jclass resultClass = env->FindClass(kResultClass);
+  jmethodID fetch = env->GetMethodID(fetcherClass, "fetch",
+                                     "(Ljava/lang/String;Ljava/lang/String;)Lcom/meridianmaps/PlacemarkStore$HttpResult;");
+  jmethodID getStatus = env->GetMethodID(resultClass, "getStatus", "()I");
+  jmethodID getBody = env->GetMethodID(resultClass, "getBody", "()[B");
+  jmethodID getEtag = env->GetMethodID(resultClass, "getEtag", "()Ljava/lang/String;");
+  jmethodID getError = env->GetMethodID(resultClass, "getError", "()Ljava/lang/String;");
+
+  HttpResponse response;
+  jstring url = env->NewStringUTF(request.url.c_str());
+  jstring etag = request.etag.empty() ? nullptr : env->NewStringUTF(request.etag.c_str());
+  jobject result = env->CallObjectMethod(fetcher, fetch, url, etag);
+  if (env->ExceptionCheck() || !result) {
+    env->ExceptionClear();
+    response.error = "fetcher threw";
+  } else {
+    response.status = env->CallIntMethod(result, getStatus);
+    auto body = static_cast<jbyteArray>(env->CallObjectMethod(result, getBody));
+    if (body) {
+      response.body.resize(static_cast<size_t>(env->GetArrayLength(body)));
+      env->GetByteArrayRegion(body, 0, static_cast<jsize>(response.body.size()),
+                              reinterpret_cast<jbyte*>(&response.body[0]));
+      env->DeleteLocalRef(body);
+    }
+    auto etagHeader = static_cast<jstring>(env->CallObjectMethod(result, getEtag));
+    response.etag = toStdString(env, etagHeader);
+    auto error = static_cast<jstring>(env->CallObjectMethod(result, getError));
+    response.error = toStdString(env, error);
+    env->DeleteLocalRef(etagHeader);
+    env->DeleteLocalRef(error);
+    env->DeleteLocalRef(result);
+  }
+  // One sync makes many requests; do not let local references pile up
+  env->DeleteLocalRef(url);
+  env->DeleteLocalRef(etag);
+  env->DeleteLocalRef(fetcherClass);
+  env->DeleteLocalRef(resultClass);
+  return response;
+}
+
+}  // namespace
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_PlacemarkStore_nativeCreate(JNIEnv*, jclass) {
+  return reinterpret_cast<jlong>(new PlacemarkStore());
+}
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_PlacemarkStore_nativeOpenSnapshot(JNIEnv* env, jclass, jstring path) {
+  std::string error;
+  std::unique_ptr<PlacemarkStore> store = PlacemarkStore::openSnapshot(toStdString(env, path), &error);
+  if (!store) {
+    __android_log_print(ANDROID_LOG_WARN, kTag, "Could not map snapshot: %s", error.c_str());
+    return 0;
+  }
+  return reinterpret_cast<jlong>(store.release());
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_PlacemarkStore_nativeDestroy(JNIEnv*, jclass, jlong handle) {
+  delete storeFrom(handle);
+}
+
+JNIEXPORT jint JNICALL Java_com_meridianmaps_PlacemarkStore_nativeSize(JNIEnv*, jclass, jlong handle) {
+  return static_cast<jint>(storeFrom(handle)->size());
+}
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_PlacemarkStore_nativeRevision(JNIEnv*, jclass, jlong handle) {
+  return static_cast<jlong>(storeFrom(handle)->revision());
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_PlacemarkStore_nativeUpsertAll(JNIEnv* env, jclass, jlong handle,
+                                                                           jobjectArray ids, jobjectArray mapIds,
+                                                                           jobjectArray names, jobjectArray types,
+                                                                           jfloatArray coords) {
+  PlacemarkStore* store = storeFrom(handle);
+  const jsize count = env->GetArrayLength(ids);
+  jfloat* values = env->GetFloatArrayElements(coords, nullptr);
+  for (jsize i = 0; i < count; ++i) {
+    const std::string id = elementAt(env, ids, i);
+    const std::string mapId = elementAt(env, mapIds, i);
+    const std::string name = elementAt(env, names, i);
+    const std::string type = elementAt(env, types, i);
+    const jfloat* c = values + i * 6;
+
+    PlacemarkInput input;
+    input.id = id;
+    input.mapKey = mapId;
+    input.name = name;
+    input.type = type;
+    input.x = c[0];
+    input.y = c[1];
+    input.bounds = Rect{c[2], c[3], c[4], c[5]};
+    store->upsert(input);
+  }
+  env->ReleaseFloatArrayElements(coords, values, JNI_ABORT);
+}
+
+JNIEXPORT jint JNICALL Java_com_meridianmaps_PlacemarkStore_nativeFind(JNIEnv* env, jclass, jlong handle,
+                                                                      jstring placemarkId) {
+  const uint32_t row = storeFrom(handle)->find(toStdString(env, placemarkId));
+  return row == PlacemarkTable::npos ? -1 : static_cast<jint>(row);
+}
+
+JNIEXPORT jstring JNICALL Java_com_meridianmaps_PlacemarkStore_nativeId(JNIEnv* env, jclass, jlong handle, jint row) {
+  return toJString(env, storeFrom(handle)->table().id(static_cast<uint32_t>(row)));
+}
+
+JNIEXPORT jstring JNICALL Java_com_meridianmaps_PlacemarkStore_nativeMapId(JNIEnv* env, jclass, jlong handle, jint row) {
+  const PlacemarkTable& table = storeFrom(handle)->table();
+  return toJString(env, table.floorKey(table.floorIndex(static_cast<uint32_t>(row))));
+}
+
+JNIEXPORT jstring JNICALL Java_com_meridianmaps_PlacemarkStore_nativeName(JNIEnv* env, jclass, jlong handle, jint row) {
+  return toJString(env, storeFrom(handle)->table().name(static_cast<uint32_t>(row)));
+}
+
+JNIEXPORT jstring JNICALL Java_com_meridianmaps_PlacemarkStore_nativeType(JNIEnv* env, jclass, jlong handle, jint row) {
+  const PlacemarkTable& table = storeFrom(handle)->table();
+  return toJString(env, table.typeName(table.typeId(static_cast<uint32_t>(row))));
+}
+
+JNIEXPORT jfloatArray JNICALL Java_com_meridianmaps_PlacemarkStore_nativePoint(JNIEnv* env, jclass, jlong handle,
+                                                                              jint row) {
+  const PlacemarkTable& table = storeFrom(handle)->table();
+  const jfloat point[2] = {table.x(static_cast<uint32_t>(row)), table.y(static_cast<uint32_t>(row))};
+  jfloatArray result = env->NewFloatArray(2);
+  env->SetFloatArrayRegion(result, 0, 2, point);
+  return result;
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_meridianmaps_PlacemarkStore_nativeQuery(JNIEnv* env, jclass, jlong handle,
+                                                                            jintArray kinds, jobjectArray mapIds,
+                                                                            jfloatArray params, jintArray limits,
+                                                                            jobjectArray types) {
+  PlacemarkStore* store = storeFrom(handle);
+  const PlacemarkTable& table = store->table();
+  const jsize count = env->GetArrayLength(kinds);
+  jint* kindValues = env->GetIntArrayElements(kinds, nullptr);
+  jint* limitValues = env->GetIntArrayElements(limits, nullptr);
+  jfloat* paramValues = env->GetFloatArrayElements(params, nullptr);
+
+  std::vector<jlong> packed;
+  for (jsize i = 0; i < count; ++i) {
+    SpatialQuery query;
+    query.kind = static_cast<SpatialQuery::Kind>(kindValues[i]);
+    const jfloat* p = paramValues + i * 7;
+    query.x = p[0];
+    query.y = p[1];
+    query.radius = p[2];
+    query.rect = Rect{p[3], p[4], p[5], p[6]};
+    query.limit = static_cast<uint32_t>(limitValues[i]);
+    query.floor = table.findFloor(elementAt(env, mapIds, i));
+
+    // An unknown floor, or a type filter naming only unknown types, matches nothing
+    bool matchesNothing = query.floor == UINT16_MAX;
+    auto typeNames = static_cast<jobjectArray>(env->GetObjectArrayElement(types, i));
+    const jsize typeCount = env->GetArrayLength(typeNames);
+    for (jsize t = 0; t < typeCount; ++t) {
+      const uint16_t type = table.findType(elementAt(env, typeNames, t));
+      if (type != UINT16_MAX) {
+        query.types.push_back(type);
+      }
+    }
+    env->DeleteLocalRef(typeNames);
+    matchesNothing = matchesNothing || (typeCount > 0 && query.types.empty());
+
+    const size_t countSlot = packed.size();
+    packed.push_back(0);
+    if (matchesNothing) {
+      continue;
+    }
+    const std::vector<SpatialHit> hits = store->spatialIndex().query(table, query);
+    packed[countSlot] = static_cast<jlong>(hits.size());
+    for (const SpatialHit& hit : hits) {
+      uint32_t distanceBits;
+      std::memcpy(&distanceBits, &hit.distance, sizeof(distanceBits));
+      packed.push_back(static_cast<jlong>((static_cast<uint64_t>(hit.row) << 32) | distanceBits));
+    }
+  }
+
+  env->ReleaseIntArrayElements(kinds, kindValues, JNI_ABORT);
+  env->ReleaseIntArrayElements(limits, limitValues, JNI_ABORT);
+  env->ReleaseFloatArrayElements(params, paramValues, JNI_ABORT);
+
+  jlongArray result = env->NewLongArray(static_cast<jsize>(packed.size()));
+  env->SetLongArrayRegion(result, 0, static_cast<jsize>(packed.size()), packed.data());
+  return result;
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_meridianmaps_PlacemarkStore_nativeSearch(JNIEnv* env, jclass, jlong handle,
+                                                                             jstring query, jint limit) {
+  PlacemarkStore* store = storeFrom(handle);
+  const std::vector<SearchResult> results =
+      store->searchIndex().search(toStdString(env, query), static_cast<uint32_t>(limit));
+
+  // (row << 32 | score bits) per result, best first
+  const PlacemarkTable& table = store->table();
+  std::vector<jlong> packed;
+  packed.reserve(results.size());
+  for (const SearchResult& result : results) {
+    const uint32_t row = table.find(result.id);
+    if (row == PlacemarkTable::npos) {
+      continue;
+    }
+    uint32_t scoreBits;
+    std::memcpy(&scoreBits, &result.score, sizeof(scoreBits));
+    packed.push_back(static_cast<jlong>((static_cast<uint64_t>(row) << 32) | scoreBits));
+  }
+
+  jlongArray packedResults = env->NewLongArray(static_cast<jsize>(packed.size()));
+  env->SetLongArrayRegion(packedResults, 0, static_cast<jsize>(packed.size()), packed.data());
+  return packedResults;
+}
+
+// Returns {succeeded, requests, bytesReceived, mapsUnchanged, mapsDelta, mapsFull,
+// upserted, removed, unchanged}; on failure errorOut[0] holds the message.
+// The store is only touched while holding lock, the Kotlin store's monitor.
+JNIEXPORT jlongArray JNICALL Java_com_meridianmaps_PlacemarkStore_nativeSync(
+    JNIEnv* env, jclass, jlong handle, jobject lock, jstring baseUrl, jobjectArray mapIds, jint pageSize,
+    jstring snapshotPath, jstring manifestPath, jobject fetcher, jobjectArray errorOut) {
+  PlacemarkStore* store = storeFrom(handle);
+  const std::string manifestFile = toStdString(env, manifestPath);
+
+  SyncManifest manifest;
+  env->MonitorEnter(lock);
+  // The manifest only describes rows the store still has
+  if (store->size() == 0 || !manifest.load(manifestFile)) {
+    manifest.maps.clear();
+  }
+  env->MonitorExit(lock);
+
+  PlacemarkSync::Options options;
+  options.baseUrl = toStdString(env, baseUrl);
+  while (!options.baseUrl.empty() && options.baseUrl.back() == '/') {
+    options.baseUrl.pop_back();
+  }
+  for (jsize i = 0; i < env->GetArrayLength(mapIds); ++i) {
+    options.mapIds.push_back(elementAt(env, mapIds, i));
+  }
+  if (pageSize > 0) {
+    options.pageSize = static_cast<uint32_t>(pageSize);
+  }
+
+  PlacemarkSync sync(options, [env, fetcher](const HttpRequest& request) { return fetchThroughJava(env, fetcher, request); });
+  SyncStats stats;
+  std::string error;
+  const bool synced = sync.run(manifest, [env, lock, store](const PlacemarkDiff& diff) {
+    env->MonitorEnter(lock);
+    diff.applyTo(*store);
+    env->MonitorExit(lock);
+  }, &stats, &error);
+
+  // Snapshot first; a manifest newer than its snapshot would skip rows the store lacks
+  env->MonitorEnter(lock);
+  const std::string bytes = PlacemarkSnapshot::serialize(store->table());
+  env->MonitorExit(lock);
+  std::string writeError;
+  if (!meridianmaps::writeFileAtomically(toStdString(env, snapshotPath), bytes, &writeError) ||
+      !manifest.write(manifestFile, &writeError)) {
+    std::remove(manifestFile.c_str());
+    __android_log_print(ANDROID_LOG_WARN, kTag, "Could not persist sync: %s", writeError.c_str());
+  }
+
+  if (!synced) {
+    jstring message = toJString(env, error);
+    env->SetObjectArrayElement(errorOut, 0, message);
+    env->DeleteLocalRef(message);
+  }
+  const jlong counters[] = {synced ? 1 : 0,
+                            stats.requests,
+                            static_cast<jlong>(stats.bytesReceived),
+                            stats.mapsUnchanged,
+                            stats.mapsDelta,
+                            stats.mapsFull,
+                            stats.upserted,
+                            stats.removed,
+                            stats.unchanged};
+  const jsize count = static_cast<jsize>(sizeof(counters) / sizeof(counters[0]));
+  jlongArray result = env->NewLongArray(count);
+  env->SetLongArrayRegion(result, 0, count, counters);
+  return result;
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_PlacemarkStore_nativeClear(JNIEnv*, jclass, jlong handle) {
+  storeFrom(handle)->clear();
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_PlacemarkStore_nativeWriteSnapshot(JNIEnv* env, jclass, jlong handle,
+                                                                                   jstring path) {
+  std::string error;
+  if (!storeFrom(handle)->writeSnapshot(toStdString(env, path), &error)) {
+    __android_log_print(ANDROID_LOG_WARN, kTag, "Could not write snapshot: %s", error.c_str());
+    return JNI_FALSE;
+  }
+  return JNI_TRUE;
+}
+
+}  // extern "C"
@@ -0,0 +1,625 @@
+// JNI bindings for com.meridianmaps.LocationThrottle, LocationFilter, LocationHistory, LocationRecorder,
+// LocationReplay, GeofenceEngine, MotionMonitor and LocationDutyCycle
+
+#include <jni.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "GeofenceEngine.h"
+#include "LocationDutyCycle.h"
+#include "LocationFilter.h"
+#include "LocationHistory.h"
+#include "LocationThrottle.h"
+#include "LocationTrace.h"
+
+using meridianmaps::GeofenceEngine;
+using meridianmaps::GeofenceRegion;
+using meridianmaps::GeofenceTransition;
+using meridianmaps::LocationDutyCycle;
+using meridianmaps::LocationDutyCycleOptions;
+using meridianmaps::LocationDutyCycleStats;
+using meridianmaps::LocationEstimate;
+using meridianmaps::LocationFilter;
+using meridianmaps::LocationHistory;
+using meridianmaps::LocationHistoryQuery;
+using meridianmaps::LocationHistoryResult;
+using meridianmaps::LocationReplay;
+using meridianmaps::LocationTrace;
+using meridianmaps::LocationTraceWriter;
+using meridianmaps::LocationSample;
+using meridianmaps::LocationThrottle;
+using meridianmaps::LocationThrottleOptions;
+using meridianmaps::LocationThrottleStats;
+using meridianmaps::MotionDetector;
+
+namespace {
+
+// nativeOffer results; LocationThrottle.kt treats anything else as a due time
+constexpr jlong kDeliver = -1;
+constexpr jlong kDrop = -2;
+
+LocationThrottle* throttleFrom(jlong handle) {
+  return reinterpret_cast<LocationThrottle*>(handle);
+}
+
+LocationFilter* filterFrom(jlong handle) {
+  return reinterpret_cast<LocationFilter*>(handle);
+}
+
+LocationTraceWriter* writerFrom(jlong handle) {
+  return reinterpret_cast<LocationTraceWriter*>(handle);
+}
+
+// Fixes cross JNI as numbers, so map keys travel once as a table and then by index
+struct ReplayHandle {
+  std::unique_ptr<LocationReplay> replay;
+  std::vector<std::string> mapKeys;
+  std::unordered_map<std::string, size_t> mapKeyIndex;
+};
+
+ReplayHandle* replayFrom(jlong handle) {
+  return reinterpret_cast<ReplayHandle*>(handle);
+}
+
+struct HistoryHandle {
+  explicit HistoryHandle(size_t capacityBytes) : history(capacityBytes) {}
+
+  LocationHistory history;
+  // Map keys of the last query's points, fetched right after it
+  std::vector<std::string> resultMapKeys;
+};
+
+HistoryHandle* historyFrom(jlong handle) {
+  return reinterpret_cast<HistoryHandle*>(handle);
+}
+
+GeofenceEngine* geofencesFrom(jlong handle) {
+  return reinterpret_cast<GeofenceEngine*>(handle);
+}
+
+void setErrorOut(JNIEnv* env, jobjectArray errorOut, const std::string& error) {
+  jstring message = env->NewStringUTF(error.c_str());
+  env->SetObjectArrayElement(errorOut, 0, message);
+  env->DeleteLocalRef(message);
+}
+
+std::string toStdString(JNIEnv* env, jstring value) {
+  if (!value) {
+    return std::string();
+  }
+  const char* chars = env->GetStringUTFChars(value, nullptr);
+  std::string result(chars);
+  env->ReleaseStringUTFChars(value, chars);
+  return result;
+}
+
+jobjectArray toStringArray(JNIEnv* env, const std::vector<std::string>& values) {
+  jclass stringClass = env->FindClass("java/lang/String");
+  jobjectArray result = env->NewObjectArray(static_cast<jsize>(values.size()), stringClass, nullptr);
+  for (size_t i = 0; i < values.size(); ++i) {
+    jstring value = env->NewStringUTF(values[i].c_str());
+    env->SetObjectArrayElement(result, static_cast<jsize>(i), value);
+    env->DeleteLocalRef(value);
+  }
+  env->DeleteLocalRef(stringClass);
+  return result;
+}
+
+jdoubleArray toDoubleArray(JNIEnv* env, const std::vector<jdouble>& values) {
+  jdoubleArray result = env->NewDoubleArray(static_cast<jsize>(values.size()));
+  env->SetDoubleArrayRegion(result, 0, static_cast<jsize>(values.size()), values.data());
+  return result;
+}
+
+MotionDetector* motionFrom(jlong handle) {
+  return reinterpret_cast<MotionDetector*>(handle);
+}
+
+// The view's duty cycle runs on the main thread, but stats are read from the JS thread
+struct DutyCycleHandle {
+  std::mutex mutex;
+  LocationDutyCycle cycle;
+
+  explicit DutyCycleHandle(int64_t nowMs) : cycle(nowMs) {}
+};
+
+DutyCycleHandle* dutyCycleFrom(jlong handle) {
+  return reinterpret_cast<DutyCycleHandle*>(handle);
+}
+
+// Counters of destroyed duty cycles, so process totals survive their views
+std::mutex retiredDutyStatsMutex;
+LocationDutyCycleStats retiredDutyStats;
+
+// In LocationDutyCycle.STATS_NAMES order
+jlongArray toLongArray(JNIEnv* env, const LocationDutyCycleStats& stats) {
+  const jlong counters[] = {
+      stats.activeMs,
+      stats.pollingMs,
+      stats.pausedMs,
+      static_cast<jlong>(stats.fixes),
+      static_cast<jlong>(stats.pauses),
+      static_cast<jlong>(stats.motionResumes),
+      static_cast<jlong>(stats.polls),
+  };
+  jlongArray result = env->NewLongArray(7);
+  env->SetLongArrayRegion(result, 0, 7, counters);
+  return result;
+}
+
+}  // namespace
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_LocationThrottle_nativeCreate(JNIEnv*, jclass) {
+  return reinterpret_cast<jlong>(new LocationThrottle());
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_LocationThrottle_nativeDestroy(JNIEnv*, jclass, jlong handle) {
+  delete throttleFrom(handle);
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_LocationThrottle_nativeSetOptions(JNIEnv*, jclass, jlong handle,
+                                                                               jdouble maxRateHz,
+                                                                               jdouble minDisplacement,
+                                                                               jdouble minAccuracyImprovement,
+                                                                               jlong coalesceWindowMs) {
+  LocationThrottleOptions options;
+  options.maxRateHz = maxRateHz;
+  options.minDisplacement = minDisplacement;
+  options.minAccuracyImprovement = minAccuracyImprovement;
+  options.coalesceWindowMs = coalesceWindowMs;
+  throttleFrom(handle)->setOptions(options);
+}
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_LocationThrottle_nativeOffer(JNIEnv* env, jclass, jlong handle,
+                                                                           jstring mapKey, jdouble x, jdouble y,
+                                                                           jdouble accuracy, jlong timestampMs,
+                                                                           jint providerType, jlong nowMs) {
+  LocationSample sample;
+  sample.mapKey = toStdString(env, mapKey);
+  sample.x = x;
+  sample.y = y;
+  sample.accuracy = accuracy;
+  sample.timestampMs = timestampMs;
+  sample.providerType = providerType;
+  const LocationThrottle::Decision decision = throttleFrom(handle)->offer(sample, nowMs);
+  switch (decision.action) {
+    case LocationThrottle::Action::Deliver:
+      return kDeliver;
+    case LocationThrottle::Action::Drop:
+      return kDrop;
+    case LocationThrottle::Action::Hold:
+      break;
+  }
+  return decision.dueMs;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_LocationThrottle_nativeFlush(JNIEnv*, jclass, jlong handle,
+                                                                              jlong nowMs) {
+  return throttleFrom(handle)->flush(nowMs).has_value() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_LocationThrottle_nativeHasPending(JNIEnv*, jclass, jlong handle) {
+  return throttleFrom(handle)->hasPending() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_LocationThrottle_nativePendingDueMs(JNIEnv*, jclass, jlong handle) {
+  return throttleFrom(handle)->pendingDueMs();
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_LocationThrottle_nativeReset(JNIEnv*, jclass, jlong handle) {
+  throttleFrom(handle)->reset();
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_meridianmaps_LocationThrottle_nativeTotalStats(JNIEnv* env, jclass) {
+  const LocationThrottleStats stats = LocationThrottle::totalStats();
+  const jlong counters[] = {
+      static_cast<jlong>(stats.received),
+      static_cast<jlong>(stats.delivered),
+      static_cast<jlong>(stats.dropped),
+      static_cast<jlong>(stats.coalesced),
+  };
+  jlongArray result = env->NewLongArray(4);
+  env->SetLongArrayRegion(result, 0, 4, counters);
+  return result;
+}
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_LocationFilter_nativeCreate(JNIEnv*, jclass) {
+  return reinterpret_cast<jlong>(new LocationFilter());
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_LocationFilter_nativeDestroy(JNIEnv*, jclass, jlong handle) {
+  delete filterFrom(handle);
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_LocationFilter_nativeReset(JNIEnv*, jclass, jlong handle) {
+  filterFrom(handle)->reset();
+}
+
+JNIEXPORT jdoubleArray JNICALL Java_com_meridianmaps_LocationFilter_nativeUpdate(JNIEnv* env, jclass, jlong handle,
+                                                                                 jstring mapKey, jdouble x, jdouble y,
+                                                                                 jdouble accuracy, jlong timestampMs,
+                                                                                 jint providerType) {
+  LocationSample sample;
+  sample.mapKey = toStdString(env, mapKey);
+  sample.x = x;
+  sample.y = y;
+  sample.accuracy = accuracy;
+  sample.timestampMs = timestampMs;
+  sample.providerType = providerType;
+  const LocationEstimate estimate = filterFrom(handle)->update(sample);
+  const jdouble values[] = {
+      estimate.sample.x, estimate.sample.y, estimate.sample.accuracy, estimate.vx, estimate.vy, estimate.speed,
+      estimate.hasHeading ? estimate.heading : NAN,
+  };
+  jdoubleArray result = env->NewDoubleArray(7);
+  env->SetDoubleArrayRegion(result, 0, 7, values);
+  return result;
+}
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_LocationHistory_nativeCreate(JNIEnv*, jclass, jint capacityBytes) {
+  return reinterpret_cast<jlong>(new HistoryHandle(static_cast<size_t>(std::max(capacityBytes, 0))));
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_LocationHistory_nativeDestroy(JNIEnv*, jclass, jlong handle) {
+  delete historyFrom(handle);
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_LocationHistory_nativeSetCapacity(JNIEnv*, jclass, jlong handle,
+                                                                             jint capacityBytes) {
+  historyFrom(handle)->history.setCapacity(static_cast<size_t>(std::max(capacityBytes, 0)));
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_LocationHistory_nativeAppend(JNIEnv* env, jclass, jlong handle,
+                                                                          jstring mapKey, jdouble x, jdouble y,
+                                                                          jdouble accuracy, jlong timestampMs,
+                                                                          jint providerType) {
+  LocationSample sample;
+  sample.mapKey = toStdString(env, mapKey);
+  sample.x = x;
+  sample.y = y;
+  sample.accuracy = accuracy;
+  sample.timestampMs = timestampMs;
+  sample.providerType = providerType;
+  historyFrom(handle)->history.append(sample);
+}
+
+// The match count, then x, y, accuracy, timestamp and map key index per point
+JNIEXPORT jdoubleArray JNICALL Java_com_meridianmaps_LocationHistory_nativeQuery(
+    JNIEnv* env, jclass, jlong handle, jlong sinceMs, jlong untilMs, jstring mapKey, jboolean hasBounds, jdouble minX,
+    jdouble minY, jdouble maxX, jdouble maxY, jint maxPoints) {
+  HistoryHandle* history = historyFrom(handle);
+  LocationHistoryQuery query;
+  query.sinceMs = sinceMs;
+  query.untilMs = untilMs;
+  query.mapKey = toStdString(env, mapKey);
+  query.hasBounds = hasBounds == JNI_TRUE;
+  query.minX = minX;
+  query.minY = minY;
+  query.maxX = maxX;
+  query.maxY = maxY;
+  query.maxPoints = static_cast<size_t>(std::max(maxPoints, 0));
+  const LocationHistoryResult result = history->history.query(query);
+
+  history->resultMapKeys.clear();
+  std::vector<jdouble> values;
+  values.reserve(1 + result.points.size() * 5);
+  values.push_back(static_cast<jdouble>(result.matched));
+  for (const LocationSample& sample : result.points) {
+    if (history->resultMapKeys.empty() || history->resultMapKeys.back() != sample.mapKey) {
+      history->resultMapKeys.push_back(sample.mapKey);
+    }
+    values.insert(values.end(), {sample.x, sample.y, sample.accuracy, static_cast<jdouble>(sample.timestampMs),
+                                 static_cast<jdouble>(history->resultMapKeys.size() - 1)});
+  }
+  return toDoubleArray(env, values);
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_meridianmaps_LocationHistory_nativeResultMapKeys(JNIEnv* env, jclass,
+                                                                                         jlong handle) {
+  return toStringArray(env, historyFrom(handle)->resultMapKeys);
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_LocationHistory_nativeClear(JNIEnv*, jclass, jlong handle) {
+  historyFrom(handle)->history.clear();
+}
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_LocationRecorder_nativeOpen(JNIEnv* env, jclass, jstring path,
+                                                                          jobjectArray errorOut) {
+  std::string error;
+  std::unique_ptr<LocationTraceWriter> writer = LocationTraceWriter::open(toStdString(env, path), &error);
+  if (!writer) {
+    setErrorOut(env, errorOut, error);
+    return 0;
+  }
+  return reinterpret_cast<jlong>(writer.release());
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_LocationRecorder_nativeAppend(JNIEnv* env, jclass, jlong handle,
+                                                                           jstring mapKey, jdouble x, jdouble y,
+                                                                           jdouble accuracy, jlong timestampMs,
+                                                                           jint providerType) {
+  LocationSample sample;
+  sample.mapKey = toStdString(env, mapKey);
+  sample.x = x;
+  sample.y = y;
+  sample.accuracy = accuracy;
+  sample.timestampMs = timestampMs;
+  sample.providerType = providerType;
+  writerFrom(handle)->append(sample);
+  writerFrom(handle)->flush();
+}
+
+JNIEXPORT jint JNICALL Java_com_meridianmaps_LocationRecorder_nativeClose(JNIEnv*, jclass, jlong handle) {
+  LocationTraceWriter* writer = writerFrom(handle);
+  const auto count = static_cast<jint>(writer->count());
+  delete writer;
+  return count;
+}
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_LocationReplay_nativeOpen(JNIEnv* env, jclass, jstring path,
+                                                                        jdouble speed, jobjectArray errorOut) {
+  std::vector<LocationSample> samples;
+  std::string error;
+  if (!LocationTrace::read(toStdString(env, path), &samples, &error)) {
+    setErrorOut(env, errorOut, error);
+    return 0;
+  }
+  auto handle = new ReplayHandle();
+  for (const LocationSample& sample : samples) {
+    if (handle->mapKeyIndex.emplace(sample.mapKey, handle->mapKeys.size()).second) {
+      handle->mapKeys.push_back(sample.mapKey);
+    }
+  }
+  handle->replay = std::make_unique<LocationReplay>(std::move(samples), speed);
+  return reinterpret_cast<jlong>(handle);
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_LocationReplay_nativeDestroy(JNIEnv*, jclass, jlong handle) {
+  delete replayFrom(handle);
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_meridianmaps_LocationReplay_nativeMapKeys(JNIEnv* env, jclass,
+                                                                                  jlong handle) {
+  return toStringArray(env, replayFrom(handle)->mapKeys);
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_LocationReplay_nativeStart(JNIEnv*, jclass, jlong handle, jlong nowMs) {
+  replayFrom(handle)->replay->start(nowMs);
+}
+
+// x, y, accuracy, timestamp, provider and map key index per fix
+JNIEXPORT jdoubleArray JNICALL Java_com_meridianmaps_LocationReplay_nativeTake(JNIEnv* env, jclass, jlong handle,
+                                                                               jlong nowMs, jint maxCount) {
+  ReplayHandle* replay = replayFrom(handle);
+  const std::vector<LocationSample> due = replay->replay->take(nowMs, static_cast<size_t>(std::max(maxCount, 0)));
+  std::vector<jdouble> values;
+  values.reserve(due.size() * 6);
+  for (const LocationSample& sample : due) {
+    values.insert(values.end(), {sample.x, sample.y, sample.accuracy, static_cast<jdouble>(sample.timestampMs),
+                                 static_cast<jdouble>(sample.providerType),
+                                 static_cast<jdouble>(replay->mapKeyIndex[sample.mapKey])});
+  }
+  return toDoubleArray(env, values);
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_LocationReplay_nativeDone(JNIEnv*, jclass, jlong handle) {
+  return replayFrom(handle)->replay->done() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_LocationReplay_nativeNextDueMs(JNIEnv*, jclass, jlong handle) {
+  return replayFrom(handle)->replay->nextDueMs();
+}
+
+JNIEXPORT jint JNICALL Java_com_meridianmaps_LocationReplay_nativePosition(JNIEnv*, jclass, jlong handle) {
+  return static_cast<jint>(replayFrom(handle)->replay->position());
+}
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_GeofenceEngine_nativeCreate(JNIEnv*, jclass) {
+  return reinterpret_cast<jlong>(new GeofenceEngine());
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_GeofenceEngine_nativeDestroy(JNIEnv*, jclass, jlong handle) {
+  delete geofencesFrom(handle);
+}
+
+JNIEXPORT jint JNICALL Java_com_meridianmaps_GeofenceEngine_nativeSize(JNIEnv*, jclass, jlong handle) {
+  return static_cast<jint>(geofencesFrom(handle)->size());
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_GeofenceEngine_nativeAdd(JNIEnv* env, jclass, jlong handle, jstring id,
+                                                                          jstring mapKey, jfloatArray vertices,
+                                                                          jfloat hysteresis, jlong dwellMs,
+                                                                          jobjectArray errorOut) {
+  GeofenceRegion region;
+  region.id = toStdString(env, id);
+  region.mapKey = toStdString(env, mapKey);
+  region.hysteresis = hysteresis;
+  region.dwellMs = dwellMs;
+  const jsize length = env->GetArrayLength(vertices);
+  std::vector<jfloat> coords(static_cast<size_t>(length));
+  env->GetFloatArrayRegion(vertices, 0, length, coords.data());
+  for (size_t i = 0; i + 1 < coords.size(); i += 2) {
+    region.polygon.push_back({coords[i], coords[i + 1]});
+  }
+  std::string error;
+  if (!geofencesFrom(handle)->add(std::move(region), &error)) {
+    setErrorOut(env, errorOut, error);
+    return JNI_FALSE;
+  }
+  return JNI_TRUE;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_GeofenceEngine_nativeAddCircle(JNIEnv* env, jclass, jlong handle,
+                                                                                jstring id, jstring mapKey, jfloat x,
+                                                                                jfloat y, jfloat radius,
+                                                                                jfloat hysteresis, jlong dwellMs,
+                                                                                jobjectArray errorOut) {
+  GeofenceRegion region;
+  region.id = toStdString(env, id);
+  region.mapKey = toStdString(env, mapKey);
+  region.polygon = meridianmaps::circlePolygon(x, y, radius);
+  region.hysteresis = hysteresis;
+  region.dwellMs = dwellMs;
+  std::string error;
+  if (!geofencesFrom(handle)->add(std::move(region), &error)) {
+    setErrorOut(env, errorOut, error);
+    return JNI_FALSE;
+  }
+  return JNI_TRUE;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_GeofenceEngine_nativeRemove(JNIEnv* env, jclass, jlong handle,
+                                                                             jstring id) {
+  return geofencesFrom(handle)->remove(toStdString(env, id)) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_GeofenceEngine_nativeClear(JNIEnv*, jclass, jlong handle) {
+  geofencesFrom(handle)->clear();
+}
+
+// Type and id of each transition, or null when the fix caused none
+JNIEXPORT jobjectArray JNICALL Java_com_meridianmaps_GeofenceEngine_nativeUpdate(JNIEnv* env, jclass, jlong handle,
+                                                                                 jstring mapKey, jdouble x, jdouble y,
+                                                                                 jdouble accuracy, jlong timestampMs,
+                                                                                 jint providerType) {
+  GeofenceEngine* engine = geofencesFrom(handle);
+  if (engine->size() == 0) {
+    return nullptr;
+  }
+  LocationSample sample;
+  sample.mapKey = toStdString(env, mapKey);
+  sample.x = x;
+  sample.y = y;
+  sample.accuracy = accuracy;
+  sample.timestampMs = timestampMs;
+  sample.providerType = providerType;
+  std::vector<GeofenceTransition> transitions;
+  engine->update(sample, &transitions);
+  if (transitions.empty()) {
+    return nullptr;
+  }
+  std::vector<std::string> values;
+  values.reserve(transitions.size() * 2);
+  for (GeofenceTransition& transition : transitions) {
+    values.emplace_back(transition.type == GeofenceTransition::Type::Enter  ? "enter"
+                        : transition.type == GeofenceTransition::Type::Exit ? "exit"
+                                                                            : "dwell");
+    values.push_back(std::move(transition.id));
+  }
+  return toStringArray(env, values);
+}
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_MotionMonitor_nativeCreate(JNIEnv*, jclass) {
+  return reinterpret_cast<jlong>(new MotionDetector());
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_MotionMonitor_nativeAddSample(JNIEnv*, jclass, jlong handle, jdouble x,
+                                                                              jdouble y, jdouble z,
+                                                                              jlong timestampMs) {
+  return motionFrom(handle)->addSample(x, y, z, timestampMs) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_MotionMonitor_nativeMoving(JNIEnv*, jclass, jlong handle) {
+  return motionFrom(handle)->moving() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_MotionMonitor_nativeReset(JNIEnv*, jclass, jlong handle) {
+  motionFrom(handle)->reset();
+}
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_LocationDutyCycle_nativeCreate(JNIEnv*, jclass, jlong nowMs) {
+  return reinterpret_cast<jlong>(new DutyCycleHandle(nowMs));
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_LocationDutyCycle_nativeDestroy(JNIEnv*, jclass, jlong handle,
+                                                                            jlong nowMs) {
+  DutyCycleHandle* dutyCycle = dutyCycleFrom(handle);
+  {
+    std::lock_guard<std::mutex> lock(retiredDutyStatsMutex);
+    retiredDutyStats += dutyCycle->cycle.stats(nowMs);
+  }
+  delete dutyCycle;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_LocationDutyCycle_nativeSetOptions(
+    JNIEnv*, jclass, jlong handle, jboolean enabled, jlong stillDelayMs, jlong stillPollIntervalMs,
+    jlong pollTimeoutMs, jboolean pauseWhenHidden, jlong nowMs) {
+  LocationDutyCycleOptions options;
+  options.enabled = enabled == JNI_TRUE;
+  options.stillDelayMs = stillDelayMs;
+  options.stillPollIntervalMs = stillPollIntervalMs;
+  options.pollTimeoutMs = pollTimeoutMs;
+  options.pauseWhenHidden = pauseWhenHidden == JNI_TRUE;
+  DutyCycleHandle* dutyCycle = dutyCycleFrom(handle);
+  std::lock_guard<std::mutex> lock(dutyCycle->mutex);
+  dutyCycle->cycle.setOptions(options, nowMs);
+  return dutyCycle->cycle.running() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_LocationDutyCycle_nativeSetMoving(JNIEnv*, jclass, jlong handle,
+                                                                                  jboolean moving, jlong nowMs) {
+  DutyCycleHandle* dutyCycle = dutyCycleFrom(handle);
+  std::lock_guard<std::mutex> lock(dutyCycle->mutex);
+  dutyCycle->cycle.setMoving(moving == JNI_TRUE, nowMs);
+  return dutyCycle->cycle.running() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_LocationDutyCycle_nativeSetVisible(JNIEnv*, jclass, jlong handle,
+                                                                                   jboolean visible, jlong nowMs) {
+  DutyCycleHandle* dutyCycle = dutyCycleFrom(handle);
+  std::lock_guard<std::mutex> lock(dutyCycle->mutex);
+  dutyCycle->cycle.setVisible(visible == JNI_TRUE, nowMs);
+  return dutyCycle->cycle.running() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_LocationDutyCycle_nativeRecordFix(JNIEnv*, jclass, jlong handle,
+                                                                                  jlong nowMs) {
+  DutyCycleHandle* dutyCycle = dutyCycleFrom(handle);
+  std::lock_guard<std::mutex> lock(dutyCycle->mutex);
+  dutyCycle->cycle.recordFix(nowMs);
+  return dutyCycle->cycle.running() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_LocationDutyCycle_nativeUpdate(JNIEnv*, jclass, jlong handle,
+                                                                               jlong nowMs) {
+  DutyCycleHandle* dutyCycle = dutyCycleFrom(handle);
+  std::lock_guard<std::mutex> lock(dutyCycle->mutex);
+  dutyCycle->cycle.update(nowMs);
+  return dutyCycle->cycle.running() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_LocationDutyCycle_nativeNextUpdateMs(JNIEnv*, jclass, jlong handle) {
+  DutyCycleHandle* dutyCycle = dutyCycleFrom(handle);
+  std::lock_guard<std::mutex> lock(dutyCycle->mutex);
+  return dutyCycle->cycle.nextUpdateMs();
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_meridianmaps_LocationDutyCycle_nativeStats(JNIEnv* env, jclass, jlong handle,
+                                                                                jlong nowMs) {
+  DutyCycleHandle* dutyCycle = dutyCycleFrom(handle);
+  LocationDutyCycleStats stats;
+  {
+    std::lock_guard<std::mutex> lock(dutyCycle->mutex);
+    stats = dutyCycle->cycle.stats(nowMs);
+  }
+  return toLongArray(env, stats);
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_meridianmaps_LocationDutyCycle_nativeRetiredStats(JNIEnv* env, jclass) {
+  LocationDutyCycleStats stats;
+  {
+    std::lock_guard<std::mutex> lock(retiredDutyStatsMutex);
+    stats = retiredDutyStats;
+  }
+  return toLongArray(env, stats);
+}
+
+}  // extern "C"
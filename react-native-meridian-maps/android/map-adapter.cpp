@@ -0,0 +1,91 @@
+// JNI bindings for com.meridianmaps.MapViewPool
+
+#include <jni.h>
+
+#include <string>
+#include <vector>
+
+#include "MapPool.h"
+
+using meridianmaps::MapPool;
+using meridianmaps::MapPoolStats;
+
+namespace {
+
+MapPool* poolFrom(jlong handle) {
+  return reinterpret_cast<MapPool*>(handle);
+}
+
+std::string toStdString(JNIEnv* env, jstring value) {
+  if (!value) {
+    return std::string();
+  }
+  const char* chars = env->GetStringUTFChars(value, nullptr);
+  std::string result(chars);
+  env->ReleaseStringUTFChars(value, chars);
+  return result;
+}
+
+jlongArray toLongArray(JNIEnv* env, const std::vector<uint64_t>& ids) {
+  std::vector<jlong> values(ids.begin(), ids.end());
+  jlongArray result = env->NewLongArray(static_cast<jsize>(values.size()));
+  env->SetLongArrayRegion(result, 0, static_cast<jsize>(values.size()), values.data());
+  return result;
+}
+
+}  // namespace
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_MapViewPool_nativeCreate(JNIEnv*, jclass, jint capacity) {
+  return reinterpret_cast<jlong>(new MapPool(static_cast<size_t>(capacity)));
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_meridianmaps_MapViewPool_nativeSetCapacity(JNIEnv* env, jclass, jlong handle,
+                                                                                 jint capacity) {
+  std::vector<uint64_t> evicted;
+  poolFrom(handle)->setCapacity(static_cast<size_t>(capacity), &evicted);
+  return toLongArray(env, evicted);
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_meridianmaps_MapViewPool_nativePark(JNIEnv* env, jclass, jlong handle,
+                                                                          jstring key, jlong id) {
+  std::vector<uint64_t> evicted;
+  poolFrom(handle)->park(toStdString(env, key), static_cast<uint64_t>(id), &evicted);
+  return toLongArray(env, evicted);
+}
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_MapViewPool_nativeTake(JNIEnv* env, jclass, jlong handle, jstring key) {
+  return static_cast<jlong>(poolFrom(handle)->take(toStdString(env, key)));
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_meridianmaps_MapViewPool_nativeTrim(JNIEnv* env, jclass, jlong handle,
+                                                                          jint keep) {
+  std::vector<uint64_t> evicted;
+  poolFrom(handle)->trim(static_cast<size_t>(keep), &evicted);
+  return toLongArray(env, evicted);
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_MapViewPool_nativeRemove(JNIEnv*, jclass, jlong handle, jlong id) {
+  return poolFrom(handle)->remove(static_cast<uint64_t>(id)) ? JNI_TRUE : JNI_FALSE;
+}
+
+// In MapViewPool.STATS_NAMES order
+JNIEXPORT jlongArray JNICALL Java_com_meridianmaps_MapViewPool_nativeStats(JNIEnv* env, jclass, jlong handle) {
+  const MapPool* pool = poolFrom(handle);
+  const MapPoolStats& stats = pool->stats();
+  const jlong counters[] = {
+      static_cast<jlong>(pool->size()),
+      static_cast<jlong>(pool->capacity()),
+      static_cast<jlong>(stats.parked),
+      static_cast<jlong>(stats.hits),
+      static_cast<jlong>(stats.misses),
+      static_cast<jlong>(stats.evictions),
+      static_cast<jlong>(stats.trims),
+  };
+  jlongArray result = env->NewLongArray(7);
+  env->SetLongArrayRegion(result, 0, 7, counters);
+  return result;
+}
+
+}  // extern "C"
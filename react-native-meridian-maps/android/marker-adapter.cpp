@@ -0,0 +1,99 @@
+// JNI bindings for com.meridianmaps.MarkerAtlas
+
+#include <jni.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "MarkerAtlas.h"
+
+using meridianmaps::MarkerAtlas;
+using meridianmaps::MarkerAtlasStats;
+
+namespace {
+
+MarkerAtlas* atlasFrom(jlong handle) {
+  return reinterpret_cast<MarkerAtlas*>(handle);
+}
+
+std::string toStdString(JNIEnv* env, jstring value) {
+  if (!value) {
+    return std::string();
+  }
+  const char* chars = env->GetStringUTFChars(value, nullptr);
+  std::string result(chars);
+  env->ReleaseStringUTFChars(value, chars);
+  return result;
+}
+
+jlongArray toLongArray(JNIEnv* env, const std::vector<uint64_t>& ids) {
+  std::vector<jlong> values(ids.begin(), ids.end());
+  jlongArray result = env->NewLongArray(static_cast<jsize>(values.size()));
+  env->SetLongArrayRegion(result, 0, static_cast<jsize>(values.size()), values.data());
+  return result;
+}
+
+}  // namespace
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_MarkerAtlas_nativeCreate(JNIEnv*, jclass, jlong maxUnusedBytes) {
+  return reinterpret_cast<jlong>(new MarkerAtlas(static_cast<uint64_t>(maxUnusedBytes)));
+}
+
+// tinted false is an icon drawn without a color, whatever argb is
+JNIEXPORT jstring JNICALL Java_com_meridianmaps_MarkerAtlas_nativeKey(JNIEnv* env, jclass, jstring icon, jint sizePx,
+                                                                      jint argb, jboolean tinted, jboolean selected) {
+  const std::optional<uint32_t> color =
+      tinted == JNI_TRUE ? std::optional<uint32_t>(static_cast<uint32_t>(argb)) : std::nullopt;
+  const std::string key =
+      MarkerAtlas::key(toStdString(env, icon), static_cast<uint32_t>(sizePx), color, selected == JNI_TRUE);
+  return env->NewStringUTF(key.c_str());
+}
+
+// Negative when the caller has to draw the bitmap for the id
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_MarkerAtlas_nativeAcquire(JNIEnv* env, jclass, jlong handle,
+                                                                        jstring key, jlong bytes) {
+  bool created = false;
+  const uint64_t id = atlasFrom(handle)->acquire(toStdString(env, key), static_cast<uint64_t>(bytes), &created);
+  return created ? -static_cast<jlong>(id) : static_cast<jlong>(id);
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_meridianmaps_MarkerAtlas_nativeRelease(JNIEnv* env, jclass, jlong handle,
+                                                                             jlong id) {
+  std::vector<uint64_t> evicted;
+  atlasFrom(handle)->release(static_cast<uint64_t>(id), &evicted);
+  return toLongArray(env, evicted);
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_MarkerAtlas_nativeRemove(JNIEnv*, jclass, jlong handle, jlong id) {
+  return atlasFrom(handle)->remove(static_cast<uint64_t>(id)) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jlongArray JNICALL Java_com_meridianmaps_MarkerAtlas_nativeTrim(JNIEnv* env, jclass, jlong handle) {
+  std::vector<uint64_t> evicted;
+  atlasFrom(handle)->trim(&evicted);
+  return toLongArray(env, evicted);
+}
+
+// In MarkerAtlas.STATS_NAMES order
+JNIEXPORT jlongArray JNICALL Java_com_meridianmaps_MarkerAtlas_nativeStats(JNIEnv* env, jclass, jlong handle) {
+  const MarkerAtlas* atlas = atlasFrom(handle);
+  const MarkerAtlasStats& stats = atlas->stats();
+  const jlong counters[] = {
+      static_cast<jlong>(atlas->size()),
+      static_cast<jlong>(atlas->bytes()),
+      static_cast<jlong>(atlas->unusedBytes()),
+      static_cast<jlong>(stats.hits),
+      static_cast<jlong>(stats.draws),
+      static_cast<jlong>(stats.releases),
+      static_cast<jlong>(stats.evictions),
+      static_cast<jlong>(stats.trims),
+  };
+  jlongArray result = env->NewLongArray(8);
+  env->SetLongArrayRegion(result, 0, 8, counters);
+  return result;
+}
+
+}  // extern "C"
@@ -0,0 +1,88 @@
+// JNI bindings for com.meridianmaps.VenueRegistry
+
+#include <jni.h>
+
+#include <string>
+#include <vector>
+
+#include "VenueRegistry.h"
+
+using meridianmaps::VenueRegistry;
+using meridianmaps::VenueRegistryStats;
+
+namespace {
+
+VenueRegistry* registryFrom(jlong handle) {
+  return reinterpret_cast<VenueRegistry*>(handle);
+}
+
+std::string toStdString(JNIEnv* env, jstring value) {
+  if (!value) {
+    return std::string();
+  }
+  const char* chars = env->GetStringUTFChars(value, nullptr);
+  std::string result(chars);
+  env->ReleaseStringUTFChars(value, chars);
+  return result;
+}
+
+jobjectArray toStringArray(JNIEnv* env, const std::vector<std::string>& values) {
+  jclass stringClass = env->FindClass("java/lang/String");
+  jobjectArray result = env->NewObjectArray(static_cast<jsize>(values.size()), stringClass, nullptr);
+  for (size_t i = 0; i < values.size(); ++i) {
+    jstring value = env->NewStringUTF(values[i].c_str());
+    env->SetObjectArrayElement(result, static_cast<jsize>(i), value);
+    env->DeleteLocalRef(value);
+  }
+  env->DeleteLocalRef(stringClass);
+  return result;
+}
+
+}  // namespace
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_VenueRegistry_nativeCreate(JNIEnv*, jclass, jint capacity) {
+  return reinterpret_cast<jlong>(new VenueRegistry(static_cast<size_t>(capacity)));
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_meridianmaps_VenueRegistry_nativeSetCapacity(JNIEnv* env, jclass,
+                                                                                     jlong handle, jint capacity) {
+  std::vector<std::string> evicted;
+  registryFrom(handle)->setCapacity(static_cast<size_t>(capacity), &evicted);
+  return toStringArray(env, evicted);
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_meridianmaps_VenueRegistry_nativeActivate(JNIEnv* env, jclass, jlong handle,
+                                                                                  jstring appId) {
+  std::vector<std::string> evicted;
+  registryFrom(handle)->activate(toStdString(env, appId), &evicted);
+  return toStringArray(env, evicted);
+}
+
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_VenueRegistry_nativeContains(JNIEnv* env, jclass, jlong handle,
+                                                                              jstring appId) {
+  return registryFrom(handle)->contains(toStdString(env, appId)) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jobjectArray JNICALL Java_com_meridianmaps_VenueRegistry_nativeVenues(JNIEnv* env, jclass, jlong handle) {
+  return toStringArray(env, registryFrom(handle)->venues());
+}
+
+// In VenueRegistry.STATS_NAMES order
+JNIEXPORT jlongArray JNICALL Java_com_meridianmaps_VenueRegistry_nativeStats(JNIEnv* env, jclass, jlong handle) {
+  const VenueRegistry* registry = registryFrom(handle);
+  const VenueRegistryStats& stats = registry->stats();
+  const jlong counters[] = {
+      static_cast<jlong>(registry->capacity()),
+      static_cast<jlong>(stats.switches),
+      static_cast<jlong>(stats.warmSwitches),
+      static_cast<jlong>(stats.coldSwitches),
+      static_cast<jlong>(stats.evictions),
+  };
+  jlongArray result = env->NewLongArray(5);
+  env->SetLongArrayRegion(result, 0, 5, counters);
+  return result;
+}
+
+}  // extern "C"
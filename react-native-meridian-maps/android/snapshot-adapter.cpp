@@ -0,0 +1,89 @@
+// JNI bindings for com.meridianmaps.ViewportSnapshotStore
+
+#include <jni.h>
+
+#include <android/log.h>
+
+#include <string>
+
+#include "ViewportSnapshot.h"
+
+using meridianmaps::ViewportSnapshot;
+using meridianmaps::ViewportSnapshotStore;
+
+namespace {
+
+constexpr const char* kTag = "ViewportSnapshotStore";
+
+ViewportSnapshotStore* storeFrom(jlong handle) {
+  return reinterpret_cast<ViewportSnapshotStore*>(handle);
+}
+
+std::string toStdString(JNIEnv* env, jstring value) {
+  if (!value) {
+    return std::string();
+  }
+  const char* chars = env->GetStringUTFChars(value, nullptr);
+  std::string result(chars);
+  env->ReleaseStringUTFChars(value, chars);
+  return result;
+}
+
+}  // namespace
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL Java_com_meridianmaps_ViewportSnapshotStore_nativeCreate(JNIEnv* env, jclass,
+                                                                                 jstring directory) {
+  return reinterpret_cast<jlong>(new ViewportSnapshotStore(toStdString(env, directory)));
+}
+
+// viewport is minX, minY, maxX, maxY, rotation, viewWidth and viewHeight
+JNIEXPORT jboolean JNICALL Java_com_meridianmaps_ViewportSnapshotStore_nativeSave(
+    JNIEnv* env, jclass, jlong handle, jstring appId, jstring mapId, jfloatArray viewport, jlong savedAtMs,
+    jbyteArray image) {
+  ViewportSnapshot snapshot;
+  snapshot.appId = toStdString(env, appId);
+  snapshot.mapId = toStdString(env, mapId);
+  jfloat values[7];
+  env->GetFloatArrayRegion(viewport, 0, 7, values);
+  snapshot.visibleRect = {values[0], values[1], values[2], values[3]};
+  snapshot.rotation = values[4];
+  snapshot.viewWidth = values[5];
+  snapshot.viewHeight = values[6];
+  snapshot.savedAtMs = savedAtMs;
+  const jsize length = env->GetArrayLength(image);
+  snapshot.image.resize(static_cast<size_t>(length));
+  env->GetByteArrayRegion(image, 0, length, reinterpret_cast<jbyte*>(&snapshot.image[0]));
+  std::string error;
+  if (!storeFrom(handle)->save(snapshot, &error)) {
+    __android_log_print(ANDROID_LOG_WARN, kTag, "Not saving %s: %s", snapshot.mapId.c_str(), error.c_str());
+    return JNI_FALSE;
+  }
+  return JNI_TRUE;
+}
+
+// The image, with the viewport in nativeSave's order written to viewportOut; null if there is none
+JNIEXPORT jbyteArray JNICALL Java_com_meridianmaps_ViewportSnapshotStore_nativeLoad(
+    JNIEnv* env, jclass, jlong handle, jstring appId, jstring mapId, jlong nowMs, jlong maxAgeMs,
+    jfloatArray viewportOut) {
+  ViewportSnapshot snapshot;
+  if (!storeFrom(handle)->load(toStdString(env, appId), toStdString(env, mapId), nowMs, maxAgeMs, &snapshot)) {
+    return nullptr;
+  }
+  const jfloat values[7] = {
+      snapshot.visibleRect.minX, snapshot.visibleRect.minY, snapshot.visibleRect.maxX, snapshot.visibleRect.maxY,
+      snapshot.rotation,         snapshot.viewWidth,        snapshot.viewHeight,
+  };
+  env->SetFloatArrayRegion(viewportOut, 0, 7, values);
+  jbyteArray result = env->NewByteArray(static_cast<jsize>(snapshot.image.size()));
+  env->SetByteArrayRegion(result, 0, static_cast<jsize>(snapshot.image.size()),
+                          reinterpret_cast<const jbyte*>(snapshot.image.data()));
+  return result;
+}
+
+JNIEXPORT void JNICALL Java_com_meridianmaps_ViewportSnapshotStore_nativeClear(JNIEnv*, jclass, jlong handle) {
+  storeFrom(handle)->clear();
+}
+
+}  // extern "C"
@@ -0,0 +1,136 @@
+package com.meridianmaps
+
+import android.content.Context
+import android.util.Log
+import org.json.JSONException
+import org.json.JSONObject
+import java.io.Closeable
+import java.io.File
+import java.io.IOException
+
+/**
+ * A venue asset bundle (cpp/AssetBundle.h) written by scripts/pack-venue.js.
+ *
+ * The packed placemark pages seed the placemark index offline through
+ * [PlacemarkIndex.seed]. Floors are kept for [read]: the Android SDK loads
+ * them through its own HTTP stack, which has no hook to answer from here.
+ * Thread-safe; reads of one bundle are serialised with [close].
+ */
+class AssetBundle private constructor(
+    private var handle: Long,
+    val path: String,
+    val appId: String,
+    val baseUrl: String,
+    val mapIds: List<String>,
+    // Page size the placemarks were packed with; their URLs depend on it
+    val pageSize: Int
+) : Closeable {
+
+    companion object {
+        private const val TAG = "AssetBundle"
+        private const val MANIFEST_KEY = "meridian:manifest"
+
+        // Order of the native counters
+        private val STATS_NAMES = listOf("assets", "bytes", "served", "bytesServed", "failures")
+
+        init {
+            System.loadLibrary("meridianmaps")
+        }
+
+        /**
+         * The bundle loaded last, if any
+         */
+        @Volatile
+        @JvmStatic
+        var active: AssetBundle? = null
+
+        /**
+         * Maps the bundle at [path]: an absolute file, or the name of an APK
+         * asset, which is copied out once per app install or update since
+         * assets cannot be mapped in place.
+         * @throws IOException if the file is missing, corrupt or has no manifest
+         */
+        @JvmStatic
+        fun open(context: Context, path: String): AssetBundle {
+            val file = if (File(path).isAbsolute) File(path) else extractAsset(context, path)
+            val error = arrayOfNulls<String>(1)
+            val handle = nativeOpen(file.path, error)
+            if (handle == 0L) throw IOException(error[0] ?: "Failed to open asset bundle $path")
+            try {
+                val bytes = nativeRead(handle, MANIFEST_KEY) ?: throw IOException("Asset bundle $path has no manifest")
+                val manifest = JSONObject(String(bytes, Charsets.UTF_8))
+                val maps = manifest.optJSONArray("maps")
+                val mapIds = List(maps?.length() ?: 0) { maps!!.getJSONObject(it).optString("id") }.filter { it.isNotEmpty() }
+                return AssetBundle(
+                    handle,
+                    file.path,
+                    manifest.getString("appId"),
+                    manifest.getString("baseUrl"),
+                    mapIds,
+                    manifest.optInt("pageSize", 0)
+                )
+            } catch (e: JSONException) {
+                nativeClose(handle)
+                throw IOException("Asset bundle $path has no valid manifest", e)
+            } catch (e: IOException) {
+                nativeClose(handle)
+                throw e
+            }
+        }
+
+        private fun extractAsset(context: Context, name: String): File {
+            val target = File(File(context.noBackupFilesDir, "meridianmaps"), name)
+            val installed = context.packageManager.getPackageInfo(context.packageName, 0).lastUpdateTime
+            if (target.exists() && target.lastModified() >= installed) {
+                return target
+            }
+            target.parentFile?.mkdirs()
+            val temporary = File(target.path + ".tmp")
+            context.assets.open(name).use { input -> temporary.outputStream().use { input.copyTo(it) } }
+            if (!temporary.renameTo(target)) {
+                temporary.delete()
+                throw IOException("Failed to extract asset bundle $name")
+            }
+            Log.d(TAG, "Extracted asset bundle $name (${target.length()} bytes)")
+            return target
+        }
+
+        @JvmStatic private external fun nativeOpen(path: String, error: Array<String?>): Long
+        @JvmStatic private external fun nativeClose(handle: Long)
+        @JvmStatic private external fun nativeRead(handle: Long, url: String): ByteArray?
+        @JvmStatic private external fun nativeContains(handle: Long, url: String): Boolean
+        @JvmStatic private external fun nativeStats(handle: Long): LongArray
+    }
+
+    /**
+     * Inflated bytes for [url] (or [url] without its query), or null
+     */
+    @Synchronized
+    fun read(url: String): ByteArray? = if (handle != 0L) nativeRead(handle, url) else null
+
+    @Synchronized
+    fun contains(url: String): Boolean = handle != 0L && nativeContains(handle, url)
+
+    /**
+     * Serves the packed placemark pages to a placemark sync, offline
+     */
+    fun fetcher() = PlacemarkStore.HttpFetcher { url, _ ->
+        read(url)?.let { PlacemarkStore.HttpResult(200, it, null) }
+            ?: PlacemarkStore.HttpResult(0, ByteArray(0), null, "not in the asset bundle: $url")
+    }
+
+    /**
+     * assets and bytes of the bundle, then served, bytesServed and failures
+     */
+    @Synchronized
+    fun stats(): Map<String, Long> =
+        if (handle != 0L) STATS_NAMES.zip(nativeStats(handle).toList()).toMap() else emptyMap()
+
+    @Synchronized
+    override fun close() {
+        if (handle != 0L) {
+            nativeClose(handle)
+            handle = 0L
+        }
+    }
+}
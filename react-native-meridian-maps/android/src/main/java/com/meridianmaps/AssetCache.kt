@@ -0,0 +1,136 @@
+package com.meridianmaps
+
+import android.content.ComponentCallbacks2
+import android.content.Context
+import android.content.res.Configuration
+import android.util.Log
+import java.io.File
+import java.io.IOException
+import java.net.HttpURLConnection
+import java.net.URL
+
+/**
+ * Process-wide disk cache of floor assets (cpp/AssetCache.h): map SVGs and
+ * images and placemark images, under cacheDir/meridianmaps/assets.
+ *
+ * The Android SDK downloads floors through its own HTTP stack, which has no
+ * hook to answer from here, so the cache serves the assets this library
+ * fetches itself through [fetch]. Recency is written to disk when the app's
+ * UI is hidden. Thread-safe.
+ */
+object AssetCache : ComponentCallbacks2 {
+    private const val TAG = "AssetCache"
+    const val DEFAULT_MAX_BYTES = 100L shl 20
+
+    // Order of the native counters
+    private val STATS_NAMES = listOf(
+        "assets", "bytes", "maxBytes", "hits", "bytesServed", "misses",
+        "stores", "dedupStores", "evictions", "bytesEvicted"
+    )
+
+    init {
+        System.loadLibrary("meridianmaps")
+    }
+
+    @Volatile
+    private var handle = 0L
+
+    /**
+     * Opens the cache directory; idempotent
+     */
+    @JvmStatic
+    @Synchronized
+    fun attach(context: Context) {
+        if (handle != 0L) return
+        val directory = File(File(context.cacheDir, "meridianmaps"), "assets")
+        directory.parentFile?.mkdirs()
+        val error = arrayOfNulls<String>(1)
+        handle = nativeCreate(directory.path, DEFAULT_MAX_BYTES, error)
+        if (handle == 0L) {
+            Log.w(TAG, "Failed to open ${directory.path}: ${error[0]}")
+            return
+        }
+        context.applicationContext.registerComponentCallbacks(this)
+    }
+
+    /**
+     * Budget in bytes; lowering it evicts the least recently used assets at once
+     */
+    var maxBytes: Long
+        get() = if (handle != 0L) nativeStats(handle)[2] else DEFAULT_MAX_BYTES
+        set(value) {
+            if (handle != 0L) nativeSetMaxBytes(handle, value.coerceAtLeast(0L))
+        }
+
+    @JvmStatic
+    fun contains(url: String): Boolean = handle != 0L && nativeContains(handle, url)
+
+    @JvmStatic
+    fun get(url: String): ByteArray? = if (handle != 0L) nativeGet(handle, url) else null
+
+    @JvmStatic
+    fun put(url: String, contentType: String?, bytes: ByteArray): Boolean =
+        handle != 0L && nativePut(handle, url, contentType ?: "", bytes)
+
+    /**
+     * Blocking GET of [url] answered from the cache, else from the network,
+     * storing 200 responses. Null if neither has it.
+     */
+    @JvmStatic
+    fun fetch(url: String): ByteArray? {
+        get(url)?.let { return it }
+        var connection: HttpURLConnection? = null
+        return try {
+            connection = (URL(url).openConnection() as HttpURLConnection).apply {
+                // Kept here; the HTTP cache would hold a second copy
+                useCaches = false
+                connectTimeout = 15_000
+                readTimeout = 30_000
+            }
+            if (connection.responseCode != HttpURLConnection.HTTP_OK) {
+                Log.d(TAG, "Not caching $url: HTTP ${connection.responseCode}")
+                return null
+            }
+            val body = connection.inputStream.use { it.readBytes() }
+            put(url, connection.contentType, body)
+            body
+        } catch (e: IOException) {
+            Log.d(TAG, "Failed to fetch $url: ${e.message}")
+            null
+        } finally {
+            connection?.disconnect()
+        }
+    }
+
+    @JvmStatic
+    fun clear() {
+        if (handle != 0L) nativeClear(handle)
+    }
+
+    /**
+     * assets, bytes and maxBytes of the cache, then hits, bytesServed, misses,
+     * stores, dedupStores, evictions and bytesEvicted since launch
+     */
+    @JvmStatic
+    fun stats(): Map<String, Long> =
+        if (handle != 0L) STATS_NAMES.zip(nativeStats(handle).toList()).toMap() else emptyMap()
+
+    override fun onTrimMemory(level: Int) {
+        if (level >= ComponentCallbacks2.TRIM_MEMORY_UI_HIDDEN && handle != 0L) {
+            nativeFlush(handle)
+        }
+    }
+
+    override fun onLowMemory() {}
+
+    override fun onConfigurationChanged(newConfig: Configuration) {}
+
+    @JvmStatic private external fun nativeCreate(directory: String, maxBytes: Long, error: Array<String?>): Long
+    @JvmStatic private external fun nativeSetMaxBytes(handle: Long, maxBytes: Long)
+    @JvmStatic private external fun nativeGet(handle: Long, url: String): ByteArray?
+    @JvmStatic private external fun nativePut(handle: Long, url: String, contentType: String, bytes: ByteArray): Boolean
+    @JvmStatic private external fun nativeContains(handle: Long, url: String): Boolean
+    @JvmStatic private external fun nativeClear(handle: Long)
+    @JvmStatic private external fun nativeFlush(handle: Long)
+    @JvmStatic private external fun nativeStats(handle: Long): LongArray
+}
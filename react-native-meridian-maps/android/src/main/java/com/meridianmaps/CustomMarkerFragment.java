@@ -67,8 +67,8 @@ public class CustomMarkerFragment extends MapFragment {
      */
     @Override
     public Marker markerForSelectedMarker(Marker markerToSelect) {
-        if (markerToSelect instanceof RandMarker && getContext() != null)
-            return new RandSelectedMarker(getContext(), markerToSelect);
+        if (markerToSelect instanceof RandMarker)
+            return new RandSelectedMarker((RandMarker) markerToSelect);
         return super.markerForSelectedMarker(markerToSelect);
     }
 
@@ -107,14 +107,17 @@ public class CustomMarkerFragment extends MapFragment {
             }
         }
 
-        // Create 20 random Markers
+        // Create 20 random Markers, sharing one decoded icon; the map asks for
+        // a marker's bitmap every time it draws it
         Random random = new Random(18923501986340L);
         ArrayList<Marker> markerList = new ArrayList<>();
+        Context c = getActivity();
+        Bitmap icon = c != null ? BitmapFactory.decodeResource(c.getResources(), R.drawable.ic_launcher) : null;
+        Bitmap dropShadow = c != null ? BitmapFactory.decodeResource(c.getResources(), R.drawable.selected_beacon) : null;
         for(int i=0;i<20;i++) {
-            Context c = getActivity();
             if (c == null) break;
             if (getMapView() != null) {
-                RandMarker marker = new RandMarker(getActivity(), getMapView().getMapInfo(), random);
+                RandMarker marker = new RandMarker(icon, dropShadow, getMapView().getMapInfo(), random);
                 marker.setName("Custom marker " + i);
                 markerList.add(marker);
             }
@@ -132,17 +135,19 @@ public class CustomMarkerFragment extends MapFragment {
      */
     private static class RandMarker extends Marker{
 
-        private final Context appContext;
-        public RandMarker(@NonNull Context context, @NonNull MapInfo mapInfo, @NonNull Random random){
+        private final Bitmap icon;
+        private final Bitmap dropShadow;
+        public RandMarker(@NonNull Bitmap icon, @NonNull Bitmap dropShadow, @NonNull MapInfo mapInfo, @NonNull Random random){
             super(random.nextInt((int)mapInfo.getWidth()),random.nextInt((int)mapInfo.getHeight()));
-            this.appContext = context.getApplicationContext();
+            this.icon = icon;
+            this.dropShadow = dropShadow;
             setWeight(2.1f);
             // Enable this to allow the custom markers to be dragged and dropped on the map
             //setDragDropEnabled(true);
         }
         @Override
         public Bitmap getBitmap() {
-            return BitmapFactory.decodeResource(appContext.getResources(), R.drawable.ic_launcher);
+            return icon;
         }
 
         /**
@@ -152,7 +157,7 @@ public class CustomMarkerFragment extends MapFragment {
          */
         @Override
         public Bitmap getDropShadowBitmap() {
-            return BitmapFactory.decodeResource(appContext.getResources(), R.drawable.selected_beacon);
+            return dropShadow;
         }
     }
 
@@ -162,11 +167,11 @@ public class CustomMarkerFragment extends MapFragment {
      */
     private static class RandSelectedMarker extends Marker {
 
-        private final Context appContext;
+        private final Bitmap icon;
 
-        public RandSelectedMarker(@NonNull Context context, @NonNull Marker baseMarker) {
+        public RandSelectedMarker(@NonNull RandMarker baseMarker) {
             super(baseMarker.getPosition()[0], baseMarker.getPosition()[1]);
-            this.appContext = context.getApplicationContext();
+            this.icon = baseMarker.icon;
             setWeight(3.1f);
             setXScale(1.5f);
             setYScale(1.5f);
@@ -174,7 +179,7 @@ public class CustomMarkerFragment extends MapFragment {
 
         @Override
         public Bitmap getBitmap() {
-            return BitmapFactory.decodeResource(appContext.getResources(), R.drawable.ic_launcher);
+            return icon;
         }
 
         @Override
@@ -0,0 +1,215 @@
+package com.meridianmaps
+
+import com.arubanetworks.meridian.editor.Placemark
+import com.facebook.react.bridge.ReadableArray
+import com.facebook.react.bridge.ReadableMap
+import com.facebook.react.bridge.ReadableType
+import java.io.Closeable
+
+/**
+ * Kotlin handle on the shared C++ geofence engine (cpp/GeofenceEngine.h).
+ *
+ * A geofence is a map with an id and either a polygon ([{x, y}]) and mapKey, or a
+ * placemarkId. Placemark geofences wait until the placemark's floor loads and then
+ * become a circle of radius around its point, as the SDK does not expose placemark
+ * areas here. hysteresis and dwellMs are optional. Main thread only; a closed
+ * engine reports no transitions.
+ */
+class GeofenceEngine : Closeable {
+
+    data class Transition(val type: String, val id: String, val timestamp: Long)
+
+    // A placemark geofence until its placemark loads
+    private class Pending(
+        val id: String,
+        val placemarkId: String,
+        val radius: Float,
+        val hysteresis: Float,
+        val dwellMs: Long
+    )
+
+    private class Polygon(
+        val id: String,
+        val mapKey: String,
+        val vertices: FloatArray,
+        val hysteresis: Float,
+        val dwellMs: Long
+    )
+
+    private var handle: Long = nativeCreate()
+    private val pending = LinkedHashMap<String, Pending>()
+
+    /** Geofences registered, including the ones waiting for their placemark */
+    val size: Int
+        get() = (if (handle != 0L) nativeSize(handle) else 0) + pending.size
+
+    /**
+     * Adds or replaces every geofence, or none of them if one is invalid
+     */
+    @Throws(IllegalArgumentException::class)
+    fun add(geofences: ReadableArray) {
+        fun string(map: ReadableMap, key: String): String? =
+            if (map.hasKey(key) && map.getType(key) == ReadableType.String) map.getString(key)?.takeIf { it.isNotEmpty() } else null
+        fun number(map: ReadableMap, key: String): Double? =
+            if (map.hasKey(key) && map.getType(key) == ReadableType.Number) map.getDouble(key) else null
+
+        // Check them all before touching the engine
+        val polygons = ArrayList<Polygon>()
+        val placemarks = ArrayList<Pending>()
+        for (i in 0 until geofences.size()) {
+            val geofence = geofences.getMap(i) ?: throw IllegalArgumentException("A geofence must be an object")
+            val placemarkId = string(geofence, "placemarkId")
+            val id = string(geofence, "id") ?: placemarkId ?: throw IllegalArgumentException("A geofence needs an id")
+            val hysteresis = number(geofence, "hysteresis")?.toFloat() ?: 0f
+            val dwellMs = number(geofence, "dwellMs")?.toLong() ?: 0L
+            val polygon = if (geofence.hasKey("polygon") && geofence.getType("polygon") == ReadableType.Array) {
+                geofence.getArray("polygon")
+            } else {
+                null
+            }
+            if (polygon != null) {
+                val mapKey = string(geofence, "mapKey")
+                    ?: throw IllegalArgumentException("Geofence $id needs the mapKey of its polygon")
+                // The engine's own rules, so a bad polygon cannot leave the batch half added
+                if (polygon.size() < 3) throw IllegalArgumentException("Geofence $id needs at least 3 vertices")
+                val vertices = FloatArray(polygon.size() * 2)
+                for (v in 0 until polygon.size()) {
+                    val vertex = polygon.getMap(v)
+                    val x = vertex?.let { number(it, "x") }
+                    val y = vertex?.let { number(it, "y") }
+                    if (x == null || y == null || !x.isFinite() || !y.isFinite()) {
+                        throw IllegalArgumentException("Geofence $id has a vertex without x and y")
+                    }
+                    vertices[v * 2] = x.toFloat()
+                    vertices[v * 2 + 1] = y.toFloat()
+                }
+                polygons.add(Polygon(id, mapKey, vertices, hysteresis, dwellMs))
+            } else if (placemarkId != null) {
+                val radius = number(geofence, "radius")?.toFloat() ?: DEFAULT_PLACEMARK_RADIUS
+                placemarks.add(Pending(id, placemarkId, radius, hysteresis, dwellMs))
+            } else {
+                throw IllegalArgumentException("Geofence $id needs a polygon or a placemarkId")
+            }
+        }
+
+        if (handle == 0L) return
+        val error = arrayOfNulls<String>(1)
+        for (polygon in polygons) {
+            pending.remove(polygon.id)
+            nativeAdd(handle, polygon.id, polygon.mapKey, polygon.vertices, polygon.hysteresis, polygon.dwellMs, error)
+        }
+        for (placemark in placemarks) {
+            nativeRemove(handle, placemark.id)
+            pending[placemark.id] = placemark
+        }
+    }
+
+    /**
+     * Forgets the geofences without reporting exits; null forgets all of them
+     */
+    fun remove(ids: ReadableArray?) {
+        if (ids == null) {
+            pending.clear()
+            if (handle != 0L) nativeClear(handle)
+            return
+        }
+        for (i in 0 until ids.size()) {
+            if (ids.getType(i) != ReadableType.String) continue
+            val id = ids.getString(i) ?: continue
+            pending.remove(id)
+            if (handle != 0L) nativeRemove(handle, id)
+        }
+    }
+
+    /**
+     * Resolves the waiting geofences whose placemark is among these
+     */
+    fun resolvePlacemarks(placemarks: Iterable<Placemark>) {
+        if (pending.isEmpty() || handle == 0L) return
+        val waiting = pending.values.mapTo(HashSet()) { it.placemarkId }
+        val byId = HashMap<String, Placemark>()
+        for (placemark in placemarks) {
+            val id = placemark.key?.id ?: continue
+            if (id in waiting && placemark.key.parent != null) {
+                byId[id] = placemark
+            }
+        }
+        if (byId.isEmpty()) return
+
+        val error = arrayOfNulls<String>(1)
+        val iterator = pending.values.iterator()
+        while (iterator.hasNext()) {
+            val geofence = iterator.next()
+            val placemark = byId[geofence.placemarkId] ?: continue
+            iterator.remove()
+            nativeAddCircle(
+                handle, geofence.id, placemark.key.parent.id, placemark.x, placemark.y,
+                geofence.radius, geofence.hysteresis, geofence.dwellMs, error
+            )
+        }
+    }
+
+    /**
+     * The transitions the fix causes, exits first
+     */
+    fun update(fix: LocationFix): List<Transition> {
+        if (handle == 0L) return emptyList()
+        val values = nativeUpdate(handle, fix.mapKey, fix.x, fix.y, fix.accuracy, fix.timestamp, fix.providerType)
+            ?: return emptyList()
+        return List(values.size / 2) { Transition(values[it * 2], values[it * 2 + 1], fix.timestamp) }
+    }
+
+    override fun close() {
+        pending.clear()
+        if (handle != 0L) {
+            nativeDestroy(handle)
+            handle = 0L
+        }
+    }
+
+    companion object {
+        // Radius in map units of a placemark geofence
+        const val DEFAULT_PLACEMARK_RADIUS = 10f
+
+        init {
+            System.loadLibrary("meridianmaps")
+        }
+
+        @JvmStatic private external fun nativeCreate(): Long
+        @JvmStatic private external fun nativeDestroy(handle: Long)
+        @JvmStatic private external fun nativeSize(handle: Long): Int
+        // Vertices as x0, y0, x1, y1, ...
+        @JvmStatic private external fun nativeAdd(
+            handle: Long,
+            id: String,
+            mapKey: String,
+            vertices: FloatArray,
+            hysteresis: Float,
+            dwellMs: Long,
+            errorOut: Array<String?>
+        ): Boolean
+        @JvmStatic private external fun nativeAddCircle(
+            handle: Long,
+            id: String,
+            mapKey: String,
+            x: Float,
+            y: Float,
+            radius: Float,
+            hysteresis: Float,
+            dwellMs: Long,
+            errorOut: Array<String?>
+        ): Boolean
+        @JvmStatic private external fun nativeRemove(handle: Long, id: String): Boolean
+        @JvmStatic private external fun nativeClear(handle: Long)
+        // Type ("enter", "exit" or "dwell") and id of each transition, or null for none
+        @JvmStatic private external fun nativeUpdate(
+            handle: Long,
+            mapKey: String,
+            x: Double,
+            y: Double,
+            accuracy: Double,
+            timestampMs: Long,
+            providerType: Int
+        ): Array<String>?
+    }
+}
@@ -0,0 +1,270 @@
+package com.meridianmaps
+
+import android.content.Context
+import android.hardware.Sensor
+import android.hardware.SensorEvent
+import android.hardware.SensorEventListener
+import android.hardware.SensorManager
+import android.os.Handler
+import android.os.Looper
+import android.os.SystemClock
+import com.facebook.react.bridge.ReadableMap
+import java.io.Closeable
+import java.util.Collections
+import java.util.WeakHashMap
+
+/**
+ * Shared accelerometer watcher telling moving from still (cpp/LocationDutyCycle.h).
+ * The accelerometer only runs while someone listens; without one, or without an
+ * accelerometer, the device always counts as moving. Main thread only.
+ */
+object MotionMonitor : SensorEventListener {
+
+    fun interface Listener {
+        fun onMovingChanged(moving: Boolean)
+    }
+
+    // Enough to catch someone picking the device up
+    private const val SAMPLE_PERIOD_US = 100_000
+
+    private val listeners = Collections.newSetFromMap(WeakHashMap<Listener, Boolean>())
+    private var sensorManager: SensorManager? = null
+    private var sampling = false
+    private var handle = 0L
+
+    val isMoving get() = handle == 0L || nativeMoving(handle)
+
+    init {
+        System.loadLibrary("meridianmaps")
+    }
+
+    /**
+     * Listeners are held weakly
+     */
+    fun addListener(context: Context, listener: Listener) {
+        listeners.add(listener)
+        if (sampling) return
+        val manager = sensorManager
+            ?: (context.applicationContext.getSystemService(Context.SENSOR_SERVICE) as? SensorManager)?.also { sensorManager = it }
+        val accelerometer = manager?.getDefaultSensor(Sensor.TYPE_ACCELEROMETER) ?: return
+        if (handle == 0L) handle = nativeCreate()
+        sampling = manager.registerListener(this, accelerometer, SAMPLE_PERIOD_US, Handler(Looper.getMainLooper()))
+    }
+
+    fun removeListener(listener: Listener) {
+        listeners.remove(listener)
+        if (listeners.isEmpty() && sampling) {
+            sensorManager?.unregisterListener(this)
+            sampling = false
+            // Moving until the next listener's samples say otherwise
+            nativeReset(handle)
+        }
+    }
+
+    override fun onSensorChanged(event: SensorEvent) {
+        val values = event.values
+        val changed = nativeAddSample(
+            handle,
+            values[0] / SensorManager.GRAVITY_EARTH.toDouble(),
+            values[1] / SensorManager.GRAVITY_EARTH.toDouble(),
+            values[2] / SensorManager.GRAVITY_EARTH.toDouble(),
+            SystemClock.uptimeMillis()
+        )
+        if (!changed) return
+        val moving = nativeMoving(handle)
+        for (listener in listeners.toList()) {
+            listener.onMovingChanged(moving)
+        }
+    }
+
+    override fun onAccuracyChanged(sensor: Sensor?, accuracy: Int) {}
+
+    @JvmStatic private external fun nativeCreate(): Long
+    // Acceleration in g; returns true when the moving state changed
+    @JvmStatic private external fun nativeAddSample(handle: Long, x: Double, y: Double, z: Double, timestampMs: Long): Boolean
+    @JvmStatic private external fun nativeMoving(handle: Long): Boolean
+    @JvmStatic private external fun nativeReset(handle: Long)
+}
+
+/**
+ * Kotlin handle on the shared C++ location duty cycle (cpp/LocationDutyCycle.h):
+ * pauses a view's positioning while the device is still or the view is hidden,
+ * and resumes it on motion. [onRunningChanged] is told when positioning should
+ * start or stop. Listens to [MotionMonitor] only while enabled. Main thread only.
+ */
+class LocationDutyCycle(
+    private val context: Context,
+    private val onRunningChanged: (Boolean) -> Unit
+) : Closeable, MotionMonitor.Listener {
+
+    data class Options(
+        val enabled: Boolean = false,
+        val stillDelayMs: Long = 30_000L,
+        val stillPollIntervalMs: Long = 120_000L,
+        val pollTimeoutMs: Long = 10_000L,
+        val pauseWhenHidden: Boolean = true
+    ) {
+        companion object {
+            @JvmStatic
+            fun fromMap(map: ReadableMap?): Options {
+                val defaults = Options()
+                if (map == null) return defaults
+                fun has(key: String) = map.hasKey(key) && !map.isNull(key)
+                return Options(
+                    enabled = has("enabled") && map.getBoolean("enabled"),
+                    stillDelayMs = if (has("stillDelayMs")) map.getDouble("stillDelayMs").toLong() else defaults.stillDelayMs,
+                    stillPollIntervalMs =
+                        if (has("stillPollIntervalMs")) map.getDouble("stillPollIntervalMs").toLong() else defaults.stillPollIntervalMs,
+                    pollTimeoutMs = if (has("pollTimeoutMs")) map.getDouble("pollTimeoutMs").toLong() else defaults.pollTimeoutMs,
+                    pauseWhenHidden = if (has("pauseWhenHidden")) map.getBoolean("pauseWhenHidden") else defaults.pauseWhenHidden
+                )
+            }
+        }
+    }
+
+    private var handle: Long = nativeCreate(SystemClock.uptimeMillis())
+    private val handler = Handler(Looper.getMainLooper())
+    private val updateRunnable = Runnable {
+        timerDueMs = NO_TIMER
+        step { nativeUpdate(handle, SystemClock.uptimeMillis()) }
+    }
+    private var timerDueMs = NO_TIMER
+    private var listening = false
+
+    var isRunning = true
+        private set
+
+    init {
+        synchronized(live) { live.add(this) }
+    }
+
+    fun setOptions(options: Options) {
+        if (handle == 0L) return
+        // Only adaptive views keep the accelerometer running
+        if (options.enabled && !listening) {
+            MotionMonitor.addListener(context, this)
+            listening = true
+        } else if (!options.enabled && listening) {
+            MotionMonitor.removeListener(this)
+            listening = false
+        }
+        val now = SystemClock.uptimeMillis()
+        step {
+            nativeSetMoving(handle, MotionMonitor.isMoving, now)
+            nativeSetOptions(
+                handle, options.enabled, options.stillDelayMs, options.stillPollIntervalMs, options.pollTimeoutMs,
+                options.pauseWhenHidden, now
+            )
+        }
+    }
+
+    /**
+     * On screen with the app in the foreground
+     */
+    fun setVisible(visible: Boolean) {
+        if (handle == 0L) return
+        step { nativeSetVisible(handle, visible, SystemClock.uptimeMillis()) }
+    }
+
+    /**
+     * A fix from the location provider
+     */
+    fun recordFix() {
+        if (handle == 0L) return
+        step { nativeRecordFix(handle, SystemClock.uptimeMillis()) }
+    }
+
+    override fun onMovingChanged(moving: Boolean) {
+        if (handle == 0L) return
+        step { nativeSetMoving(handle, moving, SystemClock.uptimeMillis()) }
+    }
+
+    // Runs a change, tells the listener if running flipped and re-arms the timer
+    private inline fun step(change: () -> Boolean) {
+        val running = change()
+        scheduleUpdate()
+        if (running != isRunning) {
+            isRunning = running
+            onRunningChanged(running)
+        }
+    }
+
+    private fun scheduleUpdate() {
+        val due = nativeNextUpdateMs(handle)
+        // Most changes, such as fixes while active, leave the deadline alone
+        if (due == timerDueMs) return
+        handler.removeCallbacks(updateRunnable)
+        timerDueMs = due
+        if (due == NO_TIMER) return
+        handler.postAtTime(updateRunnable, due)
+    }
+
+    private fun counters(): LongArray =
+        if (handle != 0L) nativeStats(handle, SystemClock.uptimeMillis()) else LongArray(STATS_NAMES.size)
+
+    override fun close() {
+        if (handle == 0L) return
+        handler.removeCallbacks(updateRunnable)
+        if (listening) {
+            MotionMonitor.removeListener(this)
+            listening = false
+        }
+        // The native side keeps its counters for totalStats
+        synchronized(live) {
+            live.remove(this)
+            nativeDestroy(handle, SystemClock.uptimeMillis())
+            handle = 0L
+        }
+    }
+
+    companion object {
+        // Order of the native counters
+        private val STATS_NAMES = listOf("activeMs", "pollingMs", "pausedMs", "fixes", "pauses", "motionResumes", "polls")
+        private const val NO_TIMER = Long.MAX_VALUE
+
+        private val live = HashSet<LocationDutyCycle>()
+
+        init {
+            System.loadLibrary("meridianmaps")
+        }
+
+        /**
+         * activeMs, pollingMs, pausedMs, fixes, pauses, motionResumes and polls
+         * summed over every duty cycle of the process, including closed ones
+         */
+        @JvmStatic
+        fun totalStats(): Map<String, Long> {
+            // Called from the JS thread; the lock keeps views from closing mid-sum
+            val total = synchronized(live) {
+                val total = nativeRetiredStats()
+                for (cycle in live) {
+                    val counters = cycle.counters()
+                    for (i in total.indices) total[i] += counters[i]
+                }
+                total
+            }
+            return STATS_NAMES.zip(total.toList()).toMap()
+        }
+
+        // Each call returns whether positioning should run afterwards
+        @JvmStatic private external fun nativeCreate(nowMs: Long): Long
+        @JvmStatic private external fun nativeDestroy(handle: Long, nowMs: Long)
+        @JvmStatic private external fun nativeSetOptions(
+            handle: Long,
+            enabled: Boolean,
+            stillDelayMs: Long,
+            stillPollIntervalMs: Long,
+            pollTimeoutMs: Long,
+            pauseWhenHidden: Boolean,
+            nowMs: Long
+        ): Boolean
+        @JvmStatic private external fun nativeSetMoving(handle: Long, moving: Boolean, nowMs: Long): Boolean
+        @JvmStatic private external fun nativeSetVisible(handle: Long, visible: Boolean, nowMs: Long): Boolean
+        @JvmStatic private external fun nativeRecordFix(handle: Long, nowMs: Long): Boolean
+        @JvmStatic private external fun nativeUpdate(handle: Long, nowMs: Long): Boolean
+        // Long.MAX_VALUE when no timer is needed
+        @JvmStatic private external fun nativeNextUpdateMs(handle: Long): Long
+        @JvmStatic private external fun nativeStats(handle: Long, nowMs: Long): LongArray
+        @JvmStatic private external fun nativeRetiredStats(): LongArray
+    }
+}
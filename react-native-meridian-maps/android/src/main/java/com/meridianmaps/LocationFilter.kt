@@ -0,0 +1,106 @@
+package com.meridianmaps
+
+import com.arubanetworks.meridian.location.MeridianLocation
+import java.io.Closeable
+
+/**
+ * A location fix on its way to JS, smoothed or as reported. [velocityX],
+ * [velocityY] and [speed] are in map units per second and only set on smoothed
+ * fixes; [heading] is in degrees clockwise from map up and null until known.
+ */
+data class LocationFix(
+    val x: Double,
+    val y: Double,
+    val rawX: Double,
+    val rawY: Double,
+    val accuracy: Double,
+    val timestamp: Long,
+    val mapKey: String,
+    val providerType: Int = 0,
+    val velocityX: Double? = null,
+    val velocityY: Double? = null,
+    val speed: Double? = null,
+    val heading: Double? = null
+) {
+    companion object {
+        /**
+         * The fix as reported, or null if it has no position. The Android SDK location
+         * has no accuracy, provider or fix time to offer, so arrival time stands in.
+         */
+        @JvmStatic
+        fun fromLocation(location: MeridianLocation): LocationFix? {
+            val point = location.point ?: return null
+            val x = point.x.toDouble()
+            val y = point.y.toDouble()
+            return LocationFix(x, y, x, y, 0.0, System.currentTimeMillis(), location.mapKey?.id ?: "")
+        }
+    }
+}
+
+/**
+ * Kotlin handle on the shared C++ location filter (cpp/LocationFilter.h): a
+ * constant-velocity Kalman filter that smooths fixes and estimates velocity
+ * and heading. Starts over on a floor change. Main thread only; a closed or
+ * disabled filter passes fixes through.
+ */
+class LocationFilter : Closeable {
+
+    private var handle: Long = nativeCreate()
+
+    var enabled = true
+        set(value) {
+            if (value != field && handle != 0L) nativeReset(handle)
+            field = value
+        }
+
+    /**
+     * Smooth a reported fix; without accuracy the filter uses its default measurement noise
+     */
+    fun filter(fix: LocationFix): LocationFix {
+        if (!enabled || handle == 0L) return fix
+        val estimate = nativeUpdate(handle, fix.mapKey, fix.rawX, fix.rawY, fix.accuracy, fix.timestamp, fix.providerType)
+        return fix.copy(
+            x = estimate[0],
+            y = estimate[1],
+            accuracy = estimate[2],
+            velocityX = estimate[3],
+            velocityY = estimate[4],
+            speed = estimate[5],
+            heading = estimate[6].takeUnless { it.isNaN() }
+        )
+    }
+
+    /**
+     * Forget the current track
+     */
+    fun reset() {
+        if (handle != 0L) nativeReset(handle)
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeDestroy(handle)
+            handle = 0L
+        }
+    }
+
+    companion object {
+        init {
+            System.loadLibrary("meridianmaps")
+        }
+
+        @JvmStatic private external fun nativeCreate(): Long
+        @JvmStatic private external fun nativeDestroy(handle: Long)
+        @JvmStatic private external fun nativeReset(handle: Long)
+        // x, y, accuracy, velocity x, velocity y, speed, heading (NaN when unknown)
+        @JvmStatic private external fun nativeUpdate(
+            handle: Long,
+            mapKey: String,
+            x: Double,
+            y: Double,
+            accuracy: Double,
+            timestampMs: Long,
+            providerType: Int
+        ): DoubleArray
+    }
+}
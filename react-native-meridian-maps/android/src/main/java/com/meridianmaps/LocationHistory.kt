@@ -0,0 +1,127 @@
+package com.meridianmaps
+
+import com.facebook.react.bridge.Arguments
+import com.facebook.react.bridge.ReadableMap
+import com.facebook.react.bridge.WritableMap
+import java.io.Closeable
+
+/**
+ * Kotlin handle on the shared C++ location history (cpp/LocationHistory.h):
+ * recent fixes delta-encoded in a fixed-size ring buffer. Main thread only; a
+ * closed history is empty and ignores new fixes.
+ */
+class LocationHistory(capacityBytes: Int = DEFAULT_CAPACITY_BYTES) : Closeable {
+
+    private var handle: Long = nativeCreate(capacityBytes)
+
+    /**
+     * Bytes of encoded fixes to keep; shrinking keeps the newest fixes
+     */
+    fun setCapacity(capacityBytes: Int) {
+        if (handle == 0L) return
+        nativeSetCapacity(handle, capacityBytes)
+    }
+
+    fun append(fix: LocationFix) {
+        if (handle == 0L) return
+        nativeAppend(handle, fix.mapKey, fix.x, fix.y, fix.accuracy, fix.timestamp, fix.providerType)
+    }
+
+    /**
+     * Fixes matching since, until (ms since the epoch), mapKey and bbox
+     * ({minX, minY, maxX, maxY}), downsampled to maxPoints; missing keys match
+     * everything. Resolves to points, oldest first, and how many matched.
+     */
+    fun query(options: ReadableMap?): WritableMap {
+        fun number(map: ReadableMap?, key: String): Double? =
+            if (map != null && map.hasKey(key) && !map.isNull(key)) map.getDouble(key) else null
+
+        val bbox = if (options != null && options.hasKey("bbox") && !options.isNull("bbox")) options.getMap("bbox") else null
+        val mapKey = if (options != null && options.hasKey("mapKey") && !options.isNull("mapKey")) options.getString("mapKey") else null
+        val points = Arguments.createArray()
+        var matched = 0
+        if (handle != 0L) {
+            val values = nativeQuery(
+                handle,
+                number(options, "since")?.toLong() ?: Long.MIN_VALUE,
+                number(options, "until")?.toLong() ?: Long.MAX_VALUE,
+                mapKey.orEmpty(),
+                bbox != null,
+                number(bbox, "minX") ?: 0.0,
+                number(bbox, "minY") ?: 0.0,
+                number(bbox, "maxX") ?: 0.0,
+                number(bbox, "maxY") ?: 0.0,
+                (number(options, "maxPoints") ?: 0.0).coerceAtLeast(0.0).toInt()
+            )
+            val mapKeys = nativeResultMapKeys(handle)
+            matched = values[0].toInt()
+            var offset = 1
+            while (offset < values.size) {
+                points.pushMap(Arguments.createMap().apply {
+                    putDouble("x", values[offset])
+                    putDouble("y", values[offset + 1])
+                    putDouble("accuracy", values[offset + 2])
+                    putDouble("timestamp", values[offset + 3])
+                    putString("mapKey", mapKeys.getOrElse(values[offset + 4].toInt()) { "" })
+                })
+                offset += POINT_STRIDE
+            }
+        }
+        return Arguments.createMap().apply {
+            putArray("points", points)
+            putInt("matched", matched)
+        }
+    }
+
+    fun clear() {
+        if (handle == 0L) return
+        nativeClear(handle)
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeDestroy(handle)
+            handle = 0L
+        }
+    }
+
+    companion object {
+        // Until JS sets locationHistoryBytes; about 10,000 walking fixes
+        const val DEFAULT_CAPACITY_BYTES = 64 * 1024
+        // Values per point from nativeQuery, after the leading match count:
+        // x, y, accuracy, timestamp, mapKey index
+        private const val POINT_STRIDE = 5
+
+        init {
+            System.loadLibrary("meridianmaps")
+        }
+
+        @JvmStatic private external fun nativeCreate(capacityBytes: Int): Long
+        @JvmStatic private external fun nativeDestroy(handle: Long)
+        @JvmStatic private external fun nativeSetCapacity(handle: Long, capacityBytes: Int)
+        @JvmStatic private external fun nativeAppend(
+            handle: Long,
+            mapKey: String,
+            x: Double,
+            y: Double,
+            accuracy: Double,
+            timestampMs: Long,
+            providerType: Int
+        )
+        @JvmStatic private external fun nativeQuery(
+            handle: Long,
+            sinceMs: Long,
+            untilMs: Long,
+            mapKey: String,
+            hasBounds: Boolean,
+            minX: Double,
+            minY: Double,
+            maxX: Double,
+            maxY: Double,
+            maxPoints: Int
+        ): DoubleArray
+        // Map keys the last nativeQuery's points index into
+        @JvmStatic private external fun nativeResultMapKeys(handle: Long): Array<String>
+        @JvmStatic private external fun nativeClear(handle: Long)
+    }
+}
@@ -0,0 +1,175 @@
+package com.meridianmaps
+
+import android.os.Handler
+import android.os.Looper
+import android.os.SystemClock
+import com.facebook.react.bridge.ReadableMap
+import java.io.Closeable
+
+/**
+ * Kotlin handle on the shared C++ location throttle (cpp/LocationThrottle.h).
+ *
+ * Offered fixes reach [deliver] only when they are meaningful and the rate
+ * limit allows; a held fix is released from the main looper, newest first.
+ * Main thread only; a closed throttle drops everything.
+ */
+class LocationThrottle(private val deliver: (LocationFix) -> Unit) : Closeable {
+
+    /**
+     * Gates from the view's locationUpdateOptions prop; 0 turns a gate off
+     */
+    data class Options(
+        val maxRateHz: Double = 0.0,
+        val minDisplacement: Double = 0.0,
+        val minAccuracyImprovement: Double = 0.0,
+        val coalesceWindowMs: Long = 0L
+    ) {
+        companion object {
+            @JvmStatic
+            fun fromMap(map: ReadableMap?): Options {
+                if (map == null) return Options()
+                fun read(key: String) =
+                    if (map.hasKey(key) && !map.isNull(key)) map.getDouble(key).coerceAtLeast(0.0) else 0.0
+                return Options(
+                    maxRateHz = read("maxRateHz"),
+                    minDisplacement = read("minDisplacement"),
+                    minAccuracyImprovement = read("minAccuracyImprovement"),
+                    coalesceWindowMs = read("coalesceWindowMs").toLong()
+                )
+            }
+        }
+    }
+
+    private var handle: Long = nativeCreate()
+    private val handler = Handler(Looper.getMainLooper())
+    private var pending: LocationFix? = null
+    private var flushScheduled = false
+    private val flushRunnable = Runnable { flush() }
+
+    fun setOptions(options: Options) {
+        if (handle == 0L) return
+        nativeSetOptions(
+            handle,
+            options.maxRateHz,
+            options.minDisplacement,
+            options.minAccuracyImprovement,
+            options.coalesceWindowMs
+        )
+    }
+
+    fun offer(fix: LocationFix) {
+        if (handle == 0L) return
+        val now = SystemClock.uptimeMillis()
+        val decision = nativeOffer(
+            handle,
+            fix.mapKey,
+            fix.x,
+            fix.y,
+            fix.accuracy,
+            fix.timestamp,
+            fix.providerType,
+            now
+        )
+        when {
+            decision == DELIVER -> {
+                pending = null
+                deliver(fix)
+            }
+            decision == DROP -> {
+                // Dropping may also have discarded a held fix
+                if (!nativeHasPending(handle)) pending = null
+            }
+            else -> {
+                pending = fix
+                scheduleFlush(decision, now)
+            }
+        }
+    }
+
+    private fun scheduleFlush(dueMs: Long, now: Long) {
+        if (flushScheduled) return
+        flushScheduled = true
+        handler.postDelayed(flushRunnable, (dueMs - now).coerceAtLeast(0L))
+    }
+
+    private fun flush() {
+        flushScheduled = false
+        if (handle == 0L) return
+        val now = SystemClock.uptimeMillis()
+        if (nativeFlush(handle, now)) {
+            val fix = pending
+            pending = null
+            fix?.let(deliver)
+        } else if (nativeHasPending(handle)) {
+            scheduleFlush(nativePendingDueMs(handle), now)
+        }
+    }
+
+    /**
+     * Drop the held fix and forget the last delivered one
+     */
+    fun reset() {
+        if (handle == 0L) return
+        nativeReset(handle)
+        pending = null
+    }
+
+    override fun close() {
+        handler.removeCallbacks(flushRunnable)
+        flushScheduled = false
+        pending = null
+        if (handle != 0L) {
+            nativeDestroy(handle)
+            handle = 0L
+        }
+    }
+
+    companion object {
+        // nativeOffer results; any other value is the time the held fix is due
+        private const val DELIVER = -1L
+        private const val DROP = -2L
+
+        init {
+            System.loadLibrary("meridianmaps")
+        }
+
+        /**
+         * received, delivered, dropped and coalesced summed over every throttle of the process
+         */
+        @JvmStatic
+        fun totalStats(): Map<String, Long> {
+            val counters = nativeTotalStats()
+            return mapOf(
+                "received" to counters[0],
+                "delivered" to counters[1],
+                "dropped" to counters[2],
+                "coalesced" to counters[3]
+            )
+        }
+
+        @JvmStatic private external fun nativeCreate(): Long
+        @JvmStatic private external fun nativeDestroy(handle: Long)
+        @JvmStatic private external fun nativeSetOptions(
+            handle: Long,
+            maxRateHz: Double,
+            minDisplacement: Double,
+            minAccuracyImprovement: Double,
+            coalesceWindowMs: Long
+        )
+        @JvmStatic private external fun nativeOffer(
+            handle: Long,
+            mapKey: String,
+            x: Double,
+            y: Double,
+            accuracy: Double,
+            timestampMs: Long,
+            providerType: Int,
+            nowMs: Long
+        ): Long
+        @JvmStatic private external fun nativeFlush(handle: Long, nowMs: Long): Boolean
+        @JvmStatic private external fun nativeHasPending(handle: Long): Boolean
+        @JvmStatic private external fun nativePendingDueMs(handle: Long): Long
+        @JvmStatic private external fun nativeReset(handle: Long)
+        @JvmStatic private external fun nativeTotalStats(): LongArray
+    }
+}
@@ -0,0 +1,192 @@
+package com.meridianmaps
+
+import android.os.Handler
+import android.os.Looper
+import android.os.SystemClock
+import java.io.IOException
+import java.util.Collections
+import java.util.WeakHashMap
+
+/**
+ * Writes the fixes the map views receive to a binary location trace
+ * (cpp/LocationTrace.h). Every view reports the same device fixes, so a fix
+ * equal to the last recorded one is skipped. Main thread only.
+ */
+object LocationRecorder {
+    private var handle = 0L
+    private var lastFix: LocationFix? = null
+
+    var path: String? = null
+        private set
+
+    val isRecording get() = handle != 0L
+
+    init {
+        System.loadLibrary("meridianmaps")
+    }
+
+    /**
+     * Start a new trace at [path], ending any recording in progress
+     */
+    @Throws(IOException::class)
+    fun start(path: String) {
+        stop()
+        val error = arrayOfNulls<String>(1)
+        handle = nativeOpen(path, error)
+        if (handle == 0L) throw IOException(error[0] ?: "Cannot open $path")
+        this.path = path
+    }
+
+    /**
+     * End the recording and return how many fixes it holds
+     */
+    fun stop(): Int {
+        if (handle == 0L) return 0
+        val count = nativeClose(handle)
+        handle = 0L
+        lastFix = null
+        return count
+    }
+
+    fun record(fix: LocationFix) {
+        if (handle == 0L) return
+        val last = lastFix
+        if (last != null && last.timestamp == fix.timestamp && last.rawX == fix.rawX && last.rawY == fix.rawY &&
+            last.mapKey == fix.mapKey) {
+            return
+        }
+        lastFix = fix
+        nativeAppend(handle, fix.mapKey, fix.rawX, fix.rawY, fix.accuracy, fix.timestamp, fix.providerType)
+    }
+
+    @JvmStatic private external fun nativeOpen(path: String, error: Array<String?>): Long
+    // Flushes after every fix so a trace survives the app being killed mid-walk
+    @JvmStatic private external fun nativeAppend(
+        handle: Long,
+        mapKey: String,
+        x: Double,
+        y: Double,
+        accuracy: Double,
+        timestampMs: Long,
+        providerType: Int
+    )
+    @JvmStatic private external fun nativeClose(handle: Long): Int
+}
+
+/**
+ * Plays a recorded trace back to every listening map view, in place of the
+ * location manager, at the recorded pace times speed. A speed of 0 replays as
+ * fast as the main looper allows. Main thread only.
+ */
+object LocationReplay {
+
+    fun interface Listener {
+        fun onReplayFix(fix: LocationFix)
+    }
+
+    /**
+     * [fixes] delivered and whether the trace ran to its end rather than being stopped
+     */
+    fun interface Completion {
+        fun onReplayFinished(fixes: Int, finished: Boolean)
+    }
+
+    // Fixes delivered per looper turn at full speed, so the UI keeps drawing
+    private const val BATCH_SIZE = 64
+    // Values per fix from nativeTake: x, y, accuracy, timestamp, provider, mapKey index
+    private const val FIX_STRIDE = 6
+
+    private val listeners = Collections.newSetFromMap(WeakHashMap<Listener, Boolean>())
+    private val handler = Handler(Looper.getMainLooper())
+    private var handle = 0L
+    private var mapKeys: Array<String> = emptyArray()
+    private var completion: Completion? = null
+    private val deliverRunnable = Runnable { deliverDueFixes() }
+
+    val isActive get() = handle != 0L
+
+    init {
+        System.loadLibrary("meridianmaps")
+    }
+
+    /**
+     * Listeners are held weakly
+     */
+    fun addListener(listener: Listener) {
+        listeners.add(listener)
+    }
+
+    fun removeListener(listener: Listener) {
+        listeners.remove(listener)
+    }
+
+    /**
+     * Load [path] and start it, stopping any replay in progress
+     */
+    @Throws(IOException::class)
+    fun start(path: String, speed: Double, completion: Completion) {
+        val error = arrayOfNulls<String>(1)
+        val replay = nativeOpen(path, speed, error)
+        if (replay == 0L) throw IOException(error[0] ?: "Cannot read $path")
+        stop()
+        handle = replay
+        mapKeys = nativeMapKeys(replay)
+        this.completion = completion
+        nativeStart(replay, SystemClock.uptimeMillis())
+        deliverDueFixes()
+    }
+
+    fun stop() {
+        finish(false)
+    }
+
+    private fun finish(finished: Boolean) {
+        if (handle == 0L) return
+        val delivered = nativePosition(handle)
+        nativeDestroy(handle)
+        handle = 0L
+        handler.removeCallbacks(deliverRunnable)
+        val done = completion
+        completion = null
+        done?.onReplayFinished(delivered, finished)
+    }
+
+    private fun deliverDueFixes() {
+        if (handle == 0L) return
+        val now = SystemClock.uptimeMillis()
+        val values = nativeTake(handle, now, BATCH_SIZE)
+        var offset = 0
+        while (offset < values.size) {
+            val x = values[offset]
+            val y = values[offset + 1]
+            val fix = LocationFix(
+                x = x,
+                y = y,
+                rawX = x,
+                rawY = y,
+                accuracy = values[offset + 2],
+                timestamp = values[offset + 3].toLong(),
+                mapKey = mapKeys.getOrElse(values[offset + 5].toInt()) { "" },
+                providerType = values[offset + 4].toInt()
+            )
+            for (listener in listeners.toList()) {
+                listener.onReplayFix(fix)
+            }
+            offset += FIX_STRIDE
+        }
+        if (nativeDone(handle)) {
+            finish(true)
+            return
+        }
+        handler.postDelayed(deliverRunnable, (nativeNextDueMs(handle) - now).coerceAtLeast(0L))
+    }
+
+    @JvmStatic private external fun nativeOpen(path: String, speed: Double, error: Array<String?>): Long
+    @JvmStatic private external fun nativeDestroy(handle: Long)
+    @JvmStatic private external fun nativeMapKeys(handle: Long): Array<String>
+    @JvmStatic private external fun nativeStart(handle: Long, nowMs: Long)
+    @JvmStatic private external fun nativeTake(handle: Long, nowMs: Long, maxCount: Int): DoubleArray
+    @JvmStatic private external fun nativeDone(handle: Long): Boolean
+    @JvmStatic private external fun nativeNextDueMs(handle: Long): Long
+    @JvmStatic private external fun nativePosition(handle: Long): Int
+}
@@ -0,0 +1,124 @@
+package com.meridianmaps
+
+import com.facebook.react.bridge.Arguments
+import com.facebook.react.bridge.ReactContext
+import com.facebook.react.bridge.WritableMap
+import com.facebook.react.uimanager.UIManagerHelper
+import com.facebook.react.uimanager.events.Event
+import java.util.concurrent.atomic.AtomicLongArray
+
+/**
+ * An event of one MeridianMapView, dispatched to that view only.
+ *
+ * Names are the JS handler props ("onMapLoadStart"); on the wire they use the
+ * "top" prefix that codegen'd view configs register (see [NAMES]). Payloads match
+ * src/MeridianMapViewNativeComponent.ts.
+ *
+ * Each view carries an event mask from JS with one bit per entry of [NAMES]; events
+ * without a JS handler are dropped before their payload is built.
+ */
+class MapViewEvent private constructor(
+    surfaceId: Int,
+    viewId: Int,
+    private val handlerName: String,
+    private val payload: WritableMap?
+) : Event<MapViewEvent>(surfaceId, viewId) {
+
+    override fun getEventName(): String = topName(handlerName)
+
+    // Several transform or location updates within a frame only need the last one
+    override fun canCoalesce(): Boolean = handlerName in COALESCED
+
+    override fun getEventData(): WritableMap = payload ?: Arguments.createMap()
+
+    /**
+     * Builds an event's payload; only called when the event is going to be sent
+     */
+    fun interface Payload {
+        fun build(): WritableMap?
+    }
+
+    companion object {
+        // Bit i of an event mask enables NAMES[i]; the order is shared with JS and iOS
+        @JvmField
+        val NAMES = listOf(
+            "onMapLoadStart",
+            "onMapLoadFinish",
+            "onMapLoadFail",
+            "onMapRenderFinish",
+            "onMapTransformChange",
+            "onLocationUpdated",
+            "onOrientationUpdated",
+            "onMarkerSelect",
+            "onMarkerDeselect",
+            "onCalloutClick",
+            "onSearchActivityStarted",
+            "onDirectionsReroute",
+            "onDirectionsClick",
+            "onDirectionsStart",
+            "onRouteStepIndexChange",
+            "onDirectionsClosed",
+            "onDirectionsError",
+            "onUseAccessiblePathsChange",
+            "onDirectionsCalculated",
+            "onDirectionsRequestComplete",
+            "onDirectionsRequestError",
+            "onDirectionsRequestCanceled",
+            "onGeofenceTransition"
+        )
+
+        private val COALESCED = setOf("onMapTransformChange", "onLocationUpdated", "onOrientationUpdated")
+
+        /** Mask with every event enabled; views use it until JS sends theirs */
+        const val ALL = -1
+
+        private val INDEX = NAMES.withIndex().associate { it.value to it.index }
+        private val dispatched = AtomicLongArray(NAMES.size)
+        private val suppressed = AtomicLongArray(NAMES.size)
+
+        private fun topName(handlerName: String) = "top" + handlerName.removePrefix("on")
+
+        /**
+         * Direct event registrations for getExportedCustomDirectEventTypeConstants
+         */
+        @JvmStatic
+        fun exportedTypes(): Map<String, Any> =
+            NAMES.associate { topName(it) to mapOf("registrationName" to it) }
+
+        /**
+         * Whether [mask] lets [handlerName] through
+         */
+        @JvmStatic
+        fun isEnabled(mask: Int, handlerName: String): Boolean {
+            val index = INDEX[handlerName] ?: return false
+            return mask and (1 shl index) != 0
+        }
+
+        /**
+         * Dispatch [handlerName] to the view with [viewId] if [mask] enables it. Works on
+         * both the legacy and the Fabric renderer; events for views that are gone are dropped.
+         */
+        @JvmStatic
+        fun dispatch(context: ReactContext?, viewId: Int, mask: Int, handlerName: String, payload: Payload?) {
+            val index = INDEX[handlerName] ?: return
+            if (!isEnabled(mask, handlerName)) {
+                suppressed.incrementAndGet(index)
+                return
+            }
+            if (context == null || viewId <= 0) return
+            val dispatcher = UIManagerHelper.getEventDispatcherForReactTag(context, viewId) ?: return
+            dispatched.incrementAndGet(index)
+            dispatcher.dispatchEvent(
+                MapViewEvent(UIManagerHelper.getSurfaceId(context), viewId, handlerName, payload?.build())
+            )
+        }
+
+        /**
+         * Per-event counts of sent and masked-out events since launch, as
+         * name to (dispatched, suppressed)
+         */
+        @JvmStatic
+        fun stats(): Map<String, Pair<Long, Long>> =
+            NAMES.withIndex().associate { (i, name) -> name to (dispatched.get(i) to suppressed.get(i)) }
+    }
+}
@@ -30,18 +30,19 @@ import com.arubanetworks.meridian.maps.MapView;
 import com.arubanetworks.meridian.maps.MapSheetFragment;
 import com.arubanetworks.meridian.maps.Marker;
 import com.arubanetworks.meridian.maps.Transaction;
-import com.arubanetworks.meridian.maps.directions.Directions;
 import com.arubanetworks.meridian.search.SearchActivity;
 import com.arubanetworks.meridian.maps.directions.DirectionsDestination;
-import com.arubanetworks.meridian.maps.directions.DirectionsResponse;
 import com.arubanetworks.meridian.maps.directions.DirectionsSource;
-import com.arubanetworks.meridian.maps.directions.TransportType;
 import com.arubanetworks.meridian.maps.directions.Route;
 
 import java.util.ArrayList;
+import java.util.Collections;
+import java.util.Map;
+import java.util.concurrent.CancellationException;
 
 public class MapViewFragment extends Fragment
-    implements MapView.DirectionsEventListener, MapView.MapEventListener, MapView.MarkerEventListener {
+    implements MapView.DirectionsEventListener, MapView.MapEventListener, MapView.MarkerEventListener,
+    LocationReplay.Listener {
 
   private static final String TAG = "MeridianMapView";
   private EditorKey appKey;
@@ -51,6 +52,13 @@ public class MapViewFragment extends Fragment
   @Override
   public void onCreate(Bundle savedInstanceState) {
     super.onCreate(savedInstanceState);
+    LocationReplay.INSTANCE.addListener(this);
+    dutyCycle = new LocationDutyCycle(requireContext(), running -> {
+      updateMapViewRunning();
+      return kotlin.Unit.INSTANCE;
+    });
+    dutyCycle.setOptions(dutyCycleOptions);
+    updateDutyCycleVisibility();
 
     Bundle args = getArguments();
     if (args != null) {
@@ -65,6 +73,39 @@ public class MapViewFragment extends Fragment
 
   // Store ThemedReactContext for event emission
   private com.facebook.react.uimanager.ThemedReactContext themedReactContext;
+  private int eventMask = MapViewEvent.ALL;
+  // Fixes are smoothed, then only those that get through the throttle reach JS
+  private final LocationFilter locationFilter = new LocationFilter();
+  private final LocationThrottle locationThrottle = new LocationThrottle(fix -> {
+    sendLocation(fix);
+    return kotlin.Unit.INSTANCE;
+  });
+  // Owned by the container view; null while it keeps no history
+  @androidx.annotation.Nullable private LocationHistory locationHistory;
+  // Owned by the container view
+  @androidx.annotation.Nullable private GeofenceEngine geofenceEngine;
+  // Decides when the map's positioning runs; created once there is a context
+  private LocationDutyCycle dutyCycle;
+  private LocationDutyCycle.Options dutyCycleOptions = new LocationDutyCycle.Options();
+  private boolean resumed;
+  private boolean viewVisible = true;
+  private boolean mapViewRunning;
+  // Detached from any container while in MapViewPool
+  private boolean parked;
+  private boolean mapLoaded;
+  // The container view's React tag; the fragment may outlive the container it was added to
+  private int reactTag = View.NO_ID;
+  // When the container view was created, for the session's first-render stats
+  private long createdAtMs = -1;
+  private boolean createdPrewarmed;
+  // Save what the map shows when the app leaves it; see ViewportSnapshotStore
+  private boolean viewportSnapshotEnabled = true;
+  // The container view, told when each floor load ends
+  @androidx.annotation.Nullable private MapLoadListener loadObserver;
+  // Custom marker icons by placemark type, drawn through MarkerAtlas
+  private Map<String, MarkerAtlas.Icon> markerIcons = Collections.emptyMap();
+  // MarkerAtlas references held by the markers of the floor on screen
+  private final ArrayList<Long> markerReferences = new ArrayList<>();
 
   /**
    * Set the ThemedReactContext from the parent container
@@ -80,9 +121,13 @@ public class MapViewFragment extends Fragment
 
   private MapView mapView;
   private static final String PENDING_DESTINATION_KEY = "meridianSamples.PendingDestinationKey";
+  private static final String PENDING_DESTINATION_FINGERPRINT = "meridianSamples.PendingDestinationFingerprint";
   private static final int SOURCE_REQUEST_CODE = "meridianSamples.source_request".hashCode() & 0xFF;
-  private Directions directions;
+  // Directions go through RequestBroker so views routing to the same place share one request
+  private RequestBroker.Subscription directionsSubscription;
   private LocationRequest locationRequest;
+  // Route start waiting for its floor to load
+  private MapLoadListener pendingMapLoad;
 
   @Override
   public View onCreateView(LayoutInflater inflater, ViewGroup container, Bundle savedInstanceState) {
@@ -123,9 +168,11 @@ public class MapViewFragment extends Fragment
   @Override
   public void onPause() {
     super.onPause();
-    if (mapView != null) {
-      mapView.onPause();
-    }
+    // Before the map view pauses, while it still shows the floor
+    captureViewportSnapshot();
+    resumed = false;
+    updateDutyCycleVisibility();
+    updateMapViewRunning();
     if (mapSheetFragment != null) {
       mapSheetFragment.onPause();
     }
@@ -134,9 +181,9 @@ public class MapViewFragment extends Fragment
   @Override
   public void onResume() {
     super.onResume();
-    if (mapView != null) {
-      mapView.onResume();
-    }
+    resumed = true;
+    updateDutyCycleVisibility();
+    updateMapViewRunning();
     if (mapSheetFragment != null) {
       mapSheetFragment.onResume();
     }
@@ -146,6 +193,13 @@ public class MapViewFragment extends Fragment
   public void onDestroy() {
     super.onDestroy();
     // Clean up memory.
+    cancelDirections();
+    LocationReplay.INSTANCE.removeListener(this);
+    locationThrottle.close();
+    locationFilter.close();
+    dutyCycle.close();
+    MapViewPool.forget(this);
+    releaseMarkers();
     if (mapView != null) {
       mapView.onDestroy();
     }
@@ -165,16 +219,38 @@ public class MapViewFragment extends Fragment
   //
   @Override
   public void onMapLoadStart() {
+    mapLoaded = false;
+    // The floor's markers are replaced
+    releaseMarkers();
     sendEvent("onMapLoadStart", null);
   }
 
   @Override
   public void onMapLoadFinish() {
+    mapLoaded = true;
+    if (createdAtMs >= 0) {
+      MeridianSession.recordFirstRender(android.os.SystemClock.uptimeMillis() - createdAtMs, createdPrewarmed);
+      createdAtMs = -1;
+    }
     sendEvent("onMapLoadFinish", null);
+    if (loadObserver != null) {
+      loadObserver.onMapLoaded(null);
+    }
+    MapLoadListener listener = pendingMapLoad;
+    pendingMapLoad = null;
+    if (listener != null) {
+      listener.onMapLoaded(null);
+    }
   }
 
   @Override
   public void onPlacemarksLoadFinish() {
+    // Keep the shared placemark index warm so route starts can resolve floors locally
+    if (appKey != null && mapView != null && mapView.getPlacemarks() != null) {
+      PlacemarkIndex.addPlacemarks(appKey.getId(), mapView.getPlacemarks());
+    }
+    resolveGeofencePlacemarks();
+
     // example: highlight the first four placemarks
     /*
      * ArrayList<Marker> markerList = new ArrayList<>();
@@ -198,7 +274,16 @@ public class MapViewFragment extends Fragment
 
   @Override
   public void onMapLoadFail(Throwable tr) {
-    sendEvent("onMapLoadFail", null);
+    mapLoaded = false;
+    sendEvent("onMapLoadFail", () -> errorPayload(tr, "The map failed to load"));
+    if (loadObserver != null) {
+      loadObserver.onMapLoaded(tr != null ? tr : new IllegalStateException("The map failed to load"));
+    }
+    MapLoadListener listener = pendingMapLoad;
+    pendingMapLoad = null;
+    if (listener != null) {
+      listener.onMapLoaded(tr != null ? tr : new IllegalStateException("The floor failed to load"));
+    }
   }
 
   @Override
@@ -213,12 +298,79 @@ public class MapViewFragment extends Fragment
 
   @Override
   public void onLocationUpdated(MeridianLocation location) {
-    sendEvent("onLocationUpdated", null);
+    // A trace replay stands in for the location provider until it ends
+    LocationFix fix = location != null ? LocationFix.fromLocation(location) : null;
+    if (fix != null) {
+      dutyCycle.recordFix();
+    }
+    if (fix != null && !LocationReplay.INSTANCE.isActive()) {
+      LocationRecorder.INSTANCE.record(fix);
+      receiveLocationFix(fix);
+    }
     if (mapView != null) {
       mapView.invalidate();
     }
   }
 
+  @Override
+  public void onReplayFix(@NonNull LocationFix fix) {
+    receiveLocationFix(fix);
+  }
+
+  private void receiveLocationFix(LocationFix fix) {
+    // Smooth first so the history, the geofences and the throttle see the
+    // filtered track. The history and the geofences see every fix, whether or
+    // not JS listens for them.
+    LocationFix filtered = locationFilter.filter(fix);
+    if (locationHistory != null) {
+      locationHistory.append(filtered);
+    }
+    if (geofenceEngine != null) {
+      for (GeofenceEngine.Transition transition : geofenceEngine.update(filtered)) {
+        sendEvent("onGeofenceTransition", () -> {
+          WritableMap event = Arguments.createMap();
+          event.putString("type", transition.getType());
+          event.putString("id", transition.getId());
+          event.putDouble("timestamp", transition.getTimestamp());
+          return event;
+        });
+      }
+    }
+    if (MapViewEvent.isEnabled(eventMask, "onLocationUpdated")) {
+      locationThrottle.offer(filtered);
+    } else {
+      // Nobody listens: count it as suppressed without running it through the throttle
+      sendEvent("onLocationUpdated", null);
+    }
+  }
+
+  private void sendLocation(LocationFix fix) {
+    sendEvent("onLocationUpdated", () -> {
+      WritableMap point = Arguments.createMap();
+      point.putDouble("x", fix.getX());
+      point.putDouble("y", fix.getY());
+      WritableMap rawPoint = Arguments.createMap();
+      rawPoint.putDouble("x", fix.getRawX());
+      rawPoint.putDouble("y", fix.getRawY());
+      WritableMap event = Arguments.createMap();
+      event.putMap("point", point);
+      event.putMap("rawPoint", rawPoint);
+      event.putString("mapKey", fix.getMapKey());
+      event.putDouble("timestamp", fix.getTimestamp());
+      if (fix.getVelocityX() != null && fix.getVelocityY() != null && fix.getSpeed() != null) {
+        WritableMap velocity = Arguments.createMap();
+        velocity.putDouble("x", fix.getVelocityX());
+        velocity.putDouble("y", fix.getVelocityY());
+        event.putMap("velocity", velocity);
+        event.putDouble("speed", fix.getSpeed());
+      }
+      if (fix.getHeading() != null) {
+        event.putDouble("heading", fix.getHeading());
+      }
+      return event;
+    });
+  }
+
   @Override
   public void onOrientationUpdated(MeridianOrientation orientation) {
     sendEvent("onOrientationUpdated", null);
@@ -238,7 +390,7 @@ public class MapViewFragment extends Fragment
     if (getActivity() != null) {
       Placemark p = mapView.getAssociatedPlacemark(marker);
       if (p != null) {
-        startDirections(DirectionsDestination.forPlacemarkKey(p.getKey()));
+        startDirections(DirectionsDestination.forPlacemarkKey(p.getKey()), RequestBroker.placemarkComponent(p.getKey()));
       } else {
         new AlertDialog.Builder(getActivity())
             .setMessage("Directions only implemented for placemarks.")
@@ -257,7 +409,11 @@ public class MapViewFragment extends Fragment
 
   @Override
   public boolean onRouteStepIndexChange(int index) {
-    sendEvent("onRouteStepIndexChange", null);
+    sendEvent("onRouteStepIndexChange", () -> {
+      WritableMap event = Arguments.createMap();
+      event.putInt("index", index);
+      return event;
+    });
     return false;
   }
 
@@ -269,7 +425,7 @@ public class MapViewFragment extends Fragment
 
   @Override
   public boolean onDirectionsError(Throwable tr) {
-    sendEvent("onDirectionsError", null);
+    sendEvent("onDirectionsError", () -> errorPayload(tr, "Directions failed"));
     return false;
   }
 
@@ -287,21 +443,20 @@ public class MapViewFragment extends Fragment
       return false;
     }
 
-    // Create a simple event with just the marker ID
-    WritableMap event = Arguments.createMap();
-    event.putString("markerId", String.valueOf(marker.getId()));
-    sendEvent("onMarkerSelect", event);
-
-    // For all other markers - try to show callout
-    try {
-      // Get the associated placemark if needed
-      Placemark placemark = mapView.getAssociatedPlacemark(marker);
-      if (placemark != null) {
-        sendEvent("onMarkerSelect", event);
+    sendEvent("onMarkerSelect", () -> {
+      WritableMap event = Arguments.createMap();
+      event.putString("markerId", String.valueOf(marker.getId()));
+      try {
+        Placemark placemark = mapView.getAssociatedPlacemark(marker);
+        if (placemark != null) {
+          event.putString("placemarkId", placemark.getKey() != null ? placemark.getKey().getId() : "");
+          event.putString("name", placemark.getName() != null ? placemark.getName() : "");
+        }
+      } catch (Exception e) {
+        Log.e(TAG, "Error handling marker selection", e);
       }
-    } catch (Exception e) {
-      Log.e(TAG, "Error handling marker selection", e);
-    }
+      return event;
+    });
 
     return false;
   }
@@ -314,14 +469,46 @@ public class MapViewFragment extends Fragment
 
   @Override
   public Marker markerForPlacemark(Placemark placemark) {
-    sendEvent("markerForPlacemark", null);
-    return null;
+    MarkerAtlas.Icon icon = markerIcons.get(placemark.getType());
+    if (icon == null) {
+      return null;
+    }
+    Marker marker = sharedMarker(placemark.getX(), placemark.getY(), icon, false);
+    if (marker != null) {
+      marker.setName(placemark.getName());
+    }
+    return marker;
   }
 
   @Override
   public Marker markerForSelectedMarker(Marker markerToSelect) {
-    sendEvent("markerForSelectedMarker", null);
-    return null;
+    if (!(markerToSelect instanceof MarkerAtlas.SharedMarker)) {
+      return null;
+    }
+    float[] position = markerToSelect.getPosition();
+    return sharedMarker(position[0], position[1], ((MarkerAtlas.SharedMarker) markerToSelect).getIcon(), true);
+  }
+
+  // Null lets the SDK draw its own marker
+  @androidx.annotation.Nullable
+  private Marker sharedMarker(float x, float y, MarkerAtlas.Icon icon, boolean selected) {
+    android.content.Context context = getContext();
+    if (context == null) {
+      return null;
+    }
+    MarkerAtlas.Entry entry = MarkerAtlas.acquire(context, icon, selected);
+    if (entry == null) {
+      return null;
+    }
+    markerReferences.add(entry.getId());
+    return new MarkerAtlas.SharedMarker(x, y, entry.getBitmap(), icon, selected);
+  }
+
+  private void releaseMarkers() {
+    for (long id : markerReferences) {
+      MarkerAtlas.release(id);
+    }
+    markerReferences.clear();
   }
 
   @Override
@@ -334,10 +521,9 @@ public class MapViewFragment extends Fragment
   /**
    * Start directions to the given placemark.
    */
-  private void startDirections(final DirectionsDestination destination) {
+  private void startDirections(final DirectionsDestination destination, final String destinationKey) {
     // check if we already have started directions
-    if (directions != null)
-      directions.cancel();
+    cancelDirections();
 
     // if we have requested the user location and its still running, keep it
     if (locationRequest != null && locationRequest.isRunning())
@@ -357,23 +543,25 @@ public class MapViewFragment extends Fragment
           @Override
           public void onResult(MeridianLocation location) {
             if (location == null) {
-              startSearchActivity(destination);
+              startSearchActivity(destination, destinationKey);
               return;
             }
             // Looks like we got a good location
-            onSourceResult(destination, DirectionsSource.forMapPoint(location.getMapKey(), location.getPoint()));
+            onSourceResult(destination, destinationKey,
+                DirectionsSource.forMapPoint(location.getMapKey(), location.getPoint()),
+                RequestBroker.pointComponent(location.getMapKey(), location.getPoint()));
           }
 
           @Override
           public void onError(LocationRequest.ErrorType errorType) {
             if (errorType != LocationRequest.ErrorType.CANCELED) {
-              startSearchActivity(destination);
+              startSearchActivity(destination, destinationKey);
             }
           }
         });
   }
 
-  private void startSearchActivity(DirectionsDestination destination) {
+  private void startSearchActivity(DirectionsDestination destination, String destinationKey) {
     // Location is unknown so use the Search activity to get a
     // start location from the user.
 
@@ -385,74 +573,65 @@ public class MapViewFragment extends Fragment
     Intent i = SearchActivity.createIntent(getActivity(), appKey,
         destination == null ? null : destination.getSearchExclusions());
     i.putExtra(PENDING_DESTINATION_KEY, destination);
+    i.putExtra(PENDING_DESTINATION_FINGERPRINT, destinationKey);
     startActivityForResult(i, SOURCE_REQUEST_CODE);
   }
 
-  private void startDirections(final DirectionsDestination destination, final DirectionsSource source) {
-    if (directions != null)
-      directions.cancel();
+  private void startDirections(final DirectionsDestination destination, final String destinationKey,
+      final DirectionsSource source, final String sourceKey) {
+    cancelDirections();
     if (getActivity() == null) {
       return;
     }
 
-    directions = new Directions.Builder()
-        // The setAppKey method expects an EditorKey object, which is what
-        // Application.APP_KEY is
-        .setAppKey(appKey)
-        .setDestination(destination)
-        .setListener(new Directions.DirectionsRequestListener() {
-          @Override
-          public void onDirectionsRequestStart() {
-            if (mapView != null) {
-              mapView.onDirectionsRequestStart();
-            }
-          }
-
-          @Override
-          public void onDirectionsRequestComplete(DirectionsResponse response) {
-            if (mapView != null) {
-              mapView.onDirectionsRequestComplete(response);
-              sendEvent("onDirectionsRequestComplete", null);
-            }
-          }
-
-          @Override
-          public void onDirectionsRequestError(Throwable tr) {
-            if (mapView != null) {
-              mapView.onDirectionsRequestError(tr);
-            }
-            // Send more detailed error information
-            WritableMap errorParams = Arguments.createMap();
-            errorParams.putString("error", tr != null ? tr.getMessage() : "Unknown error");
-            if (tr != null && tr.getCause() != null) {
-              errorParams.putString("cause", tr.getCause().getMessage());
-            }
-            sendEvent("onDirectionsError", errorParams);
-          }
-
-          @Override
-          public void onDirectionsRequestCanceled() {
+    if (mapView != null) {
+      mapView.onDirectionsRequestStart();
+    }
+    directionsSubscription = RequestBroker.requestDirections(appKey, source, sourceKey, destination, destinationKey,
+        (response, error) -> {
+          directionsSubscription = null;
+          if (error instanceof CancellationException) {
             if (mapView != null) {
               mapView.onDirectionsRequestCanceled();
               sendEvent("onDirectionsRequestCanceled", null);
             }
+          } else if (error != null) {
+            if (mapView != null) {
+              mapView.onDirectionsRequestError(error);
+            }
+            sendEvent("onDirectionsRequestError", () -> errorPayload(error, "Unknown error"));
+          } else if (mapView != null) {
+            mapView.onDirectionsRequestComplete(response);
+            sendEvent("onDirectionsRequestComplete", null);
           }
-        })
-        .setTransportType(TransportType.WALKING)
-        .setSource(source).build();
-    directions.calculate();
+        });
     sendEvent("onDirectionsCalculated", null);
   }
 
+  /**
+   * Leave the current directions request. Other views sharing it keep their result.
+   */
+  private void cancelDirections() {
+    if (directionsSubscription != null) {
+      directionsSubscription.cancel();
+      directionsSubscription = null;
+    }
+  }
+
   @Override
   public void onActivityResult(int requestCode, int resultCode, Intent data) {
     if (requestCode == SOURCE_REQUEST_CODE) {
       if (resultCode == Activity.RESULT_OK) {
         DirectionsDestination destination = (DirectionsDestination) data.getSerializableExtra(PENDING_DESTINATION_KEY);
+        String destinationKey = data.getStringExtra(PENDING_DESTINATION_FINGERPRINT);
         Placemark result = SearchActivity.getSearchResult(data).getPlacemark();
+        PointF point = new PointF(result.getX(), result.getY());
         DirectionsSource source = result.isInvalid() ? DirectionsSource.forPlacemarkKey(result.getKey())
-            : DirectionsSource.forMapPoint(result.getKey().getParent(), new PointF(result.getX(), result.getY()));
-        onSourceResult(destination, source);
+            : DirectionsSource.forMapPoint(result.getKey().getParent(), point);
+        String sourceKey = result.isInvalid() ? RequestBroker.placemarkComponent(result.getKey())
+            : RequestBroker.pointComponent(result.getKey().getParent(), point);
+        onSourceResult(destination, destinationKey != null ? destinationKey : uniqueDestinationKey(destination),
+            source, sourceKey);
       }
       if (mapView != null) {
         mapView.onDirectionsRequestCanceled();
@@ -461,8 +640,14 @@ public class MapViewFragment extends Fragment
     super.onActivityResult(requestCode, resultCode, data);
   }
 
-  private void onSourceResult(DirectionsDestination destination, DirectionsSource source) {
-    startDirections(destination, source);
+  private void onSourceResult(DirectionsDestination destination, String destinationKey,
+      DirectionsSource source, String sourceKey) {
+    startDirections(destination, destinationKey, source, sourceKey);
+  }
+
+  // The SDK destination does not expose what it points at, so an arbitrary one is never shared
+  private static String uniqueDestinationKey(DirectionsDestination destination) {
+    return "instance:" + System.identityHashCode(destination);
   }
 
   /**
@@ -470,21 +655,193 @@ public class MapViewFragment extends Fragment
    * Mirrors the pattern from MeridianMapViewManager.kt.
    */
 
-  private void sendEvent(String eventName,
-      @androidx.annotation.Nullable com.facebook.react.bridge.WritableMap params) {
-    try {
-      if (themedReactContext != null) {
-        int viewId = getId();
-        themedReactContext.getJSModule(com.facebook.react.uimanager.events.RCTEventEmitter.class)
-            .receiveEvent(viewId, eventName, params);
-      } else {
-        Log.e(TAG, "ThemedReactContext is null. Cannot send event.");
-      }
-    } catch (Exception e) {
-      Log.e(TAG, "Error sending event to React Native: " + e.getMessage());
+  /**
+   * Set the React tag of the container view events go to
+   */
+  public void setReactTag(int reactTag) {
+    this.reactTag = reactTag;
+  }
+
+  /**
+   * Set which events JS has handlers for; see MapViewEvent
+   */
+  public void setEventMask(int eventMask) {
+    this.eventMask = eventMask;
+  }
+
+  /**
+   * Set the rate, displacement and accuracy gates for onLocationUpdated
+   */
+  public void setLocationUpdateOptions(LocationThrottle.Options options) {
+    locationThrottle.setOptions(options);
+  }
+
+  /**
+   * Turn smoothing of location fixes on or off
+   */
+  public void setLocationSmoothing(boolean enabled) {
+    locationFilter.setEnabled(enabled);
+  }
+
+  /**
+   * Set where received fixes are kept for getLocationHistory, or null to keep none
+   */
+  public void setLocationHistory(@androidx.annotation.Nullable LocationHistory history) {
+    locationHistory = history;
+  }
+
+  /**
+   * Set the geofences received fixes are checked against, or null for none
+   */
+  public void setGeofenceEngine(@androidx.annotation.Nullable GeofenceEngine engine) {
+    geofenceEngine = engine;
+    resolveGeofencePlacemarks();
+  }
+
+  /**
+   * When the container view was created and whether a prewarm had started by then;
+   * the first floor load is reported to MeridianSession against it
+   */
+  public void setCreationTime(long uptimeMs, boolean prewarmed) {
+    createdAtMs = uptimeMs;
+    createdPrewarmed = prewarmed;
+  }
+
+  /**
+   * Set when the map's positioning pauses while the device is still or the view is hidden
+   */
+  public void setLocationDutyCycle(LocationDutyCycle.Options options) {
+    dutyCycleOptions = options;
+    if (dutyCycle != null) {
+      dutyCycle.setOptions(options);
     }
   }
 
+  /**
+   * Turn saving the map when the app goes to the background on or off
+   */
+  public void setViewportSnapshotEnabled(boolean enabled) {
+    viewportSnapshotEnabled = enabled;
+  }
+
+  /**
+   * Set the custom marker icons by placemark type; they apply from the next floor load
+   */
+  public void setMarkerIcons(Map<String, MarkerAtlas.Icon> icons) {
+    markerIcons = icons;
+  }
+
+  /**
+   * Set who is told when each floor load finishes or fails, or null for nobody
+   */
+  public void setMapLoadObserver(@androidx.annotation.Nullable MapLoadListener observer) {
+    loadObserver = observer;
+  }
+
+  // Only a floor the user is looking at; not when the fragment is being removed or parked
+  private void captureViewportSnapshot() {
+    View view = getView();
+    android.app.Activity activity = getActivity();
+    if (!viewportSnapshotEnabled || !mapLoaded || parked || isRemoving() || view == null || activity == null
+        || activity.isFinishing() || appKey == null || mapView == null || mapView.getMapKey() == null) {
+      return;
+    }
+    ViewportSnapshotStore.capture(view, activity.getWindow(), appKey.getId(), mapView.getMapKey().getId());
+  }
+
+  /**
+   * Whether the container view is shown; the fragment's own lifecycle covers the app going to the background
+   */
+  public void setViewVisible(boolean visible) {
+    viewVisible = visible;
+    updateDutyCycleVisibility();
+  }
+
+  private void updateDutyCycleVisibility() {
+    if (dutyCycle != null) {
+      dutyCycle.setVisible(resumed && viewVisible && !parked);
+    }
+  }
+
+  // MapView has no switch for positioning alone: pausing the view is what stops
+  // its location provider, so the map runs while resumed and the duty cycle allows
+  private void updateMapViewRunning() {
+    boolean run = resumed && !parked && (dutyCycle == null || dutyCycle.isRunning());
+    if (mapView == null || run == mapViewRunning) {
+      return;
+    }
+    mapViewRunning = run;
+    if (run) {
+      mapView.onResume();
+    } else {
+      mapView.onPause();
+    }
+  }
+
+  /**
+   * Leave the container view for MapViewPool. The map stops but keeps its floor,
+   * and nothing the container owns is kept.
+   */
+  public void park() {
+    parked = true;
+    cancelDirections();
+    pendingMapLoad = null;
+    loadObserver = null;
+    reactTag = View.NO_ID;
+    themedReactContext = null;
+    locationHistory = null;
+    geofenceEngine = null;
+    createdAtMs = -1;
+    View view = getView();
+    if (view != null && view.getParent() instanceof ViewGroup) {
+      ((ViewGroup) view.getParent()).removeView(view);
+    }
+    updateDutyCycleVisibility();
+    updateMapViewRunning();
+  }
+
+  /**
+   * Back from MapViewPool in the container view with reactTag, which has set its
+   * context and options on the fragment and added the fragment's view. A floor
+   * that is already loaded is reported to the new container as if it had just loaded.
+   */
+  public void unpark(int reactTag) {
+    parked = false;
+    this.reactTag = reactTag;
+    updateDutyCycleVisibility();
+    updateMapViewRunning();
+    if (mapLoaded) {
+      resolveGeofencePlacemarks();
+      onMapLoadFinish();
+    }
+  }
+
+  /**
+   * Resolve placemark geofences against the placemarks of the floor on screen
+   */
+  public void resolveGeofencePlacemarks() {
+    if (geofenceEngine != null && mapView != null && mapView.getPlacemarks() != null) {
+      geofenceEngine.resolvePlacemarks(mapView.getPlacemarks());
+    }
+  }
+
+  /**
+   * Send an event to the container's JS handler. The payload is only built when
+   * the event mask lets the event through.
+   */
+  private void sendEvent(String eventName, @androidx.annotation.Nullable MapViewEvent.Payload payload) {
+    MapViewEvent.dispatch(themedReactContext, reactTag, eventMask, eventName, payload);
+  }
+
+  private static WritableMap errorPayload(Throwable tr, String fallback) {
+    WritableMap event = Arguments.createMap();
+    event.putString("error", tr != null && tr.getMessage() != null ? tr.getMessage() : fallback);
+    if (tr != null && tr.getCause() != null && tr.getCause().getMessage() != null) {
+      event.putString("cause", tr.getCause().getMessage());
+    }
+    return event;
+  }
+
   // Method to be called from MeridianMapViewManager to trigger a native update
   public void performNativeUpdate() {
     if (mapView != null) {
@@ -509,7 +866,7 @@ public class MapViewFragment extends Fragment
   public void startDirectionsForDestination(DirectionsDestination destination) {
     if (destination == null) {
       Log.e(TAG, "Cannot start directions: destination is null");
-      sendEvent("onDirectionsError", null);
+      sendEvent("onDirectionsError", () -> errorPayload(null, "Cannot start directions: destination is null"));
       return;
     }
 
@@ -518,19 +875,19 @@ public class MapViewFragment extends Fragment
     // Check if we have a valid map view
     if (mapView == null) {
       Log.e(TAG, "Cannot start directions: mapView is null");
-      sendEvent("onDirectionsError", null);
+      sendEvent("onDirectionsError", () -> errorPayload(null, "Cannot start directions: mapView is null"));
       return;
     }
 
     // Check if we have a valid context
     if (getContext() == null) {
       Log.e(TAG, "Cannot start directions: context is null");
-      sendEvent("onDirectionsError", null);
+      sendEvent("onDirectionsError", () -> errorPayload(null, "Cannot start directions: context is null"));
       return;
     }
 
     // Start the directions
-    startDirections(destination);
+    startDirections(destination, uniqueDestinationKey(destination));
   }
 
   public void setRoute(com.arubanetworks.meridian.maps.directions.Route route) {
@@ -543,4 +900,35 @@ public class MapViewFragment extends Fragment
     }
   }
 
+  /**
+   * Called once the floor a route needs has loaded, with the failure if it did not.
+   */
+  public interface MapLoadListener {
+    void onMapLoaded(@androidx.annotation.Nullable Throwable error);
+  }
+
+  /**
+   * Show the route and report through listener when the floor it starts on is loaded:
+   * right away when that floor is already on screen, otherwise from onMapLoadFinish.
+   * Returns whether the map had to switch floors.
+   */
+  public boolean showRoute(Route route, @androidx.annotation.Nullable EditorKey floor, MapLoadListener listener) {
+    MapView target = mapView != null ? mapView
+        : (mapSheetFragment != null ? mapSheetFragment.getMapView() : null);
+    if (target == null) {
+      listener.onMapLoaded(new IllegalStateException("Map view is not available"));
+      return false;
+    }
+    boolean switching = floor != null && target.getMapKey() != null && !floor.equals(target.getMapKey());
+    if (pendingMapLoad != null) {
+      pendingMapLoad.onMapLoaded(new IllegalStateException("Superseded by a newer route"));
+    }
+    pendingMapLoad = switching ? listener : null;
+    target.setRoute(route);
+    if (!switching) {
+      listener.onMapLoaded(null);
+    }
+    return switching;
+  }
+
 }
@@ -0,0 +1,144 @@
+package com.meridianmaps
+
+import android.content.ComponentCallbacks2
+import android.content.Context
+import android.content.res.Configuration
+import android.util.Log
+import androidx.fragment.app.FragmentActivity
+
+/**
+ * Bounded pool of detached map fragments (cpp/MapPool.h).
+ *
+ * A MeridianMapContainerView leaving the window parks its MapViewFragment here
+ * instead of removing it. The fragment stays added to the activity with its map
+ * sheet, listeners and loaded floor; only its view leaves the container. The
+ * next container for the same app and map moves that view into itself. The
+ * least recently parked fragments are removed past [maxSize], and all of them
+ * when the system runs low on memory. Main thread only, except [stats].
+ */
+object MapViewPool : ComponentCallbacks2 {
+    private const val TAG = "MapViewPool"
+    const val DEFAULT_MAX_SIZE = 2
+
+    // Order of the native counters
+    private val STATS_NAMES = listOf("size", "maxSize", "parked", "hits", "misses", "evictions", "trims")
+
+    init {
+        System.loadLibrary("meridianmaps")
+    }
+
+    // The native index is also read by stats on the JS thread; guarded by the pool's lock
+    private val handle = nativeCreate(DEFAULT_MAX_SIZE)
+    private val fragments = HashMap<Long, MapViewFragment>()
+    private var nextId = 1L
+    private var attached = false
+
+    /**
+     * Starts listening for memory pressure; idempotent
+     */
+    @JvmStatic
+    fun attach(context: Context) {
+        if (!attached) {
+            context.applicationContext.registerComponentCallbacks(this)
+            attached = true
+        }
+    }
+
+    /**
+     * Fragments kept at most; 0 turns pooling off
+     */
+    var maxSize: Int
+        get() = synchronized(this) { nativeStats(handle)[1].toInt() }
+        set(value) = drop(synchronized(this) { nativeSetCapacity(handle, value.coerceAtLeast(0)) })
+
+    /**
+     * Detaches [fragment] from its container and keeps it for [appId] and [mapId]
+     */
+    @JvmStatic
+    fun park(fragment: MapViewFragment, appId: String, mapId: String) {
+        fragment.park()
+        val id = nextId++
+        fragments[id] = fragment
+        drop(synchronized(this) { nativePark(handle, key(appId, mapId), id) })
+    }
+
+    /**
+     * The fragment parked most recently in [activity] for [appId] and [mapId], or null
+     */
+    @JvmStatic
+    fun take(activity: FragmentActivity, appId: String, mapId: String): MapViewFragment? {
+        val id = synchronized(this) { nativeTake(handle, key(appId, mapId)) }
+        val fragment = fragments.remove(id) ?: return null
+        // Its view only fits a container of the activity it was added to
+        if (fragment.activity !== activity || fragment.view == null) {
+            remove(fragment)
+            return null
+        }
+        return fragment
+    }
+
+    /**
+     * Stops tracking a fragment destroyed with its activity
+     */
+    @JvmStatic
+    fun forget(fragment: MapViewFragment) {
+        val id = fragments.entries.firstOrNull { it.value === fragment }?.key ?: return
+        fragments.remove(id)
+        synchronized(this) { nativeRemove(handle, id) }
+    }
+
+    /**
+     * Removes every parked fragment
+     */
+    @JvmStatic
+    fun trim() {
+        val ids = synchronized(this) { nativeTrim(handle, 0) }
+        if (ids.isNotEmpty()) {
+            Log.d(TAG, "Removing ${ids.size} parked maps on memory pressure")
+        }
+        drop(ids)
+    }
+
+    // UI_HIDDEN only means the app went to the background; parked maps are already off screen
+    override fun onTrimMemory(level: Int) {
+        if (level >= ComponentCallbacks2.TRIM_MEMORY_RUNNING_LOW && level != ComponentCallbacks2.TRIM_MEMORY_UI_HIDDEN) {
+            trim()
+        }
+    }
+
+    override fun onLowMemory() = trim()
+
+    override fun onConfigurationChanged(newConfig: Configuration) {}
+
+    /**
+     * size, maxSize, parked, hits, misses, evictions and trims
+     */
+    @JvmStatic
+    fun stats(): Map<String, Long> = synchronized(this) { STATS_NAMES.zip(nativeStats(handle).toList()).toMap() }
+
+    private fun key(appId: String, mapId: String) = "$appId|$mapId"
+
+    private fun drop(ids: LongArray) {
+        for (id in ids) {
+            fragments.remove(id)?.let { remove(it) }
+        }
+    }
+
+    private fun remove(fragment: MapViewFragment) {
+        if (!fragment.isAdded || fragment.parentFragmentManager.isDestroyed) {
+            return
+        }
+        fragment.parentFragmentManager.beginTransaction()
+            .remove(fragment)
+            .commitAllowingStateLoss()
+    }
+
+    @JvmStatic private external fun nativeCreate(capacity: Int): Long
+    // Each call that can evict returns the ids of the evicted fragments
+    @JvmStatic private external fun nativeSetCapacity(handle: Long, capacity: Int): LongArray
+    @JvmStatic private external fun nativePark(handle: Long, key: String, id: Long): LongArray
+    @JvmStatic private external fun nativeTake(handle: Long, key: String): Long
+    @JvmStatic private external fun nativeTrim(handle: Long, keep: Int): LongArray
+    @JvmStatic private external fun nativeRemove(handle: Long, id: Long): Boolean
+    @JvmStatic private external fun nativeStats(handle: Long): LongArray
+}
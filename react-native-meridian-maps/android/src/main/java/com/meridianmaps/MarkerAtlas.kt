@@ -0,0 +1,297 @@
+package com.meridianmaps
+
+import android.content.ComponentCallbacks2
+import android.content.Context
+import android.content.res.Configuration
+import android.graphics.Bitmap
+import android.graphics.BitmapFactory
+import android.graphics.Canvas
+import android.graphics.Color
+import android.graphics.Paint
+import android.graphics.Path
+import android.graphics.PorterDuff
+import android.graphics.PorterDuffColorFilter
+import android.graphics.RectF
+import android.net.Uri
+import android.os.Handler
+import android.os.Looper
+import android.util.Log
+import com.arubanetworks.meridian.maps.Marker
+import com.facebook.react.bridge.ReadableArray
+import com.facebook.react.bridge.ReadableType
+import java.io.IOException
+import java.util.concurrent.Executors
+import kotlin.math.abs
+import kotlin.math.roundToInt
+
+/**
+ * Process-wide, reference-counted cache of custom marker bitmaps (cpp/MarkerAtlas.h).
+ *
+ * A bitmap is drawn once per look, an [Icon] at one pixel size, color and
+ * selected state, and every marker drawn that way gets the same bitmap, so a
+ * floor of a thousand shops allocates one instead of a thousand. Map fragments
+ * release what their markers acquired when the floor changes or they are
+ * destroyed. Bitmaps no marker uses are kept for the next floor within
+ * [DEFAULT_MAX_UNUSED_BYTES], and dropped when the system runs low on memory.
+ * Main thread only, except [stats].
+ */
+object MarkerAtlas : ComponentCallbacks2 {
+    private const val TAG = "MarkerAtlas"
+    const val DEFAULT_MAX_UNUSED_BYTES = 4L shl 20
+    private const val DEFAULT_COLOR = 0xFF1F6FD0.toInt()
+    // Selected markers are drawn larger rather than scaled by the map, so they stay sharp
+    private const val SELECTED_SCALE = 1.25f
+
+    // Order of the native counters
+    private val STATS_NAMES = listOf(
+        "bitmaps", "bytes", "unusedBytes", "hits", "draws", "releases", "evictions", "trims"
+    )
+
+    /**
+     * How the placemarks of one type are drawn; see MarkerIcon in src/MeridianMapViewNativeComponent.ts
+     */
+    class Icon(
+        val uri: String?,
+        val shape: String,
+        val sizeDp: Float,
+        val color: Int?,
+        val selectedColor: Int?
+    ) {
+        companion object {
+            /**
+             * Icons keyed by placemark type; entries without a type are skipped
+             */
+            @JvmStatic
+            fun fromArray(array: ReadableArray?): Map<String, Icon> {
+                if (array == null) return emptyMap()
+                val icons = HashMap<String, Icon>()
+                for (i in 0 until array.size()) {
+                    val map = array.getMap(i) ?: continue
+                    fun has(key: String) = map.hasKey(key) && !map.isNull(key)
+                    val type = if (has("type")) map.getString("type") else null
+                    if (type.isNullOrEmpty()) continue
+                    icons[type] = Icon(
+                        uri = if (has("uri")) map.getString("uri")?.takeIf { it.isNotEmpty() } else null,
+                        shape = if (has("shape")) map.getString("shape") ?: "circle" else "circle",
+                        sizeDp = if (has("size") && map.getType("size") == ReadableType.Number) {
+                            map.getDouble("size").toFloat().coerceIn(1f, 256f)
+                        } else {
+                            24f
+                        },
+                        color = if (has("color")) map.getDouble("color").toLong().toInt() else null,
+                        selectedColor = if (has("selectedColor")) map.getDouble("selectedColor").toLong().toInt() else null
+                    )
+                }
+                return icons
+            }
+        }
+    }
+
+    /**
+     * A marker showing a shared bitmap; the bitmap belongs to the atlas and is never recycled by the marker
+     */
+    class SharedMarker(
+        x: Float,
+        y: Float,
+        private val shared: Bitmap,
+        val icon: Icon,
+        val selected: Boolean
+    ) : Marker(x, y) {
+        override fun getBitmap(): Bitmap = shared
+
+        // The selected look replaces a marker while it is selected
+        override fun canBeSelected(): Boolean = !selected
+    }
+
+    class Entry(val id: Long, val bitmap: Bitmap)
+
+    init {
+        System.loadLibrary("meridianmaps")
+    }
+
+    // The native index is also read by stats on the JS thread; guarded by the atlas's lock
+    private val handle = nativeCreate(DEFAULT_MAX_UNUSED_BYTES)
+    private val bitmaps = HashMap<Long, Bitmap>()
+    private val fetcher = Executors.newSingleThreadExecutor()
+    private val fetching = HashSet<String>()
+    private val mainHandler = Handler(Looper.getMainLooper())
+    private var attached = false
+
+    /**
+     * Starts listening for memory pressure; idempotent
+     */
+    @JvmStatic
+    fun attach(context: Context) {
+        if (!attached) {
+            context.applicationContext.registerComponentCallbacks(this)
+            attached = true
+        }
+    }
+
+    /**
+     * The bitmap for [icon], counting a reference the caller gives back with [release].
+     * Null if the icon cannot be drawn yet: a remote image not on disk is fetched into
+     * AssetCache for a later floor load, and the SDK draws its default marker meanwhile.
+     */
+    @JvmStatic
+    fun acquire(context: Context, icon: Icon, selected: Boolean): Entry? {
+        val scale = context.resources.displayMetrics.density * if (selected) SELECTED_SCALE else 1f
+        val sizePx = (icon.sizeDp * scale).roundToInt().coerceAtLeast(1)
+        // Shapes are always filled, so their key carries the fill they get; an
+        // image without a color is untinted, which no color value stands for
+        val requested = if (selected) icon.selectedColor ?: icon.color else icon.color
+        val color = if (icon.uri == null) requested ?: DEFAULT_COLOR else requested
+        val key = nativeKey(icon.uri ?: "shape:${icon.shape}", sizePx, color ?: 0, color != null, selected)
+        val result = synchronized(this) { nativeAcquire(handle, key, sizePx.toLong() * sizePx * 4) }
+        val id = abs(result)
+        if (result > 0) {
+            bitmaps[id]?.let { return Entry(id, it) }
+        }
+        val bitmap = draw(context, icon, sizePx, color)
+        if (bitmap == null) {
+            synchronized(this) { nativeRemove(handle, id) }
+            return null
+        }
+        bitmaps[id] = bitmap
+        return Entry(id, bitmap)
+    }
+
+    /**
+     * Gives back a reference from [acquire]
+     */
+    @JvmStatic
+    fun release(id: Long) {
+        drop(synchronized(this) { nativeRelease(handle, id) })
+    }
+
+    /**
+     * Drops every bitmap no marker uses
+     */
+    @JvmStatic
+    fun trim() {
+        drop(synchronized(this) { nativeTrim(handle) })
+    }
+
+    override fun onTrimMemory(level: Int) {
+        if (level >= ComponentCallbacks2.TRIM_MEMORY_RUNNING_LOW && level != ComponentCallbacks2.TRIM_MEMORY_UI_HIDDEN) {
+            trim()
+        }
+    }
+
+    override fun onLowMemory() = trim()
+
+    override fun onConfigurationChanged(newConfig: Configuration) {}
+
+    /**
+     * bitmaps, bytes and unusedBytes held now, then hits, draws, releases, evictions and trims
+     */
+    @JvmStatic
+    fun stats(): Map<String, Long> = synchronized(this) { STATS_NAMES.zip(nativeStats(handle).toList()).toMap() }
+
+    private fun drop(ids: LongArray) {
+        for (id in ids) {
+            // Markers that showed it are gone; the garbage collector frees it
+            bitmaps.remove(id)
+        }
+    }
+
+    private fun draw(context: Context, icon: Icon, sizePx: Int, color: Int?): Bitmap? {
+        val source = if (icon.uri != null) (loadImage(context, icon.uri) ?: return null) else null
+        val bitmap = Bitmap.createBitmap(sizePx, sizePx, Bitmap.Config.ARGB_8888)
+        val canvas = Canvas(bitmap)
+        val paint = Paint(Paint.ANTI_ALIAS_FLAG or Paint.FILTER_BITMAP_FLAG)
+        val size = sizePx.toFloat()
+        if (source != null) {
+            // Aspect-fit, tinted with the color when there is one
+            val fit = minOf(size / source.width, size / source.height)
+            val width = source.width * fit
+            val height = source.height * fit
+            if (color != null) {
+                paint.colorFilter = PorterDuffColorFilter(color, PorterDuff.Mode.SRC_IN)
+            }
+            canvas.drawBitmap(
+                source, null, RectF((size - width) / 2, (size - height) / 2, (size + width) / 2, (size + height) / 2), paint
+            )
+            source.recycle()
+            return bitmap
+        }
+
+        paint.color = color ?: DEFAULT_COLOR
+        val outline = Paint(Paint.ANTI_ALIAS_FLAG).apply {
+            style = Paint.Style.STROKE
+            this.color = Color.WHITE
+            strokeWidth = size / 12
+        }
+        val inset = outline.strokeWidth
+        when (icon.shape) {
+            "square" -> {
+                val rect = RectF(inset, inset, size - inset, size - inset)
+                canvas.drawRoundRect(rect, size / 6, size / 6, paint)
+                canvas.drawRoundRect(rect, size / 6, size / 6, outline)
+            }
+            "pin" -> {
+                // A round head over a point at the bottom center, where the placemark is
+                val radius = size * 0.32f
+                val cx = size / 2
+                val cy = inset + radius
+                val pin = Path().apply {
+                    addCircle(cx, cy, radius, Path.Direction.CW)
+                    moveTo(cx - radius * 0.7f, cy + radius * 0.7f)
+                    lineTo(cx, size - inset)
+                    lineTo(cx + radius * 0.7f, cy + radius * 0.7f)
+                    close()
+                }
+                canvas.drawPath(pin, paint)
+                canvas.drawCircle(cx, cy, radius * 0.35f, outline)
+            }
+            else -> {
+                canvas.drawCircle(size / 2, size / 2, size / 2 - inset, paint)
+                canvas.drawCircle(size / 2, size / 2, size / 2 - inset, outline)
+            }
+        }
+        return bitmap
+    }
+
+    // Remote images come from AssetCache's disk only; local ones (file:, content:,
+    // android.resource:) are read directly
+    private fun loadImage(context: Context, uri: String): Bitmap? {
+        val bytes = if (uri.startsWith("http://") || uri.startsWith("https://")) {
+            AssetCache.get(uri) ?: run {
+                fetch(uri)
+                return null
+            }
+        } else {
+            try {
+                context.contentResolver.openInputStream(Uri.parse(uri))?.use { it.readBytes() }
+            } catch (e: IOException) {
+                Log.w(TAG, "Failed to read marker icon $uri: ${e.message}")
+                null
+            } catch (e: SecurityException) {
+                Log.w(TAG, "Failed to read marker icon $uri: ${e.message}")
+                null
+            } ?: return null
+        }
+        return BitmapFactory.decodeByteArray(bytes, 0, bytes.size).also {
+            if (it == null) Log.w(TAG, "Marker icon $uri is not an image")
+        }
+    }
+
+    private fun fetch(url: String) {
+        if (!fetching.add(url)) return
+        fetcher.execute {
+            if (AssetCache.fetch(url) == null) {
+                Log.w(TAG, "Failed to fetch marker icon $url")
+            }
+            mainHandler.post { fetching.remove(url) }
+        }
+    }
+
+    @JvmStatic private external fun nativeCreate(maxUnusedBytes: Long): Long
+    @JvmStatic private external fun nativeKey(icon: String, sizePx: Int, argb: Int, tinted: Boolean, selected: Boolean): String
+    // Negative when the caller has to draw the bitmap for the id
+    @JvmStatic private external fun nativeAcquire(handle: Long, key: String, bytes: Long): Long
+    @JvmStatic private external fun nativeRelease(handle: Long, id: Long): LongArray
+    @JvmStatic private external fun nativeRemove(handle: Long, id: Long): Boolean
+    @JvmStatic private external fun nativeTrim(handle: Long): LongArray
+    @JvmStatic private external fun nativeStats(handle: Long): LongArray
+}
@@ -1,35 +1,35 @@
 package com.meridianmaps
 
 import android.os.Bundle
+import android.os.Handler
+import android.os.Looper
+import android.os.SystemClock
 import android.util.Log
 import android.view.View
 import android.app.Application
 import android.widget.FrameLayout
+import android.widget.ImageView
 import androidx.fragment.app.FragmentActivity
 import com.facebook.react.bridge.Arguments
 import com.facebook.react.bridge.ReactApplicationContext
+import com.facebook.react.bridge.ReadableArray
 import com.facebook.react.bridge.ReadableMap
 import com.facebook.react.bridge.WritableMap
 import com.facebook.react.common.MapBuilder
 import com.facebook.react.uimanager.SimpleViewManager
 import com.facebook.react.uimanager.ThemedReactContext
 import com.facebook.react.uimanager.annotations.ReactProp
-import com.facebook.react.uimanager.events.RCTEventEmitter
 
 import com.arubanetworks.meridian.Meridian
 import com.arubanetworks.meridian.maps.directions.DirectionsDestination
 import com.arubanetworks.meridian.editor.EditorKey
 import com.arubanetworks.meridian.location.LocationRequest
 import com.arubanetworks.meridian.maps.directions.DirectionsSource
-import com.arubanetworks.meridian.maps.directions.Directions
-import com.arubanetworks.meridian.maps.directions.TransportType
 import com.arubanetworks.meridian.search.SearchActivity
 import com.arubanetworks.meridian.location.MeridianLocation
-import com.arubanetworks.meridian.maps.directions.DirectionsResponse
 
 // Add missing imports
 import android.content.Context
-import android.app.Activity
 
 /**
  * React Native view manager for Meridian Maps that creates and manages MapViewFragment instances
@@ -54,11 +54,20 @@ class MeridianMapViewManager(private val reactContext: ReactApplicationContext)
         private var lastAppId: String? = null
         private var lastMapId: String? = null
         private var lastAppToken: String? = null
+        // The token Meridian.configure took; the SDK keeps it for the process
+        private var sdkToken: String? = null
 
         /**
-         * Thread-safe SDK configuration that prevents multiple initialization
+         * The token the SDK runs with, or null before it is configured here
+         */
+        @JvmStatic
+        fun configuredToken(): String? = synchronized(configLock) { sdkToken }
+
+        /**
+         * Thread-safe SDK configuration that prevents multiple initialization.
+         * Credentials for another app or map switch MeridianApplication's keys.
          * @param context Application context
-         * @param activity Current activity
+         * @param application The app's Application
          * @param appId Meridian app ID
          * @param mapId Meridian map ID
          * @param appToken Meridian app token
@@ -66,7 +75,7 @@ class MeridianMapViewManager(private val reactContext: ReactApplicationContext)
          */
         fun configureSdkIfNeeded(
             context: Context,
-            activity: Activity,
+            application: Application,
             appId: String,
             mapId: String,
             appToken: String
@@ -79,10 +88,14 @@ class MeridianMapViewManager(private val reactContext: ReactApplicationContext)
                             Log.d(TAG, "SDK already configured with same credentials, skipping...")
                             return true
                         } else {
-                            Log.w(TAG, "SDK configured with different credentials. Current: appId=$appId, mapId=$mapId")
-                            Log.w(TAG, "Previous: appId=$lastAppId, mapId=$lastMapId")
-                            // For different credentials, we might need to handle reconfiguration
-                            // For now, we'll proceed with existing configuration
+                            // Another venue: switch the keys; what the previous one
+                            // loaded stays warm in VenueRegistry
+                            // A token other than the SDK's is reported by MeridianSession.configure
+                            Log.d(TAG, "Switching venue from appId=$lastAppId, mapId=$lastMapId to appId=$appId, mapId=$mapId")
+                            MeridianApplication.initialize(application, appId, mapId, appToken)
+                            lastAppId = appId
+                            lastMapId = mapId
+                            lastAppToken = appToken
                             return true
                         }
                     }
@@ -92,6 +105,7 @@ class MeridianMapViewManager(private val reactContext: ReactApplicationContext)
                         Log.d(TAG, "Configuring Meridian SDK with token")
                         Meridian.configure(context.applicationContext, appToken)
                         isSdkConfigured = true
+                        sdkToken = appToken
                         // Meridian.getShared().setForceSimulatedLocation(true)
                         Log.d(TAG, "Meridian SDK configured successfully")
                     }
@@ -100,7 +114,7 @@ class MeridianMapViewManager(private val reactContext: ReactApplicationContext)
                     if (!isAppInitialized) {
                         Log.d(TAG, "Initializing MeridianApplication with appId: $appId, mapId: $mapId")
                         MeridianApplication.initialize(
-                            activity.application as Application,
+                            application,
                             appId,
                             mapId,
                             appToken
@@ -131,7 +145,7 @@ class MeridianMapViewManager(private val reactContext: ReactApplicationContext)
                             if (!isAppInitialized) {
                                 try {
                                     MeridianApplication.initialize(
-                                        activity.application as Application,
+                                        application,
                                         appId,
                                         mapId,
                                         appToken
@@ -184,6 +198,7 @@ class MeridianMapViewManager(private val reactContext: ReactApplicationContext)
                 lastAppId = null
                 lastMapId = null
                 lastAppToken = null
+                sdkToken = null
             }
         }
     }
@@ -219,6 +234,38 @@ class MeridianMapViewManager(private val reactContext: ReactApplicationContext)
         }
     }
 
+    @ReactProp(name = "eventMask", defaultInt = MapViewEvent.ALL)
+    fun setEventMask(view: MeridianMapContainerView, mask: Int) {
+        view.eventMask = mask
+    }
+
+    @ReactProp(name = "locationUpdateOptions")
+    fun setLocationUpdateOptions(view: MeridianMapContainerView, options: ReadableMap?) {
+        view.locationUpdateOptions = LocationThrottle.Options.fromMap(options)
+        view.locationSmoothing =
+            if (options != null && options.hasKey("smoothing") && !options.isNull("smoothing")) options.getBoolean("smoothing") else true
+    }
+
+    @ReactProp(name = "locationDutyCycle")
+    fun setLocationDutyCycle(view: MeridianMapContainerView, options: ReadableMap?) {
+        view.locationDutyCycle = LocationDutyCycle.Options.fromMap(options)
+    }
+
+    @ReactProp(name = "locationHistoryBytes", defaultInt = LocationHistory.DEFAULT_CAPACITY_BYTES)
+    fun setLocationHistoryBytes(view: MeridianMapContainerView, bytes: Int) {
+        view.locationHistoryBytes = bytes
+    }
+
+    @ReactProp(name = "viewportSnapshot", defaultBoolean = true)
+    fun setViewportSnapshot(view: MeridianMapContainerView, enabled: Boolean) {
+        view.viewportSnapshot = enabled
+    }
+
+    @ReactProp(name = "markerIcons")
+    fun setMarkerIcons(view: MeridianMapContainerView, icons: ReadableArray?) {
+        view.markerIcons = MarkerAtlas.Icon.fromArray(icons)
+    }
+
     @ReactProp(name = "showLocationUpdates", defaultBoolean = true)
     fun setShowLocationUpdates(view: MeridianMapContainerView, show: Boolean) {
         if (show != view.locationUpdatesEnabled) {
@@ -236,36 +283,13 @@ class MeridianMapViewManager(private val reactContext: ReactApplicationContext)
     override fun onDropViewInstance(view: MeridianMapContainerView) {
         Log.d(TAG, "Dropping view instance")
         // view.cleanup()
+        view.locationHistory.close()
+        view.geofenceEngine.close()
         super.onDropViewInstance(view)
     }
 
-    override fun getExportedCustomDirectEventTypeConstants(): Map<String, Any> {
-        // TODO: MapBuilder is deprecated. Replace with a non-deprecated alternative if available in the SDK.
-        return mapOf(
-            "onMapLoadStart" to mapOf("registrationName" to "onMapLoadStart"),
-            "onMapLoadFinish" to mapOf("registrationName" to "onMapLoadFinish"),
-            "onMapLoadFail" to mapOf("registrationName" to "onMapLoadFail"),
-            "onMarkerSelect" to mapOf("registrationName" to "onMarkerSelect"),
-            "onLocationUpdate" to mapOf("registrationName" to "onLocationUpdate"),
-            "onLocationUpdated" to mapOf("registrationName" to "onLocationUpdated"),
-            "onMapTransformChange" to mapOf("registrationName" to "onMapTransformChange"),
-            "onMapRenderFinish" to mapOf("registrationName" to "onMapRenderFinish"),
-            "onDirectionsClick" to mapOf("registrationName" to "onDirectionsClick"),
-            "onDirectionsStart" to mapOf("registrationName" to "onDirectionsStart"),
-            "onDirectionsClosed" to mapOf("registrationName" to "onDirectionsClosed"),
-            "onSearchActivityStarted" to mapOf("registrationName" to "onSearchActivityStarted"),
-            "onRouteStepIndexChange" to mapOf("registrationName" to "onRouteStepIndexChange"),
-            "onDirectionsCalculated" to mapOf("registrationName" to "onDirectionsCalculated"),
-            "onDirectionsRequestComplete" to mapOf("registrationName" to "onDirectionsRequestComplete"),
-            "onDirectionsRequestError" to mapOf("registrationName" to "onDirectionsRequestError"),
-            "onDirectionsError" to mapOf("registrationName" to "onDirectionsError"),
-            "onDirectionsRequestCanceled" to mapOf("registrationName" to "onDirectionsRequestCanceled"),
-            "onMarkerDeselect" to mapOf("registrationName" to "onMarkerDeselect"),
-            "onCalloutClick" to mapOf("registrationName" to "onCalloutClick"),
-            "markerForPlacemark" to mapOf("registrationName" to "markerForPlacemark"),
-            "markerForSelectedMarker" to mapOf("registrationName" to "markerForSelectedMarker"),
-        )
-    }
+    override fun getExportedCustomDirectEventTypeConstants(): Map<String, Any> =
+        MapViewEvent.exportedTypes()
 
     override fun getCommandsMap(): Map<String, Int>? {
         return MapBuilder.of(
@@ -308,6 +332,9 @@ class MeridianMapContainerView(
 
     companion object {
         private const val TAG = "MeridianMapView"
+        // Watchdog for a floor that never reports onMapLoadFinish
+        private const val ROUTE_FLOOR_LOAD_TIMEOUT_MS = 15_000L
+        private const val SNAPSHOT_FADE_MS = 250L
     }
 
     // Map configuration
@@ -356,13 +383,130 @@ class MeridianMapContainerView(
             }
         }
 
+    // Events JS has handlers for; see MapViewEvent
+    var eventMask: Int = MapViewEvent.ALL
+        set(value) {
+            field = value
+            mapFragment?.setEventMask(value)
+        }
+
+    // Gates for onLocationUpdated; see LocationThrottle
+    var locationUpdateOptions = LocationThrottle.Options()
+        set(value) {
+            field = value
+            mapFragment?.setLocationUpdateOptions(value)
+        }
+
+    // Whether location fixes are smoothed; see LocationFilter
+    var locationSmoothing = true
+        set(value) {
+            field = value
+            mapFragment?.setLocationSmoothing(value)
+        }
+
+    // When positioning pauses for a still device or a hidden view; see LocationDutyCycle
+    var locationDutyCycle = LocationDutyCycle.Options()
+        set(value) {
+            field = value
+            mapFragment?.setLocationDutyCycle(value)
+        }
+
+    // Recent fixes for getLocationHistory; owned by the view so it outlives fragment
+    // re-creation, and closed when React drops the view
+    val locationHistory = LocationHistory()
+
+    // Bytes of recent fixes to keep; 0 keeps none
+    var locationHistoryBytes = LocationHistory.DEFAULT_CAPACITY_BYTES
+        set(value) {
+            field = value.coerceAtLeast(0)
+            if (field == 0) {
+                locationHistory.clear()
+            } else {
+                locationHistory.setCapacity(field)
+            }
+            mapFragment?.setLocationHistory(recordedLocationHistory())
+        }
+
+    private fun recordedLocationHistory() = if (locationHistoryBytes > 0) locationHistory else null
+
+    // Save what the map shows when the app goes to the background, and show it
+    // on the next mount of the same floor until the floor has loaded
+    var viewportSnapshot = true
+        set(value) {
+            field = value
+            mapFragment?.setViewportSnapshotEnabled(value)
+        }
+
+    // Custom marker icons by placemark type; the map applies them from its next floor load
+    var markerIcons: Map<String, MarkerAtlas.Icon> = emptyMap()
+        set(value) {
+            field = value
+            mapFragment?.setMarkerIcons(value)
+        }
+
+    // The snapshot covering a floor that is still loading
+    private var snapshotView: ImageView? = null
+    private var snapshotShown: ViewportSnapshotStore.Snapshot? = null
+
+    // Geofences for addGeofences; owned by the view like locationHistory
+    val geofenceEngine = GeofenceEngine()
+
+    /**
+     * Registers geofences checked against every fix; see [GeofenceEngine.add]
+     */
+    @Throws(IllegalArgumentException::class)
+    fun addGeofences(geofences: ReadableArray) {
+        geofenceEngine.add(geofences)
+        // Placemark geofences on the floor already shown resolve right away
+        mapFragment?.resolveGeofencePlacemarks()
+    }
+
     // Fragment reference
     private var mapFragment: MapViewFragment? = null
+    // What the fragment was created for; its app and map key it in MapViewPool
+    private data class FragmentConfig(
+        val appId: String,
+        val mapId: String,
+        val appToken: String,
+        val locationUpdatesEnabled: Boolean
+    )
+    private var fragmentConfig: FragmentConfig? = null
+
+    // This view's share of a brokered directions request
+    private var routeSubscription: RequestBroker.Subscription? = null
+
+    // Route start in progress and the timings of its finished phases
+    private class RouteStart(val callback: ((WritableMap?, Throwable?) -> Unit)?) {
+        val startNanos = SystemClock.elapsedRealtimeNanos()
+        var phaseStartNanos = startNanos
+        val timings: WritableMap = Arguments.createMap()
+        // Set once the route is shown; finishRoute adds it to the timings, which
+        // cannot change after the callback has handed them to a promise
+        var floorSwitched: Boolean? = null
+
+        fun endPhase(name: String) {
+            val now = SystemClock.elapsedRealtimeNanos()
+            timings.putDouble(name, (now - phaseStartNanos) / 1e6)
+            phaseStartNanos = now
+        }
+    }
+
+    private var activeRoute: RouteStart? = null
+
+    // For the session's time-to-first-render stats
+    private val createdAtMs = SystemClock.uptimeMillis()
+    private val createdPrewarmed = MeridianSession.isPrewarmed
+    private val mainHandler = Handler(Looper.getMainLooper())
 
     init {
         Log.d(TAG, "Initializing MeridianMapContainerView")
         // Set up the container - match parent dimensions
         layoutParams = LayoutParams(LayoutParams.MATCH_PARENT, LayoutParams.MATCH_PARENT)
+        PlacemarkIndex.attach(context)
+        MapViewPool.attach(context)
+        AssetCache.attach(context)
+        ViewportSnapshotStore.attach(context)
+        MarkerAtlas.attach(context)
     }
 
     /**
@@ -409,9 +553,19 @@ class MeridianMapContainerView(
     override fun onDetachedFromWindow() {
         super.onDetachedFromWindow()
         Log.d(TAG, "❌ View detached from window, removing fragment")
+        finishRoute(IllegalStateException("The map view was removed"))
+        routeSubscription?.cancel()
+        routeSubscription = null
         removeMapFragment()
     }
 
+    /**
+     * Hidden or shown with an ancestor; a hidden view can pause positioning
+     */
+    override fun onVisibilityAggregated(isVisible: Boolean) {
+        super.onVisibilityAggregated(isVisible)
+        mapFragment?.setViewVisible(isVisible)
+    }
 
 private fun createMapFragment() {
     Log.d(TAG, "createMapFragment called with appId: $appId, mapId: $mapId")
@@ -435,21 +589,36 @@ private fun createMapFragment() {
         return
     }
 
+    // Attaching and every prop change land here; only another config replaces the map
+    val config = FragmentConfig(appId!!, mapId!!, appToken!!, locationUpdatesEnabled)
+    if (mapFragment != null) {
+        if (config == fragmentConfig) return
+        // The old map is parked in MapViewPool, as if this view had unmounted
+        Log.d(TAG, "Configuration changed, replacing the map fragment")
+        finishRoute(IllegalStateException("The map view was reconfigured"))
+        routeSubscription?.cancel()
+        routeSubscription = null
+        removeMapFragment()
+    }
+
     try {
         Log.d(TAG, "Initializing Meridian SDK with appId: $appId, mapId: $mapId")
 
-        val configSuccess = MeridianMapViewManager.configureSdkIfNeeded(
-            context,
-            activity,
-            appId!!,
-            mapId!!,
-            appToken!!
-        )
+        // A no-op when prewarm or an earlier view already configured the SDK
+        val configSuccess = MeridianSession.configure(activity.application, appId!!, mapId!!, appToken!!)
 
         if (!configSuccess) {
             throw IllegalStateException("Failed to configure Meridian SDK")
         }
 
+        // Reuse a map an earlier view left loaded
+        val pooled = MapViewPool.take(activity, appId!!, mapId!!)
+        if (pooled != null) {
+            Log.d(TAG, "Reusing a parked MapViewFragment")
+            attachPooledFragment(pooled, config)
+            return
+        }
+
         // Create the map fragment
         try {
             Log.d(TAG, "Creating MapViewFragment")
@@ -462,6 +631,18 @@ private fun createMapFragment() {
                 }
                 // Set the themed context for React Native theming
                 setThemedReactContext(themedContext)
+                setReactTag(this@MeridianMapContainerView.id)
+                setEventMask(eventMask)
+                setLocationUpdateOptions(locationUpdateOptions)
+                setLocationSmoothing(locationSmoothing)
+                setLocationDutyCycle(locationDutyCycle)
+                setCreationTime(createdAtMs, createdPrewarmed)
+                setViewVisible(isShown)
+                setLocationHistory(recordedLocationHistory())
+                setGeofenceEngine(geofenceEngine)
+                setViewportSnapshotEnabled(viewportSnapshot)
+                setMarkerIcons(markerIcons)
+                setMapLoadObserver { onFloorLoadEnded() }
             }
             Log.d(TAG, "MapViewFragment created successfully")
         } catch (e: Exception) {
@@ -469,12 +650,15 @@ private fun createMapFragment() {
             throw Exception("Failed to create map view: ${e.message}")
         }
 
-        // Add the fragment to this view
+        // Add the fragment to this view. Not replace: a pooled fragment first added
+        // here may now be shown by another view
         activity.supportFragmentManager.beginTransaction()
-            .replace(id, mapFragment!!, "mapFragment")
+            .add(id, mapFragment!!, "mapFragment")
             .commitNow()
+        fragmentConfig = config
+        showViewportSnapshot()
 
-        sendEvent("onMapLoadStart", null)
+        // onMapLoadStart comes from the fragment once the SDK starts loading
         Log.d(TAG, "Map fragment created and added successfully")
 
     } catch (e: Exception) {
@@ -544,59 +728,118 @@ private fun createMapFragment() {
 //     }
 // }
 
+    // Moves a parked fragment's view into this container and hands it this view's state
+    private fun attachPooledFragment(fragment: MapViewFragment, config: FragmentConfig) {
+        fragment.setThemedReactContext(themedContext)
+        fragment.setEventMask(eventMask)
+        fragment.setLocationUpdateOptions(locationUpdateOptions)
+        fragment.setLocationSmoothing(locationSmoothing)
+        fragment.setLocationDutyCycle(locationDutyCycle)
+        fragment.setCreationTime(createdAtMs, createdPrewarmed)
+        fragment.setViewVisible(isShown)
+        fragment.setLocationHistory(recordedLocationHistory())
+        fragment.setGeofenceEngine(geofenceEngine)
+        fragment.setViewportSnapshotEnabled(viewportSnapshot)
+        fragment.setMarkerIcons(markerIcons)
+        fragment.setMapLoadObserver { onFloorLoadEnded() }
+        mapFragment = fragment
+        fragmentConfig = config
+
+        val mapView = fragment.requireView()
+        addView(mapView, LayoutParams(LayoutParams.MATCH_PARENT, LayoutParams.MATCH_PARENT))
+        // React lays out its own children only; this one is sized here
+        mapView.measure(
+            View.MeasureSpec.makeMeasureSpec(width, View.MeasureSpec.EXACTLY),
+            View.MeasureSpec.makeMeasureSpec(height, View.MeasureSpec.EXACTLY)
+        )
+        mapView.layout(0, 0, width, height)
+        fragment.unpark(id)
+    }
+
     fun performNativeMapUpdate() {
         mapFragment?.performNativeUpdate()
     }
 
-    fun startRouteToPlacemark(placemarkId: String) {
-        val activity = reactContext.currentActivity as? FragmentActivity ?: return
+    /**
+     * Resolve the placemark, calculate a route to it from the current location and show it.
+     * [callback] runs once on the UI thread with the phase timings in milliseconds
+     * (placemarkLookupMs, routeCalcMs, floorLoadMs, totalMs, floorSwitched) when the
+     * route is on screen, or with the error. A newer call supersedes this one.
+     */
+    fun startRouteToPlacemark(placemarkId: String, callback: ((WritableMap?, Throwable?) -> Unit)? = null) {
+        val activity = reactContext.currentActivity as? FragmentActivity
+        if (activity == null) {
+            callback?.invoke(null, IllegalStateException("No current activity"))
+            return
+        }
 
         activity.runOnUiThread {
-            val fragment = mapFragment ?: return@runOnUiThread
-
-            val appKey = EditorKey(appId ?: return@runOnUiThread)
-            val mapKey = EditorKey.forMap(mapId ?: return@runOnUiThread, appKey.id)
+            val fragment = mapFragment
+            val currentAppId = appId
+            if (fragment == null || currentAppId == null) {
+                callback?.invoke(null, IllegalStateException("Map view is not initialized"))
+                return@runOnUiThread
+            }
+            val route = RouteStart(callback)
+            finishRoute(IllegalStateException("Superseded by a newer route"))
+            activeRoute = route
+
+            val appKey = EditorKey(currentAppId)
+            // Prefer the floor recorded in the shared index; fall back to the current map
+            val record = PlacemarkIndex.lookup(appKey.id, placemarkId)
+            val mapKey = record?.mapKey ?: mapId?.let { EditorKey.forMap(it, appKey.id) }
+            if (mapKey == null) {
+                finishRoute(IllegalStateException("No floor known for placemark $placemarkId"))
+                return@runOnUiThread
+            }
             val placemarkKey = EditorKey.forPlacemark(placemarkId, mapKey)
+            route.endPhase("placemarkLookupMs")
 
             val destination = DirectionsDestination.forPlacemarkKey(placemarkKey)
 
             // Attempt to get the current location
             LocationRequest.requestCurrentLocation(activity, appKey, object : LocationRequest.LocationRequestListener {
                 override fun onResult(location: MeridianLocation) {
+                    if (activeRoute !== route) return
                     val source = DirectionsSource.forMapPoint(location.mapKey, location.point)
-                    val directions = Directions.Builder()
-                        .setAppKey(appKey)
-                        .setSource(source)
-                        .setDestination(destination)
-                        .setTransportType(TransportType.WALKING)
-                        .setListener(object : Directions.DirectionsRequestListener {
-                            override fun onDirectionsRequestStart() {
-                                Log.d(TAG, "Directions request started.")
-                            }
-
-                            override fun onDirectionsRequestComplete(response: DirectionsResponse) {
-                                val route = response.routes.firstOrNull()
-                                if (route != null) {
-                                    fragment.setRoute(route)
-                                } else {
-                                    Log.w(TAG, "No routes found.")
-                                }
-                            }
-
-                            override fun onDirectionsRequestError(tr: Throwable) {
-                                Log.e(TAG, "Error calculating directions", tr)
-                            }
-
-                            override fun onDirectionsRequestCanceled() {
-                                Log.i(TAG, "Directions request canceled")
-                            }
-                        })
-                        .build()
-                    directions.calculate()
+                    // Views routing from the same spot to the same placemark share one calculation
+                    routeSubscription?.cancel()
+                    routeSubscription = RequestBroker.requestDirections(
+                        appKey,
+                        source,
+                        RequestBroker.pointComponent(location.mapKey, location.point),
+                        destination,
+                        RequestBroker.placemarkComponent(placemarkKey)
+                    ) { response, error ->
+                        routeSubscription = null
+                        if (activeRoute !== route) return@requestDirections
+                        val shown = response?.routes?.firstOrNull()
+                        if (error != null || shown == null) {
+                            Log.e(TAG, "Error calculating directions", error)
+                            finishRoute(error ?: IllegalStateException("No routes found"))
+                            return@requestDirections
+                        }
+                        route.endPhase("routeCalcMs")
+                        // The map moves to the route's floor itself; wait for that floor to load.
+                        // On the same floor showRoute finishes the route before it returns.
+                        route.floorSwitched = false
+                        val switching = fragment.showRoute(shown, record?.mapKey) { loadError ->
+                            if (activeRoute !== route) return@showRoute
+                            route.endPhase("floorLoadMs")
+                            finishRoute(loadError)
+                        }
+                        if (switching) {
+                            route.floorSwitched = true
+                            mainHandler.postDelayed({
+                                if (activeRoute === route) finishRoute(IllegalStateException("Timed out waiting for the floor to load"))
+                            }, ROUTE_FLOOR_LOAD_TIMEOUT_MS)
+                        }
+                    }
                 }
 
                 override fun onError(error: LocationRequest.ErrorType) {
                     Log.e(TAG, "Error obtaining current location: $error")
+                    if (activeRoute === route) finishRoute(IllegalStateException("Could not get the current location: $error"))
                     // Optionally, prompt user to select starting location
                     val intent = SearchActivity.createIntent(activity, appKey)
                     activity.startActivityForResult(intent, 42)
@@ -605,11 +848,89 @@ private fun createMapFragment() {
         }
     }
 
+    private fun finishRoute(error: Throwable?) {
+        val route = activeRoute ?: return
+        activeRoute = null
+        if (error != null) {
+            routeSubscription?.cancel()
+            routeSubscription = null
+        }
+        route.floorSwitched?.let { route.timings.putBoolean("floorSwitched", it) }
+        route.timings.putDouble("totalMs", (SystemClock.elapsedRealtimeNanos() - route.startNanos) / 1e6)
+        if (error != null) {
+            Log.w(TAG, "Route start failed: ${error.message}")
+            route.callback?.invoke(null, error)
+        } else {
+            route.callback?.invoke(route.timings, null)
+        }
+    }
+
     /**
      * Removes the map fragment
      */
+    // Covers the new fragment's map, which has not drawn anything yet
+    private fun showViewportSnapshot() {
+        val configuredMapId = mapId
+        if (!viewportSnapshot || appId.isNullOrEmpty() || configuredMapId.isNullOrEmpty()) return
+        val snapshot = ViewportSnapshotStore.load(appId!!, configuredMapId) ?: return
+        // Stretched to another aspect, the snapshot would not line up with the map
+        if (width > 0 && height > 0 &&
+            Math.abs(snapshot.viewWidth / snapshot.viewHeight - width.toFloat() / height) > 0.02f
+        ) {
+            snapshot.bitmap.recycle()
+            return
+        }
+        val view = ImageView(context).apply {
+            setImageBitmap(snapshot.bitmap)
+            scaleType = ImageView.ScaleType.CENTER_CROP
+        }
+        hideViewportSnapshot(animated = false)
+        snapshotShown = snapshot
+        snapshotView = view
+        addView(view, LayoutParams(LayoutParams.MATCH_PARENT, LayoutParams.MATCH_PARENT))
+        // React lays out its own children only; this one is sized here
+        view.measure(
+            View.MeasureSpec.makeMeasureSpec(width, View.MeasureSpec.EXACTLY),
+            View.MeasureSpec.makeMeasureSpec(height, View.MeasureSpec.EXACTLY)
+        )
+        view.layout(0, 0, width, height)
+        Log.d(TAG, "Showing the viewport snapshot of ${snapshot.mapId}")
+    }
+
+    // The floor finished loading or failed; either way the snapshot has done its job
+    private fun onFloorLoadEnded() {
+        hideViewportSnapshot(animated = true)
+    }
+
+    private fun hideViewportSnapshot(animated: Boolean) {
+        val view = snapshotView ?: return
+        val snapshot = snapshotShown
+        snapshotView = null
+        snapshotShown = null
+        val remove = Runnable {
+            removeView(view)
+            view.setImageDrawable(null)
+            snapshot?.bitmap?.recycle()
+        }
+        if (animated) {
+            view.animate().alpha(0f).setDuration(SNAPSHOT_FADE_MS).withEndAction(remove)
+        } else {
+            remove.run()
+        }
+    }
+
     private fun removeMapFragment() {
-        if (mapFragment == null) return
+        hideViewportSnapshot(animated = false)
+        val fragment = mapFragment ?: return
+        // Keyed by what the map was created for, not by props that may have changed since
+        val config = fragmentConfig
+        fragmentConfig = null
+        if (fragment.isAdded && fragment.view != null && config != null) {
+            // Keep the loaded map for the next view of the same app and map
+            mapFragment = null
+            MapViewPool.park(fragment, config.appId, config.mapId)
+            return
+        }
 
         val activity = reactContext.currentActivity as? FragmentActivity ?: return
 
@@ -626,15 +947,10 @@ private fun createMapFragment() {
     }
 
     /**
-     * Send an event to React Native
+     * Send an event to this view's JS handler
      */
     private fun sendEvent(eventName: String, params: WritableMap?) {
-        try {
-            themedContext.getJSModule(RCTEventEmitter::class.java)
-                .receiveEvent(id, eventName, params)
-        } catch (e: Exception) {
-            Log.e(TAG, "Error sending event to React Native: ${e.message}")
-        }
+        MapViewEvent.dispatch(themedContext, id, eventMask, eventName) { params }
     }
 }
 
@@ -1,12 +1,17 @@
 package com.meridianmaps
 
+import android.app.Application
 import android.content.Intent
 import android.os.Handler
 import android.os.Looper
+import android.os.SystemClock
 import android.util.Log
 import android.widget.Toast
 import com.arubanetworks.meridian.Meridian
 import com.facebook.react.bridge.*
+import com.facebook.react.uimanager.UIManagerModule
+import java.io.File
+import java.io.IOException
 
 class MeridianMapsModule(private val reactContext: ReactApplicationContext) :
     ReactContextBaseJavaModule(reactContext) {
@@ -183,4 +188,582 @@ class MeridianMapsModule(private val reactContext: ReactApplicationContext) :
             promise.reject("UNEXPECTED_ERROR", errorMsg, e)
         }
     }
+
+    /**
+     * Run a batch of nearest / radius / rect placemark queries against the native
+     * per-floor spatial index
+     * @param appId The application ID
+     * @param queries Query objects, see src/PlacemarkQuery.ts
+     * @param promise Resolves with one array of hits per query
+     */
+    @ReactMethod
+    fun queryPlacemarks(appId: String?, queries: ReadableArray, promise: Promise) {
+        if (appId.isNullOrEmpty()) {
+            promise.reject("INVALID_ARGUMENT", "appId is required")
+            return
+        }
+        val parsed = try {
+            List(queries.size()) { parseQuery(it, queries.getMap(it)) }
+        } catch (e: RuntimeException) {
+            // Malformed queries, including entries that are not objects
+            promise.reject("INVALID_QUERY", e.message, e)
+            return
+        }
+
+        val results = Arguments.createArray()
+        for (hits in PlacemarkIndex.query(appId, parsed)) {
+            val serialized = Arguments.createArray()
+            for (hit in hits) {
+                serialized.pushMap(Arguments.createMap().apply {
+                    putString("id", hit.row.placemarkId)
+                    putString("mapId", hit.row.mapId)
+                    putString("name", hit.row.name)
+                    putString("type", hit.row.type)
+                    putDouble("x", hit.row.x.toDouble())
+                    putDouble("y", hit.row.y.toDouble())
+                    putDouble("distance", hit.distance.toDouble())
+                })
+            }
+            results.pushArray(serialized)
+        }
+        promise.resolve(results)
+    }
+
+    /**
+     * Configure the SDK and warm the location, map and placemark caches before any
+     * map view mounts; see MeridianSession.prewarm
+     * @param options appId, mapId and token (required) and region, see src/Session.ts
+     * @param promise Resolves with configureMs, placemarksMs, mapMs and totalMs
+     */
+    @ReactMethod
+    fun prewarm(options: ReadableMap, promise: Promise) {
+        fun string(key: String) = if (options.hasKey(key) && options.getType(key) == ReadableType.String) options.getString(key) else null
+        val appId = string("appId")
+        val mapId = string("mapId")
+        val token = string("token")
+        if (appId.isNullOrEmpty() || mapId.isNullOrEmpty() || token.isNullOrEmpty()) {
+            promise.reject("INVALID_ARGUMENT", "appId, mapId and token are required")
+            return
+        }
+        val regionName = string("region")
+        val region = MeridianSession.parseRegion(regionName)
+        if (region == null) {
+            promise.reject("INVALID_ARGUMENT", "Unknown region $regionName")
+            return
+        }
+        val application = reactContext.applicationContext as Application
+        // The session, like the SDK it configures, lives on the main thread
+        Handler(Looper.getMainLooper()).post {
+            MeridianSession.prewarm(application, appId, mapId, token, region) { timings, error ->
+                if (timings == null) {
+                    promise.reject("PREWARM_ERROR", error?.message ?: "Prewarm failed", error)
+                    return@prewarm
+                }
+                promise.resolve(Arguments.createMap().apply {
+                    for ((name, ms) in timings) {
+                        putDouble(name, ms)
+                    }
+                })
+            }
+        }
+    }
+
+    /**
+     * Prewarm state and how long views took to first render with and without it
+     */
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    fun getStartupStats(): WritableMap {
+        return Arguments.createMap().apply {
+            for ((name, value) in MeridianSession.stats()) {
+                when (value) {
+                    is String -> putString(name, value)
+                    is Number -> putDouble(name, value.toDouble())
+                }
+            }
+        }
+    }
+
+    /**
+     * Set how many venues keep their caches; see src/Venues.ts
+     */
+    @ReactMethod
+    fun setVenueOptions(options: ReadableMap) {
+        if (!options.hasKey("maxWarmVenues") || options.getType("maxWarmVenues") != ReadableType.Number) return
+        val maxWarmVenues = options.getDouble("maxWarmVenues").toInt()
+        if (maxWarmVenues < 1) return
+        Handler(Looper.getMainLooper()).post {
+            VenueRegistry.maxWarmVenues = maxWarmVenues
+        }
+    }
+
+    /**
+     * The active venue, the venues kept warm and how often switches found theirs warm
+     */
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    fun getVenueStats(): WritableMap {
+        return Arguments.createMap().apply {
+            for ((name, value) in VenueRegistry.stats()) {
+                when (value) {
+                    is String -> putString(name, value)
+                    is Number -> putDouble(name, value.toDouble())
+                    is List<*> -> putArray(name, Arguments.fromList(value))
+                }
+            }
+            putArray("tokenMismatchAppIds", Arguments.fromList(MeridianSession.tokenMismatches()))
+        }
+    }
+
+    /**
+     * Set how many unmounted maps MapViewPool keeps loaded; see src/MapPool.ts
+     */
+    @ReactMethod
+    fun setMapPoolOptions(options: ReadableMap) {
+        if (!options.hasKey("maxSize") || options.getType("maxSize") != ReadableType.Number) return
+        val maxSize = options.getDouble("maxSize").toInt()
+        Handler(Looper.getMainLooper()).post {
+            MapViewPool.maxSize = maxSize
+        }
+    }
+
+    /**
+     * size, maxSize, parked, hits, misses, evictions and trims of MapViewPool
+     */
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    fun getMapPoolStats(): WritableMap {
+        return Arguments.createMap().apply {
+            for ((name, value) in MapViewPool.stats()) {
+                putDouble(name, value.toDouble())
+            }
+        }
+    }
+
+    /**
+     * bitmaps, bytes and unusedBytes held by MarkerAtlas, then its hits, draws, releases, evictions and trims
+     */
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    fun getMarkerAtlasStats(): WritableMap {
+        return Arguments.createMap().apply {
+            for ((name, value) in MarkerAtlas.stats()) {
+                putDouble(name, value.toDouble())
+            }
+        }
+    }
+
+    /**
+     * Incrementally sync an app's placemarks from a placemark sync endpoint into
+     * the native index, transferring only what changed since the last sync
+     * @param appId The application ID
+     * @param options url (required), mapIds, pageSize and headers, see src/PlacemarkSync.ts
+     * @param promise Resolves with the sync counters
+     */
+    @ReactMethod
+    fun syncPlacemarks(appId: String?, options: ReadableMap, promise: Promise) {
+        val url = if (options.hasKey("url")) options.getString("url") else null
+        if (appId.isNullOrEmpty() || url.isNullOrEmpty()) {
+            promise.reject("INVALID_ARGUMENT", "appId and options.url are required")
+            return
+        }
+        val mapIds = if (options.hasKey("mapIds") && options.getType("mapIds") == ReadableType.Array) {
+            val array = options.getArray("mapIds")!!
+            List(array.size()) { array.getString(it) ?: "" }.filter { it.isNotEmpty() }
+        } else {
+            emptyList()
+        }
+        val pageSize = if (options.hasKey("pageSize") && options.getType("pageSize") == ReadableType.Number) options.getInt("pageSize") else 0
+        val headers = mutableMapOf<String, String>()
+        if (options.hasKey("headers") && options.getType("headers") == ReadableType.Map) {
+            val map = options.getMap("headers")!!
+            val keys = map.keySetIterator()
+            while (keys.hasNextKey()) {
+                val key = keys.nextKey()
+                map.getString(key)?.let { headers[key] = it }
+            }
+        }
+
+        val started = System.nanoTime()
+        PlacemarkIndex.sync(appId, url, mapIds, pageSize, headers) { stats, error ->
+            if (stats == null) {
+                promise.reject("SYNC_ERROR", error ?: "Placemark sync failed")
+                return@sync
+            }
+            promise.resolve(Arguments.createMap().apply {
+                putDouble("requests", stats.requests.toDouble())
+                putDouble("bytesReceived", stats.bytesReceived.toDouble())
+                putDouble("mapsUnchanged", stats.mapsUnchanged.toDouble())
+                putDouble("mapsDelta", stats.mapsDelta.toDouble())
+                putDouble("mapsFull", stats.mapsFull.toDouble())
+                putDouble("upserted", stats.upserted.toDouble())
+                putDouble("removed", stats.removed.toDouble())
+                putDouble("unchanged", stats.unchanged.toDouble())
+                putDouble("durationMs", (System.nanoTime() - started) / 1_000_000.0)
+            })
+        }
+    }
+
+    /**
+     * Load a venue asset bundle written by scripts/pack-venue.js and seed the
+     * placemark index of its app from it
+     * @param path An absolute path, or the name of an asset in the APK
+     * @param promise Resolves with what the bundle holds and how many placemarks it seeded
+     */
+    @ReactMethod
+    fun loadAssetBundle(path: String?, promise: Promise) {
+        if (path.isNullOrEmpty()) {
+            promise.reject("INVALID_ARGUMENT", "path is required")
+            return
+        }
+        val bundle = try {
+            AssetBundle.open(reactContext, path)
+        } catch (e: IOException) {
+            promise.reject("BUNDLE_ERROR", e.message, e)
+            return
+        }
+        // Not closed: a placemark seed from it may still be running
+        AssetBundle.active = bundle
+        PlacemarkIndex.attach(reactContext)
+        PlacemarkIndex.seed(bundle) { stats, error ->
+            // The SDK still loads placemarks itself if seeding failed
+            if (error != null) {
+                Log.w(TAG, "Failed to seed placemarks from $path: $error")
+            }
+            val counters = bundle.stats()
+            promise.resolve(Arguments.createMap().apply {
+                putString("appId", bundle.appId)
+                putString("baseUrl", bundle.baseUrl)
+                putDouble("maps", bundle.mapIds.size.toDouble())
+                putDouble("assets", (counters["assets"] ?: 0L).toDouble())
+                putDouble("bytes", (counters["bytes"] ?: 0L).toDouble())
+                putDouble("placemarksSeeded", (stats?.upserted ?: 0L).toDouble())
+            })
+        }
+    }
+
+    @ReactMethod
+    fun unloadAssetBundle() {
+        AssetBundle.active = null
+    }
+
+    /**
+     * Whether a bundle is loaded and how much of it has been served
+     */
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    fun getAssetBundleStats(): WritableMap {
+        val bundle = AssetBundle.active
+        return Arguments.createMap().apply {
+            putBoolean("loaded", bundle != null)
+            for (name in listOf("served", "bytesServed", "failures")) putDouble(name, 0.0)
+            if (bundle != null) {
+                putString("appId", bundle.appId)
+                for ((name, value) in bundle.stats()) {
+                    putDouble(name, value.toDouble())
+                }
+            }
+        }
+    }
+
+    /**
+     * Set how many bytes of floor assets AssetCache keeps; see src/AssetCache.ts
+     */
+    @ReactMethod
+    fun setCacheOptions(options: ReadableMap) {
+        if (!options.hasKey("maxBytes") || options.getType("maxBytes") != ReadableType.Number) return
+        AssetCache.attach(reactContext)
+        AssetCache.maxBytes = options.getDouble("maxBytes").toLong()
+    }
+
+    @ReactMethod
+    fun clearCache() {
+        AssetCache.attach(reactContext)
+        AssetCache.clear()
+        ViewportSnapshotStore.attach(reactContext)
+        ViewportSnapshotStore.clear()
+    }
+
+    /**
+     * Hits, misses and bytes served by the floor asset cache, and what it holds
+     */
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    fun getCacheStats(): WritableMap {
+        AssetCache.attach(reactContext)
+        val stats = AssetCache.stats()
+        val lookups = (stats["hits"] ?: 0L) + (stats["misses"] ?: 0L)
+        return Arguments.createMap().apply {
+            for ((name, value) in stats) {
+                putDouble(name, value.toDouble())
+            }
+            putDouble("hitRate", if (lookups > 0) (stats["hits"] ?: 0L).toDouble() / lookups else 0.0)
+        }
+    }
+
+    /**
+     * Typeahead search over the locally indexed placemarks. Synchronous so each
+     * keystroke is answered without a bridge round trip.
+     * @param appId The application ID
+     * @param query The text typed so far
+     * @param limit Maximum number of results
+     */
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    fun searchPlacemarks(appId: String?, query: String?, limit: Double): WritableArray {
+        val results = Arguments.createArray()
+        if (appId.isNullOrEmpty() || query.isNullOrEmpty()) return results
+        val resultLimit = if (limit > 0) limit.toInt() else 20
+        for (hit in PlacemarkIndex.search(appId, query, resultLimit)) {
+            results.pushMap(Arguments.createMap().apply {
+                putString("id", hit.row.placemarkId)
+                putString("mapId", hit.row.mapId)
+                putString("name", hit.row.name)
+                putString("type", hit.row.type)
+                putDouble("x", hit.row.x.toDouble())
+                putDouble("y", hit.row.y.toDouble())
+                putDouble("score", hit.score.toDouble())
+            })
+        }
+        return results
+    }
+
+    /**
+     * Start a route on the map view with [reactTag] and resolve with the phase timings
+     * once the route is on screen
+     */
+    @ReactMethod
+    fun startRoute(reactTag: Double, placemarkId: String?, promise: Promise) {
+        if (placemarkId.isNullOrEmpty()) {
+            promise.reject("INVALID_ARGUMENT", "placemarkID is required")
+            return
+        }
+        withMapView(reactTag, promise) { view ->
+            view.startRouteToPlacemark(placemarkId) { timings, error ->
+                if (timings != null) {
+                    promise.resolve(timings)
+                } else {
+                    promise.reject("ROUTE_ERROR", error?.message ?: "Route failed", error)
+                }
+            }
+        }
+    }
+
+    /**
+     * Counters of the request broker shared by every map view
+     */
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    fun getRequestStats(): WritableMap {
+        val stats = RequestBroker.stats()
+        return Arguments.createMap().apply {
+            putDouble("hits", stats.hits.toDouble())
+            putDouble("misses", stats.misses.toDouble())
+            putDouble("coalesced", stats.coalesced.toDouble())
+            putDouble("cancelled", stats.cancelled.toDouble())
+            putInt("inFlight", stats.inFlight)
+            putInt("cached", stats.cached)
+        }
+    }
+
+    /**
+     * Map view events sent to JS and dropped by event masks, in total and per event
+     */
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    fun getEventStats(): WritableMap {
+        var dispatched = 0L
+        var suppressed = 0L
+        val byEvent = Arguments.createMap()
+        for ((name, counts) in MapViewEvent.stats()) {
+            dispatched += counts.first
+            suppressed += counts.second
+            byEvent.putMap(name, Arguments.createMap().apply {
+                putDouble("dispatched", counts.first.toDouble())
+                putDouble("suppressed", counts.second.toDouble())
+            })
+        }
+        return Arguments.createMap().apply {
+            putDouble("dispatched", dispatched.toDouble())
+            putDouble("suppressed", suppressed.toDouble())
+            putMap("byEvent", byEvent)
+        }
+    }
+
+    /**
+     * Location fixes offered to, sent by and dropped or coalesced by the views' throttles
+     */
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    fun getLocationUpdateStats(): WritableMap {
+        return Arguments.createMap().apply {
+            for ((name, count) in LocationThrottle.totalStats()) {
+                putDouble(name, count.toDouble())
+            }
+        }
+    }
+
+    /**
+     * Time the views' positioning spent active, waking while still and paused, with
+     * the fixes, pauses, motion resumes and wakes behind it
+     */
+    @ReactMethod(isBlockingSynchronousMethod = true)
+    fun getLocationPowerStats(): WritableMap {
+        return Arguments.createMap().apply {
+            for ((name, value) in LocationDutyCycle.totalStats()) {
+                putDouble(name, value.toDouble())
+            }
+        }
+    }
+
+    /**
+     * Recent fixes of the map view with [reactTag] matching [options]; see LocationHistory.query
+     */
+    @ReactMethod
+    fun getLocationHistory(reactTag: Double, options: ReadableMap?, promise: Promise) {
+        withMapView(reactTag, promise) { view ->
+            promise.resolve(view.locationHistory.query(options))
+        }
+    }
+
+    /**
+     * Register geofences on the map view with [reactTag]; see GeofenceEngine.add
+     */
+    @ReactMethod
+    fun addGeofences(reactTag: Double, geofences: ReadableArray, promise: Promise) {
+        withMapView(reactTag, promise) { view ->
+            try {
+                view.addGeofences(geofences)
+                promise.resolve(null)
+            } catch (e: IllegalArgumentException) {
+                promise.reject("INVALID_ARGUMENT", e.message, e)
+            }
+        }
+    }
+
+    /**
+     * Forget geofences of the map view with [reactTag] without reporting exits; null
+     * forgets all of them
+     */
+    @ReactMethod
+    fun removeGeofences(reactTag: Double, ids: ReadableArray?, promise: Promise) {
+        withMapView(reactTag, promise) { view ->
+            view.geofenceEngine.remove(ids)
+            promise.resolve(null)
+        }
+    }
+
+    // Runs block on the UI thread with the map view of reactTag, or rejects
+    private fun withMapView(reactTag: Double, promise: Promise, block: (MeridianMapContainerView) -> Unit) {
+        val uiManager = reactContext.getNativeModule(UIManagerModule::class.java)
+        if (uiManager == null) {
+            promise.reject("INVALID_ARGUMENT", "UIManager is not available")
+            return
+        }
+        uiManager.addUIBlock { registry ->
+            val view = try {
+                registry.resolveView(reactTag.toInt()) as? MeridianMapContainerView
+            } catch (e: Exception) {
+                null
+            }
+            if (view == null) {
+                promise.reject("INVALID_ARGUMENT", "No MeridianMapView with tag #${reactTag.toInt()}")
+                return@addUIBlock
+            }
+            block(view)
+        }
+    }
+
+    /**
+     * Record the fixes the map views receive to [path], or to a new file under the
+     * cache directory when it is empty. Resolves with the path.
+     */
+    @ReactMethod
+    fun startLocationRecording(path: String?, promise: Promise) {
+        val target = if (path.isNullOrEmpty()) {
+            val directory = File(reactContext.cacheDir, "location-traces").apply { mkdirs() }
+            File(directory, "${System.currentTimeMillis()}.mmlt").path
+        } else {
+            path
+        }
+        Handler(Looper.getMainLooper()).post {
+            try {
+                LocationRecorder.start(target)
+                promise.resolve(target)
+            } catch (e: IOException) {
+                promise.reject("TRACE_ERROR", e.message, e)
+            }
+        }
+    }
+
+    @ReactMethod
+    fun stopLocationRecording(promise: Promise) {
+        Handler(Looper.getMainLooper()).post {
+            val path = LocationRecorder.path
+            if (!LocationRecorder.isRecording || path == null) {
+                promise.reject("TRACE_ERROR", "No location recording in progress")
+                return@post
+            }
+            val fixes = LocationRecorder.stop()
+            promise.resolve(Arguments.createMap().apply {
+                putString("path", path)
+                putInt("fixes", fixes)
+            })
+        }
+    }
+
+    /**
+     * Feed a recorded trace to the map views at [speed] times the recorded pace
+     * (0 for as fast as possible). Resolves when it ends or is stopped.
+     */
+    @ReactMethod
+    fun replayLocationTrace(path: String, speed: Double, promise: Promise) {
+        Handler(Looper.getMainLooper()).post {
+            val start = SystemClock.uptimeMillis()
+            try {
+                LocationReplay.start(path, speed) { fixes, finished ->
+                    promise.resolve(Arguments.createMap().apply {
+                        putInt("fixes", fixes)
+                        putBoolean("finished", finished)
+                        putDouble("durationMs", (SystemClock.uptimeMillis() - start).toDouble())
+                    })
+                }
+            } catch (e: IOException) {
+                promise.reject("TRACE_ERROR", e.message, e)
+            }
+        }
+    }
+
+    @ReactMethod
+    fun stopLocationReplay() {
+        Handler(Looper.getMainLooper()).post { LocationReplay.stop() }
+    }
+
+    private fun parseQuery(index: Int, query: ReadableMap?): PlacemarkStore.Query {
+        fun fail(reason: String): Nothing = throw IllegalArgumentException("Query $index: $reason")
+        fun number(key: String): Float? =
+            if (query != null && query.hasKey(key) && query.getType(key) == ReadableType.Number) query.getDouble(key).toFloat() else null
+
+        if (query == null) fail("expected an object")
+        val kind = when (query.getString("kind")) {
+            "nearest" -> PlacemarkStore.QueryKind.NEAREST
+            "radius" -> PlacemarkStore.QueryKind.RADIUS
+            "rect" -> PlacemarkStore.QueryKind.RECT
+            else -> fail("kind must be nearest, radius or rect")
+        }
+        val mapId = query.getString("mapId")?.takeIf { it.isNotEmpty() } ?: fail("mapId is required")
+        val limit = number("limit")?.toInt()?.takeIf { it >= 0 }
+            ?: if (kind == PlacemarkStore.QueryKind.NEAREST) 10 else 100
+        val types = if (query.hasKey("types") && query.getType("types") == ReadableType.Array) {
+            val array = query.getArray("types")!!
+            Array(array.size()) { array.getString(it) ?: "" }
+        } else {
+            emptyArray()
+        }
+
+        if (kind == PlacemarkStore.QueryKind.RECT) {
+            val rect = floatArrayOf(
+                number("minX") ?: fail("rect queries need minX, minY, maxX and maxY"),
+                number("minY") ?: fail("rect queries need minX, minY, maxX and maxY"),
+                number("maxX") ?: fail("rect queries need minX, minY, maxX and maxY"),
+                number("maxY") ?: fail("rect queries need minX, minY, maxX and maxY")
+            )
+            return PlacemarkStore.Query(kind, mapId, rect = rect, limit = limit, types = types)
+        }
+        val x = number("x") ?: fail("x and y are required")
+        val y = number("y") ?: fail("x and y are required")
+        val radius = number("radius")
+            ?: if (kind == PlacemarkStore.QueryKind.RADIUS) fail("radius is required") else Float.POSITIVE_INFINITY
+        return PlacemarkStore.Query(kind, mapId, x, y, radius, limit = limit, types = types)
+    }
 }
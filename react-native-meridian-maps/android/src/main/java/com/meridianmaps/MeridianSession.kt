@@ -0,0 +1,270 @@
+package com.meridianmaps
+
+import android.Manifest
+import android.app.Application
+import android.content.pm.PackageManager
+import android.os.Handler
+import android.os.Looper
+import android.os.SystemClock
+import android.util.Log
+import androidx.core.content.ContextCompat
+import com.arubanetworks.meridian.Meridian
+import com.arubanetworks.meridian.editor.EditorKey
+import com.arubanetworks.meridian.location.LocationRequest
+import com.arubanetworks.meridian.location.MeridianLocation
+import com.arubanetworks.meridian.maps.MapInfo
+import com.arubanetworks.meridian.requests.MapInfoRequest
+import com.arubanetworks.meridian.requests.MeridianRequest
+
+/**
+ * Process-wide SDK session shared by every MeridianMapContainerView.
+ *
+ * The SDK is configured once, by [prewarm] or by the first view that mounts.
+ * [prewarm] also starts positioning for one fix, fetches the default floor and
+ * maps the placemark snapshot, so the view that follows starts from warm
+ * caches. Views report how long they took to first render, split by whether a
+ * prewarm had started before they were created. Main thread only, except [stats].
+ */
+object MeridianSession {
+    private const val TAG = "MeridianSession"
+    // How long a fetched floor may be reused through RequestBroker
+    private const val MAP_INFO_TTL_MS = 300_000L
+    // The warm-up fix only primes positioning; nothing waits on it
+    private const val WARM_FIX_TIMEOUT_MS = 10_000L
+
+    fun interface Callback {
+        // Phase timings in milliseconds, or the error
+        fun onResult(timings: Map<String, Double>?, error: Throwable?)
+    }
+
+    private enum class PrewarmState { NONE, RUNNING, DONE, FAILED }
+
+    // First renders of views created with or without a prewarm before them
+    private class RenderTimes {
+        var count = 0L
+        var totalMs = 0.0
+        var lastMs = 0.0
+    }
+
+    // The region of the latest prewarm, for venues that were never prewarmed
+    private var region = Meridian.DomainRegion.DomainRegionDefault
+    // The region each prewarmed app was given, and the one the SDK is set to
+    private val venueRegions = HashMap<String, Meridian.DomainRegion>()
+    private var appliedRegion: Meridian.DomainRegion? = null
+    private val pendingPrewarms = HashMap<String, MutableList<Callback>>()
+    // Apps used with a token other than the SDK's, in the order they were first seen
+    private val tokenMismatches = LinkedHashSet<String>()
+    private val prewarmTimings = HashMap<String, Map<String, Double>>()
+    private var warmFix: LocationRequest? = null
+    private val mainHandler = Handler(Looper.getMainLooper())
+
+    /**
+     * Whether [prewarm] has been called
+     */
+    @Volatile var isPrewarmed = false
+        private set
+
+    // Read by stats on the JS thread; guarded by the session's lock
+    private var prewarmState = PrewarmState.NONE
+    private var prewarmMs = 0.0
+    private val coldRenders = RenderTimes()
+    private val warmRenders = RenderTimes()
+
+    /**
+     * Parses "default", "us" or "eu"; null for anything else
+     */
+    @JvmStatic
+    fun parseRegion(name: String?): Meridian.DomainRegion? =
+        when (name?.lowercase()) {
+            null, "default" -> Meridian.DomainRegion.DomainRegionDefault
+            "us" -> Meridian.DomainRegion.DomainRegionUS
+            "eu" -> Meridian.DomainRegion.DomainRegionEU
+            else -> null
+        }
+
+    /**
+     * Configures the SDK unless it already runs with these credentials, see
+     * [MeridianMapViewManager.configureSdkIfNeeded], sets the domain region
+     * [appId] was prewarmed with, or [region] when given, and makes [appId]
+     * the active venue in [VenueRegistry]
+     */
+    @JvmStatic
+    fun configure(
+        application: Application,
+        appId: String,
+        mapId: String,
+        token: String,
+        region: Meridian.DomainRegion? = null
+    ): Boolean {
+        if (!MeridianMapViewManager.configureSdkIfNeeded(application, application, appId, mapId, token)) {
+            return false
+        }
+        if (region != null) {
+            venueRegions[appId] = region
+            this.region = region
+        }
+        val venueRegion = venueRegions[appId] ?: this.region
+        if (venueRegion != appliedRegion) {
+            Meridian.getShared().setDomainRegion(venueRegion)
+            appliedRegion = venueRegion
+        }
+        // Meridian.configure only takes effect once per process, so this app's
+        // requests go out with the first token; JS sees it in getVenueStats
+        val sdkToken = MeridianMapViewManager.configuredToken()
+        if (sdkToken != null && sdkToken != token && synchronized(this) { tokenMismatches.add(appId) }) {
+            Log.w(TAG, "The Meridian SDK keeps the token it was configured with; appId=$appId asked for another")
+        }
+        VenueRegistry.activate(appId)
+        return true
+    }
+
+    /**
+     * Apps configured with a token the SDK could not switch to
+     */
+    @JvmStatic
+    fun tokenMismatches(): List<String> = synchronized(this) { tokenMismatches.toList() }
+
+    /**
+     * Forget the prewarm of a venue [VenueRegistry] released, so the next one runs again
+     */
+    @JvmStatic
+    fun release(appId: String) {
+        if (!pendingPrewarms.containsKey(appId)) {
+            prewarmTimings.remove(appId)
+        }
+    }
+
+    /**
+     * Configures the SDK, primes positioning and loads [mapId] and the app's
+     * placemark snapshot. A second call for an app that is already warm or
+     * warming joins the first.
+     */
+    @JvmStatic
+    fun prewarm(
+        application: Application,
+        appId: String,
+        mapId: String,
+        token: String,
+        region: Meridian.DomainRegion,
+        callback: Callback
+    ) {
+        isPrewarmed = true
+        prewarmTimings[appId]?.let {
+            callback.onResult(it, null)
+            return
+        }
+        pendingPrewarms[appId]?.let {
+            it.add(callback)
+            return
+        }
+        pendingPrewarms[appId] = mutableListOf(callback)
+        synchronized(this) { prewarmState = PrewarmState.RUNNING }
+
+        val start = SystemClock.elapsedRealtimeNanos()
+        fun elapsedMs() = (SystemClock.elapsedRealtimeNanos() - start) / 1e6
+        if (!configure(application, appId, mapId, token, region)) {
+            finishPrewarm(appId, emptyMap(), IllegalStateException("Failed to configure the Meridian SDK"))
+            return
+        }
+        val timings = linkedMapOf("configureMs" to elapsedMs())
+        val appKey = EditorKey.forApp(appId)
+        startWarmFix(application, appKey)
+
+        // Placemarks arrive with each floor on Android, so the snapshot is what can be warmed ahead
+        PlacemarkIndex.attach(application)
+        PlacemarkIndex.warm(appId)
+        timings["placemarksMs"] = elapsedMs()
+
+        val mapKey = EditorKey.forMap(mapId, appKey)
+        RequestBroker.request(
+            RequestBroker.fingerprint("maps", appId, mapId),
+            MAP_INFO_TTL_MS,
+            RequestBroker.Operation<MapInfo> { complete ->
+                val request = MapInfoRequest.Builder()
+                    .setMapKey(mapKey)
+                    .setListener(MeridianRequest.Listener<MapInfo> { complete.onResult(it, null) })
+                    .setErrorListener(MeridianRequest.ErrorListener { complete.onResult(null, it) })
+                    .build()
+                request.sendRequest()
+                Runnable { request.cancel() }
+            }
+        ) { _, error ->
+            if (error != null) {
+                Log.w(TAG, "Failed to prefetch map $mapId", error)
+            }
+            timings["mapMs"] = elapsedMs()
+            timings["totalMs"] = elapsedMs()
+            finishPrewarm(appId, timings, error)
+        }
+    }
+
+    // One fix starts the positioning engine's scans; skipped without permission rather than prompting
+    private fun startWarmFix(application: Application, appKey: EditorKey) {
+        if (warmFix != null ||
+            ContextCompat.checkSelfPermission(application, Manifest.permission.ACCESS_FINE_LOCATION) !=
+            PackageManager.PERMISSION_GRANTED
+        ) {
+            return
+        }
+        warmFix = LocationRequest.requestCurrentLocation(application, appKey, object : LocationRequest.LocationRequestListener {
+            override fun onResult(location: MeridianLocation) {
+                warmFix = null
+            }
+
+            override fun onError(errorType: LocationRequest.ErrorType) {
+                warmFix = null
+            }
+        })
+        mainHandler.postDelayed({
+            warmFix?.cancel()
+            warmFix = null
+        }, WARM_FIX_TIMEOUT_MS)
+    }
+
+    private fun finishPrewarm(appId: String, timings: Map<String, Double>, error: Throwable?) {
+        val callbacks = pendingPrewarms.remove(appId).orEmpty()
+        synchronized(this) {
+            prewarmState = if (error != null) PrewarmState.FAILED else PrewarmState.DONE
+            prewarmMs = timings["totalMs"] ?: 0.0
+        }
+        // A failed prewarm may be retried; a finished one is answered from its timings
+        if (error == null) {
+            prewarmTimings[appId] = timings
+        }
+        Log.d(TAG, "Prewarmed app $appId in ${timings["totalMs"]} ms${if (error != null) " with errors" else ""}")
+        for (callback in callbacks) {
+            callback.onResult(if (error == null) timings else null, error)
+        }
+    }
+
+    /**
+     * A view finished loading its first floor [ms] milliseconds after it was created
+     */
+    @JvmStatic
+    fun recordFirstRender(ms: Double, prewarmed: Boolean) {
+        synchronized(this) {
+            val times = if (prewarmed) warmRenders else coldRenders
+            times.count++
+            times.totalMs += ms
+            times.lastMs = ms
+        }
+    }
+
+    /**
+     * prewarmState ("none", "running", "done" or "failed") and prewarmMs, then count,
+     * mean and last first-render time of views created without and with a prewarm
+     */
+    @JvmStatic
+    fun stats(): Map<String, Any> = synchronized(this) {
+        mapOf(
+            "prewarmState" to prewarmState.name.lowercase(),
+            "prewarmMs" to prewarmMs,
+            "coldRenders" to coldRenders.count,
+            "coldRenderMeanMs" to if (coldRenders.count > 0) coldRenders.totalMs / coldRenders.count else 0.0,
+            "coldRenderLastMs" to coldRenders.lastMs,
+            "warmRenders" to warmRenders.count,
+            "warmRenderMeanMs" to if (warmRenders.count > 0) warmRenders.totalMs / warmRenders.count else 0.0,
+            "warmRenderLastMs" to warmRenders.lastMs
+        )
+    }
+}
@@ -0,0 +1,256 @@
+package com.meridianmaps
+
+import android.content.Context
+import android.graphics.PointF
+import android.util.Log
+import com.arubanetworks.meridian.editor.EditorKey
+import com.arubanetworks.meridian.editor.Placemark
+import java.io.File
+import java.io.IOException
+import java.net.HttpURLConnection
+import java.net.URL
+import java.util.concurrent.ConcurrentHashMap
+import java.util.concurrent.Executors
+import java.util.concurrent.TimeUnit
+
+/**
+ * Process-wide index from placemark ID to the floor, point and type of that placemark,
+ * shared by every MeridianMapContainerView of the same app.
+ *
+ * Records live in a native [PlacemarkStore] per app, persisted as a snapshot in the
+ * cache directory and memory-mapped again on the next start, so IDs seen in a
+ * previous session resolve before any map has loaded.
+ */
+object PlacemarkIndex {
+    private const val TAG = "PlacemarkIndex"
+    // Floors loaded within this long of each other go to disk in one snapshot write
+    private const val SNAPSHOT_DELAY_MS = 5_000L
+
+    data class Record(
+        val placemarkId: String,
+        val mapKey: EditorKey,
+        val point: PointF,
+        val type: String?,
+        val name: String?
+    )
+
+    private val storesByApp = ConcurrentHashMap<String, PlacemarkStore>()
+    private val snapshotWriter = Executors.newSingleThreadScheduledExecutor()
+    // Apps with a snapshot write scheduled
+    private val pendingSnapshots = ConcurrentHashMap.newKeySet<String>()
+    @Volatile private var snapshotDir: File? = null
+
+    /**
+     * Enable snapshots; call before the first lookup
+     */
+    @JvmStatic
+    fun attach(context: Context) {
+        if (snapshotDir == null) {
+            snapshotDir = File(context.applicationContext.cacheDir, "meridianmaps").apply { mkdirs() }
+        }
+    }
+
+    private fun snapshotFile(appId: String): File? = snapshotDir?.let { File(it, "placemarks-$appId.mmps") }
+
+    private fun manifestFile(appId: String): File? = snapshotDir?.let { File(it, "placemarks-$appId.sync") }
+
+    private fun storeFor(appId: String): PlacemarkStore =
+        storesByApp.getOrPut(appId) {
+            val snapshot = snapshotFile(appId)?.takeIf { it.exists() }?.let { PlacemarkStore.openSnapshot(it.path) }
+            if (snapshot != null) {
+                Log.d(TAG, "Mapped ${snapshot.size} placemarks for app $appId from snapshot")
+            }
+            snapshot ?: PlacemarkStore()
+        }
+
+    /**
+     * Map the app's snapshot ahead of the first lookup; returns the placemarks it holds
+     */
+    @JvmStatic
+    fun warm(appId: String): Int = storeFor(appId).size
+
+    /**
+     * Merge placemarks loaded by a map view into the index
+     */
+    @JvmStatic
+    fun addPlacemarks(appId: String, placemarks: Iterable<Placemark>) {
+        val indexed = placemarks.filter { it.key?.parent != null }
+        val ids = Array(indexed.size) { indexed[it].key.id }
+        val mapIds = Array(indexed.size) { indexed[it].key.parent.id }
+        val names = Array(indexed.size) { indexed[it].name ?: "" }
+        val types = Array(indexed.size) { indexed[it].type ?: "" }
+        val coords = FloatArray(indexed.size * 6)
+        indexed.forEachIndexed { i, placemark ->
+            // Only the point is known here; it doubles as the bounding box
+            for (j in 0 until 3) {
+                coords[i * 6 + j * 2] = placemark.x
+                coords[i * 6 + j * 2 + 1] = placemark.y
+            }
+        }
+
+        val store = storeFor(appId)
+        val revision = store.revision
+        store.upsertAll(ids, mapIds, names, types, coords)
+        Log.d(TAG, "Indexed ${ids.size} placemarks for app $appId (${store.size} total)")
+
+        // A floor seen before leaves the snapshot as it is
+        if (store.revision != revision) {
+            scheduleSnapshot(appId)
+        }
+    }
+
+    private fun scheduleSnapshot(appId: String) {
+        if (snapshotFile(appId) == null || !pendingSnapshots.add(appId)) return
+        snapshotWriter.schedule({
+            if (pendingSnapshots.remove(appId)) {
+                storesByApp[appId]?.let { writeSnapshot(appId, it) }
+            }
+        }, SNAPSHOT_DELAY_MS, TimeUnit.MILLISECONDS)
+    }
+
+    // On the snapshot writer
+    private fun writeSnapshot(appId: String, store: PlacemarkStore) {
+        val file = snapshotFile(appId) ?: return
+        if (!store.writeSnapshot(file.path)) {
+            Log.w(TAG, "Failed to write placemark snapshot for app $appId")
+        }
+    }
+
+    @JvmStatic
+    fun lookup(appId: String, placemarkId: String): Record? {
+        val row = storeFor(appId).get(placemarkId) ?: return null
+        return Record(
+            row.placemarkId,
+            EditorKey.forMap(row.mapId, appId),
+            PointF(row.x, row.y),
+            row.type.ifEmpty { null },
+            row.name.ifEmpty { null }
+        )
+    }
+
+    /**
+     * Run a batch of spatial queries against the app's per-floor R-trees
+     */
+    @JvmStatic
+    fun query(appId: String, queries: List<PlacemarkStore.Query>): List<List<PlacemarkStore.Hit>> =
+        storeFor(appId).query(queries)
+
+    /**
+     * Typeahead search over the placemarks the app's store already holds
+     */
+    @JvmStatic
+    fun search(appId: String, query: String, limit: Int): List<PlacemarkStore.SearchHit> =
+        storeFor(appId).search(query, limit)
+
+    /**
+     * Incrementally sync the app's placemarks from a placemark sync endpoint,
+     * see [PlacemarkStore.sync]. Runs on the snapshot writer so it never races
+     * a snapshot write; [callback] gets the stats or an error message.
+     */
+    @JvmStatic
+    fun sync(
+        appId: String,
+        baseUrl: String,
+        mapIds: List<String>,
+        pageSize: Int,
+        headers: Map<String, String>,
+        callback: (PlacemarkStore.SyncStats?, String?) -> Unit
+    ) = runSync(appId, baseUrl, mapIds, pageSize, httpFetcher(headers), "the sync endpoint", callback)
+
+    /**
+     * Fill the empty index of [bundle]'s app from the placemark pages packed
+     * into it, like [sync] but offline, so a fresh install has its placemarks
+     * before the network answers. An index that already holds placemarks is
+     * left alone and [callback] gets neither stats nor error.
+     */
+    @JvmStatic
+    fun seed(bundle: AssetBundle, callback: (PlacemarkStore.SyncStats?, String?) -> Unit) {
+        // A snapshot or an earlier sync is newer than anything packed at build time
+        if (storeFor(bundle.appId).size > 0) {
+            callback(null, null)
+            return
+        }
+        runSync(bundle.appId, bundle.baseUrl, bundle.mapIds, bundle.pageSize, bundle.fetcher(), "the asset bundle", callback)
+    }
+
+    private fun runSync(
+        appId: String,
+        baseUrl: String,
+        mapIds: List<String>,
+        pageSize: Int,
+        fetcher: PlacemarkStore.HttpFetcher,
+        source: String,
+        callback: (PlacemarkStore.SyncStats?, String?) -> Unit
+    ) {
+        val snapshot = snapshotFile(appId)
+        val manifest = manifestFile(appId)
+        if (snapshot == null || manifest == null) {
+            callback(null, "PlacemarkIndex.attach() has not been called")
+            return
+        }
+        val store = storeFor(appId)
+        snapshotWriter.execute {
+            val started = System.nanoTime()
+            try {
+                val stats = store.sync(baseUrl, mapIds, pageSize, snapshot.path, manifest.path, fetcher)
+                Log.d(TAG, "Synced app $appId from $source in ${(System.nanoTime() - started) / 1_000_000} ms: $stats")
+                callback(stats, null)
+            } catch (e: IOException) {
+                Log.w(TAG, "Placemark sync from $source failed for app $appId: ${e.message}")
+                callback(null, e.message)
+            }
+        }
+    }
+
+    private fun httpFetcher(headers: Map<String, String>) = PlacemarkStore.HttpFetcher { url, etag ->
+        var connection: HttpURLConnection? = null
+        try {
+            connection = (URL(url).openConnection() as HttpURLConnection).apply {
+                // The HTTP cache would answer conditional requests itself and hide the 304s
+                useCaches = false
+                connectTimeout = 15_000
+                readTimeout = 30_000
+                headers.forEach { (field, value) -> setRequestProperty(field, value) }
+                if (etag != null) setRequestProperty("If-None-Match", etag)
+            }
+            val status = connection.responseCode
+            val stream = if (status >= 400) connection.errorStream else connection.inputStream
+            val body = if (status == HttpURLConnection.HTTP_NOT_MODIFIED) ByteArray(0) else stream?.use { it.readBytes() }
+            PlacemarkStore.HttpResult(status, body ?: ByteArray(0), connection.getHeaderField("ETag"))
+        } catch (e: IOException) {
+            PlacemarkStore.HttpResult(0, ByteArray(0), null, e.message ?: e.javaClass.simpleName)
+        } finally {
+            connection?.disconnect()
+        }
+    }
+
+    @JvmStatic
+    fun size(appId: String): Int = storesByApp[appId]?.size ?: 0
+
+    /**
+     * Free the app's store; its snapshot stays on disk for the next lookup to map again
+     */
+    @JvmStatic
+    fun release(appId: String) {
+        val store = storesByApp.remove(appId) ?: return
+        // Behind any snapshot write still running for it; a scheduled one is written now
+        snapshotWriter.execute {
+            if (pendingSnapshots.remove(appId)) {
+                writeSnapshot(appId, store)
+            }
+            store.close()
+        }
+    }
+
+    @JvmStatic
+    fun invalidate(appId: String) {
+        storesByApp.remove(appId)?.close()
+        pendingSnapshots.remove(appId)
+        val file = snapshotFile(appId) ?: return
+        val manifest = manifestFile(appId)
+        snapshotWriter.execute {
+            file.delete()
+            manifest?.delete()
+        }
+    }
+}
@@ -0,0 +1,268 @@
+package com.meridianmaps
+
+import java.io.Closeable
+import java.io.IOException
+
+/**
+ * Kotlin handle on the shared C++ placemark store (cpp/PlacemarkStore.h).
+ *
+ * Placemarks are held in native columns instead of Placemark objects and can
+ * be persisted as a binary snapshot that is memory-mapped on the next start.
+ * All methods are synchronized; a closed store behaves as empty.
+ */
+class PlacemarkStore private constructor(private var handle: Long) : Closeable {
+
+    /**
+     * Lightweight placemark row as returned by [get]
+     */
+    data class Row(
+        val placemarkId: String,
+        val mapId: String,
+        val x: Float,
+        val y: Float,
+        val type: String,
+        val name: String
+    )
+
+    enum class QueryKind { NEAREST, RADIUS, RECT }
+
+    /**
+     * Spatial query against one floor, see cpp/SpatialIndex.h. Rect queries use
+     * [rect] (minX, minY, maxX, maxY); the others use [x], [y] and [radius].
+     * An empty [types] keeps every type.
+     */
+    data class Query(
+        val kind: QueryKind,
+        val mapId: String,
+        val x: Float = 0f,
+        val y: Float = 0f,
+        val radius: Float = Float.POSITIVE_INFINITY,
+        val rect: FloatArray = FloatArray(4),
+        val limit: Int,
+        val types: Array<String> = emptyArray()
+    )
+
+    data class Hit(val row: Row, val distance: Float)
+
+    data class SearchHit(val row: Row, val score: Float)
+
+    /**
+     * Response handed back to the native sync; [status] is 0 when the request
+     * could not be made, with the reason in [error]
+     */
+    class HttpResult(val status: Int, val body: ByteArray, val etag: String?, val error: String? = null)
+
+    /**
+     * Blocking GET used by [sync], sending [etag] as If-None-Match when set
+     */
+    fun interface HttpFetcher {
+        fun fetch(url: String, etag: String?): HttpResult
+    }
+
+    data class SyncStats(
+        val requests: Long,
+        val bytesReceived: Long,
+        val mapsUnchanged: Long,
+        val mapsDelta: Long,
+        val mapsFull: Long,
+        val upserted: Long,
+        val removed: Long,
+        val unchanged: Long
+    )
+
+    // A sync runs without holding the monitor, so close() waits for it to finish
+    private var activeSyncs = 0
+    private var closeRequested = false
+
+    constructor() : this(nativeCreate())
+
+    val size: Int
+        @Synchronized get() = if (handle != 0L) nativeSize(handle) else 0
+
+    // Changes with every upsert that changes a row, and every remove
+    val revision: Long
+        @Synchronized get() = if (handle != 0L) nativeRevision(handle) else 0
+
+    /**
+     * Insert or replace placemarks in one native call. [coords] holds x, y,
+     * minX, minY, maxX, maxY for every placemark.
+     */
+    @Synchronized
+    fun upsertAll(ids: Array<String>, mapIds: Array<String>, names: Array<String>, types: Array<String>, coords: FloatArray) {
+        require(ids.size == mapIds.size && ids.size == names.size && ids.size == types.size && coords.size == ids.size * 6)
+        if (handle != 0L) nativeUpsertAll(handle, ids, mapIds, names, types, coords)
+    }
+
+    @Synchronized
+    fun get(placemarkId: String): Row? {
+        if (handle == 0L) return null
+        val row = nativeFind(handle, placemarkId)
+        if (row < 0) return null
+        val point = nativePoint(handle, row)
+        return Row(placemarkId, nativeMapId(handle, row), point[0], point[1], nativeType(handle, row), nativeName(handle, row))
+    }
+
+    /**
+     * Run a batch of queries in one native call; returns one hit list per query
+     */
+    @Synchronized
+    fun query(queries: List<Query>): List<List<Hit>> {
+        if (handle == 0L) return queries.map { emptyList() }
+        val params = FloatArray(queries.size * 7)
+        queries.forEachIndexed { i, query ->
+            params[i * 7] = query.x
+            params[i * 7 + 1] = query.y
+            params[i * 7 + 2] = query.radius
+            query.rect.copyInto(params, i * 7 + 3, 0, 4)
+        }
+        val packed = nativeQuery(
+            handle,
+            IntArray(queries.size) { queries[it].kind.ordinal },
+            Array(queries.size) { queries[it].mapId },
+            params,
+            IntArray(queries.size) { queries[it].limit },
+            Array(queries.size) { queries[it].types }
+        )
+
+        // Per query: hit count, then (row << 32 | distance bits) per hit
+        val results = ArrayList<List<Hit>>(queries.size)
+        var cursor = 0
+        repeat(queries.size) {
+            val count = packed[cursor++].toInt()
+            results.add(List(count) {
+                val entry = packed[cursor++]
+                Hit(rowAt((entry ushr 32).toInt()), Float.fromBits(entry.toInt()))
+            })
+        }
+        return results
+    }
+
+    /**
+     * Typeahead search over names and types, best match first, see cpp/SearchIndex.h
+     */
+    @Synchronized
+    fun search(query: String, limit: Int): List<SearchHit> {
+        if (handle == 0L || limit <= 0) return emptyList()
+        return nativeSearch(handle, query, limit).map { entry ->
+            SearchHit(rowAt((entry ushr 32).toInt()), Float.fromBits(entry.toInt()))
+        }
+    }
+
+    private fun rowAt(row: Int): Row {
+        val point = nativePoint(handle, row)
+        return Row(nativeId(handle, row), nativeMapId(handle, row), point[0], point[1], nativeType(handle, row), nativeName(handle, row))
+    }
+
+    @Synchronized
+    fun clear() {
+        if (handle != 0L) nativeClear(handle)
+    }
+
+    @Synchronized
+    fun writeSnapshot(path: String): Boolean = handle != 0L && nativeWriteSnapshot(handle, path)
+
+    /**
+     * Bring the store up to date from a placemark sync endpoint (see
+     * cpp/PlacemarkSync.h), fetching only the floors and placemarks that changed
+     * since the manifest at [manifestPath] was written, then persist the snapshot
+     * and the manifest. Blocks on the network; the store stays readable
+     * meanwhile and is only locked while a page is applied.
+     * @throws IOException if any floor failed to sync; the floors that did are kept
+     */
+    fun sync(
+        baseUrl: String,
+        mapIds: List<String>,
+        pageSize: Int,
+        snapshotPath: String,
+        manifestPath: String,
+        fetcher: HttpFetcher
+    ): SyncStats {
+        val current = synchronized(this) {
+            if (handle == 0L) throw IOException("Placemark store is closed")
+            activeSyncs++
+            handle
+        }
+        try {
+            val error = arrayOfNulls<String>(1)
+            val counters = nativeSync(
+                current, this, baseUrl, mapIds.toTypedArray(), pageSize, snapshotPath, manifestPath, fetcher, error
+            )
+            if (counters[0] == 0L) throw IOException(error[0] ?: "Placemark sync failed")
+            return SyncStats(counters[1], counters[2], counters[3], counters[4], counters[5], counters[6], counters[7], counters[8])
+        } finally {
+            synchronized(this) {
+                activeSyncs--
+                if (closeRequested && activeSyncs == 0) close()
+            }
+        }
+    }
+
+    @Synchronized
+    override fun close() {
+        if (activeSyncs > 0) {
+            closeRequested = true
+            return
+        }
+        if (handle != 0L) {
+            nativeDestroy(handle)
+            handle = 0L
+        }
+    }
+
+    companion object {
+        init {
+            System.loadLibrary("meridianmaps")
+        }
+
+        /**
+         * Map a snapshot written by [writeSnapshot], or null if it is missing or unreadable
+         */
+        @JvmStatic
+        fun openSnapshot(path: String): PlacemarkStore? {
+            val handle = nativeOpenSnapshot(path)
+            return if (handle != 0L) PlacemarkStore(handle) else null
+        }
+
+        @JvmStatic private external fun nativeCreate(): Long
+        @JvmStatic private external fun nativeOpenSnapshot(path: String): Long
+        @JvmStatic private external fun nativeDestroy(handle: Long)
+        @JvmStatic private external fun nativeSize(handle: Long): Int
+        @JvmStatic private external fun nativeRevision(handle: Long): Long
+        @JvmStatic private external fun nativeUpsertAll(
+            handle: Long,
+            ids: Array<String>,
+            mapIds: Array<String>,
+            names: Array<String>,
+            types: Array<String>,
+            coords: FloatArray
+        )
+        @JvmStatic private external fun nativeFind(handle: Long, placemarkId: String): Int
+        @JvmStatic private external fun nativeId(handle: Long, row: Int): String
+        @JvmStatic private external fun nativeMapId(handle: Long, row: Int): String
+        @JvmStatic private external fun nativeName(handle: Long, row: Int): String
+        @JvmStatic private external fun nativeType(handle: Long, row: Int): String
+        @JvmStatic private external fun nativePoint(handle: Long, row: Int): FloatArray
+        @JvmStatic private external fun nativeQuery(
+            handle: Long,
+            kinds: IntArray,
+            mapIds: Array<String>,
+            params: FloatArray,
+            limits: IntArray,
+            types: Array<Array<String>>
+        ): LongArray
+        @JvmStatic private external fun nativeSearch(handle: Long, query: String, limit: Int): LongArray
+        @JvmStatic private external fun nativeSync(
+            handle: Long,
+            lock: Any,
+            baseUrl: String,
+            mapIds: Array<String>,
+            pageSize: Int,
+            snapshotPath: String,
+            manifestPath: String,
+            fetcher: HttpFetcher,
+            error: Array<String?>
+        ): LongArray
+        @JvmStatic private external fun nativeClear(handle: Long)
+        @JvmStatic private external fun nativeWriteSnapshot(handle: Long, path: String): Boolean
+    }
+}
@@ -0,0 +1,256 @@
+package com.meridianmaps
+
+import android.graphics.PointF
+import android.os.Handler
+import android.os.Looper
+import android.os.SystemClock
+import com.arubanetworks.meridian.editor.EditorKey
+import com.arubanetworks.meridian.maps.directions.Directions
+import com.arubanetworks.meridian.maps.directions.DirectionsDestination
+import com.arubanetworks.meridian.maps.directions.DirectionsResponse
+import com.arubanetworks.meridian.maps.directions.DirectionsSource
+import com.arubanetworks.meridian.maps.directions.TransportType
+import java.util.Locale
+import java.util.concurrent.CancellationException
+import kotlin.math.roundToLong
+
+/**
+ * Shares placemark, map and directions requests between every view of the app.
+ *
+ * Requests are keyed by a normalized fingerprint (see [fingerprint]). A request whose
+ * key is already in flight joins it instead of starting another SDK call, and every
+ * subscriber receives the same result. Successful results are kept for the TTL given
+ * by the request; errors are never cached. The shared operation is cancelled only
+ * when its last subscriber leaves. Thread-safe; callbacks always run on the main thread.
+ */
+object RequestBroker {
+    private const val CACHE_LIMIT = 256
+    // Map units per grid cell when fingerprinting points
+    private const val POINT_GRID = 2f
+    // Routes between fixed points; a route from a location fix is keyed by that fix
+    private const val DIRECTIONS_TTL_MS = 15_000L
+
+    /**
+     * Receives the shared result, or the error, on the main thread
+     */
+    fun interface Callback<T> {
+        fun onResult(result: T?, error: Throwable?)
+    }
+
+    /**
+     * Starts the underlying SDK call and reports its outcome once through [complete].
+     * Returns a runnable that cancels the call, or null if it cannot be cancelled.
+     */
+    fun interface Operation<T> {
+        fun start(complete: Callback<T>): Runnable?
+    }
+
+    /**
+     * One caller's interest in a brokered request
+     */
+    class Subscription internal constructor(val key: String, callback: Callback<Any>) {
+        private var callback: Callback<Any>? = callback
+
+        /**
+         * Stops delivery to this subscriber; the shared call keeps running for the others
+         */
+        fun cancel() {
+            synchronized(this) {
+                if (callback == null) return
+                callback = null
+            }
+            unsubscribe(this)
+        }
+
+        internal fun deliver(result: Any?, error: Throwable?) {
+            val target = synchronized(this) { callback.also { callback = null } } ?: return
+            target.onResult(result, error)
+        }
+    }
+
+    data class Stats(
+        val hits: Long,
+        val misses: Long,
+        val coalesced: Long,
+        val cancelled: Long,
+        val inFlight: Int,
+        val cached: Int
+    )
+
+    private class Entry(val key: String, var ttlMs: Long) {
+        val subscribers = mutableListOf<Subscription>()
+        var canceller: Runnable? = null
+        var finished = false
+        // Set when the last subscriber left before the call ended
+        var abandoned = false
+    }
+
+    private class CacheItem(val result: Any, val expiresAt: Long)
+
+    private val lock = Any()
+    private val mainHandler = Handler(Looper.getMainLooper())
+    private val inFlight = HashMap<String, Entry>()
+    private val cache = HashMap<String, CacheItem>()
+    private var hits = 0L
+    private var misses = 0L
+    private var coalesced = 0L
+    private var cancelled = 0L
+
+    @JvmStatic
+    fun <T : Any> request(key: String, ttlMs: Long, operation: Operation<T>, callback: Callback<T>): Subscription {
+        @Suppress("UNCHECKED_CAST")
+        val subscription = Subscription(key, callback as Callback<Any>)
+        val entry: Entry
+        synchronized(lock) {
+            val cached = cache[key]
+            if (cached != null && cached.expiresAt > SystemClock.elapsedRealtime()) {
+                hits++
+                // Stay asynchronous on hits too, so callers see the same ordering either way
+                mainHandler.post { subscription.deliver(cached.result, null) }
+                return subscription
+            }
+            cache.remove(key)
+            val existing = inFlight[key]
+            if (existing != null) {
+                coalesced++
+                existing.ttlMs = maxOf(existing.ttlMs, ttlMs)
+                existing.subscribers.add(subscription)
+                return subscription
+            }
+            misses++
+            entry = Entry(key, ttlMs).also { it.subscribers.add(subscription) }
+            inFlight[key] = entry
+        }
+
+        val canceller = operation.start { result, error -> finish(entry, result, error) }
+        val cancelNow = synchronized(lock) {
+            entry.canceller = canceller
+            // Every subscriber may have left while the call was starting
+            entry.abandoned
+        }
+        if (cancelNow) canceller?.run()
+        return subscription
+    }
+
+    private fun finish(entry: Entry, result: Any?, error: Throwable?) {
+        val subscribers: List<Subscription>
+        synchronized(lock) {
+            if (entry.finished) return
+            entry.finished = true
+            entry.canceller = null
+            if (inFlight[entry.key] === entry) inFlight.remove(entry.key)
+            if (error == null && result != null && entry.ttlMs > 0) {
+                cache[entry.key] = CacheItem(result, SystemClock.elapsedRealtime() + entry.ttlMs)
+                trimCacheLocked()
+            }
+            subscribers = entry.subscribers.toList()
+            entry.subscribers.clear()
+        }
+        val deliver = Runnable { subscribers.forEach { it.deliver(result, error) } }
+        if (Looper.myLooper() == Looper.getMainLooper()) deliver.run() else mainHandler.post(deliver)
+    }
+
+    private fun unsubscribe(subscription: Subscription) {
+        val canceller = synchronized(lock) {
+            val entry = inFlight[subscription.key] ?: return
+            if (!entry.subscribers.removeAll { it === subscription } || entry.subscribers.isNotEmpty()) return
+            inFlight.remove(entry.key)
+            entry.finished = true
+            entry.abandoned = true
+            cancelled++
+            entry.canceller.also { entry.canceller = null }
+        }
+        canceller?.run()
+    }
+
+    private fun trimCacheLocked() {
+        val now = SystemClock.elapsedRealtime()
+        cache.entries.removeAll { it.value.expiresAt <= now }
+        while (cache.size > CACHE_LIMIT) {
+            cache.remove(cache.minByOrNull { it.value.expiresAt }!!.key)
+        }
+    }
+
+    /**
+     * Drop cached results whose key starts with [prefix], e.g. after the app's data changed
+     */
+    @JvmStatic
+    fun invalidate(prefix: String) {
+        synchronized(lock) {
+            cache.keys.removeAll { it.startsWith(prefix) }
+        }
+    }
+
+    @JvmStatic
+    fun stats(): Stats = synchronized(lock) {
+        trimCacheLocked()
+        Stats(hits, misses, coalesced, cancelled, inFlight.size, cache.size)
+    }
+
+    /**
+     * Build a request key from a kind ("maps", "placemarks", "directions") and its
+     * components. The kind is lowercased and components are trimmed, so keys built from
+     * the same request by different callers compare equal; components keep their case,
+     * since placemark, map and app IDs are case-sensitive.
+     */
+    @JvmStatic
+    fun fingerprint(kind: String, vararg components: String?): String =
+        (listOf(kind.trim().lowercase(Locale.ROOT)) + components.map { (it ?: "").trim().replace("|", "%7C") })
+            .joinToString("|")
+
+    /**
+     * A fingerprint component for a point on a floor, snapped to a small grid so
+     * location jitter does not defeat sharing
+     */
+    @JvmStatic
+    fun pointComponent(mapKey: EditorKey?, point: PointF): String {
+        val x = (point.x / POINT_GRID).roundToLong()
+        val y = (point.y / POINT_GRID).roundToLong()
+        return "${mapKey?.id ?: ""}@$x,$y"
+    }
+
+    @JvmStatic
+    fun placemarkComponent(placemarkKey: EditorKey?): String = "placemark:${placemarkKey?.id ?: ""}"
+
+    /**
+     * Walking directions through the broker. [sourceKey] and [destinationKey] identify
+     * the endpoints (see [pointComponent] and [placemarkComponent]); the SDK types do
+     * not expose them. A cancelled calculation is reported as a [CancellationException].
+     */
+    @JvmStatic
+    fun requestDirections(
+        appKey: EditorKey,
+        source: DirectionsSource,
+        sourceKey: String,
+        destination: DirectionsDestination,
+        destinationKey: String,
+        callback: Callback<DirectionsResponse>
+    ): Subscription {
+        val key = fingerprint("directions", appKey.id, sourceKey, destinationKey, TransportType.WALKING.name)
+        return request(key, DIRECTIONS_TTL_MS, Operation<DirectionsResponse> { complete ->
+            val directions = Directions.Builder()
+                .setAppKey(appKey)
+                .setSource(source)
+                .setDestination(destination)
+                .setTransportType(TransportType.WALKING)
+                .setListener(object : Directions.DirectionsRequestListener {
+                    override fun onDirectionsRequestStart() {}
+
+                    override fun onDirectionsRequestComplete(response: DirectionsResponse) {
+                        complete.onResult(response, null)
+                    }
+
+                    override fun onDirectionsRequestError(tr: Throwable) {
+                        complete.onResult(null, tr)
+                    }
+
+                    override fun onDirectionsRequestCanceled() {
+                        complete.onResult(null, CancellationException("Directions request canceled"))
+                    }
+                })
+                .build()
+            directions.calculate()
+            Runnable { directions.cancel() }
+        }, callback)
+    }
+}
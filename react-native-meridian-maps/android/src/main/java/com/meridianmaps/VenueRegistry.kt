@@ -0,0 +1,81 @@
+package com.meridianmaps
+
+import android.util.Log
+
+/**
+ * Venues whose caches stay in memory (cpp/VenueRegistry.h).
+ *
+ * [MeridianSession.configure] activates a venue whenever a view or a prewarm
+ * uses an app. The most recently active venues, up to [maxWarmVenues], keep
+ * their placemark store, prewarm and cached requests, so switching back to one
+ * does not start cold; the others are released. Main thread only, except [stats].
+ */
+object VenueRegistry {
+    private const val TAG = "VenueRegistry"
+    const val DEFAULT_MAX_WARM_VENUES = 3
+
+    // Order of the native counters
+    private val STATS_NAMES = listOf("maxWarmVenues", "switches", "warmSwitches", "coldSwitches", "evictions")
+
+    init {
+        System.loadLibrary("meridianmaps")
+    }
+
+    // Read by stats on the JS thread; guarded by the registry's lock
+    private val handle = nativeCreate(DEFAULT_MAX_WARM_VENUES)
+
+    /**
+     * Venues kept warm, at least 1; shrinking releases the least recently used
+     */
+    var maxWarmVenues: Int
+        get() = synchronized(this) { nativeStats(handle)[0].toInt() }
+        set(value) = release(synchronized(this) { nativeSetCapacity(handle, value.coerceAtLeast(1)) })
+
+    /**
+     * Make [appId] the active venue; returns whether it was still warm
+     */
+    @JvmStatic
+    fun activate(appId: String): Boolean {
+        val (warm, evicted) = synchronized(this) {
+            nativeContains(handle, appId) to nativeActivate(handle, appId)
+        }
+        if (!warm) {
+            Log.d(TAG, "Venue $appId is cold${if (evicted.isNotEmpty()) ", releasing ${evicted.joinToString()}" else ""}")
+        }
+        release(evicted)
+        return warm
+    }
+
+    // What a venue keeps warm; its placemark snapshot on disk stays for its next activation
+    private fun release(appIds: Array<String>) {
+        for (appId in appIds) {
+            PlacemarkIndex.release(appId)
+            MeridianSession.release(appId)
+            for (kind in listOf("maps", "placemarks", "directions")) {
+                RequestBroker.invalidate(RequestBroker.fingerprint(kind, appId, ""))
+            }
+        }
+    }
+
+    /**
+     * activeAppId, warmAppIds (most recent first), maxWarmVenues, switches,
+     * warmSwitches, coldSwitches and evictions
+     */
+    @JvmStatic
+    fun stats(): Map<String, Any> = synchronized(this) {
+        val venues = nativeVenues(handle)
+        mapOf(
+            "activeAppId" to (venues.firstOrNull() ?: ""),
+            "warmAppIds" to venues.toList()
+        ) + STATS_NAMES.zip(nativeStats(handle).toList())
+    }
+
+    @JvmStatic private external fun nativeCreate(capacity: Int): Long
+    // Each call that can evict returns the app IDs of the released venues
+    @JvmStatic private external fun nativeSetCapacity(handle: Long, capacity: Int): Array<String>
+    @JvmStatic private external fun nativeActivate(handle: Long, appId: String): Array<String>
+    @JvmStatic private external fun nativeContains(handle: Long, appId: String): Boolean
+    // Most recently active first
+    @JvmStatic private external fun nativeVenues(handle: Long): Array<String>
+    @JvmStatic private external fun nativeStats(handle: Long): LongArray
+}
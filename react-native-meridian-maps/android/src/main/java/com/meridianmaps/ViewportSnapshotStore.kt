@@ -0,0 +1,132 @@
+package com.meridianmaps
+
+import android.content.Context
+import android.graphics.Bitmap
+import android.graphics.BitmapFactory
+import android.graphics.Canvas
+import android.graphics.Rect
+import android.os.Build
+import android.os.Handler
+import android.os.Looper
+import android.util.Log
+import android.view.PixelCopy
+import android.view.View
+import android.view.Window
+import java.io.ByteArrayOutputStream
+import java.io.File
+import java.util.concurrent.Executors
+
+/**
+ * What a map view showed when the app last went to the background: a JPEG of
+ * the rendered map per floor, kept under cacheDir/meridianmaps/viewports
+ * (cpp/ViewportSnapshot.h). A view mounting on relaunch shows it at once and
+ * fades it out when the floor has loaded.
+ *
+ * The Android SDK has no public way to set the visible rect and rotation, so
+ * unlike iOS only the image is restored; the live map opens at its default
+ * viewport under it.
+ */
+object ViewportSnapshotStore {
+    private const val TAG = "ViewportSnapshotStore"
+    // Older snapshots may show a venue that has changed since
+    private const val MAX_AGE_MS = 7L * 24 * 60 * 60 * 1000
+    private const val JPEG_QUALITY = 60
+    // Wider snapshots are scaled down; the fade does not look any sharper for them
+    private const val MAX_WIDTH_PX = 1080
+
+    class Snapshot(val mapId: String, val bitmap: Bitmap, val viewWidth: Float, val viewHeight: Float)
+
+    init {
+        System.loadLibrary("meridianmaps")
+    }
+
+    @Volatile
+    private var handle = 0L
+    private val writer = Executors.newSingleThreadExecutor()
+
+    /**
+     * Sets the snapshot directory; idempotent
+     */
+    @JvmStatic
+    @Synchronized
+    fun attach(context: Context) {
+        if (handle != 0L) return
+        val directory = File(File(context.cacheDir, "meridianmaps"), "viewports")
+        directory.parentFile?.mkdirs()
+        handle = nativeCreate(directory.path)
+    }
+
+    /**
+     * Copies what [view] shows on the calling (main) thread and saves it as the
+     * snapshot of floor [mapId] on a background thread. [window] is the view's
+     * window: the map draws into a surface that only a copy of the window sees.
+     */
+    @JvmStatic
+    fun capture(view: View, window: Window?, appId: String, mapId: String) {
+        if (handle == 0L || view.width <= 0 || view.height <= 0 || !view.isAttachedToWindow) return
+        val scale = minOf(1f, MAX_WIDTH_PX.toFloat() / view.width)
+        val bitmap = Bitmap.createBitmap(
+            (view.width * scale).toInt().coerceAtLeast(1),
+            (view.height * scale).toInt().coerceAtLeast(1),
+            Bitmap.Config.ARGB_8888
+        )
+        val viewWidth = view.width.toFloat()
+        val viewHeight = view.height.toFloat()
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.O && window != null) {
+            val location = IntArray(2)
+            view.getLocationInWindow(location)
+            val source = Rect(location[0], location[1], location[0] + view.width, location[1] + view.height)
+            PixelCopy.request(window, source, bitmap, { result ->
+                if (result == PixelCopy.SUCCESS) {
+                    save(appId, mapId, viewWidth, viewHeight, bitmap)
+                } else {
+                    Log.d(TAG, "Not saving $mapId: PixelCopy failed with $result")
+                    bitmap.recycle()
+                }
+            }, Handler(Looper.getMainLooper()))
+        } else {
+            val canvas = Canvas(bitmap)
+            canvas.scale(scale, scale)
+            view.draw(canvas)
+            save(appId, mapId, viewWidth, viewHeight, bitmap)
+        }
+    }
+
+    private fun save(appId: String, mapId: String, viewWidth: Float, viewHeight: Float, bitmap: Bitmap) {
+        writer.execute {
+            val jpeg = ByteArrayOutputStream()
+            bitmap.compress(Bitmap.CompressFormat.JPEG, JPEG_QUALITY, jpeg)
+            bitmap.recycle()
+            // The SDK's viewport is not readable here; see the class comment
+            val viewport = floatArrayOf(0f, 0f, 0f, 0f, 0f, viewWidth, viewHeight)
+            nativeSave(handle, appId, mapId, viewport, System.currentTimeMillis(), jpeg.toByteArray())
+        }
+    }
+
+    /**
+     * The floor's snapshot if one was saved in the last week; reads and decodes
+     * the file on the calling thread
+     */
+    @JvmStatic
+    fun load(appId: String, mapId: String): Snapshot? {
+        if (handle == 0L) return null
+        val viewport = FloatArray(7)
+        val jpeg = nativeLoad(handle, appId, mapId, System.currentTimeMillis(), MAX_AGE_MS, viewport) ?: return null
+        val bitmap = BitmapFactory.decodeByteArray(jpeg, 0, jpeg.size) ?: return null
+        return Snapshot(mapId, bitmap, viewport[5], viewport[6])
+    }
+
+    @JvmStatic
+    fun clear() {
+        if (handle != 0L) writer.execute { nativeClear(handle) }
+    }
+
+    @JvmStatic private external fun nativeCreate(directory: String): Long
+    @JvmStatic private external fun nativeSave(
+        handle: Long, appId: String, mapId: String, viewport: FloatArray, savedAtMs: Long, image: ByteArray
+    ): Boolean
+    @JvmStatic private external fun nativeLoad(
+        handle: Long, appId: String, mapId: String, nowMs: Long, maxAgeMs: Long, viewport: FloatArray
+    ): ByteArray?
+    @JvmStatic private external fun nativeClear(handle: Long)
+}
@@ -0,0 +1,255 @@
+#include "AssetBundle.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace meridianmaps {
+
+namespace {
+
+constexpr char kMagic[4] = {'M', 'M', 'A', 'B'};
+constexpr uint32_t kEndianTag = 0x01020304;
+constexpr uint32_t kCompressed = 1;
+
+struct Header {
+  char magic[4];
+  uint32_t version;
+  uint32_t endianTag;
+  uint32_t count;
+  uint64_t stringsOffset;
+  uint64_t stringsLength;
+};
+
+struct IndexEntry {
+  uint64_t offset;
+  uint64_t storedLength;
+  uint64_t length;
+  uint32_t keyOffset;
+  uint32_t keyLength;
+  uint32_t typeOffset;
+  uint32_t typeLength;
+  uint32_t crc;
+  uint32_t flags;
+};
+
+static_assert(sizeof(Header) == 32, "asset bundle header layout changed");
+static_assert(sizeof(IndexEntry) == 48, "asset bundle index layout changed");
+
+void setError(std::string* error, const std::string& message) {
+  if (error) {
+    *error = message;
+  }
+}
+
+uint32_t crcOf(std::string_view bytes) {
+  uLong crc = crc32(0L, Z_NULL, 0);
+  // crc32 takes a uInt length, so feed large assets in chunks
+  while (!bytes.empty()) {
+    const size_t chunk = std::min<size_t>(bytes.size(), 1u << 30);
+    crc = crc32(crc, reinterpret_cast<const Bytef*>(bytes.data()), static_cast<uInt>(chunk));
+    bytes.remove_prefix(chunk);
+  }
+  return static_cast<uint32_t>(crc);
+}
+
+bool deflateBytes(std::string_view bytes, std::string* out) {
+  uLongf length = compressBound(static_cast<uLong>(bytes.size()));
+  out->resize(length);
+  if (compress2(reinterpret_cast<Bytef*>(&(*out)[0]), &length, reinterpret_cast<const Bytef*>(bytes.data()),
+                static_cast<uLong>(bytes.size()), Z_BEST_COMPRESSION) != Z_OK) {
+    return false;
+  }
+  out->resize(length);
+  return true;
+}
+
+}  // namespace
+
+std::string AssetBundle::serialize(std::vector<Asset> assets) {
+  // Last one wins for duplicate keys, as when a packer re-adds a URL
+  std::stable_sort(assets.begin(), assets.end(), [](const Asset& a, const Asset& b) { return a.key < b.key; });
+  std::vector<Asset> unique;
+  unique.reserve(assets.size());
+  for (Asset& asset : assets) {
+    if (!unique.empty() && unique.back().key == asset.key) {
+      unique.back() = std::move(asset);
+    } else {
+      unique.push_back(std::move(asset));
+    }
+  }
+
+  std::string strings;
+  std::vector<IndexEntry> index(unique.size());
+  std::vector<std::string> stored(unique.size());
+  for (size_t i = 0; i < unique.size(); ++i) {
+    const Asset& asset = unique[i];
+    IndexEntry& entry = index[i];
+    entry.keyOffset = static_cast<uint32_t>(strings.size());
+    entry.keyLength = static_cast<uint32_t>(asset.key.size());
+    strings.append(asset.key);
+    entry.typeOffset = static_cast<uint32_t>(strings.size());
+    entry.typeLength = static_cast<uint32_t>(asset.contentType.size());
+    strings.append(asset.contentType);
+    entry.length = asset.bytes.size();
+    entry.crc = crcOf(asset.bytes);
+    std::string deflated;
+    if (deflateBytes(asset.bytes, &deflated) && deflated.size() < asset.bytes.size()) {
+      stored[i] = std::move(deflated);
+      entry.flags = kCompressed;
+    } else {
+      stored[i] = asset.bytes;
+    }
+    entry.storedLength = stored[i].size();
+  }
+
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.endianTag = kEndianTag;
+  header.count = static_cast<uint32_t>(index.size());
+  header.stringsOffset = sizeof(Header) + index.size() * sizeof(IndexEntry);
+  header.stringsLength = strings.size();
+
+  std::string buffer(header.stringsOffset, '\0');
+  buffer.append(strings);
+  for (size_t i = 0; i < index.size(); ++i) {
+    buffer.resize((buffer.size() + 7) & ~size_t(7), '\0');
+    index[i].offset = buffer.size();
+    buffer.append(stored[i]);
+  }
+  std::memcpy(&buffer[0], &header, sizeof(Header));
+  if (!index.empty()) {
+    std::memcpy(&buffer[sizeof(Header)], index.data(), index.size() * sizeof(IndexEntry));
+  }
+  return buffer;
+}
+
+std::unique_ptr<AssetBundle> AssetBundle::open(const std::string& path, std::string* error) {
+  std::unique_ptr<MappedFile> file = MappedFile::open(path, error);
+  if (!file) {
+    return nullptr;
+  }
+  std::unique_ptr<AssetBundle> bundle(new AssetBundle(std::move(file)));
+  if (!bundle->bind(error)) {
+    return nullptr;
+  }
+  return bundle;
+}
+
+bool AssetBundle::bind(std::string* error) {
+  const char* base = file_->data();
+  const uint64_t fileSize = file_->size();
+  if (fileSize < sizeof(Header)) {
+    setError(error, "asset bundle is truncated");
+    return false;
+  }
+
+  Header header;
+  std::memcpy(&header, base, sizeof(Header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    setError(error, "not an asset bundle");
+    return false;
+  }
+  if (header.endianTag != kEndianTag) {
+    setError(error, "asset bundle was written with a different byte order");
+    return false;
+  }
+  if (header.version != kVersion) {
+    setError(error, "asset bundle version " + std::to_string(header.version) + " is not supported");
+    return false;
+  }
+  const uint64_t indexEnd = sizeof(Header) + uint64_t(header.count) * sizeof(IndexEntry);
+  if (indexEnd > fileSize || header.stringsOffset < indexEnd || header.stringsOffset > fileSize ||
+      header.stringsLength > fileSize - header.stringsOffset) {
+    setError(error, "asset bundle index is truncated");
+    return false;
+  }
+
+  const char* strings = base + header.stringsOffset;
+  entries_.reserve(header.count);
+  for (uint32_t i = 0; i < header.count; ++i) {
+    IndexEntry raw;
+    std::memcpy(&raw, base + sizeof(Header) + i * sizeof(IndexEntry), sizeof(IndexEntry));
+    if (uint64_t(raw.keyOffset) + raw.keyLength > header.stringsLength ||
+        uint64_t(raw.typeOffset) + raw.typeLength > header.stringsLength || raw.offset > fileSize ||
+        raw.storedLength > fileSize - raw.offset || (!(raw.flags & kCompressed) && raw.storedLength != raw.length)) {
+      setError(error, "asset bundle entry " + std::to_string(i) + " is out of bounds");
+      return false;
+    }
+    Entry entry{std::string_view(strings + raw.keyOffset, raw.keyLength),
+                std::string_view(strings + raw.typeOffset, raw.typeLength),
+                raw.offset,
+                raw.storedLength,
+                raw.length,
+                raw.crc,
+                (raw.flags & kCompressed) != 0};
+    if (!entries_.empty() && !(entries_.back().key < entry.key)) {
+      setError(error, "asset bundle index is not sorted");
+      return false;
+    }
+    entries_.push_back(entry);
+  }
+  return true;
+}
+
+const AssetBundle::Entry* AssetBundle::find(std::string_view key) const {
+  auto it = std::lower_bound(entries_.begin(), entries_.end(), key,
+                             [](const Entry& entry, std::string_view value) { return entry.key < value; });
+  return it != entries_.end() && it->key == key ? &*it : nullptr;
+}
+
+const AssetBundle::Entry* AssetBundle::findUrl(std::string_view url) const {
+  if (const Entry* entry = find(url)) {
+    return entry;
+  }
+  const size_t end = url.find_first_of("?#");
+  return end != std::string_view::npos ? find(url.substr(0, end)) : nullptr;
+}
+
+bool AssetBundle::read(const Entry& entry, std::string* out, std::string* error) const {
+  const std::string_view stored(file_->data() + entry.offset, entry.storedLength);
+  if (entry.compressed) {
+    out->resize(entry.length);
+    uLongf length = static_cast<uLongf>(entry.length);
+    if (uncompress(reinterpret_cast<Bytef*>(&(*out)[0]), &length, reinterpret_cast<const Bytef*>(stored.data()),
+                   static_cast<uLong>(stored.size())) != Z_OK ||
+        length != entry.length) {
+      setError(error, "asset " + std::string(entry.key) + " does not inflate");
+      ++failures_;
+      return false;
+    }
+  } else {
+    out->assign(stored);
+  }
+  if (crcOf(*out) != entry.crc) {
+    setError(error, "asset " + std::string(entry.key) + " fails its checksum");
+    ++failures_;
+    return false;
+  }
+  ++served_;
+  bytesServed_ += out->size();
+  return true;
+}
+
+HttpResponse AssetBundle::fetch(const HttpRequest& request) const {
+  HttpResponse response;
+  const Entry* entry = findUrl(request.url);
+  if (!entry) {
+    response.error = "not in the asset bundle: " + request.url;
+  } else if (read(*entry, &response.body, &response.error)) {
+    response.status = 200;
+  }
+  return response;
+}
+
+AssetBundleStats AssetBundle::stats() const {
+  AssetBundleStats stats;
+  stats.served = served_;
+  stats.bytesServed = bytesServed_;
+  stats.failures = failures_;
+  return stats;
+}
+
+}  // namespace meridianmaps
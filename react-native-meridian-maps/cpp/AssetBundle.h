@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+#include "PlacemarkSync.h"
+
+namespace meridianmaps {
+
+// One file to pack, keyed by the URL it is served for.
+struct Asset {
+  std::string key;
+  std::string contentType;
+  std::string bytes;
+};
+
+struct AssetBundleStats {
+  // Assets read, their inflated bytes, and reads that failed to inflate or verify
+  uint64_t served = 0;
+  uint64_t bytesServed = 0;
+  uint64_t failures = 0;
+};
+
+/**
+ * Read-only, indexed bundle of venue assets (floor SVGs and images,
+ * placemark pages, route data) written by scripts/pack-venue.js.
+ *
+ * Layout, little-endian: a 32-byte header (magic "MMAB", format version,
+ * endianness tag, asset count, string table offset and length), one 48-byte
+ * index entry per asset sorted by key bytes, the string table holding keys
+ * and content types, then each asset's bytes 8-byte aligned. An asset is
+ * stored raw or zlib-deflated, whichever is smaller, with the CRC-32 of its
+ * original bytes. Opening maps the file and validates the index; assets are
+ * only inflated when read. Safe to read from any thread.
+ */
+class AssetBundle {
+ public:
+  static constexpr uint32_t kVersion = 1;
+  // Written by the packer: appId, baseUrl and the packed maps as JSON
+  static constexpr std::string_view kManifestKey = "meridian:manifest";
+
+  struct Entry {
+    std::string_view key;
+    std::string_view contentType;
+    uint64_t offset;
+    uint64_t storedLength;
+    uint64_t length;
+    uint32_t crc;
+    bool compressed;
+  };
+
+  // Maps and validates the file. Returns null and fills error if the file is
+  // missing, truncated, from another format version or otherwise corrupt.
+  static std::unique_ptr<AssetBundle> open(const std::string& path, std::string* error = nullptr);
+
+  // Encodes assets in the packer's layout; a later asset replaces an earlier
+  // one with the same key.
+  static std::string serialize(std::vector<Asset> assets);
+
+  // The asset stored under key, or null.
+  const Entry* find(std::string_view key) const;
+
+  // The asset for a request URL: the exact URL, else the URL without its
+  // query and fragment, so signed or cache-busting parameters still match.
+  // Not counted in stats(), so a caller may probe before it reads.
+  const Entry* findUrl(std::string_view url) const;
+
+  // Inflates the asset into out and checks it against its CRC. Counts
+  // towards stats().
+  bool read(const Entry& entry, std::string* out, std::string* error = nullptr) const;
+
+  // Serves GETs for URLs in the bundle with 200 and everything else with
+  // status 0, so a PlacemarkSync can run from the bundle offline.
+  HttpResponse fetch(const HttpRequest& request) const;
+
+  const std::vector<Entry>& entries() const { return entries_; }
+  size_t byteSize() const { return file_->size(); }
+  AssetBundleStats stats() const;
+
+ private:
+  explicit AssetBundle(std::unique_ptr<MappedFile> file) : file_(std::move(file)) {}
+
+  bool bind(std::string* error);
+
+  std::unique_ptr<MappedFile> file_;
+  std::vector<Entry> entries_;
+  mutable std::atomic<uint64_t> served_{0};
+  mutable std::atomic<uint64_t> bytesServed_{0};
+  mutable std::atomic<uint64_t> failures_{0};
+};
+
+}  // namespace meridianmaps
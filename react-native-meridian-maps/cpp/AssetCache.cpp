@@ -0,0 +1,367 @@
+#include "AssetCache.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "MappedFile.h"
+#include "PlacemarkTable.h"
+
+namespace meridianmaps {
+
+namespace {
+
+constexpr char kMagic[4] = {'M', 'M', 'A', 'C'};
+constexpr uint32_t kEndianTag = 0x01020304;
+constexpr const char* kIndexName = "index";
+
+void setError(std::string* error, const std::string& message) {
+  if (error) {
+    *error = message;
+  }
+}
+
+template <typename T>
+void appendValue(std::string& out, T value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendString(std::string& out, std::string_view value) {
+  appendValue(out, static_cast<uint32_t>(value.size()));
+  out.append(value);
+}
+
+class Reader {
+ public:
+  explicit Reader(std::string_view bytes) : bytes_(bytes) {}
+
+  template <typename T>
+  bool read(T& value) {
+    if (bytes_.size() - pos_ < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&value, bytes_.data() + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return true;
+  }
+
+  bool readString(std::string& value) {
+    uint32_t length;
+    if (!read(length) || bytes_.size() - pos_ < length) {
+      return false;
+    }
+    value.assign(bytes_.data() + pos_, length);
+    pos_ += length;
+    return true;
+  }
+
+ private:
+  std::string_view bytes_;
+  size_t pos_ = 0;
+};
+
+std::string blobName(uint64_t hash, uint64_t length) {
+  char name[48];
+  std::snprintf(name, sizeof(name), "%016" PRIx64 "-%" PRIx64, hash, length);
+  return name;
+}
+
+bool readFile(const std::string& path, std::string* bytes) {
+  std::unique_ptr<MappedFile> file = MappedFile::open(path);
+  if (!file) {
+    return false;
+  }
+  bytes->assign(file->data(), file->size());
+  return true;
+}
+
+}  // namespace
+
+AssetCache::AssetCache(std::string directory, uint64_t maxBytes)
+    : directory_(std::move(directory)), maxBytes_(maxBytes) {}
+
+std::string AssetCache::blobPath(uint64_t hash, uint64_t length) const {
+  return directory_ + "/" + blobName(hash, length);
+}
+
+std::string AssetCache::indexPath() const {
+  return directory_ + "/" + kIndexName;
+}
+
+bool AssetCache::open(std::string* error) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (::mkdir(directory_.c_str(), 0755) != 0 && errno != EEXIST) {
+    setError(error, "mkdir " + directory_ + ": " + std::strerror(errno));
+    return false;
+  }
+  entries_.clear();
+  byUrl_.clear();
+  blobs_.clear();
+  bytes_ = 0;
+
+  std::string index;
+  if (readFile(indexPath(), &index)) {
+    Reader reader(index);
+    char magic[4];
+    uint32_t version, endianTag, count;
+    if (reader.read(magic) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0 && reader.read(version) &&
+        version == kVersion && reader.read(endianTag) && endianTag == kEndianTag && reader.read(count)) {
+      for (uint32_t i = 0; i < count; ++i) {
+        Entry entry;
+        if (!reader.readString(entry.url) || !reader.readString(entry.contentType) || !reader.read(entry.hash) ||
+            !reader.read(entry.length)) {
+          break;
+        }
+        if (byUrl_.count(entry.url) != 0) {
+          continue;
+        }
+        // Listed most recently used first, so appending keeps the order
+        entries_.push_back(std::move(entry));
+        auto it = std::prev(entries_.end());
+        byUrl_[it->url] = it;
+        Blob& blob = blobs_[blobName(it->hash, it->length)];
+        if (blob.references++ == 0) {
+          blob.length = it->length;
+          bytes_ += it->length;
+        }
+      }
+    }
+  }
+
+  // Drop URLs whose file is gone, then files no URL refers to
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    struct stat info;
+    auto next = std::next(it);
+    if (::stat(blobPath(it->hash, it->length).c_str(), &info) != 0 ||
+        static_cast<uint64_t>(info.st_size) != it->length) {
+      dropLocked(it);
+      dirty_ = true;
+    }
+    it = next;
+  }
+  removeStrayFilesLocked();
+  evictLocked(maxBytes_);
+  return true;
+}
+
+void AssetCache::removeStrayFilesLocked() {
+  DIR* dir = ::opendir(directory_.c_str());
+  if (!dir) {
+    return;
+  }
+  std::vector<std::string> stray;
+  while (dirent* item = ::readdir(dir)) {
+    const std::string name = item->d_name;
+    if (name == "." || name == ".." || name == kIndexName || blobs_.count(name) != 0) {
+      continue;
+    }
+    stray.push_back(name);
+  }
+  ::closedir(dir);
+  for (const std::string& name : stray) {
+    std::remove((directory_ + "/" + name).c_str());
+  }
+}
+
+void AssetCache::setMaxBytes(uint64_t maxBytes) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  maxBytes_ = maxBytes;
+  const uint64_t evictions = stats_.evictions;
+  evictLocked(maxBytes_);
+  if (stats_.evictions != evictions) {
+    writeIndexLocked(nullptr);
+  }
+}
+
+uint64_t AssetCache::maxBytes() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return maxBytes_;
+}
+
+bool AssetCache::contains(std::string_view url) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return byUrl_.count(url) != 0;
+}
+
+bool AssetCache::get(std::string_view url, std::string* bytes, std::string* contentType) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto found = byUrl_.find(url);
+  if (found == byUrl_.end()) {
+    stats_.misses++;
+    return false;
+  }
+  auto it = found->second;
+  if (!readFile(blobPath(it->hash, it->length), bytes) || bytes->size() != it->length) {
+    dropLocked(it);
+    writeIndexLocked(nullptr);
+    stats_.misses++;
+    return false;
+  }
+  if (contentType) {
+    *contentType = it->contentType;
+  }
+  entries_.splice(entries_.begin(), entries_, it);
+  dirty_ = true;
+  stats_.hits++;
+  stats_.bytesServed += it->length;
+  return true;
+}
+
+bool AssetCache::sameBytes(uint64_t hash, uint64_t length, std::string_view bytes) const {
+  std::unique_ptr<MappedFile> file = MappedFile::open(blobPath(hash, length));
+  return file && file->size() == bytes.size() && std::memcmp(file->data(), bytes.data(), bytes.size()) == 0;
+}
+
+bool AssetCache::put(std::string_view url, std::string_view contentType, std::string_view bytes, std::string* error) {
+  if (bytes.empty()) {
+    return false;
+  }
+  const uint64_t hash = hashString(bytes);
+  const uint64_t length = bytes.size();
+  const std::string name = blobName(hash, length);
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (length > maxBytes_) {
+    setError(error, "asset is larger than the cache budget");
+    return false;
+  }
+  auto existing = byUrl_.find(url);
+  if (existing != byUrl_.end()) {
+    auto it = existing->second;
+    if (it->hash == hash && it->length == length && sameBytes(hash, length, bytes)) {
+      // Unchanged: refresh recency and type without touching the file
+      it->contentType.assign(contentType);
+      entries_.splice(entries_.begin(), entries_, it);
+      stats_.stores++;
+      stats_.dedupStores++;
+      return writeIndexLocked(error);
+    }
+    dropLocked(it);
+  }
+
+  auto blob = blobs_.find(name);
+  if (blob != blobs_.end() && sameBytes(hash, length, bytes)) {
+    stats_.dedupStores++;
+  } else {
+    // A hash collision with different bytes is stored as a miss rather than shared
+    if (blob != blobs_.end()) {
+      setError(error, "content hash collision");
+      writeIndexLocked(nullptr);
+      return false;
+    }
+    if (!writeFileAtomically(blobPath(hash, length), bytes, error)) {
+      writeIndexLocked(nullptr);
+      return false;
+    }
+    blob = blobs_.emplace(name, Blob{length, 0}).first;
+    bytes_ += length;
+  }
+  blob->second.references++;
+
+  entries_.push_front({std::string(url), std::string(contentType), hash, length});
+  byUrl_[entries_.front().url] = entries_.begin();
+  stats_.stores++;
+  evictLocked(maxBytes_);
+  return writeIndexLocked(error);
+}
+
+bool AssetCache::remove(std::string_view url) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto found = byUrl_.find(url);
+  if (found == byUrl_.end()) {
+    return false;
+  }
+  dropLocked(found->second);
+  writeIndexLocked(nullptr);
+  return true;
+}
+
+void AssetCache::clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  while (!entries_.empty()) {
+    dropLocked(entries_.begin());
+  }
+  writeIndexLocked(nullptr);
+}
+
+HttpResponse AssetCache::fetch(const HttpRequest& request, const HttpFetch& network) {
+  HttpResponse response;
+  if (get(request.url, &response.body, &response.contentType)) {
+    response.status = 200;
+    return response;
+  }
+  response = network(request);
+  if (response.status == 200) {
+    put(request.url, response.contentType, response.body);
+  }
+  return response;
+}
+
+bool AssetCache::flush(std::string* error) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return !dirty_ || writeIndexLocked(error);
+}
+
+void AssetCache::dropLocked(std::list<Entry>::iterator entry) {
+  const std::string name = blobName(entry->hash, entry->length);
+  auto blob = blobs_.find(name);
+  if (blob != blobs_.end() && --blob->second.references == 0) {
+    std::remove((directory_ + "/" + name).c_str());
+    bytes_ -= blob->second.length;
+    blobs_.erase(blob);
+  }
+  byUrl_.erase(entry->url);
+  entries_.erase(entry);
+  dirty_ = true;
+}
+
+void AssetCache::evictLocked(uint64_t maxBytes) {
+  while (bytes_ > maxBytes && !entries_.empty()) {
+    const uint64_t before = bytes_;
+    dropLocked(std::prev(entries_.end()));
+    stats_.evictions++;
+    stats_.bytesEvicted += before - bytes_;
+  }
+}
+
+bool AssetCache::writeIndexLocked(std::string* error) {
+  std::string out;
+  out.append(kMagic, sizeof(kMagic));
+  appendValue(out, kVersion);
+  appendValue(out, kEndianTag);
+  appendValue(out, static_cast<uint32_t>(entries_.size()));
+  for (const Entry& entry : entries_) {
+    appendString(out, entry.url);
+    appendString(out, entry.contentType);
+    appendValue(out, entry.hash);
+    appendValue(out, entry.length);
+  }
+  if (!writeFileAtomically(indexPath(), out, error)) {
+    return false;
+  }
+  dirty_ = false;
+  return true;
+}
+
+size_t AssetCache::size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return entries_.size();
+}
+
+uint64_t AssetCache::byteSize() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return bytes_;
+}
+
+AssetCacheStats AssetCache::stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return stats_;
+}
+
+}  // namespace meridianmaps
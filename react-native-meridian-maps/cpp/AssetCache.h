@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "PlacemarkSync.h"
+
+namespace meridianmaps {
+
+struct AssetCacheStats {
+  // Lookups answered from disk, and the network bytes that saved; lookups that missed
+  uint64_t hits = 0;
+  uint64_t bytesServed = 0;
+  uint64_t misses = 0;
+  // Assets stored, and how many of those reused a file already holding the same bytes
+  uint64_t stores = 0;
+  uint64_t dedupStores = 0;
+  // URLs dropped to stay within the budget, and the file bytes that freed
+  uint64_t evictions = 0;
+  uint64_t bytesEvicted = 0;
+};
+
+/**
+ * Persistent, size-bounded LRU cache of floor assets (map SVGs and images,
+ * placemark images) keyed by URL.
+ *
+ * Bytes are stored once per content hash, so URLs that serve the same file,
+ * such as one icon used by many placemarks, share it and count once against
+ * the budget. An index file in the same directory lists the URLs, most
+ * recently used first; it is rewritten on every store and removal and by
+ * flush(), which also persists recency. Files the index does not reference
+ * are deleted by open(), so a crash between writing a file and the index
+ * leaks nothing. Thread-safe; disk reads and writes happen under the lock,
+ * network fetches in fetch() outside it.
+ */
+class AssetCache {
+ public:
+  static constexpr uint32_t kVersion = 1;
+
+  AssetCache(std::string directory, uint64_t maxBytes);
+
+  // Creates the directory and loads the index; an unreadable index starts
+  // the cache empty. Returns false only if the directory is unusable.
+  bool open(std::string* error = nullptr);
+
+  // Evicts the least recently used URLs until the cache fits.
+  void setMaxBytes(uint64_t maxBytes);
+  uint64_t maxBytes() const;
+
+  bool contains(std::string_view url) const;
+
+  // Reads the asset for url and marks it most recently used. A file that
+  // went missing or changed size drops the URL and counts as a miss.
+  bool get(std::string_view url, std::string* bytes, std::string* contentType = nullptr);
+
+  // Stores bytes for url, replacing what it had, then evicts down to the
+  // budget. Empty assets and assets larger than the whole budget are not kept.
+  bool put(std::string_view url, std::string_view contentType, std::string_view bytes, std::string* error = nullptr);
+
+  bool remove(std::string_view url);
+  void clear();
+
+  // Answers from the cache, else from network, storing 200 responses.
+  HttpResponse fetch(const HttpRequest& request, const HttpFetch& network);
+
+  // Writes the index if recency changed since it was last written.
+  bool flush(std::string* error = nullptr);
+
+  size_t size() const;
+  // Bytes of distinct files on disk, what the budget applies to
+  uint64_t byteSize() const;
+  AssetCacheStats stats() const;
+
+ private:
+  struct Entry {
+    std::string url;
+    std::string contentType;
+    uint64_t hash;
+    uint64_t length;
+  };
+
+  struct Blob {
+    uint64_t length = 0;
+    uint32_t references = 0;
+  };
+
+  std::string blobPath(uint64_t hash, uint64_t length) const;
+  std::string indexPath() const;
+  bool sameBytes(uint64_t hash, uint64_t length, std::string_view bytes) const;
+  void dropLocked(std::list<Entry>::iterator entry);
+  void evictLocked(uint64_t maxBytes);
+  bool writeIndexLocked(std::string* error);
+  void removeStrayFilesLocked();
+
+  const std::string directory_;
+  mutable std::mutex mutex_;
+  uint64_t maxBytes_;
+  uint64_t bytes_ = 0;
+  bool dirty_ = false;
+  // Most recently used first
+  std::list<Entry> entries_;
+  std::unordered_map<std::string_view, std::list<Entry>::iterator> byUrl_;
+  // Keyed by "<hash>-<length>", the file name
+  std::unordered_map<std::string, Blob> blobs_;
+  AssetCacheStats stats_;
+};
+
+}  // namespace meridianmaps
@@ -0,0 +1,1146 @@
+#include "FloorPlan.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace meridianmaps {
+
+namespace {
+
+constexpr float kPi = 3.14159265358979323846f;
+
+void setError(std::string* error, const std::string& message) {
+  if (error) {
+    *error = message;
+  }
+}
+
+bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+std::string_view trim(std::string_view value) {
+  while (!value.empty() && isSpace(value.front())) {
+    value.remove_prefix(1);
+  }
+  while (!value.empty() && isSpace(value.back())) {
+    value.remove_suffix(1);
+  }
+  return value;
+}
+
+// Reads numbers, flags and command letters out of path data, point lists and
+// transform arguments; commas count as whitespace
+class NumberScanner {
+ public:
+  explicit NumberScanner(std::string_view text) : text_(text) {}
+
+  void skipSeparators() {
+    while (pos_ < text_.size() && (isSpace(text_[pos_]) || text_[pos_] == ',')) {
+      ++pos_;
+    }
+  }
+
+  bool atEnd() {
+    skipSeparators();
+    return pos_ >= text_.size();
+  }
+
+  char peek() {
+    skipSeparators();
+    return pos_ < text_.size() ? text_[pos_] : '\0';
+  }
+
+  void advance() { ++pos_; }
+
+  bool nextIsNumber() {
+    const char c = peek();
+    return isDigit(c) || c == '-' || c == '+' || c == '.';
+  }
+
+  // Locale-independent; "1.5.5" reads as 1.5 then .5 and "1-2" as 1 then -2
+  bool number(float& value) {
+    skipSeparators();
+    size_t pos = pos_;
+    double sign = 1;
+    if (pos < text_.size() && (text_[pos] == '-' || text_[pos] == '+')) {
+      sign = text_[pos] == '-' ? -1 : 1;
+      ++pos;
+    }
+    double mantissa = 0;
+    bool digits = false;
+    while (pos < text_.size() && isDigit(text_[pos])) {
+      mantissa = mantissa * 10 + (text_[pos++] - '0');
+      digits = true;
+    }
+    if (pos < text_.size() && text_[pos] == '.') {
+      ++pos;
+      double scale = 0.1;
+      while (pos < text_.size() && isDigit(text_[pos])) {
+        mantissa += (text_[pos++] - '0') * scale;
+        scale *= 0.1;
+        digits = true;
+      }
+    }
+    if (!digits) {
+      return false;
+    }
+    if (pos < text_.size() && (text_[pos] == 'e' || text_[pos] == 'E')) {
+      size_t exponentPos = pos + 1;
+      int exponentSign = 1;
+      if (exponentPos < text_.size() && (text_[exponentPos] == '-' || text_[exponentPos] == '+')) {
+        exponentSign = text_[exponentPos] == '-' ? -1 : 1;
+        ++exponentPos;
+      }
+      if (exponentPos < text_.size() && isDigit(text_[exponentPos])) {
+        int exponent = 0;
+        while (exponentPos < text_.size() && isDigit(text_[exponentPos])) {
+          exponent = std::min(exponent * 10 + (text_[exponentPos++] - '0'), 400);
+        }
+        mantissa *= std::pow(10.0, exponentSign * exponent);
+        pos = exponentPos;
+      }
+    }
+    value = static_cast<float>(sign * mantissa);
+    pos_ = pos;
+    return true;
+  }
+
+  // Arc flags may be written without separators, as in "a5 5 0 011 1"
+  bool flag(bool& value) {
+    const char c = peek();
+    if (c != '0' && c != '1') {
+      return false;
+    }
+    value = c == '1';
+    ++pos_;
+    return true;
+  }
+
+  // A function name of a transform list, such as "translate"
+  std::string_view word() {
+    skipSeparators();
+    const size_t start = pos_;
+    while (pos_ < text_.size() && ((text_[pos_] >= 'a' && text_[pos_] <= 'z') || (text_[pos_] >= 'A' && text_[pos_] <= 'Z'))) {
+      ++pos_;
+    }
+    return text_.substr(start, pos_ - start);
+  }
+
+ private:
+  std::string_view text_;
+  size_t pos_ = 0;
+};
+
+float parseNumber(std::string_view text, float fallback) {
+  NumberScanner scanner(text);
+  float value;
+  return scanner.number(value) ? value : fallback;
+}
+
+// Lengths are taken as document units; a percentage is of reference
+float parseLength(std::string_view text, float reference, float fallback = 0) {
+  text = trim(text);
+  NumberScanner scanner(text);
+  float value;
+  if (!scanner.number(value)) {
+    return fallback;
+  }
+  return !text.empty() && text.back() == '%' ? value * reference / 100 : value;
+}
+
+struct Matrix {
+  float a = 1, b = 0, c = 0, d = 1, e = 0, f = 0;
+
+  Matrix operator*(const Matrix& m) const {
+    return {a * m.a + c * m.b,     b * m.a + d * m.b,     a * m.c + c * m.d,
+            b * m.c + d * m.d,     a * m.e + c * m.f + e, b * m.e + d * m.f + f};
+  }
+
+  void apply(float& x, float& y) const {
+    const float tx = a * x + c * y + e;
+    y = b * x + d * y + f;
+    x = tx;
+  }
+
+  // How much lengths grow, on average over directions
+  float scale() const { return std::sqrt(std::fabs(a * d - b * c)); }
+};
+
+Matrix parseTransform(std::string_view text) {
+  Matrix result;
+  NumberScanner scanner(text);
+  while (!scanner.atEnd()) {
+    const std::string_view name = scanner.word();
+    if (name.empty() || scanner.peek() != '(') {
+      break;
+    }
+    scanner.advance();
+    float args[6] = {0, 0, 0, 0, 0, 0};
+    int count = 0;
+    while (count < 6 && scanner.number(args[count])) {
+      ++count;
+    }
+    if (scanner.peek() != ')') {
+      break;
+    }
+    scanner.advance();
+    Matrix m;
+    if (name == "matrix" && count == 6) {
+      m = {args[0], args[1], args[2], args[3], args[4], args[5]};
+    } else if (name == "translate" && count >= 1) {
+      m.e = args[0];
+      m.f = count >= 2 ? args[1] : 0;
+    } else if (name == "scale" && count >= 1) {
+      m.a = args[0];
+      m.d = count >= 2 ? args[1] : args[0];
+    } else if (name == "rotate" && count >= 1) {
+      const float angle = args[0] * kPi / 180;
+      const float cs = std::cos(angle);
+      const float sn = std::sin(angle);
+      m = {cs, sn, -sn, cs, 0, 0};
+      if (count >= 3) {
+        m = Matrix{1, 0, 0, 1, args[1], args[2]} * m * Matrix{1, 0, 0, 1, -args[1], -args[2]};
+      }
+    } else if (name == "skewX" && count >= 1) {
+      m.c = std::tan(args[0] * kPi / 180);
+    } else if (name == "skewY" && count >= 1) {
+      m.b = std::tan(args[0] * kPi / 180);
+    } else {
+      continue;
+    }
+    result = result * m;
+  }
+  return result;
+}
+
+struct NamedColor {
+  const char* name;
+  uint32_t rgb;
+};
+
+// The names floor plan editors write; an unknown name keeps the inherited paint
+constexpr NamedColor kNamedColors[] = {
+    {"black", 0x000000},     {"white", 0xFFFFFF},    {"red", 0xFF0000},       {"green", 0x008000},
+    {"blue", 0x0000FF},      {"yellow", 0xFFFF00},   {"orange", 0xFFA500},    {"purple", 0x800080},
+    {"gray", 0x808080},      {"grey", 0x808080},     {"silver", 0xC0C0C0},    {"lightgray", 0xD3D3D3},
+    {"lightgrey", 0xD3D3D3}, {"darkgray", 0xA9A9A9}, {"darkgrey", 0xA9A9A9},  {"gainsboro", 0xDCDCDC},
+    {"whitesmoke", 0xF5F5F5}, {"maroon", 0x800000},  {"navy", 0x000080},      {"teal", 0x008080},
+    {"olive", 0x808000},     {"lime", 0x00FF00},     {"aqua", 0x00FFFF},      {"cyan", 0x00FFFF},
+    {"fuchsia", 0xFF00FF},   {"magenta", 0xFF00FF},  {"beige", 0xF5F5DC},     {"brown", 0xA52A2A},
+    {"tan", 0xD2B48C},       {"pink", 0xFFC0CB},     {"lightblue", 0xADD8E6}, {"skyblue", 0x87CEEB},
+};
+
+int hexDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+struct Paint {
+  bool none = true;
+  uint32_t rgb = 0;
+  float alpha = 1;
+};
+
+// Gradients and patterns paint nothing unless a fallback color follows the url()
+bool parsePaint(std::string_view text, Paint& paint) {
+  text = trim(text);
+  if (text.empty()) {
+    return false;
+  }
+  if (text.compare(0, 4, "url(") == 0) {
+    const size_t close = text.find(')');
+    const std::string_view fallback = close == std::string_view::npos ? std::string_view() : trim(text.substr(close + 1));
+    if (fallback.empty() || !parsePaint(fallback, paint)) {
+      paint = Paint{};
+    }
+    return true;
+  }
+  Paint result;
+  result.none = false;
+  if (text == "none" || text == "transparent") {
+    result.none = true;
+  } else if (text == "currentColor") {
+    result.rgb = 0;
+  } else if (text[0] == '#') {
+    const std::string_view hex = text.substr(1);
+    uint32_t value = 0;
+    for (char c : hex) {
+      const int digit = hexDigit(c);
+      if (digit < 0) {
+        return false;
+      }
+      value = value << 4 | static_cast<uint32_t>(digit);
+    }
+    if (hex.size() == 3 || hex.size() == 4) {
+      const uint32_t r = (value >> ((hex.size() - 1) * 4)) & 0xF;
+      const uint32_t g = (value >> ((hex.size() - 2) * 4)) & 0xF;
+      const uint32_t b = (value >> ((hex.size() - 3) * 4)) & 0xF;
+      result.rgb = (r * 0x11) << 16 | (g * 0x11) << 8 | b * 0x11;
+      if (hex.size() == 4) {
+        result.alpha = (value & 0xF) * 0x11 / 255.0f;
+      }
+    } else if (hex.size() == 6) {
+      result.rgb = value;
+    } else if (hex.size() == 8) {
+      result.rgb = value >> 8;
+      result.alpha = (value & 0xFF) / 255.0f;
+    } else {
+      return false;
+    }
+  } else if (text.compare(0, 4, "rgb(") == 0 || text.compare(0, 5, "rgba(") == 0) {
+    NumberScanner scanner(text.substr(text.find('(') + 1));
+    float channels[4] = {0, 0, 0, 1};
+    for (int i = 0; i < 4 && scanner.number(channels[i]); ++i) {
+      if (i < 3 && scanner.peek() == '%') {
+        channels[i] *= 2.55f;
+        scanner.advance();
+      }
+    }
+    for (int i = 0; i < 3; ++i) {
+      result.rgb = result.rgb << 8 | static_cast<uint32_t>(std::clamp(channels[i], 0.0f, 255.0f) + 0.5f);
+    }
+    result.alpha = std::clamp(channels[3], 0.0f, 1.0f);
+  } else {
+    bool found = false;
+    for (const NamedColor& named : kNamedColors) {
+      if (text == named.name) {
+        result.rgb = named.rgb;
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      return false;
+    }
+  }
+  paint = result;
+  return true;
+}
+
+// Inherited down the element tree; opacity multiplies instead of inheriting,
+// which draws group opacity per shape
+struct Style {
+  Paint fill{false, 0, 1};
+  Paint stroke;
+  float fillOpacity = 1;
+  float strokeOpacity = 1;
+  float opacity = 1;
+  float strokeWidth = 1;
+  bool evenOdd = false;
+  bool visible = true;
+  bool display = true;
+  Matrix transform;
+};
+
+void applyProperty(Style& style, std::string_view name, std::string_view value, float diagonal) {
+  value = trim(value);
+  if (value == "inherit") {
+    return;
+  }
+  if (name == "fill") {
+    parsePaint(value, style.fill);
+  } else if (name == "stroke") {
+    parsePaint(value, style.stroke);
+  } else if (name == "stroke-width") {
+    style.strokeWidth = std::max(0.0f, parseLength(value, diagonal, style.strokeWidth));
+  } else if (name == "fill-opacity") {
+    style.fillOpacity = std::clamp(parseNumber(value, 1), 0.0f, 1.0f);
+  } else if (name == "stroke-opacity") {
+    style.strokeOpacity = std::clamp(parseNumber(value, 1), 0.0f, 1.0f);
+  } else if (name == "opacity") {
+    style.opacity *= std::clamp(parseNumber(value, 1), 0.0f, 1.0f);
+  } else if (name == "fill-rule") {
+    style.evenOdd = value == "evenodd";
+  } else if (name == "visibility") {
+    style.visible = value == "visible";
+  } else if (name == "display") {
+    style.display = value != "none";
+  }
+}
+
+void applyStyleAttribute(Style& style, std::string_view text, float diagonal) {
+  while (!text.empty()) {
+    const size_t end = std::min(text.find(';'), text.size());
+    const std::string_view declaration = text.substr(0, end);
+    const size_t colon = declaration.find(':');
+    if (colon != std::string_view::npos) {
+      applyProperty(style, trim(declaration.substr(0, colon)), declaration.substr(colon + 1), diagonal);
+    }
+    text.remove_prefix(std::min(end + 1, text.size()));
+  }
+}
+
+struct Attribute {
+  std::string_view name;
+  std::string_view value;
+};
+
+std::string_view attribute(const std::vector<Attribute>& attributes, std::string_view name) {
+  for (const Attribute& item : attributes) {
+    if (item.name == name) {
+      return item.value;
+    }
+  }
+  return {};
+}
+
+// Elements whose content is never drawn directly
+bool skipsSubtree(std::string_view name) {
+  static constexpr const char* kSkipped[] = {
+      "defs", "symbol", "clipPath", "mask", "pattern", "marker", "linearGradient", "radialGradient", "filter",
+      "text", "title", "desc", "metadata", "style", "script", "image", "use", "foreignObject",
+  };
+  for (const char* skipped : kSkipped) {
+    if (name == skipped) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Outlines of one shape in its own coordinates, curves already flattened
+class PathBuilder {
+ public:
+  struct Subpath {
+    std::vector<float> points;
+    bool closed = false;
+  };
+
+  explicit PathBuilder(float tolerance) : tolerance_(std::max(tolerance, 1e-4f)) {}
+
+  void moveTo(float x, float y) {
+    subpaths_.emplace_back();
+    startX_ = x;
+    startY_ = y;
+    push(x, y);
+  }
+
+  // After a close, drawing continues in a new subpath from its start
+  void lineTo(float x, float y) {
+    if (subpaths_.empty() || subpaths_.back().closed) {
+      moveTo(x_, y_);
+    }
+    push(x, y);
+  }
+
+  void close() {
+    if (!subpaths_.empty() && !subpaths_.back().closed) {
+      subpaths_.back().closed = true;
+      x_ = startX_;
+      y_ = startY_;
+    }
+  }
+
+  void quadTo(float x1, float y1, float x, float y) {
+    const float ddx = x_ - 2 * x1 + x;
+    const float ddy = y_ - 2 * y1 + y;
+    const int steps = segmentCount(0.25f * std::sqrt(ddx * ddx + ddy * ddy));
+    const float x0 = x_;
+    const float y0 = y_;
+    for (int i = 1; i <= steps; ++i) {
+      const float t = static_cast<float>(i) / steps;
+      const float u = 1 - t;
+      lineTo(u * u * x0 + 2 * u * t * x1 + t * t * x, u * u * y0 + 2 * u * t * y1 + t * t * y);
+    }
+  }
+
+  void cubicTo(float x1, float y1, float x2, float y2, float x, float y) {
+    const float ddx = std::max(std::fabs(x_ - 2 * x1 + x2), std::fabs(x1 - 2 * x2 + x));
+    const float ddy = std::max(std::fabs(y_ - 2 * y1 + y2), std::fabs(y1 - 2 * y2 + y));
+    const int steps = segmentCount(0.75f * std::sqrt(ddx * ddx + ddy * ddy));
+    const float x0 = x_;
+    const float y0 = y_;
+    for (int i = 1; i <= steps; ++i) {
+      const float t = static_cast<float>(i) / steps;
+      const float u = 1 - t;
+      const float a = u * u * u;
+      const float b = 3 * u * u * t;
+      const float c = 3 * u * t * t;
+      const float d = t * t * t;
+      lineTo(a * x0 + b * x1 + c * x2 + d * x, a * y0 + b * y1 + c * y2 + d * y);
+    }
+  }
+
+  // Endpoint arc as in the SVG spec, appendix B.2.4
+  void arcTo(float rx, float ry, float rotation, bool largeArc, bool sweep, float x, float y) {
+    rx = std::fabs(rx);
+    ry = std::fabs(ry);
+    if (x == x_ && y == y_) {
+      return;
+    }
+    if (rx == 0 || ry == 0) {
+      lineTo(x, y);
+      return;
+    }
+    const float phi = rotation * kPi / 180;
+    const float cs = std::cos(phi);
+    const float sn = std::sin(phi);
+    const float dx = (x_ - x) / 2;
+    const float dy = (y_ - y) / 2;
+    const float x1 = cs * dx + sn * dy;
+    const float y1 = -sn * dx + cs * dy;
+    const float lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+    if (lambda > 1) {
+      rx *= std::sqrt(lambda);
+      ry *= std::sqrt(lambda);
+    }
+    const float numerator = rx * rx * ry * ry - rx * rx * y1 * y1 - ry * ry * x1 * x1;
+    const float denominator = rx * rx * y1 * y1 + ry * ry * x1 * x1;
+    float coefficient = denominator > 0 ? std::sqrt(std::max(0.0f, numerator / denominator)) : 0;
+    if (largeArc == sweep) {
+      coefficient = -coefficient;
+    }
+    const float cx1 = coefficient * rx * y1 / ry;
+    const float cy1 = -coefficient * ry * x1 / rx;
+    const float cx = cs * cx1 - sn * cy1 + (x_ + x) / 2;
+    const float cy = sn * cx1 + cs * cy1 + (y_ + y) / 2;
+    const float start = std::atan2((y1 - cy1) / ry, (x1 - cx1) / rx);
+    float delta = std::atan2((-y1 - cy1) / ry, (-x1 - cx1) / rx) - start;
+    if (sweep && delta < 0) {
+      delta += 2 * kPi;
+    } else if (!sweep && delta > 0) {
+      delta -= 2 * kPi;
+    }
+    const int steps = arcSegmentCount(std::max(rx, ry), delta);
+    for (int i = 1; i < steps; ++i) {
+      const float angle = start + delta * i / steps;
+      const float px = rx * std::cos(angle);
+      const float py = ry * std::sin(angle);
+      lineTo(cs * px - sn * py + cx, sn * px + cs * py + cy);
+    }
+    lineTo(x, y);
+  }
+
+  void ellipse(float cx, float cy, float rx, float ry) {
+    const int steps = arcSegmentCount(std::max(rx, ry), 2 * kPi);
+    moveTo(cx + rx, cy);
+    for (int i = 1; i < steps; ++i) {
+      const float angle = 2 * kPi * i / steps;
+      lineTo(cx + rx * std::cos(angle), cy + ry * std::sin(angle));
+    }
+    close();
+  }
+
+  float x() const { return x_; }
+  float y() const { return y_; }
+  std::vector<Subpath>& subpaths() { return subpaths_; }
+
+ private:
+  void push(float x, float y) {
+    std::vector<float>& points = subpaths_.back().points;
+    points.push_back(x);
+    points.push_back(y);
+    x_ = x;
+    y_ = y;
+  }
+
+  int segmentCount(float deviation) const {
+    return std::clamp(static_cast<int>(std::ceil(std::sqrt(deviation / tolerance_))), 1, 256);
+  }
+
+  int arcSegmentCount(float radius, float angle) const {
+    const float step = radius > tolerance_ ? 2 * std::acos(1 - tolerance_ / radius) : kPi / 2;
+    return std::clamp(static_cast<int>(std::ceil(std::fabs(angle) / std::max(step, 1e-3f))), 2, 1024);
+  }
+
+  const float tolerance_;
+  std::vector<Subpath> subpaths_;
+  float x_ = 0;
+  float y_ = 0;
+  float startX_ = 0;
+  float startY_ = 0;
+};
+
+// Draws up to the first malformed command, as browsers do
+void parsePathData(std::string_view data, PathBuilder& path) {
+  NumberScanner scanner(data);
+  char command = 0;
+  float lastControlX = 0;
+  float lastControlY = 0;
+  char lastCommand = 0;
+  while (!scanner.atEnd()) {
+    if (!scanner.nextIsNumber()) {
+      command = scanner.peek();
+      scanner.advance();
+    } else if (command == 0) {
+      return;
+    }
+    const bool relative = command >= 'a' && command <= 'z';
+    const char upper = relative ? static_cast<char>(command - 'a' + 'A') : command;
+    const float ox = relative ? path.x() : 0;
+    const float oy = relative ? path.y() : 0;
+    float v[7];
+    auto read = [&](int count) {
+      for (int i = 0; i < count; ++i) {
+        if (!scanner.number(v[i])) {
+          return false;
+        }
+      }
+      return true;
+    };
+    switch (upper) {
+      case 'M':
+        if (!read(2)) return;
+        path.moveTo(ox + v[0], oy + v[1]);
+        // Further pairs are implicit line-tos
+        command = relative ? 'l' : 'L';
+        break;
+      case 'L':
+        if (!read(2)) return;
+        path.lineTo(ox + v[0], oy + v[1]);
+        break;
+      case 'H':
+        if (!read(1)) return;
+        path.lineTo(ox + v[0], path.y());
+        break;
+      case 'V':
+        if (!read(1)) return;
+        path.lineTo(path.x(), oy + v[0]);
+        break;
+      case 'C':
+        if (!read(6)) return;
+        path.cubicTo(ox + v[0], oy + v[1], ox + v[2], oy + v[3], ox + v[4], oy + v[5]);
+        lastControlX = ox + v[2];
+        lastControlY = oy + v[3];
+        break;
+      case 'S': {
+        if (!read(4)) return;
+        const bool smooth = lastCommand == 'C' || lastCommand == 'S';
+        const float x1 = smooth ? 2 * path.x() - lastControlX : path.x();
+        const float y1 = smooth ? 2 * path.y() - lastControlY : path.y();
+        path.cubicTo(x1, y1, ox + v[0], oy + v[1], ox + v[2], oy + v[3]);
+        lastControlX = ox + v[0];
+        lastControlY = oy + v[1];
+        break;
+      }
+      case 'Q':
+        if (!read(4)) return;
+        path.quadTo(ox + v[0], oy + v[1], ox + v[2], oy + v[3]);
+        lastControlX = ox + v[0];
+        lastControlY = oy + v[1];
+        break;
+      case 'T': {
+        if (!read(2)) return;
+        const bool smooth = lastCommand == 'Q' || lastCommand == 'T';
+        lastControlX = smooth ? 2 * path.x() - lastControlX : path.x();
+        lastControlY = smooth ? 2 * path.y() - lastControlY : path.y();
+        path.quadTo(lastControlX, lastControlY, ox + v[0], oy + v[1]);
+        break;
+      }
+      case 'A': {
+        bool largeArc;
+        bool sweep;
+        if (!read(3) || !scanner.flag(largeArc) || !scanner.flag(sweep) || !scanner.number(v[3]) ||
+            !scanner.number(v[4])) {
+          return;
+        }
+        path.arcTo(v[0], v[1], v[2], largeArc, sweep, ox + v[3], oy + v[4]);
+        break;
+      }
+      case 'Z':
+        path.close();
+        // Numbers cannot follow a close
+        command = 0;
+        break;
+      default:
+        return;
+    }
+    lastCommand = upper;
+  }
+}
+
+void appendPoints(std::string_view text, PathBuilder& path, bool closed) {
+  NumberScanner scanner(text);
+  float x;
+  float y;
+  bool first = true;
+  while (scanner.number(x) && scanner.number(y)) {
+    if (first) {
+      path.moveTo(x, y);
+      first = false;
+    } else {
+      path.lineTo(x, y);
+    }
+  }
+  if (closed) {
+    path.close();
+  }
+}
+
+uint32_t withAlpha(const Paint& paint, float opacity) {
+  const float alpha = std::clamp(paint.alpha * opacity, 0.0f, 1.0f);
+  return static_cast<uint32_t>(alpha * 255 + 0.5f) << 24 | paint.rgb;
+}
+
+void growBounds(Rect& bounds, float x, float y) {
+  bounds.minX = std::min(bounds.minX, x);
+  bounds.minY = std::min(bounds.minY, y);
+  bounds.maxX = std::max(bounds.maxX, x);
+  bounds.maxY = std::max(bounds.maxY, y);
+}
+
+}  // namespace
+
+class FloorPlanBuilder {
+ public:
+  FloorPlanBuilder(FloorPlan& plan, float flatness) : plan_(plan), flatness_(flatness) {}
+
+  bool parse(std::string_view svg, std::string* error) {
+    struct Frame {
+      std::string_view name;
+      Style style;
+      bool skip;
+    };
+    std::vector<Frame> stack;
+    std::vector<Attribute> attributes;
+    bool sawRoot = false;
+    size_t pos = 0;
+    while ((pos = svg.find('<', pos)) != std::string_view::npos) {
+      if (svg.compare(pos, 4, "<!--") == 0) {
+        pos = skipPast(svg, pos, "-->");
+      } else if (svg.compare(pos, 9, "<![CDATA[") == 0) {
+        pos = skipPast(svg, pos, "]]>");
+      } else if (svg.compare(pos, 2, "<?") == 0) {
+        pos = skipPast(svg, pos, "?>");
+      } else if (svg.compare(pos, 2, "<!") == 0) {
+        pos = skipPast(svg, pos, ">");
+      } else if (svg.compare(pos, 2, "</") == 0) {
+        const size_t close = svg.find('>', pos);
+        if (close == std::string_view::npos) {
+          return fail(error, "unterminated closing tag", pos);
+        }
+        const std::string_view name = trim(svg.substr(pos + 2, close - pos - 2));
+        if (stack.empty() || stack.back().name != name) {
+          return fail(error, "mismatched </" + std::string(name) + ">", pos);
+        }
+        stack.pop_back();
+        pos = close + 1;
+        continue;
+      } else {
+        bool selfClosing = false;
+        std::string_view name;
+        const size_t end = readTag(svg, pos, name, attributes, selfClosing);
+        if (end == std::string_view::npos) {
+          return fail(error, "malformed tag", pos);
+        }
+        pos = end;
+        if (!sawRoot) {
+          if (name != "svg") {
+            return fail(error, "the root element is <" + std::string(name) + ">, not <svg>", pos);
+          }
+          sawRoot = true;
+          readViewport(attributes);
+        }
+        Frame frame{name, stack.empty() ? Style{} : stack.back().style, !stack.empty() && stack.back().skip};
+        if (!frame.skip) {
+          frame.skip = skipsSubtree(name) || !element(name, attributes, frame.style, stack.empty());
+        }
+        if (!selfClosing) {
+          stack.push_back(frame);
+        }
+        continue;
+      }
+      if (pos == std::string_view::npos) {
+        return fail(error, "unterminated comment or declaration", svg.size());
+      }
+    }
+    if (!sawRoot) {
+      setError(error, "no <svg> element");
+      return false;
+    }
+    if (!stack.empty()) {
+      setError(error, "<" + std::string(stack.back().name) + "> is not closed");
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  static size_t skipPast(std::string_view svg, size_t pos, std::string_view terminator) {
+    const size_t end = svg.find(terminator, pos);
+    return end == std::string_view::npos ? end : end + terminator.size();
+  }
+
+  static bool fail(std::string* error, const std::string& message, size_t offset) {
+    setError(error, message + " at offset " + std::to_string(offset));
+    return false;
+  }
+
+  // Returns the offset past the tag
+  static size_t readTag(std::string_view svg, size_t pos, std::string_view& name,
+                        std::vector<Attribute>& attributes, bool& selfClosing) {
+    attributes.clear();
+    size_t i = pos + 1;
+    const size_t nameStart = i;
+    while (i < svg.size() && !isSpace(svg[i]) && svg[i] != '>' && svg[i] != '/') {
+      ++i;
+    }
+    name = svg.substr(nameStart, i - nameStart);
+    if (name.empty()) {
+      return std::string_view::npos;
+    }
+    while (true) {
+      while (i < svg.size() && isSpace(svg[i])) {
+        ++i;
+      }
+      if (i >= svg.size()) {
+        return std::string_view::npos;
+      }
+      if (svg[i] == '>') {
+        return i + 1;
+      }
+      if (svg[i] == '/') {
+        if (i + 1 >= svg.size() || svg[i + 1] != '>') {
+          return std::string_view::npos;
+        }
+        selfClosing = true;
+        return i + 2;
+      }
+      const size_t attributeStart = i;
+      while (i < svg.size() && !isSpace(svg[i]) && svg[i] != '=' && svg[i] != '>' && svg[i] != '/') {
+        ++i;
+      }
+      const std::string_view attributeName = svg.substr(attributeStart, i - attributeStart);
+      while (i < svg.size() && isSpace(svg[i])) {
+        ++i;
+      }
+      if (i >= svg.size() || svg[i] != '=') {
+        return std::string_view::npos;
+      }
+      ++i;
+      while (i < svg.size() && isSpace(svg[i])) {
+        ++i;
+      }
+      if (i >= svg.size() || (svg[i] != '"' && svg[i] != '\'')) {
+        return std::string_view::npos;
+      }
+      const char quote = svg[i++];
+      const size_t valueEnd = svg.find(quote, i);
+      if (valueEnd == std::string_view::npos) {
+        return std::string_view::npos;
+      }
+      attributes.push_back({attributeName, svg.substr(i, valueEnd - i)});
+      i = valueEnd + 1;
+    }
+  }
+
+  void readViewport(const std::vector<Attribute>& attributes) {
+    NumberScanner viewBox(attribute(attributes, "viewBox"));
+    float box[4];
+    if (viewBox.number(box[0]) && viewBox.number(box[1]) && viewBox.number(box[2]) && viewBox.number(box[3]) &&
+        box[2] > 0 && box[3] > 0) {
+      plan_.bounds_ = {box[0], box[1], box[0] + box[2], box[1] + box[3]};
+      return;
+    }
+    const float width = parseLength(attribute(attributes, "width"), 0);
+    const float height = parseLength(attribute(attributes, "height"), 0);
+    if (width > 0 && height > 0) {
+      plan_.bounds_ = {0, 0, width, height};
+    }
+  }
+
+  // Applies the element's attributes to style and draws it if it is a
+  // shape; returns false when its subtree is not displayed
+  bool element(std::string_view name, const std::vector<Attribute>& attributes, Style& style, bool root) {
+    const float width = plan_.bounds_.maxX - plan_.bounds_.minX;
+    const float height = plan_.bounds_.maxY - plan_.bounds_.minY;
+    const float diagonal = std::sqrt((width * width + height * height) / 2);
+    const std::string_view transform = attribute(attributes, "transform");
+    if (!transform.empty()) {
+      style.transform = style.transform * parseTransform(transform);
+    }
+    for (const Attribute& item : attributes) {
+      if (item.name != "style") {
+        applyProperty(style, item.name, item.value, diagonal);
+      }
+    }
+    applyStyleAttribute(style, attribute(attributes, "style"), diagonal);
+    if (!style.display) {
+      return false;
+    }
+    auto length = [&](const char* attributeName, float reference) {
+      return parseLength(attribute(attributes, attributeName), reference);
+    };
+
+    if (name == "svg") {
+      // The root is the document; nested viewports only offset their content
+      if (!root) {
+        style.transform = style.transform * Matrix{1, 0, 0, 1, length("x", width), length("y", height)};
+      }
+      return true;
+    }
+    if (name == "g" || name == "a" || name == "switch") {
+      return true;
+    }
+
+    PathBuilder path(flatness_ / std::max(style.transform.scale(), 1e-6f));
+    bool fillable = true;
+    if (name == "rect") {
+      const float x = length("x", width);
+      const float y = length("y", height);
+      const float w = length("width", width);
+      const float h = length("height", height);
+      if (w <= 0 || h <= 0) {
+        return true;
+      }
+      const std::string_view rxText = attribute(attributes, "rx");
+      const std::string_view ryText = attribute(attributes, "ry");
+      float rx = parseLength(rxText, width, -1);
+      float ry = parseLength(ryText, height, -1);
+      rx = rx < 0 ? std::max(ry, 0.0f) : rx;
+      ry = ry < 0 ? rx : ry;
+      rx = std::min(rx, w / 2);
+      ry = std::min(ry, h / 2);
+      if (rx > 0 && ry > 0) {
+        path.moveTo(x + rx, y);
+        path.lineTo(x + w - rx, y);
+        path.arcTo(rx, ry, 0, false, true, x + w, y + ry);
+        path.lineTo(x + w, y + h - ry);
+        path.arcTo(rx, ry, 0, false, true, x + w - rx, y + h);
+        path.lineTo(x + rx, y + h);
+        path.arcTo(rx, ry, 0, false, true, x, y + h - ry);
+        path.lineTo(x, y + ry);
+        path.arcTo(rx, ry, 0, false, true, x + rx, y);
+      } else {
+        path.moveTo(x, y);
+        path.lineTo(x + w, y);
+        path.lineTo(x + w, y + h);
+        path.lineTo(x, y + h);
+      }
+      path.close();
+    } else if (name == "circle" || name == "ellipse") {
+      const bool circle = name == "circle";
+      const float rx = circle ? length("r", diagonal) : length("rx", width);
+      const float ry = circle ? rx : length("ry", height);
+      if (rx <= 0 || ry <= 0) {
+        return true;
+      }
+      path.ellipse(length("cx", width), length("cy", height), rx, ry);
+    } else if (name == "line") {
+      path.moveTo(length("x1", width), length("y1", height));
+      path.lineTo(length("x2", width), length("y2", height));
+      fillable = false;
+    } else if (name == "polyline" || name == "polygon") {
+      appendPoints(attribute(attributes, "points"), path, name == "polygon");
+    } else if (name == "path") {
+      parsePathData(attribute(attributes, "d"), path);
+    } else {
+      // Unknown elements draw nothing but may hold shapes
+      return true;
+    }
+
+    std::vector<PathBuilder::Subpath>& subpaths = path.subpaths();
+    if (subpaths.empty() || !style.visible) {
+      return true;
+    }
+    for (PathBuilder::Subpath& subpath : subpaths) {
+      for (size_t i = 0; i + 1 < subpath.points.size(); i += 2) {
+        style.transform.apply(subpath.points[i], subpath.points[i + 1]);
+      }
+    }
+    bool drawn = false;
+    if (fillable && !style.fill.none) {
+      drawn |= addFill(subpaths, withAlpha(style.fill, style.fillOpacity * style.opacity), style.evenOdd);
+    }
+    if (!style.stroke.none && style.strokeWidth > 0) {
+      drawn |= addStroke(subpaths, style.strokeWidth * style.transform.scale(),
+                         withAlpha(style.stroke, style.strokeOpacity * style.opacity));
+    }
+    plan_.elements_ += drawn ? 1 : 0;
+    return true;
+  }
+
+  bool addFill(const std::vector<PathBuilder::Subpath>& subpaths, uint32_t color, bool evenOdd) {
+    if ((color >> 24) == 0) {
+      return false;
+    }
+    FloorPlan::Item item{{INFINITY, INFINITY, -INFINITY, -INFINITY}, static_cast<uint32_t>(plan_.contourStarts_.size() - 1),
+                         0, color, evenOdd};
+    for (const PathBuilder::Subpath& subpath : subpaths) {
+      if (subpath.points.size() < 6) {
+        continue;
+      }
+      for (size_t i = 0; i < subpath.points.size(); i += 2) {
+        growBounds(item.bounds, subpath.points[i], subpath.points[i + 1]);
+      }
+      plan_.points_.insert(plan_.points_.end(), subpath.points.begin(), subpath.points.end());
+      plan_.contourStarts_.push_back(static_cast<uint32_t>(plan_.points_.size() / 2));
+      ++item.contourCount;
+    }
+    return finishItem(item);
+  }
+
+  // Each segment becomes a quad wound the same way as every other, so where
+  // quads overlap at joins coverage adds up instead of cancelling
+  bool addStroke(const std::vector<PathBuilder::Subpath>& subpaths, float width, uint32_t color) {
+    if ((color >> 24) == 0) {
+      return false;
+    }
+    const float half = width / 2;
+    FloorPlan::Item item{{INFINITY, INFINITY, -INFINITY, -INFINITY}, static_cast<uint32_t>(plan_.contourStarts_.size() - 1),
+                         0, color, false};
+    for (const PathBuilder::Subpath& subpath : subpaths) {
+      const std::vector<float>& p = subpath.points;
+      const size_t count = p.size() / 2;
+      const size_t segments = subpath.closed ? count : count - 1;
+      for (size_t s = 0; s < segments && count >= 2; ++s) {
+        const size_t next = (s + 1) % count;
+        const float x0 = p[2 * s];
+        const float y0 = p[2 * s + 1];
+        const float x1 = p[2 * next];
+        const float y1 = p[2 * next + 1];
+        const float length = std::hypot(x1 - x0, y1 - y0);
+        if (length == 0) {
+          continue;
+        }
+        const float ux = (x1 - x0) / length * half;
+        const float uy = (y1 - y0) / length * half;
+        const float quad[8] = {
+            x0 - ux - uy, y0 - uy + ux, x1 + ux - uy, y1 + uy + ux,
+            x1 + ux + uy, y1 + uy - ux, x0 - ux + uy, y0 - uy - ux,
+        };
+        for (int i = 0; i < 8; i += 2) {
+          growBounds(item.bounds, quad[i], quad[i + 1]);
+        }
+        plan_.points_.insert(plan_.points_.end(), quad, quad + 8);
+        plan_.contourStarts_.push_back(static_cast<uint32_t>(plan_.points_.size() / 2));
+        ++item.contourCount;
+      }
+    }
+    return finishItem(item);
+  }
+
+  bool finishItem(const FloorPlan::Item& item) {
+    if (item.contourCount == 0) {
+      return false;
+    }
+    plan_.items_.push_back(item);
+    return true;
+  }
+
+  FloorPlan& plan_;
+  const float flatness_;
+};
+
+std::unique_ptr<FloorPlan> FloorPlan::parse(std::string_view svg, float flatness, std::string* error) {
+  std::unique_ptr<FloorPlan> plan(new FloorPlan());
+  FloorPlanBuilder builder(*plan, flatness);
+  if (!builder.parse(svg, error)) {
+    return nullptr;
+  }
+  if (plan->bounds_.maxX <= plan->bounds_.minX || plan->bounds_.maxY <= plan->bounds_.minY) {
+    Rect bounds{INFINITY, INFINITY, -INFINITY, -INFINITY};
+    for (const Item& item : plan->items_) {
+      growBounds(bounds, item.bounds.minX, item.bounds.minY);
+      growBounds(bounds, item.bounds.maxX, item.bounds.maxY);
+    }
+    plan->bounds_ = plan->items_.empty() ? Rect{0, 0, 1, 1} : bounds;
+  }
+  plan->items_.shrink_to_fit();
+  plan->contourStarts_.shrink_to_fit();
+  plan->points_.shrink_to_fit();
+  plan->buildGrid();
+  return plan;
+}
+
+FloorPlan::Contour FloorPlan::contour(uint32_t index) const {
+  const uint32_t start = contourStarts_[index];
+  return {points_.data() + 2 * static_cast<size_t>(start), contourStarts_[index + 1] - start};
+}
+
+// About two items per cell, so a tile query reads few cells it does not need
+void FloorPlan::buildGrid() {
+  const float width = bounds_.maxX - bounds_.minX;
+  const float height = bounds_.maxY - bounds_.minY;
+  const float cells = std::max(1.0f, items_.size() / 2.0f);
+  gridColumns_ = std::clamp(static_cast<uint32_t>(std::sqrt(cells * width / height)), 1u, 256u);
+  gridRows_ = std::clamp(static_cast<uint32_t>(std::sqrt(cells * height / width)), 1u, 256u);
+  cellWidth_ = width / gridColumns_;
+  cellHeight_ = height / gridRows_;
+
+  auto cellRange = [&](const Rect& rect, uint32_t& x0, uint32_t& y0, uint32_t& x1, uint32_t& y1) {
+    auto column = [&](float x) {
+      return static_cast<uint32_t>(std::clamp((x - bounds_.minX) / cellWidth_, 0.0f, gridColumns_ - 1.0f));
+    };
+    auto row = [&](float y) {
+      return static_cast<uint32_t>(std::clamp((y - bounds_.minY) / cellHeight_, 0.0f, gridRows_ - 1.0f));
+    };
+    x0 = column(rect.minX);
+    x1 = column(rect.maxX);
+    y0 = row(rect.minY);
+    y1 = row(rect.maxY);
+  };
+
+  // Counting pass, then fill, so every cell's list is contiguous
+  std::vector<uint32_t> counts(static_cast<size_t>(gridColumns_) * gridRows_ + 1, 0);
+  for (const Item& item : items_) {
+    uint32_t x0, y0, x1, y1;
+    cellRange(item.bounds, x0, y0, x1, y1);
+    for (uint32_t y = y0; y <= y1; ++y) {
+      for (uint32_t x = x0; x <= x1; ++x) {
+        ++counts[y * gridColumns_ + x + 1];
+      }
+    }
+  }
+  for (size_t i = 1; i < counts.size(); ++i) {
+    counts[i] += counts[i - 1];
+  }
+  cellStarts_ = counts;
+  cellItems_.assign(counts.back(), 0);
+  for (uint32_t index = 0; index < items_.size(); ++index) {
+    uint32_t x0, y0, x1, y1;
+    cellRange(items_[index].bounds, x0, y0, x1, y1);
+    for (uint32_t y = y0; y <= y1; ++y) {
+      for (uint32_t x = x0; x <= x1; ++x) {
+        cellItems_[counts[y * gridColumns_ + x]++] = index;
+      }
+    }
+  }
+}
+
+void FloorPlan::query(const Rect& rect, std::vector<uint32_t>& items) const {
+  if (items_.empty()) {
+    return;
+  }
+  const size_t first = items.size();
+  auto column = [&](float x) {
+    return static_cast<uint32_t>(std::clamp((x - bounds_.minX) / cellWidth_, 0.0f, gridColumns_ - 1.0f));
+  };
+  auto row = [&](float y) {
+    return static_cast<uint32_t>(std::clamp((y - bounds_.minY) / cellHeight_, 0.0f, gridRows_ - 1.0f));
+  };
+  const uint32_t x0 = column(rect.minX);
+  const uint32_t x1 = column(rect.maxX);
+  const uint32_t y0 = row(rect.minY);
+  const uint32_t y1 = row(rect.maxY);
+  for (uint32_t y = y0; y <= y1; ++y) {
+    for (uint32_t x = x0; x <= x1; ++x) {
+      const uint32_t cell = y * gridColumns_ + x;
+      for (uint32_t i = cellStarts_[cell]; i < cellStarts_[cell + 1]; ++i) {
+        const Rect& bounds = items_[cellItems_[i]].bounds;
+        if (bounds.minX <= rect.maxX && bounds.maxX >= rect.minX && bounds.minY <= rect.maxY &&
+            bounds.maxY >= rect.minY) {
+          items.push_back(cellItems_[i]);
+        }
+      }
+    }
+  }
+  std::sort(items.begin() + first, items.end());
+  items.erase(std::unique(items.begin() + first, items.end()), items.end());
+}
+
+size_t FloorPlan::byteSize() const {
+  return sizeof(*this) + items_.capacity() * sizeof(Item) + contourStarts_.capacity() * sizeof(uint32_t) +
+         points_.capacity() * sizeof(float) + cellStarts_.capacity() * sizeof(uint32_t) +
+         cellItems_.capacity() * sizeof(uint32_t);
+}
+
+}  // namespace meridianmaps
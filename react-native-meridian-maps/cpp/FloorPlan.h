@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "PlacemarkTable.h"
+
+namespace meridianmaps {
+
+/**
+ * A floor SVG flattened into a display list: every filled shape and every
+ * stroke becomes one item of straight-edged contours in document (viewBox)
+ * units, in paint order, with transforms and inherited styles resolved.
+ *
+ * Covers what floor plans use: rect (with rounded corners), circle,
+ * ellipse, line, polyline, polygon and path with every command, groups and
+ * nested svg elements, the transform attribute, presentation attributes and
+ * the style attribute, solid colors, opacity and fill-rule. Text, images,
+ * gradients, patterns, clip paths, masks and <use> are skipped; the SDK
+ * draws labels and icons itself. Strokes get butt ends extended by half the
+ * width, which closes the joins of walls. Immutable once parsed; queries are
+ * safe from any thread.
+ */
+class FloorPlan {
+ public:
+  struct Item {
+    // Document units, strokes included
+    Rect bounds;
+    uint32_t firstContour;
+    uint32_t contourCount;
+    // 0xAARRGGBB, not premultiplied
+    uint32_t color;
+    bool evenOdd;
+  };
+
+  struct Contour {
+    // x, y pairs; closed implicitly
+    const float* points;
+    uint32_t count;
+  };
+
+  // Curves and arcs are split into lines no further than flatness document
+  // units from the true curve. Fails on malformed XML or a missing <svg>.
+  static std::unique_ptr<FloorPlan> parse(std::string_view svg, float flatness = 0.25f,
+                                          std::string* error = nullptr);
+
+  // The viewBox, else 0, 0, width, height, else the bounds of the items
+  const Rect& bounds() const { return bounds_; }
+
+  // Shape elements drawn; an element with fill and stroke makes two items
+  size_t elementCount() const { return elements_; }
+  size_t size() const { return items_.size(); }
+  const Item& item(uint32_t index) const { return items_[index]; }
+  Contour contour(uint32_t index) const;
+
+  // Appends the items whose bounds intersect rect, in paint order
+  void query(const Rect& rect, std::vector<uint32_t>& items) const;
+
+  // Memory held by the display list and its grid
+  size_t byteSize() const;
+
+ private:
+  friend class FloorPlanBuilder;
+
+  FloorPlan() = default;
+  void buildGrid();
+
+  Rect bounds_{0, 0, 0, 0};
+  size_t elements_ = 0;
+  std::vector<Item> items_;
+  // Contour c spans points [contourStarts_[c], contourStarts_[c + 1])
+  std::vector<uint32_t> contourStarts_{0};
+  std::vector<float> points_;
+
+  // Uniform grid over bounds_; cell c lists items [cellStarts_[c], cellStarts_[c + 1])
+  uint32_t gridColumns_ = 0;
+  uint32_t gridRows_ = 0;
+  float cellWidth_ = 1;
+  float cellHeight_ = 1;
+  std::vector<uint32_t> cellStarts_;
+  std::vector<uint32_t> cellItems_;
+};
+
+}  // namespace meridianmaps
@@ -0,0 +1,131 @@
+#include "FloorPrefetcher.h"
+
+namespace meridianmaps {
+
+bool FloorPrefetcher::enqueueLocked(std::deque<std::string>& queue, const Floor& floor) {
+  bool added = false;
+  for (const std::string& url : floor.urls) {
+    if (!url.empty() && queued_.insert(url).second) {
+      queue.push_back(url);
+      added = true;
+    }
+  }
+  return added;
+}
+
+void FloorPrefetcher::dropLocked(std::deque<std::string>& queue) {
+  for (const std::string& url : queue) {
+    queued_.erase(url);
+  }
+  stats_.cancelled += queue.size();
+  queue.clear();
+}
+
+size_t FloorPrefetcher::openFloor(const std::string& mapId, const std::vector<Floor>& group) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  openMapId_ = mapId;
+  dropLocked(neighbors_);
+  planBytes_ = 0;
+
+  const Floor* open = nullptr;
+  for (const Floor& floor : group) {
+    if (floor.mapId == mapId) {
+      open = &floor;
+      break;
+    }
+  }
+  if (!open) {
+    return 0;
+  }
+  size_t floors = 0;
+  // The floor below, then the floor above
+  for (int offset : {-1, 1}) {
+    for (const Floor& floor : group) {
+      if (floor.mapId != mapId && floor.groupId == open->groupId && floor.level == open->level + offset &&
+          enqueueLocked(neighbors_, floor)) {
+        floors++;
+      }
+    }
+  }
+  return floors;
+}
+
+void FloorPrefetcher::addRouteFloor(const Floor& floor) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (floor.mapId == openMapId_) {
+    return;
+  }
+  // A URL already queued as a neighbor moves up to the route queue
+  for (const std::string& url : floor.urls) {
+    for (auto it = neighbors_.begin(); it != neighbors_.end(); ++it) {
+      if (*it == url) {
+        neighbors_.erase(it);
+        queued_.erase(url);
+        break;
+      }
+    }
+  }
+  enqueueLocked(route_, floor);
+}
+
+void FloorPrefetcher::clearRoute() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  dropLocked(route_);
+}
+
+void FloorPrefetcher::cancel() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  dropLocked(route_);
+  dropLocked(neighbors_);
+}
+
+bool FloorPrefetcher::step(const HttpFetch& network) {
+  std::string url;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (route_.empty() && neighbors_.empty()) {
+      return false;
+    }
+    if (planBytes_ >= cache_.maxBytes() / 2) {
+      dropLocked(route_);
+      dropLocked(neighbors_);
+      stats_.budgetStops++;
+      return false;
+    }
+    std::deque<std::string>& queue = route_.empty() ? neighbors_ : route_;
+    url = std::move(queue.front());
+    queue.pop_front();
+    queued_.erase(url);
+  }
+
+  if (cache_.contains(url)) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stats_.alreadyCached++;
+    return true;
+  }
+  const HttpResponse response = network({url, ""});
+  const bool stored = response.status == 200 && cache_.put(url, response.contentType, response.body);
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (stored) {
+    stats_.fetched++;
+    stats_.bytesFetched += response.body.size();
+    planBytes_ += response.body.size();
+  } else {
+    stats_.failures++;
+  }
+  return true;
+}
+
+bool FloorPrefetcher::idle() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return route_.empty() && neighbors_.empty();
+}
+
+FloorPrefetchStats FloorPrefetcher::stats() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  FloorPrefetchStats stats = stats_;
+  stats.queued = route_.size() + neighbors_.size();
+  return stats;
+}
+
+}  // namespace meridianmaps
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "AssetCache.h"
+#include "PlacemarkSync.h"
+
+namespace meridianmaps {
+
+struct FloorPrefetchStats {
+  // URLs waiting now
+  uint64_t queued = 0;
+  // URLs downloaded into the cache and their bytes, URLs found there already, failed downloads
+  uint64_t fetched = 0;
+  uint64_t bytesFetched = 0;
+  uint64_t alreadyCached = 0;
+  uint64_t failures = 0;
+  // Queued URLs dropped by cancel() or a newly opened floor, and plans cut short by the budget
+  uint64_t cancelled = 0;
+  uint64_t budgetStops = 0;
+};
+
+/**
+ * Plans background downloads of the floors a user is likely to open next
+ * into an AssetCache: the floors one level above and below the open floor
+ * in its map group, and every floor of the current route, route floors
+ * first.
+ *
+ * The platforms resolve floors to their asset URLs and call step() from a
+ * low-priority worker until it returns false; each step downloads one URL
+ * with the platform's HttpFetch outside the lock. A plan (everything queued
+ * since the last openFloor()) downloads at most half the cache budget, so
+ * prefetching cannot push out most of what the user actually viewed.
+ * Thread-safe.
+ */
+class FloorPrefetcher {
+ public:
+  struct Floor {
+    std::string mapId;
+    // Empty for a floor outside any group
+    std::string groupId;
+    int level = 0;
+    // Its SVG and image URLs
+    std::vector<std::string> urls;
+  };
+
+  explicit FloorPrefetcher(AssetCache& cache) : cache_(cache) {}
+
+  // Makes mapId the open floor and replaces the queued neighbors with the
+  // floors a level above and below it in group; route floors stay queued.
+  // Returns how many floors were queued.
+  size_t openFloor(const std::string& mapId, const std::vector<Floor>& group);
+
+  // Queues a floor of the route ahead of the neighbors, unless it is open.
+  void addRouteFloor(const Floor& floor);
+  void clearRoute();
+
+  // Drops everything queued; a download in progress still completes.
+  void cancel();
+
+  // Downloads the next queued URL. False once nothing is queued or the plan
+  // has used its share of the budget.
+  bool step(const HttpFetch& network);
+
+  bool idle() const;
+  FloorPrefetchStats stats() const;
+
+ private:
+  bool enqueueLocked(std::deque<std::string>& queue, const Floor& floor);
+  void dropLocked(std::deque<std::string>& queue);
+
+  AssetCache& cache_;
+  mutable std::mutex mutex_;
+  std::string openMapId_;
+  std::deque<std::string> route_;
+  std::deque<std::string> neighbors_;
+  // Every URL in either queue, so a floor on the route and next door is fetched once
+  std::unordered_set<std::string> queued_;
+  uint64_t planBytes_ = 0;
+  FloorPrefetchStats stats_;
+};
+
+}  // namespace meridianmaps
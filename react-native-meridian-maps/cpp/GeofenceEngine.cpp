@@ -0,0 +1,270 @@
+#include "GeofenceEngine.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace meridianmaps {
+
+namespace {
+
+// A region overlapping more cells than this goes on the floor's large list
+constexpr int64_t kMaxCellsPerRegion = 256;
+constexpr double kPi = 3.14159265358979323846;
+
+void setError(std::string* error, const std::string& message) {
+  if (error) {
+    *error = message;
+  }
+}
+
+uint64_t cellKey(int64_t cx, int64_t cy) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+}
+
+int64_t cellOf(float value, float cellSize) {
+  return static_cast<int64_t>(std::floor(value / cellSize));
+}
+
+bool rectContains(const Rect& rect, float x, float y) {
+  return x >= rect.minX && x <= rect.maxX && y >= rect.minY && y <= rect.maxY;
+}
+
+float segmentDistance(float x, float y, const GeofencePoint& a, const GeofencePoint& b) {
+  const float dx = b.x - a.x;
+  const float dy = b.y - a.y;
+  const float lengthSquared = dx * dx + dy * dy;
+  float t = lengthSquared > 0 ? ((x - a.x) * dx + (y - a.y) * dy) / lengthSquared : 0;
+  t = std::clamp(t, 0.0f, 1.0f);
+  return std::hypot(x - (a.x + t * dx), y - (a.y + t * dy));
+}
+
+}  // namespace
+
+std::vector<GeofencePoint> circlePolygon(float x, float y, float radius, int sides) {
+  sides = std::max(sides, 3);
+  std::vector<GeofencePoint> polygon;
+  polygon.reserve(static_cast<size_t>(sides));
+  for (int i = 0; i < sides; ++i) {
+    const double angle = 2 * kPi * i / sides;
+    polygon.push_back({x + radius * static_cast<float>(std::cos(angle)), y + radius * static_cast<float>(std::sin(angle))});
+  }
+  return polygon;
+}
+
+bool GeofenceEngine::add(GeofenceRegion region, std::string* error) {
+  if (region.id.empty()) {
+    setError(error, "A geofence needs an id");
+    return false;
+  }
+  if (region.polygon.size() < 3) {
+    setError(error, "Geofence " + region.id + " needs at least 3 vertices");
+    return false;
+  }
+  Rect bounds{region.polygon[0].x, region.polygon[0].y, region.polygon[0].x, region.polygon[0].y};
+  for (const GeofencePoint& point : region.polygon) {
+    if (!std::isfinite(point.x) || !std::isfinite(point.y)) {
+      setError(error, "Geofence " + region.id + " has a vertex that is not a number");
+      return false;
+    }
+    bounds.minX = std::min(bounds.minX, point.x);
+    bounds.minY = std::min(bounds.minY, point.y);
+    bounds.maxX = std::max(bounds.maxX, point.x);
+    bounds.maxY = std::max(bounds.maxY, point.y);
+  }
+  region.hysteresis = std::max(region.hysteresis, 0.0f);
+  region.dwellMs = std::max<int64_t>(region.dwellMs, 0);
+
+  remove(region.id);
+  index_.emplace(region.id, static_cast<uint32_t>(regions_.size()));
+  regions_.push_back(Region{std::move(region), bounds});
+  dirty_ = true;
+  return true;
+}
+
+bool GeofenceEngine::remove(std::string_view id) {
+  auto found = index_.find(std::string(id));
+  if (found == index_.end()) {
+    return false;
+  }
+  const uint32_t removed = found->second;
+  const uint32_t last = static_cast<uint32_t>(regions_.size() - 1);
+  index_.erase(found);
+  inside_.erase(std::remove_if(inside_.begin(), inside_.end(),
+                               [removed](const Presence& presence) { return presence.region == removed; }),
+                inside_.end());
+  if (removed != last) {
+    // The last region takes the removed one's slot
+    regions_[removed] = std::move(regions_[last]);
+    index_[regions_[removed].definition.id] = removed;
+    for (Presence& presence : inside_) {
+      if (presence.region == last) {
+        presence.region = removed;
+      }
+    }
+  }
+  regions_.pop_back();
+  dirty_ = true;
+  return true;
+}
+
+void GeofenceEngine::clear() {
+  regions_.clear();
+  index_.clear();
+  floors_.clear();
+  inside_.clear();
+  testedAt_.clear();
+  dirty_ = false;
+}
+
+bool GeofenceEngine::contains(std::string_view id) const {
+  return index_.count(std::string(id)) > 0;
+}
+
+void GeofenceEngine::rebuild() {
+  dirty_ = false;
+  floors_.clear();
+  testedAt_.assign(regions_.size(), 0);
+
+  // Size each floor's cells to its median region, so a typical region sits in a few cells
+  std::unordered_map<std::string, std::vector<uint32_t>> byFloor;
+  for (uint32_t i = 0; i < regions_.size(); ++i) {
+    byFloor[regions_[i].definition.mapKey].push_back(i);
+  }
+  for (auto& [mapKey, members] : byFloor) {
+    std::vector<float> extents;
+    extents.reserve(members.size());
+    for (uint32_t i : members) {
+      const Rect& bounds = regions_[i].bounds;
+      extents.push_back(std::max(bounds.maxX - bounds.minX, bounds.maxY - bounds.minY));
+    }
+    std::nth_element(extents.begin(), extents.begin() + extents.size() / 2, extents.end());
+
+    FloorGrid& grid = floors_[mapKey];
+    grid.cellSize = std::max(extents[extents.size() / 2], 1.0f);
+    for (uint32_t i : members) {
+      const Rect& bounds = regions_[i].bounds;
+      const int64_t minX = cellOf(bounds.minX, grid.cellSize);
+      const int64_t maxX = cellOf(bounds.maxX, grid.cellSize);
+      const int64_t minY = cellOf(bounds.minY, grid.cellSize);
+      const int64_t maxY = cellOf(bounds.maxY, grid.cellSize);
+      if ((maxX - minX + 1) * (maxY - minY + 1) > kMaxCellsPerRegion) {
+        grid.large.push_back(i);
+        continue;
+      }
+      for (int64_t cx = minX; cx <= maxX; ++cx) {
+        for (int64_t cy = minY; cy <= maxY; ++cy) {
+          grid.cells[cellKey(cx, cy)].push_back(i);
+        }
+      }
+    }
+  }
+}
+
+// Even-odd rule: count the edges a ray to +x crosses
+bool GeofenceEngine::insideRegion(const Region& region, float x, float y) {
+  if (!rectContains(region.bounds, x, y)) {
+    return false;
+  }
+  stats_.polygonTests++;
+  const std::vector<GeofencePoint>& polygon = region.definition.polygon;
+  bool inside = false;
+  for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+    const GeofencePoint& a = polygon[i];
+    const GeofencePoint& b = polygon[j];
+    if ((a.y > y) != (b.y > y) && x < (b.x - a.x) * (y - a.y) / (b.y - a.y) + a.x) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+float GeofenceEngine::distanceOutside(const Region& region, float x, float y) {
+  stats_.polygonTests++;
+  const std::vector<GeofencePoint>& polygon = region.definition.polygon;
+  float distance = INFINITY;
+  for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+    distance = std::min(distance, segmentDistance(x, y, polygon[j], polygon[i]));
+  }
+  return distance;
+}
+
+void GeofenceEngine::update(const LocationSample& sample, std::vector<GeofenceTransition>* transitions) {
+  if (dirty_) {
+    rebuild();
+  }
+  const uint64_t stamp = ++stats_.updates;
+  const float x = static_cast<float>(sample.x);
+  const float y = static_cast<float>(sample.y);
+  const size_t firstTransition = transitions->size();
+
+  // Exits and dwells of the regions the device was already inside
+  std::vector<std::string> dwells;
+  size_t kept = 0;
+  for (Presence& presence : inside_) {
+    const Region& region = regions_[presence.region];
+    testedAt_[presence.region] = stamp;
+    const float hysteresis = region.definition.hysteresis;
+    bool stillInside = region.definition.mapKey == sample.mapKey;
+    if (stillInside && !insideRegion(region, x, y)) {
+      const Rect& bounds = region.bounds;
+      stillInside = hysteresis > 0 &&
+                    rectContains({bounds.minX - hysteresis, bounds.minY - hysteresis, bounds.maxX + hysteresis,
+                                   bounds.maxY + hysteresis},
+                                  x, y) &&
+                    distanceOutside(region, x, y) <= hysteresis;
+    }
+    if (!stillInside) {
+      transitions->push_back({GeofenceTransition::Type::Exit, region.definition.id, sample.timestampMs});
+      continue;
+    }
+    if (region.definition.dwellMs > 0 && !presence.dwelled &&
+        sample.timestampMs - presence.enteredMs >= region.definition.dwellMs) {
+      presence.dwelled = true;
+      dwells.push_back(region.definition.id);
+    }
+    inside_[kept++] = presence;
+  }
+  inside_.resize(kept);
+
+  // Enters, from the regions bucketed where the fix falls
+  auto floor = floors_.find(sample.mapKey);
+  if (floor != floors_.end()) {
+    const FloorGrid& grid = floor->second;
+    auto test = [&](uint32_t candidate) {
+      if (testedAt_[candidate] == stamp) {
+        return;
+      }
+      testedAt_[candidate] = stamp;
+      const Region& region = regions_[candidate];
+      if (insideRegion(region, x, y)) {
+        transitions->push_back({GeofenceTransition::Type::Enter, region.definition.id, sample.timestampMs});
+        inside_.push_back({candidate, sample.timestampMs, false});
+      }
+    };
+    auto cell = grid.cells.find(cellKey(cellOf(x, grid.cellSize), cellOf(y, grid.cellSize)));
+    if (cell != grid.cells.end()) {
+      for (uint32_t candidate : cell->second) {
+        test(candidate);
+      }
+    }
+    for (uint32_t candidate : grid.large) {
+      test(candidate);
+    }
+  }
+
+  for (std::string& id : dwells) {
+    transitions->push_back({GeofenceTransition::Type::Dwell, std::move(id), sample.timestampMs});
+  }
+  stats_.transitions += transitions->size() - firstTransition;
+}
+
+std::vector<std::string> GeofenceEngine::inside() const {
+  std::vector<std::string> ids;
+  ids.reserve(inside_.size());
+  for (const Presence& presence : inside_) {
+    ids.push_back(regions_[presence.region].definition.id);
+  }
+  return ids;
+}
+
+}  // namespace meridianmaps
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "LocationSample.h"
+#include "PlacemarkTable.h"
+
+namespace meridianmaps {
+
+struct GeofencePoint {
+  float x;
+  float y;
+};
+
+struct GeofenceRegion {
+  std::string id;
+  // Floor the polygon lies on
+  std::string mapKey;
+  // Vertices in map units, in either winding; the last one connects back to the first
+  std::vector<GeofencePoint> polygon;
+  // An inside region is only exited once a fix is this far outside its edge,
+  // so a position jittering on the boundary does not flap
+  float hysteresis = 0;
+  // Time inside after which a Dwell transition fires once; 0 for none
+  int64_t dwellMs = 0;
+};
+
+struct GeofenceTransition {
+  enum class Type { Enter, Exit, Dwell };
+
+  Type type;
+  std::string id;
+  // Timestamp of the fix that caused it
+  int64_t timestampMs;
+};
+
+struct GeofenceStats {
+  uint64_t updates = 0;
+  // Point-in-polygon and edge distance tests run; the grid keeps this close to
+  // the number of regions near each fix
+  uint64_t polygonTests = 0;
+  uint64_t transitions = 0;
+};
+
+// Regular polygon inscribed in the circle, for geofences known only by a point
+std::vector<GeofencePoint> circlePolygon(float x, float y, float radius, int sides = 16);
+
+/**
+ * Turns location fixes into enter, exit and dwell transitions for a set of
+ * polygon regions.
+ *
+ * Regions are bucketed per floor in a uniform grid over their bounds, so a fix
+ * is only tested against regions whose cell it falls in plus the ones it is
+ * already inside. State carries over between updates and only changes are
+ * reported. Dwell is checked when fixes arrive, so it fires on the first fix
+ * at or after the dwell time. Adding, replacing or removing regions rebuilds
+ * the grid on the next update. Not thread-safe.
+ */
+class GeofenceEngine {
+ public:
+  // Adds the region or replaces the one with the same id, forgetting whether
+  // the device was inside it. Returns false and fills error for an invalid polygon.
+  bool add(GeofenceRegion region, std::string* error = nullptr);
+  // Forgets the region without an Exit transition
+  bool remove(std::string_view id);
+  void clear();
+
+  size_t size() const { return regions_.size(); }
+  bool contains(std::string_view id) const;
+
+  // Appends the transitions the fix causes, exits first
+  void update(const LocationSample& sample, std::vector<GeofenceTransition>* transitions);
+
+  // Ids of the regions the last fix was inside
+  std::vector<std::string> inside() const;
+
+  const GeofenceStats& stats() const { return stats_; }
+
+ private:
+  struct Region {
+    GeofenceRegion definition;
+    Rect bounds;
+  };
+
+  struct Presence {
+    uint32_t region;
+    int64_t enteredMs;
+    bool dwelled;
+  };
+
+  // Regions of one floor bucketed by the grid cells their bounds overlap
+  struct FloorGrid {
+    float cellSize = 1;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+    // Regions spanning too many cells to bucket; tested on every fix
+    std::vector<uint32_t> large;
+  };
+
+  void rebuild();
+  bool insideRegion(const Region& region, float x, float y);
+  float distanceOutside(const Region& region, float x, float y);
+
+  std::vector<Region> regions_;
+  std::unordered_map<std::string, uint32_t> index_;
+  std::unordered_map<std::string, FloorGrid> floors_;
+  bool dirty_ = false;
+  std::vector<Presence> inside_;
+  // Per region: the update that last tested it, so a region in several cells is tested once
+  std::vector<uint64_t> testedAt_;
+  GeofenceStats stats_;
+};
+
+}  // namespace meridianmaps
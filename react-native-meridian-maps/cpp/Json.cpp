@@ -0,0 +1,338 @@
+#include "Json.h"
+
+#include <cstdint>
+#include <cstdlib>
+
+namespace meridianmaps {
+
+namespace {
+
+constexpr int kMaxDepth = 64;
+
+const JsonValue& nullValue() {
+  static const JsonValue value;
+  return value;
+}
+
+void appendUtf8(std::string& out, uint32_t codePoint) {
+  if (codePoint < 0x80) {
+    out.push_back(static_cast<char>(codePoint));
+  } else if (codePoint < 0x800) {
+    out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+    out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+  } else if (codePoint < 0x10000) {
+    out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+  } else {
+    out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+  }
+}
+
+}  // namespace
+
+class JsonParser {
+ public:
+  explicit JsonParser(std::string_view text) : text_(text) {}
+
+  bool parseDocument(JsonValue& out, std::string* error) {
+    skipWhitespace();
+    if (!parseValue(out, 0)) {
+      return fail(error);
+    }
+    skipWhitespace();
+    if (pos_ != text_.size()) {
+      error_ = "unexpected trailing characters";
+      return fail(error);
+    }
+    return true;
+  }
+
+ private:
+  bool fail(std::string* error) {
+    if (error) {
+      *error = error_ + " at offset " + std::to_string(pos_);
+    }
+    return false;
+  }
+
+  bool setError(const char* message) {
+    if (error_.empty()) {
+      error_ = message;
+    }
+    return false;
+  }
+
+  void skipWhitespace() {
+    while (pos_ < text_.size() &&
+           (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' || text_[pos_] == '\r')) {
+      ++pos_;
+    }
+  }
+
+  bool consume(std::string_view literal) {
+    if (text_.substr(pos_, literal.size()) != literal) {
+      return false;
+    }
+    pos_ += literal.size();
+    return true;
+  }
+
+  bool parseValue(JsonValue& out, int depth) {
+    if (depth > kMaxDepth) {
+      return setError("nesting too deep");
+    }
+    if (pos_ >= text_.size()) {
+      return setError("unexpected end of input");
+    }
+    switch (text_[pos_]) {
+      case '{':
+        return parseObject(out, depth);
+      case '[':
+        return parseArray(out, depth);
+      case '"':
+        out.type_ = JsonValue::Type::String;
+        return parseString(out.string_);
+      case 't':
+        out.type_ = JsonValue::Type::Bool;
+        out.bool_ = true;
+        return consume("true") || setError("invalid literal");
+      case 'f':
+        out.type_ = JsonValue::Type::Bool;
+        return consume("false") || setError("invalid literal");
+      case 'n':
+        return consume("null") || setError("invalid literal");
+      default:
+        return parseNumber(out);
+    }
+  }
+
+  bool parseObject(JsonValue& out, int depth) {
+    out.type_ = JsonValue::Type::Object;
+    ++pos_;
+    skipWhitespace();
+    if (consume("}")) {
+      return true;
+    }
+    while (true) {
+      skipWhitespace();
+      std::string key;
+      if (pos_ >= text_.size() || text_[pos_] != '"') {
+        return setError("expected object key");
+      }
+      if (!parseString(key)) {
+        return false;
+      }
+      skipWhitespace();
+      if (!consume(":")) {
+        return setError("expected ':'");
+      }
+      skipWhitespace();
+      out.members_.emplace_back(std::move(key), JsonValue());
+      if (!parseValue(out.members_.back().second, depth + 1)) {
+        return false;
+      }
+      skipWhitespace();
+      if (consume("}")) {
+        return true;
+      }
+      if (!consume(",")) {
+        return setError("expected ',' or '}'");
+      }
+    }
+  }
+
+  bool parseArray(JsonValue& out, int depth) {
+    out.type_ = JsonValue::Type::Array;
+    ++pos_;
+    skipWhitespace();
+    if (consume("]")) {
+      return true;
+    }
+    while (true) {
+      skipWhitespace();
+      out.items_.emplace_back();
+      if (!parseValue(out.items_.back(), depth + 1)) {
+        return false;
+      }
+      skipWhitespace();
+      if (consume("]")) {
+        return true;
+      }
+      if (!consume(",")) {
+        return setError("expected ',' or ']'");
+      }
+    }
+  }
+
+  bool parseHex4(uint32_t& value) {
+    if (pos_ + 4 > text_.size()) {
+      return setError("truncated \\u escape");
+    }
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+      const char c = text_[pos_++];
+      value <<= 4;
+      if (c >= '0' && c <= '9') {
+        value |= static_cast<uint32_t>(c - '0');
+      } else if (c >= 'a' && c <= 'f') {
+        value |= static_cast<uint32_t>(c - 'a' + 10);
+      } else if (c >= 'A' && c <= 'F') {
+        value |= static_cast<uint32_t>(c - 'A' + 10);
+      } else {
+        return setError("invalid \\u escape");
+      }
+    }
+    return true;
+  }
+
+  bool parseString(std::string& out) {
+    ++pos_;
+    while (pos_ < text_.size()) {
+      // Copy unescaped runs in one go; most strings have no escapes at all
+      const size_t start = pos_;
+      while (pos_ < text_.size() && text_[pos_] != '"' && text_[pos_] != '\\' &&
+             static_cast<unsigned char>(text_[pos_]) >= 0x20) {
+        ++pos_;
+      }
+      out.append(text_.data() + start, pos_ - start);
+      if (pos_ >= text_.size()) {
+        break;
+      }
+      const char c = text_[pos_++];
+      if (c == '"') {
+        return true;
+      }
+      if (c != '\\') {
+        return setError("control character in string");
+      }
+      if (pos_ >= text_.size()) {
+        break;
+      }
+      const char escape = text_[pos_++];
+      switch (escape) {
+        case '"':
+        case '\\':
+        case '/':
+          out.push_back(escape);
+          break;
+        case 'b':
+          out.push_back('\b');
+          break;
+        case 'f':
+          out.push_back('\f');
+          break;
+        case 'n':
+          out.push_back('\n');
+          break;
+        case 'r':
+          out.push_back('\r');
+          break;
+        case 't':
+          out.push_back('\t');
+          break;
+        case 'u': {
+          uint32_t codePoint;
+          if (!parseHex4(codePoint)) {
+            return false;
+          }
+          if (codePoint >= 0xD800 && codePoint < 0xDC00) {
+            uint32_t low;
+            if (!consume("\\u") || !parseHex4(low) || low < 0xDC00 || low >= 0xE000) {
+              return setError("unpaired surrogate");
+            }
+            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+          } else if (codePoint >= 0xDC00 && codePoint < 0xE000) {
+            return setError("unpaired surrogate");
+          }
+          appendUtf8(out, codePoint);
+          break;
+        }
+        default:
+          return setError("invalid escape");
+      }
+    }
+    return setError("unterminated string");
+  }
+
+  bool parseNumber(JsonValue& out) {
+    const size_t start = pos_;
+    if (pos_ < text_.size() && text_[pos_] == '-') {
+      ++pos_;
+    }
+    const size_t digits = pos_;
+    while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9') {
+      ++pos_;
+    }
+    if (pos_ == digits) {
+      return setError("unexpected character");
+    }
+    if (pos_ < text_.size() && text_[pos_] == '.') {
+      ++pos_;
+      while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9') {
+        ++pos_;
+      }
+    }
+    if (pos_ < text_.size() && (text_[pos_] == 'e' || text_[pos_] == 'E')) {
+      ++pos_;
+      if (pos_ < text_.size() && (text_[pos_] == '+' || text_[pos_] == '-')) {
+        ++pos_;
+      }
+      while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9') {
+        ++pos_;
+      }
+    }
+    // strtod needs a terminator; numbers are short, so the copy is cheap
+    const std::string literal(text_.substr(start, pos_ - start));
+    char* end = nullptr;
+    out.type_ = JsonValue::Type::Number;
+    out.number_ = std::strtod(literal.c_str(), &end);
+    return end == literal.c_str() + literal.size() || setError("invalid number");
+  }
+
+  std::string_view text_;
+  size_t pos_ = 0;
+  std::string error_;
+};
+
+JsonValue JsonValue::parse(std::string_view text, std::string* error) {
+  JsonValue value;
+  JsonParser parser(text);
+  if (!parser.parseDocument(value, error)) {
+    return JsonValue();
+  }
+  return value;
+}
+
+const std::string& JsonValue::string() const {
+  static const std::string empty;
+  return type_ == Type::String ? string_ : empty;
+}
+
+const std::vector<JsonValue>& JsonValue::items() const {
+  static const std::vector<JsonValue> empty;
+  return type_ == Type::Array ? items_ : empty;
+}
+
+const JsonValue& JsonValue::operator[](std::string_view key) const {
+  for (const auto& member : members_) {
+    if (member.first == key) {
+      return member.second;
+    }
+  }
+  return nullValue();
+}
+
+bool JsonValue::has(std::string_view key) const {
+  for (const auto& member : members_) {
+    if (member.first == key) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace meridianmaps
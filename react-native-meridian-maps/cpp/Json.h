@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace meridianmaps {
+
+/**
+ * Parsed JSON document, just enough for the placemark sync pages.
+ *
+ * Objects keep their members in document order and are searched linearly,
+ * which is faster than hashing for the dozen keys a placemark has. Numbers
+ * are doubles. Accessors on a value of the wrong type return an empty value
+ * instead of failing, so optional fields read naturally.
+ */
+class JsonValue {
+ public:
+  enum class Type { Null, Bool, Number, String, Array, Object };
+
+  // Returns a Null value and fills error if text is not a single valid JSON
+  // value (trailing whitespace allowed). Nesting is limited to 64 levels.
+  static JsonValue parse(std::string_view text, std::string* error = nullptr);
+
+  Type type() const { return type_; }
+  bool isNull() const { return type_ == Type::Null; }
+  bool isString() const { return type_ == Type::String; }
+  bool isNumber() const { return type_ == Type::Number; }
+  bool isArray() const { return type_ == Type::Array; }
+  bool isObject() const { return type_ == Type::Object; }
+
+  bool boolean() const { return type_ == Type::Bool && bool_; }
+  double number(double fallback = 0) const { return type_ == Type::Number ? number_ : fallback; }
+  const std::string& string() const;
+  const std::vector<JsonValue>& items() const;
+
+  // Member of an object, or a shared Null value if absent.
+  const JsonValue& operator[](std::string_view key) const;
+  bool has(std::string_view key) const;
+
+ private:
+  friend class JsonParser;
+
+  Type type_ = Type::Null;
+  bool bool_ = false;
+  double number_ = 0;
+  std::string string_;
+  std::vector<JsonValue> items_;
+  std::vector<std::pair<std::string, JsonValue>> members_;
+};
+
+}  // namespace meridianmaps
@@ -0,0 +1,194 @@
+#include "LocationDutyCycle.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace meridianmaps {
+
+namespace {
+
+// Weight of each new sample in the running mean of the magnitude, about a
+// second at the 10 Hz the platforms sample at
+constexpr double kMeanWeight = 0.1;
+
+constexpr int64_t kNever = std::numeric_limits<int64_t>::max();
+
+}  // namespace
+
+bool MotionDetector::addSample(double x, double y, double z, int64_t timestampMs) {
+  const double magnitude = std::sqrt(x * x + y * y + z * z);
+  if (!hasMean_) {
+    hasMean_ = true;
+    mean_ = magnitude;
+    lastMotionMs_ = timestampMs;
+    return false;
+  }
+  const bool motion = std::abs(magnitude - mean_) > options_.threshold;
+  mean_ += (magnitude - mean_) * kMeanWeight;
+  if (motion) {
+    lastMotionMs_ = timestampMs;
+  }
+  const bool moving = timestampMs - lastMotionMs_ < options_.quietMs;
+  if (moving == moving_) {
+    return false;
+  }
+  moving_ = moving;
+  return true;
+}
+
+void MotionDetector::reset() {
+  hasMean_ = false;
+  mean_ = 0;
+  lastMotionMs_ = 0;
+  moving_ = true;
+}
+
+LocationDutyCycleStats& LocationDutyCycleStats::operator+=(const LocationDutyCycleStats& other) {
+  activeMs += other.activeMs;
+  pollingMs += other.pollingMs;
+  pausedMs += other.pausedMs;
+  fixes += other.fixes;
+  pauses += other.pauses;
+  motionResumes += other.motionResumes;
+  polls += other.polls;
+  return *this;
+}
+
+void LocationDutyCycle::setOptions(const LocationDutyCycleOptions& options, int64_t nowMs) {
+  options_ = options;
+  options_.stillDelayMs = std::max<int64_t>(options_.stillDelayMs, 0);
+  options_.stillPollIntervalMs = std::max<int64_t>(options_.stillPollIntervalMs, 0);
+  options_.pollTimeoutMs = std::max<int64_t>(options_.pollTimeoutMs, 0);
+  nextPollMs_ = std::min(nextPollMs_, nowMs + options_.stillPollIntervalMs);
+  update(nowMs);
+}
+
+void LocationDutyCycle::setMoving(bool moving, int64_t nowMs) {
+  if (moving == moving_) {
+    return;
+  }
+  moving_ = moving;
+  if (!moving) {
+    stillSinceMs_ = nowMs;
+  }
+  const bool wasActive = state_ == State::Active;
+  update(nowMs);
+  if (moving && !wasActive && state_ == State::Active) {
+    stats_.motionResumes++;
+  }
+}
+
+void LocationDutyCycle::setVisible(bool visible, int64_t nowMs) {
+  if (visible == visible_) {
+    return;
+  }
+  visible_ = visible;
+  update(nowMs);
+}
+
+void LocationDutyCycle::recordFix(int64_t nowMs) {
+  stats_.fixes++;
+  if (state_ == State::Polling) {
+    fixWhilePolling_ = true;
+    update(nowMs);
+  }
+}
+
+LocationDutyCycle::State LocationDutyCycle::targetState(int64_t nowMs) {
+  if (!options_.enabled) {
+    return State::Active;
+  }
+  if (!visible_ && options_.pauseWhenHidden) {
+    return State::Paused;
+  }
+  if (moving_ || nowMs - stillSinceMs_ < options_.stillDelayMs) {
+    return State::Active;
+  }
+  if (options_.stillPollIntervalMs == 0) {
+    return State::Paused;
+  }
+  switch (state_) {
+    case State::Active:
+      return State::Paused;
+    case State::Polling:
+      return fixWhilePolling_ || nowMs - stateSinceMs_ >= options_.pollTimeoutMs ? State::Paused : State::Polling;
+    case State::Paused:
+      return nowMs >= nextPollMs_ ? State::Polling : State::Paused;
+  }
+  return state_;
+}
+
+bool LocationDutyCycle::update(int64_t nowMs) {
+  const State target = targetState(nowMs);
+  if (target == state_) {
+    return false;
+  }
+  const bool wasRunning = running();
+  enter(target, nowMs);
+  return running() != wasRunning;
+}
+
+void LocationDutyCycle::enter(State state, int64_t nowMs) {
+  const int64_t elapsed = std::max<int64_t>(nowMs - stateSinceMs_, 0);
+  switch (state_) {
+    case State::Active:
+      stats_.activeMs += elapsed;
+      break;
+    case State::Polling:
+      stats_.pollingMs += elapsed;
+      break;
+    case State::Paused:
+      stats_.pausedMs += elapsed;
+      break;
+  }
+
+  if (state == State::Paused) {
+    if (state_ == State::Active) {
+      stats_.pauses++;
+    }
+    // Polls are spaced from the start of the pause or of the last wake
+    const int64_t from = state_ == State::Polling ? stateSinceMs_ : nowMs;
+    nextPollMs_ = from + options_.stillPollIntervalMs;
+  }
+  if (state == State::Polling) {
+    stats_.polls++;
+    fixWhilePolling_ = false;
+  }
+  state_ = state;
+  stateSinceMs_ = nowMs;
+}
+
+int64_t LocationDutyCycle::nextUpdateMs() const {
+  if (!options_.enabled || (!visible_ && options_.pauseWhenHidden) || moving_) {
+    return kNever;
+  }
+  switch (state_) {
+    case State::Active:
+      return stillSinceMs_ + options_.stillDelayMs;
+    case State::Polling:
+      return stateSinceMs_ + options_.pollTimeoutMs;
+    case State::Paused:
+      return options_.stillPollIntervalMs > 0 ? nextPollMs_ : kNever;
+  }
+  return kNever;
+}
+
+LocationDutyCycleStats LocationDutyCycle::stats(int64_t nowMs) const {
+  LocationDutyCycleStats stats = stats_;
+  const int64_t elapsed = std::max<int64_t>(nowMs - stateSinceMs_, 0);
+  switch (state_) {
+    case State::Active:
+      stats.activeMs += elapsed;
+      break;
+    case State::Polling:
+      stats.pollingMs += elapsed;
+      break;
+    case State::Paused:
+      stats.pausedMs += elapsed;
+      break;
+  }
+  return stats;
+}
+
+}  // namespace meridianmaps
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+
+namespace meridianmaps {
+
+struct MotionDetectorOptions {
+  // Change in acceleration magnitude, in g, that counts as motion
+  double threshold = 0.025;
+  // Without motion for this long the device is still
+  int64_t quietMs = 3000;
+};
+
+/**
+ * Tells moving from still from accelerometer samples. Gravity is removed by
+ * comparing each sample's magnitude with a running mean, so the orientation
+ * the device rests in does not matter. The first motion makes it moving at
+ * once; it becomes still only after quietMs without any. Not thread-safe.
+ */
+class MotionDetector {
+ public:
+  explicit MotionDetector(const MotionDetectorOptions& options = {}) : options_(options) {}
+
+  // Accelerometer sample in g; returns true when moving() changed
+  bool addSample(double x, double y, double z, int64_t timestampMs);
+
+  bool moving() const { return moving_; }
+  void reset();
+
+ private:
+  MotionDetectorOptions options_;
+  bool hasMean_ = false;
+  double mean_ = 0;
+  int64_t lastMotionMs_ = 0;
+  bool moving_ = true;
+};
+
+struct LocationDutyCycleOptions {
+  // When false location runs whenever the view shows it, as before
+  bool enabled = false;
+  // Still this long before location pauses
+  int64_t stillDelayMs = 30000;
+  // While still, location wakes this often for one fix; 0 stays paused until motion
+  int64_t stillPollIntervalMs = 120000;
+  // A wake ends at its first fix or after this long
+  int64_t pollTimeoutMs = 10000;
+  // Pause while the view is off screen or the app is in the background
+  bool pauseWhenHidden = true;
+};
+
+struct LocationDutyCycleStats {
+  // Time with location running at full rate, waking for a still fix, and paused
+  int64_t activeMs = 0;
+  int64_t pollingMs = 0;
+  int64_t pausedMs = 0;
+  uint64_t fixes = 0;
+  // Times location paused, and resumed because the device moved
+  uint64_t pauses = 0;
+  uint64_t motionResumes = 0;
+  uint64_t polls = 0;
+
+  LocationDutyCycleStats& operator+=(const LocationDutyCycleStats& other);
+};
+
+/**
+ * Decides when a view's location manager should run.
+ *
+ * Location runs while the device moves. Once it has been still for
+ * stillDelayMs, location pauses and only wakes every stillPollIntervalMs
+ * until one fix arrives. Motion resumes it at once. A hidden view pauses
+ * outright when pauseWhenHidden is set. The caller owns the clock and the
+ * location manager: it reports motion, visibility and fixes, calls update()
+ * at nextUpdateMs() and starts or stops location when running() changes.
+ * Not thread-safe.
+ */
+class LocationDutyCycle {
+ public:
+  enum class State { Active, Polling, Paused };
+
+  explicit LocationDutyCycle(int64_t nowMs = 0) : stateSinceMs_(nowMs), stillSinceMs_(nowMs) {}
+
+  void setOptions(const LocationDutyCycleOptions& options, int64_t nowMs);
+  const LocationDutyCycleOptions& options() const { return options_; }
+
+  void setMoving(bool moving, int64_t nowMs);
+  void setVisible(bool visible, int64_t nowMs);
+  void recordFix(int64_t nowMs);
+
+  // Advances the timers; returns true when running() changed
+  bool update(int64_t nowMs);
+
+  State state() const { return state_; }
+  bool running() const { return state_ != State::Paused; }
+  // When update() next needs to run for a timer; INT64_MAX when no timer is set
+  int64_t nextUpdateMs() const;
+
+  // Counters including the time spent in the current state up to nowMs
+  LocationDutyCycleStats stats(int64_t nowMs) const;
+
+ private:
+  State targetState(int64_t nowMs);
+  void enter(State state, int64_t nowMs);
+
+  LocationDutyCycleOptions options_;
+  State state_ = State::Active;
+  int64_t stateSinceMs_;
+  bool moving_ = true;
+  bool visible_ = true;
+  // Start of the current stillness
+  int64_t stillSinceMs_;
+  int64_t nextPollMs_ = 0;
+  bool fixWhilePolling_ = false;
+  LocationDutyCycleStats stats_;
+};
+
+}  // namespace meridianmaps
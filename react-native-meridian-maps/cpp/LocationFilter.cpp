@@ -0,0 +1,107 @@
+#include "LocationFilter.h"
+
+#include <cmath>
+
+namespace meridianmaps {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// A circle holding 68% of a round 2-D Gaussian has a radius of about 1.51 sigma;
+// accuracy radii are read and reported on that scale
+constexpr double kRadiusPerSigma = 1.51;
+
+}  // namespace
+
+void LocationFilter::Axis::start(double measured, double positionVariance, double velocityVariance) {
+  position = measured;
+  velocity = 0;
+  pp = positionVariance;
+  pv = 0;
+  vv = velocityVariance;
+}
+
+void LocationFilter::Axis::predict(double dt, double accelerationVariance) {
+  position += velocity * dt;
+  // P = F P F' + Q with F = [1 dt; 0 1] and Q for piecewise white acceleration
+  const double dt2 = dt * dt;
+  pp += 2 * dt * pv + dt2 * vv + accelerationVariance * dt2 * dt2 / 4;
+  pv += dt * vv + accelerationVariance * dt2 * dt / 2;
+  vv += accelerationVariance * dt2;
+}
+
+void LocationFilter::Axis::correct(double measured, double variance) {
+  const double innovation = measured - position;
+  const double s = pp + variance;
+  const double kp = pp / s;
+  const double kv = pv / s;
+  position += kp * innovation;
+  velocity += kv * innovation;
+  // P = (I - K H) P, written out so it stays symmetric
+  const double oldPp = pp;
+  const double oldPv = pv;
+  pp -= kp * oldPp;
+  pv -= kp * oldPv;
+  vv -= kv * oldPv;
+}
+
+LocationEstimate LocationFilter::update(const LocationSample& sample) {
+  const double accuracy = sample.accuracy > 0 ? sample.accuracy : options_.defaultAccuracy;
+  const double sigma = accuracy / kRadiusPerSigma;
+  const double variance = sigma * sigma;
+
+  if (!hasTrack_ || sample.mapKey != estimate_.sample.mapKey || sample.providerType != estimate_.sample.providerType ||
+      sample.timestampMs - estimate_.sample.timestampMs > options_.maxGapMs) {
+    start(sample, variance);
+    return estimate_;
+  }
+  if (sample.timestampMs < estimate_.sample.timestampMs) {
+    return estimate_;
+  }
+
+  const double dt = static_cast<double>(sample.timestampMs - estimate_.sample.timestampMs) / 1000.0;
+  if (dt > 0) {
+    const double accelerationVariance = options_.accelerationNoise * options_.accelerationNoise;
+    x_.predict(dt, accelerationVariance);
+    y_.predict(dt, accelerationVariance);
+  }
+  x_.correct(sample.x, variance);
+  y_.correct(sample.y, variance);
+  publish(sample);
+  return estimate_;
+}
+
+void LocationFilter::reset() {
+  hasTrack_ = false;
+  estimate_ = LocationEstimate();
+}
+
+void LocationFilter::start(const LocationSample& sample, double variance) {
+  const double velocityVariance = options_.initialSpeedSigma * options_.initialSpeedSigma;
+  x_.start(sample.x, variance, velocityVariance);
+  y_.start(sample.y, variance, velocityVariance);
+  hasTrack_ = true;
+  estimate_.hasHeading = false;
+  publish(sample);
+}
+
+void LocationFilter::publish(const LocationSample& sample) {
+  estimate_.sample = sample;
+  estimate_.sample.x = x_.position;
+  estimate_.sample.y = y_.position;
+  estimate_.sample.accuracy = kRadiusPerSigma * std::sqrt((x_.pp + y_.pp) / 2);
+  estimate_.vx = x_.velocity;
+  estimate_.vy = y_.velocity;
+  estimate_.speed = std::hypot(x_.velocity, y_.velocity);
+  if (estimate_.speed >= options_.minHeadingSpeed) {
+    double heading = std::atan2(x_.velocity, -y_.velocity) * 180 / kPi;
+    if (heading < 0) {
+      heading += 360;
+    }
+    estimate_.heading = heading;
+    estimate_.hasHeading = true;
+  }
+}
+
+}  // namespace meridianmaps
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+
+#include "LocationSample.h"
+
+namespace meridianmaps {
+
+struct LocationFilterOptions {
+  // Standard deviation of the walker's acceleration in map units/s²; larger
+  // values follow turns faster and smooth less
+  double accelerationNoise = 1;
+  // Measurement noise for fixes that report no accuracy
+  double defaultAccuracy = 10;
+  // Uncertainty of the velocity when a track starts, in map units/s
+  double initialSpeedSigma = 20;
+  // Start over when fixes are further apart than this
+  int64_t maxGapMs = 10000;
+  // Slower than this the heading is too noisy to update and the last one is kept
+  double minHeadingSpeed = 1;
+};
+
+// A filtered fix. sample holds the smoothed position, with accuracy set to the
+// estimate's uncertainty on the same radius scale as the fixes.
+struct LocationEstimate {
+  LocationSample sample;
+  // Map units per second
+  double vx = 0;
+  double vy = 0;
+  double speed = 0;
+  // Degrees clockwise from map up (-y), in [0, 360); only set when hasHeading
+  double heading = 0;
+  bool hasHeading = false;
+};
+
+/**
+ * Constant-velocity Kalman filter over the fixes of one device.
+ *
+ * Each axis is filtered on its own with a position/velocity state and white
+ * acceleration noise; a fix's accuracy radius sets its measurement noise. The state
+ * belongs to one mapKey and provider: a fix from another floor or provider,
+ * or one after a long gap, starts a new track at the raw position. Fixes older
+ * than the last one are ignored. Not thread-safe.
+ */
+class LocationFilter {
+ public:
+  explicit LocationFilter(const LocationFilterOptions& options = {}) : options_(options) {}
+
+  void setOptions(const LocationFilterOptions& options) { options_ = options; }
+  const LocationFilterOptions& options() const { return options_; }
+
+  LocationEstimate update(const LocationSample& sample);
+
+  bool hasTrack() const { return hasTrack_; }
+  // The last estimate; only meaningful while hasTrack()
+  const LocationEstimate& estimate() const { return estimate_; }
+
+  void reset();
+
+ private:
+  struct Axis {
+    double position = 0;
+    double velocity = 0;
+    // Covariance of (position, velocity)
+    double pp = 0;
+    double pv = 0;
+    double vv = 0;
+
+    void start(double measured, double positionVariance, double velocityVariance);
+    void predict(double dt, double accelerationVariance);
+    void correct(double measured, double variance);
+  };
+
+  void start(const LocationSample& sample, double variance);
+  void publish(const LocationSample& sample);
+
+  LocationFilterOptions options_;
+  bool hasTrack_ = false;
+  Axis x_;
+  Axis y_;
+  LocationEstimate estimate_;
+};
+
+}  // namespace meridianmaps
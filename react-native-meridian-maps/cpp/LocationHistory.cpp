@@ -0,0 +1,259 @@
+#include "LocationHistory.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace meridianmaps {
+
+namespace {
+
+// Worst case for one fix: four 64-bit zigzag varints
+constexpr size_t kMaxFixBytes = 4 * 10;
+
+int64_t quantize(double value) {
+  return static_cast<int64_t>(std::llround(value * LocationHistory::kScale));
+}
+
+double dequantize(int64_t value) {
+  return static_cast<double>(value) / LocationHistory::kScale;
+}
+
+size_t putVarint(uint8_t* out, int64_t value) {
+  uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+  size_t length = 0;
+  while (zigzag >= 0x80) {
+    out[length++] = static_cast<uint8_t>((zigzag & 0x7f) | 0x80);
+    zigzag >>= 7;
+  }
+  out[length++] = static_cast<uint8_t>(zigzag);
+  return length;
+}
+
+// Blocks are only ever written by putVarint, so no bounds checks are needed
+int64_t getVarint(const uint8_t* bytes, size_t* offset) {
+  uint64_t zigzag = 0;
+  int shift = 0;
+  uint8_t byte;
+  do {
+    byte = bytes[(*offset)++];
+    zigzag |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  return static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+}
+
+bool inBounds(const LocationHistoryQuery& query, double x, double y) {
+  return !query.hasBounds || (x >= query.minX && x <= query.maxX && y >= query.minY && y <= query.maxY);
+}
+
+// Largest-triangle-three-buckets: keeps the first and last fix and, from each
+// bucket in between, the fix that spans the largest triangle with the fix kept
+// before it and the average of the next bucket. Corners and turns survive where
+// picking every nth fix would cut them.
+std::vector<LocationSample> downsample(std::vector<LocationSample> points, size_t maxPoints) {
+  const size_t count = points.size();
+  if (maxPoints == 0 || count <= maxPoints) {
+    return points;
+  }
+  if (maxPoints == 1) {
+    return {std::move(points.back())};
+  }
+  if (maxPoints == 2) {
+    return {std::move(points.front()), std::move(points.back())};
+  }
+
+  std::vector<LocationSample> out;
+  out.reserve(maxPoints);
+  out.push_back(points.front());
+  const double bucketSize = static_cast<double>(count - 2) / static_cast<double>(maxPoints - 2);
+  size_t anchor = 0;
+  for (size_t bucket = 0; bucket < maxPoints - 2; ++bucket) {
+    const size_t begin = static_cast<size_t>(bucket * bucketSize) + 1;
+    const size_t end = std::min(static_cast<size_t>((bucket + 1) * bucketSize) + 1, count - 1);
+    // The last bucket looks ahead to the final fix
+    const size_t nextEnd =
+        std::max(std::min(static_cast<size_t>((bucket + 2) * bucketSize) + 1, count), end + 1);
+
+    double averageX = 0;
+    double averageY = 0;
+    for (size_t i = end; i < nextEnd; ++i) {
+      averageX += points[i].x;
+      averageY += points[i].y;
+    }
+    averageX /= static_cast<double>(nextEnd - end);
+    averageY /= static_cast<double>(nextEnd - end);
+
+    const LocationSample& a = points[anchor];
+    size_t best = begin;
+    double bestArea = -1;
+    for (size_t i = begin; i < end; ++i) {
+      const double area =
+          std::abs((points[i].x - a.x) * (averageY - a.y) - (averageX - a.x) * (points[i].y - a.y));
+      if (area > bestArea) {
+        bestArea = area;
+        best = i;
+      }
+    }
+    out.push_back(points[best]);
+    anchor = best;
+  }
+  out.push_back(points.back());
+  return out;
+}
+
+}  // namespace
+
+LocationHistory::LocationHistory(size_t capacityBytes) {
+  setCapacity(capacityBytes);
+}
+
+void LocationHistory::append(const LocationSample& sample) {
+  Block* current = used_ > 0 ? &block(used_ - 1) : nullptr;
+  if (!current || current->mapKey != sample.mapKey || current->providerType != sample.providerType) {
+    current = &startBlock(sample);
+  }
+
+  const int64_t x = quantize(sample.x);
+  const int64_t y = quantize(sample.y);
+  const int64_t accuracy = quantize(std::max(sample.accuracy, 0.0));
+  uint8_t encoded[kMaxFixBytes];
+  size_t length = putVarint(encoded, sample.timestampMs - current->lastMs);
+  length += putVarint(encoded + length, x - current->lastX);
+  length += putVarint(encoded + length, y - current->lastY);
+  length += putVarint(encoded + length, accuracy - current->lastAccuracy);
+
+  if (current->used + length > kBlockBytes) {
+    // Deltas restart from zero in a fresh block, so re-encode against it
+    current = &startBlock(sample);
+    length = putVarint(encoded, sample.timestampMs);
+    length += putVarint(encoded + length, x);
+    length += putVarint(encoded + length, y);
+    length += putVarint(encoded + length, accuracy);
+  }
+
+  std::copy(encoded, encoded + length, current->bytes.begin() + current->used);
+  current->used += static_cast<uint32_t>(length);
+  if (current->count == 0) {
+    current->minMs = current->maxMs = sample.timestampMs;
+    current->minX = current->maxX = sample.x;
+    current->minY = current->maxY = sample.y;
+  } else {
+    current->minMs = std::min(current->minMs, sample.timestampMs);
+    current->maxMs = std::max(current->maxMs, sample.timestampMs);
+    current->minX = std::min(current->minX, sample.x);
+    current->maxX = std::max(current->maxX, sample.x);
+    current->minY = std::min(current->minY, sample.y);
+    current->maxY = std::max(current->maxY, sample.y);
+  }
+  current->count++;
+  current->lastMs = sample.timestampMs;
+  current->lastX = x;
+  current->lastY = y;
+  current->lastAccuracy = accuracy;
+  size_++;
+}
+
+LocationHistory::Block& LocationHistory::startBlock(const LocationSample& sample) {
+  if (used_ == blocks_.size()) {
+    size_ -= block(0).count;
+    head_ = (head_ + 1) % blocks_.size();
+    used_--;
+  }
+  Block& fresh = block(used_++);
+  fresh.mapKey = sample.mapKey;
+  fresh.providerType = sample.providerType;
+  fresh.count = 0;
+  fresh.used = 0;
+  fresh.lastMs = 0;
+  fresh.lastX = 0;
+  fresh.lastY = 0;
+  fresh.lastAccuracy = 0;
+  return fresh;
+}
+
+LocationHistoryResult LocationHistory::query(const LocationHistoryQuery& query) const {
+  LocationHistoryResult result;
+  for (size_t age = 0; age < used_; ++age) {
+    const Block& candidate = block(age);
+    if (candidate.count == 0 || candidate.maxMs < query.sinceMs || candidate.minMs > query.untilMs) {
+      continue;
+    }
+    if (!query.mapKey.empty() && candidate.mapKey != query.mapKey) {
+      continue;
+    }
+    if (query.hasBounds && (candidate.maxX < query.minX || candidate.minX > query.maxX ||
+                            candidate.maxY < query.minY || candidate.minY > query.maxY)) {
+      continue;
+    }
+    decode(candidate, query, &result.points);
+  }
+  result.matched = result.points.size();
+  result.points = downsample(std::move(result.points), query.maxPoints);
+  return result;
+}
+
+void LocationHistory::decode(const Block& block,
+                             const LocationHistoryQuery& query,
+                             std::vector<LocationSample>* out) const {
+  // Skip the per-fix checks when the whole block matches
+  const bool whole = block.minMs >= query.sinceMs && block.maxMs <= query.untilMs &&
+                     (!query.hasBounds || (block.minX >= query.minX && block.maxX <= query.maxX &&
+                                           block.minY >= query.minY && block.maxY <= query.maxY));
+  int64_t timestampMs = 0;
+  int64_t x = 0;
+  int64_t y = 0;
+  int64_t accuracy = 0;
+  size_t offset = 0;
+  for (uint32_t i = 0; i < block.count; ++i) {
+    timestampMs += getVarint(block.bytes.data(), &offset);
+    x += getVarint(block.bytes.data(), &offset);
+    y += getVarint(block.bytes.data(), &offset);
+    accuracy += getVarint(block.bytes.data(), &offset);
+    LocationSample sample;
+    sample.x = dequantize(x);
+    sample.y = dequantize(y);
+    if (!whole && (timestampMs < query.sinceMs || timestampMs > query.untilMs || !inBounds(query, sample.x, sample.y))) {
+      continue;
+    }
+    sample.mapKey = block.mapKey;
+    sample.accuracy = dequantize(accuracy);
+    sample.timestampMs = timestampMs;
+    sample.providerType = block.providerType;
+    out->push_back(std::move(sample));
+  }
+}
+
+void LocationHistory::setCapacity(size_t capacityBytes) {
+  // Two blocks at least, so a new block never evicts the one being filled
+  const size_t count = std::max<size_t>(capacityBytes / kBlockBytes, 2);
+  if (count == blocks_.size()) {
+    return;
+  }
+  std::vector<Block> resized(count);
+  const size_t kept = std::min(used_, count);
+  size_t keptSize = 0;
+  for (size_t i = 0; i < kept; ++i) {
+    resized[i] = std::move(block(used_ - kept + i));
+    keptSize += resized[i].count;
+  }
+  blocks_ = std::move(resized);
+  head_ = 0;
+  used_ = kept;
+  size_ = keptSize;
+}
+
+void LocationHistory::clear() {
+  head_ = 0;
+  used_ = 0;
+  size_ = 0;
+}
+
+size_t LocationHistory::byteSize() const {
+  size_t bytes = 0;
+  for (size_t age = 0; age < used_; ++age) {
+    bytes += block(age).used;
+  }
+  return bytes;
+}
+
+}  // namespace meridianmaps
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "LocationSample.h"
+
+namespace meridianmaps {
+
+struct LocationHistoryQuery {
+  // Inclusive time range in ms since the epoch
+  int64_t sinceMs = std::numeric_limits<int64_t>::min();
+  int64_t untilMs = std::numeric_limits<int64_t>::max();
+  // Only fixes on this map; empty for every map
+  std::string mapKey;
+  // Only fixes inside this box, edges included
+  bool hasBounds = false;
+  double minX = 0;
+  double minY = 0;
+  double maxX = 0;
+  double maxY = 0;
+  // Downsample to at most this many points; 0 returns every match
+  size_t maxPoints = 0;
+};
+
+struct LocationHistoryResult {
+  // Oldest first
+  std::vector<LocationSample> points;
+  // Fixes that matched the query before downsampling
+  size_t matched = 0;
+};
+
+/**
+ * Recent location fixes in a fixed amount of memory.
+ *
+ * Fixes are packed into fixed-size blocks as zigzag varint deltas from the
+ * previous fix: timestamps in ms, x, y and accuracy in tenths of a map unit,
+ * about 6 bytes per 1 Hz walking fix. A block holds one map and provider, and
+ * keeps its time range and bounding box so queries skip it without decoding.
+ * When every block is full the oldest one is dropped. Not thread-safe.
+ */
+class LocationHistory {
+ public:
+  static constexpr size_t kBlockBytes = 256;
+  // Positions and accuracy are kept to 1 / kScale map units
+  static constexpr double kScale = 10;
+
+  explicit LocationHistory(size_t capacityBytes = 64 * 1024);
+
+  void append(const LocationSample& sample);
+
+  // Matching fixes, downsampled to maxPoints with largest-triangle-three-buckets
+  // so the shape of the track survives
+  LocationHistoryResult query(const LocationHistoryQuery& query) const;
+
+  // Resizes the buffer, keeping the newest blocks that still fit
+  void setCapacity(size_t capacityBytes);
+  size_t capacityBytes() const { return blocks_.size() * kBlockBytes; }
+
+  void clear();
+
+  // Fixes held
+  size_t size() const { return size_; }
+  // Payload bytes in use
+  size_t byteSize() const;
+
+ private:
+  struct Block {
+    std::string mapKey;
+    int providerType = 0;
+    int64_t minMs = 0;
+    int64_t maxMs = 0;
+    double minX = 0;
+    double minY = 0;
+    double maxX = 0;
+    double maxY = 0;
+    uint32_t count = 0;
+    uint32_t used = 0;
+    // Last fix, quantized, that the next delta is taken from
+    int64_t lastMs = 0;
+    int64_t lastX = 0;
+    int64_t lastY = 0;
+    int64_t lastAccuracy = 0;
+    std::array<uint8_t, kBlockBytes> bytes{};
+  };
+
+  Block& block(size_t age) { return blocks_[(head_ + age) % blocks_.size()]; }
+  const Block& block(size_t age) const { return blocks_[(head_ + age) % blocks_.size()]; }
+  Block& startBlock(const LocationSample& sample);
+  void decode(const Block& block, const LocationHistoryQuery& query, std::vector<LocationSample>* out) const;
+
+  std::vector<Block> blocks_;
+  // Oldest block in use and how many are in use
+  size_t head_ = 0;
+  size_t used_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace meridianmaps
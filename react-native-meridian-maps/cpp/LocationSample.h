@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace meridianmaps {
+
+// One position fix from the platform location manager, in map units.
+struct LocationSample {
+  std::string mapKey;
+  double x = 0;
+  double y = 0;
+  // Radius of uncertainty; 0 or less when the provider does not report one
+  double accuracy = 0;
+  int64_t timestampMs = 0;
+  // Platform provider that produced the fix (MRLocationProviderType on iOS); 0 when unknown
+  int providerType = 0;
+};
+
+}  // namespace meridianmaps
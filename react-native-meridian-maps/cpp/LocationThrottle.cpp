@@ -0,0 +1,122 @@
+#include "LocationThrottle.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace meridianmaps {
+
+namespace {
+
+// Process-wide counters behind LocationThrottle::totalStats()
+std::atomic<uint64_t> totalReceived{0};
+std::atomic<uint64_t> totalDelivered{0};
+std::atomic<uint64_t> totalDropped{0};
+std::atomic<uint64_t> totalCoalesced{0};
+
+}  // namespace
+
+LocationThrottleStats& LocationThrottleStats::operator+=(const LocationThrottleStats& other) {
+  received += other.received;
+  delivered += other.delivered;
+  dropped += other.dropped;
+  coalesced += other.coalesced;
+  return *this;
+}
+
+LocationThrottle::Decision LocationThrottle::offer(const LocationSample& sample, int64_t nowMs) {
+  ++stats_.received;
+  ++totalReceived;
+  const bool isMeaningful = meaningful(sample);
+
+  if (pending_) {
+    // Latest wins: the held fix is superseded whatever the new one is worth
+    pending_.reset();
+    ++stats_.coalesced;
+    ++totalCoalesced;
+    if (isMeaningful) {
+      // Keep the original due time so a steady stream still gets flushed
+      pending_ = sample;
+      return {Action::Hold, pendingDueMs_};
+    }
+  }
+  if (!isMeaningful) {
+    ++stats_.dropped;
+    ++totalDropped;
+    return {Action::Drop, 0};
+  }
+
+  const int64_t due = dueTime(nowMs);
+  if (due <= nowMs) {
+    deliver(sample, nowMs);
+    return {Action::Deliver, nowMs};
+  }
+  pending_ = sample;
+  pendingDueMs_ = due;
+  return {Action::Hold, due};
+}
+
+std::optional<LocationSample> LocationThrottle::flush(int64_t nowMs) {
+  if (!pending_ || nowMs < pendingDueMs_) {
+    return std::nullopt;
+  }
+  std::optional<LocationSample> sample = std::move(pending_);
+  pending_.reset();
+  deliver(*sample, nowMs);
+  return sample;
+}
+
+void LocationThrottle::reset() {
+  lastDelivered_.reset();
+  pending_.reset();
+  lastDeliveredMs_ = 0;
+  pendingDueMs_ = 0;
+}
+
+LocationThrottleStats LocationThrottle::totalStats() {
+  LocationThrottleStats stats;
+  stats.received = totalReceived.load();
+  stats.delivered = totalDelivered.load();
+  stats.dropped = totalDropped.load();
+  stats.coalesced = totalCoalesced.load();
+  return stats;
+}
+
+bool LocationThrottle::meaningful(const LocationSample& sample) const {
+  if (!lastDelivered_) {
+    return true;
+  }
+  const LocationSample& last = *lastDelivered_;
+  if (sample.mapKey != last.mapKey) {
+    return true;
+  }
+  if (std::hypot(sample.x - last.x, sample.y - last.y) > options_.minDisplacement) {
+    return true;
+  }
+  if (sample.accuracy <= 0) {
+    return false;
+  }
+  if (last.accuracy <= 0) {
+    return true;
+  }
+  const double improvement = last.accuracy - sample.accuracy;
+  return improvement > 0 && improvement >= options_.minAccuracyImprovement;
+}
+
+int64_t LocationThrottle::dueTime(int64_t nowMs) const {
+  int64_t due = nowMs + std::max<int64_t>(options_.coalesceWindowMs, 0);
+  if (lastDelivered_ && options_.maxRateHz > 0) {
+    const auto intervalMs = static_cast<int64_t>(std::llround(1000.0 / options_.maxRateHz));
+    due = std::max(due, lastDeliveredMs_ + intervalMs);
+  }
+  return due;
+}
+
+void LocationThrottle::deliver(const LocationSample& sample, int64_t nowMs) {
+  lastDelivered_ = sample;
+  lastDeliveredMs_ = nowMs;
+  ++stats_.delivered;
+  ++totalDelivered;
+}
+
+}  // namespace meridianmaps
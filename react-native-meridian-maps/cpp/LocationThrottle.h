@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "LocationSample.h"
+
+namespace meridianmaps {
+
+struct LocationThrottleOptions {
+  // Upper bound on delivered updates per second; 0 disables the limit
+  double maxRateHz = 0;
+  // Distance from the last delivered fix a new fix must exceed
+  double minDisplacement = 0;
+  // How much smaller the accuracy radius must get for a fix that has not moved
+  double minAccuracyImprovement = 0;
+  // A meaningful fix waits this long for newer ones and only the latest is delivered
+  int64_t coalesceWindowMs = 0;
+};
+
+struct LocationThrottleStats {
+  uint64_t received = 0;
+  uint64_t delivered = 0;
+  // Neither moved far enough nor got more accurate than the last delivered fix
+  uint64_t dropped = 0;
+  // Replaced by a newer fix while waiting for the rate limit or coalescing window
+  uint64_t coalesced = 0;
+
+  LocationThrottleStats& operator+=(const LocationThrottleStats& other);
+};
+
+/**
+ * Decides which location fixes are worth sending to JS.
+ *
+ * A fix is meaningful when it is the first one, is on another floor, moved
+ * more than minDisplacement or improved accuracy by at least
+ * minAccuracyImprovement; anything else is dropped. Meaningful fixes are held
+ * when the rate limit or the coalescing window says so, and a newer meaningful
+ * fix replaces the held one (latest wins). The caller owns the clock: offer()
+ * says when the held fix is due and flush() releases it at that time.
+ * Not thread-safe.
+ */
+class LocationThrottle {
+ public:
+  enum class Action {
+    // Send the offered fix now
+    Deliver,
+    // The fix is held; call flush() at dueMs
+    Hold,
+    // Not meaningful; nothing to send
+    Drop,
+  };
+
+  struct Decision {
+    Action action;
+    int64_t dueMs;
+  };
+
+  explicit LocationThrottle(const LocationThrottleOptions& options = {}) : options_(options) {}
+
+  void setOptions(const LocationThrottleOptions& options) { options_ = options; }
+  const LocationThrottleOptions& options() const { return options_; }
+
+  Decision offer(const LocationSample& sample, int64_t nowMs);
+
+  // The held fix if it is due at nowMs, recorded as delivered.
+  std::optional<LocationSample> flush(int64_t nowMs);
+
+  bool hasPending() const { return pending_.has_value(); }
+  int64_t pendingDueMs() const { return pendingDueMs_; }
+
+  // Forget the last delivered fix, e.g. when JS starts listening again
+  void reset();
+
+  const LocationThrottleStats& stats() const { return stats_; }
+  // Counters summed over every throttle of the process
+  static LocationThrottleStats totalStats();
+
+ private:
+  bool meaningful(const LocationSample& sample) const;
+  int64_t dueTime(int64_t nowMs) const;
+  void deliver(const LocationSample& sample, int64_t nowMs);
+
+  LocationThrottleOptions options_;
+  std::optional<LocationSample> lastDelivered_;
+  int64_t lastDeliveredMs_ = 0;
+  std::optional<LocationSample> pending_;
+  int64_t pendingDueMs_ = 0;
+  LocationThrottleStats stats_;
+};
+
+}  // namespace meridianmaps
@@ -0,0 +1,285 @@
+#include "LocationTrace.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "MappedFile.h"
+
+namespace meridianmaps {
+
+namespace {
+
+constexpr char kMagic[4] = {'M', 'M', 'L', 'T'};
+constexpr size_t kHeaderSize = 8;
+constexpr char kMapKeyRecord = 'K';
+constexpr char kFixRecord = 'F';
+
+void setError(std::string* error, const std::string& message) {
+  if (error) {
+    *error = message;
+  }
+}
+
+void putU16(std::string& out, uint16_t value) {
+  out.push_back(static_cast<char>(value & 0xff));
+  out.push_back(static_cast<char>(value >> 8));
+}
+
+void putU32(std::string& out, uint32_t value) {
+  for (int shift = 0; shift < 32; shift += 8) {
+    out.push_back(static_cast<char>((value >> shift) & 0xff));
+  }
+}
+
+void putFloat(std::string& out, double value) {
+  const float narrowed = static_cast<float>(value);
+  uint32_t bits;
+  std::memcpy(&bits, &narrowed, sizeof(bits));
+  putU32(out, bits);
+}
+
+void putVarint(std::string& out, int64_t value) {
+  uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+  while (zigzag >= 0x80) {
+    out.push_back(static_cast<char>((zigzag & 0x7f) | 0x80));
+    zigzag >>= 7;
+  }
+  out.push_back(static_cast<char>(zigzag));
+}
+
+std::string header() {
+  std::string out(kMagic, sizeof(kMagic));
+  putU32(out, LocationTrace::kVersion);
+  return out;
+}
+
+// Bounds-checked little-endian reads; any read past the end fails the record
+class Cursor {
+ public:
+  explicit Cursor(std::string_view bytes) : bytes_(bytes) {}
+
+  bool atEnd() const { return offset_ >= bytes_.size(); }
+  size_t offset() const { return offset_; }
+
+  bool u8(uint8_t* value) {
+    if (bytes_.size() - offset_ < 1) {
+      return false;
+    }
+    *value = static_cast<uint8_t>(bytes_[offset_++]);
+    return true;
+  }
+
+  bool u16(uint16_t* value) {
+    uint8_t low, high;
+    if (!u8(&low) || !u8(&high)) {
+      return false;
+    }
+    *value = static_cast<uint16_t>(low | (high << 8));
+    return true;
+  }
+
+  bool u32(uint32_t* value) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+      uint8_t byte;
+      if (!u8(&byte)) {
+        return false;
+      }
+      result |= static_cast<uint32_t>(byte) << shift;
+    }
+    *value = result;
+    return true;
+  }
+
+  bool f32(double* value) {
+    uint32_t bits;
+    if (!u32(&bits)) {
+      return false;
+    }
+    float narrowed;
+    std::memcpy(&narrowed, &bits, sizeof(narrowed));
+    *value = narrowed;
+    return true;
+  }
+
+  bool varint(int64_t* value) {
+    uint64_t zigzag = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t byte;
+      if (!u8(&byte)) {
+        return false;
+      }
+      zigzag |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        *value = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool bytes(size_t length, std::string_view* value) {
+    if (bytes_.size() - offset_ < length) {
+      return false;
+    }
+    *value = bytes_.substr(offset_, length);
+    offset_ += length;
+    return true;
+  }
+
+ private:
+  std::string_view bytes_;
+  size_t offset_ = 0;
+};
+
+// Shared by LocationTrace::encode and LocationTraceWriter so both produce the same bytes
+std::string encodeRecords(const LocationSample& sample, std::unordered_map<std::string, uint16_t>& mapKeyIds,
+                          int64_t& lastTimestampMs) {
+  std::string out;
+  auto found = mapKeyIds.find(sample.mapKey);
+  if (found == mapKeyIds.end()) {
+    const auto id = static_cast<uint16_t>(mapKeyIds.size());
+    found = mapKeyIds.emplace(sample.mapKey, id).first;
+    out.push_back(kMapKeyRecord);
+    putU16(out, id);
+    putU16(out, static_cast<uint16_t>(sample.mapKey.size()));
+    out.append(sample.mapKey);
+  }
+  out.push_back(kFixRecord);
+  putU16(out, found->second);
+  out.push_back(static_cast<char>(sample.providerType & 0xff));
+  putVarint(out, sample.timestampMs - lastTimestampMs);
+  putFloat(out, sample.x);
+  putFloat(out, sample.y);
+  putFloat(out, sample.accuracy);
+  lastTimestampMs = sample.timestampMs;
+  return out;
+}
+
+}  // namespace
+
+bool LocationTrace::decode(std::string_view bytes, std::vector<LocationSample>* samples, std::string* error) {
+  if (bytes.size() < kHeaderSize || std::memcmp(bytes.data(), kMagic, sizeof(kMagic)) != 0) {
+    setError(error, "not a location trace");
+    return false;
+  }
+  Cursor cursor(bytes.substr(sizeof(kMagic)));
+  uint32_t version = 0;
+  cursor.u32(&version);
+  if (version != kVersion) {
+    setError(error, "unsupported location trace version " + std::to_string(version));
+    return false;
+  }
+
+  std::vector<std::string> mapKeys;
+  int64_t timestampMs = 0;
+  while (!cursor.atEnd()) {
+    uint8_t tag;
+    cursor.u8(&tag);
+    if (tag == kMapKeyRecord) {
+      uint16_t id, length;
+      std::string_view name;
+      if (!cursor.u16(&id) || !cursor.u16(&length) || !cursor.bytes(length, &name)) {
+        break;
+      }
+      if (id >= mapKeys.size()) {
+        mapKeys.resize(id + 1u);
+      }
+      mapKeys[id] = std::string(name);
+    } else if (tag == kFixRecord) {
+      uint16_t id;
+      uint8_t provider;
+      int64_t delta;
+      LocationSample sample;
+      if (!cursor.u16(&id) || !cursor.u8(&provider) || !cursor.varint(&delta) || !cursor.f32(&sample.x) ||
+          !cursor.f32(&sample.y) || !cursor.f32(&sample.accuracy)) {
+        break;
+      }
+      if (id >= mapKeys.size()) {
+        setError(error, "location trace names an unknown map key");
+        return false;
+      }
+      timestampMs += delta;
+      sample.mapKey = mapKeys[id];
+      sample.providerType = provider;
+      sample.timestampMs = timestampMs;
+      samples->push_back(std::move(sample));
+    } else {
+      setError(error, "location trace is corrupt");
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LocationTrace::read(const std::string& path, std::vector<LocationSample>* samples, std::string* error) {
+  std::unique_ptr<MappedFile> file = MappedFile::open(path, error);
+  if (!file) {
+    return false;
+  }
+  return decode(std::string_view(file->data(), file->size()), samples, error);
+}
+
+std::string LocationTrace::encode(const std::vector<LocationSample>& samples) {
+  std::string out = header();
+  std::unordered_map<std::string, uint16_t> mapKeyIds;
+  int64_t lastTimestampMs = 0;
+  for (const LocationSample& sample : samples) {
+    out.append(encodeRecords(sample, mapKeyIds, lastTimestampMs));
+  }
+  return out;
+}
+
+std::unique_ptr<LocationTraceWriter> LocationTraceWriter::open(const std::string& path, std::string* error) {
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file) {
+    setError(error, "cannot open " + path + " for writing");
+    return nullptr;
+  }
+  std::unique_ptr<LocationTraceWriter> writer(new LocationTraceWriter(file));
+  writer->write(header());
+  return writer;
+}
+
+LocationTraceWriter::~LocationTraceWriter() {
+  std::fclose(file_);
+}
+
+void LocationTraceWriter::append(const LocationSample& sample) {
+  write(encodeRecords(sample, mapKeyIds_, lastTimestampMs_));
+  ++count_;
+}
+
+void LocationTraceWriter::flush() {
+  std::fflush(file_);
+}
+
+void LocationTraceWriter::write(const std::string& bytes) {
+  bytes_ += std::fwrite(bytes.data(), 1, bytes.size(), file_);
+}
+
+LocationReplay::LocationReplay(std::vector<LocationSample> samples, double speed)
+    : samples_(std::move(samples)), speed_(speed) {}
+
+void LocationReplay::start(int64_t nowMs) {
+  startMs_ = nowMs;
+  next_ = 0;
+}
+
+int64_t LocationReplay::nextDueMs() const {
+  if (done() || speed_ <= 0) {
+    return startMs_;
+  }
+  const double offset = static_cast<double>(samples_[next_].timestampMs - samples_.front().timestampMs) / speed_;
+  return startMs_ + static_cast<int64_t>(std::llround(offset));
+}
+
+std::vector<LocationSample> LocationReplay::take(int64_t nowMs, size_t maxCount) {
+  std::vector<LocationSample> due;
+  while (!done() && due.size() < maxCount && nextDueMs() <= nowMs) {
+    due.push_back(samples_[next_++]);
+  }
+  return due;
+}
+
+}  // namespace meridianmaps
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "LocationSample.h"
+
+namespace meridianmaps {
+
+/**
+ * Compact binary log of location fixes, for replaying venue walks.
+ *
+ * Layout: an 8-byte header (magic "MMLT", little-endian format version) and
+ * then records. A 'K' record names a mapKey once (u16 id, u16 length, bytes);
+ * an 'F' record is one fix: u16 mapKey id, u8 provider, zigzag varint of the
+ * timestamp delta in ms and x, y, accuracy as little-endian float32, 18 bytes
+ * for 1 Hz fixes. Records are appended as fixes arrive, so a log cut short by a crash
+ * still decodes up to its last complete record.
+ */
+class LocationTrace {
+ public:
+  static constexpr uint32_t kVersion = 1;
+
+  // Decodes a whole log. Returns false and fills error when the header is
+  // missing or from another version; a truncated tail is not an error.
+  static bool decode(std::string_view bytes, std::vector<LocationSample>* samples, std::string* error = nullptr);
+
+  static bool read(const std::string& path, std::vector<LocationSample>* samples, std::string* error = nullptr);
+
+  static std::string encode(const std::vector<LocationSample>& samples);
+};
+
+// Appends fixes to a trace file as they arrive. Not thread-safe.
+class LocationTraceWriter {
+ public:
+  // Creates or truncates path. Returns null and fills error if it cannot be opened.
+  static std::unique_ptr<LocationTraceWriter> open(const std::string& path, std::string* error = nullptr);
+
+  ~LocationTraceWriter();
+  LocationTraceWriter(const LocationTraceWriter&) = delete;
+  LocationTraceWriter& operator=(const LocationTraceWriter&) = delete;
+
+  void append(const LocationSample& sample);
+  // Pushes buffered records to the file
+  void flush();
+
+  size_t count() const { return count_; }
+  size_t byteSize() const { return bytes_; }
+
+ private:
+  explicit LocationTraceWriter(std::FILE* file) : file_(file) {}
+
+  void write(const std::string& bytes);
+
+  std::FILE* file_;
+  std::unordered_map<std::string, uint16_t> mapKeyIds_;
+  int64_t lastTimestampMs_ = 0;
+  size_t count_ = 0;
+  size_t bytes_ = 0;
+};
+
+/**
+ * Paces a recorded trace for replay. Fixes come due at their recorded spacing
+ * divided by speed, counted from start(); a speed of 0 or less makes every fix
+ * due at once. Fixes keep their recorded timestamps, so filters downstream see
+ * the same motion at any speed. The caller owns the clock. Not thread-safe.
+ */
+class LocationReplay {
+ public:
+  LocationReplay(std::vector<LocationSample> samples, double speed);
+
+  void start(int64_t nowMs);
+
+  // Due fixes in order, at most maxCount of them
+  std::vector<LocationSample> take(int64_t nowMs, size_t maxCount = SIZE_MAX);
+
+  bool done() const { return next_ >= samples_.size(); }
+  // When the next fix comes due; only meaningful while !done()
+  int64_t nextDueMs() const;
+
+  size_t size() const { return samples_.size(); }
+  size_t position() const { return next_; }
+  double speed() const { return speed_; }
+
+ private:
+  std::vector<LocationSample> samples_;
+  double speed_;
+  int64_t startMs_ = 0;
+  size_t next_ = 0;
+};
+
+}  // namespace meridianmaps
@@ -0,0 +1,61 @@
+#include "MapPool.h"
+
+namespace meridianmaps {
+
+void MapPool::setCapacity(size_t capacity, std::vector<uint64_t>* evicted) {
+  capacity_ = capacity;
+  evictTo(capacity_, &stats_.evictions, evicted);
+}
+
+void MapPool::park(const std::string& key, uint64_t id, std::vector<uint64_t>* evicted) {
+  if (id == 0) {
+    return;
+  }
+  remove(id);
+  entries_.push_front({key, id});
+  byId_[id] = entries_.begin();
+  stats_.parked++;
+  evictTo(capacity_, &stats_.evictions, evicted);
+}
+
+uint64_t MapPool::take(const std::string& key) {
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    if (it->key == key) {
+      const uint64_t id = it->id;
+      byId_.erase(id);
+      entries_.erase(it);
+      stats_.hits++;
+      return id;
+    }
+  }
+  stats_.misses++;
+  return 0;
+}
+
+void MapPool::trim(size_t keep, std::vector<uint64_t>* evicted) {
+  evictTo(keep, &stats_.trims, evicted);
+}
+
+bool MapPool::remove(uint64_t id) {
+  auto found = byId_.find(id);
+  if (found == byId_.end()) {
+    return false;
+  }
+  entries_.erase(found->second);
+  byId_.erase(found);
+  return true;
+}
+
+void MapPool::evictTo(size_t size, uint64_t* counter, std::vector<uint64_t>* evicted) {
+  while (entries_.size() > size) {
+    const uint64_t id = entries_.back().id;
+    byId_.erase(id);
+    entries_.pop_back();
+    (*counter)++;
+    if (evicted) {
+      evicted->push_back(id);
+    }
+  }
+}
+
+}  // namespace meridianmaps
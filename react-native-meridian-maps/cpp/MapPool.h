@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace meridianmaps {
+
+struct MapPoolStats {
+  // Views parked on unmount, taken back by a view that mounted, and mounts that found nothing parked
+  uint64_t parked = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  // Entries dropped to stay within capacity, and by trim() on memory pressure
+  uint64_t evictions = 0;
+  uint64_t trims = 0;
+};
+
+/**
+ * Least-recently-parked index over detached native maps.
+ *
+ * The platforms own the map controllers; the pool tracks them by a nonzero
+ * id under the "appId|mapId" key they were loaded for. An unmounting view
+ * parks its controller and a view mounting with the same key takes the most
+ * recently parked one back. Whenever the pool grows past its capacity the
+ * oldest entries are evicted, and the caller destroys what park(), trim()
+ * and setCapacity() report. Capacity is a handful of maps, so lookups scan.
+ * Not thread-safe.
+ */
+class MapPool {
+ public:
+  explicit MapPool(size_t capacity = 2) : capacity_(capacity) {}
+
+  // Shrinking evicts the oldest entries into *evicted
+  void setCapacity(size_t capacity, std::vector<uint64_t>* evicted);
+  size_t capacity() const { return capacity_; }
+  size_t size() const { return entries_.size(); }
+
+  // Parks id under key; entries over capacity, possibly id itself, are
+  // appended to *evicted oldest first
+  void park(const std::string& key, uint64_t id, std::vector<uint64_t>* evicted);
+  // Removes and returns the most recently parked entry for key; 0 on a miss
+  uint64_t take(const std::string& key);
+  // Evicts all but the keep most recent entries, counted as trims
+  void trim(size_t keep, std::vector<uint64_t>* evicted);
+  // Forgets id without counting it, for a controller destroyed elsewhere
+  bool remove(uint64_t id);
+
+  const MapPoolStats& stats() const { return stats_; }
+
+ private:
+  struct Entry {
+    std::string key;
+    uint64_t id;
+  };
+
+  void evictTo(size_t size, uint64_t* counter, std::vector<uint64_t>* evicted);
+
+  size_t capacity_;
+  // Most recently parked first
+  std::list<Entry> entries_;
+  std::unordered_map<uint64_t, std::list<Entry>::iterator> byId_;
+  MapPoolStats stats_;
+};
+
+}  // namespace meridianmaps
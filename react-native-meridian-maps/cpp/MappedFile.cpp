@@ -0,0 +1,80 @@
+#include "MappedFile.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace meridianmaps {
+
+namespace {
+
+void setError(std::string* error, const std::string& message) {
+  if (error) {
+    *error = message;
+  }
+}
+
+}  // namespace
+
+std::unique_ptr<MappedFile> MappedFile::open(const std::string& path, std::string* error) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    setError(error, "open " + path + ": " + std::strerror(errno));
+    return nullptr;
+  }
+
+  struct stat info;
+  if (::fstat(fd, &info) != 0) {
+    setError(error, "stat " + path + ": " + std::strerror(errno));
+    ::close(fd);
+    return nullptr;
+  }
+  if (info.st_size <= 0) {
+    setError(error, path + " is empty");
+    ::close(fd);
+    return nullptr;
+  }
+
+  const size_t size = static_cast<size_t>(info.st_size);
+  void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps its own reference to the file
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    setError(error, "mmap " + path + ": " + std::strerror(errno));
+    return nullptr;
+  }
+  return std::unique_ptr<MappedFile>(new MappedFile(static_cast<const char*>(data), size));
+}
+
+MappedFile::~MappedFile() {
+  ::munmap(const_cast<char*>(data_), size_);
+}
+
+bool writeFileAtomically(const std::string& path, std::string_view bytes, std::string* error) {
+  const std::string temporary = path + ".tmp";
+
+  FILE* file = std::fopen(temporary.c_str(), "wb");
+  if (!file) {
+    setError(error, "open " + temporary + ": " + std::strerror(errno));
+    return false;
+  }
+  const bool written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+  const bool closed = std::fclose(file) == 0;
+  if (!written || !closed) {
+    setError(error, "write " + temporary + " failed");
+    std::remove(temporary.c_str());
+    return false;
+  }
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    setError(error, "rename " + temporary + ": " + std::strerror(errno));
+    std::remove(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace meridianmaps
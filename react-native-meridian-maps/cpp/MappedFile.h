@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace meridianmaps {
+
+// Read-only memory mapping of a whole file. Pages are faulted in lazily by
+// the OS, so opening a large file costs no more than opening a small one.
+class MappedFile {
+ public:
+  static std::unique_ptr<MappedFile> open(const std::string& path, std::string* error = nullptr);
+
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  MappedFile(const char* data, size_t size) : data_(data), size_(size) {}
+
+  const char* data_;
+  size_t size_;
+};
+
+// Writes bytes to a temporary file next to path, then renames it over path,
+// so a reader never maps a half-written file.
+bool writeFileAtomically(const std::string& path, std::string_view bytes, std::string* error = nullptr);
+
+}  // namespace meridianmaps
@@ -0,0 +1,106 @@
+#include "MarkerAtlas.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+namespace meridianmaps {
+
+std::string MarkerAtlas::key(std::string_view icon, uint32_t sizePx, std::optional<uint32_t> argb, bool selected) {
+  char color[12] = "-";
+  if (argb) {
+    std::snprintf(color, sizeof(color), "%08" PRIx32, *argb);
+  }
+  char suffix[40];
+  std::snprintf(suffix, sizeof(suffix), "|%" PRIu32 "|%s|%d", sizePx, color, selected ? 1 : 0);
+  std::string key(icon);
+  key += suffix;
+  return key;
+}
+
+uint64_t MarkerAtlas::acquire(const std::string& key, uint64_t bytes, bool* created) {
+  auto found = byKey_.find(key);
+  if (found != byKey_.end()) {
+    Entry& entry = entries_.at(found->second);
+    if (entry.references++ == 0) {
+      unused_.erase(entry.unused);
+      entry.unused = unused_.end();
+      unusedBytes_ -= entry.bytes;
+    }
+    stats_.hits++;
+    if (created) {
+      *created = false;
+    }
+    return found->second;
+  }
+  const uint64_t id = nextId_++;
+  entries_.emplace(id, Entry{key, bytes, 1, unused_.end()});
+  byKey_.emplace(key, id);
+  bytes_ += bytes;
+  stats_.draws++;
+  if (created) {
+    *created = true;
+  }
+  return id;
+}
+
+bool MarkerAtlas::release(uint64_t id, std::vector<uint64_t>* evicted) {
+  auto found = entries_.find(id);
+  if (found == entries_.end() || found->second.references == 0) {
+    return false;
+  }
+  Entry& entry = found->second;
+  stats_.releases++;
+  if (--entry.references == 0) {
+    unused_.push_front(id);
+    entry.unused = unused_.begin();
+    unusedBytes_ += entry.bytes;
+    evictTo(maxUnusedBytes_, &stats_.evictions, evicted);
+  }
+  return true;
+}
+
+bool MarkerAtlas::remove(uint64_t id) {
+  auto found = entries_.find(id);
+  if (found == entries_.end()) {
+    return false;
+  }
+  erase(found);
+  return true;
+}
+
+void MarkerAtlas::setMaxUnusedBytes(uint64_t maxUnusedBytes, std::vector<uint64_t>* evicted) {
+  maxUnusedBytes_ = maxUnusedBytes;
+  evictTo(maxUnusedBytes_, &stats_.evictions, evicted);
+}
+
+void MarkerAtlas::trim(std::vector<uint64_t>* evicted) {
+  evictTo(0, &stats_.trims, evicted);
+}
+
+uint32_t MarkerAtlas::references(uint64_t id) const {
+  auto found = entries_.find(id);
+  return found != entries_.end() ? found->second.references : 0;
+}
+
+void MarkerAtlas::evictTo(uint64_t unusedBytes, uint64_t* counter, std::vector<uint64_t>* evicted) {
+  while (unusedBytes_ > unusedBytes && !unused_.empty()) {
+    const uint64_t id = unused_.back();
+    erase(entries_.find(id));
+    (*counter)++;
+    if (evicted) {
+      evicted->push_back(id);
+    }
+  }
+}
+
+void MarkerAtlas::erase(std::unordered_map<uint64_t, Entry>::iterator entry) {
+  if (entry->second.references == 0) {
+    unused_.erase(entry->second.unused);
+    unusedBytes_ -= entry->second.bytes;
+  }
+  bytes_ -= entry->second.bytes;
+  byKey_.erase(entry->second.key);
+  entries_.erase(entry);
+}
+
+}  // namespace meridianmaps
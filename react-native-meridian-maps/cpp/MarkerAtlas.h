@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace meridianmaps {
+
+struct MarkerAtlasStats {
+  // Acquires answered by a bitmap already drawn, and those that had to draw one
+  uint64_t hits = 0;
+  uint64_t draws = 0;
+  uint64_t releases = 0;
+  // Unused bitmaps dropped to stay within the budget, and by trim() on memory pressure
+  uint64_t evictions = 0;
+  uint64_t trims = 0;
+};
+
+/**
+ * Reference-counted index over shared marker bitmaps.
+ *
+ * The platforms own the bitmaps; the atlas tracks them by a nonzero id under
+ * a key naming everything that changes the pixels (see key()), so every
+ * marker drawn the same way shares one bitmap. acquire() counts a reference
+ * and tells the caller when it has to draw a new bitmap; release() drops it.
+ * A bitmap nobody references is kept, so the next floor with the same icons
+ * does not draw them again, until the unused bitmaps outgrow maxUnusedBytes;
+ * the least recently released go first, and the caller frees what release(),
+ * trim() and setMaxUnusedBytes() report. Not thread-safe.
+ */
+class MarkerAtlas {
+ public:
+  static constexpr uint64_t kDefaultMaxUnusedBytes = 4u << 20;
+
+  explicit MarkerAtlas(uint64_t maxUnusedBytes = kDefaultMaxUnusedBytes) : maxUnusedBytes_(maxUnusedBytes) {}
+
+  // "<icon>|<size>|<color>|<selected>", with the color as eight hex digits, or
+  // "-" for none so an untinted icon never shares a key with a transparent one
+  static std::string key(std::string_view icon, uint32_t sizePx, std::optional<uint32_t> argb, bool selected);
+
+  // The id of key's bitmap, counting a reference. *created is set when the id
+  // is new and the caller has to draw a bitmap of the given bytes for it.
+  uint64_t acquire(const std::string& key, uint64_t bytes, bool* created);
+  // Drops a reference; evictions this causes are appended to *evicted
+  bool release(uint64_t id, std::vector<uint64_t>* evicted);
+  // Forgets id whatever its references, for a bitmap the caller failed to draw
+  bool remove(uint64_t id);
+
+  // Shrinking evicts the least recently released unused bitmaps into *evicted
+  void setMaxUnusedBytes(uint64_t maxUnusedBytes, std::vector<uint64_t>* evicted);
+  uint64_t maxUnusedBytes() const { return maxUnusedBytes_; }
+  // Evicts every unused bitmap, counted as trims
+  void trim(std::vector<uint64_t>* evicted);
+
+  size_t size() const { return entries_.size(); }
+  // Bytes of every bitmap, and of those nobody references
+  uint64_t bytes() const { return bytes_; }
+  uint64_t unusedBytes() const { return unusedBytes_; }
+  uint32_t references(uint64_t id) const;
+
+  const MarkerAtlasStats& stats() const { return stats_; }
+
+ private:
+  struct Entry {
+    std::string key;
+    uint64_t bytes;
+    uint32_t references;
+    std::list<uint64_t>::iterator unused;
+  };
+
+  void evictTo(uint64_t unusedBytes, uint64_t* counter, std::vector<uint64_t>* evicted);
+  void erase(std::unordered_map<uint64_t, Entry>::iterator entry);
+
+  uint64_t maxUnusedBytes_;
+  uint64_t nextId_ = 1;
+  uint64_t bytes_ = 0;
+  uint64_t unusedBytes_ = 0;
+  std::unordered_map<uint64_t, Entry> entries_;
+  std::unordered_map<std::string, uint64_t> byKey_;
+  // Ids without references, most recently released first
+  std::list<uint64_t> unused_;
+  MarkerAtlasStats stats_;
+};
+
+}  // namespace meridianmaps
@@ -0,0 +1,289 @@
+#include "PlacemarkSnapshot.h"
+
+#include <cstring>
+#include <vector>
+
+namespace meridianmaps {
+
+namespace {
+
+constexpr char kMagic[4] = {'M', 'M', 'P', 'S'};
+constexpr uint32_t kEndianTag = 0x01020304;
+
+enum Section : uint32_t {
+  kX,
+  kY,
+  kFloor,
+  kType,
+  kBounds,
+  kIdRefs,
+  kIdData,
+  kNameRefs,
+  kNameData,
+  kDetailRefs,
+  kDetailData,
+  kFloorRefs,
+  kFloorData,
+  kTypeRefs,
+  kTypeData,
+  kSlots,
+  kSectionCount,
+};
+
+struct SectionEntry {
+  uint64_t offset;
+  uint64_t length;
+};
+
+struct Header {
+  char magic[4];
+  uint32_t version;
+  uint32_t endianTag;
+  uint32_t count;
+  uint32_t floorCount;
+  uint32_t typeCount;
+  uint32_t slotCount;
+  uint32_t reserved;
+  SectionEntry sections[kSectionCount];
+};
+
+static_assert(sizeof(Header) == 288, "snapshot header layout changed");
+
+void setError(std::string* error, const std::string& message) {
+  if (error) {
+    *error = message;
+  }
+}
+
+uint32_t slotCountFor(uint32_t count) {
+  uint32_t slots = 16;
+  while (slots < count * 2u) {
+    slots <<= 1;
+  }
+  return slots;
+}
+
+class Writer {
+ public:
+  explicit Writer(Header& header) : header_(header) { buffer_.resize(sizeof(Header)); }
+
+  void section(Section section, const void* data, size_t length) {
+    buffer_.resize((buffer_.size() + 7) & ~size_t(7), '\0');
+    header_.sections[section] = {buffer_.size(), length};
+    buffer_.append(static_cast<const char*>(data), length);
+  }
+
+  std::string finish() {
+    std::memcpy(&buffer_[0], &header_, sizeof(Header));
+    return std::move(buffer_);
+  }
+
+ private:
+  Header& header_;
+  std::string buffer_;
+};
+
+// Copies a string column, dropping bytes no longer referenced by any row.
+void compactStrings(uint32_t count, std::string_view (PlacemarkTable::*get)(uint32_t) const, const PlacemarkTable& table,
+                    std::vector<StringRef>& refs, std::string& data) {
+  refs.resize(count);
+  for (uint32_t row = 0; row < count; ++row) {
+    std::string_view value = (table.*get)(row);
+    refs[row] = {static_cast<uint32_t>(data.size()), static_cast<uint32_t>(value.size())};
+    data.append(value);
+  }
+}
+
+void copyPool(uint32_t count, std::string_view (PlacemarkTable::*get)(uint16_t) const, const PlacemarkTable& table,
+              std::vector<StringRef>& refs, std::string& data) {
+  refs.resize(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    std::string_view value = (table.*get)(static_cast<uint16_t>(i));
+    refs[i] = {static_cast<uint32_t>(data.size()), static_cast<uint32_t>(value.size())};
+    data.append(value);
+  }
+}
+
+bool refsFit(const StringRef* refs, uint32_t count, uint64_t dataLength) {
+  for (uint32_t i = 0; i < count; ++i) {
+    if (uint64_t(refs[i].offset) + refs[i].length > dataLength) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+std::string PlacemarkSnapshot::serialize(const PlacemarkTable& table) {
+  const uint32_t count = table.size();
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.endianTag = kEndianTag;
+  header.count = count;
+  header.floorCount = table.floorCount();
+  header.typeCount = table.typeCount();
+  header.slotCount = slotCountFor(count);
+
+  std::vector<StringRef> idRefs, nameRefs, detailRefs, floorRefs, typeRefs;
+  std::string idData, nameData, detailData, floorData, typeData;
+  compactStrings(count, &PlacemarkTable::id, table, idRefs, idData);
+  compactStrings(count, &PlacemarkTable::name, table, nameRefs, nameData);
+  compactStrings(count, &PlacemarkTable::details, table, detailRefs, detailData);
+  copyPool(table.floorCount(), &PlacemarkTable::floorKey, table, floorRefs, floorData);
+  copyPool(table.typeCount(), &PlacemarkTable::typeName, table, typeRefs, typeData);
+
+  std::vector<uint32_t> slots(header.slotCount, PlacemarkTable::npos);
+  const uint32_t mask = header.slotCount - 1;
+  for (uint32_t row = 0; row < count; ++row) {
+    uint32_t slot = static_cast<uint32_t>(hashString(table.id(row))) & mask;
+    while (slots[slot] != PlacemarkTable::npos) {
+      slot = (slot + 1) & mask;
+    }
+    slots[slot] = row;
+  }
+
+  Writer writer(header);
+  writer.section(kX, table.xs(), count * sizeof(float));
+  writer.section(kY, table.ys(), count * sizeof(float));
+  writer.section(kFloor, table.floors(), count * sizeof(uint16_t));
+  writer.section(kType, table.types(), count * sizeof(uint16_t));
+  writer.section(kBounds, table.boundsData(), count * sizeof(Rect));
+  writer.section(kIdRefs, idRefs.data(), idRefs.size() * sizeof(StringRef));
+  writer.section(kIdData, idData.data(), idData.size());
+  writer.section(kNameRefs, nameRefs.data(), nameRefs.size() * sizeof(StringRef));
+  writer.section(kNameData, nameData.data(), nameData.size());
+  writer.section(kDetailRefs, detailRefs.data(), detailRefs.size() * sizeof(StringRef));
+  writer.section(kDetailData, detailData.data(), detailData.size());
+  writer.section(kFloorRefs, floorRefs.data(), floorRefs.size() * sizeof(StringRef));
+  writer.section(kFloorData, floorData.data(), floorData.size());
+  writer.section(kTypeRefs, typeRefs.data(), typeRefs.size() * sizeof(StringRef));
+  writer.section(kTypeData, typeData.data(), typeData.size());
+  writer.section(kSlots, slots.data(), slots.size() * sizeof(uint32_t));
+  return writer.finish();
+}
+
+bool PlacemarkSnapshot::write(const PlacemarkTable& table, const std::string& path, std::string* error) {
+  return writeFileAtomically(path, serialize(table), error);
+}
+
+std::unique_ptr<PlacemarkSnapshot> PlacemarkSnapshot::open(const std::string& path, std::string* error) {
+  std::unique_ptr<MappedFile> file = MappedFile::open(path, error);
+  if (!file) {
+    return nullptr;
+  }
+  std::unique_ptr<PlacemarkSnapshot> snapshot(new PlacemarkSnapshot(std::move(file)));
+  if (!snapshot->bind(error)) {
+    return nullptr;
+  }
+  return snapshot;
+}
+
+bool PlacemarkSnapshot::bind(std::string* error) {
+  const char* base = file_->data();
+  const uint64_t fileSize = file_->size();
+  if (fileSize < sizeof(Header)) {
+    setError(error, "snapshot is truncated");
+    return false;
+  }
+
+  Header header;
+  std::memcpy(&header, base, sizeof(Header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    setError(error, "not a placemark snapshot");
+    return false;
+  }
+  if (header.endianTag != kEndianTag) {
+    setError(error, "snapshot was written with a different byte order");
+    return false;
+  }
+  if (header.version != kVersion) {
+    setError(error, "unsupported snapshot version " + std::to_string(header.version));
+    return false;
+  }
+
+  const uint32_t count = header.count;
+  // A free slot must always exist, otherwise a miss would probe forever
+  if (header.slotCount <= count || (header.slotCount & (header.slotCount - 1)) != 0 || header.floorCount > UINT16_MAX ||
+      header.typeCount > UINT16_MAX) {
+    setError(error, "snapshot header is corrupt");
+    return false;
+  }
+
+  const uint64_t expected[kSectionCount] = {
+      count * uint64_t(sizeof(float)),
+      count * uint64_t(sizeof(float)),
+      count * uint64_t(sizeof(uint16_t)),
+      count * uint64_t(sizeof(uint16_t)),
+      count * uint64_t(sizeof(Rect)),
+      count * uint64_t(sizeof(StringRef)),
+      UINT64_MAX,
+      count * uint64_t(sizeof(StringRef)),
+      UINT64_MAX,
+      count * uint64_t(sizeof(StringRef)),
+      UINT64_MAX,
+      header.floorCount * uint64_t(sizeof(StringRef)),
+      UINT64_MAX,
+      header.typeCount * uint64_t(sizeof(StringRef)),
+      UINT64_MAX,
+      header.slotCount * uint64_t(sizeof(uint32_t)),
+  };
+  for (uint32_t section = 0; section < kSectionCount; ++section) {
+    const SectionEntry& entry = header.sections[section];
+    if ((entry.offset & 7) != 0 || entry.offset > fileSize || entry.length > fileSize - entry.offset ||
+        (expected[section] != UINT64_MAX && entry.length != expected[section])) {
+      setError(error, "snapshot section " + std::to_string(section) + " is corrupt");
+      return false;
+    }
+  }
+
+  auto at = [&](Section section) { return base + header.sections[section].offset; };
+  PlacemarkTable& table = table_;
+  table.size_ = count;
+  table.x_ = reinterpret_cast<const float*>(at(kX));
+  table.y_ = reinterpret_cast<const float*>(at(kY));
+  table.floor_ = reinterpret_cast<const uint16_t*>(at(kFloor));
+  table.type_ = reinterpret_cast<const uint16_t*>(at(kType));
+  table.bounds_ = reinterpret_cast<const Rect*>(at(kBounds));
+  table.idRefs_ = reinterpret_cast<const StringRef*>(at(kIdRefs));
+  table.idData_ = at(kIdData);
+  table.nameRefs_ = reinterpret_cast<const StringRef*>(at(kNameRefs));
+  table.nameData_ = at(kNameData);
+  table.detailRefs_ = reinterpret_cast<const StringRef*>(at(kDetailRefs));
+  table.detailData_ = at(kDetailData);
+  table.floorCount_ = header.floorCount;
+  table.floorRefs_ = reinterpret_cast<const StringRef*>(at(kFloorRefs));
+  table.floorData_ = at(kFloorData);
+  table.typeCount_ = header.typeCount;
+  table.typeRefs_ = reinterpret_cast<const StringRef*>(at(kTypeRefs));
+  table.typeData_ = at(kTypeData);
+  table.slots_ = reinterpret_cast<const uint32_t*>(at(kSlots));
+  table.slotCount_ = header.slotCount;
+
+  if (!refsFit(table.idRefs_, count, header.sections[kIdData].length) ||
+      !refsFit(table.nameRefs_, count, header.sections[kNameData].length) ||
+      !refsFit(table.detailRefs_, count, header.sections[kDetailData].length) ||
+      !refsFit(table.floorRefs_, header.floorCount, header.sections[kFloorData].length) ||
+      !refsFit(table.typeRefs_, header.typeCount, header.sections[kTypeData].length)) {
+    setError(error, "snapshot string table is corrupt");
+    return false;
+  }
+  for (uint32_t row = 0; row < count; ++row) {
+    if (table.floor_[row] >= header.floorCount || table.type_[row] >= header.typeCount) {
+      setError(error, "snapshot row " + std::to_string(row) + " is corrupt");
+      return false;
+    }
+  }
+  uint32_t used = 0;
+  for (uint32_t slot = 0; slot < header.slotCount; ++slot) {
+    const uint32_t row = table.slots_[slot];
+    if (row != PlacemarkTable::npos && (row >= count || ++used > count)) {
+      setError(error, "snapshot ID table is corrupt");
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace meridianmaps
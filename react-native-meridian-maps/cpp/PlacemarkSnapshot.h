@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "MappedFile.h"
+#include "PlacemarkTable.h"
+
+namespace meridianmaps {
+
+/**
+ * Versioned binary snapshot of a PlacemarkTable.
+ *
+ * Layout: a fixed 288-byte header (magic "MMPS", format version, endianness
+ * tag, row/floor/type/slot counts and a section directory of offset/length
+ * pairs) followed by one 8-byte aligned section per column, including the ID
+ * hash table. A snapshot is therefore usable straight from mmap: opening it
+ * validates the header and string references but never copies a column.
+ */
+class PlacemarkSnapshot {
+ public:
+  static constexpr uint32_t kVersion = 2;
+
+  // Maps and validates the file. Returns null and fills error if the file is
+  // missing, truncated, from another format version or otherwise corrupt.
+  static std::unique_ptr<PlacemarkSnapshot> open(const std::string& path, std::string* error = nullptr);
+
+  // Encodes any table. String blobs are compacted and the ID hash table is
+  // rebuilt, so the output does not depend on the table's edit history.
+  static std::string serialize(const PlacemarkTable& table);
+
+  // serialize() to a temporary file next to path, then rename over it so a
+  // reader never maps a half-written snapshot.
+  static bool write(const PlacemarkTable& table, const std::string& path, std::string* error = nullptr);
+
+  const PlacemarkTable& table() const { return table_; }
+  size_t byteSize() const { return file_->size(); }
+
+ private:
+  explicit PlacemarkSnapshot(std::unique_ptr<MappedFile> file) : file_(std::move(file)) {}
+
+  bool bind(std::string* error);
+
+  std::unique_ptr<MappedFile> file_;
+  PlacemarkTable table_;
+};
+
+}  // namespace meridianmaps
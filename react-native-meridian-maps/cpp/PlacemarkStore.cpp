@@ -0,0 +1,358 @@
+#include "PlacemarkStore.h"
+
+namespace meridianmaps {
+
+namespace {
+
+constexpr uint32_t kInitialSlots = 16;
+
+std::string joinDetails(const PlacemarkInput& input) {
+  std::string details;
+  for (std::string_view field : {input.typeName, input.typeCategory, input.description, input.custom1, input.custom2}) {
+    details.append(field);
+    details.push_back(PlacemarkTable::kDetailSeparator);
+  }
+  // Trailing empty fields need no separators
+  while (!details.empty() && details.back() == PlacemarkTable::kDetailSeparator) {
+    details.pop_back();
+  }
+  return details;
+}
+
+SearchDocument searchDocument(const PlacemarkTable& table, uint32_t row) {
+  using Detail = PlacemarkTable::Detail;
+  SearchDocument document;
+  document.id = table.id(row);
+  document.name = table.name(row);
+  document.typeName = table.detail(row, Detail::TypeName);
+  document.typeCategory = table.detail(row, Detail::TypeCategory);
+  document.description = table.detail(row, Detail::Description);
+  document.custom1 = table.detail(row, Detail::Custom1);
+  document.custom2 = table.detail(row, Detail::Custom2);
+  return document;
+}
+
+}  // namespace
+
+uint16_t PlacemarkStore::StringPool::intern(std::string_view value) {
+  auto it = lookup_.find(std::string(value));
+  if (it != lookup_.end()) {
+    return it->second;
+  }
+  if (refs.size() >= UINT16_MAX) {
+    return UINT16_MAX;
+  }
+  const uint16_t index = static_cast<uint16_t>(refs.size());
+  refs.push_back({static_cast<uint32_t>(data.size()), static_cast<uint32_t>(value.size())});
+  data.append(value);
+  lookup_.emplace(std::string(value), index);
+  return index;
+}
+
+void PlacemarkStore::StringPool::clear() {
+  refs.clear();
+  data.clear();
+  lookup_.clear();
+}
+
+StringRef PlacemarkStore::StringColumn::add(std::string_view value) {
+  StringRef ref{static_cast<uint32_t>(data.size()), static_cast<uint32_t>(value.size())};
+  data.append(value);
+  return ref;
+}
+
+void PlacemarkStore::StringColumn::compactIfNeeded(std::vector<StringRef>& refs) {
+  if (garbage_ * 2 <= data.size()) {
+    return;
+  }
+  std::string compacted;
+  compacted.reserve(data.size() - garbage_);
+  for (StringRef& ref : refs) {
+    const uint32_t offset = static_cast<uint32_t>(compacted.size());
+    compacted.append(data, ref.offset, ref.length);
+    ref.offset = offset;
+  }
+  data.swap(compacted);
+  garbage_ = 0;
+}
+
+void PlacemarkStore::StringColumn::clear() {
+  data.clear();
+  garbage_ = 0;
+}
+
+PlacemarkStore::PlacemarkStore() {
+  slots_.assign(kInitialSlots, npos);
+  refreshTable();
+}
+
+std::unique_ptr<PlacemarkStore> PlacemarkStore::openSnapshot(const std::string& path, std::string* error) {
+  std::unique_ptr<PlacemarkSnapshot> snapshot = PlacemarkSnapshot::open(path, error);
+  if (!snapshot) {
+    return nullptr;
+  }
+  std::unique_ptr<PlacemarkStore> store(new PlacemarkStore());
+  store->table_ = snapshot->table();
+  store->snapshot_ = std::move(snapshot);
+  return store;
+}
+
+void PlacemarkStore::materialize() {
+  if (!snapshot_) {
+    return;
+  }
+  const PlacemarkTable& source = snapshot_->table();
+  const uint32_t count = source.size();
+  x_.assign(source.xs(), source.xs() + count);
+  y_.assign(source.ys(), source.ys() + count);
+  floor_.assign(source.floors(), source.floors() + count);
+  type_.assign(source.types(), source.types() + count);
+  bounds_.assign(source.boundsData(), source.boundsData() + count);
+
+  ids_.clear();
+  names_.clear();
+  details_.clear();
+  idRefs_.resize(count);
+  nameRefs_.resize(count);
+  detailRefs_.resize(count);
+  for (uint32_t row = 0; row < count; ++row) {
+    idRefs_[row] = ids_.add(source.id(row));
+    nameRefs_[row] = names_.add(source.name(row));
+    detailRefs_[row] = details_.add(source.details(row));
+  }
+  floors_.clear();
+  for (uint32_t floor = 0; floor < source.floorCount(); ++floor) {
+    floors_.intern(source.floorKey(static_cast<uint16_t>(floor)));
+  }
+  types_.clear();
+  for (uint32_t type = 0; type < source.typeCount(); ++type) {
+    types_.intern(source.typeName(static_cast<uint16_t>(type)));
+  }
+  slots_.assign(source.slots_, source.slots_ + source.slotCount_);
+
+  snapshot_.reset();
+  refreshTable();
+}
+
+void PlacemarkStore::refreshTable() {
+  table_.size_ = static_cast<uint32_t>(x_.size());
+  table_.x_ = x_.data();
+  table_.y_ = y_.data();
+  table_.floor_ = floor_.data();
+  table_.type_ = type_.data();
+  table_.bounds_ = bounds_.data();
+  table_.idRefs_ = idRefs_.data();
+  table_.idData_ = ids_.data.data();
+  table_.nameRefs_ = nameRefs_.data();
+  table_.nameData_ = names_.data.data();
+  table_.detailRefs_ = detailRefs_.data();
+  table_.detailData_ = details_.data.data();
+  table_.floorCount_ = static_cast<uint32_t>(floors_.refs.size());
+  table_.floorRefs_ = floors_.refs.data();
+  table_.floorData_ = floors_.data.data();
+  table_.typeCount_ = static_cast<uint32_t>(types_.refs.size());
+  table_.typeRefs_ = types_.refs.data();
+  table_.typeData_ = types_.data.data();
+  table_.slots_ = slots_.data();
+  table_.slotCount_ = static_cast<uint32_t>(slots_.size());
+}
+
+const SpatialIndex& PlacemarkStore::spatialIndex() const {
+  if (spatialRevision_ != revision_) {
+    spatialIndex_.build(table_);
+    spatialRevision_ = revision_;
+  }
+  return spatialIndex_;
+}
+
+const SearchIndex& PlacemarkStore::searchIndex() const {
+  if (!searchIndexBuilt_) {
+    for (uint32_t row = 0; row < table_.size(); ++row) {
+      searchIndex_.upsert(searchDocument(table_, row));
+    }
+    searchIndexBuilt_ = true;
+  }
+  return searchIndex_;
+}
+
+uint32_t PlacemarkStore::upsert(const PlacemarkInput& input) {
+  const Rect bounds = input.bounds.value_or(Rect{input.x, input.y, input.x, input.y});
+  const std::string details = joinDetails(input);
+  uint32_t row = table_.find(input.id);
+  // Reloading a floor upserts what the store already holds; that is no mutation
+  if (row != npos && sameRow(row, input, bounds, details)) {
+    return row;
+  }
+
+  materialize();
+
+  const uint16_t floor = floors_.intern(input.mapKey);
+  const uint16_t type = types_.intern(input.type);
+  if (floor == UINT16_MAX || type == UINT16_MAX) {
+    return npos;
+  }
+  ++revision_;
+
+  if (row != npos) {
+    x_[row] = input.x;
+    y_[row] = input.y;
+    floor_[row] = floor;
+    type_[row] = type;
+    bounds_[row] = bounds;
+    if (table_.name(row) != input.name) {
+      names_.release(nameRefs_[row]);
+      nameRefs_[row] = names_.add(input.name);
+      names_.compactIfNeeded(nameRefs_);
+    }
+    if (table_.details(row) != details) {
+      details_.release(detailRefs_[row]);
+      detailRefs_[row] = details_.add(details);
+      details_.compactIfNeeded(detailRefs_);
+    }
+    refreshTable();
+    if (searchIndexBuilt_) {
+      searchIndex_.upsert(searchDocument(table_, row));
+    }
+    return row;
+  }
+
+  row = static_cast<uint32_t>(x_.size());
+  x_.push_back(input.x);
+  y_.push_back(input.y);
+  floor_.push_back(floor);
+  type_.push_back(type);
+  bounds_.push_back(bounds);
+  idRefs_.push_back(ids_.add(input.id));
+  nameRefs_.push_back(names_.add(input.name));
+  detailRefs_.push_back(details_.add(details));
+  if ((row + 1) * 2 > slots_.size()) {
+    growSlots();
+  }
+  refreshTable();
+  insertSlot(row);
+  if (searchIndexBuilt_) {
+    searchIndex_.upsert(searchDocument(table_, row));
+  }
+  return row;
+}
+
+bool PlacemarkStore::sameRow(uint32_t row, const PlacemarkInput& input, const Rect& bounds,
+                             std::string_view details) const {
+  const Rect& current = table_.bounds(row);
+  return table_.x(row) == input.x && table_.y(row) == input.y && current.minX == bounds.minX &&
+         current.minY == bounds.minY && current.maxX == bounds.maxX && current.maxY == bounds.maxY &&
+         table_.floorKey(table_.floorIndex(row)) == input.mapKey && table_.typeName(table_.typeId(row)) == input.type &&
+         table_.name(row) == input.name && table_.details(row) == details;
+}
+
+bool PlacemarkStore::remove(std::string_view id) {
+  if (table_.find(id) == npos) {
+    return false;
+  }
+  materialize();
+  ++revision_;
+
+  const uint32_t row = table_.find(id);
+  const uint32_t last = static_cast<uint32_t>(x_.size()) - 1;
+  if (searchIndexBuilt_) {
+    searchIndex_.remove(id);
+  }
+  eraseSlot(slotOf(id));
+  ids_.release(idRefs_[row]);
+  names_.release(nameRefs_[row]);
+  details_.release(detailRefs_[row]);
+
+  if (row != last) {
+    slots_[slotOf(table_.id(last))] = row;
+    x_[row] = x_[last];
+    y_[row] = y_[last];
+    floor_[row] = floor_[last];
+    type_[row] = type_[last];
+    bounds_[row] = bounds_[last];
+    idRefs_[row] = idRefs_[last];
+    nameRefs_[row] = nameRefs_[last];
+    detailRefs_[row] = detailRefs_[last];
+  }
+  x_.pop_back();
+  y_.pop_back();
+  floor_.pop_back();
+  type_.pop_back();
+  bounds_.pop_back();
+  idRefs_.pop_back();
+  nameRefs_.pop_back();
+  detailRefs_.pop_back();
+
+  ids_.compactIfNeeded(idRefs_);
+  names_.compactIfNeeded(nameRefs_);
+  details_.compactIfNeeded(detailRefs_);
+  refreshTable();
+  return true;
+}
+
+void PlacemarkStore::clear() {
+  ++revision_;
+  snapshot_.reset();
+  x_.clear();
+  y_.clear();
+  floor_.clear();
+  type_.clear();
+  bounds_.clear();
+  idRefs_.clear();
+  nameRefs_.clear();
+  detailRefs_.clear();
+  ids_.clear();
+  names_.clear();
+  details_.clear();
+  floors_.clear();
+  types_.clear();
+  slots_.assign(kInitialSlots, npos);
+  searchIndex_.clear();
+  searchIndexBuilt_ = false;
+  refreshTable();
+}
+
+void PlacemarkStore::growSlots() {
+  slots_.assign(slots_.size() * 2, npos);
+  refreshTable();
+  for (uint32_t row = 0; row < x_.size(); ++row) {
+    // The row being appended is inserted by the caller
+    if (row + 1 < x_.size()) {
+      insertSlot(row);
+    }
+  }
+}
+
+void PlacemarkStore::insertSlot(uint32_t row) {
+  const uint32_t mask = static_cast<uint32_t>(slots_.size()) - 1;
+  uint32_t slot = static_cast<uint32_t>(hashString(table_.id(row))) & mask;
+  while (slots_[slot] != npos) {
+    slot = (slot + 1) & mask;
+  }
+  slots_[slot] = row;
+}
+
+uint32_t PlacemarkStore::slotOf(std::string_view id) const {
+  const uint32_t mask = static_cast<uint32_t>(slots_.size()) - 1;
+  uint32_t slot = static_cast<uint32_t>(hashString(id)) & mask;
+  while (table_.id(slots_[slot]) != id) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+// Backward-shift deletion keeps every probe chain contiguous without tombstones
+void PlacemarkStore::eraseSlot(uint32_t slot) {
+  const uint32_t mask = static_cast<uint32_t>(slots_.size()) - 1;
+  uint32_t hole = slot;
+  for (uint32_t next = (hole + 1) & mask; slots_[next] != npos; next = (next + 1) & mask) {
+    const uint32_t home = static_cast<uint32_t>(hashString(table_.id(slots_[next]))) & mask;
+    const bool homeBetween = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+    if (!homeBetween) {
+      slots_[hole] = slots_[next];
+      hole = next;
+    }
+  }
+  slots_[hole] = npos;
+}
+
+}  // namespace meridianmaps
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "PlacemarkSnapshot.h"
+#include "PlacemarkTable.h"
+#include "SearchIndex.h"
+#include "SpatialIndex.h"
+
+namespace meridianmaps {
+
+struct PlacemarkInput {
+  std::string_view id;
+  std::string_view mapKey;
+  std::string_view name;
+  std::string_view type;
+  // Secondary search text, see PlacemarkTable::Detail
+  std::string_view typeName;
+  std::string_view typeCategory;
+  std::string_view description;
+  std::string_view custom1;
+  std::string_view custom2;
+  float x = 0;
+  float y = 0;
+  // Defaults to the point itself
+  std::optional<Rect> bounds;
+};
+
+/**
+ * Mutable columnar placemark store for one app.
+ *
+ * Rows are addressed by index; IDs are interned through an open-addressed
+ * hash table and floor keys / type names through small string pools, so a
+ * row costs a handful of fixed-size fields instead of an object graph.
+ *
+ * A store opened from a snapshot reads straight from the mapping and only
+ * copies the columns into its own buffers on the first mutation. Row indices
+ * are not stable across remove(). Not thread-safe.
+ */
+class PlacemarkStore {
+ public:
+  static constexpr uint32_t npos = PlacemarkTable::npos;
+
+  PlacemarkStore();
+  PlacemarkStore(const PlacemarkStore&) = delete;
+  PlacemarkStore& operator=(const PlacemarkStore&) = delete;
+
+  static std::unique_ptr<PlacemarkStore> openSnapshot(const std::string& path, std::string* error = nullptr);
+
+  // Inserts or replaces the placemark with input.id and returns its row, or
+  // npos if the floor or type pool is full. Upserting a row unchanged is not a
+  // mutation: the revision stays and a mapped store stays mapped.
+  uint32_t upsert(const PlacemarkInput& input);
+  bool remove(std::string_view id);
+  void clear();
+
+  const PlacemarkTable& table() const { return table_; }
+  uint32_t size() const { return table_.size(); }
+  uint32_t find(std::string_view id) const { return table_.find(id); }
+  bool isMapped() const { return snapshot_ != nullptr; }
+
+  // Incremented by every mutation, so callers can tell when derived data is stale.
+  uint64_t revision() const { return revision_; }
+
+  // Per-floor R-trees over the current rows, rebuilt on first use after a mutation.
+  const SpatialIndex& spatialIndex() const;
+
+  // Full-text index over names and details. Built from the rows on first use,
+  // then updated incrementally by every upsert and remove.
+  const SearchIndex& searchIndex() const;
+
+  bool writeSnapshot(const std::string& path, std::string* error = nullptr) const {
+    return PlacemarkSnapshot::write(table_, path, error);
+  }
+
+ private:
+  bool sameRow(uint32_t row, const PlacemarkInput& input, const Rect& bounds, std::string_view details) const;
+
+  class StringPool {
+   public:
+    uint16_t intern(std::string_view value);
+    void clear();
+    std::vector<StringRef> refs;
+    std::string data;
+
+   private:
+    std::unordered_map<std::string, uint16_t> lookup_;
+  };
+
+  class StringColumn {
+   public:
+    StringRef add(std::string_view value);
+    // Releases the bytes of a ref that is no longer used by any row
+    void release(StringRef ref) { garbage_ += ref.length; }
+    // Rewrites the blob when more than half of it is unreferenced
+    void compactIfNeeded(std::vector<StringRef>& refs);
+    void clear();
+    std::string data;
+
+   private:
+    size_t garbage_ = 0;
+  };
+
+  void materialize();
+  void refreshTable();
+  void growSlots();
+  void insertSlot(uint32_t row);
+  uint32_t slotOf(std::string_view id) const;
+  void eraseSlot(uint32_t slot);
+
+  std::unique_ptr<PlacemarkSnapshot> snapshot_;
+
+  std::vector<float> x_;
+  std::vector<float> y_;
+  std::vector<uint16_t> floor_;
+  std::vector<uint16_t> type_;
+  std::vector<Rect> bounds_;
+  std::vector<StringRef> idRefs_;
+  std::vector<StringRef> nameRefs_;
+  std::vector<StringRef> detailRefs_;
+  StringColumn ids_;
+  StringColumn names_;
+  StringColumn details_;
+  StringPool floors_;
+  StringPool types_;
+  std::vector<uint32_t> slots_;
+
+  PlacemarkTable table_;
+  uint64_t revision_ = 0;
+
+  mutable SpatialIndex spatialIndex_;
+  mutable uint64_t spatialRevision_ = UINT64_MAX;
+
+  mutable SearchIndex searchIndex_;
+  mutable bool searchIndexBuilt_ = false;
+};
+
+}  // namespace meridianmaps
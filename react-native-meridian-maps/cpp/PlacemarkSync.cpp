@@ -0,0 +1,420 @@
+#include "PlacemarkSync.h"
+
+#include <cstring>
+#include <unordered_set>
+
+#include "Json.h"
+#include "MappedFile.h"
+
+namespace meridianmaps {
+
+namespace {
+
+constexpr char kMagic[4] = {'M', 'M', 'S', 'M'};
+constexpr uint32_t kEndianTag = 0x01020304;
+
+void setError(std::string* error, const std::string& message) {
+  if (error && error->empty()) {
+    *error = message;
+  }
+}
+
+template <typename T>
+void appendValue(std::string& out, T value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendString(std::string& out, std::string_view value) {
+  appendValue(out, static_cast<uint32_t>(value.size()));
+  out.append(value);
+}
+
+class Reader {
+ public:
+  explicit Reader(std::string_view bytes) : bytes_(bytes) {}
+
+  template <typename T>
+  bool read(T& value) {
+    if (bytes_.size() - pos_ < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&value, bytes_.data() + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return true;
+  }
+
+  bool readString(std::string& value) {
+    uint32_t length;
+    if (!read(length) || bytes_.size() - pos_ < length) {
+      return false;
+    }
+    value.assign(bytes_.data() + pos_, length);
+    pos_ += length;
+    return true;
+  }
+
+  bool atEnd() const { return pos_ == bytes_.size(); }
+
+ private:
+  std::string_view bytes_;
+  size_t pos_ = 0;
+};
+
+std::string percentEncode(std::string_view value) {
+  static const char kHex[] = "0123456789ABCDEF";
+  std::string encoded;
+  encoded.reserve(value.size());
+  for (const char c : value) {
+    const unsigned char byte = static_cast<unsigned char>(c);
+    if ((byte >= 'a' && byte <= 'z') || (byte >= 'A' && byte <= 'Z') || (byte >= '0' && byte <= '9') ||
+        byte == '-' || byte == '_' || byte == '.' || byte == '~') {
+      encoded.push_back(c);
+    } else {
+      encoded.push_back('%');
+      encoded.push_back(kHex[byte >> 4]);
+      encoded.push_back(kHex[byte & 0xF]);
+    }
+  }
+  return encoded;
+}
+
+// Decodes one entry of a page's "results"; false if it has no usable ID.
+bool decodePlacemark(const JsonValue& json, const std::string& mapId, PlacemarkRecord& record) {
+  if (!json["id"].isString() || json["id"].string().empty()) {
+    return false;
+  }
+  record.id = json["id"].string();
+  record.mapKey = mapId;
+  record.name = json["name"].string();
+  record.type = json["type"].string();
+  record.typeName = json["type_name"].string();
+  record.typeCategory = json["type_category"].string();
+  record.description = json["description"].string();
+  record.custom1 = json["custom_1"].string();
+  record.custom2 = json["custom_2"].string();
+  record.x = static_cast<float>(json["x"].number());
+  record.y = static_cast<float>(json["y"].number());
+  const std::vector<JsonValue>& bounds = json["bounds"].items();
+  if (bounds.size() == 4) {
+    record.bounds = Rect{static_cast<float>(bounds[0].number()), static_cast<float>(bounds[1].number()),
+                         static_cast<float>(bounds[2].number()), static_cast<float>(bounds[3].number())};
+  }
+  return true;
+}
+
+}  // namespace
+
+PlacemarkInput PlacemarkRecord::input() const {
+  PlacemarkInput input;
+  input.id = id;
+  input.mapKey = mapKey;
+  input.name = name;
+  input.type = type;
+  input.typeName = typeName;
+  input.typeCategory = typeCategory;
+  input.description = description;
+  input.custom1 = custom1;
+  input.custom2 = custom2;
+  input.x = x;
+  input.y = y;
+  input.bounds = bounds;
+  return input;
+}
+
+uint64_t PlacemarkRecord::contentHash() const {
+  std::string buffer;
+  buffer.reserve(mapKey.size() + name.size() + type.size() + typeName.size() + typeCategory.size() +
+                 description.size() + custom1.size() + custom2.size() + 48);
+  for (const std::string* field : {&mapKey, &name, &type, &typeName, &typeCategory, &description, &custom1, &custom2}) {
+    buffer.append(*field);
+    buffer.push_back(PlacemarkTable::kDetailSeparator);
+  }
+  appendValue(buffer, x);
+  appendValue(buffer, y);
+  if (bounds) {
+    appendValue(buffer, *bounds);
+  }
+  return hashString(buffer);
+}
+
+void PlacemarkDiff::applyTo(PlacemarkStore& store) const {
+  for (const std::string& id : removals) {
+    store.remove(id);
+  }
+  for (const PlacemarkRecord& record : upserts) {
+    store.upsert(record.input());
+  }
+}
+
+std::string SyncManifest::serialize() const {
+  std::string out;
+  out.append(kMagic, sizeof(kMagic));
+  appendValue(out, kVersion);
+  appendValue(out, kEndianTag);
+  appendValue(out, static_cast<uint32_t>(maps.size()));
+  for (const auto& [mapId, state] : maps) {
+    appendString(out, mapId);
+    appendString(out, state.cursor);
+    appendString(out, state.etag);
+    appendValue(out, static_cast<uint32_t>(state.hashes.size()));
+    for (const auto& [id, hash] : state.hashes) {
+      appendString(out, id);
+      appendValue(out, hash);
+    }
+  }
+  return out;
+}
+
+bool SyncManifest::parse(std::string_view bytes, std::string* error) {
+  maps.clear();
+  Reader reader(bytes);
+  char magic[4];
+  uint32_t version, endianTag, mapCount;
+  if (!reader.read(magic) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+    setError(error, "not a sync manifest");
+    return false;
+  }
+  if (!reader.read(version) || version != kVersion || !reader.read(endianTag) || endianTag != kEndianTag) {
+    setError(error, "sync manifest is from another format version");
+    return false;
+  }
+  if (!reader.read(mapCount)) {
+    setError(error, "sync manifest is truncated");
+    return false;
+  }
+  for (uint32_t m = 0; m < mapCount; ++m) {
+    std::string mapId;
+    MapState state;
+    uint32_t count;
+    if (!reader.readString(mapId) || !reader.readString(state.cursor) || !reader.readString(state.etag) ||
+        !reader.read(count)) {
+      maps.clear();
+      setError(error, "sync manifest is truncated");
+      return false;
+    }
+    state.hashes.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+      std::string id;
+      uint64_t hash;
+      if (!reader.readString(id) || !reader.read(hash)) {
+        maps.clear();
+        setError(error, "sync manifest is truncated");
+        return false;
+      }
+      state.hashes.emplace(std::move(id), hash);
+    }
+    maps.emplace(std::move(mapId), std::move(state));
+  }
+  if (!reader.atEnd()) {
+    maps.clear();
+    setError(error, "sync manifest has trailing bytes");
+    return false;
+  }
+  return true;
+}
+
+bool SyncManifest::load(const std::string& path, std::string* error) {
+  maps.clear();
+  std::unique_ptr<MappedFile> file = MappedFile::open(path, error);
+  return file && parse(std::string_view(file->data(), file->size()), error);
+}
+
+bool SyncManifest::write(const std::string& path, std::string* error) const {
+  return writeFileAtomically(path, serialize(), error);
+}
+
+bool PlacemarkSync::run(SyncManifest& manifest, const std::function<void(const PlacemarkDiff&)>& apply,
+                        SyncStats* stats, std::string* error) {
+  SyncStats local;
+  SyncStats& counters = stats ? *stats : local;
+
+  std::vector<std::string> mapIds = options_.mapIds;
+  const bool listed = mapIds.empty();
+  if (listed && !fetchMapIds(mapIds, counters, error)) {
+    return false;
+  }
+
+  bool succeeded = true;
+  for (const std::string& mapId : mapIds) {
+    // Work on a copy so a map that fails half way keeps its old cursor
+    SyncManifest::MapState state = manifest.maps[mapId];
+    if (syncMap(mapId, state, apply, counters, error)) {
+      manifest.maps[mapId] = std::move(state);
+    } else {
+      succeeded = false;
+    }
+  }
+
+  // Only a full listing proves that a map is gone
+  if (listed) {
+    const std::unordered_set<std::string> current(mapIds.begin(), mapIds.end());
+    for (auto it = manifest.maps.begin(); it != manifest.maps.end();) {
+      if (current.count(it->first) != 0) {
+        ++it;
+        continue;
+      }
+      PlacemarkDiff diff;
+      diff.mapKey = it->first;
+      for (const auto& entry : it->second.hashes) {
+        diff.removals.push_back(entry.first);
+      }
+      counters.removed += static_cast<uint32_t>(diff.removals.size());
+      if (!diff.empty()) {
+        apply(diff);
+      }
+      it = manifest.maps.erase(it);
+    }
+  }
+  return succeeded;
+}
+
+bool PlacemarkSync::fetchMapIds(std::vector<std::string>& mapIds, SyncStats& stats, std::string* error) {
+  const HttpResponse response = get({options_.baseUrl + "/maps", std::string()}, stats);
+  if (response.status != 200) {
+    setError(error, "map list: " + (response.status == 0 ? response.error : "HTTP " + std::to_string(response.status)));
+    return false;
+  }
+  std::string parseError;
+  const JsonValue json = JsonValue::parse(response.body, &parseError);
+  if (!json.isObject()) {
+    setError(error, "map list: " + (parseError.empty() ? std::string("expected an object") : parseError));
+    return false;
+  }
+  for (const JsonValue& map : json["results"].items()) {
+    if (map["id"].isString() && !map["id"].string().empty()) {
+      mapIds.push_back(map["id"].string());
+    }
+  }
+  return true;
+}
+
+bool PlacemarkSync::syncMap(const std::string& mapId, SyncManifest::MapState& state,
+                            const std::function<void(const PlacemarkDiff&)>& apply, SyncStats& stats,
+                            std::string* error) {
+  bool delta = !state.cursor.empty();
+  const std::string listUrl = options_.baseUrl + "/maps/" + percentEncode(mapId) +
+                              "/placemarks?page_size=" + std::to_string(options_.pageSize);
+
+  while (true) {
+    std::string url = delta ? listUrl + "&since=" + percentEncode(state.cursor) : listUrl;
+    std::string etag;
+    std::string cursor;
+    // IDs listed by a full sync; whatever the manifest has beyond them was deleted
+    std::unordered_set<std::string> seen;
+    bool first = true;
+    bool restart = false;
+
+    while (!url.empty()) {
+      const HttpResponse response = get({url, first ? state.etag : std::string()}, stats);
+      if (first && response.status == 304) {
+        ++stats.mapsUnchanged;
+        return true;
+      }
+      if (first && delta && response.status == 410) {
+        // The server no longer keeps changes that old
+        delta = false;
+        restart = true;
+        break;
+      }
+      if (response.status != 200) {
+        setError(error, "map " + mapId + ": " +
+                            (response.status == 0 ? response.error : "HTTP " + std::to_string(response.status)));
+        return false;
+      }
+
+      std::string parseError;
+      const JsonValue page = JsonValue::parse(response.body, &parseError);
+      if (!page.isObject()) {
+        setError(error, "map " + mapId + ": " + (parseError.empty() ? std::string("expected an object") : parseError));
+        return false;
+      }
+      if (first) {
+        etag = response.etag;
+        first = false;
+      }
+
+      PlacemarkDiff diff;
+      diff.mapKey = mapId;
+      for (const JsonValue& entry : page["results"].items()) {
+        PlacemarkRecord record;
+        if (!decodePlacemark(entry, mapId, record)) {
+          continue;
+        }
+        const uint64_t hash = record.contentHash();
+        if (!delta) {
+          seen.insert(record.id);
+        }
+        auto known = state.hashes.find(record.id);
+        if (known != state.hashes.end() && known->second == hash) {
+          ++stats.unchanged;
+          continue;
+        }
+        state.hashes[record.id] = hash;
+        diff.upserts.push_back(std::move(record));
+      }
+      for (const JsonValue& entry : page["deleted"].items()) {
+        // Removed even if the manifest never saw it; the map view may have added it
+        if (entry.isString()) {
+          state.hashes.erase(entry.string());
+          diff.removals.push_back(entry.string());
+        }
+      }
+      stats.upserted += static_cast<uint32_t>(diff.upserts.size());
+      stats.removed += static_cast<uint32_t>(diff.removals.size());
+      if (!diff.empty()) {
+        apply(diff);
+      }
+
+      if (page["cursor"].isString()) {
+        cursor = page["cursor"].string();
+      }
+      url = page["next"].isString() ? resolve(page["next"].string()) : std::string();
+    }
+    if (restart) {
+      continue;
+    }
+
+    if (!delta) {
+      PlacemarkDiff diff;
+      diff.mapKey = mapId;
+      for (auto it = state.hashes.begin(); it != state.hashes.end();) {
+        if (seen.count(it->first) == 0) {
+          diff.removals.push_back(it->first);
+          it = state.hashes.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      stats.removed += static_cast<uint32_t>(diff.removals.size());
+      if (!diff.empty()) {
+        apply(diff);
+      }
+    }
+    ++(delta ? stats.mapsDelta : stats.mapsFull);
+    state.cursor = cursor;
+    state.etag = etag;
+    return true;
+  }
+}
+
+HttpResponse PlacemarkSync::get(const HttpRequest& request, SyncStats& stats) {
+  HttpResponse response = fetch_(request);
+  ++stats.requests;
+  stats.bytesReceived += response.body.size();
+  return response;
+}
+
+std::string PlacemarkSync::resolve(const std::string& url) const {
+  if (url.rfind("http://", 0) == 0 || url.rfind("https://", 0) == 0) {
+    return url;
+  }
+  // Path-absolute links keep the scheme and host of the base URL
+  const size_t scheme = options_.baseUrl.find("://");
+  const size_t path = scheme == std::string::npos ? std::string::npos : options_.baseUrl.find('/', scheme + 3);
+  if (!url.empty() && url[0] == '/') {
+    return options_.baseUrl.substr(0, path) + url;
+  }
+  return options_.baseUrl + "/" + url;
+}
+
+}  // namespace meridianmaps
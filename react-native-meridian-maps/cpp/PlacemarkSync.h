@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "PlacemarkStore.h"
+
+namespace meridianmaps {
+
+// Owning copy of a PlacemarkInput, as decoded from a sync page.
+struct PlacemarkRecord {
+  std::string id;
+  std::string mapKey;
+  std::string name;
+  std::string type;
+  std::string typeName;
+  std::string typeCategory;
+  std::string description;
+  std::string custom1;
+  std::string custom2;
+  float x = 0;
+  float y = 0;
+  std::optional<Rect> bounds;
+
+  PlacemarkInput input() const;
+  // Hash of every field but the ID, used to skip unchanged placemarks.
+  uint64_t contentHash() const;
+};
+
+// Changes to one floor, applied to a store in a single critical section.
+struct PlacemarkDiff {
+  std::string mapKey;
+  std::vector<PlacemarkRecord> upserts;
+  std::vector<std::string> removals;
+
+  bool empty() const { return upserts.empty() && removals.empty(); }
+  void applyTo(PlacemarkStore& store) const;
+};
+
+/**
+ * What the previous sync of an app saw, per map: the server cursor, the
+ * ETag of the map's first page and a content hash per placemark.
+ *
+ * It describes the store's contents, so it must be written after the
+ * snapshot it goes with and discarded whenever that snapshot is.
+ */
+class SyncManifest {
+ public:
+  static constexpr uint32_t kVersion = 1;
+
+  struct MapState {
+    std::string cursor;
+    std::string etag;
+    std::unordered_map<std::string, uint64_t> hashes;
+  };
+
+  // Returns false and leaves the manifest empty if the file is missing or
+  // unreadable; a missing manifest simply means a full sync.
+  bool load(const std::string& path, std::string* error = nullptr);
+  bool write(const std::string& path, std::string* error = nullptr) const;
+
+  std::string serialize() const;
+  bool parse(std::string_view bytes, std::string* error = nullptr);
+
+  std::unordered_map<std::string, MapState> maps;
+};
+
+struct HttpRequest {
+  std::string url;
+  // Sent as If-None-Match when not empty
+  std::string etag;
+};
+
+struct HttpResponse {
+  // 0 when the request could not be made at all
+  int status = 0;
+  std::string body;
+  std::string etag;
+  // Content-Type, where the platform reports it; kept with cached assets
+  std::string contentType;
+  std::string error;
+};
+
+// Blocking GET supplied by the platform (NSURLSession, HttpURLConnection).
+using HttpFetch = std::function<HttpResponse(const HttpRequest&)>;
+
+struct SyncStats {
+  uint32_t requests = 0;
+  uint64_t bytesReceived = 0;
+  // Maps answered with 304, synced from a cursor, or re-listed in full
+  uint32_t mapsUnchanged = 0;
+  uint32_t mapsDelta = 0;
+  uint32_t mapsFull = 0;
+  uint32_t upserted = 0;
+  uint32_t removed = 0;
+  // Placemarks a full listing returned with an unchanged content hash
+  uint32_t unchanged = 0;
+};
+
+/**
+ * Incremental placemark sync against a paged JSON endpoint.
+ *
+ *   GET {baseUrl}/maps
+ *     {"results": [{"id": "<mapId>"}, ...]}
+ *   GET {baseUrl}/maps/{mapId}/placemarks?page_size=N[&since=<cursor>]
+ *     {"results": [placemark, ...], "deleted": ["<id>", ...],
+ *      "next": "<url>" | null, "cursor": "<opaque>"}
+ *
+ * A placemark is {"id", "name", "type", "type_name", "type_category",
+ * "description", "custom_1", "custom_2", "x", "y"} with an optional
+ * "bounds": [minX, minY, maxX, maxY]. The first page of every map is sent
+ * with the ETag it had last time, so a map that has not changed costs one
+ * 304. With a cursor the server only returns what changed since then; a 410
+ * means the cursor expired and the map is listed again in full, where
+ * unchanged content hashes are skipped and anything not listed is removed.
+ */
+class PlacemarkSync {
+ public:
+  struct Options {
+    std::string baseUrl;
+    // Maps to sync; empty asks the server for every map of the app
+    std::vector<std::string> mapIds;
+    uint32_t pageSize = 500;
+  };
+
+  PlacemarkSync(Options options, HttpFetch fetch) : options_(std::move(options)), fetch_(std::move(fetch)) {}
+
+  // Brings the manifest and, through apply, the store up to date. apply is
+  // called on the calling thread once per page that changed anything. A map
+  // that fails keeps its previous manifest state and the other maps still
+  // sync; the first failure is reported through error.
+  bool run(SyncManifest& manifest, const std::function<void(const PlacemarkDiff&)>& apply, SyncStats* stats,
+           std::string* error = nullptr);
+
+ private:
+  bool fetchMapIds(std::vector<std::string>& mapIds, SyncStats& stats, std::string* error);
+  bool syncMap(const std::string& mapId, SyncManifest::MapState& state,
+               const std::function<void(const PlacemarkDiff&)>& apply, SyncStats& stats, std::string* error);
+  HttpResponse get(const HttpRequest& request, SyncStats& stats);
+  std::string resolve(const std::string& url) const;
+
+  Options options_;
+  HttpFetch fetch_;
+};
+
+}  // namespace meridianmaps
@@ -0,0 +1,60 @@
+#include "PlacemarkTable.h"
+
+namespace meridianmaps {
+
+uint64_t hashString(std::string_view value) {
+  uint64_t hash = 14695981039346656037ull;
+  for (unsigned char c : value) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+uint32_t PlacemarkTable::find(std::string_view id) const {
+  if (slotCount_ == 0) {
+    return npos;
+  }
+  const uint32_t mask = slotCount_ - 1;
+  for (uint32_t slot = static_cast<uint32_t>(hashString(id)) & mask;; slot = (slot + 1) & mask) {
+    const uint32_t row = slots_[slot];
+    if (row == npos) {
+      return npos;
+    }
+    if (this->id(row) == id) {
+      return row;
+    }
+  }
+}
+
+std::string_view PlacemarkTable::detail(uint32_t row, Detail field) const {
+  std::string_view rest = details(row);
+  for (uint32_t index = 0; index < static_cast<uint32_t>(field); ++index) {
+    const size_t separator = rest.find(kDetailSeparator);
+    if (separator == std::string_view::npos) {
+      return std::string_view();
+    }
+    rest.remove_prefix(separator + 1);
+  }
+  return rest.substr(0, rest.find(kDetailSeparator));
+}
+
+uint16_t PlacemarkTable::findFloor(std::string_view mapKey) const {
+  for (uint32_t floor = 0; floor < floorCount_; ++floor) {
+    if (floorKey(static_cast<uint16_t>(floor)) == mapKey) {
+      return static_cast<uint16_t>(floor);
+    }
+  }
+  return UINT16_MAX;
+}
+
+uint16_t PlacemarkTable::findType(std::string_view type) const {
+  for (uint32_t id = 0; id < typeCount_; ++id) {
+    if (typeName(static_cast<uint16_t>(id)) == type) {
+      return static_cast<uint16_t>(id);
+    }
+  }
+  return UINT16_MAX;
+}
+
+}  // namespace meridianmaps
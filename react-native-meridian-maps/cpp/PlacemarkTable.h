@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace meridianmaps {
+
+struct Rect {
+  float minX;
+  float minY;
+  float maxX;
+  float maxY;
+};
+
+// Location of a string inside a blob; used instead of std::string so that
+// columns can point straight into a memory-mapped snapshot.
+struct StringRef {
+  uint32_t offset;
+  uint32_t length;
+};
+
+// FNV-1a, also used for the snapshot's ID hash table. Changing it requires
+// bumping the snapshot version.
+uint64_t hashString(std::string_view value);
+
+/**
+ * Read-only, non-owning view over placemark columns.
+ *
+ * Every placemark is a row index; each attribute lives in its own contiguous
+ * array so floor/area scans only touch the columns they need. The same view
+ * is produced by an in-memory PlacemarkStore and by a memory-mapped snapshot.
+ */
+class PlacemarkTable {
+ public:
+  static constexpr uint32_t npos = UINT32_MAX;
+
+  // Secondary text fields, stored per row in one column joined by kDetailSeparator
+  enum class Detail : uint32_t { TypeName, TypeCategory, Description, Custom1, Custom2, Count };
+  static constexpr char kDetailSeparator = '\x1f';
+
+  uint32_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Row of the placemark with this ID, or npos.
+  uint32_t find(std::string_view id) const;
+
+  std::string_view id(uint32_t row) const { return string(idData_, idRefs_[row]); }
+  std::string_view name(uint32_t row) const { return string(nameData_, nameRefs_[row]); }
+  std::string_view details(uint32_t row) const { return string(detailData_, detailRefs_[row]); }
+  std::string_view detail(uint32_t row, Detail field) const;
+  float x(uint32_t row) const { return x_[row]; }
+  float y(uint32_t row) const { return y_[row]; }
+  const Rect& bounds(uint32_t row) const { return bounds_[row]; }
+
+  uint16_t floorIndex(uint32_t row) const { return floor_[row]; }
+  uint32_t floorCount() const { return floorCount_; }
+  std::string_view floorKey(uint16_t floor) const { return string(floorData_, floorRefs_[floor]); }
+  // Floor index for a map key, or UINT16_MAX.
+  uint16_t findFloor(std::string_view mapKey) const;
+
+  uint16_t typeId(uint32_t row) const { return type_[row]; }
+  uint32_t typeCount() const { return typeCount_; }
+  std::string_view typeName(uint16_t type) const { return string(typeData_, typeRefs_[type]); }
+  // Type id for a type name, or UINT16_MAX.
+  uint16_t findType(std::string_view type) const;
+
+  // Raw columns, size() entries each
+  const float* xs() const { return x_; }
+  const float* ys() const { return y_; }
+  const uint16_t* floors() const { return floor_; }
+  const uint16_t* types() const { return type_; }
+  const Rect* boundsData() const { return bounds_; }
+
+ private:
+  friend class PlacemarkStore;
+  friend class PlacemarkSnapshot;
+
+  static std::string_view string(const char* data, StringRef ref) {
+    return std::string_view(data + ref.offset, ref.length);
+  }
+
+  uint32_t size_ = 0;
+  const float* x_ = nullptr;
+  const float* y_ = nullptr;
+  const uint16_t* floor_ = nullptr;
+  const uint16_t* type_ = nullptr;
+  const Rect* bounds_ = nullptr;
+  const StringRef* idRefs_ = nullptr;
+  const char* idData_ = nullptr;
+  const StringRef* nameRefs_ = nullptr;
+  const char* nameData_ = nullptr;
+  const StringRef* detailRefs_ = nullptr;
+  const char* detailData_ = nullptr;
+
+  uint32_t floorCount_ = 0;
+  const StringRef* floorRefs_ = nullptr;
+  const char* floorData_ = nullptr;
+  uint32_t typeCount_ = 0;
+  const StringRef* typeRefs_ = nullptr;
+  const char* typeData_ = nullptr;
+
+  // Open-addressed ID hash table (linear probing), power-of-two sized.
+  // Each slot holds a row or npos.
+  const uint32_t* slots_ = nullptr;
+  uint32_t slotCount_ = 0;
+};
+
+}  // namespace meridianmaps
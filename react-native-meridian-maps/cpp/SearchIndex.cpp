@@ -0,0 +1,365 @@
+#include "SearchIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace meridianmaps {
+
+namespace {
+
+constexpr float kBm25K1 = 1.2f;
+constexpr float kBm25B = 0.75f;
+
+// Field weights added to a token's term frequency
+constexpr float kNameWeight = 3.0f;
+constexpr float kTypeNameWeight = 2.0f;
+constexpr float kTypeCategoryWeight = 1.5f;
+constexpr float kTextWeight = 1.0f;
+
+// Score multipliers for non-exact matches of a query token
+constexpr float kPrefixWeight = 0.8f;
+constexpr float kFuzzyWeight = 0.6f;
+
+constexpr uint32_t kMaxPrefixExpansions = 256;
+constexpr uint32_t kMaxFuzzyExpansions = 16;
+constexpr float kMinFuzzySimilarity = 0.3f;
+
+constexpr uint32_t kCompactionMinimum = 256;
+
+template <typename Visitor>
+void forEachToken(std::string_view text, Visitor visit) {
+  std::string token;
+  for (char c : text) {
+    const unsigned char byte = static_cast<unsigned char>(c);
+    if ((byte >= 'a' && byte <= 'z') || (byte >= '0' && byte <= '9') || byte >= 0x80) {
+      token.push_back(c);
+    } else if (byte >= 'A' && byte <= 'Z') {
+      token.push_back(static_cast<char>(byte - 'A' + 'a'));
+    } else if (!token.empty()) {
+      visit(token);
+      token.clear();
+    }
+  }
+  if (!token.empty()) {
+    visit(token);
+  }
+}
+
+uint32_t prefixKey(std::string_view term, uint32_t length) {
+  uint32_t key = length << 24;
+  for (uint32_t i = 0; i < length; ++i) {
+    key |= static_cast<uint32_t>(static_cast<unsigned char>(term[i])) << (16 - 8 * i);
+  }
+  return key;
+}
+
+// Distinct trigrams of the term padded as "  term ", so short terms and word
+// starts get trigrams of their own
+std::vector<uint32_t> trigrams(std::string_view term) {
+  std::string padded = "  ";
+  padded.append(term);
+  padded.push_back(' ');
+  std::vector<uint32_t> result;
+  for (size_t i = 0; i + 3 <= padded.size(); ++i) {
+    result.push_back(static_cast<uint32_t>(static_cast<unsigned char>(padded[i])) << 16 |
+                     static_cast<uint32_t>(static_cast<unsigned char>(padded[i + 1])) << 8 |
+                     static_cast<uint32_t>(static_cast<unsigned char>(padded[i + 2])));
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+}  // namespace
+
+void SearchIndex::upsert(const SearchDocument& document) {
+  auto existing = documentIds_.find(std::string(document.id));
+  if (existing != documentIds_.end()) {
+    markDead(existing->second);
+  }
+
+  std::unordered_map<std::string, float> frequencies;
+  float length = 0;
+  auto addField = [&](std::string_view text, float weight) {
+    forEachToken(text, [&](const std::string& token) {
+      frequencies[token] += weight;
+      length += weight;
+    });
+  };
+  addField(document.name, kNameWeight);
+  addField(document.typeName, kTypeNameWeight);
+  addField(document.typeCategory, kTypeCategoryWeight);
+  addField(document.description, kTextWeight);
+  addField(document.custom1, kTextWeight);
+  addField(document.custom2, kTextWeight);
+
+  const uint32_t id = static_cast<uint32_t>(documents_.size());
+  documents_.push_back({std::string(document.id), length, true});
+  documentIds_[std::string(document.id)] = id;
+  ++liveDocuments_;
+  totalLength_ += length;
+
+  // A prefix shared by several terms of the document keeps its best frequency
+  std::unordered_map<uint32_t, float> prefixFrequencies;
+  for (const auto& [text, frequency] : frequencies) {
+    terms_[internTerm(text)].postings.push_back({id, frequency});
+    const uint32_t prefixes = std::min<uint32_t>(kPrefixPostingLength, static_cast<uint32_t>(text.size()));
+    for (uint32_t length = 1; length <= prefixes; ++length) {
+      float& best = prefixFrequencies[prefixKey(text, length)];
+      best = std::max(best, frequency);
+    }
+  }
+  for (const auto& [key, frequency] : prefixFrequencies) {
+    prefixPostings_[key].push_back({id, frequency});
+  }
+
+  if (deadDocuments_ > kCompactionMinimum && deadDocuments_ > liveDocuments_ / 4) {
+    compact();
+  }
+}
+
+bool SearchIndex::remove(std::string_view id) {
+  auto existing = documentIds_.find(std::string(id));
+  if (existing == documentIds_.end()) {
+    return false;
+  }
+  markDead(existing->second);
+  documentIds_.erase(existing);
+  if (deadDocuments_ > kCompactionMinimum && deadDocuments_ > liveDocuments_ / 4) {
+    compact();
+  }
+  return true;
+}
+
+void SearchIndex::clear() {
+  documents_.clear();
+  documentIds_.clear();
+  liveDocuments_ = 0;
+  deadDocuments_ = 0;
+  totalLength_ = 0;
+  terms_.clear();
+  termIds_.clear();
+  prefixPostings_.clear();
+  trigramTerms_.clear();
+  sortedTerms_.clear();
+  sortedTermsDirty_ = false;
+}
+
+uint32_t SearchIndex::internTerm(const std::string& text) {
+  auto it = termIds_.find(text);
+  if (it != termIds_.end()) {
+    return it->second;
+  }
+  const uint32_t id = static_cast<uint32_t>(terms_.size());
+  terms_.push_back({text, {}});
+  termIds_.emplace(text, id);
+  for (uint32_t trigram : trigrams(text)) {
+    trigramTerms_[trigram].push_back(id);
+  }
+  sortedTermsDirty_ = true;
+  return id;
+}
+
+void SearchIndex::markDead(uint32_t document) {
+  Document& entry = documents_[document];
+  entry.live = false;
+  --liveDocuments_;
+  ++deadDocuments_;
+  totalLength_ -= entry.length;
+}
+
+void SearchIndex::compact() {
+  std::vector<uint32_t> remap(documents_.size(), UINT32_MAX);
+  std::vector<Document> live;
+  live.reserve(liveDocuments_);
+  for (uint32_t document = 0; document < documents_.size(); ++document) {
+    if (documents_[document].live) {
+      remap[document] = static_cast<uint32_t>(live.size());
+      live.push_back(std::move(documents_[document]));
+    }
+  }
+
+  auto rewrite = [&remap](std::vector<Posting>& postings) {
+    size_t kept = 0;
+    for (const Posting& posting : postings) {
+      if (remap[posting.document] != UINT32_MAX) {
+        postings[kept++] = {remap[posting.document], posting.frequency};
+      }
+    }
+    postings.resize(kept);
+  };
+  for (Term& term : terms_) {
+    rewrite(term.postings);
+  }
+  for (auto it = prefixPostings_.begin(); it != prefixPostings_.end();) {
+    rewrite(it->second);
+    it = it->second.empty() ? prefixPostings_.erase(it) : std::next(it);
+  }
+
+  documents_ = std::move(live);
+  for (auto& [id, document] : documentIds_) {
+    document = remap[document];
+  }
+  deadDocuments_ = 0;
+}
+
+void SearchIndex::ensureSortedTerms() const {
+  if (!sortedTermsDirty_) {
+    return;
+  }
+  sortedTerms_.resize(terms_.size());
+  for (uint32_t id = 0; id < terms_.size(); ++id) {
+    sortedTerms_[id] = id;
+  }
+  std::sort(sortedTerms_.begin(), sortedTerms_.end(),
+            [this](uint32_t a, uint32_t b) { return terms_[a].text < terms_[b].text; });
+  sortedTermsDirty_ = false;
+}
+
+void SearchIndex::scorePostings(const std::vector<Posting>& postings, float weight, std::vector<float>& best,
+                                std::vector<uint32_t>& touched) const {
+  if (postings.empty()) {
+    return;
+  }
+  const float documents = static_cast<float>(liveDocuments_);
+  const float frequency = static_cast<float>(postings.size());
+  const float idf = std::log(1.0f + (documents - frequency + 0.5f) / (frequency + 0.5f));
+  const float averageLength = static_cast<float>(totalLength_ / std::max<uint32_t>(liveDocuments_, 1));
+
+  for (const Posting& posting : postings) {
+    const Document& document = documents_[posting.document];
+    if (!document.live) {
+      continue;
+    }
+    const float norm = kBm25K1 * (1.0f - kBm25B + kBm25B * document.length / averageLength);
+    const float score = weight * idf * posting.frequency * (kBm25K1 + 1.0f) / (posting.frequency + norm);
+    float& slot = best[posting.document];
+    if (slot == 0) {
+      touched.push_back(posting.document);
+    }
+    slot = std::max(slot, score);
+  }
+}
+
+void SearchIndex::expandFuzzy(const std::string& token, std::vector<float>& best,
+                              std::vector<uint32_t>& touched) const {
+  const std::vector<uint32_t> tokenTrigrams = trigrams(token);
+  std::unordered_map<uint32_t, uint32_t> shared;
+  for (uint32_t trigram : tokenTrigrams) {
+    auto it = trigramTerms_.find(trigram);
+    if (it == trigramTerms_.end()) {
+      continue;
+    }
+    for (uint32_t term : it->second) {
+      ++shared[term];
+    }
+  }
+
+  std::vector<std::pair<float, uint32_t>> candidates;
+  for (const auto& [term, count] : shared) {
+    const std::string& text = terms_[term].text;
+    // A padded term of length n has at most n + 1 distinct trigrams
+    const float termTrigrams = static_cast<float>(text.size() + 1);
+    float similarity = count / (static_cast<float>(tokenTrigrams.size()) + termTrigrams - count);
+    if (token.size() >= 3 && text.find(token) != std::string::npos) {
+      similarity = std::max(similarity, 0.5f + 0.5f * token.size() / text.size());
+    }
+    if (similarity >= kMinFuzzySimilarity) {
+      candidates.push_back({similarity, term});
+    }
+  }
+  const size_t keep = std::min<size_t>(kMaxFuzzyExpansions, candidates.size());
+  std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(),
+                    [](const auto& a, const auto& b) { return a.first > b.first; });
+  for (size_t i = 0; i < keep; ++i) {
+    scorePostings(terms_[candidates[i].second].postings, kFuzzyWeight * candidates[i].first, best, touched);
+  }
+}
+
+std::vector<SearchResult> SearchIndex::search(std::string_view query, uint32_t limit) const {
+  std::vector<std::string> tokens;
+  forEachToken(query, [&tokens](const std::string& token) { tokens.push_back(token); });
+  if (tokens.empty() || limit == 0 || liveDocuments_ == 0) {
+    return {};
+  }
+
+  const size_t documentCount = documents_.size();
+  std::vector<float> scores(documentCount, 0);
+  std::vector<uint16_t> matchedTokens(documentCount, 0);
+  std::vector<float> best(documentCount, 0);
+  std::vector<uint32_t> touched;
+  std::vector<uint32_t> candidates;
+
+  for (uint16_t index = 0; index < tokens.size(); ++index) {
+    const std::string& token = tokens[index];
+    touched.clear();
+
+    auto exact = termIds_.find(token);
+    if (exact != termIds_.end()) {
+      scorePostings(terms_[exact->second].postings, 1.0f, best, touched);
+    }
+    if (token.size() <= kPrefixPostingLength) {
+      auto prefix = prefixPostings_.find(prefixKey(token, static_cast<uint32_t>(token.size())));
+      if (prefix != prefixPostings_.end()) {
+        scorePostings(prefix->second, kPrefixWeight, best, touched);
+      }
+    } else {
+      ensureSortedTerms();
+      auto it = std::lower_bound(sortedTerms_.begin(), sortedTerms_.end(), token,
+                                 [this](uint32_t term, const std::string& value) { return terms_[term].text < value; });
+      for (uint32_t expanded = 0; it != sortedTerms_.end() && expanded < kMaxPrefixExpansions; ++it) {
+        const std::string& text = terms_[*it].text;
+        if (text.compare(0, token.size(), token) != 0) {
+          break;
+        }
+        if (text.size() > token.size()) {
+          scorePostings(terms_[*it].postings, kPrefixWeight, best, touched);
+          ++expanded;
+        }
+      }
+    }
+    if (touched.empty()) {
+      expandFuzzy(token, best, touched);
+    }
+    if (touched.empty()) {
+      return {};
+    }
+
+    for (uint32_t document : touched) {
+      if (index == 0) {
+        candidates.push_back(document);
+      }
+      if (matchedTokens[document] == index) {
+        scores[document] += best[document];
+        ++matchedTokens[document];
+      }
+      best[document] = 0;
+    }
+  }
+
+  std::vector<SearchResult> results;
+  std::vector<uint32_t> matches;
+  for (uint32_t document : candidates) {
+    if (matchedTokens[document] == tokens.size()) {
+      matches.push_back(document);
+    }
+  }
+  auto ranksBefore = [&](uint32_t a, uint32_t b) {
+    if (scores[a] != scores[b]) {
+      return scores[a] > scores[b];
+    }
+    if (documents_[a].length != documents_[b].length) {
+      return documents_[a].length < documents_[b].length;
+    }
+    return documents_[a].id < documents_[b].id;
+  };
+  const size_t keep = std::min<size_t>(limit, matches.size());
+  std::partial_sort(matches.begin(), matches.begin() + keep, matches.end(), ranksBefore);
+  results.reserve(keep);
+  for (size_t i = 0; i < keep; ++i) {
+    results.push_back({documents_[matches[i]].id, scores[matches[i]]});
+  }
+  return results;
+}
+
+}  // namespace meridianmaps
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace meridianmaps {
+
+struct SearchDocument {
+  std::string_view id;
+  std::string_view name;
+  std::string_view typeName;
+  std::string_view typeCategory;
+  std::string_view description;
+  std::string_view custom1;
+  std::string_view custom2;
+};
+
+struct SearchResult {
+  // Valid until the next mutation of the index
+  std::string_view id;
+  float score;
+};
+
+/**
+ * Incremental inverted index for placemark typeahead.
+ *
+ * Text is lowercased and split into alphanumeric tokens; each field adds its
+ * weight to a token's term frequency (name counts most). Three kinds of
+ * postings are kept:
+ *  - exact terms,
+ *  - prefixes of up to kPrefixPostingLength bytes, so the first keystrokes
+ *    never expand into thousands of terms (longer prefixes walk a sorted
+ *    term dictionary instead),
+ *  - term trigrams, used as a fallback to match misspellings and infixes.
+ *
+ * Every query token must match (exactly, as a prefix or fuzzily); documents
+ * are ranked by BM25 summed over tokens. Replaced and removed documents are
+ * tombstoned and dropped in bulk once enough of them accumulate. Not
+ * thread-safe.
+ */
+class SearchIndex {
+ public:
+  static constexpr uint32_t kPrefixPostingLength = 3;
+
+  void upsert(const SearchDocument& document);
+  bool remove(std::string_view id);
+  void clear();
+
+  uint32_t size() const { return liveDocuments_; }
+
+  std::vector<SearchResult> search(std::string_view query, uint32_t limit) const;
+
+ private:
+  struct Posting {
+    uint32_t document;
+    float frequency;
+  };
+
+  struct Term {
+    std::string text;
+    std::vector<Posting> postings;
+  };
+
+  struct Document {
+    std::string id;
+    float length;
+    bool live;
+  };
+
+  uint32_t internTerm(const std::string& text);
+  void markDead(uint32_t document);
+  void compact();
+  void ensureSortedTerms() const;
+
+  // Adds idf-weighted BM25 scores of postings to best[], keeping the best score per document
+  void scorePostings(const std::vector<Posting>& postings, float weight, std::vector<float>& best,
+                     std::vector<uint32_t>& touched) const;
+  void expandFuzzy(const std::string& token, std::vector<float>& best, std::vector<uint32_t>& touched) const;
+
+  std::vector<Document> documents_;
+  std::unordered_map<std::string, uint32_t> documentIds_;
+  uint32_t liveDocuments_ = 0;
+  uint32_t deadDocuments_ = 0;
+  double totalLength_ = 0;
+
+  std::vector<Term> terms_;
+  std::unordered_map<std::string, uint32_t> termIds_;
+  std::unordered_map<uint32_t, std::vector<Posting>> prefixPostings_;
+  std::unordered_map<uint32_t, std::vector<uint32_t>> trigramTerms_;
+
+  // Term ids in lexicographic order, rebuilt lazily after new terms appear
+  mutable std::vector<uint32_t> sortedTerms_;
+  mutable bool sortedTermsDirty_ = false;
+};
+
+}  // namespace meridianmaps
@@ -0,0 +1,215 @@
+#include "SpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace meridianmaps {
+
+namespace {
+
+// Position of (x, y) on a Hilbert curve filling a 2^16 x 2^16 grid
+uint32_t hilbertIndex(uint32_t x, uint32_t y) {
+  constexpr uint32_t n = 1u << 16;
+  uint32_t index = 0;
+  for (uint32_t s = n / 2; s > 0; s /= 2) {
+    const uint32_t rx = (x & s) ? 1 : 0;
+    const uint32_t ry = (y & s) ? 1 : 0;
+    index += s * s * ((3 * rx) ^ ry);
+    if (ry == 0) {
+      if (rx == 1) {
+        x = n - 1 - x;
+        y = n - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return index;
+}
+
+bool intersects(const Rect& a, const Rect& b) {
+  return a.minX <= b.maxX && a.minY <= b.maxY && a.maxX >= b.minX && a.maxY >= b.minY;
+}
+
+float squaredDistance(float x, float y, const Rect& box) {
+  const float dx = x < box.minX ? box.minX - x : (x > box.maxX ? x - box.maxX : 0);
+  const float dy = y < box.minY ? box.minY - y : (y > box.maxY ? y - box.maxY : 0);
+  return dx * dx + dy * dy;
+}
+
+bool typeAllowed(const PlacemarkTable& table, const SpatialQuery& query, uint32_t row) {
+  if (query.types.empty()) {
+    return true;
+  }
+  const uint16_t type = table.typeId(row);
+  return std::find(query.types.begin(), query.types.end(), type) != query.types.end();
+}
+
+}  // namespace
+
+void FloorRTree::build(const PlacemarkTable& table, const std::vector<uint32_t>& rows) {
+  itemCount_ = static_cast<uint32_t>(rows.size());
+  boxes_.clear();
+  indices_.clear();
+  levelBounds_.clear();
+  if (itemCount_ == 0) {
+    return;
+  }
+
+  uint32_t count = itemCount_;
+  uint32_t total = count;
+  levelBounds_.push_back(total);
+  do {
+    count = (count + kNodeSize - 1) / kNodeSize;
+    total += count;
+    levelBounds_.push_back(total);
+  } while (count != 1);
+  boxes_.reserve(total);
+  indices_.reserve(total);
+
+  Rect extent = table.bounds(rows[0]);
+  for (uint32_t row : rows) {
+    const Rect& box = table.bounds(row);
+    extent = {std::min(extent.minX, box.minX), std::min(extent.minY, box.minY), std::max(extent.maxX, box.maxX),
+              std::max(extent.maxY, box.maxY)};
+  }
+  const float width = std::max(extent.maxX - extent.minX, 1e-6f);
+  const float height = std::max(extent.maxY - extent.minY, 1e-6f);
+
+  std::vector<std::pair<uint32_t, uint32_t>> order(itemCount_);
+  for (uint32_t i = 0; i < itemCount_; ++i) {
+    const Rect& box = table.bounds(rows[i]);
+    const float cx = ((box.minX + box.maxX) / 2 - extent.minX) / width;
+    const float cy = ((box.minY + box.maxY) / 2 - extent.minY) / height;
+    order[i] = {hilbertIndex(static_cast<uint32_t>(cx * 65535.0f), static_cast<uint32_t>(cy * 65535.0f)), rows[i]};
+  }
+  std::sort(order.begin(), order.end());
+  for (const auto& item : order) {
+    boxes_.push_back(table.bounds(item.second));
+    indices_.push_back(item.second);
+  }
+
+  uint32_t position = 0;
+  for (size_t level = 0; level + 1 < levelBounds_.size(); ++level) {
+    const uint32_t end = levelBounds_[level];
+    while (position < end) {
+      const uint32_t firstChild = position;
+      Rect node = boxes_[position];
+      for (uint32_t i = 0; i < kNodeSize && position < end; ++i, ++position) {
+        const Rect& box = boxes_[position];
+        node = {std::min(node.minX, box.minX), std::min(node.minY, box.minY), std::max(node.maxX, box.maxX),
+                std::max(node.maxY, box.maxY)};
+      }
+      boxes_.push_back(node);
+      indices_.push_back(firstChild);
+    }
+  }
+}
+
+uint32_t FloorRTree::levelEnd(uint32_t position) const {
+  return *std::upper_bound(levelBounds_.begin(), levelBounds_.end(), position);
+}
+
+void FloorRTree::intersecting(const PlacemarkTable& table, const SpatialQuery& query,
+                              std::vector<SpatialHit>& hits) const {
+  if (itemCount_ == 0 || query.limit == 0) {
+    return;
+  }
+  std::vector<uint32_t> stack;
+  uint32_t node = static_cast<uint32_t>(boxes_.size()) - 1;
+  while (true) {
+    const uint32_t end = std::min(node + kNodeSize, levelEnd(node));
+    const bool leaf = node < itemCount_;
+    for (uint32_t position = node; position < end; ++position) {
+      if (!intersects(query.rect, boxes_[position])) {
+        continue;
+      }
+      if (!leaf) {
+        stack.push_back(indices_[position]);
+      } else if (typeAllowed(table, query, indices_[position])) {
+        hits.push_back({indices_[position], 0});
+        if (hits.size() >= query.limit) {
+          return;
+        }
+      }
+    }
+    if (stack.empty()) {
+      return;
+    }
+    node = stack.back();
+    stack.pop_back();
+  }
+}
+
+void FloorRTree::nearest(const PlacemarkTable& table, const SpatialQuery& query, std::vector<SpatialHit>& hits) const {
+  if (itemCount_ == 0 || query.limit == 0) {
+    return;
+  }
+  struct Entry {
+    float squaredDistance;
+    uint32_t index;
+    bool item;
+    bool operator>(const Entry& other) const { return squaredDistance > other.squaredDistance; }
+  };
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+  const float maxSquared = query.radius * query.radius;
+
+  uint32_t node = static_cast<uint32_t>(boxes_.size()) - 1;
+  while (true) {
+    const uint32_t end = std::min(node + kNodeSize, levelEnd(node));
+    const bool leaf = node < itemCount_;
+    for (uint32_t position = node; position < end; ++position) {
+      const float distance = squaredDistance(query.x, query.y, boxes_[position]);
+      if (distance > maxSquared || (leaf && !typeAllowed(table, query, indices_[position]))) {
+        continue;
+      }
+      queue.push({distance, indices_[position], leaf});
+    }
+
+    // Items that surface before any remaining node are final, in order
+    while (!queue.empty() && queue.top().item) {
+      const Entry entry = queue.top();
+      queue.pop();
+      hits.push_back({entry.index, std::sqrt(entry.squaredDistance)});
+      if (hits.size() >= query.limit) {
+        return;
+      }
+    }
+    if (queue.empty()) {
+      return;
+    }
+    node = queue.top().index;
+    queue.pop();
+  }
+}
+
+void SpatialIndex::build(const PlacemarkTable& table) {
+  std::vector<std::vector<uint32_t>> rowsByFloor(table.floorCount());
+  for (uint32_t row = 0; row < table.size(); ++row) {
+    rowsByFloor[table.floorIndex(row)].push_back(row);
+  }
+  floors_.assign(table.floorCount(), FloorRTree());
+  for (uint32_t floor = 0; floor < table.floorCount(); ++floor) {
+    floors_[floor].build(table, rowsByFloor[floor]);
+  }
+}
+
+std::vector<SpatialHit> SpatialIndex::query(const PlacemarkTable& table, const SpatialQuery& query) const {
+  std::vector<SpatialHit> hits;
+  if (query.floor >= floors_.size()) {
+    return hits;
+  }
+  const FloorRTree& tree = floors_[query.floor];
+  switch (query.kind) {
+    case SpatialQuery::Kind::Nearest:
+    case SpatialQuery::Kind::Radius:
+      tree.nearest(table, query, hits);
+      break;
+    case SpatialQuery::Kind::Rect:
+      tree.intersecting(table, query, hits);
+      break;
+  }
+  return hits;
+}
+
+}  // namespace meridianmaps
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "PlacemarkTable.h"
+
+namespace meridianmaps {
+
+struct SpatialQuery {
+  enum class Kind {
+    // limit closest placemarks to (x, y), optionally within radius
+    Nearest,
+    // Every placemark within radius of (x, y), closest first, up to limit
+    Radius,
+    // Every placemark whose bounds intersect rect, up to limit, unordered
+    Rect,
+  };
+
+  Kind kind = Kind::Nearest;
+  uint16_t floor = 0;
+  float x = 0;
+  float y = 0;
+  float radius = std::numeric_limits<float>::infinity();
+  Rect rect{0, 0, 0, 0};
+  uint32_t limit = 10;
+  // Type ids to keep; empty keeps every type
+  std::vector<uint16_t> types;
+};
+
+struct SpatialHit {
+  uint32_t row;
+  // Distance from (x, y) to the placemark bounds; 0 for rect queries
+  float distance;
+};
+
+/**
+ * Packed Hilbert R-tree over the bounds of one floor's placemarks.
+ *
+ * Items are sorted along a Hilbert curve and packed bottom-up into nodes of
+ * kNodeSize entries, so the tree is a handful of flat arrays with no per-node
+ * allocation. It is static: rebuild it when the floor changes.
+ */
+class FloorRTree {
+ public:
+  static constexpr uint32_t kNodeSize = 16;
+
+  void build(const PlacemarkTable& table, const std::vector<uint32_t>& rows);
+
+  uint32_t size() const { return itemCount_; }
+
+  void nearest(const PlacemarkTable& table, const SpatialQuery& query, std::vector<SpatialHit>& hits) const;
+  void intersecting(const PlacemarkTable& table, const SpatialQuery& query, std::vector<SpatialHit>& hits) const;
+
+ private:
+  uint32_t levelEnd(uint32_t position) const;
+
+  uint32_t itemCount_ = 0;
+  // Items first, then each level of nodes up to the root
+  std::vector<Rect> boxes_;
+  // Row for an item, position of the first child for a node
+  std::vector<uint32_t> indices_;
+  std::vector<uint32_t> levelBounds_;
+};
+
+/**
+ * One FloorRTree per floor of a PlacemarkTable.
+ */
+class SpatialIndex {
+ public:
+  void build(const PlacemarkTable& table);
+
+  // Rows are only meaningful against the table the index was built from
+  std::vector<SpatialHit> query(const PlacemarkTable& table, const SpatialQuery& query) const;
+
+ private:
+  std::vector<FloorRTree> floors_;
+};
+
+}  // namespace meridianmaps
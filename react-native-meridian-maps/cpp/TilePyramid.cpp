@@ -0,0 +1,253 @@
+#include "TilePyramid.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "MappedFile.h"
+#include "PlacemarkTable.h"
+
+namespace meridianmaps {
+
+namespace {
+
+constexpr int kDeepestZoom = 12;
+
+void setError(std::string* error, const std::string& message) {
+  if (error) {
+    *error = message;
+  }
+}
+
+bool makeDirectory(const std::string& path, std::string* error) {
+  if (::mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+    setError(error, "cannot create " + path + ": " + std::strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+float longerSide(const Rect& bounds) {
+  return std::max(bounds.maxX - bounds.minX, bounds.maxY - bounds.minY);
+}
+
+}  // namespace
+
+std::unique_ptr<TilePyramid> TilePyramid::open(std::string_view svg, TilePyramidOptions options, std::string* error) {
+  if (options.tileSize == 0) {
+    setError(error, "tile size must be positive");
+    return nullptr;
+  }
+  std::unique_ptr<FloorPlan> plan = FloorPlan::parse(svg, 0.25f, error);
+  if (!plan) {
+    return nullptr;
+  }
+  int maxZoom = options.maxZoom;
+  if (maxZoom < 0) {
+    maxZoom = 0;
+    while (maxZoom < kDeepestZoom && static_cast<float>(options.tileSize << maxZoom) < longerSide(plan->bounds())) {
+      ++maxZoom;
+    }
+  }
+  maxZoom = std::min(maxZoom, kDeepestZoom);
+  // Curves belong within a quarter pixel of true at the deepest level; the
+  // first parse is kept unless it is more than twice too coarse for that
+  const float flatness = 0.25f * longerSide(plan->bounds()) / static_cast<float>(options.tileSize << maxZoom);
+  if (flatness < 0.125f) {
+    plan = FloorPlan::parse(svg, flatness, error);
+    if (!plan) {
+      return nullptr;
+    }
+  }
+
+  std::unique_ptr<TilePyramid> pyramid(new TilePyramid(std::move(plan), options, maxZoom));
+  if (!options.cacheDirectory.empty()) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%016" PRIx64 "-%u-%08x-%d", hashString(svg), options.tileSize,
+                  options.background, maxZoom);
+    pyramid->cachePath_ = options.cacheDirectory + "/" + name;
+    if (!makeDirectory(options.cacheDirectory, error) || !makeDirectory(pyramid->cachePath_, error)) {
+      return nullptr;
+    }
+  }
+  return pyramid;
+}
+
+TilePyramid::TilePyramid(std::unique_ptr<FloorPlan> plan, TilePyramidOptions options, int maxZoom)
+    : plan_(std::move(plan)), options_(std::move(options)), maxZoom_(maxZoom) {}
+
+TilePyramid::~TilePyramid() = default;
+
+float TilePyramid::scale(int zoom) const {
+  return static_cast<float>(options_.tileSize << zoom) / longerSide(plan_->bounds());
+}
+
+uint32_t TilePyramid::columns(int zoom) const {
+  const Rect& bounds = plan_->bounds();
+  const float pixels = (bounds.maxX - bounds.minX) * scale(zoom);
+  return std::max(1u, static_cast<uint32_t>(std::ceil(pixels / options_.tileSize - 1e-4f)));
+}
+
+uint32_t TilePyramid::rows(int zoom) const {
+  const Rect& bounds = plan_->bounds();
+  const float pixels = (bounds.maxY - bounds.minY) * scale(zoom);
+  return std::max(1u, static_cast<uint32_t>(std::ceil(pixels / options_.tileSize - 1e-4f)));
+}
+
+int TilePyramid::zoomForScale(float pixelsPerUnit) const {
+  int zoom = 0;
+  while (zoom < maxZoom_ && scale(zoom) < pixelsPerUnit) {
+    ++zoom;
+  }
+  return zoom;
+}
+
+Rect TilePyramid::tileBounds(const TileKey& key) const {
+  const float extent = options_.tileSize / scale(key.zoom);
+  const Rect& bounds = plan_->bounds();
+  const float x = bounds.minX + key.x * extent;
+  const float y = bounds.minY + key.y * extent;
+  return {x, y, x + extent, y + extent};
+}
+
+std::vector<TileKey> TilePyramid::visibleTiles(const Rect& visible, int zoom) const {
+  std::vector<TileKey> keys;
+  zoom = std::clamp(zoom, 0, maxZoom_);
+  const Rect& bounds = plan_->bounds();
+  const float extent = options_.tileSize / scale(zoom);
+  const float lastColumn = static_cast<float>(columns(zoom) - 1);
+  const float lastRow = static_cast<float>(rows(zoom) - 1);
+  if (visible.maxX < bounds.minX || visible.maxY < bounds.minY || visible.minX > bounds.maxX ||
+      visible.minY > bounds.maxY) {
+    return keys;
+  }
+  const uint32_t x0 = static_cast<uint32_t>(std::clamp(std::floor((visible.minX - bounds.minX) / extent), 0.0f, lastColumn));
+  const uint32_t x1 = static_cast<uint32_t>(std::clamp(std::floor((visible.maxX - bounds.minX) / extent), 0.0f, lastColumn));
+  const uint32_t y0 = static_cast<uint32_t>(std::clamp(std::floor((visible.minY - bounds.minY) / extent), 0.0f, lastRow));
+  const uint32_t y1 = static_cast<uint32_t>(std::clamp(std::floor((visible.maxY - bounds.minY) / extent), 0.0f, lastRow));
+  keys.reserve(static_cast<size_t>(x1 - x0 + 1) * (y1 - y0 + 1));
+  for (uint32_t y = y0; y <= y1; ++y) {
+    for (uint32_t x = x0; x <= x1; ++x) {
+      keys.push_back({static_cast<uint32_t>(zoom), x, y});
+    }
+  }
+  return keys;
+}
+
+std::string TilePyramid::tilePath(const TileKey& key) const {
+  char name[48];
+  std::snprintf(name, sizeof(name), "/%u-%u-%u.png", key.zoom, key.x, key.y);
+  return cachePath_ + name;
+}
+
+bool TilePyramid::tile(const TileKey& key, std::string* png, std::string* error) {
+  if (key.zoom > static_cast<uint32_t>(maxZoom_) || key.x >= columns(key.zoom) || key.y >= rows(key.zoom)) {
+    setError(error, "tile " + std::to_string(key.zoom) + "/" + std::to_string(key.x) + "/" + std::to_string(key.y) +
+                        " is outside the pyramid");
+    return false;
+  }
+  const std::string path = cachePath_.empty() ? std::string() : tilePath(key);
+  if (!path.empty()) {
+    if (std::unique_ptr<MappedFile> file = MappedFile::open(path)) {
+      png->assign(file->data(), file->size());
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++stats_.diskHits;
+      return true;
+    }
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  std::unique_ptr<TileRasterizer> rasterizer = takeRasterizer();
+  const Rect bounds = tileBounds(key);
+  rasterizer->render(*plan_, bounds.minX, bounds.minY, scale(key.zoom), options_.background);
+  // Encoding costs more than drawing; zlib level 1 halves it for a quarter more bytes
+  *png = encodePng(rasterizer->rgba().data(), options_.tileSize, options_.tileSize, 1);
+  returnRasterizer(std::move(rasterizer));
+  if (png->empty()) {
+    setError(error, "PNG encoding failed");
+    return false;
+  }
+  const bool written = path.empty() || writeFileAtomically(path, *png);
+  const auto micros =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++stats_.rendered;
+  stats_.renderMicros += static_cast<uint64_t>(micros);
+  if (!path.empty()) {
+    if (written) {
+      stats_.bytesWritten += png->size();
+    } else {
+      ++stats_.writeFailures;
+    }
+  }
+  return true;
+}
+
+size_t TilePyramid::render(const std::vector<TileKey>& keys, const TileCallback& done) {
+  WorkerPool* pool;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!pool_) {
+      pool_ = std::make_unique<WorkerPool>(options_.threads);
+    }
+    pool = pool_.get();
+  }
+  std::atomic<size_t> succeeded{0};
+  for (const TileKey& key : keys) {
+    pool->submit([this, key, &done, &succeeded] {
+      std::string png;
+      if (tile(key, &png)) {
+        succeeded.fetch_add(1, std::memory_order_relaxed);
+        if (done) {
+          done(key, png);
+        }
+      }
+    });
+  }
+  pool->wait();
+  return succeeded.load();
+}
+
+size_t TilePyramid::renderLevels(int maxZoom, const TileCallback& done) {
+  std::vector<TileKey> keys;
+  for (int zoom = 0; zoom <= std::min(maxZoom, maxZoom_); ++zoom) {
+    for (uint32_t y = 0; y < rows(zoom); ++y) {
+      for (uint32_t x = 0; x < columns(zoom); ++x) {
+        keys.push_back({static_cast<uint32_t>(zoom), x, y});
+      }
+    }
+  }
+  return render(keys, done);
+}
+
+std::unique_ptr<TileRasterizer> TilePyramid::takeRasterizer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!rasterizers_.empty()) {
+      std::unique_ptr<TileRasterizer> rasterizer = std::move(rasterizers_.back());
+      rasterizers_.pop_back();
+      return rasterizer;
+    }
+  }
+  return std::make_unique<TileRasterizer>(options_.tileSize);
+}
+
+void TilePyramid::returnRasterizer(std::unique_ptr<TileRasterizer> rasterizer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  rasterizers_.push_back(std::move(rasterizer));
+}
+
+TilePyramidStats TilePyramid::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+}  // namespace meridianmaps
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "FloorPlan.h"
+#include "TileRasterizer.h"
+#include "WorkerPool.h"
+
+namespace meridianmaps {
+
+struct TileKey {
+  uint32_t zoom;
+  uint32_t x;
+  uint32_t y;
+
+  bool operator==(const TileKey& other) const { return zoom == other.zoom && x == other.x && y == other.y; }
+};
+
+struct TilePyramidOptions {
+  // Pixels per tile side
+  uint32_t tileSize = 256;
+  // Deepest level; at level z the longer side of the floor spans tileSize << z
+  // pixels. -1 goes as deep as one pixel per document unit needs.
+  int maxZoom = -1;
+  // 0xAARRGGBB drawn under the floor
+  uint32_t background = 0xFFFFFFFF;
+  // Encoded tiles are written to a subdirectory named after the SVG and
+  // these options, and read back from there; empty keeps nothing on disk
+  std::string cacheDirectory;
+  // Threads render() uses; 0 means one per hardware thread
+  unsigned threads = 0;
+};
+
+struct TilePyramidStats {
+  // Tiles drawn and encoded, and the time that took summed over threads
+  uint64_t rendered = 0;
+  uint64_t renderMicros = 0;
+  // Tiles read back from the cache directory instead
+  uint64_t diskHits = 0;
+  // Encoded bytes written to the cache directory, and writes that failed
+  uint64_t bytesWritten = 0;
+  uint64_t writeFailures = 0;
+};
+
+/**
+ * Zoom levels of square PNG tiles for one floor SVG, drawn on demand.
+ *
+ * Level 0 fits the whole floor in one tile and each level doubles the
+ * resolution, so a view only ever asks for the tiles it shows at the level
+ * matching its scale, however large the floor. The SVG is parsed by open();
+ * tile() draws one tile on the calling thread and render() draws many on a
+ * worker pool. Tiles written to the cache directory are keyed by a hash
+ * of the SVG, so a changed floor never reads stale tiles. Thread-safe.
+ */
+class TilePyramid {
+ public:
+  using TileCallback = std::function<void(const TileKey& key, const std::string& png)>;
+
+  static std::unique_ptr<TilePyramid> open(std::string_view svg, TilePyramidOptions options,
+                                           std::string* error = nullptr);
+  ~TilePyramid();
+
+  const FloorPlan& plan() const { return *plan_; }
+  uint32_t tileSize() const { return options_.tileSize; }
+  int maxZoom() const { return maxZoom_; }
+  // Where this floor's tiles are kept; empty without a cache directory
+  const std::string& cachePath() const { return cachePath_; }
+
+  // Pixels per document unit at zoom
+  float scale(int zoom) const;
+  uint32_t columns(int zoom) const;
+  uint32_t rows(int zoom) const;
+  // The shallowest level drawn at least pixelsPerUnit, else the deepest
+  int zoomForScale(float pixelsPerUnit) const;
+  // The document rectangle a tile covers
+  Rect tileBounds(const TileKey& key) const;
+  // Tiles at zoom intersecting a document rectangle, row by row
+  std::vector<TileKey> visibleTiles(const Rect& visible, int zoom) const;
+
+  // The encoded tile, from the cache directory when it is there, else drawn
+  // and written there. Fails for tiles outside the pyramid.
+  bool tile(const TileKey& key, std::string* png, std::string* error = nullptr);
+
+  // Draws the tiles on the worker pool, calling done on a worker thread as
+  // each is ready, and returns how many succeeded once all have finished.
+  size_t render(const std::vector<TileKey>& keys, const TileCallback& done = {});
+  // Every tile of levels 0 through maxZoom
+  size_t renderLevels(int maxZoom, const TileCallback& done = {});
+
+  TilePyramidStats stats() const;
+
+ private:
+  TilePyramid(std::unique_ptr<FloorPlan> plan, TilePyramidOptions options, int maxZoom);
+
+  std::string tilePath(const TileKey& key) const;
+  std::unique_ptr<TileRasterizer> takeRasterizer();
+  void returnRasterizer(std::unique_ptr<TileRasterizer> rasterizer);
+
+  const std::unique_ptr<FloorPlan> plan_;
+  const TilePyramidOptions options_;
+  const int maxZoom_;
+  std::string cachePath_;
+
+  mutable std::mutex mutex_;
+  // Idle rasterizers, one per thread that has drawn concurrently
+  std::vector<std::unique_ptr<TileRasterizer>> rasterizers_;
+  TilePyramidStats stats_;
+  std::unique_ptr<WorkerPool> pool_;
+};
+
+}  // namespace meridianmaps
@@ -0,0 +1,259 @@
+#include "TileRasterizer.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace meridianmaps {
+
+namespace {
+
+// Source-over of a straight-alpha color at the given coverage onto a
+// premultiplied pixel
+inline void blend(uint8_t* pixel, uint32_t color, float coverage) {
+  const float alpha = (color >> 24) / 255.0f * coverage;
+  const float keep = 1 - alpha;
+  pixel[0] = static_cast<uint8_t>(((color >> 16) & 0xFF) * alpha + pixel[0] * keep + 0.5f);
+  pixel[1] = static_cast<uint8_t>(((color >> 8) & 0xFF) * alpha + pixel[1] * keep + 0.5f);
+  pixel[2] = static_cast<uint8_t>((color & 0xFF) * alpha + pixel[2] * keep + 0.5f);
+  pixel[3] = static_cast<uint8_t>(255 * alpha + pixel[3] * keep + 0.5f);
+}
+
+void appendBigEndian(std::string& out, uint32_t value) {
+  out.push_back(static_cast<char>(value >> 24));
+  out.push_back(static_cast<char>(value >> 16));
+  out.push_back(static_cast<char>(value >> 8));
+  out.push_back(static_cast<char>(value));
+}
+
+void appendChunk(std::string& out, const char type[4], const std::string& data) {
+  appendBigEndian(out, static_cast<uint32_t>(data.size()));
+  const size_t start = out.size();
+  out.append(type, 4);
+  out.append(data);
+  const uLong crc = crc32(0, reinterpret_cast<const Bytef*>(out.data() + start), static_cast<uInt>(out.size() - start));
+  appendBigEndian(out, static_cast<uint32_t>(crc));
+}
+
+}  // namespace
+
+TileRasterizer::TileRasterizer(uint32_t tileSize)
+    : tileSize_(tileSize), rgba_(static_cast<size_t>(tileSize) * tileSize * 4) {}
+
+size_t TileRasterizer::render(const FloorPlan& plan, float originX, float originY, float scale,
+                              uint32_t background) {
+  const uint8_t alpha = background >> 24;
+  const uint8_t pixel[4] = {
+      static_cast<uint8_t>(((background >> 16) & 0xFF) * alpha / 255),
+      static_cast<uint8_t>(((background >> 8) & 0xFF) * alpha / 255),
+      static_cast<uint8_t>((background & 0xFF) * alpha / 255),
+      alpha,
+  };
+  for (size_t i = 0; i < rgba_.size(); i += 4) {
+    std::copy(pixel, pixel + 4, &rgba_[i]);
+  }
+
+  // A pixel of margin for the anti-aliased edges of items just outside
+  const float extent = tileSize_ / scale;
+  const float margin = 1 / scale;
+  items_.clear();
+  plan.query({originX - margin, originY - margin, originX + extent + margin, originY + extent + margin}, items_);
+  for (uint32_t index : items_) {
+    fillItem(plan, plan.item(index), originX, originY, scale);
+  }
+  return items_.size();
+}
+
+void TileRasterizer::fillItem(const FloorPlan& plan, const FloorPlan::Item& item, float originX, float originY,
+                              float scale) {
+  const float size = static_cast<float>(tileSize_);
+  const float left = std::clamp(std::floor((item.bounds.minX - originX) * scale), 0.0f, size);
+  const float top = std::clamp(std::floor((item.bounds.minY - originY) * scale), 0.0f, size);
+  const float right = std::clamp(std::ceil((item.bounds.maxX - originX) * scale), 0.0f, size);
+  const float bottom = std::clamp(std::ceil((item.bounds.maxY - originY) * scale), 0.0f, size);
+  if (right <= left || bottom <= top) {
+    return;
+  }
+  width_ = static_cast<uint32_t>(right - left);
+  height_ = static_cast<uint32_t>(bottom - top);
+  const size_t stride = width_ + 2;
+  coverage_.assign(stride * height_, 0.0f);
+
+  for (uint32_t c = item.firstContour; c < item.firstContour + item.contourCount; ++c) {
+    const FloorPlan::Contour contour = plan.contour(c);
+    float previousX = (contour.points[2 * (contour.count - 1)] - originX) * scale - left;
+    float previousY = (contour.points[2 * (contour.count - 1) + 1] - originY) * scale - top;
+    for (uint32_t i = 0; i < contour.count; ++i) {
+      const float x = (contour.points[2 * i] - originX) * scale - left;
+      const float y = (contour.points[2 * i + 1] - originY) * scale - top;
+      accumulateClippedLine(previousX, previousY, x, y);
+      previousX = x;
+      previousY = y;
+    }
+  }
+
+  const uint32_t color = item.color;
+  const bool opaque = (color >> 24) == 0xFF;
+  const uint8_t solid[4] = {static_cast<uint8_t>(color >> 16), static_cast<uint8_t>(color >> 8),
+                            static_cast<uint8_t>(color), 0xFF};
+  for (uint32_t y = 0; y < height_; ++y) {
+    const float* row = &coverage_[y * stride];
+    uint8_t* out = &rgba_[((static_cast<size_t>(top) + y) * tileSize_ + static_cast<size_t>(left)) * 4];
+    float sum = 0;
+    for (uint32_t x = 0; x < width_; ++x, out += 4) {
+      sum += row[x];
+      float coverage = std::fabs(sum);
+      if (item.evenOdd) {
+        coverage = std::fmod(coverage, 2.0f);
+        coverage = coverage > 1 ? 2 - coverage : coverage;
+      } else {
+        coverage = std::min(coverage, 1.0f);
+      }
+      if (coverage < 1.0f / 512) {
+        continue;
+      }
+      if (opaque && coverage > 1 - 1.0f / 512) {
+        std::copy(solid, solid + 4, out);
+      } else {
+        blend(out, color, coverage);
+      }
+    }
+  }
+}
+
+// Pieces left of the buffer move onto its left edge, where they still cover
+// every pixel to their right; pieces right of it move onto the spare column
+void TileRasterizer::accumulateClippedLine(float x0, float y0, float x1, float y1) {
+  const float width = static_cast<float>(width_);
+  float splits[4] = {0, 1, 1, 1};
+  int count = 1;
+  if ((x0 < 0) != (x1 < 0)) {
+    splits[count++] = (0 - x0) / (x1 - x0);
+  }
+  if ((x0 > width) != (x1 > width)) {
+    splits[count++] = (width - x0) / (x1 - x0);
+  }
+  splits[count++] = 1;
+  std::sort(splits, splits + count);
+  float previousX = x0;
+  float previousY = y0;
+  for (int i = 1; i < count; ++i) {
+    const float t = splits[i];
+    const float x = i == count - 1 ? x1 : x0 + (x1 - x0) * t;
+    const float y = i == count - 1 ? y1 : y0 + (y1 - y0) * t;
+    accumulateLine(std::clamp(previousX, 0.0f, width), previousY, std::clamp(x, 0.0f, width), y);
+    previousX = x;
+    previousY = y;
+  }
+}
+
+// Exact area coverage of one edge, after font-rs: every row the edge
+// crosses gets the signed area to the right of it in the pixels it passes
+// through, and the pixel past it gets the rest
+void TileRasterizer::accumulateLine(float x0, float y0, float x1, float y1) {
+  if (y0 == y1) {
+    return;
+  }
+  float direction = 1;
+  if (y0 > y1) {
+    std::swap(x0, x1);
+    std::swap(y0, y1);
+    direction = -1;
+  }
+  const float height = static_cast<float>(height_);
+  if (y1 <= 0 || y0 >= height) {
+    return;
+  }
+  const float width = static_cast<float>(width_);
+  const size_t stride = width_ + 2;
+  const float dxdy = (x1 - x0) / (y1 - y0);
+  float x = y0 < 0 ? x0 - y0 * dxdy : x0;
+  const uint32_t firstRow = static_cast<uint32_t>(std::max(y0, 0.0f));
+  const uint32_t endRow = static_cast<uint32_t>(std::min(height, std::ceil(y1)));
+  for (uint32_t y = firstRow; y < endRow; ++y) {
+    float* row = &coverage_[y * stride];
+    const float dy = std::min(static_cast<float>(y + 1), y1) - std::max(static_cast<float>(y), y0);
+    const float nextX = std::clamp(x + dxdy * dy, 0.0f, width);
+    const float d = dy * direction;
+    const float left = std::min(x, nextX);
+    const float right = std::max(x, nextX);
+    const float leftFloor = std::floor(left);
+    const int leftIndex = static_cast<int>(leftFloor);
+    const float rightCeil = std::ceil(right);
+    const int rightIndex = static_cast<int>(rightCeil);
+    if (rightIndex <= leftIndex + 1) {
+      // Within one pixel: split by where the edge crosses it on average
+      const float mid = 0.5f * (x + nextX) - leftFloor;
+      row[leftIndex] += d - d * mid;
+      row[leftIndex + 1] += d * mid;
+    } else {
+      const float inverse = 1 / (right - left);
+      const float leftFraction = left - leftFloor;
+      const float firstArea = 0.5f * inverse * (1 - leftFraction) * (1 - leftFraction);
+      const float rightFraction = right - rightCeil + 1;
+      const float lastArea = 0.5f * inverse * rightFraction * rightFraction;
+      row[leftIndex] += d * firstArea;
+      if (rightIndex == leftIndex + 2) {
+        row[leftIndex + 1] += d * (1 - firstArea - lastArea);
+      } else {
+        const float secondArea = inverse * (1.5f - leftFraction);
+        row[leftIndex + 1] += d * (secondArea - firstArea);
+        for (int i = leftIndex + 2; i < rightIndex - 1; ++i) {
+          row[i] += d * inverse;
+        }
+        const float beforeLast = secondArea + (rightIndex - leftIndex - 3) * inverse;
+        row[rightIndex - 1] += d * (1 - beforeLast - lastArea);
+      }
+      row[rightIndex] += d * lastArea;
+    }
+    x = nextX;
+  }
+}
+
+std::string encodePng(const uint8_t* rgba, uint32_t width, uint32_t height, int level) {
+  // Each row is preceded by filter type 0; flat floor colors compress well without prediction
+  std::string raw;
+  raw.resize(static_cast<size_t>(height) * (width * 4 + 1));
+  char* out = &raw[0];
+  for (uint32_t y = 0; y < height; ++y) {
+    *out++ = 0;
+    const uint8_t* in = rgba + static_cast<size_t>(y) * width * 4;
+    for (uint32_t x = 0; x < width; ++x, in += 4) {
+      const uint8_t alpha = in[3];
+      if (alpha == 0xFF || alpha == 0) {
+        out[0] = static_cast<char>(alpha ? in[0] : 0);
+        out[1] = static_cast<char>(alpha ? in[1] : 0);
+        out[2] = static_cast<char>(alpha ? in[2] : 0);
+      } else {
+        out[0] = static_cast<char>(std::min(255, (in[0] * 255 + alpha / 2) / alpha));
+        out[1] = static_cast<char>(std::min(255, (in[1] * 255 + alpha / 2) / alpha));
+        out[2] = static_cast<char>(std::min(255, (in[2] * 255 + alpha / 2) / alpha));
+      }
+      out[3] = static_cast<char>(alpha);
+      out += 4;
+    }
+  }
+
+  uLongf compressedSize = compressBound(static_cast<uLong>(raw.size()));
+  std::string compressed(compressedSize, '\0');
+  if (compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressedSize, reinterpret_cast<const Bytef*>(raw.data()),
+                static_cast<uLong>(raw.size()), level) != Z_OK) {
+    return {};
+  }
+  compressed.resize(compressedSize);
+
+  std::string header;
+  appendBigEndian(header, width);
+  appendBigEndian(header, height);
+  // 8 bits per channel, RGBA, deflate, adaptive filtering, not interlaced
+  header += std::string("\x08\x06\x00\x00\x00", 5);
+
+  std::string png("\x89PNG\r\n\x1a\n", 8);
+  appendChunk(png, "IHDR", header);
+  appendChunk(png, "IDAT", compressed);
+  appendChunk(png, "IEND", {});
+  return png;
+}
+
+}  // namespace meridianmaps
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FloorPlan.h"
+
+namespace meridianmaps {
+
+/**
+ * Anti-aliased renderer of a FloorPlan into square tiles.
+ *
+ * Each item's edges add their exact signed area to a buffer covering the
+ * item's pixels in the tile, and a running sum along every row turns that
+ * into per-pixel coverage, which is blended over what is already drawn.
+ * Contours overlapping with the same winding saturate under nonzero and fold
+ * back under even-odd. Work is proportional to the items a tile touches, not
+ * to the floor. Not thread-safe; use one rasterizer per thread and share the
+ * plan.
+ */
+class TileRasterizer {
+ public:
+  explicit TileRasterizer(uint32_t tileSize);
+
+  uint32_t tileSize() const { return tileSize_; }
+
+  // Draws the tile whose top-left corner is document point (originX, originY)
+  // at scale pixels per document unit, over background (0xAARRGGBB). Returns
+  // how many items it drew; rgba() then holds the tile.
+  size_t render(const FloorPlan& plan, float originX, float originY, float scale, uint32_t background);
+
+  // Premultiplied RGBA, tileSize rows of tileSize pixels
+  const std::vector<uint8_t>& rgba() const { return rgba_; }
+
+ private:
+  void fillItem(const FloorPlan& plan, const FloorPlan::Item& item, float originX, float originY, float scale);
+  void accumulateLine(float x0, float y0, float x1, float y1);
+  void accumulateClippedLine(float x0, float y0, float x1, float y1);
+
+  const uint32_t tileSize_;
+  std::vector<uint8_t> rgba_;
+  std::vector<float> coverage_;
+  std::vector<uint32_t> items_;
+  // Pixel size of the item being filled; coverage rows are width_ + 2 long
+  uint32_t width_ = 0;
+  uint32_t height_ = 0;
+};
+
+// Encodes premultiplied RGBA rows as an 8-bit RGBA PNG at the given zlib level
+std::string encodePng(const uint8_t* rgba, uint32_t width, uint32_t height, int level = 6);
+
+}  // namespace meridianmaps
@@ -0,0 +1,64 @@
+#include "VenueRegistry.h"
+
+#include <algorithm>
+
+namespace meridianmaps {
+
+namespace {
+
+const std::string kNone;
+
+}  // namespace
+
+void VenueRegistry::setCapacity(size_t capacity, std::vector<std::string>* evicted) {
+  capacity_ = capacity < 1 ? 1 : capacity;
+  evictTo(capacity_, evicted);
+}
+
+bool VenueRegistry::activate(const std::string& appId, std::vector<std::string>* evicted) {
+  auto found = std::find(venues_.begin(), venues_.end(), appId);
+  if (found == venues_.begin() && found != venues_.end()) {
+    return true;
+  }
+  const bool warm = found != venues_.end();
+  if (!venues_.empty()) {
+    stats_.switches++;
+    (warm ? stats_.warmSwitches : stats_.coldSwitches)++;
+  }
+  if (warm) {
+    std::rotate(venues_.begin(), found, found + 1);
+  } else {
+    venues_.insert(venues_.begin(), appId);
+    evictTo(capacity_, evicted);
+  }
+  return warm;
+}
+
+bool VenueRegistry::contains(const std::string& appId) const {
+  return std::find(venues_.begin(), venues_.end(), appId) != venues_.end();
+}
+
+const std::string& VenueRegistry::active() const {
+  return venues_.empty() ? kNone : venues_.front();
+}
+
+bool VenueRegistry::remove(const std::string& appId) {
+  auto found = std::find(venues_.begin(), venues_.end(), appId);
+  if (found == venues_.end()) {
+    return false;
+  }
+  venues_.erase(found);
+  return true;
+}
+
+void VenueRegistry::evictTo(size_t size, std::vector<std::string>* evicted) {
+  while (venues_.size() > size) {
+    if (evicted) {
+      evicted->push_back(venues_.back());
+    }
+    venues_.pop_back();
+    stats_.evictions++;
+  }
+}
+
+}  // namespace meridianmaps
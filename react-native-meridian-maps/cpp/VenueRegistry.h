@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace meridianmaps {
+
+struct VenueRegistryStats {
+  // Changes of the active venue, to one that was still warm or to one that had to load
+  uint64_t switches = 0;
+  uint64_t warmSwitches = 0;
+  uint64_t coldSwitches = 0;
+  // Venues whose caches were released to stay within capacity
+  uint64_t evictions = 0;
+};
+
+/**
+ * Which venues (Meridian apps) keep their caches in memory.
+ *
+ * Each app the process has used has a context on the platform side: its keys,
+ * token, location manager and placemark index. The registry keeps the most
+ * recently active ones, up to capacity, so switching back to one of them is
+ * cheap. Past capacity the least recently active venue is evicted and the
+ * platform releases its context; the active venue is never evicted. Not
+ * thread-safe.
+ */
+class VenueRegistry {
+ public:
+  explicit VenueRegistry(size_t capacity = 3) : capacity_(capacity < 1 ? 1 : capacity) {}
+
+  // At least 1; shrinking evicts the least recently active venues into *evicted
+  void setCapacity(size_t capacity, std::vector<std::string>* evicted);
+  size_t capacity() const { return capacity_; }
+
+  // Makes appId the active venue. Returns true when it was already registered,
+  // i.e. its context is still warm. Venues past capacity go to *evicted.
+  bool activate(const std::string& appId, std::vector<std::string>* evicted);
+
+  bool contains(const std::string& appId) const;
+  // Empty before the first activate()
+  const std::string& active() const;
+  // Most recently active first
+  const std::vector<std::string>& venues() const { return venues_; }
+
+  // Forgets appId without counting an eviction; returns whether it was registered
+  bool remove(const std::string& appId);
+
+  const VenueRegistryStats& stats() const { return stats_; }
+
+ private:
+  void evictTo(size_t size, std::vector<std::string>* evicted);
+
+  size_t capacity_;
+  // A handful of venues, so a vector ordered by recency beats a list and a map
+  std::vector<std::string> venues_;
+  VenueRegistryStats stats_;
+};
+
+}  // namespace meridianmaps
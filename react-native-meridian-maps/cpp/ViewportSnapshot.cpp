@@ -0,0 +1,233 @@
+#include "ViewportSnapshot.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "MappedFile.h"
+
+namespace meridianmaps {
+
+namespace {
+
+constexpr char kMagic[4] = {'M', 'M', 'V', 'S'};
+constexpr uint32_t kEndianTag = 0x01020304;
+constexpr const char* kExtension = ".snapshot";
+
+void setError(std::string* error, const std::string& message) {
+  if (error) {
+    *error = message;
+  }
+}
+
+template <typename T>
+void appendValue(std::string& out, T value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendString(std::string& out, std::string_view value) {
+  appendValue(out, static_cast<uint32_t>(value.size()));
+  out.append(value);
+}
+
+class Reader {
+ public:
+  explicit Reader(std::string_view bytes) : bytes_(bytes) {}
+
+  template <typename T>
+  bool read(T& value) {
+    if (bytes_.size() - pos_ < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&value, bytes_.data() + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return true;
+  }
+
+  bool readString(std::string* value) {
+    uint32_t length;
+    if (!read(length) || bytes_.size() - pos_ < length) {
+      return false;
+    }
+    if (value) {
+      value->assign(bytes_.data() + pos_, length);
+    }
+    pos_ += length;
+    return true;
+  }
+
+  bool atEnd() const { return pos_ == bytes_.size(); }
+
+ private:
+  std::string_view bytes_;
+  size_t pos_ = 0;
+};
+
+bool endsWith(const std::string& value, std::string_view suffix) {
+  return value.size() >= suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::vector<std::string> snapshotFiles(const std::string& directory) {
+  std::vector<std::string> names;
+  if (DIR* dir = ::opendir(directory.c_str())) {
+    while (dirent* item = ::readdir(dir)) {
+      const std::string name = item->d_name;
+      if (endsWith(name, kExtension)) {
+        names.push_back(name);
+      }
+    }
+    ::closedir(dir);
+  }
+  return names;
+}
+
+}  // namespace
+
+ViewportSnapshotStore::ViewportSnapshotStore(std::string directory, size_t capacity)
+    : directory_(std::move(directory)), capacity_(std::max<size_t>(capacity, 1)) {}
+
+std::string ViewportSnapshotStore::pathFor(std::string_view appId, std::string_view mapId) const {
+  std::string key(appId);
+  key += '\0';
+  key.append(mapId);
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016" PRIx64, hashString(key));
+  return directory_ + "/" + name + kExtension;
+}
+
+std::string ViewportSnapshotStore::serialize(const ViewportSnapshot& snapshot) {
+  std::string out;
+  out.reserve(64 + snapshot.appId.size() + snapshot.mapId.size() + snapshot.image.size());
+  out.append(kMagic, sizeof(kMagic));
+  appendValue(out, kVersion);
+  appendValue(out, kEndianTag);
+  appendValue(out, snapshot.savedAtMs);
+  appendString(out, snapshot.appId);
+  appendString(out, snapshot.mapId);
+  appendValue(out, snapshot.visibleRect);
+  appendValue(out, snapshot.rotation);
+  appendValue(out, snapshot.viewWidth);
+  appendValue(out, snapshot.viewHeight);
+  appendString(out, snapshot.image);
+  return out;
+}
+
+bool ViewportSnapshotStore::parse(std::string_view bytes, ViewportSnapshot* snapshot, bool withImage,
+                                  std::string* error) {
+  Reader reader(bytes);
+  char magic[4];
+  uint32_t version, endianTag;
+  if (!reader.read(magic) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+    setError(error, "not a viewport snapshot");
+    return false;
+  }
+  if (!reader.read(version) || version != kVersion) {
+    setError(error, "viewport snapshot is from another format version");
+    return false;
+  }
+  if (!reader.read(endianTag) || endianTag != kEndianTag) {
+    setError(error, "viewport snapshot was written with a different byte order");
+    return false;
+  }
+  ViewportSnapshot parsed;
+  if (!reader.read(parsed.savedAtMs) || !reader.readString(&parsed.appId) || !reader.readString(&parsed.mapId) ||
+      !reader.read(parsed.visibleRect) || !reader.read(parsed.rotation) || !reader.read(parsed.viewWidth) ||
+      !reader.read(parsed.viewHeight) || !reader.readString(withImage ? &parsed.image : nullptr) ||
+      !reader.atEnd()) {
+    setError(error, "viewport snapshot is truncated");
+    return false;
+  }
+  *snapshot = std::move(parsed);
+  return true;
+}
+
+bool ViewportSnapshotStore::save(const ViewportSnapshot& snapshot, std::string* error) {
+  if (snapshot.image.empty()) {
+    setError(error, "viewport snapshot has no image");
+    return false;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (::mkdir(directory_.c_str(), 0755) != 0 && errno != EEXIST) {
+    setError(error, "mkdir " + directory_ + ": " + std::strerror(errno));
+    return false;
+  }
+  if (!writeFileAtomically(pathFor(snapshot.appId, snapshot.mapId), serialize(snapshot), error)) {
+    return false;
+  }
+  pruneLocked();
+  return true;
+}
+
+void ViewportSnapshotStore::pruneLocked() {
+  std::vector<std::string> names = snapshotFiles(directory_);
+  if (names.size() <= capacity_) {
+    return;
+  }
+  // Unreadable files sort first, at the oldest possible time
+  std::vector<std::pair<int64_t, std::string>> files;
+  for (const std::string& name : names) {
+    std::string path = directory_ + "/" + name;
+    ViewportSnapshot header;
+    std::unique_ptr<MappedFile> file = MappedFile::open(path);
+    const bool valid = file && parse(std::string_view(file->data(), file->size()), &header, false);
+    files.emplace_back(valid ? header.savedAtMs : std::numeric_limits<int64_t>::min(), std::move(path));
+  }
+  std::sort(files.begin(), files.end());
+  for (size_t i = 0; i + capacity_ < files.size(); ++i) {
+    std::remove(files[i].second.c_str());
+  }
+}
+
+bool ViewportSnapshotStore::load(std::string_view appId, std::string_view mapId, int64_t nowMs, int64_t maxAgeMs,
+                                 ViewportSnapshot* snapshot, std::string* error) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  const std::string path = pathFor(appId, mapId);
+  std::unique_ptr<MappedFile> file = MappedFile::open(path, error);
+  if (!file) {
+    return false;
+  }
+  ViewportSnapshot loaded;
+  if (!parse(std::string_view(file->data(), file->size()), &loaded, true, error)) {
+    std::remove(path.c_str());
+    return false;
+  }
+  if (loaded.appId != appId || loaded.mapId != mapId) {
+    setError(error, "viewport snapshot belongs to another floor");
+    return false;
+  }
+  if (nowMs - loaded.savedAtMs > maxAgeMs) {
+    setError(error, "viewport snapshot is too old");
+    std::remove(path.c_str());
+    return false;
+  }
+  *snapshot = std::move(loaded);
+  return true;
+}
+
+bool ViewportSnapshotStore::remove(std::string_view appId, std::string_view mapId) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return std::remove(pathFor(appId, mapId).c_str()) == 0;
+}
+
+void ViewportSnapshotStore::clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (const std::string& name : snapshotFiles(directory_)) {
+    std::remove((directory_ + "/" + name).c_str());
+  }
+}
+
+size_t ViewportSnapshotStore::size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return snapshotFiles(directory_).size();
+}
+
+}  // namespace meridianmaps
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "PlacemarkTable.h"
+
+namespace meridianmaps {
+
+// What a map view showed when the app last went to the background
+struct ViewportSnapshot {
+  std::string appId;
+  // The floor on screen, which may differ from the one the view was configured with
+  std::string mapId;
+  // The visible map rect in map units, and the map's rotation in radians
+  Rect visibleRect{0, 0, 0, 0};
+  float rotation = 0;
+  // The view's size in points; a snapshot only fits a view of the same aspect
+  float viewWidth = 0;
+  float viewHeight = 0;
+  int64_t savedAtMs = 0;
+  // The rendered map, encoded by the platform (JPEG)
+  std::string image;
+};
+
+/**
+ * The most recent viewport snapshot of each floor, one file per
+ * (app, floor), so a view mounting on relaunch can show the map it left
+ * before the SDK has loaded anything.
+ *
+ * Files are written atomically. save() keeps the newest `capacity` files
+ * and deletes the rest; load() ignores, and deletes, snapshots that are
+ * unreadable, from another format version or older than maxAgeMs, since
+ * the venue may have changed since. Thread-safe.
+ */
+class ViewportSnapshotStore {
+ public:
+  static constexpr uint32_t kVersion = 1;
+  static constexpr size_t kDefaultCapacity = 8;
+
+  explicit ViewportSnapshotStore(std::string directory, size_t capacity = kDefaultCapacity);
+
+  // Creates the directory if needed. Snapshots without an image are refused.
+  bool save(const ViewportSnapshot& snapshot, std::string* error = nullptr);
+
+  // The snapshot of (appId, mapId), if one was saved within maxAgeMs of nowMs.
+  bool load(std::string_view appId, std::string_view mapId, int64_t nowMs, int64_t maxAgeMs,
+            ViewportSnapshot* snapshot, std::string* error = nullptr);
+
+  bool remove(std::string_view appId, std::string_view mapId);
+  void clear();
+
+  // Snapshot files on disk
+  size_t size() const;
+
+  static std::string serialize(const ViewportSnapshot& snapshot);
+  // With withImage false the image is skipped, which is all pruning needs.
+  static bool parse(std::string_view bytes, ViewportSnapshot* snapshot, bool withImage = true,
+                    std::string* error = nullptr);
+
+ private:
+  std::string pathFor(std::string_view appId, std::string_view mapId) const;
+  void pruneLocked();
+
+  const std::string directory_;
+  const size_t capacity_;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace meridianmaps
@@ -0,0 +1,98 @@
+// Replays a location trace at full speed through the same smoothing and
+// throttling the map views run, and reports fixes per second and how many
+// fixes would have crossed the bridge. Pass a trace recorded on a device
+// (startLocationRecording) to benchmark a real venue walk; without one an
+// hour-long synthetic walk is used.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "LocationFilter.h"
+#include "LocationThrottle.h"
+#include "LocationTrace.h"
+
+using namespace meridianmaps;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+double secondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Back and forth along a corridor at 1 Hz with a floor change every ten minutes
+std::vector<LocationSample> syntheticWalk() {
+  std::vector<LocationSample> samples;
+  for (int i = 0; i < 3600; ++i) {
+    LocationSample sample;
+    sample.mapKey = "floor-" + std::to_string(1 + (i / 600) % 3);
+    sample.providerType = 1;
+    sample.timestampMs = 1700000000000 + i * 1000;
+    const double along = std::fmod(i * 10.0, 1200.0);
+    sample.x = (along < 600 ? along : 1200 - along) + std::sin(i * 1.7) * 4;
+    sample.y = 300 + std::cos(i * 2.3) * 4;
+    sample.accuracy = 6;
+    samples.push_back(sample);
+  }
+  return samples;
+}
+
+void run(const char* name, const std::vector<LocationSample>& samples, const LocationThrottleOptions& options) {
+  constexpr int kRounds = 50;
+  size_t delivered = 0;
+  const auto start = Clock::now();
+  for (int round = 0; round < kRounds; ++round) {
+    LocationFilter filter;
+    LocationThrottle throttle(options);
+    LocationReplay replay(samples, 0);
+    replay.start(0);
+    for (const LocationSample& sample : replay.take(0)) {
+      // Replays run on recorded time, so the throttle's clock is the fix's timestamp
+      const LocationEstimate estimate = filter.update(sample);
+      if (throttle.offer(estimate.sample, sample.timestampMs).action == LocationThrottle::Action::Deliver) {
+        ++delivered;
+      }
+      if (throttle.flush(sample.timestampMs)) {
+        ++delivered;
+      }
+    }
+  }
+  const double seconds = secondsSince(start);
+  const double fixes = static_cast<double>(samples.size()) * kRounds;
+  std::printf("  %-28s %10.0f fixes/s  %5.1f%% delivered\n", name, fixes / seconds, 100.0 * delivered / fixes);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::vector<LocationSample> samples;
+  if (argc > 1) {
+    std::string error;
+    if (!LocationTrace::read(argv[1], &samples, &error)) {
+      std::fprintf(stderr, "cannot read trace %s: %s\n", argv[1], error.c_str());
+      return 1;
+    }
+  } else {
+    samples = syntheticWalk();
+  }
+  const std::string encoded = LocationTrace::encode(samples);
+  std::printf("%zu fixes, %.1f bytes/fix encoded\n", samples.size(),
+              static_cast<double>(encoded.size()) / std::max<size_t>(samples.size(), 1));
+
+  LocationThrottleOptions unthrottled;
+  run("filter only", samples, unthrottled);
+
+  LocationThrottleOptions gated;
+  gated.minDisplacement = 5;
+  run("filter, 5 unit displacement", samples, gated);
+
+  LocationThrottleOptions limited;
+  limited.maxRateHz = 0.5;
+  limited.minDisplacement = 5;
+  run("filter, 5 units, 0.5 Hz", samples, limited);
+  return 0;
+}
@@ -0,0 +1,73 @@
+// Load-time benchmark for a synthetic 200k-placemark venue: building the
+// store from parsed placemarks versus mapping a snapshot at startup.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+#include "PlacemarkSnapshot.h"
+#include "PlacemarkStore.h"
+#include "../tests/SyntheticVenue.h"
+
+using namespace meridianmaps;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+double millisecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const uint32_t count = argc > 1 ? static_cast<uint32_t>(std::stoul(argv[1])) : 200000;
+  const auto venue = testing::makeVenue(count);
+  const std::string path = "/tmp/mm_store_bench_" + std::to_string(::getpid()) + ".mmps";
+
+  auto start = Clock::now();
+  PlacemarkStore store;
+  for (const auto& placemark : venue) {
+    store.upsert(testing::toInput(placemark));
+  }
+  const double buildMs = millisecondsSince(start);
+
+  start = Clock::now();
+  std::string error;
+  if (!store.writeSnapshot(path, &error)) {
+    std::fprintf(stderr, "write failed: %s\n", error.c_str());
+    return 1;
+  }
+  const double writeMs = millisecondsSince(start);
+
+  start = Clock::now();
+  std::unique_ptr<PlacemarkStore> mapped = PlacemarkStore::openSnapshot(path, &error);
+  if (!mapped) {
+    std::fprintf(stderr, "open failed: %s\n", error.c_str());
+    return 1;
+  }
+  const double openMs = millisecondsSince(start);
+
+  start = Clock::now();
+  uint32_t found = 0;
+  for (uint32_t i = 0; i < count; i += 97) {
+    found += mapped->find(venue[i].id) != PlacemarkStore::npos;
+  }
+  const double lookupMs = millisecondsSince(start);
+
+  start = Clock::now();
+  mapped->upsert(testing::toInput(venue[0]));
+  const double materializeMs = millisecondsSince(start);
+
+  std::printf("placemarks:            %u\n", count);
+  std::printf("snapshot size:         %.1f MB\n", store.table().size() ? PlacemarkSnapshot::serialize(store.table()).size() / 1e6 : 0.0);
+  std::printf("build from input:      %8.2f ms\n", buildMs);
+  std::printf("write snapshot:        %8.2f ms\n", writeMs);
+  std::printf("open mapped snapshot:  %8.2f ms\n", openMs);
+  std::printf("%u ID lookups:       %8.2f ms\n", found, lookupMs);
+  std::printf("copy on first write:   %8.2f ms\n", materializeMs);
+
+  std::remove(path.c_str());
+  return found == (count + 96) / 97 ? 0 : 1;
+}
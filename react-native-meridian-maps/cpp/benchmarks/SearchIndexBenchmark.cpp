@@ -0,0 +1,162 @@
+// Typeahead latency on a synthetic 100k-placemark venue (every prefix of a
+// set of queries, as typed key by key), then recall@10 against a fixture of
+// reference search results.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "SearchIndex.h"
+
+using namespace meridianmaps;
+using Clock = std::chrono::steady_clock;
+
+#ifndef MERIDIANMAPS_FIXTURES_DIR
+#define MERIDIANMAPS_FIXTURES_DIR "benchmarks/fixtures"
+#endif
+
+namespace {
+
+struct OwnedDocument {
+  std::string id, name, typeName, typeCategory, description;
+
+  SearchDocument view() const {
+    SearchDocument document;
+    document.id = id;
+    document.name = name;
+    document.typeName = typeName;
+    document.typeCategory = typeCategory;
+    document.description = description;
+    return document;
+  }
+};
+
+std::vector<OwnedDocument> makeVenue(uint32_t count) {
+  static const char* kAdjectives[] = {"North", "South", "East", "West", "Upper", "Lower", "Blue", "Green",
+                                      "Quiet", "Open",  "Main",  "Old",  "New",   "Grand", "Small", "Corner"};
+  static const char* kNouns[] = {"Conference", "Office", "Restroom", "Kitchen", "Lounge",  "Studio",   "Lab",
+                                 "Library",    "Cafe",   "Pantry",   "Gallery", "Theater", "Workshop", "Atrium",
+                                 "Suite",      "Desk",   "Booth",    "Terrace", "Garden",  "Storage"};
+  static const char* kTypes[][2] = {{"Conference Room", "Meeting Spaces"}, {"Office", "Workspace"},
+                                    {"Restroom", "Amenities"},             {"Kitchenette", "Food and Drink"},
+                                    {"Elevator", "Transit"},               {"Stairs", "Transit"},
+                                    {"Desk", "Workspace"},                 {"Printer", "Services"}};
+  static const char* kWords[] = {"window",  "projector", "whiteboard", "seats", "coffee", "accessible",
+                                 "badge",   "shower",    "lockers",    "video", "phone",  "standing",
+                                 "printer", "snacks",    "quiet",      "view"};
+
+  uint32_t state = 12345;
+  auto next = [&state]() {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+  };
+
+  std::vector<OwnedDocument> venue(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    const auto& type = kTypes[next() % 8];
+    venue[i].id = "pm_" + std::to_string(i);
+    venue[i].name = std::string(kAdjectives[next() % 16]) + " " + kNouns[next() % 20] + " " + std::to_string(next() % 2000);
+    venue[i].typeName = type[0];
+    venue[i].typeCategory = type[1];
+    for (int w = 0; w < 4; ++w) {
+      venue[i].description += std::string(kWords[next() % 16]) + " ";
+    }
+  }
+  return venue;
+}
+
+double percentile(std::vector<double> values, double p) {
+  std::sort(values.begin(), values.end());
+  return values[std::min(values.size() - 1, static_cast<size_t>(p * values.size()))];
+}
+
+void measureLatency(uint32_t count) {
+  const auto venue = makeVenue(count);
+  SearchIndex index;
+  auto start = Clock::now();
+  for (const auto& document : venue) {
+    index.upsert(document.view());
+  }
+  std::printf("%u placemarks indexed in %.0f ms\n", count,
+              std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+
+  const char* queries[] = {"conference room", "north kitchen 12", "restrom", "quiet library", "blue studio 1999",
+                           "elevator",        "coffee",           "atrium",  "west lounge 7",  "projector window"};
+  std::vector<double> latencies;
+  for (const char* query : queries) {
+    const std::string text(query);
+    for (size_t length = 1; length <= text.size(); ++length) {
+      start = Clock::now();
+      const auto results = index.search(text.substr(0, length), 20);
+      latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+  }
+  std::printf("  %zu keystrokes: p50 %.3f ms, p95 %.3f ms, max %.3f ms\n", latencies.size(),
+              percentile(latencies, 0.5), percentile(latencies, 0.95), percentile(latencies, 1.0));
+}
+
+std::vector<std::string> split(const std::string& line, char separator) {
+  std::vector<std::string> fields;
+  std::stringstream stream(line);
+  std::string field;
+  while (std::getline(stream, field, separator)) {
+    fields.push_back(field);
+  }
+  return fields;
+}
+
+bool measureRecall(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    std::fprintf(stderr, "cannot open fixture %s\n", path.c_str());
+    return false;
+  }
+
+  std::vector<OwnedDocument> documents;
+  std::vector<std::pair<std::string, std::vector<std::string>>> queries;
+  std::string line;
+  while (std::getline(file, line)) {
+    const auto fields = split(line, '\t');
+    if (fields.size() >= 6 && fields[0] == "P") {
+      documents.push_back({fields[1], fields[2], fields[3], fields[4], fields[5]});
+    } else if (fields.size() >= 3 && fields[0] == "Q") {
+      queries.push_back({fields[1], split(fields[2], ',')});
+    }
+  }
+
+  SearchIndex index;
+  for (const auto& document : documents) {
+    index.upsert(document.view());
+  }
+
+  double recallSum = 0;
+  for (const auto& [query, expected] : queries) {
+    std::vector<std::string> found;
+    for (const SearchResult& result : index.search(query, 10)) {
+      found.emplace_back(result.id);
+    }
+    size_t hits = 0;
+    for (const std::string& id : expected) {
+      hits += std::find(found.begin(), found.end(), id) != found.end();
+    }
+    const double recall = static_cast<double>(hits) / expected.size();
+    recallSum += recall;
+    if (recall < 1.0) {
+      std::printf("  recall %.2f for \"%s\"\n", recall, query.c_str());
+    }
+  }
+  std::printf("recall@10 over %zu fixture queries: %.3f\n", queries.size(), recallSum / queries.size());
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  measureLatency(100000);
+  const std::string fixture = argc > 1 ? argv[1] : MERIDIANMAPS_FIXTURES_DIR "/search_recall.tsv";
+  return measureRecall(fixture) ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+// Queries per second for k-nearest, radius and rectangle queries on a single
+// floor of 10k, 100k and 1M placemarks.
+
+#include <chrono>
+#include <cstdio>
+
+#include "PlacemarkStore.h"
+#include "SpatialIndex.h"
+#include "../tests/SyntheticVenue.h"
+
+using namespace meridianmaps;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+double secondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+template <typename MakeQuery>
+void run(const char* name, const PlacemarkStore& store, MakeQuery makeQuery) {
+  constexpr uint32_t kQueries = 20000;
+  size_t hits = 0;
+  const auto start = Clock::now();
+  for (uint32_t i = 0; i < kQueries; ++i) {
+    hits += store.spatialIndex().query(store.table(), makeQuery(i)).size();
+  }
+  const double seconds = secondsSince(start);
+  std::printf("  %-22s %10.0f queries/s  (%.1f hits/query)\n", name, kQueries / seconds,
+              static_cast<double>(hits) / kQueries);
+}
+
+}  // namespace
+
+int main() {
+  for (uint32_t count : {10000u, 100000u, 1000000u}) {
+    PlacemarkStore store;
+    for (const auto& placemark : testing::makeVenue(count, 1)) {
+      store.upsert(testing::toInput(placemark));
+    }
+    const auto start = Clock::now();
+    store.spatialIndex();
+    std::printf("%u placemarks, index built in %.1f ms\n", count, secondsSince(start) * 1000);
+
+    const uint16_t restroom = store.table().findType("restroom");
+    auto point = [](uint32_t i, SpatialQuery& query) {
+      query.x = static_cast<float>((i * 7919) % 4000);
+      query.y = static_cast<float>((i * 104729) % 3000);
+    };
+    run("nearest k=5", store, [&](uint32_t i) {
+      SpatialQuery query;
+      point(i, query);
+      query.limit = 5;
+      return query;
+    });
+    run("nearest restroom k=1", store, [&](uint32_t i) {
+      SpatialQuery query;
+      point(i, query);
+      query.limit = 1;
+      query.types = {restroom};
+      return query;
+    });
+    run("radius 25", store, [&](uint32_t i) {
+      SpatialQuery query;
+      query.kind = SpatialQuery::Kind::Radius;
+      point(i, query);
+      query.radius = 25;
+      query.limit = UINT32_MAX;
+      return query;
+    });
+    run("rect 100x100", store, [&](uint32_t i) {
+      SpatialQuery query;
+      query.kind = SpatialQuery::Kind::Rect;
+      point(i, query);
+      query.rect = {query.x, query.y, query.x + 100, query.y + 100};
+      query.limit = UINT32_MAX;
+      return query;
+    });
+  }
+  return 0;
+}
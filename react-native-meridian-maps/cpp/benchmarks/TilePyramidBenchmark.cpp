@@ -0,0 +1,156 @@
+// Parse time, tiles per second on one thread and on the worker pool, and
+// peak memory for a synthetic 20k-element floor plan.
+
+#include <dirent.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "TilePyramid.h"
+
+using namespace meridianmaps;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+double secondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Peak resident set of the process so far; kilobytes on Linux
+double peakMegabytes() {
+  rusage usage{};
+  ::getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss / 1024.0;
+}
+
+void removeAll(const std::string& path) {
+  if (DIR* dir = ::opendir(path.c_str())) {
+    while (dirent* item = ::readdir(dir)) {
+      const std::string name = item->d_name;
+      if (name != "." && name != "..") {
+        removeAll(path + "/" + name);
+      }
+    }
+    ::closedir(dir);
+    ::rmdir(path.c_str());
+  } else {
+    std::remove(path.c_str());
+  }
+}
+
+// A 10,000 by 5,000 unit floor of 5,000 rooms, each with a wall outline, a
+// door swing, a table and a desk: rect, path with an arc, circle and polygon
+std::string makeFloor(int elements) {
+  std::string svg = "<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"0 0 10000 5000\">\n";
+  char buffer[512];
+  int written = 0;
+  for (int room = 0; written < elements; ++room) {
+    const int x = (room % 100) * 100;
+    const int y = (room / 100 % 50) * 100;
+    std::snprintf(buffer, sizeof(buffer),
+                  "<g transform=\"translate(%d %d)\">"
+                  "<rect x=\"4\" y=\"4\" width=\"92\" height=\"92\" fill=\"#%06x\" stroke=\"#555\" stroke-width=\"2\"/>"
+                  "<path d=\"M40 96 l0 -16 a16 16 0 0 1 16 16\" fill=\"none\" stroke=\"#999\"/>"
+                  "<circle cx=\"30\" cy=\"30\" r=\"%d\" fill=\"#c8b090\"/>"
+                  "<polygon points=\"60,20 85,20 85,45 72,50 60,45\" fill=\"#a0b0c8\" opacity=\"0.8\"/>"
+                  "</g>\n",
+                  x, y, 0xd0d0d0 + (room * 2654435761u % 0x202020), 8 + room % 6);
+    svg += buffer;
+    written += 4;
+  }
+  svg += "</svg>\n";
+  return svg;
+}
+
+size_t tilesThrough(const TilePyramid& pyramid, int maxZoom) {
+  size_t count = 0;
+  for (int zoom = 0; zoom <= maxZoom; ++zoom) {
+    count += static_cast<size_t>(pyramid.columns(zoom)) * pyramid.rows(zoom);
+  }
+  return count;
+}
+
+}  // namespace
+
+int main() {
+  constexpr int kElements = 20000;
+  const std::string svg = makeFloor(kElements);
+  const double baseline = peakMegabytes();
+
+  auto start = Clock::now();
+  TilePyramidOptions options;
+  options.background = 0xFFF4F4F0;
+  std::unique_ptr<TilePyramid> serial = TilePyramid::open(svg, options);
+  if (!serial) {
+    std::printf("failed to parse the floor\n");
+    return 1;
+  }
+  std::printf("%zu elements, %.1f MB of SVG, parsed in %.1f ms into %zu items (%.1f MB)\n",
+              serial->plan().elementCount(), svg.size() / 1e6, secondsSince(start) * 1000, serial->plan().size(),
+              serial->plan().byteSize() / 1e6);
+
+  // The deepest level alone is 2,048 tiles; the levels above it show the trend
+  const int levels = serial->maxZoom() - 1;
+  const size_t tileCount = tilesThrough(*serial, levels);
+  start = Clock::now();
+  size_t bytes = 0;
+  for (int zoom = 0; zoom <= levels; ++zoom) {
+    for (uint32_t y = 0; y < serial->rows(zoom); ++y) {
+      for (uint32_t x = 0; x < serial->columns(zoom); ++x) {
+        std::string png;
+        serial->tile({static_cast<uint32_t>(zoom), x, y}, &png);
+        bytes += png.size();
+      }
+    }
+  }
+  double seconds = secondsSince(start);
+  std::printf("  levels 0-%d, 1 thread   %6zu tiles %8.0f tiles/s  (%.1f KB/tile)\n", levels, tileCount,
+              tileCount / seconds, bytes / 1024.0 / tileCount);
+
+  const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  TilePyramidOptions pooledOptions = options;
+  pooledOptions.threads = threads;
+  std::unique_ptr<TilePyramid> pooled = TilePyramid::open(svg, pooledOptions);
+  start = Clock::now();
+  const size_t rendered = pooled->renderLevels(levels);
+  seconds = secondsSince(start);
+  std::printf("  levels 0-%d, pool of %-3u %5zu tiles %8.0f tiles/s\n", levels, threads, rendered, rendered / seconds);
+
+  // What a view at the deepest level asks for: the tiles under a 1170 by 2532 pixel phone screen
+  const int deepest = pooled->maxZoom();
+  const Rect& bounds = pooled->plan().bounds();
+  const float cx = (bounds.minX + bounds.maxX) / 2;
+  const float cy = (bounds.minY + bounds.maxY) / 2;
+  const float halfWidth = 1170 / 2.0f / pooled->scale(deepest);
+  const float halfHeight = 2532 / 2.0f / pooled->scale(deepest);
+  const std::vector<TileKey> visible =
+      pooled->visibleTiles({cx - halfWidth, cy - halfHeight, cx + halfWidth, cy + halfHeight}, deepest);
+  start = Clock::now();
+  pooled->render(visible);
+  std::printf("  level %d, one screen     %6zu tiles in %.1f ms\n", deepest, visible.size(), secondsSince(start) * 1000);
+
+  // A second launch reading the same tiles back from disk
+  const std::string directory = "/tmp/mm_tile_benchmark_" + std::to_string(::getpid());
+  TilePyramidOptions diskOptions = pooledOptions;
+  diskOptions.cacheDirectory = directory;
+  {
+    std::unique_ptr<TilePyramid> writer = TilePyramid::open(svg, diskOptions);
+    writer->renderLevels(levels);
+  }
+  std::unique_ptr<TilePyramid> reader = TilePyramid::open(svg, diskOptions);
+  start = Clock::now();
+  const size_t read = reader->renderLevels(levels);
+  seconds = secondsSince(start);
+  std::printf("  levels 0-%d from disk    %6zu tiles %8.0f tiles/s  (%llu drawn)\n", levels, read, read / seconds,
+              static_cast<unsigned long long>(reader->stats().rendered));
+  removeAll(directory);
+
+  std::printf("peak memory %.1f MB, %.1f MB above the generated SVG\n", peakMegabytes(), peakMegabytes() - baseline);
+  return 0;
+}
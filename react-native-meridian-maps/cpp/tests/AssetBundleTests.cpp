@@ -0,0 +1,258 @@
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "AssetBundle.h"
+#include "Json.h"
+#include "PlacemarkStore.h"
+#include "PlacemarkSync.h"
+#include "StandInHttpServer.h"
+#include "TestHarness.h"
+
+using namespace meridianmaps;
+using namespace meridianmaps::testing;
+
+namespace {
+
+std::string tempPath(const char* name) {
+  return "/tmp/mm_bundle_" + std::to_string(::getpid()) + "_" + name;
+}
+
+std::unique_ptr<AssetBundle> writeAndOpen(const std::string& bytes, const char* name, std::string* error = nullptr) {
+  const std::string path = tempPath(name);
+  if (!writeFileAtomically(path, bytes, error)) {
+    return nullptr;
+  }
+  std::unique_ptr<AssetBundle> bundle = AssetBundle::open(path, error);
+  std::remove(path.c_str());
+  return bundle;
+}
+
+std::string readAsset(const AssetBundle& bundle, std::string_view key) {
+  const AssetBundle::Entry* entry = bundle.find(key);
+  std::string bytes;
+  if (!entry || !bundle.read(*entry, &bytes)) {
+    return "<missing>";
+  }
+  return bytes;
+}
+
+std::string floorSvg(int rooms) {
+  std::string svg = "<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"0 0 1000 1000\">";
+  for (int i = 0; i < rooms; ++i) {
+    svg += "<rect id=\"room-" + std::to_string(i) + "\" x=\"" + std::to_string(i * 10) +
+           "\" y=\"10\" width=\"8\" height=\"8\" fill=\"#e0e0e0\"/>";
+  }
+  return svg + "</svg>";
+}
+
+std::string placemarkPage(const std::string& mapId, int first, int count, const std::string& next) {
+  std::string body = "{\"results\": [";
+  for (int i = first; i < first + count; ++i) {
+    if (i > first) {
+      body += ",";
+    }
+    body += "{\"id\": \"" + mapId + "-" + std::to_string(i) + "\", \"name\": \"Room " + std::to_string(i) +
+            "\", \"type\": \"room\", \"x\": " + std::to_string(i * 10) + ", \"y\": 10}";
+  }
+  body += "], \"deleted\": [], \"cursor\": \"c" + std::to_string(first + count) + "\", \"next\": ";
+  return body + (next.empty() ? "null" : "\"" + next + "\"") + "}";
+}
+
+}  // namespace
+
+TEST(roundTripsCompressedAndStoredAssets) {
+  // Random-looking bytes do not deflate and are stored as they are
+  std::string noise;
+  uint32_t state = 7;
+  for (int i = 0; i < 4096; ++i) {
+    state = state * 1103515245u + 12345u;
+    noise.push_back(static_cast<char>(state >> 24));
+  }
+  const std::string svg = floorSvg(200);
+  std::string error;
+  std::unique_ptr<AssetBundle> bundle = writeAndOpen(
+      AssetBundle::serialize({{"https://venue/maps/1.svg", "image/svg+xml", svg},
+                              {"https://venue/maps/2.png", "image/png", noise},
+                              {"https://venue/empty", "text/plain", ""}}),
+      "roundtrip", &error);
+  ASSERT_TRUE(bundle != nullptr);
+  EXPECT_EQ(bundle->entries().size(), size_t(3));
+
+  const AssetBundle::Entry* svgEntry = bundle->find("https://venue/maps/1.svg");
+  ASSERT_TRUE(svgEntry != nullptr);
+  EXPECT_TRUE(svgEntry->compressed);
+  EXPECT_TRUE(svgEntry->storedLength < svg.size() / 4);
+  EXPECT_TRUE(svgEntry->contentType == "image/svg+xml");
+  EXPECT_TRUE(!bundle->find("https://venue/maps/2.png")->compressed);
+
+  EXPECT_TRUE(readAsset(*bundle, "https://venue/maps/1.svg") == svg);
+  EXPECT_TRUE(readAsset(*bundle, "https://venue/maps/2.png") == noise);
+  EXPECT_TRUE(readAsset(*bundle, "https://venue/empty").empty());
+  EXPECT_TRUE(bundle->find("https://venue/maps/3.svg") == nullptr);
+  EXPECT_EQ(bundle->stats().served, uint64_t(3));
+  EXPECT_EQ(bundle->stats().bytesServed, uint64_t(svg.size() + noise.size()));
+}
+
+TEST(laterAssetReplacesEarlierWithSameKey) {
+  std::unique_ptr<AssetBundle> bundle =
+      writeAndOpen(AssetBundle::serialize({{"b", "", "old"}, {"a", "", "first"}, {"b", "", "new"}}), "dupes");
+  ASSERT_TRUE(bundle != nullptr);
+  EXPECT_EQ(bundle->entries().size(), size_t(2));
+  EXPECT_TRUE(readAsset(*bundle, "b") == "new");
+}
+
+TEST(urlLookupFallsBackToUrlWithoutQuery) {
+  std::unique_ptr<AssetBundle> bundle = writeAndOpen(
+      AssetBundle::serialize({{"https://venue/maps/1.svg", "image/svg+xml", "<svg/>"},
+                              {"https://venue/maps/1/placemarks?page_size=500", "application/json", "{}"}}),
+      "urls");
+  ASSERT_TRUE(bundle != nullptr);
+  EXPECT_TRUE(bundle->findUrl("https://venue/maps/1.svg?signature=abc") != nullptr);
+  EXPECT_TRUE(bundle->findUrl("https://venue/maps/1.svg#layer") != nullptr);
+  EXPECT_TRUE(bundle->findUrl("https://venue/maps/1/placemarks?page_size=500") != nullptr);
+  EXPECT_TRUE(bundle->findUrl("https://venue/maps/1/placemarks?page_size=100") == nullptr);
+  EXPECT_TRUE(bundle->findUrl("https://venue/maps/2.svg") == nullptr);
+  EXPECT_EQ(bundle->stats().served, uint64_t(0));
+
+  const HttpResponse hit = bundle->fetch({"https://venue/maps/1.svg", ""});
+  EXPECT_EQ(hit.status, 200);
+  EXPECT_TRUE(hit.body == "<svg/>");
+  const HttpResponse miss = bundle->fetch({"https://venue/maps/2.svg", ""});
+  EXPECT_EQ(miss.status, 0);
+  EXPECT_TRUE(!miss.error.empty());
+  EXPECT_EQ(bundle->stats().served, uint64_t(1));
+}
+
+TEST(rejectsCorruptBundles) {
+  const std::string bytes = AssetBundle::serialize({{"https://venue/maps/1.svg", "image/svg+xml", floorSvg(50)}});
+  std::string error;
+
+  EXPECT_TRUE(writeAndOpen(bytes.substr(0, 20), "short", &error) == nullptr);
+  EXPECT_TRUE(error.find("truncated") != std::string::npos);
+
+  std::string magic = bytes;
+  magic[0] = 'X';
+  EXPECT_TRUE(writeAndOpen(magic, "magic", &error) == nullptr);
+  EXPECT_TRUE(error.find("not an asset bundle") != std::string::npos);
+
+  std::string version = bytes;
+  version[4] = 9;
+  EXPECT_TRUE(writeAndOpen(version, "version", &error) == nullptr);
+
+  // The index points past the end of a cut-off file
+  EXPECT_TRUE(writeAndOpen(bytes.substr(0, bytes.size() - 8), "cut", &error) == nullptr);
+  EXPECT_TRUE(error.find("out of bounds") != std::string::npos);
+
+  // A flipped byte in the deflated payload fails to inflate or fails its CRC
+  std::string flipped = bytes;
+  flipped[flipped.size() - 12] ^= 0x5A;
+  std::unique_ptr<AssetBundle> bundle = writeAndOpen(flipped, "flipped", &error);
+  ASSERT_TRUE(bundle != nullptr);
+  std::string out;
+  EXPECT_TRUE(!bundle->read(*bundle->find("https://venue/maps/1.svg"), &out, &error));
+  EXPECT_EQ(bundle->stats().failures, uint64_t(1));
+}
+
+TEST(seedsPlacemarkStoreOffline) {
+  const std::string base = "https://venue/api";
+  std::unique_ptr<AssetBundle> bundle = writeAndOpen(
+      AssetBundle::serialize({
+          {base + "/maps", "application/json", "{\"results\": [{\"id\": \"L1\"}, {\"id\": \"L2\"}]}"},
+          {base + "/maps/L1/placemarks?page_size=500", "application/json",
+           placemarkPage("L1", 0, 3, "/api/maps/L1/placemarks?page_size=500&page=2")},
+          {base + "/maps/L1/placemarks?page_size=500&page=2", "application/json", placemarkPage("L1", 3, 2, "")},
+          {base + "/maps/L2/placemarks?page_size=500", "application/json", placemarkPage("L2", 0, 4, "")},
+      }),
+      "seed");
+  ASSERT_TRUE(bundle != nullptr);
+
+  PlacemarkStore store;
+  SyncManifest manifest;
+  SyncStats stats;
+  PlacemarkSync::Options options;
+  options.baseUrl = base;
+  PlacemarkSync sync(options, [&bundle](const HttpRequest& request) { return bundle->fetch(request); });
+  std::string error;
+  EXPECT_TRUE(sync.run(manifest, [&store](const PlacemarkDiff& diff) { diff.applyTo(store); }, &stats, &error));
+  EXPECT_EQ(store.size(), uint32_t(9));
+  EXPECT_EQ(stats.requests, uint32_t(4));
+  // Cursors from the pack let the first online sync ask only for what changed since
+  EXPECT_TRUE(manifest.maps["L1"].cursor == "c5");
+}
+
+#ifdef MERIDIANMAPS_NODE
+TEST(packsVenueFromStandInServer) {
+  const std::string svg = floorSvg(300);
+  const std::string png = "\x89PNG\r\n\x1a\n raster floor";
+  StandInHttpServer server([&](const StandInRequest& request) {
+    const std::string& target = request.target;
+    if (target == "/api/maps") {
+      return HttpResponse{200,
+                          "{\"results\": [{\"id\": \"L1\", \"svg_url\": \"/floors/L1.svg\"},"
+                          " {\"id\": \"L2\", \"image_url\": \"/floors/L2.png\"}]}",
+                          "", ""};
+    }
+    if (target == "/floors/L1.svg") {
+      return HttpResponse{200, svg, "", ""};
+    }
+    if (target == "/floors/L2.png") {
+      return HttpResponse{200, png, "", ""};
+    }
+    if (target == "/api/maps/L1/placemarks?page_size=2") {
+      return HttpResponse{200, placemarkPage("L1", 0, 2, "/api/maps/L1/placemarks?page_size=2&page=2"), "", ""};
+    }
+    if (target == "/api/maps/L1/placemarks?page_size=2&page=2") {
+      return HttpResponse{200, placemarkPage("L1", 2, 1, ""), "", ""};
+    }
+    if (target == "/api/maps/L2/placemarks?page_size=2") {
+      return HttpResponse{200, placemarkPage("L2", 0, 2, ""), "", ""};
+    }
+    if (target == "/api/maps/L1/routes") {
+      return HttpResponse{200, "{\"nodes\": [], \"edges\": []}", "", ""};
+    }
+    return HttpResponse{404, "{}", "", ""};
+  });
+
+  const std::string out = tempPath("venue.mmab");
+  const std::string command = std::string(MERIDIANMAPS_NODE) + " " + MERIDIANMAPS_PACKER + " --url " +
+                              server.baseUrl() + "/api --app APP --out " + out + " --page-size 2 > /dev/null";
+  ASSERT_TRUE(std::system(command.c_str()) == 0);
+
+  std::string error;
+  std::unique_ptr<AssetBundle> bundle = AssetBundle::open(out, &error);
+  std::remove(out.c_str());
+  ASSERT_TRUE(bundle != nullptr);
+
+  const std::string base = server.baseUrl();
+  EXPECT_TRUE(readAsset(*bundle, base + "/floors/L1.svg") == svg);
+  EXPECT_TRUE(readAsset(*bundle, base + "/floors/L2.png") == png);
+  EXPECT_TRUE(bundle->find(base + "/floors/L1.svg")->compressed);
+  EXPECT_TRUE(bundle->find(base + "/floors/L1.svg")->contentType == "image/svg+xml");
+  EXPECT_TRUE(bundle->find(base + "/api/maps/L1/routes") != nullptr);
+  EXPECT_TRUE(bundle->find(base + "/api/maps/L2/routes") == nullptr);
+
+  const std::string manifestBytes = readAsset(*bundle, AssetBundle::kManifestKey);
+  const JsonValue manifest = JsonValue::parse(manifestBytes, &error);
+  ASSERT_TRUE(manifest.isObject());
+  EXPECT_TRUE(manifest["appId"].string() == "APP");
+  EXPECT_TRUE(manifest["baseUrl"].string() == base + "/api");
+  EXPECT_EQ(manifest["maps"].items().size(), size_t(2));
+
+  // The bundle alone now answers a sync with the packed page size
+  PlacemarkStore store;
+  SyncManifest syncManifest;
+  SyncStats stats;
+  PlacemarkSync::Options options;
+  options.baseUrl = base + "/api";
+  options.pageSize = 2;
+  PlacemarkSync sync(options, [&bundle](const HttpRequest& request) { return bundle->fetch(request); });
+  EXPECT_TRUE(sync.run(syncManifest, [&store](const PlacemarkDiff& diff) { diff.applyTo(store); }, &stats, &error));
+  EXPECT_EQ(store.size(), uint32_t(5));
+}
+#endif
+
+TEST_MAIN()
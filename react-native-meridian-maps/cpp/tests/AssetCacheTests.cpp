@@ -0,0 +1,312 @@
+#include <dirent.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "AssetCache.h"
+#include "MappedFile.h"
+#include "StandInHttpServer.h"
+#include "TestHarness.h"
+
+using namespace meridianmaps;
+using namespace meridianmaps::testing;
+
+namespace {
+
+// A fresh cache directory, removed with everything in it when the test ends
+class TempDirectory {
+ public:
+  explicit TempDirectory(const char* name)
+      : path_("/tmp/mm_cache_" + std::to_string(::getpid()) + "_" + name) {
+    removeAll();
+  }
+  ~TempDirectory() { removeAll(); }
+
+  const std::string& path() const { return path_; }
+
+  std::vector<std::string> files() const {
+    std::vector<std::string> names;
+    if (DIR* dir = ::opendir(path_.c_str())) {
+      while (dirent* item = ::readdir(dir)) {
+        const std::string name = item->d_name;
+        if (name != "." && name != "..") {
+          names.push_back(name);
+        }
+      }
+      ::closedir(dir);
+    }
+    return names;
+  }
+
+ private:
+  void removeAll() const {
+    for (const std::string& name : files()) {
+      std::remove((path_ + "/" + name).c_str());
+    }
+    ::rmdir(path_.c_str());
+  }
+
+  std::string path_;
+};
+
+std::string asset(char fill, size_t length) {
+  return std::string(length, fill);
+}
+
+std::string cached(AssetCache& cache, const std::string& url) {
+  std::string bytes;
+  return cache.get(url, &bytes) ? bytes : "<missing>";
+}
+
+}  // namespace
+
+TEST(storesAndServesAssets) {
+  TempDirectory directory("roundtrip");
+  AssetCache cache(directory.path(), 1 << 20);
+  std::string error;
+  ASSERT_TRUE(cache.open(&error));
+  EXPECT_TRUE(cache.put("https://venue/maps/1.svg", "image/svg+xml", "<svg/>", &error));
+
+  std::string bytes;
+  std::string contentType;
+  EXPECT_TRUE(cache.get("https://venue/maps/1.svg", &bytes, &contentType));
+  EXPECT_EQ(bytes, std::string("<svg/>"));
+  EXPECT_EQ(contentType, std::string("image/svg+xml"));
+  EXPECT_TRUE(!cache.get("https://venue/maps/2.svg", &bytes));
+  // Empty bodies carry nothing worth caching
+  EXPECT_TRUE(!cache.put("https://venue/empty", "text/plain", ""));
+
+  const AssetCacheStats stats = cache.stats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.bytesServed, 6u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.stores, 1u);
+  EXPECT_EQ(cache.byteSize(), 6u);
+}
+
+TEST(evictsLeastRecentlyUsedFirst) {
+  TempDirectory directory("lru");
+  AssetCache cache(directory.path(), 300);
+  ASSERT_TRUE(cache.open());
+  cache.put("a", "", asset('a', 100));
+  cache.put("b", "", asset('b', 100));
+  cache.put("c", "", asset('c', 100));
+  // Reading a makes b the least recently used
+  EXPECT_EQ(cached(cache, "a"), asset('a', 100));
+  cache.put("d", "", asset('d', 100));
+
+  EXPECT_TRUE(cache.contains("a"));
+  EXPECT_TRUE(!cache.contains("b"));
+  EXPECT_TRUE(cache.contains("c"));
+  EXPECT_TRUE(cache.contains("d"));
+  EXPECT_EQ(cache.byteSize(), 300u);
+  EXPECT_EQ(cache.stats().evictions, 1u);
+  EXPECT_EQ(cache.stats().bytesEvicted, 100u);
+
+  // Shrinking the budget evicts at once, oldest first
+  cache.setMaxBytes(150);
+  EXPECT_EQ(cache.size(), 1u);
+  EXPECT_TRUE(cache.contains("d"));
+  // Larger than the whole budget: refused, nothing else evicted for it
+  EXPECT_TRUE(!cache.put("e", "", asset('e', 200)));
+  EXPECT_TRUE(cache.contains("d"));
+  // One file per stored asset, plus the index
+  EXPECT_EQ(directory.files().size(), 2u);
+}
+
+TEST(sharesFilesBetweenUrlsWithTheSameBytes) {
+  TempDirectory directory("dedup");
+  AssetCache cache(directory.path(), 250);
+  ASSERT_TRUE(cache.open());
+  const std::string icon = asset('i', 100);
+  cache.put("https://venue/placemarks/1/icon.png", "image/png", icon);
+  cache.put("https://venue/placemarks/2/icon.png", "image/png", icon);
+  cache.put("https://venue/placemarks/3/icon.png", "image/png", icon);
+
+  EXPECT_EQ(cache.size(), 3u);
+  EXPECT_EQ(cache.byteSize(), 100u);
+  EXPECT_EQ(cache.stats().dedupStores, 2u);
+  EXPECT_EQ(directory.files().size(), 2u);
+
+  // The file stays until the last URL sharing it goes
+  cache.remove("https://venue/placemarks/1/icon.png");
+  cache.remove("https://venue/placemarks/2/icon.png");
+  EXPECT_EQ(cached(cache, "https://venue/placemarks/3/icon.png"), icon);
+  cache.remove("https://venue/placemarks/3/icon.png");
+  EXPECT_EQ(cache.byteSize(), 0u);
+  EXPECT_EQ(directory.files().size(), 1u);
+
+  // Replacing a URL's bytes releases its old file
+  cache.put("https://venue/maps/1.svg", "image/svg+xml", asset('1', 50));
+  cache.put("https://venue/maps/1.svg", "image/svg+xml", asset('2', 60));
+  EXPECT_EQ(cache.byteSize(), 60u);
+  EXPECT_EQ(cached(cache, "https://venue/maps/1.svg"), asset('2', 60));
+  EXPECT_EQ(directory.files().size(), 2u);
+}
+
+TEST(persistsContentsAndRecencyAcrossOpens) {
+  TempDirectory directory("persist");
+  {
+    AssetCache cache(directory.path(), 300);
+    ASSERT_TRUE(cache.open());
+    cache.put("a", "image/png", asset('a', 100));
+    cache.put("b", "image/png", asset('b', 100));
+    cache.put("c", "image/png", asset('c', 100));
+    cached(cache, "a");
+    std::string error;
+    EXPECT_TRUE(cache.flush(&error));
+  }
+
+  AssetCache cache(directory.path(), 300);
+  ASSERT_TRUE(cache.open());
+  EXPECT_EQ(cache.size(), 3u);
+  EXPECT_EQ(cache.byteSize(), 300u);
+  std::string contentType;
+  std::string bytes;
+  EXPECT_TRUE(cache.get("c", &bytes, &contentType));
+  EXPECT_EQ(contentType, std::string("image/png"));
+  // a was read before the flush, so b is now the oldest
+  cache.put("d", "", asset('d', 100));
+  EXPECT_TRUE(!cache.contains("b"));
+  EXPECT_TRUE(cache.contains("a"));
+
+  // A smaller budget on reopen trims the cache to it
+  AssetCache smaller(directory.path(), 100);
+  ASSERT_TRUE(smaller.open());
+  EXPECT_EQ(smaller.size(), 1u);
+  EXPECT_TRUE(smaller.contains("d"));
+}
+
+TEST(recoversFromMissingAndStrayFiles) {
+  TempDirectory directory("recover");
+  {
+    AssetCache cache(directory.path(), 1000);
+    ASSERT_TRUE(cache.open());
+    cache.put("a", "", asset('a', 10));
+    cache.put("b", "", asset('b', 20));
+  }
+  // A file written before a crash that never made the index, and one lost
+  EXPECT_TRUE(writeFileAtomically(directory.path() + "/0000000000000000-5", "stray"));
+  for (const std::string& name : directory.files()) {
+    if (name.size() > 3 && name.compare(name.size() - 3, 3, "-14") == 0) {
+      std::remove((directory.path() + "/" + name).c_str());
+    }
+  }
+
+  AssetCache cache(directory.path(), 1000);
+  ASSERT_TRUE(cache.open());
+  EXPECT_TRUE(cache.contains("a"));
+  EXPECT_TRUE(!cache.contains("b"));
+  EXPECT_EQ(cache.byteSize(), 10u);
+  EXPECT_EQ(directory.files().size(), 2u);
+
+  // A corrupt index starts empty and clears what it can no longer account for
+  EXPECT_TRUE(writeFileAtomically(directory.path() + "/index", "garbage"));
+  AssetCache reset(directory.path(), 1000);
+  ASSERT_TRUE(reset.open());
+  EXPECT_EQ(reset.size(), 0u);
+  EXPECT_EQ(directory.files().size(), 1u);
+}
+
+// A visitor opens the same venue's floors several times a day. Every floor
+// SVG and image comes from a stand-in asset server; after the first visit
+// they should all come from disk, and later visits should not touch the
+// network at all while the venue fits the budget.
+TEST(repeatedVenueVisitsAreServedFromDisk) {
+  constexpr int kFloors = 6;
+  std::vector<std::string> svgs;
+  for (int floor = 0; floor < kFloors; ++floor) {
+    std::string svg = "<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"0 0 1000 1000\">";
+    for (int room = 0; room < 400; ++room) {
+      svg += "<rect id=\"f" + std::to_string(floor) + "-r" + std::to_string(room) + "\" x=\"" +
+             std::to_string(room * 2) + "\" y=\"" + std::to_string(floor * 10) + "\" width=\"8\" height=\"8\"/>";
+    }
+    svgs.push_back(svg + "</svg>");
+  }
+  // Every placemark of a type shares one icon
+  const std::string icon = asset('p', 2048);
+
+  std::atomic<int> requests{0};
+  std::atomic<uint64_t> bytesSent{0};
+  StandInHttpServer server([&](const StandInRequest& request) {
+    requests++;
+    HttpResponse response;
+    int floor = -1;
+    int placemark = -1;
+    if (std::sscanf(request.target.c_str(), "/maps/%d.svg", &floor) == 1 && floor >= 0 && floor < kFloors) {
+      response.status = 200;
+      response.body = svgs[floor];
+    } else if (std::sscanf(request.target.c_str(), "/placemarks/%d/icon.png", &placemark) == 1) {
+      response.status = 200;
+      response.body = icon;
+    } else {
+      response.status = 404;
+    }
+    bytesSent += response.body.size();
+    return response;
+  });
+
+  std::vector<std::string> urls;
+  for (int floor = 0; floor < kFloors; ++floor) {
+    urls.push_back(server.baseUrl() + "/maps/" + std::to_string(floor) + ".svg");
+    for (int placemark = 0; placemark < 10; ++placemark) {
+      urls.push_back(server.baseUrl() + "/placemarks/" + std::to_string(floor * 10 + placemark) + "/icon.png");
+    }
+  }
+  urls.push_back(server.baseUrl() + "/maps/missing.svg");
+
+  TempDirectory directory("visits");
+  AssetCache cache(directory.path(), 4 << 20);
+  ASSERT_TRUE(cache.open());
+  uint64_t bytesLoaded = 0;
+  int failures = 0;
+  constexpr int kVisits = 5;
+  for (int visit = 0; visit < kVisits; ++visit) {
+    for (const std::string& url : urls) {
+      const HttpResponse response = cache.fetch({url, ""}, standInFetch);
+      if (response.status == 200) {
+        bytesLoaded += response.body.size();
+      } else {
+        failures++;
+      }
+    }
+  }
+  EXPECT_EQ(failures, kVisits);
+
+  const AssetCacheStats stats = cache.stats();
+  // Only the first visit and the URL the server 404s reach the network
+  const int firstVisit = static_cast<int>(urls.size());
+  EXPECT_EQ(requests.load(), firstVisit + kVisits - 1);
+  EXPECT_EQ(stats.hits, static_cast<uint64_t>((kVisits - 1) * (urls.size() - 1)));
+  EXPECT_EQ(stats.bytesServed + bytesSent.load(), bytesLoaded);
+  // Sixty placemark URLs, one icon on disk
+  EXPECT_EQ(stats.dedupStores, 59u);
+
+  uint64_t svgBytes = 0;
+  for (const std::string& svg : svgs) {
+    svgBytes += svg.size();
+  }
+  EXPECT_EQ(cache.byteSize(), svgBytes + icon.size());
+
+  const double hitRate = static_cast<double>(stats.hits) / static_cast<double>(stats.hits + stats.misses);
+  std::printf("  %d visits, hit rate %.1f%%, %llu of %llu bytes served from disk (%llu on disk)\n", kVisits,
+              hitRate * 100.0, static_cast<unsigned long long>(stats.bytesServed),
+              static_cast<unsigned long long>(bytesLoaded), static_cast<unsigned long long>(cache.byteSize()));
+
+  // With a budget smaller than the venue, the oldest floors churn but the
+  // requests the cache cannot answer still reach the network
+  cache.setMaxBytes(svgBytes / 2);
+  const int before = requests.load();
+  for (const std::string& url : urls) {
+    if (url.find("missing") == std::string::npos) {
+      EXPECT_EQ(cache.fetch({url, ""}, standInFetch).status, 200);
+    }
+  }
+  EXPECT_TRUE(requests.load() > before);
+  EXPECT_TRUE(cache.byteSize() <= svgBytes / 2);
+}
+
+TEST_MAIN()
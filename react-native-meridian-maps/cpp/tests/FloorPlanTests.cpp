@@ -0,0 +1,173 @@
+#include <string>
+#include <vector>
+
+#include "FloorPlan.h"
+#include "TestHarness.h"
+
+using namespace meridianmaps;
+using namespace meridianmaps::testing;
+
+namespace {
+
+std::unique_ptr<FloorPlan> parse(const std::string& body, const char* viewBox = "0 0 100 100") {
+  std::string error;
+  std::unique_ptr<FloorPlan> plan = FloorPlan::parse(
+      std::string("<?xml version=\"1.0\"?>\n<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"") + viewBox + "\">" +
+          body + "</svg>",
+      0.05f, &error);
+  if (!plan) {
+    std::printf("  parse failed: %s\n", error.c_str());
+  }
+  return plan;
+}
+
+bool near(float actual, float expected, float tolerance = 0.06f) {
+  return actual > expected - tolerance && actual < expected + tolerance;
+}
+
+bool boundsNear(const Rect& bounds, float minX, float minY, float maxX, float maxY, float tolerance = 0.06f) {
+  return near(bounds.minX, minX, tolerance) && near(bounds.minY, minY, tolerance) &&
+         near(bounds.maxX, maxX, tolerance) && near(bounds.maxY, maxY, tolerance);
+}
+
+}  // namespace
+
+TEST(parsesShapesIntoDisplayItems) {
+  auto plan = parse(
+      "<rect x=\"10\" y=\"20\" width=\"30\" height=\"40\" fill=\"#ff0000\"/>"
+      "<circle cx=\"50\" cy=\"50\" r=\"10\" fill=\"blue\" stroke=\"black\" stroke-width=\"2\"/>"
+      "<line x1=\"0\" y1=\"0\" x2=\"100\" y2=\"0\" stroke=\"#0f0\"/>"
+      "<polygon points=\"0,0 10,0 10,10\" fill=\"rgb(0, 128, 255)\"/>");
+  ASSERT_TRUE(plan != nullptr);
+  EXPECT_TRUE(boundsNear(plan->bounds(), 0, 0, 100, 100));
+  EXPECT_EQ(plan->elementCount(), 4u);
+  // The circle has a fill and a stroke item; the line has only a stroke
+  ASSERT_TRUE(plan->size() == 5u);
+
+  EXPECT_TRUE(boundsNear(plan->item(0).bounds, 10, 20, 40, 60));
+  EXPECT_EQ(plan->item(0).color, 0xFFFF0000u);
+  EXPECT_EQ(plan->item(0).contourCount, 1u);
+  EXPECT_EQ(plan->contour(plan->item(0).firstContour).count, 4u);
+
+  EXPECT_TRUE(boundsNear(plan->item(1).bounds, 40, 40, 60, 60));
+  EXPECT_EQ(plan->item(1).color, 0xFF0000FFu);
+  EXPECT_TRUE(boundsNear(plan->item(2).bounds, 39, 39, 61, 61, 0.1f));
+  EXPECT_EQ(plan->item(2).color, 0xFF000000u);
+
+  // A one-unit stroke reaches half a unit past both ends of the line
+  EXPECT_TRUE(boundsNear(plan->item(3).bounds, -0.5f, -0.5f, 100.5f, 0.5f));
+  EXPECT_EQ(plan->item(3).color, 0xFF00FF00u);
+  EXPECT_EQ(plan->item(4).color, 0xFF0080FFu);
+}
+
+TEST(resolvesTransformsAndInheritedStyles) {
+  auto plan = parse(
+      "<g transform=\"translate(10 20) scale(2)\" fill=\"#123456\" opacity=\"0.5\">"
+      "  <rect width=\"5\" height=\"5\"/>"
+      "  <g style=\"fill: white; fill-opacity: 0.5\">"
+      "    <rect x=\"1\" y=\"1\" width=\"1\" height=\"1\" transform=\"rotate(90)\"/>"
+      "  </g>"
+      "</g>"
+      "<rect width=\"1\" height=\"1\"/>");
+  ASSERT_TRUE(plan != nullptr);
+  ASSERT_TRUE(plan->size() == 3u);
+  EXPECT_TRUE(boundsNear(plan->item(0).bounds, 10, 20, 20, 30));
+  EXPECT_EQ(plan->item(0).color, 0x80123456u);
+  // rotate(90) maps (1, 1)-(2, 2) to (-2, 1)-(-1, 2), then the group's transform applies
+  EXPECT_TRUE(boundsNear(plan->item(1).bounds, 6, 22, 8, 24));
+  EXPECT_EQ(plan->item(1).color, 0x40FFFFFFu);
+  // Styles do not leak out of the group
+  EXPECT_EQ(plan->item(2).color, 0xFF000000u);
+}
+
+TEST(parsesEveryPathCommand) {
+  auto plan = parse(
+      "<path d=\"M10 10 h20 v20 H10 Z\"/>"
+      "<path d=\"m50,50 l10-10 10,10z\"/>"
+      "<path d=\"M0 80 C0 70 10 70 10 80 S20 90 20 80 Q25 70 30 80 T40 80 Z\"/>"
+      "<path d=\"M60 80 A10 10 0 1 1 80 80 A10 10 0 1 1 60 80\" fill-rule=\"evenodd\"/>"
+      "<path d=\"M0 0 L1.5.5-2e1 10\"/>");
+  ASSERT_TRUE(plan != nullptr);
+  ASSERT_TRUE(plan->size() == 5u);
+  EXPECT_TRUE(boundsNear(plan->item(0).bounds, 10, 10, 30, 30));
+  EXPECT_TRUE(boundsNear(plan->item(1).bounds, 50, 40, 70, 50));
+  // The cubic's bulges stay within its control points
+  EXPECT_TRUE(plan->item(2).bounds.minY > 69 && plan->item(2).bounds.maxY < 91);
+  EXPECT_TRUE(near(plan->item(2).bounds.minX, 0) && near(plan->item(2).bounds.maxX, 40));
+  // Two half circles make a circle of radius 10 around (70, 80)
+  EXPECT_TRUE(boundsNear(plan->item(3).bounds, 60, 70, 80, 90, 0.1f));
+  EXPECT_TRUE(plan->item(3).evenOdd);
+  EXPECT_TRUE(plan->contour(plan->item(3).firstContour).count > 16);
+  // Numbers run together as "1.5", ".5", "-2e1"
+  EXPECT_TRUE(boundsNear(plan->item(4).bounds, -20, 0, 1.5f, 10));
+}
+
+TEST(skipsContentThatIsNotDrawn) {
+  auto plan = parse(
+      "<defs><rect width=\"10\" height=\"10\"/></defs>"
+      "<text x=\"5\" y=\"5\">Room 101</text>"
+      "<g display=\"none\"><rect width=\"10\" height=\"10\"/></g>"
+      "<rect width=\"10\" height=\"10\" fill=\"none\"/>"
+      "<rect width=\"10\" height=\"10\" visibility=\"hidden\"/>"
+      "<rect width=\"0\" height=\"10\"/>"
+      "<!-- <rect width=\"10\" height=\"10\"/> -->"
+      "<rect width=\"10\" height=\"10\" fill=\"url(#gradient)\"/>"
+      "<rect width=\"10\" height=\"10\" fill=\"url(#gradient) #00ff00\"/>");
+  ASSERT_TRUE(plan != nullptr);
+  ASSERT_TRUE(plan->size() == 1u);
+  EXPECT_EQ(plan->item(0).color, 0xFF00FF00u);
+}
+
+TEST(rejectsMalformedDocuments) {
+  std::string error;
+  EXPECT_TRUE(FloorPlan::parse("<html></html>", 0.25f, &error) == nullptr);
+  EXPECT_TRUE(error.find("not <svg>") != std::string::npos);
+  EXPECT_TRUE(FloorPlan::parse("<svg><g></svg>", 0.25f, &error) == nullptr);
+  EXPECT_TRUE(error.find("mismatched") != std::string::npos);
+  EXPECT_TRUE(FloorPlan::parse("<svg><rect width=\"1></svg>", 0.25f, &error) == nullptr);
+  EXPECT_TRUE(FloorPlan::parse("<svg>", 0.25f, &error) == nullptr);
+  EXPECT_TRUE(FloorPlan::parse("", 0.25f, &error) == nullptr);
+
+  // Without a viewBox the size comes from width and height, else the content
+  auto sized = FloorPlan::parse("<svg width=\"640px\" height=\"480\"></svg>");
+  ASSERT_TRUE(sized != nullptr);
+  EXPECT_TRUE(boundsNear(sized->bounds(), 0, 0, 640, 480));
+  auto fitted = FloorPlan::parse("<svg><rect x=\"5\" y=\"6\" width=\"7\" height=\"8\"/></svg>");
+  ASSERT_TRUE(fitted != nullptr);
+  EXPECT_TRUE(boundsNear(fitted->bounds(), 5, 6, 12, 14));
+}
+
+TEST(queriesItemsInPaintOrder) {
+  std::string body;
+  for (int i = 0; i < 100; ++i) {
+    const int x = (i % 10) * 10;
+    const int y = (i / 10) * 10;
+    body += "<rect x=\"" + std::to_string(x) + "\" y=\"" + std::to_string(y) + "\" width=\"8\" height=\"8\"/>";
+  }
+  // Covers everything and is painted last
+  body += "<rect width=\"100\" height=\"100\" fill-opacity=\"0.1\"/>";
+  auto plan = parse(body);
+  ASSERT_TRUE(plan != nullptr);
+  ASSERT_TRUE(plan->size() == 101u);
+
+  std::vector<uint32_t> items;
+  plan->query({21, 21, 29, 29}, items);
+  ASSERT_TRUE(items.size() == 2u);
+  EXPECT_EQ(items[0], 22u);
+  EXPECT_EQ(items[1], 100u);
+
+  items.clear();
+  plan->query({0, 0, 100, 100}, items);
+  EXPECT_EQ(items.size(), 101u);
+  bool ordered = true;
+  for (size_t i = 0; i < items.size(); ++i) {
+    ordered = ordered && items[i] == i;
+  }
+  EXPECT_TRUE(ordered);
+
+  items.clear();
+  plan->query({200, 200, 300, 300}, items);
+  EXPECT_TRUE(items.empty());
+}
+
+TEST_MAIN()
@@ -0,0 +1,224 @@
+#include <dirent.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "AssetCache.h"
+#include "FloorPrefetcher.h"
+#include "StandInHttpServer.h"
+#include "TestHarness.h"
+
+using namespace meridianmaps;
+using namespace meridianmaps::testing;
+
+namespace {
+
+// A cache in a fresh directory, removed with its files when the test ends
+class TempCache {
+ public:
+  TempCache(const char* name, uint64_t maxBytes)
+      : path_("/tmp/mm_prefetch_" + std::to_string(::getpid()) + "_" + name), cache_(path_, maxBytes) {
+    removeAll();
+    cache_.open();
+  }
+  ~TempCache() { removeAll(); }
+
+  AssetCache& cache() { return cache_; }
+
+ private:
+  void removeAll() const {
+    if (DIR* dir = ::opendir(path_.c_str())) {
+      while (dirent* item = ::readdir(dir)) {
+        const std::string name = item->d_name;
+        if (name != "." && name != "..") {
+          std::remove((path_ + "/" + name).c_str());
+        }
+      }
+      ::closedir(dir);
+    }
+    ::rmdir(path_.c_str());
+  }
+
+  std::string path_;
+  AssetCache cache_;
+};
+
+FloorPrefetcher::Floor floor(const std::string& mapId, const std::string& groupId, int level) {
+  return {mapId, groupId, level, {"https://venue/maps/" + mapId + ".svg"}};
+}
+
+// Answers every URL with a body of its own, recording what was asked for
+struct FakeNetwork {
+  HttpResponse operator()(const HttpRequest& request) {
+    requested.push_back(request.url);
+    HttpResponse response;
+    response.status = 200;
+    response.body = std::string(bodyBytes, 'x') + request.url;
+    return response;
+  }
+
+  size_t bodyBytes = 100;
+  std::vector<std::string> requested;
+};
+
+void drain(FloorPrefetcher& prefetcher, FakeNetwork& network) {
+  while (prefetcher.step(std::ref(network))) {
+  }
+}
+
+// Two buildings; the main one has levels 0 to 4
+std::vector<FloorPrefetcher::Floor> venue() {
+  return {floor("main-0", "main", 0), floor("main-1", "main", 1), floor("main-2", "main", 2),
+          floor("main-3", "main", 3), floor("main-4", "main", 4), floor("annex-2", "annex", 2)};
+}
+
+}  // namespace
+
+TEST(queuesTheFloorsAboveAndBelow) {
+  TempCache temp("neighbors", 1 << 20);
+  FloorPrefetcher prefetcher(temp.cache());
+  EXPECT_EQ(prefetcher.openFloor("main-2", venue()), 2u);
+
+  FakeNetwork network;
+  drain(prefetcher, network);
+  ASSERT_TRUE(network.requested.size() == 2);
+  EXPECT_EQ(network.requested[0], std::string("https://venue/maps/main-1.svg"));
+  EXPECT_EQ(network.requested[1], std::string("https://venue/maps/main-3.svg"));
+  EXPECT_TRUE(temp.cache().contains("https://venue/maps/main-1.svg"));
+  EXPECT_TRUE(!temp.cache().contains("https://venue/maps/annex-2.svg"));
+
+  // The top floor has only a floor below; an unknown floor has none
+  EXPECT_EQ(prefetcher.openFloor("main-4", venue()), 1u);
+  EXPECT_EQ(prefetcher.openFloor("roof", venue()), 0u);
+}
+
+TEST(fetchesRouteFloorsFirstAndOnlyOnce) {
+  TempCache temp("route", 1 << 20);
+  FloorPrefetcher prefetcher(temp.cache());
+  prefetcher.openFloor("main-2", venue());
+  // The route leaves the open floor, goes down a level and across to the annex
+  for (const char* mapId : {"main-2", "main-1", "main-0", "annex-2"}) {
+    const std::vector<FloorPrefetcher::Floor> floors = venue();
+    for (const FloorPrefetcher::Floor& candidate : floors) {
+      if (candidate.mapId == mapId) {
+        prefetcher.addRouteFloor(candidate);
+      }
+    }
+  }
+
+  FakeNetwork network;
+  drain(prefetcher, network);
+  ASSERT_TRUE(network.requested.size() == 4);
+  EXPECT_EQ(network.requested[0], std::string("https://venue/maps/main-1.svg"));
+  EXPECT_EQ(network.requested[1], std::string("https://venue/maps/main-0.svg"));
+  EXPECT_EQ(network.requested[2], std::string("https://venue/maps/annex-2.svg"));
+  EXPECT_EQ(network.requested[3], std::string("https://venue/maps/main-3.svg"));
+  EXPECT_EQ(prefetcher.stats().fetched, 4u);
+
+  // Floors already on disk are not downloaded again: main-0 is, main-2 was
+  // open and loaded by the map itself
+  prefetcher.openFloor("main-1", venue());
+  drain(prefetcher, network);
+  EXPECT_EQ(network.requested.size(), 5u);
+  EXPECT_EQ(prefetcher.stats().alreadyCached, 1u);
+}
+
+TEST(cancelsQueuedFloors) {
+  TempCache temp("cancel", 1 << 20);
+  FloorPrefetcher prefetcher(temp.cache());
+  prefetcher.openFloor("main-2", venue());
+  prefetcher.addRouteFloor(floor("main-0", "main", 0));
+  EXPECT_EQ(prefetcher.stats().queued, 3u);
+
+  FakeNetwork network;
+  EXPECT_TRUE(prefetcher.step(std::ref(network)));
+  prefetcher.cancel();
+  EXPECT_TRUE(prefetcher.idle());
+  EXPECT_TRUE(!prefetcher.step(std::ref(network)));
+  EXPECT_EQ(network.requested.size(), 1u);
+  EXPECT_EQ(prefetcher.stats().cancelled, 2u);
+
+  // Opening another floor replaces the neighbors but keeps the route
+  prefetcher.openFloor("main-2", venue());
+  prefetcher.addRouteFloor(floor("annex-2", "annex", 2));
+  prefetcher.openFloor("main-4", venue());
+  EXPECT_EQ(prefetcher.stats().queued, 2u);
+  prefetcher.clearRoute();
+  EXPECT_EQ(prefetcher.stats().queued, 1u);
+}
+
+TEST(stopsAtHalfTheCacheBudget) {
+  // Room for four floors; the plan may use two
+  TempCache temp("budget", 4 * 1024);
+  FloorPrefetcher prefetcher(temp.cache());
+  for (int level = 0; level < 6; ++level) {
+    prefetcher.addRouteFloor(floor("main-" + std::to_string(level), "main", level));
+  }
+  FakeNetwork network;
+  network.bodyBytes = 1000;
+  drain(prefetcher, network);
+
+  EXPECT_EQ(network.requested.size(), 2u);
+  const FloorPrefetchStats stats = prefetcher.stats();
+  EXPECT_EQ(stats.budgetStops, 1u);
+  EXPECT_EQ(stats.queued, 0u);
+  EXPECT_TRUE(temp.cache().byteSize() <= temp.cache().maxBytes());
+}
+
+// A visitor routes from the ground floor of a six-floor building to its top
+// floor. The route's floors download in the background while the first is
+// on screen; each floor switch along the route then loads without the
+// network.
+TEST(routeFloorTransitionsComeFromTheCache) {
+  constexpr int kLevels = 6;
+  std::atomic<int> requests{0};
+  StandInHttpServer server([&](const StandInRequest& request) {
+    requests++;
+    HttpResponse response;
+    int level = -1;
+    if (std::sscanf(request.target.c_str(), "/maps/main-%d.svg", &level) == 1) {
+      response.status = 200;
+      response.body = "<svg id=\"main-" + std::to_string(level) + "\">" + std::string(20000, ' ') + "</svg>";
+    } else {
+      response.status = 404;
+    }
+    return response;
+  });
+
+  std::vector<FloorPrefetcher::Floor> building;
+  for (int level = 0; level < kLevels; ++level) {
+    const std::string mapId = "main-" + std::to_string(level);
+    building.push_back({mapId, "main", level, {server.baseUrl() + "/maps/" + mapId + ".svg"}});
+  }
+
+  TempCache temp("transitions", 8 << 20);
+  AssetCache& cache = temp.cache();
+  FloorPrefetcher prefetcher(cache);
+  // The ground floor loads itself; its neighbor and the route follow
+  cache.fetch({building[0].urls[0], ""}, standInFetch);
+  prefetcher.openFloor("main-0", building);
+  for (const FloorPrefetcher::Floor& route : building) {
+    prefetcher.addRouteFloor(route);
+  }
+  while (prefetcher.step(standInFetch)) {
+  }
+  EXPECT_EQ(requests.load(), kLevels);
+
+  const AssetCacheStats before = cache.stats();
+  for (int level = 1; level < kLevels; ++level) {
+    prefetcher.openFloor(building[level].mapId, building);
+    const HttpResponse response = cache.fetch({building[level].urls[0], ""}, standInFetch);
+    EXPECT_EQ(response.status, 200);
+    while (prefetcher.step(standInFetch)) {
+    }
+  }
+  EXPECT_EQ(requests.load(), kLevels);
+  EXPECT_EQ(cache.stats().hits - before.hits, static_cast<uint64_t>(kLevels - 1));
+  std::printf("  %d floor transitions, %llu bytes prefetched, %d requests on the route\n", kLevels - 1,
+              static_cast<unsigned long long>(prefetcher.stats().bytesFetched), requests.load() - kLevels);
+}
+
+TEST_MAIN()
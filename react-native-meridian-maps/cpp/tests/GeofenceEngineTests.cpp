@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "GeofenceEngine.h"
+#include "TestHarness.h"
+
+using namespace meridianmaps;
+
+namespace {
+
+GeofenceRegion square(std::string id, float x, float y, float size, std::string mapKey = "floor-1") {
+  GeofenceRegion region;
+  region.id = std::move(id);
+  region.mapKey = std::move(mapKey);
+  region.polygon = {{x, y}, {x + size, y}, {x + size, y + size}, {x, y + size}};
+  return region;
+}
+
+LocationSample fix(int64_t timestampMs, double x, double y, std::string mapKey = "floor-1") {
+  LocationSample sample;
+  sample.mapKey = std::move(mapKey);
+  sample.x = x;
+  sample.y = y;
+  sample.timestampMs = timestampMs;
+  return sample;
+}
+
+std::vector<GeofenceTransition> update(GeofenceEngine& engine, const LocationSample& sample) {
+  std::vector<GeofenceTransition> transitions;
+  engine.update(sample, &transitions);
+  return transitions;
+}
+
+bool isTransition(const GeofenceTransition& transition, GeofenceTransition::Type type, const std::string& id) {
+  return transition.type == type && transition.id == id;
+}
+
+}  // namespace
+
+TEST(reportsEnterAndExitOnce) {
+  GeofenceEngine engine;
+  ASSERT_TRUE(engine.add(square("lobby", 0, 0, 10)));
+
+  EXPECT_TRUE(update(engine, fix(0, -5, 5)).empty());
+  auto transitions = update(engine, fix(1000, 5, 5));
+  ASSERT_TRUE(transitions.size() == 1);
+  EXPECT_TRUE(isTransition(transitions[0], GeofenceTransition::Type::Enter, "lobby"));
+  EXPECT_EQ(transitions[0].timestampMs, int64_t{1000});
+  // Staying inside reports nothing
+  EXPECT_TRUE(update(engine, fix(2000, 6, 5)).empty());
+  EXPECT_EQ(engine.inside().size(), size_t{1});
+
+  transitions = update(engine, fix(3000, 15, 5));
+  ASSERT_TRUE(transitions.size() == 1);
+  EXPECT_TRUE(isTransition(transitions[0], GeofenceTransition::Type::Exit, "lobby"));
+  EXPECT_TRUE(engine.inside().empty());
+}
+
+TEST(hysteresisKeepsBoundaryJitterInside) {
+  GeofenceEngine engine;
+  GeofenceRegion region = square("desk", 0, 0, 10);
+  region.hysteresis = 2;
+  ASSERT_TRUE(engine.add(region));
+
+  EXPECT_EQ(update(engine, fix(0, 9, 5)).size(), size_t{1});
+  // Jitter across the right edge within the band
+  for (int i = 1; i <= 10; ++i) {
+    EXPECT_TRUE(update(engine, fix(i * 100, i % 2 ? 11.5 : 9.5, 5)).empty());
+  }
+  const auto transitions = update(engine, fix(2000, 12.5, 5));
+  ASSERT_TRUE(transitions.size() == 1);
+  EXPECT_TRUE(isTransition(transitions[0], GeofenceTransition::Type::Exit, "desk"));
+  // Re-entering needs a fix inside the polygon itself, not just inside the band
+  EXPECT_TRUE(update(engine, fix(2100, 11, 5)).empty());
+}
+
+TEST(dwellFiresOnceAfterDwellTime) {
+  GeofenceEngine engine;
+  GeofenceRegion region = square("cafe", 0, 0, 10);
+  region.dwellMs = 5000;
+  ASSERT_TRUE(engine.add(region));
+
+  EXPECT_EQ(update(engine, fix(1000, 5, 5)).size(), size_t{1});
+  EXPECT_TRUE(update(engine, fix(5999, 5, 5)).empty());
+  auto transitions = update(engine, fix(6000, 5, 5));
+  ASSERT_TRUE(transitions.size() == 1);
+  EXPECT_TRUE(isTransition(transitions[0], GeofenceTransition::Type::Dwell, "cafe"));
+  EXPECT_TRUE(update(engine, fix(20000, 5, 5)).empty());
+
+  // Leaving resets the timer
+  EXPECT_EQ(update(engine, fix(21000, 50, 5)).size(), size_t{1});
+  EXPECT_EQ(update(engine, fix(22000, 5, 5)).size(), size_t{1});
+  EXPECT_TRUE(update(engine, fix(23000, 5, 5)).empty());
+}
+
+TEST(changingFloorExits) {
+  GeofenceEngine engine;
+  ASSERT_TRUE(engine.add(square("a", 0, 0, 10, "floor-1")));
+  ASSERT_TRUE(engine.add(square("b", 0, 0, 10, "floor-2")));
+
+  EXPECT_EQ(update(engine, fix(0, 5, 5, "floor-1")).size(), size_t{1});
+  const auto transitions = update(engine, fix(1000, 5, 5, "floor-2"));
+  ASSERT_TRUE(transitions.size() == 2);
+  // Exits come before enters
+  EXPECT_TRUE(isTransition(transitions[0], GeofenceTransition::Type::Exit, "a"));
+  EXPECT_TRUE(isTransition(transitions[1], GeofenceTransition::Type::Enter, "b"));
+}
+
+TEST(concavePolygon) {
+  GeofenceEngine engine;
+  GeofenceRegion region;
+  region.id = "ell";
+  region.mapKey = "floor-1";
+  // An L: the square (0,0)-(10,10) minus (5,5)-(10,10)
+  region.polygon = {{0, 0}, {10, 0}, {10, 5}, {5, 5}, {5, 10}, {0, 10}};
+  ASSERT_TRUE(engine.add(region));
+
+  EXPECT_TRUE(update(engine, fix(0, 7.5, 7.5)).empty());
+  EXPECT_EQ(update(engine, fix(1000, 7.5, 2.5)).size(), size_t{1});
+  EXPECT_TRUE(update(engine, fix(2000, 2.5, 7.5)).empty());
+  EXPECT_EQ(update(engine, fix(3000, 7.5, 7.5)).size(), size_t{1});
+}
+
+TEST(removeAndReplaceForgetState) {
+  GeofenceEngine engine;
+  ASSERT_TRUE(engine.add(square("a", 0, 0, 10)));
+  ASSERT_TRUE(engine.add(square("b", 100, 0, 10)));
+  ASSERT_TRUE(engine.add(square("c", 200, 0, 10)));
+  EXPECT_EQ(update(engine, fix(0, 205, 5)).size(), size_t{1});
+
+  // Removing another region moves "c" to a new slot without losing its state
+  EXPECT_TRUE(engine.remove("a"));
+  EXPECT_TRUE(!engine.remove("a"));
+  EXPECT_TRUE(update(engine, fix(1000, 205, 5)).empty());
+
+  // Removing the region the device is in does not report an exit
+  EXPECT_TRUE(engine.remove("c"));
+  EXPECT_TRUE(update(engine, fix(2000, 300, 5)).empty());
+  EXPECT_EQ(engine.size(), size_t{1});
+
+  // Replacing a region starts it over
+  EXPECT_EQ(update(engine, fix(3000, 105, 5)).size(), size_t{1});
+  ASSERT_TRUE(engine.add(square("b", 100, 0, 20)));
+  EXPECT_EQ(update(engine, fix(4000, 105, 5)).size(), size_t{1});
+}
+
+TEST(circleAroundPoint) {
+  GeofenceEngine engine;
+  GeofenceRegion region;
+  region.id = "kiosk";
+  region.mapKey = "floor-1";
+  region.polygon = circlePolygon(100, 50, 10);
+  ASSERT_TRUE(engine.add(region));
+
+  EXPECT_TRUE(update(engine, fix(0, 100, 61)).empty());
+  EXPECT_EQ(update(engine, fix(1000, 100, 59)).size(), size_t{1});
+  EXPECT_TRUE(update(engine, fix(2000, 94, 44)).empty());
+  EXPECT_EQ(update(engine, fix(3000, 89, 50)).size(), size_t{1});
+}
+
+TEST(rejectsInvalidPolygons) {
+  GeofenceEngine engine;
+  std::string error;
+  GeofenceRegion line = square("line", 0, 0, 10);
+  line.polygon.resize(2);
+  EXPECT_TRUE(!engine.add(line, &error));
+  EXPECT_TRUE(!error.empty());
+  GeofenceRegion unnamed = square("", 0, 0, 10);
+  EXPECT_TRUE(!engine.add(unnamed, &error));
+  EXPECT_EQ(engine.size(), size_t{0});
+}
+
+TEST(gridMatchesBruteForce) {
+  GeofenceEngine engine;
+  std::vector<GeofenceRegion> regions;
+  uint32_t state = 7;
+  auto next = [&state]() {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+  };
+  for (int i = 0; i < 500; ++i) {
+    // Mostly rooms, plus a few halls that span many cells
+    const float size = i % 50 == 0 ? 800.0f : 5.0f + static_cast<float>(next() % 40);
+    regions.push_back(square("r" + std::to_string(i), static_cast<float>(next() % 1000),
+                             static_cast<float>(next() % 1000), size));
+    ASSERT_TRUE(engine.add(regions.back()));
+  }
+
+  std::vector<std::string> expectedInside;
+  for (int step = 0; step < 2000; ++step) {
+    const double x = (step * 7) % 1100 + 0.5;
+    const double y = (step * 13) % 1100 + 0.5;
+    update(engine, fix(step * 100, x, y));
+
+    expectedInside.clear();
+    for (const auto& region : regions) {
+      const auto& p = region.polygon;
+      if (x > p[0].x && x < p[2].x && y > p[0].y && y < p[2].y) {
+        expectedInside.push_back(region.id);
+      }
+    }
+    auto inside = engine.inside();
+    std::sort(inside.begin(), inside.end());
+    std::sort(expectedInside.begin(), expectedInside.end());
+    ASSERT_TRUE(inside == expectedInside);
+  }
+  // The grid skipped most regions
+  EXPECT_TRUE(engine.stats().polygonTests < engine.stats().updates * 50);
+}
+
+TEST_MAIN()
@@ -0,0 +1,150 @@
+#include <cmath>
+
+#include "LocationDutyCycle.h"
+#include "TestHarness.h"
+
+using namespace meridianmaps;
+
+namespace {
+
+using State = LocationDutyCycle::State;
+
+LocationDutyCycleOptions adaptive(int64_t stillDelayMs, int64_t stillPollIntervalMs, int64_t pollTimeoutMs = 10000) {
+  LocationDutyCycleOptions options;
+  options.enabled = true;
+  options.stillDelayMs = stillDelayMs;
+  options.stillPollIntervalMs = stillPollIntervalMs;
+  options.pollTimeoutMs = pollTimeoutMs;
+  return options;
+}
+
+// Feeds 10 Hz samples from fromMs up to toMs; shaking adds a swing of 0.2 g
+bool feed(MotionDetector& detector, int64_t fromMs, int64_t toMs, bool shaking) {
+  bool changed = false;
+  for (int64_t t = fromMs; t < toMs; t += 100) {
+    const double swing = shaking ? 0.2 * std::sin(static_cast<double>(t) / 150.0) : 0.001 * ((t / 100) % 2);
+    changed |= detector.addSample(0.02, -0.03, -1.0 + swing, t);
+  }
+  return changed;
+}
+
+}  // namespace
+
+TEST(motionDetectorIgnoresGravityAndNoise) {
+  MotionDetector detector;
+  EXPECT_TRUE(detector.moving());
+  // Resting on its back: 1 g straight down plus sensor noise
+  EXPECT_TRUE(feed(detector, 0, 5000, false));
+  EXPECT_TRUE(!detector.moving());
+
+  // Picked up: moving on the first swing
+  EXPECT_TRUE(feed(detector, 5000, 5500, true));
+  EXPECT_TRUE(detector.moving());
+
+  // Set down again: still once it has been quiet for quietMs
+  feed(detector, 5500, 8000, false);
+  EXPECT_TRUE(detector.moving());
+  feed(detector, 8000, 9000, false);
+  EXPECT_TRUE(!detector.moving());
+}
+
+TEST(disabledAlwaysRuns) {
+  LocationDutyCycle cycle(0);
+  cycle.setMoving(false, 0);
+  cycle.setVisible(false, 0);
+  EXPECT_TRUE(!cycle.update(1000000));
+  EXPECT_TRUE(cycle.running());
+  EXPECT_EQ(cycle.nextUpdateMs(), INT64_MAX);
+}
+
+TEST(pausesAfterStillDelayAndResumesOnMotion) {
+  LocationDutyCycle cycle(0);
+  cycle.setOptions(adaptive(30000, 0), 0);
+  cycle.setMoving(false, 1000);
+  EXPECT_EQ(cycle.nextUpdateMs(), int64_t{31000});
+  EXPECT_TRUE(!cycle.update(30999));
+  EXPECT_TRUE(cycle.running());
+  EXPECT_TRUE(cycle.update(31000));
+  EXPECT_TRUE(cycle.state() == State::Paused);
+  // No polling: nothing to wake for
+  EXPECT_EQ(cycle.nextUpdateMs(), INT64_MAX);
+
+  cycle.setMoving(true, 90000);
+  EXPECT_TRUE(cycle.state() == State::Active);
+  const LocationDutyCycleStats stats = cycle.stats(100000);
+  EXPECT_EQ(stats.activeMs, int64_t{31000 + 10000});
+  EXPECT_EQ(stats.pausedMs, int64_t{59000});
+  EXPECT_EQ(stats.pauses, uint64_t{1});
+  EXPECT_EQ(stats.motionResumes, uint64_t{1});
+}
+
+TEST(briefStillnessDoesNotPause) {
+  LocationDutyCycle cycle(0);
+  cycle.setOptions(adaptive(30000, 0), 0);
+  cycle.setMoving(false, 0);
+  cycle.setMoving(true, 20000);
+  cycle.setMoving(false, 25000);
+  EXPECT_TRUE(!cycle.update(40000));
+  EXPECT_TRUE(cycle.running());
+  EXPECT_TRUE(cycle.update(55000));
+  EXPECT_EQ(cycle.stats(55000).motionResumes, uint64_t{0});
+}
+
+TEST(pollsWhileStillUntilAFix) {
+  LocationDutyCycle cycle(0);
+  cycle.setOptions(adaptive(10000, 60000, 5000), 0);
+  cycle.setMoving(false, 0);
+  EXPECT_TRUE(cycle.update(10000));
+  EXPECT_EQ(cycle.nextUpdateMs(), int64_t{70000});
+
+  // A wake that gets its fix ends right away
+  EXPECT_TRUE(cycle.update(70000));
+  EXPECT_TRUE(cycle.state() == State::Polling);
+  cycle.recordFix(71200);
+  EXPECT_TRUE(cycle.state() == State::Paused);
+  // The next wake is spaced from the start of this one
+  EXPECT_EQ(cycle.nextUpdateMs(), int64_t{130000});
+
+  // A wake without a fix gives up after the timeout
+  EXPECT_TRUE(cycle.update(130000));
+  EXPECT_EQ(cycle.nextUpdateMs(), int64_t{135000});
+  EXPECT_TRUE(!cycle.update(134999));
+  EXPECT_TRUE(cycle.update(135000));
+  EXPECT_TRUE(!cycle.running());
+
+  const LocationDutyCycleStats stats = cycle.stats(135000);
+  EXPECT_EQ(stats.polls, uint64_t{2});
+  EXPECT_EQ(stats.pollingMs, int64_t{1200 + 5000});
+  EXPECT_EQ(stats.fixes, uint64_t{1});
+  EXPECT_EQ(stats.activeMs + stats.pollingMs + stats.pausedMs, int64_t{135000});
+}
+
+TEST(hiddenViewsPause) {
+  LocationDutyCycle cycle(0);
+  cycle.setOptions(adaptive(30000, 60000), 0);
+  cycle.setVisible(false, 5000);
+  EXPECT_TRUE(!cycle.running());
+  // Hidden views do not wake for still fixes either
+  EXPECT_EQ(cycle.nextUpdateMs(), INT64_MAX);
+  cycle.setVisible(true, 8000);
+  EXPECT_TRUE(cycle.running());
+  EXPECT_EQ(cycle.stats(8000).motionResumes, uint64_t{0});
+
+  LocationDutyCycleOptions options = adaptive(30000, 60000);
+  options.pauseWhenHidden = false;
+  cycle.setOptions(options, 9000);
+  cycle.setVisible(false, 10000);
+  EXPECT_TRUE(cycle.running());
+}
+
+TEST(disablingResumes) {
+  LocationDutyCycle cycle(0);
+  cycle.setOptions(adaptive(1000, 0), 0);
+  cycle.setMoving(false, 0);
+  cycle.update(1000);
+  EXPECT_TRUE(!cycle.running());
+  cycle.setOptions(LocationDutyCycleOptions(), 2000);
+  EXPECT_TRUE(cycle.running());
+}
+
+TEST_MAIN()
@@ -0,0 +1,210 @@
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "LocationFilter.h"
+#include "TestHarness.h"
+
+#ifndef MERIDIANMAPS_FIXTURES_DIR
+#define MERIDIANMAPS_FIXTURES_DIR "tests/fixtures"
+#endif
+
+using namespace meridianmaps;
+
+namespace {
+
+struct TraceFix {
+  LocationSample sample;
+  double trueX = 0;
+  double trueY = 0;
+};
+
+std::vector<TraceFix> loadTrace(const std::string& name) {
+  std::vector<TraceFix> trace;
+  std::ifstream file(std::string(MERIDIANMAPS_FIXTURES_DIR) + "/" + name);
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.empty() || line[0] == '#' || line.rfind("timestamp", 0) == 0) {
+      continue;
+    }
+    std::vector<std::string> fields;
+    std::stringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, ',')) {
+      fields.push_back(field);
+    }
+    if (fields.size() < 8) {
+      continue;
+    }
+    TraceFix fix;
+    fix.sample.timestampMs = std::stoll(fields[0]);
+    fix.sample.mapKey = fields[1];
+    fix.sample.providerType = std::stoi(fields[2]);
+    fix.sample.x = std::stod(fields[3]);
+    fix.sample.y = std::stod(fields[4]);
+    fix.sample.accuracy = std::stod(fields[5]);
+    fix.trueX = std::stod(fields[6]);
+    fix.trueY = std::stod(fields[7]);
+    trace.push_back(fix);
+  }
+  return trace;
+}
+
+LocationSample fix(int64_t timestampMs, double x, double y, double accuracy = 5, std::string mapKey = "floor-1",
+                   int providerType = 1) {
+  LocationSample sample;
+  sample.mapKey = std::move(mapKey);
+  sample.providerType = providerType;
+  sample.x = x;
+  sample.y = y;
+  sample.accuracy = accuracy;
+  sample.timestampMs = timestampMs;
+  return sample;
+}
+
+double headingDifference(double a, double b) {
+  const double difference = std::fmod(std::fabs(a - b), 360.0);
+  return difference > 180 ? 360 - difference : difference;
+}
+
+}  // namespace
+
+TEST(smoothingReducesErrorOnTheWalkTrace) {
+  const auto trace = loadTrace("walk_trace.csv");
+  ASSERT_TRUE(trace.size() > 100);
+
+  LocationFilter filter;
+  double rawSquared = 0;
+  double filteredSquared = 0;
+  size_t counted = 0;
+  size_t sinceReset = 0;
+  for (size_t i = 0; i < trace.size(); ++i) {
+    const TraceFix& fix = trace[i];
+    const bool newTrack = i == 0 || fix.sample.mapKey != trace[i - 1].sample.mapKey ||
+                          fix.sample.providerType != trace[i - 1].sample.providerType;
+    sinceReset = newTrack ? 0 : sinceReset + 1;
+    const LocationEstimate estimate = filter.update(fix.sample);
+    // A fresh track needs a few fixes before its velocity means anything
+    if (sinceReset < 5) {
+      continue;
+    }
+    rawSquared += std::pow(fix.sample.x - fix.trueX, 2) + std::pow(fix.sample.y - fix.trueY, 2);
+    filteredSquared += std::pow(estimate.sample.x - fix.trueX, 2) + std::pow(estimate.sample.y - fix.trueY, 2);
+    ++counted;
+  }
+  const double rawRms = std::sqrt(rawSquared / counted);
+  const double filteredRms = std::sqrt(filteredSquared / counted);
+  std::printf("  raw rms %.2f, filtered rms %.2f over %zu fixes\n", rawRms, filteredRms, counted);
+  EXPECT_TRUE(filteredRms < 0.75 * rawRms);
+}
+
+TEST(velocityAndHeadingFollowTheCorridors) {
+  const auto trace = loadTrace("walk_trace.csv");
+  ASSERT_TRUE(trace.size() > 100);
+
+  LocationFilter filter;
+  for (size_t i = 0; i < trace.size(); ++i) {
+    const LocationEstimate estimate = filter.update(trace[i].sample);
+    // Halfway down the east corridor (10 units/s) and the south one
+    if (i == 40) {
+      EXPECT_NEAR(estimate.speed, 10.0, 3.0);
+      EXPECT_TRUE(estimate.hasHeading);
+      EXPECT_TRUE(headingDifference(estimate.heading, 90) < 20);
+    }
+    if (i == 80) {
+      EXPECT_NEAR(estimate.speed, 10.0, 3.0);
+      EXPECT_TRUE(estimate.hasHeading);
+      EXPECT_TRUE(headingDifference(estimate.heading, 180) < 20);
+    }
+  }
+}
+
+TEST(floorChangeStartsANewTrack) {
+  LocationFilter filter;
+  for (int i = 0; i < 10; ++i) {
+    filter.update(fix(i * 1000, i * 10.0, 0));
+  }
+  EXPECT_TRUE(filter.estimate().speed > 5);
+
+  const LocationEstimate estimate = filter.update(fix(10000, 500, 500, 5, "floor-2"));
+  EXPECT_NEAR(estimate.sample.x, 500.0, 1e-9);
+  EXPECT_NEAR(estimate.sample.y, 500.0, 1e-9);
+  EXPECT_NEAR(estimate.speed, 0.0, 1e-9);
+  EXPECT_TRUE(!estimate.hasHeading);
+  EXPECT_EQ(estimate.sample.mapKey, std::string("floor-2"));
+}
+
+TEST(providerChangeStartsANewTrack) {
+  LocationFilter filter;
+  for (int i = 0; i < 10; ++i) {
+    filter.update(fix(i * 1000, i * 10.0, 0));
+  }
+  const LocationEstimate estimate = filter.update(fix(10000, 140, 3, 5, "floor-1", 2));
+  EXPECT_NEAR(estimate.sample.x, 140.0, 1e-9);
+  EXPECT_NEAR(estimate.speed, 0.0, 1e-9);
+  EXPECT_EQ(estimate.sample.providerType, 2);
+}
+
+TEST(longGapStartsANewTrack) {
+  LocationFilterOptions options;
+  options.maxGapMs = 5000;
+  LocationFilter filter(options);
+  filter.update(fix(0, 0, 0));
+  filter.update(fix(1000, 10, 0));
+  const LocationEstimate estimate = filter.update(fix(7000, 300, 0));
+  EXPECT_NEAR(estimate.sample.x, 300.0, 1e-9);
+  EXPECT_NEAR(estimate.speed, 0.0, 1e-9);
+}
+
+TEST(olderFixesAreIgnored) {
+  LocationFilter filter;
+  filter.update(fix(1000, 0, 0));
+  const LocationEstimate before = filter.update(fix(2000, 10, 0));
+  const LocationEstimate after = filter.update(fix(1500, 500, 500));
+  EXPECT_NEAR(after.sample.x, before.sample.x, 1e-9);
+  EXPECT_NEAR(after.sample.y, before.sample.y, 1e-9);
+  EXPECT_EQ(after.sample.timestampMs, int64_t{2000});
+}
+
+TEST(standingStillConvergesBelowTheFixAccuracy) {
+  LocationFilter filter;
+  LocationEstimate estimate;
+  for (int i = 0; i < 30; ++i) {
+    // Alternating jitter around (50, 50)
+    const double offset = (i % 2 == 0) ? 4 : -4;
+    estimate = filter.update(fix(i * 1000, 50 + offset, 50 - offset, 8));
+  }
+  EXPECT_NEAR(estimate.sample.x, 50.0, 2.0);
+  EXPECT_NEAR(estimate.sample.y, 50.0, 2.0);
+  EXPECT_TRUE(estimate.sample.accuracy < 8);
+  EXPECT_TRUE(estimate.speed < 2);
+}
+
+TEST(fixesWithoutAccuracyUseTheDefault) {
+  LocationFilter filter;
+  filter.update(fix(0, 0, 0, 0));
+  const LocationEstimate estimate = filter.update(fix(1000, 10, 0, 0));
+  EXPECT_TRUE(std::isfinite(estimate.sample.x));
+  EXPECT_TRUE(estimate.sample.x > 0 && estimate.sample.x < 10);
+  EXPECT_TRUE(estimate.sample.accuracy > 0);
+}
+
+TEST(headingIsKeptWhenSlowingDown) {
+  LocationFilter filter;
+  for (int i = 0; i < 10; ++i) {
+    filter.update(fix(i * 1000, 0, -i * 10.0, 1));
+  }
+  EXPECT_TRUE(filter.estimate().hasHeading);
+  EXPECT_TRUE(headingDifference(filter.estimate().heading, 0) < 5);
+  LocationEstimate estimate;
+  for (int i = 10; i < 30; ++i) {
+    estimate = filter.update(fix(i * 1000, 0, -90, 1));
+  }
+  EXPECT_TRUE(estimate.speed < filter.options().minHeadingSpeed);
+  EXPECT_TRUE(estimate.hasHeading);
+  EXPECT_TRUE(headingDifference(estimate.heading, 0) < 5);
+}
+
+TEST_MAIN()
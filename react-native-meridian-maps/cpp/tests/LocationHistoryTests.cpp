@@ -0,0 +1,154 @@
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "LocationHistory.h"
+#include "TestHarness.h"
+
+using namespace meridianmaps;
+
+namespace {
+
+constexpr int64_t kStart = 1700000000000;
+
+LocationSample fix(int64_t timestampMs, double x, double y, std::string mapKey = "floor-1", int providerType = 1,
+                   double accuracy = 5) {
+  LocationSample sample;
+  sample.mapKey = std::move(mapKey);
+  sample.providerType = providerType;
+  sample.x = x;
+  sample.y = y;
+  sample.accuracy = accuracy;
+  sample.timestampMs = timestampMs;
+  return sample;
+}
+
+// count 1 Hz fixes walking right along y = 100
+void walk(LocationHistory& history, int count, const std::string& mapKey = "floor-1", int64_t start = kStart) {
+  for (int i = 0; i < count; ++i) {
+    history.append(fix(start + i * 1000, 10 + i * 1.3, 100, mapKey));
+  }
+}
+
+}  // namespace
+
+TEST(keepsEveryFixUntilFull) {
+  LocationHistory history;
+  history.append(fix(kStart, 12.34, 56.78, "floor-1", 2, 3.2));
+  history.append(fix(kStart + 1000, 13.01, 55.5, "floor-1", 2, 4.6));
+
+  const auto result = history.query({});
+  ASSERT_TRUE(result.points.size() == 2);
+  EXPECT_EQ(result.matched, size_t{2});
+  const auto& second = result.points[1];
+  EXPECT_EQ(second.mapKey, std::string("floor-1"));
+  EXPECT_EQ(second.providerType, 2);
+  EXPECT_EQ(second.timestampMs, kStart + 1000);
+  EXPECT_NEAR(second.x, 13.0, 1e-9);
+  EXPECT_NEAR(second.y, 55.5, 1e-9);
+  EXPECT_NEAR(second.accuracy, 4.6, 1e-9);
+  EXPECT_NEAR(result.points[0].x, 12.3, 1e-9);
+}
+
+TEST(walkingFixesTakeAboutSixBytes) {
+  LocationHistory history(1 << 20);
+  walk(history, 3600);
+  EXPECT_EQ(history.size(), size_t{3600});
+  const double perFix = static_cast<double>(history.byteSize()) / 3600.0;
+  EXPECT_TRUE(perFix <= 6.5);
+}
+
+TEST(dropsOldestBlocksWhenFull) {
+  LocationHistory history(4 * LocationHistory::kBlockBytes);
+  walk(history, 5000);
+  EXPECT_TRUE(history.size() < 5000);
+  EXPECT_TRUE(history.byteSize() <= history.capacityBytes());
+
+  const auto result = history.query({});
+  ASSERT_TRUE(result.points.size() == history.size());
+  // The newest fixes are kept, in order
+  EXPECT_EQ(result.points.back().timestampMs, kStart + 4999 * 1000);
+  for (size_t i = 1; i < result.points.size(); ++i) {
+    EXPECT_EQ(result.points[i].timestampMs - result.points[i - 1].timestampMs, int64_t{1000});
+  }
+}
+
+TEST(filtersByTimeRange) {
+  LocationHistory history;
+  walk(history, 100);
+  LocationHistoryQuery query;
+  query.sinceMs = kStart + 10 * 1000;
+  query.untilMs = kStart + 19 * 1000;
+  const auto result = history.query(query);
+  ASSERT_TRUE(result.points.size() == 10);
+  EXPECT_EQ(result.points.front().timestampMs, query.sinceMs);
+  EXPECT_EQ(result.points.back().timestampMs, query.untilMs);
+}
+
+TEST(filtersByMapKeyAndBounds) {
+  LocationHistory history;
+  walk(history, 50, "floor-1");
+  walk(history, 50, "floor-2", kStart + 50 * 1000);
+
+  LocationHistoryQuery byMap;
+  byMap.mapKey = "floor-2";
+  const auto onFloor = history.query(byMap);
+  EXPECT_EQ(onFloor.points.size(), size_t{50});
+  EXPECT_EQ(onFloor.points.front().mapKey, std::string("floor-2"));
+
+  LocationHistoryQuery inBox;
+  inBox.hasBounds = true;
+  inBox.minX = 20;
+  inBox.maxX = 30;
+  inBox.minY = 90;
+  inBox.maxY = 110;
+  const auto boxed = history.query(inBox);
+  // x = 10 + i * 1.3 lies in [20, 30] for i = 8..15 on both floors
+  EXPECT_EQ(boxed.points.size(), size_t{16});
+  for (const auto& point : boxed.points) {
+    EXPECT_TRUE(point.x >= 20 && point.x <= 30);
+  }
+}
+
+TEST(downsamplingKeepsEndsAndCorners) {
+  LocationHistory history;
+  // Right along y = 0, then a sharp turn down along x = 100
+  for (int i = 0; i <= 100; ++i) {
+    history.append(fix(kStart + i * 1000, i, 0));
+  }
+  for (int i = 1; i <= 100; ++i) {
+    history.append(fix(kStart + (100 + i) * 1000, 100, i));
+  }
+
+  LocationHistoryQuery query;
+  query.maxPoints = 10;
+  const auto result = history.query(query);
+  EXPECT_EQ(result.matched, size_t{201});
+  ASSERT_TRUE(result.points.size() == 10);
+  EXPECT_EQ(result.points.front().timestampMs, kStart);
+  EXPECT_EQ(result.points.back().timestampMs, kStart + 200 * 1000);
+  bool keptCorner = false;
+  for (const auto& point : result.points) {
+    keptCorner = keptCorner || (std::fabs(point.x - 100) < 1e-9 && std::fabs(point.y) < 1e-9);
+  }
+  EXPECT_TRUE(keptCorner);
+}
+
+TEST(shrinkingKeepsNewestBlocks) {
+  LocationHistory history(64 * LocationHistory::kBlockBytes);
+  walk(history, 2000);
+  history.setCapacity(2 * LocationHistory::kBlockBytes);
+  EXPECT_TRUE(history.size() > 0 && history.size() < 2000);
+  const auto result = history.query({});
+  EXPECT_EQ(result.points.back().timestampMs, kStart + 1999 * 1000);
+
+  // Appending after the resize continues the newest block
+  history.append(fix(kStart + 2000 * 1000, 0, 0));
+  EXPECT_EQ(history.query({}).points.back().timestampMs, kStart + 2000 * 1000);
+
+  history.clear();
+  EXPECT_EQ(history.size(), size_t{0});
+  EXPECT_TRUE(history.query({}).points.empty());
+}
+
+TEST_MAIN()
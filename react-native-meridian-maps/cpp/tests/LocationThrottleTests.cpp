@@ -0,0 +1,132 @@
+#include <string>
+
+#include "LocationThrottle.h"
+#include "TestHarness.h"
+
+using namespace meridianmaps;
+
+namespace {
+
+using Action = LocationThrottle::Action;
+
+LocationSample fix(double x, double y, double accuracy = 5, std::string mapKey = "floor-1") {
+  LocationSample sample;
+  sample.mapKey = std::move(mapKey);
+  sample.x = x;
+  sample.y = y;
+  sample.accuracy = accuracy;
+  return sample;
+}
+
+LocationThrottleOptions options(double maxRateHz, double minDisplacement, double minAccuracyImprovement = 0,
+                                int64_t coalesceWindowMs = 0) {
+  LocationThrottleOptions result;
+  result.maxRateHz = maxRateHz;
+  result.minDisplacement = minDisplacement;
+  result.minAccuracyImprovement = minAccuracyImprovement;
+  result.coalesceWindowMs = coalesceWindowMs;
+  return result;
+}
+
+}  // namespace
+
+TEST(defaultsOnlyDropRepeatedFixes) {
+  LocationThrottle throttle;
+  EXPECT_TRUE(throttle.offer(fix(10, 10), 0).action == Action::Deliver);
+  EXPECT_TRUE(throttle.offer(fix(10, 10), 5).action == Action::Drop);
+  EXPECT_TRUE(throttle.offer(fix(10, 10.5), 10).action == Action::Deliver);
+  EXPECT_EQ(throttle.stats().received, 3u);
+  EXPECT_EQ(throttle.stats().delivered, 2u);
+  EXPECT_EQ(throttle.stats().dropped, 1u);
+}
+
+TEST(smallMovesAreDroppedUntilTheyAddUp) {
+  LocationThrottle throttle(options(0, 3));
+  EXPECT_TRUE(throttle.offer(fix(0, 0), 0).action == Action::Deliver);
+  EXPECT_TRUE(throttle.offer(fix(1, 1), 100).action == Action::Drop);
+  EXPECT_TRUE(throttle.offer(fix(2, 2), 200).action == Action::Drop);
+  // Measured from the last delivered fix, not the last offered one
+  EXPECT_TRUE(throttle.offer(fix(3, 3), 300).action == Action::Deliver);
+}
+
+TEST(accuracyImprovementPassesWithoutMovement) {
+  LocationThrottle throttle(options(0, 3, 2));
+  EXPECT_TRUE(throttle.offer(fix(0, 0, 10), 0).action == Action::Deliver);
+  EXPECT_TRUE(throttle.offer(fix(0, 0, 9), 100).action == Action::Drop);
+  EXPECT_TRUE(throttle.offer(fix(0, 0, 7), 200).action == Action::Deliver);
+  // Getting worse is never an improvement
+  EXPECT_TRUE(throttle.offer(fix(0, 0, 20), 300).action == Action::Drop);
+}
+
+TEST(floorChangeIsAlwaysMeaningful) {
+  LocationThrottle throttle(options(0, 100));
+  EXPECT_TRUE(throttle.offer(fix(0, 0), 0).action == Action::Deliver);
+  EXPECT_TRUE(throttle.offer(fix(0, 0, 5, "floor-2"), 10).action == Action::Deliver);
+}
+
+TEST(rateLimitHoldsLatestFix) {
+  LocationThrottle throttle(options(2, 0));
+  EXPECT_TRUE(throttle.offer(fix(0, 0), 0).action == Action::Deliver);
+  const auto held = throttle.offer(fix(1, 0), 100);
+  EXPECT_TRUE(held.action == Action::Hold);
+  EXPECT_EQ(held.dueMs, 500);
+  // A newer fix replaces the held one and keeps its due time
+  const auto replaced = throttle.offer(fix(2, 0), 300);
+  EXPECT_TRUE(replaced.action == Action::Hold);
+  EXPECT_EQ(replaced.dueMs, 500);
+
+  EXPECT_TRUE(!throttle.flush(499).has_value());
+  const auto flushed = throttle.flush(500);
+  ASSERT_TRUE(flushed.has_value());
+  EXPECT_EQ(flushed->x, 2.0);
+  EXPECT_TRUE(!throttle.hasPending());
+  EXPECT_EQ(throttle.stats().coalesced, 1u);
+  EXPECT_EQ(throttle.stats().delivered, 2u);
+}
+
+TEST(heldFixDroppedWhenUserReturns) {
+  LocationThrottle throttle(options(1, 2));
+  EXPECT_TRUE(throttle.offer(fix(0, 0), 0).action == Action::Deliver);
+  EXPECT_TRUE(throttle.offer(fix(5, 0), 100).action == Action::Hold);
+  // Back next to the delivered fix: the held move is stale and nothing is sent
+  EXPECT_TRUE(throttle.offer(fix(0.5, 0), 200).action == Action::Drop);
+  EXPECT_TRUE(!throttle.hasPending());
+  const LocationThrottleStats& stats = throttle.stats();
+  EXPECT_EQ(stats.received, stats.delivered + stats.dropped + stats.coalesced);
+}
+
+TEST(coalescingWindowDelaysEvenTheFirstFix) {
+  LocationThrottle throttle(options(0, 0, 0, 50));
+  const auto first = throttle.offer(fix(0, 0), 1000);
+  EXPECT_TRUE(first.action == Action::Hold);
+  EXPECT_EQ(first.dueMs, 1050);
+  EXPECT_TRUE(throttle.offer(fix(1, 0), 1020).action == Action::Hold);
+  EXPECT_TRUE(throttle.offer(fix(2, 0), 1040).action == Action::Hold);
+  const auto flushed = throttle.flush(1050);
+  ASSERT_TRUE(flushed.has_value());
+  EXPECT_EQ(flushed->x, 2.0);
+  EXPECT_EQ(throttle.stats().coalesced, 2u);
+}
+
+TEST(resetForgetsLastDeliveredFix) {
+  LocationThrottle throttle(options(0, 10));
+  EXPECT_TRUE(throttle.offer(fix(0, 0), 0).action == Action::Deliver);
+  EXPECT_TRUE(throttle.offer(fix(1, 0), 10).action == Action::Drop);
+  throttle.reset();
+  EXPECT_TRUE(throttle.offer(fix(1, 0), 20).action == Action::Deliver);
+}
+
+TEST(totalsSumEveryThrottle) {
+  const LocationThrottleStats before = LocationThrottle::totalStats();
+  LocationThrottle a;
+  LocationThrottle b;
+  a.offer(fix(0, 0), 0);
+  b.offer(fix(0, 0), 0);
+  b.offer(fix(0, 0), 1);
+  const LocationThrottleStats after = LocationThrottle::totalStats();
+  EXPECT_EQ(after.received - before.received, 3u);
+  EXPECT_EQ(after.delivered - before.delivered, 2u);
+  EXPECT_EQ(after.dropped - before.dropped, 1u);
+}
+
+TEST_MAIN()
@@ -0,0 +1,138 @@
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "LocationTrace.h"
+#include "TestHarness.h"
+
+using namespace meridianmaps;
+
+namespace {
+
+std::string tempPath(const char* name) {
+  return "/tmp/mm_trace_" + std::to_string(::getpid()) + "_" + name;
+}
+
+LocationSample fix(int64_t timestampMs, double x, double y, std::string mapKey = "floor-1", int providerType = 1,
+                   double accuracy = 5) {
+  LocationSample sample;
+  sample.mapKey = std::move(mapKey);
+  sample.providerType = providerType;
+  sample.x = x;
+  sample.y = y;
+  sample.accuracy = accuracy;
+  sample.timestampMs = timestampMs;
+  return sample;
+}
+
+// A minute of 1 Hz fixes with a floor change halfway
+std::vector<LocationSample> walk() {
+  std::vector<LocationSample> samples;
+  const int64_t start = 1700000000000;
+  for (int i = 0; i < 60; ++i) {
+    samples.push_back(fix(start + i * 1000, 100 + i * 10.25, 200 - i * 0.5, i < 30 ? "floor-1" : "floor-2",
+                          i < 45 ? 1 : 2, 4 + (i % 5)));
+  }
+  return samples;
+}
+
+bool sameFix(const LocationSample& a, const LocationSample& b) {
+  return a.mapKey == b.mapKey && a.providerType == b.providerType && a.timestampMs == b.timestampMs &&
+         std::fabs(a.x - b.x) < 1e-3 && std::fabs(a.y - b.y) < 1e-3 && std::fabs(a.accuracy - b.accuracy) < 1e-3;
+}
+
+}  // namespace
+
+TEST(encodeAndDecodeRoundTrip) {
+  const auto samples = walk();
+  std::vector<LocationSample> decoded;
+  std::string error;
+  ASSERT_TRUE(LocationTrace::decode(LocationTrace::encode(samples), &decoded, &error));
+  ASSERT_TRUE(decoded.size() == samples.size());
+  for (size_t i = 0; i < samples.size(); ++i) {
+    EXPECT_TRUE(sameFix(decoded[i], samples[i]));
+  }
+}
+
+TEST(fixesTakeEighteenBytesAtOneHertz) {
+  const auto samples = walk();
+  const std::string bytes = LocationTrace::encode(samples);
+  // Plus the header, two map key records and the first fix's full timestamp
+  EXPECT_TRUE(bytes.size() < 8 + 2 * 12 + 8 + samples.size() * 18);
+}
+
+TEST(writerMatchesEncode) {
+  const auto samples = walk();
+  const std::string path = tempPath("writer.mmlt");
+  {
+    std::string error;
+    auto writer = LocationTraceWriter::open(path, &error);
+    ASSERT_TRUE(writer != nullptr);
+    for (const LocationSample& sample : samples) {
+      writer->append(sample);
+    }
+    EXPECT_EQ(writer->count(), samples.size());
+    EXPECT_EQ(writer->byteSize(), LocationTrace::encode(samples).size());
+  }
+  std::vector<LocationSample> read;
+  ASSERT_TRUE(LocationTrace::read(path, &read));
+  EXPECT_EQ(read.size(), samples.size());
+  EXPECT_TRUE(sameFix(read.back(), samples.back()));
+  std::remove(path.c_str());
+}
+
+TEST(truncatedTailKeepsCompleteRecords) {
+  const auto samples = walk();
+  const std::string bytes = LocationTrace::encode(samples);
+  std::vector<LocationSample> decoded;
+  ASSERT_TRUE(LocationTrace::decode(std::string_view(bytes).substr(0, bytes.size() - 5), &decoded));
+  EXPECT_EQ(decoded.size(), samples.size() - 1);
+  EXPECT_TRUE(sameFix(decoded.back(), samples[samples.size() - 2]));
+}
+
+TEST(rejectsOtherFiles) {
+  std::vector<LocationSample> decoded;
+  std::string error;
+  EXPECT_TRUE(!LocationTrace::decode("MMPS\x01\x00\x00\x00", &decoded, &error));
+  EXPECT_TRUE(!error.empty());
+  std::string future = LocationTrace::encode(walk());
+  future[4] = 9;
+  EXPECT_TRUE(!LocationTrace::decode(future, &decoded, &error));
+  EXPECT_TRUE(!LocationTrace::read(tempPath("missing.mmlt"), &decoded, &error));
+}
+
+TEST(replayKeepsRecordedSpacing) {
+  LocationReplay replay(walk(), 1);
+  replay.start(5000);
+  EXPECT_EQ(replay.take(5000).size(), 1u);
+  EXPECT_EQ(replay.take(5999).size(), 0u);
+  EXPECT_EQ(replay.nextDueMs(), int64_t{6000});
+  EXPECT_EQ(replay.take(8000).size(), 3u);
+  EXPECT_EQ(replay.position(), 4u);
+}
+
+TEST(replayAtTenTimesSpeed) {
+  LocationReplay replay(walk(), 10);
+  replay.start(0);
+  // 60 s of fixes in 6 s
+  EXPECT_EQ(replay.take(2999).size(), 30u);
+  EXPECT_TRUE(!replay.done());
+  const auto rest = replay.take(5900);
+  EXPECT_EQ(rest.size(), 30u);
+  EXPECT_TRUE(replay.done());
+  // Recorded timestamps are kept
+  EXPECT_EQ(rest.back().timestampMs, walk().back().timestampMs);
+}
+
+TEST(replayAtMaxSpeedIsBoundedByTheCaller) {
+  LocationReplay replay(walk(), 0);
+  replay.start(100);
+  EXPECT_EQ(replay.take(100, 16).size(), 16u);
+  EXPECT_EQ(replay.nextDueMs(), int64_t{100});
+  EXPECT_EQ(replay.take(100).size(), 44u);
+  EXPECT_TRUE(replay.done());
+}
+
+TEST_MAIN()
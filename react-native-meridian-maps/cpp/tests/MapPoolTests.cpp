@@ -0,0 +1,94 @@
+#include <string>
+#include <vector>
+
+#include "MapPool.h"
+#include "TestHarness.h"
+
+using namespace meridianmaps;
+
+TEST(takesTheMostRecentEntryForItsKey) {
+  MapPool pool(4);
+  std::vector<uint64_t> evicted;
+  pool.park("app|lobby", 1, &evicted);
+  pool.park("app|garage", 2, &evicted);
+  pool.park("app|lobby", 3, &evicted);
+  EXPECT_TRUE(evicted.empty());
+  EXPECT_EQ(pool.size(), 3u);
+
+  EXPECT_EQ(pool.take("app|lobby"), 3u);
+  EXPECT_EQ(pool.take("app|lobby"), 1u);
+  EXPECT_EQ(pool.take("app|lobby"), 0u);
+  EXPECT_EQ(pool.take("other|lobby"), 0u);
+  EXPECT_EQ(pool.size(), 1u);
+
+  EXPECT_EQ(pool.stats().parked, 3u);
+  EXPECT_EQ(pool.stats().hits, 2u);
+  EXPECT_EQ(pool.stats().misses, 2u);
+}
+
+TEST(evictsTheLeastRecentlyParkedPastCapacity) {
+  MapPool pool(2);
+  std::vector<uint64_t> evicted;
+  pool.park("a", 1, &evicted);
+  pool.park("b", 2, &evicted);
+  pool.park("c", 3, &evicted);
+  ASSERT_TRUE(evicted.size() == 1);
+  EXPECT_EQ(evicted[0], 1u);
+  EXPECT_EQ(pool.take("a"), 0u);
+
+  // Taking and parking again makes an entry the most recent
+  EXPECT_EQ(pool.take("b"), 2u);
+  pool.park("b", 2, &evicted);
+  pool.park("d", 4, &evicted);
+  ASSERT_TRUE(evicted.size() == 2);
+  EXPECT_EQ(evicted[1], 3u);
+  EXPECT_EQ(pool.stats().evictions, 2u);
+}
+
+TEST(zeroCapacityEvictsOnPark) {
+  MapPool pool(0);
+  std::vector<uint64_t> evicted;
+  pool.park("a", 7, &evicted);
+  ASSERT_TRUE(evicted.size() == 1);
+  EXPECT_EQ(evicted[0], 7u);
+  EXPECT_EQ(pool.size(), 0u);
+
+  // Id 0 means no entry and is never parked
+  pool.park("a", 0, &evicted);
+  EXPECT_EQ(pool.size(), 0u);
+  EXPECT_EQ(pool.stats().parked, 1u);
+}
+
+TEST(trimAndShrinkEvictOldestFirst) {
+  MapPool pool(4);
+  std::vector<uint64_t> evicted;
+  for (uint64_t id = 1; id <= 4; ++id) {
+    pool.park("k" + std::to_string(id), id, &evicted);
+  }
+  pool.setCapacity(3, &evicted);
+  ASSERT_TRUE(evicted.size() == 1);
+  EXPECT_EQ(evicted[0], 1u);
+
+  pool.trim(1, &evicted);
+  ASSERT_TRUE(evicted.size() == 3);
+  EXPECT_EQ(evicted[1], 2u);
+  EXPECT_EQ(evicted[2], 3u);
+  EXPECT_EQ(pool.take("k4"), 4u);
+  EXPECT_EQ(pool.stats().evictions, 1u);
+  EXPECT_EQ(pool.stats().trims, 2u);
+}
+
+TEST(removeForgetsWithoutCounting) {
+  MapPool pool(2);
+  std::vector<uint64_t> evicted;
+  pool.park("a", 1, &evicted);
+  pool.park("b", 2, &evicted);
+  EXPECT_TRUE(pool.remove(1));
+  EXPECT_TRUE(!pool.remove(1));
+  pool.park("c", 3, &evicted);
+  EXPECT_TRUE(evicted.empty());
+  EXPECT_EQ(pool.size(), 2u);
+  EXPECT_EQ(pool.stats().evictions, 0u);
+}
+
+TEST_MAIN()
@@ -0,0 +1,123 @@
+#include <string>
+#include <vector>
+
+#include "MarkerAtlas.h"
+#include "TestHarness.h"
+
+using namespace meridianmaps;
+
+TEST(sharesOneBitmapPerKey) {
+  MarkerAtlas atlas;
+  const std::string shop = MarkerAtlas::key("shape:circle", 72, 0xFF2266CC, false);
+  EXPECT_TRUE(shop == "shape:circle|72|ff2266cc|0");
+
+  bool created = false;
+  const uint64_t first = atlas.acquire(shop, 72 * 72 * 4, &created);
+  EXPECT_TRUE(first != 0);
+  EXPECT_TRUE(created);
+  // A thousand shops on the floor draw once
+  for (int i = 0; i < 999; ++i) {
+    EXPECT_EQ(atlas.acquire(shop, 72 * 72 * 4, &created), first);
+  }
+  EXPECT_TRUE(!created);
+  EXPECT_EQ(atlas.references(first), 1000u);
+  EXPECT_EQ(atlas.size(), 1u);
+  EXPECT_EQ(atlas.bytes(), 72u * 72 * 4);
+
+  // Any part of the key that changes the pixels is another bitmap
+  const uint64_t selected = atlas.acquire(MarkerAtlas::key("shape:circle", 72, 0xFF2266CC, true), 90 * 90 * 4, &created);
+  EXPECT_TRUE(created);
+  EXPECT_TRUE(selected != first);
+  EXPECT_TRUE(atlas.acquire(MarkerAtlas::key("shape:circle", 72, 0xFF2266CD, false), 1, nullptr) != first);
+  EXPECT_TRUE(atlas.acquire(MarkerAtlas::key("shape:circle", 96, 0xFF2266CC, false), 1, nullptr) != first);
+  EXPECT_TRUE(atlas.acquire(MarkerAtlas::key("https://venue/icons/shop.png", 72, 0xFF2266CC, false), 1, nullptr) != first);
+  // No tint is not a transparent tint
+  EXPECT_TRUE(MarkerAtlas::key("https://venue/icons/shop.png", 72, std::nullopt, false) == "https://venue/icons/shop.png|72|-|0");
+  EXPECT_TRUE(MarkerAtlas::key("https://venue/icons/shop.png", 72, std::nullopt, false) !=
+              MarkerAtlas::key("https://venue/icons/shop.png", 72, 0u, false));
+  EXPECT_EQ(atlas.size(), 5u);
+  EXPECT_EQ(atlas.stats().draws, 5u);
+  EXPECT_EQ(atlas.stats().hits, 999u);
+}
+
+TEST(keepsUnusedBitmapsWithinTheBudget) {
+  MarkerAtlas atlas(250);
+  std::vector<uint64_t> evicted;
+  const uint64_t a = atlas.acquire("a", 100, nullptr);
+  const uint64_t b = atlas.acquire("b", 100, nullptr);
+  const uint64_t c = atlas.acquire("c", 100, nullptr);
+  atlas.acquire("a", 100, nullptr);
+
+  // Still referenced once
+  EXPECT_TRUE(atlas.release(a, &evicted));
+  EXPECT_EQ(atlas.unusedBytes(), 0u);
+  EXPECT_TRUE(atlas.release(a, &evicted));
+  EXPECT_TRUE(atlas.release(b, &evicted));
+  EXPECT_TRUE(evicted.empty());
+  EXPECT_EQ(atlas.unusedBytes(), 200u);
+  EXPECT_TRUE(!atlas.release(b, &evicted));
+
+  // The next floor with the same icon takes the unused bitmap back without drawing
+  bool created = true;
+  EXPECT_EQ(atlas.acquire("b", 100, &created), b);
+  EXPECT_TRUE(!created);
+  EXPECT_EQ(atlas.unusedBytes(), 100u);
+  EXPECT_TRUE(atlas.release(b, &evicted));
+
+  // Past the budget the least recently released goes
+  EXPECT_TRUE(atlas.release(c, &evicted));
+  ASSERT_TRUE(evicted.size() == 1u);
+  EXPECT_EQ(evicted[0], a);
+  EXPECT_EQ(atlas.size(), 2u);
+  EXPECT_EQ(atlas.unusedBytes(), 200u);
+  EXPECT_EQ(atlas.stats().evictions, 1u);
+
+  // A key evicted is drawn again under a new id
+  EXPECT_TRUE(atlas.acquire("a", 100, &created) != a);
+  EXPECT_TRUE(created);
+}
+
+TEST(trimsAndShrinksOnlyUnusedBitmaps) {
+  MarkerAtlas atlas;
+  std::vector<uint64_t> evicted;
+  const uint64_t shown = atlas.acquire("shown", 100, nullptr);
+  const uint64_t hidden = atlas.acquire("hidden", 100, nullptr);
+  const uint64_t older = atlas.acquire("older", 100, nullptr);
+  atlas.release(older, &evicted);
+  atlas.release(hidden, &evicted);
+
+  atlas.setMaxUnusedBytes(100, &evicted);
+  ASSERT_TRUE(evicted.size() == 1u);
+  EXPECT_EQ(evicted[0], older);
+
+  evicted.clear();
+  atlas.trim(&evicted);
+  ASSERT_TRUE(evicted.size() == 1u);
+  EXPECT_EQ(evicted[0], hidden);
+  EXPECT_EQ(atlas.stats().trims, 1u);
+  EXPECT_EQ(atlas.references(shown), 1u);
+  EXPECT_EQ(atlas.bytes(), 100u);
+}
+
+TEST(removesBitmapsThatFailedToDraw) {
+  MarkerAtlas atlas;
+  std::vector<uint64_t> evicted;
+  bool created = false;
+  const uint64_t broken = atlas.acquire("https://venue/missing.png|72|ff000000|0", 100, &created);
+  EXPECT_TRUE(created);
+  EXPECT_TRUE(atlas.remove(broken));
+  EXPECT_TRUE(!atlas.remove(broken));
+  EXPECT_TRUE(!atlas.release(broken, &evicted));
+  EXPECT_EQ(atlas.size(), 0u);
+  EXPECT_EQ(atlas.bytes(), 0u);
+
+  // An unused bitmap can be removed too
+  const uint64_t unused = atlas.acquire("unused", 100, nullptr);
+  atlas.release(unused, &evicted);
+  EXPECT_TRUE(atlas.remove(unused));
+  EXPECT_EQ(atlas.unusedBytes(), 0u);
+  EXPECT_TRUE(atlas.acquire("https://venue/missing.png|72|ff000000|0", 100, &created) != broken);
+  EXPECT_TRUE(created);
+}
+
+TEST_MAIN()
@@ -0,0 +1,210 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+#include "PlacemarkSnapshot.h"
+#include "PlacemarkStore.h"
+#include "SyntheticVenue.h"
+#include "TestHarness.h"
+
+using namespace meridianmaps;
+using namespace meridianmaps::testing;
+
+namespace {
+
+std::string tempPath(const char* name) {
+  return "/tmp/mm_store_" + std::to_string(::getpid()) + "_" + name;
+}
+
+PlacemarkInput input(std::string_view id, std::string_view mapKey, std::string_view name, std::string_view type, float x,
+                     float y) {
+  PlacemarkInput in;
+  in.id = id;
+  in.mapKey = mapKey;
+  in.name = name;
+  in.type = type;
+  in.x = x;
+  in.y = y;
+  return in;
+}
+
+void expectSameTable(const PlacemarkTable& a, const PlacemarkTable& b) {
+  EXPECT_EQ(a.size(), b.size());
+  for (uint32_t row = 0; row < a.size() && row < b.size(); ++row) {
+    const uint32_t other = b.find(a.id(row));
+    if (other == PlacemarkTable::npos) {
+      fail(__FILE__, __LINE__, "missing " + std::string(a.id(row)));
+      return;
+    }
+    EXPECT_EQ(a.name(row), b.name(other));
+    EXPECT_EQ(a.floorKey(a.floorIndex(row)), b.floorKey(b.floorIndex(other)));
+    EXPECT_EQ(a.typeName(a.typeId(row)), b.typeName(b.typeId(other)));
+    EXPECT_EQ(a.x(row), b.x(other));
+    EXPECT_EQ(a.y(row), b.y(other));
+    EXPECT_EQ(a.bounds(row).maxX, b.bounds(other).maxX);
+  }
+}
+
+}  // namespace
+
+TEST(upsertInternsFloorsAndTypes) {
+  PlacemarkStore store;
+  store.upsert(input("a", "map1", "Lobby", "entrance", 1, 2));
+  store.upsert(input("b", "map1", "Cafe", "cafe", 3, 4));
+  store.upsert(input("c", "map2", "Desk", "cafe", 5, 6));
+
+  const PlacemarkTable& table = store.table();
+  EXPECT_EQ(table.size(), 3u);
+  EXPECT_EQ(table.floorCount(), 2u);
+  EXPECT_EQ(table.typeCount(), 2u);
+  EXPECT_EQ(table.floorIndex(table.find("a")), table.floorIndex(table.find("b")));
+  EXPECT_EQ(table.typeId(table.find("b")), table.typeId(table.find("c")));
+  EXPECT_EQ(table.findFloor("map2"), table.floorIndex(table.find("c")));
+  EXPECT_EQ(table.findFloor("missing"), UINT16_MAX);
+  EXPECT_EQ(table.find("missing"), PlacemarkTable::npos);
+
+  const Rect& point = table.bounds(table.find("a"));
+  EXPECT_EQ(point.minX, 1.0f);
+  EXPECT_EQ(point.maxY, 2.0f);
+}
+
+TEST(upsertReplacesExistingRow) {
+  PlacemarkStore store;
+  const uint32_t row = store.upsert(input("a", "map1", "Lobby", "entrance", 1, 2));
+  EXPECT_EQ(store.upsert(input("a", "map2", "Main lobby", "entrance", 7, 8)), row);
+  EXPECT_EQ(store.size(), 1u);
+  EXPECT_EQ(store.table().name(row), "Main lobby");
+  EXPECT_EQ(store.table().floorKey(store.table().floorIndex(row)), "map2");
+  EXPECT_EQ(store.table().x(row), 7.0f);
+}
+
+TEST(unchangedUpsertIsNoMutation) {
+  PlacemarkStore store;
+  const uint32_t row = store.upsert(input("a", "map1", "Lobby", "entrance", 1, 2));
+  const uint64_t revision = store.revision();
+  EXPECT_EQ(store.upsert(input("a", "map1", "Lobby", "entrance", 1, 2)), row);
+  EXPECT_EQ(store.revision(), revision);
+  store.upsert(input("a", "map1", "Lobby", "entrance", 1, 3));
+  EXPECT_TRUE(store.revision() != revision);
+
+  const std::string path = tempPath("unchanged.mmps");
+  ASSERT_TRUE(store.writeSnapshot(path));
+  std::unique_ptr<PlacemarkStore> loaded = PlacemarkStore::openSnapshot(path);
+  std::remove(path.c_str());
+  ASSERT_TRUE(loaded != nullptr);
+  loaded->upsert(input("a", "map1", "Lobby", "entrance", 1, 3));
+  EXPECT_TRUE(loaded->isMapped());
+  EXPECT_EQ(loaded->revision(), 0u);
+}
+
+TEST(removeKeepsLookupsConsistent) {
+  const auto venue = makeVenue(5000, 8);
+  PlacemarkStore store;
+  for (const auto& placemark : venue) {
+    store.upsert(toInput(placemark));
+  }
+  for (uint32_t i = 0; i < venue.size(); i += 3) {
+    EXPECT_TRUE(store.remove(venue[i].id));
+  }
+  EXPECT_TRUE(!store.remove(venue[0].id));
+
+  for (uint32_t i = 0; i < venue.size(); ++i) {
+    const uint32_t row = store.find(venue[i].id);
+    if (i % 3 == 0) {
+      EXPECT_EQ(row, PlacemarkStore::npos);
+    } else {
+      ASSERT_TRUE(row != PlacemarkStore::npos);
+      EXPECT_EQ(store.table().name(row), venue[i].name);
+      EXPECT_EQ(store.table().x(row), venue[i].x);
+    }
+  }
+}
+
+TEST(snapshotRoundTrip) {
+  const auto venue = makeVenue(20000, 12);
+  PlacemarkStore store;
+  for (const auto& placemark : venue) {
+    store.upsert(toInput(placemark));
+  }
+  store.remove(venue[10].id);
+
+  const std::string path = tempPath("roundtrip.mmps");
+  std::string error;
+  ASSERT_TRUE(store.writeSnapshot(path, &error));
+
+  std::unique_ptr<PlacemarkStore> loaded = PlacemarkStore::openSnapshot(path, &error);
+  ASSERT_TRUE(loaded != nullptr);
+  EXPECT_TRUE(loaded->isMapped());
+  expectSameTable(store.table(), loaded->table());
+  EXPECT_EQ(loaded->find(venue[10].id), PlacemarkStore::npos);
+  std::remove(path.c_str());
+}
+
+TEST(mappedStoreCopiesOnFirstWrite) {
+  PlacemarkStore store;
+  store.upsert(input("a", "map1", "Lobby", "entrance", 1, 2));
+  store.upsert(input("b", "map1", "Cafe", "cafe", 3, 4));
+  const std::string path = tempPath("cow.mmps");
+  ASSERT_TRUE(store.writeSnapshot(path));
+
+  std::unique_ptr<PlacemarkStore> loaded = PlacemarkStore::openSnapshot(path);
+  ASSERT_TRUE(loaded != nullptr);
+  // Removing the file must not affect a store that is still mapped
+  std::remove(path.c_str());
+  EXPECT_EQ(loaded->table().name(loaded->find("b")), "Cafe");
+
+  loaded->upsert(input("c", "map2", "Desk", "desk", 5, 6));
+  EXPECT_TRUE(!loaded->isMapped());
+  EXPECT_EQ(loaded->size(), 3u);
+  EXPECT_EQ(loaded->table().name(loaded->find("a")), "Lobby");
+  EXPECT_EQ(loaded->table().floorKey(loaded->table().floorIndex(loaded->find("c"))), "map2");
+}
+
+TEST(emptyStoreRoundTrip) {
+  PlacemarkStore store;
+  const std::string path = tempPath("empty.mmps");
+  ASSERT_TRUE(store.writeSnapshot(path));
+  std::unique_ptr<PlacemarkStore> loaded = PlacemarkStore::openSnapshot(path);
+  ASSERT_TRUE(loaded != nullptr);
+  EXPECT_EQ(loaded->size(), 0u);
+  EXPECT_EQ(loaded->find("a"), PlacemarkStore::npos);
+  std::remove(path.c_str());
+}
+
+TEST(rejectsCorruptSnapshots) {
+  PlacemarkStore store;
+  store.upsert(input("a", "map1", "Lobby", "entrance", 1, 2));
+  std::string bytes = PlacemarkSnapshot::serialize(store.table());
+  const std::string path = tempPath("corrupt.mmps");
+  std::string error;
+
+  auto writeBytes = [&](const std::string& data) {
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(data.data(), data.size());
+  };
+
+  writeBytes(bytes.substr(0, 100));
+  EXPECT_TRUE(PlacemarkSnapshot::open(path, &error) == nullptr);
+
+  std::string badMagic = bytes;
+  badMagic[0] = 'X';
+  writeBytes(badMagic);
+  EXPECT_TRUE(PlacemarkSnapshot::open(path, &error) == nullptr);
+
+  std::string badVersion = bytes;
+  badVersion[4] = static_cast<char>(PlacemarkSnapshot::kVersion + 1);
+  writeBytes(badVersion);
+  EXPECT_TRUE(PlacemarkSnapshot::open(path, &error) == nullptr);
+  EXPECT_EQ(error, "unsupported snapshot version " + std::to_string(PlacemarkSnapshot::kVersion + 1));
+
+  writeBytes(bytes.substr(0, bytes.size() - 8));
+  EXPECT_TRUE(PlacemarkSnapshot::open(path, &error) == nullptr);
+
+  EXPECT_TRUE(PlacemarkSnapshot::open(tempPath("missing.mmps"), &error) == nullptr);
+
+  writeBytes(bytes);
+  EXPECT_TRUE(PlacemarkSnapshot::open(path, &error) != nullptr);
+  std::remove(path.c_str());
+}
+
+TEST_MAIN()
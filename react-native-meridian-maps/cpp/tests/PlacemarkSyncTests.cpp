@@ -0,0 +1,447 @@
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Json.h"
+#include "PlacemarkStore.h"
+#include "PlacemarkSync.h"
+#include "StandInHttpServer.h"
+#include "SyntheticVenue.h"
+#include "TestHarness.h"
+
+using namespace meridianmaps;
+using namespace meridianmaps::testing;
+
+namespace {
+
+std::string tempPath(const char* name) {
+  return "/tmp/mm_sync_" + std::to_string(::getpid()) + "_" + name;
+}
+
+std::string quote(const std::string& value) {
+  std::string out = "\"";
+  for (const char c : value) {
+    if (c == '"' || c == '\\') {
+      out.push_back('\\');
+    }
+    out.push_back(c);
+  }
+  return out + "\"";
+}
+
+std::string queryParam(const std::string& target, const std::string& name) {
+  const size_t query = target.find('?');
+  if (query == std::string::npos) {
+    return std::string();
+  }
+  const std::string key = name + "=";
+  size_t start = query + 1;
+  while (start < target.size()) {
+    const size_t end = std::min(target.find('&', start), target.size());
+    if (target.compare(start, key.size(), key) == 0) {
+      return target.substr(start + key.size(), end - start - key.size());
+    }
+    start = end + 1;
+  }
+  return std::string();
+}
+
+/**
+ * In-memory venue behind the paged placemark endpoint documented in
+ * PlacemarkSync.h. Every change bumps a global sequence number; cursors and
+ * ETags are sequence numbers, and compact() forgets tombstones so older
+ * cursors get a 410.
+ */
+class VenueServer {
+ public:
+  struct Entry {
+    PlacemarkRecord record;
+    uint64_t sequence = 0;
+    bool deleted = false;
+  };
+
+  void put(PlacemarkRecord record) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    Entry& entry = maps_[record.mapKey][record.id];
+    entry.record = std::move(record);
+    entry.sequence = ++sequence_;
+    entry.deleted = false;
+  }
+
+  void erase(const std::string& mapId, const std::string& id) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    Entry& entry = maps_[mapId][id];
+    entry.sequence = ++sequence_;
+    entry.deleted = true;
+  }
+
+  void eraseMap(const std::string& mapId) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    maps_.erase(mapId);
+  }
+
+  void compact() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto& map : maps_) {
+      for (auto it = map.second.begin(); it != map.second.end();) {
+        it = it->second.deleted ? map.second.erase(it) : std::next(it);
+      }
+    }
+    horizon_ = sequence_;
+  }
+
+  void failMap(const std::string& mapId) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    failing_ = mapId;
+  }
+
+  std::vector<PlacemarkRecord> live() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    std::vector<PlacemarkRecord> records;
+    for (const auto& map : maps_) {
+      for (const auto& entry : map.second) {
+        if (!entry.second.deleted) {
+          records.push_back(entry.second.record);
+        }
+      }
+    }
+    return records;
+  }
+
+  HttpResponse handle(const StandInRequest& request) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    HttpResponse response;
+    response.status = 200;
+    const std::string path = request.target.substr(0, request.target.find('?'));
+    if (path == "/maps") {
+      response.body = "{\"results\":[";
+      for (const auto& map : maps_) {
+        response.body += (response.body.back() == '[' ? "{\"id\":" : ",{\"id\":") + quote(map.first) + "}";
+      }
+      response.body += "]}";
+      return response;
+    }
+
+    const std::string prefix = "/maps/";
+    const std::string suffix = "/placemarks";
+    const std::string mapId = path.substr(prefix.size(), path.size() - prefix.size() - suffix.size());
+    auto map = maps_.find(mapId);
+    if (map == maps_.end()) {
+      response.status = 404;
+      return response;
+    }
+    if (mapId == failing_) {
+      response.status = 500;
+      return response;
+    }
+
+    uint64_t mapSequence = 0;
+    for (const auto& entry : map->second) {
+      mapSequence = std::max(mapSequence, entry.second.sequence);
+    }
+    const std::string etag = "\"" + std::to_string(mapSequence) + "\"";
+    if (request.ifNoneMatch == etag) {
+      response.status = 304;
+      return response;
+    }
+
+    const std::string sinceParam = queryParam(request.target, "since");
+    const uint64_t since = sinceParam.empty() ? 0 : std::stoull(sinceParam);
+    if (!sinceParam.empty() && since < horizon_) {
+      response.status = 410;
+      return response;
+    }
+    const size_t pageSize = std::stoul(queryParam(request.target, "page_size"));
+    const std::string afterParam = queryParam(request.target, "after");
+    const size_t after = afterParam.empty() ? 0 : std::stoul(afterParam);
+
+    std::vector<const std::pair<const std::string, Entry>*> changed;
+    for (const auto& entry : map->second) {
+      if (sinceParam.empty() ? !entry.second.deleted : entry.second.sequence > since) {
+        changed.push_back(&entry);
+      }
+    }
+
+    std::string results;
+    std::string deleted;
+    const size_t end = std::min(changed.size(), after + pageSize);
+    for (size_t i = after; i < end; ++i) {
+      const Entry& entry = changed[i]->second;
+      if (entry.deleted) {
+        deleted += (deleted.empty() ? "" : ",") + quote(changed[i]->first);
+        continue;
+      }
+      const PlacemarkRecord& record = entry.record;
+      results += results.empty() ? "{" : ",{";
+      results += "\"id\":" + quote(record.id) + ",\"name\":" + quote(record.name) + ",\"type\":" + quote(record.type) +
+                 ",\"type_name\":" + quote(record.typeName) + ",\"description\":" + quote(record.description) +
+                 ",\"x\":" + std::to_string(record.x) + ",\"y\":" + std::to_string(record.y) + "}";
+    }
+    std::string next = "null";
+    if (end < changed.size()) {
+      next = quote(path + "?page_size=" + std::to_string(pageSize) + (sinceParam.empty() ? "" : "&since=" + sinceParam) +
+                   "&after=" + std::to_string(end));
+    }
+    response.etag = etag;
+    response.body = "{\"results\":[" + results + "],\"deleted\":[" + deleted + "],\"next\":" + next +
+                    ",\"cursor\":" + quote(std::to_string(mapSequence)) + "}";
+    return response;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::map<std::string, std::map<std::string, Entry>> maps_;
+  uint64_t sequence_ = 0;
+  uint64_t horizon_ = 0;
+  std::string failing_;
+};
+
+PlacemarkRecord record(const SyntheticPlacemark& placemark) {
+  PlacemarkRecord record;
+  record.id = placemark.id;
+  record.mapKey = placemark.mapKey;
+  record.name = placemark.name;
+  record.type = placemark.type;
+  record.typeName = placemark.type;
+  record.description = "Synthetic placemark on " + placemark.mapKey;
+  // Round-trips exactly through the server's fixed six decimals
+  record.x = static_cast<float>(static_cast<int>(placemark.x));
+  record.y = static_cast<float>(static_cast<int>(placemark.y));
+  return record;
+}
+
+void seed(VenueServer& server, uint32_t count, uint32_t floors) {
+  for (const SyntheticPlacemark& placemark : makeVenue(count, floors)) {
+    server.put(record(placemark));
+  }
+}
+
+void expectStoreMatches(const PlacemarkStore& store, const std::vector<PlacemarkRecord>& records) {
+  EXPECT_EQ(store.size(), static_cast<uint32_t>(records.size()));
+  const PlacemarkTable& table = store.table();
+  for (const PlacemarkRecord& expected : records) {
+    const uint32_t row = table.find(expected.id);
+    EXPECT_TRUE(row != PlacemarkTable::npos);
+    if (row == PlacemarkTable::npos) {
+      return;
+    }
+    EXPECT_EQ(table.name(row), expected.name);
+    EXPECT_EQ(table.floorKey(table.floorIndex(row)), expected.mapKey);
+    EXPECT_EQ(table.x(row), expected.x);
+  }
+}
+
+bool sync(const std::string& baseUrl, PlacemarkStore& store, SyncManifest& manifest, SyncStats* stats,
+          uint32_t pageSize = 100) {
+  PlacemarkSync::Options options;
+  options.baseUrl = baseUrl;
+  options.pageSize = pageSize;
+  PlacemarkSync sync(options, standInFetch);
+  return sync.run(manifest, [&store](const PlacemarkDiff& diff) { diff.applyTo(store); }, stats);
+}
+
+}  // namespace
+
+TEST(jsonParsesNestedDocuments) {
+  std::string error;
+  const JsonValue value = JsonValue::parse(
+      R"({"results":[{"id":"a","x":1.5e1,"ok":true,"none":null}],"next":null,"name":"caf\u00e9 \ud83d\ude00\n"})", &error);
+  ASSERT_TRUE(value.isObject());
+  EXPECT_EQ(value["results"].items().size(), 1u);
+  EXPECT_EQ(value["results"].items()[0]["id"].string(), "a");
+  EXPECT_EQ(value["results"].items()[0]["x"].number(), 15.0);
+  EXPECT_TRUE(value["results"].items()[0]["ok"].boolean());
+  EXPECT_TRUE(value["next"].isNull());
+  EXPECT_TRUE(value.has("next"));
+  EXPECT_TRUE(!value.has("missing"));
+  EXPECT_EQ(value["name"].string(), "caf\xC3\xA9 \xF0\x9F\x98\x80\n");
+  // Wrong-type access falls back instead of failing
+  EXPECT_EQ(value["name"].number(7), 7.0);
+  EXPECT_TRUE(value["missing"]["deeper"].items().empty());
+}
+
+TEST(jsonRejectsMalformedInput) {
+  for (const char* text : {"", "{", "{\"a\":}", "[1,]", "{\"a\":1} x", "\"\\ud800\"", "tru", "-", "\"a\nb\""}) {
+    std::string error;
+    EXPECT_TRUE(JsonValue::parse(text, &error).isNull());
+    EXPECT_TRUE(!error.empty());
+  }
+  std::string deep(100, '[');
+  EXPECT_TRUE(JsonValue::parse(deep + std::string(100, ']')).isNull());
+}
+
+TEST(manifestRoundTripsAndRejectsTruncation) {
+  SyncManifest manifest;
+  manifest.maps["map_1"].cursor = "42";
+  manifest.maps["map_1"].etag = "\"42\"";
+  manifest.maps["map_1"].hashes = {{"a", 1}, {"b", 2}};
+  manifest.maps["map_2"].hashes = {{"c", 3}};
+
+  const std::string path = tempPath("roundtrip.sync");
+  ASSERT_TRUE(manifest.write(path));
+  SyncManifest loaded;
+  ASSERT_TRUE(loaded.load(path));
+  EXPECT_EQ(loaded.maps.size(), 2u);
+  EXPECT_EQ(loaded.maps["map_1"].cursor, "42");
+  EXPECT_EQ(loaded.maps["map_1"].etag, "\"42\"");
+  EXPECT_EQ(loaded.maps["map_1"].hashes["b"], 2u);
+  EXPECT_EQ(loaded.maps["map_2"].hashes["c"], 3u);
+  std::remove(path.c_str());
+
+  const std::string bytes = manifest.serialize();
+  std::string error;
+  EXPECT_TRUE(!loaded.parse(std::string_view(bytes).substr(0, bytes.size() - 3), &error));
+  EXPECT_TRUE(loaded.maps.empty());
+  EXPECT_TRUE(!loaded.load(tempPath("missing.sync")));
+}
+
+TEST(firstSyncLoadsEveryFloor) {
+  VenueServer server;
+  seed(server, 2000, 8);
+  StandInHttpServer http([&server](const StandInRequest& request) { return server.handle(request); });
+
+  PlacemarkStore store;
+  SyncManifest manifest;
+  SyncStats stats;
+  ASSERT_TRUE(sync(http.baseUrl(), store, manifest, &stats));
+  expectStoreMatches(store, server.live());
+  EXPECT_EQ(stats.mapsFull, 8u);
+  EXPECT_EQ(stats.upserted, 2000u);
+  // One map list plus three pages of 100 or fewer per floor of 250
+  EXPECT_EQ(stats.requests, 1u + 8u * 3u);
+  EXPECT_EQ(manifest.maps.size(), 8u);
+  EXPECT_TRUE(!manifest.maps["map_0"].cursor.empty());
+}
+
+TEST(secondLaunchOnlyTransfersChanges) {
+  VenueServer server;
+  seed(server, 4000, 8);
+  StandInHttpServer http([&server](const StandInRequest& request) { return server.handle(request); });
+
+  const std::string snapshotPath = tempPath("launch.mmps");
+  const std::string manifestPath = tempPath("launch.sync");
+  SyncStats first;
+  const auto coldStart = std::chrono::steady_clock::now();
+  {
+    PlacemarkStore store;
+    SyncManifest manifest;
+    ASSERT_TRUE(sync(http.baseUrl(), store, manifest, &first));
+    ASSERT_TRUE(store.writeSnapshot(snapshotPath));
+    ASSERT_TRUE(manifest.write(manifestPath));
+  }
+  const auto coldTime = std::chrono::steady_clock::now() - coldStart;
+
+  // About 1% churn, confined to two of the eight floors
+  std::vector<SyntheticPlacemark> venue = makeVenue(4000, 8);
+  for (uint32_t i = 0; i < 40; i += 8) {
+    PlacemarkRecord edited = record(venue[i]);
+    edited.name += " (renamed)";
+    server.put(edited);
+    server.erase(venue[i + 1].mapKey, venue[i + 1].id);
+    PlacemarkRecord added = record(venue[i]);
+    added.id = "new_" + std::to_string(i);
+    server.put(added);
+  }
+
+  SyncStats second;
+  const auto warmStart = std::chrono::steady_clock::now();
+  std::unique_ptr<PlacemarkStore> store = PlacemarkStore::openSnapshot(snapshotPath);
+  ASSERT_TRUE(store != nullptr);
+  SyncManifest manifest;
+  ASSERT_TRUE(manifest.load(manifestPath));
+  ASSERT_TRUE(sync(http.baseUrl(), *store, manifest, &second));
+  const auto warmTime = std::chrono::steady_clock::now() - warmStart;
+
+  expectStoreMatches(*store, server.live());
+  EXPECT_EQ(second.upserted, 10u);
+  EXPECT_EQ(second.removed, 5u);
+  EXPECT_EQ(second.mapsDelta, 2u);
+  EXPECT_EQ(second.mapsUnchanged, 6u);
+  EXPECT_TRUE(second.bytesReceived * 20 < first.bytesReceived);
+  std::printf("  cold sync %llu bytes in %.1f ms, warm sync %llu bytes in %.1f ms\n",
+              static_cast<unsigned long long>(first.bytesReceived),
+              std::chrono::duration<double, std::milli>(coldTime).count(),
+              static_cast<unsigned long long>(second.bytesReceived),
+              std::chrono::duration<double, std::milli>(warmTime).count());
+
+  std::remove(snapshotPath.c_str());
+  std::remove(manifestPath.c_str());
+}
+
+TEST(expiredCursorFallsBackToFullListing) {
+  VenueServer server;
+  seed(server, 600, 2);
+  StandInHttpServer http([&server](const StandInRequest& request) { return server.handle(request); });
+
+  PlacemarkStore store;
+  SyncManifest manifest;
+  ASSERT_TRUE(sync(http.baseUrl(), store, manifest, nullptr));
+
+  std::vector<SyntheticPlacemark> venue = makeVenue(600, 2);
+  server.erase(venue[0].mapKey, venue[0].id);
+  PlacemarkRecord edited = record(venue[2]);
+  edited.name = "Moved";
+  server.put(edited);
+  server.compact();
+
+  SyncStats stats;
+  ASSERT_TRUE(sync(http.baseUrl(), store, manifest, &stats));
+  expectStoreMatches(store, server.live());
+  EXPECT_EQ(stats.mapsFull, 1u);
+  EXPECT_EQ(stats.mapsUnchanged, 1u);
+  EXPECT_EQ(stats.upserted, 1u);
+  EXPECT_EQ(stats.removed, 1u);
+  EXPECT_EQ(stats.unchanged, 298u);
+}
+
+TEST(removedMapDropsItsPlacemarks) {
+  VenueServer server;
+  seed(server, 300, 3);
+  StandInHttpServer http([&server](const StandInRequest& request) { return server.handle(request); });
+
+  PlacemarkStore store;
+  SyncManifest manifest;
+  ASSERT_TRUE(sync(http.baseUrl(), store, manifest, nullptr));
+  server.eraseMap("map_1");
+
+  SyncStats stats;
+  ASSERT_TRUE(sync(http.baseUrl(), store, manifest, &stats));
+  expectStoreMatches(store, server.live());
+  EXPECT_EQ(stats.removed, 100u);
+  EXPECT_EQ(manifest.maps.count("map_1"), 0u);
+}
+
+TEST(failedMapKeepsItsPreviousState) {
+  VenueServer server;
+  seed(server, 300, 3);
+  StandInHttpServer http([&server](const StandInRequest& request) { return server.handle(request); });
+
+  PlacemarkStore store;
+  SyncManifest manifest;
+  ASSERT_TRUE(sync(http.baseUrl(), store, manifest, nullptr));
+  const std::string cursor = manifest.maps["map_2"].cursor;
+
+  std::vector<SyntheticPlacemark> venue = makeVenue(300, 3);
+  PlacemarkRecord onFailing = record(venue[2]);
+  onFailing.name = "Unreachable edit";
+  server.put(onFailing);
+  PlacemarkRecord onHealthy = record(venue[0]);
+  onHealthy.name = "Reachable edit";
+  server.put(onHealthy);
+  server.failMap("map_2");
+
+  EXPECT_TRUE(!sync(http.baseUrl(), store, manifest, nullptr));
+  EXPECT_EQ(manifest.maps["map_2"].cursor, cursor);
+  EXPECT_EQ(store.table().name(store.find(venue[0].id)), "Reachable edit");
+
+  server.failMap("");
+  ASSERT_TRUE(sync(http.baseUrl(), store, manifest, nullptr));
+  expectStoreMatches(store, server.live());
+}
+
+TEST_MAIN()
@@ -0,0 +1,161 @@
+#include <string>
+#include <vector>
+
+#include "PlacemarkStore.h"
+#include "SearchIndex.h"
+#include "TestHarness.h"
+
+using namespace meridianmaps;
+
+namespace {
+
+SearchDocument document(std::string_view id, std::string_view name, std::string_view typeName = {},
+                        std::string_view description = {}) {
+  SearchDocument doc;
+  doc.id = id;
+  doc.name = name;
+  doc.typeName = typeName;
+  doc.description = description;
+  return doc;
+}
+
+std::vector<std::string> ids(const std::vector<SearchResult>& results) {
+  std::vector<std::string> out;
+  for (const SearchResult& result : results) {
+    out.emplace_back(result.id);
+  }
+  return out;
+}
+
+SearchIndex makeIndex() {
+  SearchIndex index;
+  index.upsert(document("conf-a", "Conference Room A", "Conference Room"));
+  index.upsert(document("conf-b", "Conference Room B", "Conference Room"));
+  index.upsert(document("restroom-1", "Restroom", "Restroom", "Next to the elevators"));
+  index.upsert(document("cafe", "Starbucks", "Cafe", "Coffee and pastries"));
+  index.upsert(document("lobby", "Main Lobby", "Entrance", "Reception desk and conference check-in"));
+  return index;
+}
+
+}  // namespace
+
+TEST(exactTermsRankNameAboveDescription) {
+  SearchIndex index = makeIndex();
+  const auto results = index.search("conference", 10);
+  ASSERT_TRUE(results.size() == 3);
+  EXPECT_EQ(results[2].id, "lobby");
+  EXPECT_TRUE(results[0].score > results[2].score);
+}
+
+TEST(lastKeystrokeMatchesAsPrefix) {
+  SearchIndex index = makeIndex();
+  EXPECT_EQ(ids(index.search("sta", 10)), std::vector<std::string>{"cafe"});
+  EXPECT_EQ(ids(index.search("coff", 10)), std::vector<std::string>{"cafe"});
+  EXPECT_EQ(index.search("c", 10).size(), 4u);
+}
+
+TEST(everyTokenMustMatch) {
+  SearchIndex index = makeIndex();
+  EXPECT_EQ(ids(index.search("conf room b", 10)), std::vector<std::string>{"conf-b"});
+  EXPECT_EQ(ids(index.search("Conference, room A!", 10)), std::vector<std::string>{"conf-a"});
+  EXPECT_TRUE(index.search("conference kitchen", 10).empty());
+}
+
+TEST(misspellingsAndInfixesFallBackToTrigrams) {
+  SearchIndex index = makeIndex();
+  EXPECT_EQ(ids(index.search("restrom", 10)), std::vector<std::string>{"restroom-1"});
+  EXPECT_EQ(ids(index.search("bucks", 10)), std::vector<std::string>{"cafe"});
+  EXPECT_TRUE(index.search("zzzz", 10).empty());
+}
+
+TEST(limitAndEmptyQueries) {
+  SearchIndex index = makeIndex();
+  EXPECT_EQ(index.search("room", 1).size(), 1u);
+  EXPECT_TRUE(index.search("", 10).empty());
+  EXPECT_TRUE(index.search("  ,. ", 10).empty());
+  EXPECT_TRUE(index.search("room", 0).empty());
+}
+
+TEST(upsertReplacesAndRemoveDrops) {
+  SearchIndex index = makeIndex();
+  index.upsert(document("cafe", "Blue Bottle", "Cafe"));
+  EXPECT_TRUE(index.search("starbucks", 10).empty());
+  EXPECT_EQ(ids(index.search("blue", 10)), std::vector<std::string>{"cafe"});
+  EXPECT_EQ(index.size(), 5u);
+
+  EXPECT_TRUE(index.remove("cafe"));
+  EXPECT_TRUE(!index.remove("cafe"));
+  EXPECT_TRUE(index.search("blue", 10).empty());
+  EXPECT_EQ(index.size(), 4u);
+}
+
+TEST(compactionKeepsResults) {
+  SearchIndex index;
+  std::vector<std::string> names;
+  for (int i = 0; i < 2000; ++i) {
+    names.push_back("room" + std::to_string(i));
+  }
+  for (int i = 0; i < 2000; ++i) {
+    index.upsert(document(names[i], "Office " + names[i], "Office"));
+  }
+  for (int i = 0; i < 2000; i += 4) {
+    index.remove(names[i]);
+  }
+  for (int i = 1; i < 2000; i += 4) {
+    index.upsert(document(names[i], "Desk " + names[i], "Desk"));
+  }
+  EXPECT_EQ(index.size(), 1500u);
+  for (const SearchResult& result : index.search("office room0", 2000)) {
+    EXPECT_TRUE(result.id != "room0");
+  }
+  EXPECT_EQ(index.search("desk room1", 10).front().id, "room1");
+  EXPECT_EQ(index.search("office room2", 10).front().id, "room2");
+  EXPECT_EQ(index.search("office", 2000).size(), 1000u);
+  EXPECT_EQ(index.search("desk", 2000).size(), 500u);
+}
+
+TEST(storeIndexesDetailsAndFollowsMutations) {
+  PlacemarkStore store;
+  PlacemarkInput input;
+  input.id = "a";
+  input.mapKey = "map";
+  input.name = "Lobby";
+  input.type = "entrance";
+  input.typeName = "Entrance";
+  input.description = "Security desk";
+  input.custom2 = "badge";
+  store.upsert(input);
+  EXPECT_EQ(store.table().detail(0, PlacemarkTable::Detail::Description), "Security desk");
+  EXPECT_EQ(store.table().detail(0, PlacemarkTable::Detail::Custom1), "");
+  EXPECT_EQ(store.table().detail(0, PlacemarkTable::Detail::Custom2), "badge");
+
+  EXPECT_EQ(ids(store.searchIndex().search("security", 10)), std::vector<std::string>{"a"});
+
+  input.id = "b";
+  input.name = "Badge Office";
+  input.description = "";
+  input.custom2 = "";
+  store.upsert(input);
+  EXPECT_EQ(store.searchIndex().search("badge", 10).size(), 2u);
+  store.remove("a");
+  EXPECT_EQ(ids(store.searchIndex().search("badge", 10)), std::vector<std::string>{"b"});
+}
+
+TEST(storeBuildsIndexFromMappedSnapshot) {
+  PlacemarkStore store;
+  PlacemarkInput input;
+  input.id = "a";
+  input.mapKey = "map";
+  input.name = "Lobby";
+  input.typeCategory = "Amenities";
+  store.upsert(input);
+  const std::string path = "/tmp/mm_search_snapshot.mmps";
+  ASSERT_TRUE(store.writeSnapshot(path));
+
+  auto mapped = PlacemarkStore::openSnapshot(path);
+  ASSERT_TRUE(mapped != nullptr);
+  EXPECT_EQ(ids(mapped->searchIndex().search("amen", 10)), std::vector<std::string>{"a"});
+  std::remove(path.c_str());
+}
+
+TEST_MAIN()
@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "PlacemarkStore.h"
+#include "SpatialIndex.h"
+#include "SyntheticVenue.h"
+#include "TestHarness.h"
+
+using namespace meridianmaps;
+using namespace meridianmaps::testing;
+
+namespace {
+
+float distanceTo(const Rect& box, float x, float y) {
+  const float dx = std::max({box.minX - x, 0.0f, x - box.maxX});
+  const float dy = std::max({box.minY - y, 0.0f, y - box.maxY});
+  return std::sqrt(dx * dx + dy * dy);
+}
+
+std::vector<SpatialHit> bruteForce(const PlacemarkTable& table, const SpatialQuery& query) {
+  std::vector<SpatialHit> hits;
+  for (uint32_t row = 0; row < table.size(); ++row) {
+    if (table.floorIndex(row) != query.floor) {
+      continue;
+    }
+    if (!query.types.empty() &&
+        std::find(query.types.begin(), query.types.end(), table.typeId(row)) == query.types.end()) {
+      continue;
+    }
+    const Rect& box = table.bounds(row);
+    if (query.kind == SpatialQuery::Kind::Rect) {
+      if (box.minX <= query.rect.maxX && box.maxX >= query.rect.minX && box.minY <= query.rect.maxY &&
+          box.maxY >= query.rect.minY) {
+        hits.push_back({row, 0});
+      }
+      continue;
+    }
+    const float distance = distanceTo(box, query.x, query.y);
+    if (distance <= query.radius) {
+      hits.push_back({row, distance});
+    }
+  }
+  if (query.kind != SpatialQuery::Kind::Rect) {
+    std::sort(hits.begin(), hits.end(), [](const SpatialHit& a, const SpatialHit& b) { return a.distance < b.distance; });
+    if (hits.size() > query.limit) {
+      hits.resize(query.limit);
+    }
+  }
+  return hits;
+}
+
+std::unique_ptr<PlacemarkStore> makeStore(uint32_t count, uint32_t floors) {
+  auto store = std::make_unique<PlacemarkStore>();
+  for (const auto& placemark : makeVenue(count, floors, 7)) {
+    store->upsert(toInput(placemark));
+  }
+  return store;
+}
+
+void expectSameDistances(const std::vector<SpatialHit>& actual, const std::vector<SpatialHit>& expected) {
+  EXPECT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size() && i < expected.size(); ++i) {
+    // Ties may come back in either order, distances may not
+    EXPECT_NEAR(actual[i].distance, expected[i].distance, 1e-3f);
+  }
+}
+
+std::vector<uint32_t> sortedRows(const std::vector<SpatialHit>& hits) {
+  std::vector<uint32_t> rows;
+  for (const SpatialHit& hit : hits) {
+    rows.push_back(hit.row);
+  }
+  std::sort(rows.begin(), rows.end());
+  return rows;
+}
+
+}  // namespace
+
+TEST(nearestMatchesBruteForce) {
+  auto store = makeStore(20000, 4);
+  const PlacemarkTable& table = store->table();
+  const SpatialIndex& index = store->spatialIndex();
+  for (uint32_t i = 0; i < 50; ++i) {
+    SpatialQuery query;
+    query.floor = static_cast<uint16_t>(i % 4);
+    query.x = static_cast<float>((i * 797) % 4000);
+    query.y = static_cast<float>((i * 463) % 3000);
+    query.limit = 1 + i % 12;
+    expectSameDistances(index.query(table, query), bruteForce(table, query));
+  }
+}
+
+TEST(nearestFiltersByType) {
+  auto store = makeStore(20000, 4);
+  const PlacemarkTable& table = store->table();
+  SpatialQuery query;
+  query.floor = 2;
+  query.x = 1000;
+  query.y = 1000;
+  query.limit = 5;
+  query.types = {table.findType("restroom"), table.findType("exit")};
+  const auto hits = store->spatialIndex().query(table, query);
+  expectSameDistances(hits, bruteForce(table, query));
+  for (const SpatialHit& hit : hits) {
+    const std::string_view type = table.typeName(table.typeId(hit.row));
+    EXPECT_TRUE(type == "restroom" || type == "exit");
+  }
+}
+
+TEST(radiusMatchesBruteForce) {
+  auto store = makeStore(20000, 4);
+  const PlacemarkTable& table = store->table();
+  SpatialQuery query;
+  query.kind = SpatialQuery::Kind::Radius;
+  query.floor = 1;
+  query.x = 2000;
+  query.y = 1500;
+  query.radius = 150;
+  query.limit = UINT32_MAX;
+  const auto hits = store->spatialIndex().query(table, query);
+  EXPECT_TRUE(!hits.empty());
+  expectSameDistances(hits, bruteForce(table, query));
+  for (const SpatialHit& hit : hits) {
+    EXPECT_TRUE(hit.distance <= 150);
+  }
+}
+
+TEST(rectMatchesBruteForce) {
+  auto store = makeStore(20000, 4);
+  const PlacemarkTable& table = store->table();
+  SpatialQuery query;
+  query.kind = SpatialQuery::Kind::Rect;
+  query.floor = 3;
+  query.rect = {500, 500, 900, 700};
+  query.limit = UINT32_MAX;
+  const auto hits = store->spatialIndex().query(table, query);
+  EXPECT_TRUE(!hits.empty());
+  EXPECT_TRUE(sortedRows(hits) == sortedRows(bruteForce(table, query)));
+
+  query.limit = 3;
+  EXPECT_EQ(store->spatialIndex().query(table, query).size(), 3u);
+}
+
+TEST(areasContainingThePointAreAtDistanceZero) {
+  PlacemarkStore store;
+  PlacemarkInput room;
+  room.id = "room";
+  room.mapKey = "map";
+  room.type = "office";
+  room.x = 50;
+  room.y = 50;
+  room.bounds = Rect{0, 0, 100, 100};
+  store.upsert(room);
+  PlacemarkInput desk = room;
+  desk.id = "desk";
+  desk.x = 10;
+  desk.y = 10;
+  desk.bounds.reset();
+  store.upsert(desk);
+
+  SpatialQuery query;
+  query.x = 90;
+  query.y = 90;
+  const auto hits = store.spatialIndex().query(store.table(), query);
+  ASSERT_TRUE(hits.size() == 2);
+  EXPECT_EQ(store.table().id(hits[0].row), "room");
+  EXPECT_EQ(hits[0].distance, 0.0f);
+  EXPECT_NEAR(hits[1].distance, std::sqrt(2.0f) * 80, 1e-3f);
+}
+
+TEST(indexFollowsStoreMutations) {
+  PlacemarkStore store;
+  PlacemarkInput input;
+  input.id = "a";
+  input.mapKey = "map";
+  input.x = 10;
+  input.y = 10;
+  store.upsert(input);
+
+  SpatialQuery query;
+  EXPECT_EQ(store.spatialIndex().query(store.table(), query).size(), 1u);
+
+  input.id = "b";
+  input.x = 1;
+  input.y = 1;
+  store.upsert(input);
+  auto hits = store.spatialIndex().query(store.table(), query);
+  ASSERT_TRUE(hits.size() == 2);
+  EXPECT_EQ(store.table().id(hits[0].row), "b");
+
+  store.remove("b");
+  hits = store.spatialIndex().query(store.table(), query);
+  ASSERT_TRUE(hits.size() == 1);
+  EXPECT_EQ(store.table().id(hits[0].row), "a");
+}
+
+TEST(unknownFloorAndEmptyStoreReturnNothing) {
+  PlacemarkStore store;
+  SpatialQuery query;
+  EXPECT_TRUE(store.spatialIndex().query(store.table(), query).empty());
+  query.floor = 12;
+  EXPECT_TRUE(store.spatialIndex().query(store.table(), query).empty());
+}
+
+TEST_MAIN()
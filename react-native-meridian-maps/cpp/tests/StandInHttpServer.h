@@ -0,0 +1,164 @@
+#pragma once
+
+// Loopback HTTP/1.1 server and client for tests that exercise code written
+// against a real endpoint. One request per connection, GET only.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "PlacemarkSync.h"
+
+namespace meridianmaps::testing {
+
+struct StandInRequest {
+  // Path and query, e.g. "/maps/1/placemarks?page_size=10"
+  std::string target;
+  std::string ifNoneMatch;
+};
+
+class StandInHttpServer {
+ public:
+  using Handler = std::function<HttpResponse(const StandInRequest&)>;
+
+  explicit StandInHttpServer(Handler handler) : handler_(std::move(handler)) {
+    listener_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    ::setsockopt(listener_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    ::bind(listener_, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    ::listen(listener_, 16);
+    socklen_t length = sizeof(address);
+    ::getsockname(listener_, reinterpret_cast<sockaddr*>(&address), &length);
+    port_ = ntohs(address.sin_port);
+    thread_ = std::thread([this] { serve(); });
+  }
+
+  ~StandInHttpServer() {
+    stopping_ = true;
+    ::shutdown(listener_, SHUT_RDWR);
+    ::close(listener_);
+    thread_.join();
+  }
+
+  std::string baseUrl() const { return "http://127.0.0.1:" + std::to_string(port_); }
+
+ private:
+  void serve() {
+    while (!stopping_) {
+      const int client = ::accept(listener_, nullptr, nullptr);
+      if (client < 0) {
+        continue;
+      }
+      std::string head;
+      char buffer[4096];
+      while (head.find("\r\n\r\n") == std::string::npos) {
+        const ssize_t received = ::recv(client, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+          break;
+        }
+        head.append(buffer, static_cast<size_t>(received));
+      }
+
+      StandInRequest request;
+      const size_t targetStart = head.find(' ') + 1;
+      request.target = head.substr(targetStart, head.find(' ', targetStart) - targetStart);
+      const size_t etag = head.find("\r\nIf-None-Match: ");
+      if (etag != std::string::npos) {
+        const size_t start = etag + 17;
+        request.ifNoneMatch = head.substr(start, head.find("\r\n", start) - start);
+      }
+
+      const HttpResponse response = handler_(request);
+      std::string reply = "HTTP/1.1 " + std::to_string(response.status) + " Stand-in\r\n";
+      reply += "Content-Type: application/json\r\nConnection: close\r\n";
+      reply += "Content-Length: " + std::to_string(response.body.size()) + "\r\n";
+      if (!response.etag.empty()) {
+        reply += "ETag: " + response.etag + "\r\n";
+      }
+      reply += "\r\n" + response.body;
+      size_t sent = 0;
+      while (sent < reply.size()) {
+        const ssize_t written = ::send(client, reply.data() + sent, reply.size() - sent, 0);
+        if (written <= 0) {
+          break;
+        }
+        sent += static_cast<size_t>(written);
+      }
+      ::close(client);
+    }
+  }
+
+  Handler handler_;
+  int listener_ = -1;
+  uint16_t port_ = 0;
+  std::atomic<bool> stopping_{false};
+  std::thread thread_;
+};
+
+// Blocking GET of an http://127.0.0.1:<port>/... URL, the HttpFetch the
+// platforms implement with their own HTTP stacks.
+inline HttpResponse standInFetch(const HttpRequest& request) {
+  HttpResponse response;
+  const std::string prefix = "http://127.0.0.1:";
+  if (request.url.rfind(prefix, 0) != 0) {
+    response.error = "unsupported URL " + request.url;
+    return response;
+  }
+  const size_t pathStart = request.url.find('/', prefix.size());
+  const int port = std::stoi(request.url.substr(prefix.size(), pathStart - prefix.size()));
+  const std::string target = pathStart == std::string::npos ? "/" : request.url.substr(pathStart);
+
+  const int connection = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(static_cast<uint16_t>(port));
+  if (::connect(connection, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+    response.error = std::string("connect: ") + std::strerror(errno);
+    ::close(connection);
+    return response;
+  }
+
+  std::string head = "GET " + target + " HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: close\r\n";
+  if (!request.etag.empty()) {
+    head += "If-None-Match: " + request.etag + "\r\n";
+  }
+  head += "\r\n";
+  ::send(connection, head.data(), head.size(), 0);
+
+  std::string raw;
+  char buffer[16384];
+  ssize_t received;
+  while ((received = ::recv(connection, buffer, sizeof(buffer), 0)) > 0) {
+    raw.append(buffer, static_cast<size_t>(received));
+  }
+  ::close(connection);
+
+  const size_t bodyStart = raw.find("\r\n\r\n");
+  if (raw.rfind("HTTP/1.1 ", 0) != 0 || bodyStart == std::string::npos) {
+    response.error = "malformed response";
+    return response;
+  }
+  response.status = std::stoi(raw.substr(9, 3));
+  const size_t etag = raw.find("\r\nETag: ");
+  if (etag != std::string::npos && etag < bodyStart) {
+    const size_t start = etag + 8;
+    response.etag = raw.substr(start, raw.find("\r\n", start) - start);
+  }
+  response.body = raw.substr(bodyStart + 4);
+  return response;
+}
+
+}  // namespace meridianmaps::testing
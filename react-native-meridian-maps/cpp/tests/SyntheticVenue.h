@@ -0,0 +1,60 @@
+#pragma once
+
+// Deterministic synthetic venue shared by tests and benchmarks: placemarks
+// spread over a number of floors on a 4000x3000 canvas with a small set of
+// types, roughly matching the shape of a large campus.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "PlacemarkStore.h"
+
+namespace meridianmaps::testing {
+
+struct SyntheticPlacemark {
+  std::string id;
+  std::string mapKey;
+  std::string name;
+  std::string type;
+  float x;
+  float y;
+  Rect bounds;
+};
+
+inline std::vector<SyntheticPlacemark> makeVenue(uint32_t count, uint32_t floors = 40, uint32_t seed = 1) {
+  static const char* kTypes[] = {"office", "conference", "restroom", "elevator", "stairs",  "cafe",
+                                 "kiosk",  "exit",       "parking",  "store",    "printer", "desk"};
+  uint32_t state = seed;
+  auto next = [&state]() {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+  };
+
+  std::vector<SyntheticPlacemark> venue;
+  venue.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    const float x = static_cast<float>(next() % 4000000) / 1000.0f;
+    const float y = static_cast<float>(next() % 3000000) / 1000.0f;
+    const float w = static_cast<float>(next() % 4000) / 100.0f;
+    const float h = static_cast<float>(next() % 4000) / 100.0f;
+    const char* type = kTypes[next() % (sizeof(kTypes) / sizeof(kTypes[0]))];
+    venue.push_back({"pm_" + std::to_string(i), "map_" + std::to_string(i % floors),
+                     std::string(type) + " " + std::to_string(i), type, x, y, Rect{x - w / 2, y - h / 2, x + w / 2, y + h / 2}});
+  }
+  return venue;
+}
+
+inline PlacemarkInput toInput(const SyntheticPlacemark& placemark) {
+  PlacemarkInput input;
+  input.id = placemark.id;
+  input.mapKey = placemark.mapKey;
+  input.name = placemark.name;
+  input.type = placemark.type;
+  input.x = placemark.x;
+  input.y = placemark.y;
+  input.bounds = placemark.bounds;
+  return input;
+}
+
+}  // namespace meridianmaps::testing
@@ -0,0 +1,87 @@
+#pragma once
+
+// Minimal self-contained test runner so the core builds and tests without
+// third-party dependencies. Each test binary is one ctest entry.
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace meridianmaps::testing {
+
+struct TestCase {
+  const char* name;
+  std::function<void()> body;
+};
+
+inline std::vector<TestCase>& registry() {
+  static std::vector<TestCase> tests;
+  return tests;
+}
+
+inline int& failures() {
+  static int count = 0;
+  return count;
+}
+
+struct Registrar {
+  Registrar(const char* name, std::function<void()> body) { registry().push_back({name, std::move(body)}); }
+};
+
+inline void fail(const char* file, int line, const std::string& message) {
+  std::fprintf(stderr, "%s:%d: %s\n", file, line, message.c_str());
+  ++failures();
+}
+
+inline int runAll() {
+  int failedTests = 0;
+  for (const TestCase& test : registry()) {
+    const int before = failures();
+    test.body();
+    const bool passed = failures() == before;
+    std::printf("[%s] %s\n", passed ? "  OK  " : " FAIL ", test.name);
+    failedTests += passed ? 0 : 1;
+  }
+  std::printf("%zu tests, %d failed\n", registry().size(), failedTests);
+  return failedTests == 0 ? 0 : 1;
+}
+
+}  // namespace meridianmaps::testing
+
+#define MM_CONCAT_INNER(a, b) a##b
+#define MM_CONCAT(a, b) MM_CONCAT_INNER(a, b)
+
+#define TEST(name)                                                                     \
+  static void name();                                                                  \
+  static ::meridianmaps::testing::Registrar MM_CONCAT(registrar_, name)(#name, name); \
+  static void name()
+
+#define EXPECT_TRUE(condition)                                                        \
+  do {                                                                                \
+    if (!(condition)) ::meridianmaps::testing::fail(__FILE__, __LINE__, #condition); \
+  } while (0)
+
+#define EXPECT_EQ(actual, expected)                                                                            \
+  do {                                                                                                         \
+    if (!((actual) == (expected))) ::meridianmaps::testing::fail(__FILE__, __LINE__, #actual " == " #expected); \
+  } while (0)
+
+#define EXPECT_NEAR(actual, expected, tolerance)                                        \
+  do {                                                                                  \
+    if (std::fabs((actual) - (expected)) > (tolerance))                                 \
+      ::meridianmaps::testing::fail(__FILE__, __LINE__, #actual " ~= " #expected);      \
+  } while (0)
+
+// Stops the current test on failure
+#define ASSERT_TRUE(condition)                                                          \
+  do {                                                                                  \
+    if (!(condition)) {                                                                 \
+      ::meridianmaps::testing::fail(__FILE__, __LINE__, #condition);                    \
+      return;                                                                           \
+    }                                                                                   \
+  } while (0)
+
+#define TEST_MAIN() \
+  int main() { return ::meridianmaps::testing::runAll(); }
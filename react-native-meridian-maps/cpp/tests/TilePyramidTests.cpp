@@ -0,0 +1,241 @@
+#include <dirent.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "TilePyramid.h"
+#include "TestHarness.h"
+
+using namespace meridianmaps;
+using namespace meridianmaps::testing;
+
+namespace {
+
+// A fresh cache directory, removed with everything under it when the test ends
+class TempDirectory {
+ public:
+  explicit TempDirectory(const char* name)
+      : path_("/tmp/mm_tiles_" + std::to_string(::getpid()) + "_" + name) {
+    removeAll(path_);
+  }
+  ~TempDirectory() { removeAll(path_); }
+
+  const std::string& path() const { return path_; }
+
+ private:
+  static void removeAll(const std::string& path) {
+    if (DIR* dir = ::opendir(path.c_str())) {
+      while (dirent* item = ::readdir(dir)) {
+        const std::string name = item->d_name;
+        if (name != "." && name != "..") {
+          removeAll(path + "/" + name);
+        }
+      }
+      ::closedir(dir);
+      ::rmdir(path.c_str());
+    } else {
+      std::remove(path.c_str());
+    }
+  }
+
+  std::string path_;
+};
+
+std::string svg(const std::string& body, const char* viewBox = "0 0 16 16") {
+  return std::string("<svg viewBox=\"") + viewBox + "\">" + body + "</svg>";
+}
+
+const uint8_t* pixel(const TileRasterizer& rasterizer, uint32_t x, uint32_t y) {
+  return &rasterizer.rgba()[(y * rasterizer.tileSize() + x) * 4];
+}
+
+uint32_t readBigEndian(const std::string& bytes, size_t offset) {
+  const auto* p = reinterpret_cast<const uint8_t*>(bytes.data() + offset);
+  return uint32_t{p[0]} << 24 | uint32_t{p[1]} << 16 | uint32_t{p[2]} << 8 | p[3];
+}
+
+}  // namespace
+
+TEST(rastersFillsWithAntialiasedEdges) {
+  // Edges at x = 4.5 and 11.5 cut pixel columns 4 and 11 in half
+  auto plan = FloorPlan::parse(svg("<rect x=\"4.5\" y=\"4\" width=\"7\" height=\"8\" fill=\"#ff0000\"/>"));
+  ASSERT_TRUE(plan != nullptr);
+  TileRasterizer rasterizer(16);
+  EXPECT_EQ(rasterizer.render(*plan, 0, 0, 1, 0xFFFFFFFF), 1u);
+
+  const uint8_t* inside = pixel(rasterizer, 8, 8);
+  EXPECT_TRUE(inside[0] == 255 && inside[1] == 0 && inside[2] == 0 && inside[3] == 255);
+  const uint8_t* outside = pixel(rasterizer, 2, 8);
+  EXPECT_TRUE(outside[0] == 255 && outside[1] == 255 && outside[2] == 255 && outside[3] == 255);
+  const uint8_t* leftEdge = pixel(rasterizer, 4, 8);
+  const uint8_t* rightEdge = pixel(rasterizer, 11, 8);
+  EXPECT_TRUE(leftEdge[0] == 255 && leftEdge[1] > 120 && leftEdge[1] < 136);
+  EXPECT_TRUE(rightEdge[0] == 255 && rightEdge[1] > 120 && rightEdge[1] < 136);
+  // Rows 4 through 11 are covered whole
+  EXPECT_EQ(pixel(rasterizer, 8, 3)[1], 255);
+  EXPECT_EQ(pixel(rasterizer, 8, 4)[1], 0);
+  EXPECT_EQ(pixel(rasterizer, 8, 11)[1], 0);
+  EXPECT_EQ(pixel(rasterizer, 8, 12)[1], 255);
+
+  // The same floor at twice the scale, offset by half the floor
+  TileRasterizer zoomed(16);
+  zoomed.render(*plan, 8, 8, 2, 0);
+  EXPECT_EQ(pixel(zoomed, 0, 0)[0], 255);
+  EXPECT_EQ(pixel(zoomed, 6, 6)[3], 255);
+  EXPECT_EQ(pixel(zoomed, 7, 7)[3], 0);
+}
+
+TEST(followsFillRules) {
+  // Both squares wind the same way; even-odd cuts the inner one out, nonzero does not
+  const std::string square = "M2 2 H14 V14 H2 Z M6 6 H10 V10 H6 Z";
+  auto plan = FloorPlan::parse(svg("<path d=\"" + square + "\" fill-rule=\"evenodd\"/>"
+                                   "<path d=\"" + square + "\" transform=\"translate(16)\"/>",
+                                   "0 0 32 16"));
+  ASSERT_TRUE(plan != nullptr);
+  TileRasterizer rasterizer(32);
+  rasterizer.render(*plan, 0, 0, 1, 0);
+  EXPECT_EQ(pixel(rasterizer, 3, 8)[3], 255);
+  EXPECT_EQ(pixel(rasterizer, 8, 8)[3], 0);
+  EXPECT_EQ(pixel(rasterizer, 19, 8)[3], 255);
+  EXPECT_EQ(pixel(rasterizer, 24, 8)[3], 255);
+
+  // Overlapping stroke segments at a corner do not cancel each other out
+  auto corner = FloorPlan::parse(svg("<polyline points=\"2,2 14,2 14,14\" fill=\"none\" stroke=\"black\" "
+                                     "stroke-width=\"2\"/>"));
+  ASSERT_TRUE(corner != nullptr);
+  TileRasterizer strokes(16);
+  strokes.render(*corner, 0, 0, 1, 0);
+  EXPECT_EQ(pixel(strokes, 14, 2)[3], 255);
+  EXPECT_EQ(pixel(strokes, 8, 1)[3], 255);
+  EXPECT_EQ(pixel(strokes, 8, 8)[3], 0);
+}
+
+TEST(encodesPng) {
+  auto plan = FloorPlan::parse(svg("<rect width=\"8\" height=\"16\" fill=\"#336699\" fill-opacity=\"0.5\"/>"));
+  ASSERT_TRUE(plan != nullptr);
+  TileRasterizer rasterizer(16);
+  rasterizer.render(*plan, 0, 0, 1, 0);
+  const std::string png = encodePng(rasterizer.rgba().data(), 16, 16);
+  ASSERT_TRUE(png.size() > 57);
+  EXPECT_TRUE(png.compare(0, 8, std::string("\x89PNG\r\n\x1a\n", 8)) == 0);
+  EXPECT_TRUE(png.compare(12, 4, "IHDR") == 0);
+  EXPECT_EQ(readBigEndian(png, 16), 16u);
+  EXPECT_EQ(readBigEndian(png, 20), 16u);
+  EXPECT_TRUE(png.compare(png.size() - 8, 4, "IEND") == 0);
+
+  const uint32_t dataLength = readBigEndian(png, 33);
+  ASSERT_TRUE(png.compare(37, 4, "IDAT") == 0);
+  std::vector<uint8_t> raw(16 * (16 * 4 + 1));
+  uLongf rawLength = raw.size();
+  ASSERT_TRUE(uncompress(raw.data(), &rawLength, reinterpret_cast<const Bytef*>(png.data() + 41), dataLength) == Z_OK);
+  EXPECT_EQ(rawLength, raw.size());
+  // Stored straight, not premultiplied
+  const uint8_t* first = &raw[1];
+  EXPECT_TRUE(first[0] >= 0x32 && first[0] <= 0x34 && first[1] >= 0x65 && first[1] <= 0x67);
+  EXPECT_TRUE(first[3] >= 127 && first[3] <= 128);
+  EXPECT_EQ(raw[1 + 12 * 4 + 3], 0);
+}
+
+TEST(sizesLevelsToTheFloor) {
+  auto pyramid = TilePyramid::open(svg("<rect width=\"1000\" height=\"500\"/>", "0 0 1000 500"), {});
+  ASSERT_TRUE(pyramid != nullptr);
+  // 256, 512 then 1024 pixels across the 1000-unit side
+  EXPECT_EQ(pyramid->maxZoom(), 2);
+  EXPECT_EQ(pyramid->columns(0), 1u);
+  EXPECT_EQ(pyramid->rows(0), 1u);
+  EXPECT_EQ(pyramid->columns(2), 4u);
+  EXPECT_EQ(pyramid->rows(2), 2u);
+  EXPECT_EQ(pyramid->zoomForScale(0.1f), 0);
+  EXPECT_EQ(pyramid->zoomForScale(0.3f), 1);
+  EXPECT_EQ(pyramid->zoomForScale(8), 2);
+
+  const std::vector<TileKey> visible = pyramid->visibleTiles({300, 100, 520, 200}, 2);
+  ASSERT_TRUE(visible.size() == 2u);
+  EXPECT_TRUE(visible[0] == (TileKey{2, 1, 0}));
+  EXPECT_TRUE(visible[1] == (TileKey{2, 2, 0}));
+  EXPECT_TRUE(pyramid->visibleTiles({2000, 0, 3000, 100}, 2).empty());
+  EXPECT_EQ(pyramid->visibleTiles({-100, -100, 5000, 5000}, 9).size(), 8u);
+
+  std::string png;
+  std::string error;
+  EXPECT_TRUE(pyramid->tile({2, 3, 1}, &png, &error));
+  EXPECT_TRUE(!pyramid->tile({2, 4, 0}, &png, &error));
+  EXPECT_TRUE(error.find("outside") != std::string::npos);
+  EXPECT_TRUE(!pyramid->tile({3, 0, 0}, &png, &error));
+}
+
+TEST(keepsTilesOnDisk) {
+  TempDirectory directory("disk");
+  TilePyramidOptions options;
+  options.cacheDirectory = directory.path();
+  const std::string floor = svg("<circle cx=\"500\" cy=\"500\" r=\"400\" fill=\"teal\"/>", "0 0 1000 1000");
+
+  std::string first;
+  {
+    auto pyramid = TilePyramid::open(floor, options);
+    ASSERT_TRUE(pyramid != nullptr);
+    ASSERT_TRUE(pyramid->tile({1, 1, 0}, &first));
+    EXPECT_EQ(pyramid->stats().rendered, 1u);
+    EXPECT_EQ(pyramid->stats().bytesWritten, first.size());
+  }
+  // A later launch reads it back instead of drawing it
+  auto reopened = TilePyramid::open(floor, options);
+  ASSERT_TRUE(reopened != nullptr);
+  std::string second;
+  ASSERT_TRUE(reopened->tile({1, 1, 0}, &second));
+  EXPECT_TRUE(second == first);
+  EXPECT_EQ(reopened->stats().rendered, 0u);
+  EXPECT_EQ(reopened->stats().diskHits, 1u);
+
+  // An edited floor gets a directory of its own
+  auto edited = TilePyramid::open(svg("<circle cx=\"500\" cy=\"500\" r=\"300\" fill=\"teal\"/>", "0 0 1000 1000"),
+                                  options);
+  ASSERT_TRUE(edited != nullptr);
+  EXPECT_TRUE(edited->cachePath() != reopened->cachePath());
+  std::string changed;
+  ASSERT_TRUE(edited->tile({1, 1, 0}, &changed));
+  EXPECT_EQ(edited->stats().rendered, 1u);
+  EXPECT_TRUE(changed != first);
+}
+
+TEST(poolRendersWhatOneThreadDoes) {
+  std::string body;
+  for (int i = 0; i < 400; ++i) {
+    const int x = (i % 20) * 50;
+    const int y = (i / 20) * 50;
+    body += "<rect x=\"" + std::to_string(x + 5) + "\" y=\"" + std::to_string(y + 5) +
+            "\" width=\"40\" height=\"40\" rx=\"4\" fill=\"#e0e0e0\" stroke=\"#404040\"/>";
+  }
+  const std::string floor = svg(body, "0 0 1000 1000");
+  TilePyramidOptions options;
+  options.threads = 4;
+  auto pooled = TilePyramid::open(floor, options);
+  auto serial = TilePyramid::open(floor, {});
+  ASSERT_TRUE(pooled != nullptr && serial != nullptr);
+
+  std::vector<std::string> tiles(1 + 4 + 16);
+  auto index = [](const TileKey& key) { return (key.zoom == 0 ? 0 : key.zoom == 1 ? 1 : 5) + key.y * (1u << key.zoom) + key.x; };
+  const size_t rendered = pooled->renderLevels(2, [&](const TileKey& key, const std::string& png) {
+    tiles[index(key)] = png;
+  });
+  EXPECT_EQ(rendered, 21u);
+  EXPECT_EQ(pooled->stats().rendered, 21u);
+
+  size_t matching = 0;
+  for (uint32_t zoom = 0; zoom <= 2; ++zoom) {
+    for (uint32_t y = 0; y < serial->rows(zoom); ++y) {
+      for (uint32_t x = 0; x < serial->columns(zoom); ++x) {
+        std::string png;
+        ASSERT_TRUE(serial->tile({zoom, x, y}, &png));
+        matching += png == tiles[index({zoom, x, y})] ? 1 : 0;
+      }
+    }
+  }
+  EXPECT_EQ(matching, 21u);
+}
+
+TEST_MAIN()
@@ -0,0 +1,82 @@
+#include <string>
+#include <vector>
+
+#include "TestHarness.h"
+#include "VenueRegistry.h"
+
+using namespace meridianmaps;
+
+TEST(firstActivationIsColdButNotASwitch) {
+  VenueRegistry registry;
+  EXPECT_TRUE(registry.active().empty());
+  std::vector<std::string> evicted;
+  EXPECT_TRUE(!registry.activate("mall", &evicted));
+  EXPECT_EQ(registry.active(), std::string("mall"));
+  // Activating the active venue again changes nothing
+  EXPECT_TRUE(registry.activate("mall", &evicted));
+  EXPECT_EQ(registry.stats().switches, 0u);
+  EXPECT_TRUE(evicted.empty());
+}
+
+TEST(switchingBackToARecentVenueIsWarm) {
+  VenueRegistry registry(3);
+  std::vector<std::string> evicted;
+  registry.activate("mall", &evicted);
+  EXPECT_TRUE(!registry.activate("campus", &evicted));
+  EXPECT_TRUE(registry.activate("mall", &evicted));
+  EXPECT_EQ(registry.active(), std::string("mall"));
+  ASSERT_TRUE(registry.venues().size() == 2);
+  EXPECT_EQ(registry.venues()[1], std::string("campus"));
+
+  EXPECT_EQ(registry.stats().switches, 2u);
+  EXPECT_EQ(registry.stats().warmSwitches, 1u);
+  EXPECT_EQ(registry.stats().coldSwitches, 1u);
+  EXPECT_TRUE(evicted.empty());
+}
+
+TEST(evictsTheLeastRecentlyActiveVenue) {
+  VenueRegistry registry(2);
+  std::vector<std::string> evicted;
+  registry.activate("mall", &evicted);
+  registry.activate("campus", &evicted);
+  registry.activate("mall", &evicted);
+  registry.activate("airport", &evicted);
+  ASSERT_TRUE(evicted.size() == 1);
+  EXPECT_EQ(evicted[0], std::string("campus"));
+  EXPECT_TRUE(!registry.contains("campus"));
+  EXPECT_TRUE(registry.contains("mall"));
+
+  // Coming back to an evicted venue loads it again
+  EXPECT_TRUE(!registry.activate("campus", &evicted));
+  ASSERT_TRUE(evicted.size() == 2);
+  EXPECT_EQ(evicted[1], std::string("mall"));
+  EXPECT_EQ(registry.stats().evictions, 2u);
+}
+
+TEST(shrinkingKeepsTheActiveVenue) {
+  VenueRegistry registry(3);
+  std::vector<std::string> evicted;
+  registry.activate("a", &evicted);
+  registry.activate("b", &evicted);
+  registry.activate("c", &evicted);
+  registry.setCapacity(0, &evicted);
+  EXPECT_EQ(registry.capacity(), 1u);
+  ASSERT_TRUE(evicted.size() == 2);
+  EXPECT_EQ(evicted[0], std::string("a"));
+  EXPECT_EQ(evicted[1], std::string("b"));
+  EXPECT_EQ(registry.active(), std::string("c"));
+}
+
+TEST(removeForgetsWithoutCounting) {
+  VenueRegistry registry(2);
+  std::vector<std::string> evicted;
+  registry.activate("a", &evicted);
+  registry.activate("b", &evicted);
+  EXPECT_TRUE(registry.remove("a"));
+  EXPECT_TRUE(!registry.remove("a"));
+  registry.activate("c", &evicted);
+  EXPECT_TRUE(evicted.empty());
+  EXPECT_EQ(registry.stats().evictions, 0u);
+}
+
+TEST_MAIN()
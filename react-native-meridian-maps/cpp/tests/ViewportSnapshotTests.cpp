@@ -0,0 +1,183 @@
+#include <dirent.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "TestHarness.h"
+#include "ViewportSnapshot.h"
+
+using namespace meridianmaps;
+using namespace meridianmaps::testing;
+
+namespace {
+
+constexpr int64_t kDay = 24 * 60 * 60 * 1000;
+
+// A fresh snapshot directory, removed with everything in it when the test ends
+class TempDirectory {
+ public:
+  explicit TempDirectory(const char* name)
+      : path_("/tmp/mm_viewport_" + std::to_string(::getpid()) + "_" + name) {
+    removeAll();
+  }
+  ~TempDirectory() { removeAll(); }
+
+  const std::string& path() const { return path_; }
+
+  std::vector<std::string> files() const {
+    std::vector<std::string> names;
+    if (DIR* dir = ::opendir(path_.c_str())) {
+      while (dirent* item = ::readdir(dir)) {
+        const std::string name = item->d_name;
+        if (name != "." && name != "..") {
+          names.push_back(name);
+        }
+      }
+      ::closedir(dir);
+    }
+    return names;
+  }
+
+ private:
+  void removeAll() const {
+    for (const std::string& name : files()) {
+      std::remove((path_ + "/" + name).c_str());
+    }
+    ::rmdir(path_.c_str());
+  }
+
+  std::string path_;
+};
+
+ViewportSnapshot snapshot(const std::string& mapId, int64_t savedAtMs, const std::string& image = "jpeg bytes") {
+  ViewportSnapshot snapshot;
+  snapshot.appId = "app";
+  snapshot.mapId = mapId;
+  snapshot.visibleRect = {120.5f, 80, 620.5f, 1160};
+  snapshot.rotation = 0.75f;
+  snapshot.viewWidth = 390;
+  snapshot.viewHeight = 844;
+  snapshot.savedAtMs = savedAtMs;
+  snapshot.image = image;
+  return snapshot;
+}
+
+}  // namespace
+
+TEST(restoresTheSavedViewport) {
+  TempDirectory directory("restore");
+  ViewportSnapshotStore store(directory.path());
+  std::string image(40000, '\0');
+  for (size_t i = 0; i < image.size(); ++i) {
+    image[i] = static_cast<char>(i * 31);
+  }
+  ASSERT_TRUE(store.save(snapshot("floor-2", 1000, image)));
+  EXPECT_EQ(store.size(), 1u);
+
+  // A new store, as after a relaunch
+  ViewportSnapshotStore reopened(directory.path());
+  ViewportSnapshot loaded;
+  ASSERT_TRUE(reopened.load("app", "floor-2", 5000, kDay, &loaded));
+  EXPECT_TRUE(loaded.appId == "app");
+  EXPECT_TRUE(loaded.mapId == "floor-2");
+  EXPECT_NEAR(loaded.visibleRect.minX, 120.5, 1e-6);
+  EXPECT_NEAR(loaded.visibleRect.maxY, 1160, 1e-6);
+  EXPECT_NEAR(loaded.rotation, 0.75, 1e-6);
+  EXPECT_NEAR(loaded.viewWidth, 390, 1e-6);
+  EXPECT_NEAR(loaded.viewHeight, 844, 1e-6);
+  EXPECT_EQ(loaded.savedAtMs, 1000);
+  EXPECT_TRUE(loaded.image == image);
+
+  // Each floor has its own snapshot; saving again replaces it
+  std::string error;
+  EXPECT_TRUE(!reopened.load("app", "floor-3", 5000, kDay, &loaded, &error));
+  EXPECT_TRUE(!reopened.load("other-app", "floor-2", 5000, kDay, &loaded, &error));
+  ASSERT_TRUE(reopened.save(snapshot("floor-2", 2000, "newer")));
+  ASSERT_TRUE(reopened.load("app", "floor-2", 5000, kDay, &loaded));
+  EXPECT_TRUE(loaded.image == "newer");
+  EXPECT_EQ(reopened.size(), 1u);
+}
+
+TEST(dropsSnapshotsPastTheirAge) {
+  TempDirectory directory("age");
+  ViewportSnapshotStore store(directory.path());
+  ASSERT_TRUE(store.save(snapshot("floor-1", 0)));
+
+  ViewportSnapshot loaded;
+  EXPECT_TRUE(store.load("app", "floor-1", kDay, kDay, &loaded));
+  std::string error;
+  EXPECT_TRUE(!store.load("app", "floor-1", kDay + 1, kDay, &loaded, &error));
+  EXPECT_TRUE(error.find("too old") != std::string::npos);
+  // The stale file is gone rather than checked again on every mount
+  EXPECT_EQ(store.size(), 0u);
+}
+
+TEST(keepsTheNewestSnapshots) {
+  TempDirectory directory("capacity");
+  ViewportSnapshotStore store(directory.path(), 3);
+  // Saved out of time order; pruning goes by savedAtMs, not by file order
+  const int64_t times[] = {500, 100, 400, 200, 300};
+  for (int64_t time : times) {
+    ASSERT_TRUE(store.save(snapshot("floor-" + std::to_string(time), time)));
+  }
+  EXPECT_EQ(store.size(), 3u);
+
+  ViewportSnapshot loaded;
+  EXPECT_TRUE(!store.load("app", "floor-100", 1000, kDay, &loaded));
+  EXPECT_TRUE(!store.load("app", "floor-200", 1000, kDay, &loaded));
+  EXPECT_TRUE(store.load("app", "floor-300", 1000, kDay, &loaded));
+  EXPECT_TRUE(store.load("app", "floor-400", 1000, kDay, &loaded));
+  EXPECT_TRUE(store.load("app", "floor-500", 1000, kDay, &loaded));
+}
+
+TEST(rejectsDamagedSnapshots) {
+  TempDirectory directory("damaged");
+  ViewportSnapshotStore store(directory.path());
+  std::string error;
+  EXPECT_TRUE(!store.save(snapshot("floor-1", 0, ""), &error));
+  EXPECT_TRUE(error.find("no image") != std::string::npos);
+
+  const std::string bytes = ViewportSnapshotStore::serialize(snapshot("floor-1", 0));
+  ViewportSnapshot parsed;
+  EXPECT_TRUE(ViewportSnapshotStore::parse(bytes, &parsed));
+  EXPECT_TRUE(!ViewportSnapshotStore::parse(bytes.substr(0, bytes.size() - 1), &parsed, true, &error));
+  EXPECT_TRUE(error.find("truncated") != std::string::npos);
+  EXPECT_TRUE(!ViewportSnapshotStore::parse(bytes + "x", &parsed, true, &error));
+  EXPECT_TRUE(!ViewportSnapshotStore::parse("MMPS", &parsed, true, &error));
+  EXPECT_TRUE(error.find("not a viewport snapshot") != std::string::npos);
+  std::string otherVersion = bytes;
+  otherVersion[4] = static_cast<char>(ViewportSnapshotStore::kVersion + 1);
+  EXPECT_TRUE(!ViewportSnapshotStore::parse(otherVersion, &parsed, true, &error));
+  EXPECT_TRUE(error.find("version") != std::string::npos);
+
+  // A snapshot cut short on disk is deleted when read
+  ASSERT_TRUE(store.save(snapshot("floor-1", 0)));
+  ASSERT_TRUE(directory.files().size() == 1u);
+  const std::string path = directory.path() + "/" + directory.files()[0];
+  ASSERT_TRUE(writeFileAtomically(path, bytes.substr(0, 20)));
+  ViewportSnapshot loaded;
+  EXPECT_TRUE(!store.load("app", "floor-1", 0, kDay, &loaded, &error));
+  EXPECT_EQ(store.size(), 0u);
+}
+
+TEST(clearsEverySnapshot) {
+  TempDirectory directory("clear");
+  ViewportSnapshotStore store(directory.path());
+  ASSERT_TRUE(store.save(snapshot("floor-1", 0)));
+  ASSERT_TRUE(store.save(snapshot("floor-2", 0)));
+  EXPECT_EQ(store.size(), 2u);
+  EXPECT_TRUE(store.remove("app", "floor-1"));
+  EXPECT_TRUE(!store.remove("app", "floor-1"));
+  EXPECT_EQ(store.size(), 1u);
+  store.clear();
+  EXPECT_EQ(store.size(), 0u);
+  // Clearing a store that never saved anything is harmless
+  ViewportSnapshotStore empty(directory.path() + "/missing");
+  empty.clear();
+  EXPECT_EQ(empty.size(), 0u);
+}
+
+TEST_MAIN()
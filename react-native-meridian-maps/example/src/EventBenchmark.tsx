@@ -0,0 +1,270 @@
+import { useCallback, useEffect, useRef, useState } from 'react';
+import { Button, StyleSheet, Text, View } from 'react-native';
+import {
+  getEventStats,
+  MeridianMapView,
+  replayLocationTrace,
+  startLocationRecording,
+  stopLocationRecording,
+  type EventStats,
+} from 'react-native-meridian-maps';
+
+const MAP_COUNT = 4;
+const FRAME_BUDGET_MS = 1000 / 60;
+
+type Props = {
+  appId: string;
+  mapId: string;
+  appToken: string;
+  durationMs?: number;
+};
+
+type Result = {
+  seconds: number;
+  eventsPerSecond: number;
+  perMap: number[];
+  frames: number;
+  meanFrameMs: number;
+  p95FrameMs: number;
+  maxFrameMs: number;
+  // Frames that took longer than two 60 Hz vsyncs
+  droppedFrames: number;
+  // Events that crossed to JS and events native dropped for lack of a handler
+  bridged: number;
+  suppressed: number;
+};
+
+const readEventStats = (): EventStats | null => {
+  try {
+    return getEventStats();
+  } catch {
+    return null;
+  }
+};
+
+const percentile = (sorted: number[], p: number) =>
+  sorted.length === 0
+    ? 0
+    : sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))]!;
+
+/**
+ * Mounts four maps and measures how many events reach JS per second and how
+ * long JS frames take while they arrive. Pan and zoom the maps during a run to
+ * generate transform events; run once with and once without the transform
+ * handlers to see how much bridge traffic the native event mask saves.
+ *
+ * To make runs repeatable, record a walk once and replay it during the run:
+ * the replay drives every map's location pipeline instead of the device.
+ */
+export default function EventBenchmark({
+  appId,
+  mapId,
+  appToken,
+  durationMs = 10000,
+}: Props) {
+  const counts = useRef<number[]>(new Array(MAP_COUNT).fill(0));
+  const frameTimes = useRef<number[]>([]);
+  const [running, setRunning] = useState(false);
+  const [observeTransforms, setObserveTransforms] = useState(true);
+  const [result, setResult] = useState<Result | null>(null);
+
+  const start = useCallback(() => {
+    counts.current = new Array(MAP_COUNT).fill(0);
+    frameTimes.current = [];
+    setResult(null);
+    setRunning(true);
+  }, []);
+
+  const [recording, setRecording] = useState(false);
+  const [tracePath, setTracePath] = useState<string | null>(null);
+  const [traceStatus, setTraceStatus] = useState('');
+
+  const toggleRecording = useCallback(async () => {
+    try {
+      if (recording) {
+        const { path, fixes } = await stopLocationRecording();
+        setTracePath(path);
+        setTraceStatus(`Recorded ${fixes} fixes`);
+        setRecording(false);
+      } else {
+        await startLocationRecording();
+        setTraceStatus('Recording…');
+        setRecording(true);
+      }
+    } catch (error) {
+      setTraceStatus(String(error));
+      setRecording(false);
+    }
+  }, [recording]);
+
+  const replay = useCallback(
+    async (speed: number | 'max') => {
+      if (!tracePath) return;
+      // Measure while the trace plays
+      start();
+      try {
+        const { fixes, durationMs } = await replayLocationTrace(tracePath, {
+          speed,
+        });
+        setTraceStatus(
+          `Replayed ${fixes} fixes at ${speed}x in ${durationMs.toFixed(0)} ms`
+        );
+      } catch (error) {
+        setTraceStatus(String(error));
+      }
+    },
+    [tracePath, start]
+  );
+
+  useEffect(() => {
+    if (!running) return;
+    const statsBefore = readEventStats();
+    const startedAt = performance.now();
+    let last = startedAt;
+    let frame = 0;
+    const tick = (now: number) => {
+      frameTimes.current.push(now - last);
+      last = now;
+      frame = requestAnimationFrame(tick);
+    };
+    frame = requestAnimationFrame(tick);
+
+    const timer = setTimeout(() => {
+      cancelAnimationFrame(frame);
+      const seconds = (performance.now() - startedAt) / 1000;
+      const sorted = [...frameTimes.current].sort((a, b) => a - b);
+      const total = counts.current.reduce((sum, n) => sum + n, 0);
+      const statsAfter = readEventStats();
+      const next: Result = {
+        seconds,
+        eventsPerSecond: total / seconds,
+        perMap: counts.current.map((n) => n / seconds),
+        frames: sorted.length,
+        meanFrameMs:
+          sorted.reduce((sum, t) => sum + t, 0) / Math.max(sorted.length, 1),
+        p95FrameMs: percentile(sorted, 0.95),
+        maxFrameMs: sorted[sorted.length - 1] ?? 0,
+        droppedFrames: sorted.filter((t) => t > 2 * FRAME_BUDGET_MS).length,
+        bridged:
+          (statsAfter?.dispatched ?? 0) - (statsBefore?.dispatched ?? 0),
+        suppressed:
+          (statsAfter?.suppressed ?? 0) - (statsBefore?.suppressed ?? 0),
+      };
+      console.log('Event benchmark:', next);
+      setResult(next);
+      setRunning(false);
+    }, durationMs);
+
+    return () => {
+      clearTimeout(timer);
+      cancelAnimationFrame(frame);
+    };
+  }, [running, durationMs]);
+
+  // Handlers only count, so the measurement is the cost of delivery itself
+  const handlersFor = (index: number) => {
+    const count = () => {
+      counts.current[index] = (counts.current[index] ?? 0) + 1;
+    };
+    return {
+      onMapLoadStart: count,
+      onMapLoadFinish: count,
+      onMapRenderFinish: count,
+      onLocationUpdated: count,
+      onMarkerSelect: count,
+      onMarkerDeselect: count,
+      ...(observeTransforms && {
+        onMapTransformChange: count,
+        onOrientationUpdated: count,
+      }),
+    };
+  };
+
+  return (
+    <View style={styles.container}>
+      <View style={styles.grid}>
+        {Array.from({ length: MAP_COUNT }, (_, index) => (
+          <View key={index} style={styles.cell}>
+            <MeridianMapView
+              appId={appId}
+              mapId={mapId}
+              appToken={appToken}
+              showLocationUpdates={true}
+              {...handlersFor(index)}
+            />
+          </View>
+        ))}
+      </View>
+      <Button
+        title={
+          observeTransforms
+            ? 'Transform handlers: on'
+            : 'Transform handlers: off'
+        }
+        onPress={() => setObserveTransforms((on) => !on)}
+        disabled={running}
+      />
+      <Button
+        title={running ? 'Measuring…' : 'Run event benchmark'}
+        onPress={start}
+        disabled={running}
+      />
+      <Button
+        title={recording ? 'Stop recording' : 'Record walk'}
+        onPress={toggleRecording}
+        disabled={running}
+      />
+      {tracePath && (
+        <View style={styles.row}>
+          <Button
+            title="Replay 10x"
+            onPress={() => replay(10)}
+            disabled={running || recording}
+          />
+          <Button
+            title="Replay max"
+            onPress={() => replay('max')}
+            disabled={running || recording}
+          />
+        </View>
+      )}
+      {traceStatus !== '' && <Text style={styles.result}>{traceStatus}</Text>}
+      {result && (
+        <Text style={styles.result}>
+          {`${result.eventsPerSecond.toFixed(1)} events/s over ${result.seconds.toFixed(1)} s ` +
+            `(per map: ${result.perMap.map((n) => n.toFixed(1)).join(', ')})\n` +
+            `JS frames: ${result.frames}, mean ${result.meanFrameMs.toFixed(2)} ms, ` +
+            `p95 ${result.p95FrameMs.toFixed(2)} ms, max ${result.maxFrameMs.toFixed(2)} ms, ` +
+            `dropped ${result.droppedFrames}\n` +
+            `Bridge: ${result.bridged} events sent, ${result.suppressed} dropped natively`}
+        </Text>
+      )}
+    </View>
+  );
+}
+
+const styles = StyleSheet.create({
+  container: {
+    flex: 1,
+  },
+  grid: {
+    flex: 1,
+    flexDirection: 'row',
+    flexWrap: 'wrap',
+  },
+  cell: {
+    width: '50%',
+    height: '50%',
+    borderWidth: 1,
+    borderColor: '#ddd',
+  },
+  row: {
+    flexDirection: 'row',
+    justifyContent: 'space-around',
+  },
+  result: {
+    padding: 8,
+    fontSize: 12,
+    color: '#444',
+  },
+});
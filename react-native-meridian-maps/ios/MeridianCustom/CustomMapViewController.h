@@ -1,4 +1,24 @@
 #import <Meridian/Meridian.h>
 
+@class CustomMapViewController;
+
+/// Map events forwarded from the controller's MRMapViewDelegate callbacks.
+@protocol CustomMapViewControllerDelegate <NSObject>
+@optional
+- (void)mapViewControllerWillStartLoadingMap:(CustomMapViewController *)controller;
+- (void)mapViewControllerDidFinishLoadingMap:(CustomMapViewController *)controller;
+- (void)mapViewController:(CustomMapViewController *)controller didFailLoadingMapWithError:(NSError *)error;
+- (void)mapViewController:(CustomMapViewController *)controller didLoadPlacemarks:(NSArray<MRPlacemark *> *)placemarks;
+- (void)mapViewController:(CustomMapViewController *)controller routeDidChange:(MRRoute *)route;
+- (void)mapViewController:(CustomMapViewController *)controller willScrollToStepAtIndex:(NSUInteger)index;
+- (void)mapViewControllerVisibleMapRectDidChange:(CustomMapViewController *)controller;
+- (void)mapViewControllerDidChangeUseAccessiblePaths:(CustomMapViewController *)controller;
+- (void)mapViewController:(CustomMapViewController *)controller didSelectPlacemark:(MRPlacemark *)placemark;
+- (void)mapViewControllerDidDeselectAnnotation:(CustomMapViewController *)controller;
+@end
+
 @interface CustomMapViewController : MRMapViewController
+@property (nonatomic, weak) id<CustomMapViewControllerDelegate> eventDelegate;
+/// Whether the map view has finished loading its current floor.
+@property (nonatomic, readonly, getter=isMapLoaded) BOOL mapLoaded;
 @end
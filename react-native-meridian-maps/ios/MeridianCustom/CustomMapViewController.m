@@ -1,5 +1,9 @@
 #import "CustomMapViewController.h"
 
+@interface CustomMapViewController ()
+@property (nonatomic, readwrite, getter=isMapLoaded) BOOL mapLoaded;
+@end
+
 @implementation CustomMapViewController
 
 - (void)mapView:(MRMapView *)mapView didSelectAnnotationView:(MRAnnotationView *)view {
@@ -11,6 +15,96 @@
     MRPlacemark *placemark = (MRPlacemark *)annotation;
     NSString *placemarkID = placemark.key.identifier;
     NSLog(@"Selected placemark ID: %@", placemarkID);
+    if ([self.eventDelegate respondsToSelector:@selector(mapViewController:didSelectPlacemark:)]) {
+        [self.eventDelegate mapViewController:self didSelectPlacemark:placemark];
+    }
+}
+
+- (void)mapView:(MRMapView *)mapView didDeselectAnnotationView:(MRAnnotationView *)view {
+    if ([MRMapViewController instancesRespondToSelector:_cmd]) {
+        [super mapView:mapView didDeselectAnnotationView:view];
+    }
+    if ([self.eventDelegate respondsToSelector:@selector(mapViewControllerDidDeselectAnnotation:)]) {
+        [self.eventDelegate mapViewControllerDidDeselectAnnotation:self];
+    }
+}
+
+// MRMapViewController is the map view's delegate, so map events are
+// passed on after it has handled them.
+
+- (void)mapViewWillStartLoadingMap:(MRMapView *)mapView {
+    if ([MRMapViewController instancesRespondToSelector:_cmd]) {
+        [super mapViewWillStartLoadingMap:mapView];
+    }
+    self.mapLoaded = NO;
+    if ([self.eventDelegate respondsToSelector:@selector(mapViewControllerWillStartLoadingMap:)]) {
+        [self.eventDelegate mapViewControllerWillStartLoadingMap:self];
+    }
+}
+
+- (void)mapViewDidFinishLoadingMap:(MRMapView *)mapView {
+    if ([MRMapViewController instancesRespondToSelector:_cmd]) {
+        [super mapViewDidFinishLoadingMap:mapView];
+    }
+    self.mapLoaded = YES;
+    if ([self.eventDelegate respondsToSelector:@selector(mapViewControllerDidFinishLoadingMap:)]) {
+        [self.eventDelegate mapViewControllerDidFinishLoadingMap:self];
+    }
+}
+
+- (void)mapViewDidFailLoadingMap:(MRMapView *)mapView withError:(NSError *)error {
+    if ([MRMapViewController instancesRespondToSelector:_cmd]) {
+        [super mapViewDidFailLoadingMap:mapView withError:error];
+    }
+    self.mapLoaded = NO;
+    if ([self.eventDelegate respondsToSelector:@selector(mapViewController:didFailLoadingMapWithError:)]) {
+        [self.eventDelegate mapViewController:self didFailLoadingMapWithError:error];
+    }
+}
+
+- (void)mapView:(MRMapView *)mapView didLoadPlacemarks:(NSArray<MRPlacemark *> *)placemarks {
+    if ([MRMapViewController instancesRespondToSelector:_cmd]) {
+        [super mapView:mapView didLoadPlacemarks:placemarks];
+    }
+    if ([self.eventDelegate respondsToSelector:@selector(mapViewController:didLoadPlacemarks:)]) {
+        [self.eventDelegate mapViewController:self didLoadPlacemarks:placemarks];
+    }
+}
+
+- (void)mapView:(MRMapView *)mapView routeDidChange:(MRRoute *)route {
+    if ([MRMapViewController instancesRespondToSelector:_cmd]) {
+        [super mapView:mapView routeDidChange:route];
+    }
+    if ([self.eventDelegate respondsToSelector:@selector(mapViewController:routeDidChange:)]) {
+        [self.eventDelegate mapViewController:self routeDidChange:route];
+    }
+}
+
+- (void)mapView:(MRMapView *)mapView willScrollToStepAtIndex:(NSUInteger)index {
+    if ([MRMapViewController instancesRespondToSelector:_cmd]) {
+        [super mapView:mapView willScrollToStepAtIndex:index];
+    }
+    if ([self.eventDelegate respondsToSelector:@selector(mapViewController:willScrollToStepAtIndex:)]) {
+        [self.eventDelegate mapViewController:self willScrollToStepAtIndex:index];
+    }
+}
+
+- (void)mapView:(MRMapView *)mapView visibleMapRectDidChange:(BOOL)animated {
+    if ([MRMapViewController instancesRespondToSelector:_cmd]) {
+        [super mapView:mapView visibleMapRectDidChange:animated];
+    }
+    if ([self.eventDelegate respondsToSelector:@selector(mapViewControllerVisibleMapRectDidChange:)]) {
+        [self.eventDelegate mapViewControllerVisibleMapRectDidChange:self];
+    }
+}
+
+- (void)mapViewDidChangeUseAccessiblePaths:(MRMapView *)mapView {
+    if ([MRMapViewController instancesRespondToSelector:_cmd]) {
+        [super mapViewDidChangeUseAccessiblePaths:mapView];
+    }
+    if ([self.eventDelegate respondsToSelector:@selector(mapViewControllerDidChangeUseAccessiblePaths:)]) {
+        [self.eventDelegate mapViewControllerDidChangeUseAccessiblePaths:self];
+    }
 }
 
 //- (void)startRouteToPlacemarkWithID:(NSString *)placemarkID {
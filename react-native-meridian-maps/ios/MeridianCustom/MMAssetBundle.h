@@ -0,0 +1,47 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+extern NSString *const MMAssetBundleErrorDomain;
+
+/**
+ * Objective-C face of a venue asset bundle (cpp/AssetBundle.h) written by
+ * scripts/pack-venue.js.
+ *
+ * Making a bundle active registers MMBundleURLProtocol, which answers GETs
+ * for URLs in the bundle (floor SVGs and images, route data) from the bundle
+ * instead of the network, for every request the URL loading system routes
+ * through its registered protocols. The packed placemark pages are replayed
+ * into the placemark index by MMPlacemarkIndex seedFromBundle:. Thread-safe.
+ */
+@interface MMAssetBundle : NSObject
+
+/// Maps and validates the bundle at path, or returns nil with error.
++ (nullable instancetype)bundleWithPath:(NSString *)path error:(NSError **)error;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// The bundle requests are served from, if any.
++ (nullable MMAssetBundle *)activeBundle;
++ (void)setActiveBundle:(nullable MMAssetBundle *)bundle;
+
+@property (nonatomic, copy, readonly) NSString *path;
+/// From the packer's manifest: the venue, its sync endpoint and the page size the placemarks were packed with.
+@property (nonatomic, copy, readonly) NSString *appId;
+@property (nonatomic, copy, readonly) NSURL *baseURL;
+@property (nonatomic, copy, readonly) NSArray<NSString *> *mapIds;
+@property (nonatomic, readonly) NSUInteger pageSize;
+@property (nonatomic, readonly) NSUInteger assetCount;
+@property (nonatomic, readonly) unsigned long long byteSize;
+
+- (BOOL)containsURL:(NSURL *)url;
+
+/// Inflated bytes for url, or nil if it is not in the bundle or fails its checksum.
+- (nullable NSData *)dataForURL:(NSURL *)url contentType:(NSString *_Nullable *_Nullable)contentType;
+
+/// served, bytesServed and failures since the bundle was opened.
+- (NSDictionary<NSString *, NSNumber *> *)stats;
+
+@end
+
+NS_ASSUME_NONNULL_END
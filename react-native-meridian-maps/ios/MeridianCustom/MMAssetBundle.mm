@@ -0,0 +1,194 @@
+#import "MMAssetBundle.h"
+
+#include <memory>
+#include <string>
+
+#include "AssetBundle.h"
+
+using meridianmaps::AssetBundle;
+using meridianmaps::AssetBundleStats;
+
+NSString *const MMAssetBundleErrorDomain = @"MMAssetBundleErrorDomain";
+
+static NSError *MMBundleError(NSString *message) {
+    return [NSError errorWithDomain:MMAssetBundleErrorDomain code:1 userInfo:@{NSLocalizedDescriptionKey: message}];
+}
+
+static std::string MMStdString(NSString *value) {
+    return value ? std::string(value.UTF8String) : std::string();
+}
+
+static NSString *MMNSString(std::string_view value) {
+    return [[NSString alloc] initWithBytes:value.data() length:value.size() encoding:NSUTF8StringEncoding] ?: @"";
+}
+
+/**
+ * Answers GETs for URLs in the active bundle. Registered once, the first time
+ * a bundle becomes active; with no active bundle it declines every request.
+ */
+@interface MMBundleURLProtocol : NSURLProtocol
+@end
+
+@implementation MMBundleURLProtocol
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request {
+    MMAssetBundle *bundle = [MMAssetBundle activeBundle];
+    return bundle && [request.HTTPMethod isEqualToString:@"GET"] && [bundle containsURL:request.URL];
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request {
+    return request;
+}
+
+- (void)startLoading {
+    NSString *contentType = nil;
+    NSData *data = [[MMAssetBundle activeBundle] dataForURL:self.request.URL contentType:&contentType];
+    if (!data) {
+        [self.client URLProtocol:self
+                didFailWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorResourceUnavailable userInfo:nil]];
+        return;
+    }
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.request.URL
+                                                              statusCode:200
+                                                             HTTPVersion:@"HTTP/1.1"
+                                                            headerFields:@{
+        @"Content-Type": contentType.length > 0 ? contentType : @"application/octet-stream",
+        @"Content-Length": [NSString stringWithFormat:@"%lu", (unsigned long)data.length],
+    }];
+    // Already on disk; a second copy in the URL cache would only cost space
+    [self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    [self.client URLProtocol:self didLoadData:data];
+    [self.client URLProtocolDidFinishLoading:self];
+}
+
+- (void)stopLoading {
+}
+
+@end
+
+@implementation MMAssetBundle {
+    std::unique_ptr<AssetBundle> _bundle;
+}
+
+static MMAssetBundle *MMActiveBundle;
+
++ (nullable MMAssetBundle *)activeBundle {
+    @synchronized (self) {
+        return MMActiveBundle;
+    }
+}
+
++ (void)setActiveBundle:(nullable MMAssetBundle *)bundle {
+    static dispatch_once_t registerOnce;
+    dispatch_once(&registerOnce, ^{
+        [NSURLProtocol registerClass:[MMBundleURLProtocol class]];
+    });
+    @synchronized (self) {
+        MMActiveBundle = bundle;
+    }
+}
+
++ (nullable instancetype)bundleWithPath:(NSString *)path error:(NSError **)error {
+    std::string openError;
+    std::unique_ptr<AssetBundle> bundle = AssetBundle::open(MMStdString(path), &openError);
+    if (!bundle) {
+        if (error) {
+            *error = MMBundleError([NSString stringWithFormat:@"Failed to open asset bundle %@: %s", path, openError.c_str()]);
+        }
+        return nil;
+    }
+
+    std::string manifestBytes;
+    const AssetBundle::Entry *entry = bundle->find(AssetBundle::kManifestKey);
+    NSDictionary *manifest = nil;
+    if (entry && bundle->read(*entry, &manifestBytes, &openError)) {
+        NSData *data = [NSData dataWithBytes:manifestBytes.data() length:manifestBytes.size()];
+        manifest = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+    }
+    NSString *appId = [manifest isKindOfClass:[NSDictionary class]] ? manifest[@"appId"] : nil;
+    NSString *baseURL = [manifest isKindOfClass:[NSDictionary class]] ? manifest[@"baseUrl"] : nil;
+    if (![appId isKindOfClass:[NSString class]] || ![baseURL isKindOfClass:[NSString class]] ||
+        ![NSURL URLWithString:baseURL]) {
+        if (error) {
+            *error = MMBundleError([NSString stringWithFormat:@"Asset bundle %@ has no valid manifest", path]);
+        }
+        return nil;
+    }
+    NSMutableArray<NSString *> *mapIds = [NSMutableArray array];
+    NSArray *maps = [manifest[@"maps"] isKindOfClass:[NSArray class]] ? manifest[@"maps"] : @[];
+    for (NSDictionary *map in maps) {
+        if ([map isKindOfClass:[NSDictionary class]] && [map[@"id"] isKindOfClass:[NSString class]]) {
+            [mapIds addObject:map[@"id"]];
+        }
+    }
+    NSNumber *pageSize = [manifest[@"pageSize"] isKindOfClass:[NSNumber class]] ? manifest[@"pageSize"] : nil;
+    return [[self alloc] initWithBundle:std::move(bundle)
+                                   path:path
+                                  appId:appId
+                                baseURL:[NSURL URLWithString:baseURL]
+                                 mapIds:mapIds
+                               pageSize:pageSize.unsignedIntegerValue];
+}
+
+- (instancetype)initWithBundle:(std::unique_ptr<AssetBundle>)bundle
+                          path:(NSString *)path
+                         appId:(NSString *)appId
+                       baseURL:(NSURL *)baseURL
+                        mapIds:(NSArray<NSString *> *)mapIds
+                      pageSize:(NSUInteger)pageSize {
+    if ((self = [super init])) {
+        _bundle = std::move(bundle);
+        _path = [path copy];
+        _appId = [appId copy];
+        _baseURL = [baseURL copy];
+        _mapIds = [mapIds copy];
+        _pageSize = pageSize;
+    }
+    return self;
+}
+
+- (NSUInteger)assetCount {
+    return _bundle->entries().size();
+}
+
+- (unsigned long long)byteSize {
+    return _bundle->byteSize();
+}
+
+- (BOOL)containsURL:(NSURL *)url {
+    return url && _bundle->findUrl(MMStdString(url.absoluteString)) != nullptr;
+}
+
+- (nullable NSData *)dataForURL:(NSURL *)url contentType:(NSString **)contentType {
+    const AssetBundle::Entry *entry = url ? _bundle->findUrl(MMStdString(url.absoluteString)) : nullptr;
+    if (!entry) {
+        return nil;
+    }
+    // Inflated into a heap buffer NSData takes over, so the bytes are not copied again
+    auto *bytes = new std::string();
+    std::string readError;
+    if (!_bundle->read(*entry, bytes, &readError)) {
+        NSLog(@"[MMAssetBundle] %s", readError.c_str());
+        delete bytes;
+        return nil;
+    }
+    if (contentType) {
+        *contentType = MMNSString(entry->contentType);
+    }
+    return [[NSData alloc] initWithBytesNoCopy:bytes->empty() ? nullptr : &(*bytes)[0]
+                                        length:bytes->size()
+                                   deallocator:^(void *, NSUInteger) {
+        delete bytes;
+    }];
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)stats {
+    const AssetBundleStats stats = _bundle->stats();
+    return @{
+        @"served": @(stats.served),
+        @"bytesServed": @(stats.bytesServed),
+        @"failures": @(stats.failures),
+    };
+}
+
+@end
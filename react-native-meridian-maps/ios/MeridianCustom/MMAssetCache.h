@@ -0,0 +1,57 @@
+#import <Foundation/Foundation.h>
+#import <Meridian/Meridian.h>
+
+#ifdef __cplusplus
+#include "AssetCache.h"
+#endif
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Process-wide disk cache of floor assets (cpp/AssetCache.h): map SVGs and
+ * images and placemark images, under Caches/meridianmaps/assets.
+ *
+ * The first use registers MMCacheURLProtocol, which answers GETs for cached
+ * URLs from disk. Other URLs the cache has been told about with registerMap:
+ * or registerPlacemarks: are fetched from the network by the protocol and
+ * stored when they answer 200; every other request passes through untouched.
+ * Recency is written to disk when the app moves to the background.
+ * Thread-safe.
+ */
+@interface MMAssetCache : NSObject
+
++ (instancetype)sharedCache;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Budget in bytes, 100 MB by default; lowering it evicts least recently used assets at once.
+@property (nonatomic) unsigned long long maxBytes;
+
+/// Makes the map's SVG and image cacheable.
+- (void)registerMap:(MRMap *)map;
+/// Makes the placemarks' images cacheable.
+- (void)registerPlacemarks:(NSArray<MRPlacemark *> *)placemarks;
+- (void)registerURL:(NSURL *)url;
+
+- (BOOL)shouldCacheURL:(NSURL *)url;
+- (BOOL)containsURL:(NSURL *)url;
+
+- (nullable NSData *)dataForURL:(NSURL *)url contentType:(NSString *_Nullable *_Nullable)contentType;
+- (void)storeData:(NSData *)data contentType:(nullable NSString *)contentType forURL:(NSURL *)url;
+
+- (void)clear;
+
+/**
+ * hits, bytesServed, misses, hitRate, stores, dedupStores, evictions and
+ * bytesEvicted since launch, then assets, bytes and maxBytes of the cache.
+ */
+- (NSDictionary<NSString *, NSNumber *> *)stats;
+
+@end
+
+#ifdef __cplusplus
+/// The shared cache's C++ core, for the Objective-C++ wrappers that fill it
+meridianmaps::AssetCache &MMAssetCacheCore(void);
+#endif
+
+NS_ASSUME_NONNULL_END
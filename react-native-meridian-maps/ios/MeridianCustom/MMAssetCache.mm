@@ -0,0 +1,268 @@
+#import "MMAssetCache.h"
+#import <UIKit/UIKit.h>
+
+#include <memory>
+#include <string>
+
+#include "AssetCache.h"
+
+using meridianmaps::AssetCache;
+using meridianmaps::AssetCacheStats;
+
+static const unsigned long long MMDefaultCacheBytes = 100ull << 20;
+
+// Set on the requests MMCacheURLProtocol sends itself, so it does not pick them up again
+static NSString *const MMCacheHandledKey = @"MMAssetCacheHandled";
+
+static std::string MMStdString(NSString *value) {
+    return value ? std::string(value.UTF8String) : std::string();
+}
+
+/**
+ * Answers GETs for cached URLs from disk and loads other cacheable URLs
+ * through its own session, storing what comes back.
+ */
+@interface MMCacheURLProtocol : NSURLProtocol
+@property (nonatomic, strong) NSURLSessionDataTask *task;
+@end
+
+@implementation MMCacheURLProtocol
+
++ (NSURLSession *)session {
+    static NSURLSession *session;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
+        // The disk cache keeps these; the shared URL cache would hold a second copy
+        configuration.URLCache = nil;
+        session = [NSURLSession sessionWithConfiguration:configuration];
+    });
+    return session;
+}
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request {
+    return [request.HTTPMethod isEqualToString:@"GET"] &&
+        ![NSURLProtocol propertyForKey:MMCacheHandledKey inRequest:request] &&
+        [[MMAssetCache sharedCache] shouldCacheURL:request.URL];
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request {
+    return request;
+}
+
+- (void)startLoading {
+    MMAssetCache *cache = [MMAssetCache sharedCache];
+    NSURL *url = self.request.URL;
+    NSString *contentType = nil;
+    NSData *data = [cache dataForURL:url contentType:&contentType];
+    if (data) {
+        NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:url
+                                                                  statusCode:200
+                                                                 HTTPVersion:@"HTTP/1.1"
+                                                                headerFields:@{
+            @"Content-Type": contentType.length > 0 ? contentType : @"application/octet-stream",
+            @"Content-Length": [NSString stringWithFormat:@"%lu", (unsigned long)data.length],
+        }];
+        [self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+        [self.client URLProtocol:self didLoadData:data];
+        [self.client URLProtocolDidFinishLoading:self];
+        return;
+    }
+
+    NSMutableURLRequest *request = [self.request mutableCopy];
+    [NSURLProtocol setProperty:@YES forKey:MMCacheHandledKey inRequest:request];
+    __weak typeof(self) weakSelf = self;
+    self.task = [[MMCacheURLProtocol session] dataTaskWithRequest:request
+                                                completionHandler:^(NSData *body, NSURLResponse *response, NSError *error) {
+        typeof(self) strongSelf = weakSelf;
+        if (!strongSelf) {
+            return;
+        }
+        if (error) {
+            [strongSelf.client URLProtocol:strongSelf didFailWithError:error];
+            return;
+        }
+        NSHTTPURLResponse *http = [response isKindOfClass:[NSHTTPURLResponse class]] ? (NSHTTPURLResponse *)response : nil;
+        if (http.statusCode == 200 && body.length > 0) {
+            [cache storeData:body contentType:http.allHeaderFields[@"Content-Type"] forURL:url];
+        }
+        [strongSelf.client URLProtocol:strongSelf didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+        if (body.length > 0) {
+            [strongSelf.client URLProtocol:strongSelf didLoadData:body];
+        }
+        [strongSelf.client URLProtocolDidFinishLoading:strongSelf];
+    }];
+    [self.task resume];
+}
+
+- (void)stopLoading {
+    [self.task cancel];
+    self.task = nil;
+}
+
+@end
+
+@implementation MMAssetCache {
+    std::unique_ptr<AssetCache> _cache;
+    // Guarded by @synchronized (self)
+    NSMutableSet<NSString *> *_registeredURLs;
+}
+
++ (instancetype)sharedCache {
+    static MMAssetCache *cache;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        cache = [[MMAssetCache alloc] initPrivate];
+        [NSURLProtocol registerClass:[MMCacheURLProtocol class]];
+    });
+    return cache;
+}
+
+- (instancetype)initPrivate {
+    if ((self = [super init])) {
+        NSString *caches = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+        NSString *directory = [caches stringByAppendingPathComponent:@"meridianmaps/assets"];
+        [[NSFileManager defaultManager] createDirectoryAtPath:directory.stringByDeletingLastPathComponent
+                                  withIntermediateDirectories:YES
+                                                   attributes:nil
+                                                        error:nil];
+        _cache = std::make_unique<AssetCache>(MMStdString(directory), MMDefaultCacheBytes);
+        std::string error;
+        if (!_cache->open(&error)) {
+            NSLog(@"[MMAssetCache] Failed to open %@: %s", directory, error.c_str());
+        } else {
+            NSLog(@"[MMAssetCache] Opened with %zu assets (%llu bytes)", _cache->size(), _cache->byteSize());
+        }
+        _registeredURLs = [NSMutableSet set];
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(flush)
+                                                     name:UIApplicationDidEnterBackgroundNotification
+                                                   object:nil];
+    }
+    return self;
+}
+
+- (unsigned long long)maxBytes {
+    return _cache->maxBytes();
+}
+
+- (void)setMaxBytes:(unsigned long long)maxBytes {
+    _cache->setMaxBytes(maxBytes);
+}
+
+- (void)registerMap:(MRMap *)map {
+    if (map.svgURL) {
+        [self registerURL:map.svgURL];
+    }
+    if (map.imageURL) {
+        [self registerURL:map.imageURL];
+    }
+}
+
+- (void)registerPlacemarks:(NSArray<MRPlacemark *> *)placemarks {
+    @synchronized (self) {
+        for (MRPlacemark *placemark in placemarks) {
+            if (placemark.imageURL.absoluteString) {
+                [_registeredURLs addObject:placemark.imageURL.absoluteString];
+            }
+        }
+    }
+}
+
+- (void)registerURL:(NSURL *)url {
+    if (!url.absoluteString) {
+        return;
+    }
+    @synchronized (self) {
+        [_registeredURLs addObject:url.absoluteString];
+    }
+}
+
+- (BOOL)shouldCacheURL:(NSURL *)url {
+    NSString *string = url.absoluteString;
+    if (!string) {
+        return NO;
+    }
+    @synchronized (self) {
+        if ([_registeredURLs containsObject:string]) {
+            return YES;
+        }
+    }
+    // Cached on an earlier launch, before this one saw the map again
+    return _cache->contains(MMStdString(string));
+}
+
+- (BOOL)containsURL:(NSURL *)url {
+    return url.absoluteString && _cache->contains(MMStdString(url.absoluteString));
+}
+
+- (nullable NSData *)dataForURL:(NSURL *)url contentType:(NSString **)contentType {
+    if (!url.absoluteString) {
+        return nil;
+    }
+    auto *bytes = new std::string();
+    std::string type;
+    if (!_cache->get(MMStdString(url.absoluteString), bytes, &type)) {
+        delete bytes;
+        return nil;
+    }
+    if (contentType) {
+        *contentType = [[NSString alloc] initWithBytes:type.data() length:type.size() encoding:NSUTF8StringEncoding];
+    }
+    // NSData takes over the buffer rather than copying it
+    return [[NSData alloc] initWithBytesNoCopy:&(*bytes)[0]
+                                        length:bytes->size()
+                                   deallocator:^(void *, NSUInteger) {
+        delete bytes;
+    }];
+}
+
+- (void)storeData:(NSData *)data contentType:(nullable NSString *)contentType forURL:(NSURL *)url {
+    if (!url.absoluteString || data.length == 0) {
+        return;
+    }
+    std::string error;
+    const std::string_view bytes(static_cast<const char *>(data.bytes), data.length);
+    if (!_cache->put(MMStdString(url.absoluteString), MMStdString(contentType), bytes, &error) && !error.empty()) {
+        NSLog(@"[MMAssetCache] Not caching %@: %s", url, error.c_str());
+    }
+}
+
+- (void)clear {
+    _cache->clear();
+}
+
+- (void)flush {
+    std::string error;
+    if (!_cache->flush(&error)) {
+        NSLog(@"[MMAssetCache] Failed to write the index: %s", error.c_str());
+    }
+}
+
+- (AssetCache &)core {
+    return *_cache;
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)stats {
+    const AssetCacheStats stats = _cache->stats();
+    const uint64_t lookups = stats.hits + stats.misses;
+    return @{
+        @"hits": @(stats.hits),
+        @"bytesServed": @(stats.bytesServed),
+        @"misses": @(stats.misses),
+        @"hitRate": @(lookups > 0 ? static_cast<double>(stats.hits) / lookups : 0.0),
+        @"stores": @(stats.stores),
+        @"dedupStores": @(stats.dedupStores),
+        @"evictions": @(stats.evictions),
+        @"bytesEvicted": @(stats.bytesEvicted),
+        @"assets": @(_cache->size()),
+        @"bytes": @(_cache->byteSize()),
+        @"maxBytes": @(_cache->maxBytes()),
+    };
+}
+
+@end
+
+AssetCache &MMAssetCacheCore(void) {
+    return [[MMAssetCache sharedCache] core];
+}
@@ -1,26 +0,0 @@
-#import <Foundation/Foundation.h>
-
-extern NSString *const MMEventCustomEvent;
-extern NSString *const MMEventMapLoadStart;
-extern NSString *const MMEventMapLoadFinish;
-extern NSString *const MMEventMapLoadFail;
-extern NSString *const MMEventLocationUpdated;
-extern NSString *const MMEventMarkerSelect;
-extern NSString *const MMEventMarkerDeselect;
-extern NSString *const MMEventError;
-extern NSString *const MMEventMapTransformChange;
-extern NSString *const MMEventOrientationUpdated;
-extern NSString *const MMEventDirectionsReroute;
-extern NSString *const MMEventDirectionsClick;
-extern NSString *const MMEventDirectionsStart;
-extern NSString *const MMEventRouteStepIndexChange;
-extern NSString *const MMEventDirectionsClosed;
-extern NSString *const MMEventDirectionsError;
-extern NSString *const MMEventUseAccessiblePathsChange;
-extern NSString *const MMEventMarkerForSelectedMarker;
-extern NSString *const MMEventCalloutClick;
-extern NSString *const MMEventDirectionsCalculated;
-extern NSString *const MMEventDirectionsRequestComplete;
-extern NSString *const MMEventDirectionsRequestError;
-extern NSString *const MMEventDirectionsRequestCanceled;
-extern NSString *const MMEventSearchActivityStarted;
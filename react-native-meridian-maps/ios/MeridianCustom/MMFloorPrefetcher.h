@@ -0,0 +1,41 @@
+#import <Foundation/Foundation.h>
+#import <Meridian/Meridian.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Downloads the floors a user is likely to open next into MMAssetCache
+ * (cpp/FloorPrefetcher.h), so switching to them renders from disk.
+ *
+ * Once a floor has loaded, the floors a level above and below it in its map
+ * group are fetched; once a route exists, every floor it crosses is, ahead
+ * of those. Downloads run one at a time on a utility queue with low task
+ * priority and stop at half the cache budget. Main queue only, except stats.
+ */
+@interface MMFloorPrefetcher : NSObject
+
++ (instancetype)sharedPrefetcher;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Replaces the queued neighbors with those of map; the route's floors stay queued.
+- (void)prefetchAroundMap:(MRMap *)map;
+
+/// Queues every floor the route's steps are on.
+- (void)prefetchRoute:(MRRoute *)route;
+
+/// Drops queued floors and any map lookups still running; a download in progress completes.
+- (void)cancel;
+
+/// Map views sharing the plan. Each mounted view adds itself; when the last
+/// one is removed the plan is cancelled, so one view going away leaves the
+/// floors the others queued.
+- (void)addClient;
+- (void)removeClient;
+
+/// queued, fetched, bytesFetched, alreadyCached, failures, cancelled and budgetStops.
+- (NSDictionary<NSString *, NSNumber *> *)stats;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,206 @@
+#import "MMFloorPrefetcher.h"
+#import "MMAssetCache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FloorPrefetcher.h"
+
+using meridianmaps::FloorPrefetcher;
+using meridianmaps::FloorPrefetchStats;
+using meridianmaps::HttpFetch;
+using meridianmaps::HttpRequest;
+using meridianmaps::HttpResponse;
+
+static std::string MMStdString(NSString *value) {
+    return value ? std::string(value.UTF8String) : std::string();
+}
+
+static FloorPrefetcher::Floor MMFloorFromMap(MRMap *map) {
+    FloorPrefetcher::Floor floor;
+    floor.mapId = MMStdString(map.key.identifier);
+    floor.groupId = MMStdString(map.groupKey.identifier);
+    floor.level = map.level;
+    if (map.svgURL) {
+        floor.urls.push_back(MMStdString(map.svgURL.absoluteString));
+    }
+    if (map.imageURL) {
+        floor.urls.push_back(MMStdString(map.imageURL.absoluteString));
+    }
+    return floor;
+}
+
+@interface MMFloorPrefetcher ()
+// Bumped by cancel so map lookups it did not stop in time are ignored
+@property (nonatomic, assign) NSUInteger generation;
+@property (nonatomic, strong) NSMutableArray<NSOperation *> *lookups;
+@property (nonatomic, assign) NSUInteger clients;
+@end
+
+@implementation MMFloorPrefetcher {
+    std::unique_ptr<FloorPrefetcher> _prefetcher;
+    dispatch_queue_t _queue;
+    HttpFetch _fetch;
+}
+
++ (instancetype)sharedPrefetcher {
+    static MMFloorPrefetcher *prefetcher;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        prefetcher = [[MMFloorPrefetcher alloc] initPrivate];
+    });
+    return prefetcher;
+}
+
+- (instancetype)initPrivate {
+    if ((self = [super init])) {
+        _prefetcher = std::make_unique<FloorPrefetcher>(MMAssetCacheCore());
+        _queue = dispatch_queue_create("com.meridianmaps.prefetch",
+                                       dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+        _lookups = [NSMutableArray array];
+
+        NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration ephemeralSessionConfiguration];
+        configuration.URLCache = nil;
+        configuration.networkServiceType = NSURLNetworkServiceTypeBackground;
+        NSURLSession *session = [NSURLSession sessionWithConfiguration:configuration];
+        _fetch = [session](const HttpRequest &request) {
+            __block HttpResponse response;
+            NSURL *url = [NSURL URLWithString:[NSString stringWithUTF8String:request.url.c_str()]];
+            if (!url) {
+                response.error = "invalid URL " + request.url;
+                return response;
+            }
+            dispatch_semaphore_t done = dispatch_semaphore_create(0);
+            NSURLSessionDataTask *task = [session dataTaskWithURL:url completionHandler:^(NSData *data, NSURLResponse *urlResponse, NSError *error) {
+                NSHTTPURLResponse *http = [urlResponse isKindOfClass:[NSHTTPURLResponse class]] ? (NSHTTPURLResponse *)urlResponse : nil;
+                if (error || !http) {
+                    response.error = MMStdString(error.localizedDescription ?: @"not an HTTP response");
+                } else {
+                    response.status = (int)http.statusCode;
+                    response.body.assign((const char *)data.bytes, data.length);
+                    response.contentType = MMStdString([http valueForHTTPHeaderField:@"Content-Type"]);
+                }
+                dispatch_semaphore_signal(done);
+            }];
+            // Behind whatever the visible map is loading
+            task.priority = NSURLSessionTaskPriorityLow;
+            [task resume];
+            dispatch_semaphore_wait(done, DISPATCH_TIME_FOREVER);
+            return response;
+        };
+    }
+    return self;
+}
+
+- (void)prefetchAroundMap:(MRMap *)map {
+    if (!map.key) {
+        return;
+    }
+    if (!map.groupKey) {
+        _prefetcher->openFloor(MMStdString(map.key.identifier), {MMFloorFromMap(map)});
+        return;
+    }
+    const NSUInteger generation = self.generation;
+    __weak typeof(self) weakSelf = self;
+    __block NSOperation *lookup = nil;
+    lookup = [MRMap getMapGroup:map.groupKey success:^(NSArray<MRMap *> *maps) {
+        typeof(self) strongSelf = weakSelf;
+        [strongSelf.lookups removeObject:lookup];
+        if (!strongSelf || strongSelf.generation != generation) {
+            return;
+        }
+        std::vector<FloorPrefetcher::Floor> group;
+        for (MRMap *floor in maps) {
+            [[MMAssetCache sharedCache] registerMap:floor];
+            group.push_back(MMFloorFromMap(floor));
+        }
+        const size_t queued = strongSelf->_prefetcher->openFloor(MMStdString(map.key.identifier), group);
+        NSLog(@"[MMFloorPrefetcher] Prefetching %zu floors next to %@", queued, map.key.identifier);
+        [strongSelf pump];
+    } failure:^(NSError *error) {
+        [weakSelf.lookups removeObject:lookup];
+        NSLog(@"[MMFloorPrefetcher] Failed to load the map group of %@: %@", map.key.identifier, error.localizedDescription);
+    }];
+    if (lookup) {
+        [self.lookups addObject:lookup];
+    }
+}
+
+- (void)prefetchRoute:(MRRoute *)route {
+    _prefetcher->clearRoute();
+    NSMutableOrderedSet<NSString *> *mapIds = [NSMutableOrderedSet orderedSet];
+    NSMutableArray<MREditorKey *> *mapKeys = [NSMutableArray array];
+    for (MRRouteStep *step in route.steps) {
+        if (step.mapKey.identifier && ![mapIds containsObject:step.mapKey.identifier]) {
+            [mapIds addObject:step.mapKey.identifier];
+            [mapKeys addObject:step.mapKey];
+        }
+    }
+    const NSUInteger generation = self.generation;
+    __weak typeof(self) weakSelf = self;
+    // Looked up in route order and queued as they arrive; the SDK answers known floors from memory
+    for (MREditorKey *mapKey in mapKeys) {
+        __block NSOperation *lookup = nil;
+        lookup = [MRMap getMap:mapKey success:^(MRMap *map) {
+            typeof(self) strongSelf = weakSelf;
+            [strongSelf.lookups removeObject:lookup];
+            if (!strongSelf || strongSelf.generation != generation) {
+                return;
+            }
+            [[MMAssetCache sharedCache] registerMap:map];
+            strongSelf->_prefetcher->addRouteFloor(MMFloorFromMap(map));
+            [strongSelf pump];
+        } failure:^(NSError *error) {
+            [weakSelf.lookups removeObject:lookup];
+            NSLog(@"[MMFloorPrefetcher] Failed to load route floor %@: %@", mapKey.identifier, error.localizedDescription);
+        }];
+        if (lookup) {
+            [self.lookups addObject:lookup];
+        }
+    }
+}
+
+- (void)cancel {
+    self.generation++;
+    for (NSOperation *lookup in self.lookups) {
+        [lookup cancel];
+    }
+    [self.lookups removeAllObjects];
+    _prefetcher->cancel();
+}
+
+- (void)addClient {
+    self.clients++;
+}
+
+- (void)removeClient {
+    if (self.clients > 0 && --self.clients == 0) {
+        [self cancel];
+    }
+}
+
+// The queue is serial, so a pump behind a running one finds nothing left
+- (void)pump {
+    FloorPrefetcher *prefetcher = _prefetcher.get();
+    HttpFetch fetch = _fetch;
+    dispatch_async(_queue, ^{
+        while (prefetcher->step(fetch)) {
+        }
+    });
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)stats {
+    const FloorPrefetchStats stats = _prefetcher->stats();
+    return @{
+        @"queued": @(stats.queued),
+        @"fetched": @(stats.fetched),
+        @"bytesFetched": @(stats.bytesFetched),
+        @"alreadyCached": @(stats.alreadyCached),
+        @"failures": @(stats.failures),
+        @"cancelled": @(stats.cancelled),
+        @"budgetStops": @(stats.budgetStops),
+    };
+}
+
+@end
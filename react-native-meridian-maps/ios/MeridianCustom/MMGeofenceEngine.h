@@ -0,0 +1,36 @@
+#import <Foundation/Foundation.h>
+#import <Meridian/Meridian.h>
+#import "MMLocationFilter.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+extern NSString *const MMGeofenceErrorDomain;
+
+/**
+ * Objective-C face of the shared C++ geofence engine (cpp/GeofenceEngine.h).
+ *
+ * A geofence is a dictionary with an id and either a polygon ([{x, y}]) and
+ * mapKey, or a placemarkId. Placemark geofences wait until the placemark's
+ * floor loads and then take its area, or a circle of radius around its point
+ * when it has none. hysteresis and dwellMs are optional. Main queue only.
+ */
+@interface MMGeofenceEngine : NSObject
+
+/// Geofences registered, including the ones waiting for their placemark
+@property (nonatomic, readonly) NSUInteger count;
+
+/// Adds or replaces every geofence, or none of them if one is invalid.
+- (BOOL)addGeofences:(NSArray<NSDictionary *> *)geofences error:(NSError **)error;
+
+/// Forgets the geofences without reporting exits; nil forgets all of them.
+- (void)removeGeofencesWithIDs:(nullable NSArray<NSString *> *)ids;
+
+/// Resolves the waiting geofences whose placemark is among these.
+- (void)resolvePlacemarks:(NSArray<MRPlacemark *> *)placemarks;
+
+/// The transitions the fix causes, exits first, as {type, id, timestamp}.
+- (NSArray<NSDictionary *> *)transitionsForFix:(MMLocationFix *)fix;
+
+@end
+
+NS_ASSUME_NONNULL_END
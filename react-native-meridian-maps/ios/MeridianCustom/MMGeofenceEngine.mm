@@ -0,0 +1,245 @@
+#import "MMGeofenceEngine.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "GeofenceEngine.h"
+
+using meridianmaps::GeofenceEngine;
+using meridianmaps::GeofencePoint;
+using meridianmaps::GeofenceRegion;
+using meridianmaps::GeofenceTransition;
+
+NSString *const MMGeofenceErrorDomain = @"MMGeofenceErrorDomain";
+
+// Radius in map units of a placemark geofence whose placemark has no area
+static const float MMDefaultPlacemarkRadius = 10;
+
+namespace {
+
+// A placemark geofence until its placemark loads
+struct PendingGeofence {
+    GeofenceRegion region;
+    std::string placemarkID;
+    float radius;
+};
+
+}  // namespace
+
+static NSError *MMGeofenceError(NSString *message) {
+    return [NSError errorWithDomain:MMGeofenceErrorDomain code:1 userInfo:@{NSLocalizedDescriptionKey: message}];
+}
+
+static NSString *_Nullable MMString(NSDictionary *geofence, NSString *key) {
+    id value = geofence[key];
+    return [value isKindOfClass:[NSString class]] && [value length] > 0 ? value : nil;
+}
+
+static NSNumber *_Nullable MMNumber(NSDictionary *geofence, NSString *key) {
+    id value = geofence[key];
+    return [value isKindOfClass:[NSNumber class]] ? value : nil;
+}
+
+static void MMAddPathPoint(void *info, const CGPathElement *element) {
+    auto *polygon = static_cast<std::vector<GeofencePoint> *>(info);
+    const CGPoint *points = element->points;
+    switch (element->type) {
+        case kCGPathElementMoveToPoint:
+            // Only the first subpath is used
+            if (!polygon->empty()) {
+                return;
+            }
+            polygon->push_back({static_cast<float>(points[0].x), static_cast<float>(points[0].y)});
+            break;
+        case kCGPathElementAddLineToPoint:
+            polygon->push_back({static_cast<float>(points[0].x), static_cast<float>(points[0].y)});
+            break;
+        // Curves keep their end point; placemark areas are drawn as polygons
+        case kCGPathElementAddQuadCurveToPoint:
+            polygon->push_back({static_cast<float>(points[1].x), static_cast<float>(points[1].y)});
+            break;
+        case kCGPathElementAddCurveToPoint:
+            polygon->push_back({static_cast<float>(points[2].x), static_cast<float>(points[2].y)});
+            break;
+        case kCGPathElementCloseSubpath:
+            break;
+    }
+}
+
+@implementation MMGeofenceEngine {
+    GeofenceEngine _engine;
+    std::vector<PendingGeofence> _pending;
+}
+
+- (NSUInteger)count {
+    return _engine.size() + _pending.size();
+}
+
+- (BOOL)addGeofences:(NSArray<NSDictionary *> *)geofences error:(NSError **)error {
+    // Check them all before touching the engine
+    std::vector<GeofenceRegion> regions;
+    std::vector<PendingGeofence> pending;
+    for (id entry in geofences) {
+        if (![entry isKindOfClass:[NSDictionary class]]) {
+            if (error) {
+                *error = MMGeofenceError(@"A geofence must be an object");
+            }
+            return NO;
+        }
+        NSDictionary *geofence = entry;
+        NSString *placemarkID = MMString(geofence, @"placemarkId");
+        NSString *identifier = MMString(geofence, @"id") ?: placemarkID;
+        if (!identifier) {
+            if (error) {
+                *error = MMGeofenceError(@"A geofence needs an id");
+            }
+            return NO;
+        }
+        GeofenceRegion region;
+        region.id = identifier.UTF8String;
+        region.hysteresis = [MMNumber(geofence, @"hysteresis") floatValue];
+        region.dwellMs = [MMNumber(geofence, @"dwellMs") longLongValue];
+
+        id polygon = geofence[@"polygon"];
+        if ([polygon isKindOfClass:[NSArray class]]) {
+            NSString *mapKey = MMString(geofence, @"mapKey");
+            if (!mapKey) {
+                if (error) {
+                    *error = MMGeofenceError([NSString stringWithFormat:@"Geofence %@ needs the mapKey of its polygon", identifier]);
+                }
+                return NO;
+            }
+            region.mapKey = mapKey.UTF8String;
+            for (id vertex in polygon) {
+                NSNumber *x = [vertex isKindOfClass:[NSDictionary class]] ? MMNumber(vertex, @"x") : nil;
+                NSNumber *y = [vertex isKindOfClass:[NSDictionary class]] ? MMNumber(vertex, @"y") : nil;
+                if (!x || !y) {
+                    if (error) {
+                        *error = MMGeofenceError([NSString stringWithFormat:@"Geofence %@ has a vertex without x and y", identifier]);
+                    }
+                    return NO;
+                }
+                region.polygon.push_back({x.floatValue, y.floatValue});
+            }
+            // The engine's own checks, so a bad polygon cannot leave the batch half added
+            std::string message;
+            GeofenceEngine scratch;
+            if (!scratch.add(region, &message)) {
+                if (error) {
+                    *error = MMGeofenceError([NSString stringWithUTF8String:message.c_str()]);
+                }
+                return NO;
+            }
+            regions.push_back(std::move(region));
+        } else if (placemarkID) {
+            NSNumber *radius = MMNumber(geofence, @"radius");
+            pending.push_back({std::move(region), placemarkID.UTF8String,
+                               radius ? radius.floatValue : MMDefaultPlacemarkRadius});
+        } else {
+            if (error) {
+                *error = MMGeofenceError([NSString stringWithFormat:@"Geofence %@ needs a polygon or a placemarkId", identifier]);
+            }
+            return NO;
+        }
+    }
+
+    for (GeofenceRegion &region : regions) {
+        [self forgetPendingWithID:region.id];
+        _engine.add(std::move(region));
+    }
+    for (PendingGeofence &geofence : pending) {
+        [self forgetPendingWithID:geofence.region.id];
+        _engine.remove(geofence.region.id);
+        _pending.push_back(std::move(geofence));
+    }
+    return YES;
+}
+
+- (void)forgetPendingWithID:(const std::string &)identifier {
+    _pending.erase(std::remove_if(_pending.begin(), _pending.end(),
+                                  [&identifier](const PendingGeofence &geofence) { return geofence.region.id == identifier; }),
+                   _pending.end());
+}
+
+- (void)removeGeofencesWithIDs:(NSArray<NSString *> *)ids {
+    if (!ids) {
+        _engine.clear();
+        _pending.clear();
+        return;
+    }
+    for (id identifier in ids) {
+        if (![identifier isKindOfClass:[NSString class]]) {
+            continue;
+        }
+        const std::string key = [identifier UTF8String];
+        _engine.remove(key);
+        [self forgetPendingWithID:key];
+    }
+}
+
+- (void)resolvePlacemarks:(NSArray<MRPlacemark *> *)placemarks {
+    if (_pending.empty()) {
+        return;
+    }
+    std::unordered_set<std::string> waiting;
+    for (const PendingGeofence &geofence : _pending) {
+        waiting.insert(geofence.placemarkID);
+    }
+    NSMutableDictionary<NSString *, MRPlacemark *> *byID = [NSMutableDictionary dictionary];
+    for (MRPlacemark *placemark in placemarks) {
+        NSString *identifier = placemark.key.identifier;
+        if (identifier && placemark.key.parent.identifier && waiting.count(identifier.UTF8String)) {
+            byID[identifier] = placemark;
+        }
+    }
+    if (byID.count == 0) {
+        return;
+    }
+
+    std::vector<PendingGeofence> stillPending;
+    for (PendingGeofence &geofence : _pending) {
+        MRPlacemark *placemark = byID[[NSString stringWithUTF8String:geofence.placemarkID.c_str()]];
+        if (!placemark) {
+            stillPending.push_back(std::move(geofence));
+            continue;
+        }
+        GeofenceRegion region = std::move(geofence.region);
+        region.mapKey = placemark.key.parent.identifier.UTF8String;
+        if (placemark.area) {
+            CGPathApply(placemark.area.CGPath, &region.polygon, MMAddPathPoint);
+        }
+        if (region.polygon.size() < 3) {
+            region.polygon = meridianmaps::circlePolygon(static_cast<float>(placemark.point.x),
+                                                         static_cast<float>(placemark.point.y), geofence.radius);
+        }
+        std::string message;
+        if (!_engine.add(std::move(region), &message)) {
+            NSLog(@"[MMGeofenceEngine] Skipping placemark %s: %s", geofence.placemarkID.c_str(), message.c_str());
+        }
+    }
+    _pending = std::move(stillPending);
+}
+
+- (NSArray<NSDictionary *> *)transitionsForFix:(MMLocationFix *)fix {
+    if (_engine.size() == 0) {
+        return @[];
+    }
+    std::vector<GeofenceTransition> transitions;
+    _engine.update(MMLocationSampleFromFix(fix), &transitions);
+    NSMutableArray<NSDictionary *> *result = [NSMutableArray arrayWithCapacity:transitions.size()];
+    for (const GeofenceTransition &transition : transitions) {
+        NSString *type = transition.type == GeofenceTransition::Type::Enter  ? @"enter"
+                         : transition.type == GeofenceTransition::Type::Exit ? @"exit"
+                                                                             : @"dwell";
+        [result addObject:@{
+            @"type": type,
+            @"id": [NSString stringWithUTF8String:transition.id.c_str()] ?: @"",
+            @"timestamp": @(transition.timestampMs)
+        }];
+    }
+    return result;
+}
+
+@end
@@ -0,0 +1,59 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@protocol MMMotionListener <NSObject>
+- (void)motionMonitorDidChangeMoving:(BOOL)moving;
+@end
+
+/**
+ * Shared accelerometer watcher telling moving from still (cpp/LocationDutyCycle.h).
+ * The accelerometer only runs while someone listens; without one the device
+ * always counts as moving. Main queue only.
+ */
+@interface MMMotionMonitor : NSObject
+
++ (instancetype)sharedMonitor;
+
+@property (nonatomic, readonly, getter=isMoving) BOOL moving;
+
+/// Listeners are held weakly.
+- (void)addListener:(id<MMMotionListener>)listener;
+- (void)removeListener:(id<MMMotionListener>)listener;
+
+@end
+
+/// Called when the location manager should start (YES) or stop (NO)
+typedef void (^MMDutyCycleHandler)(BOOL running);
+
+/**
+ * Objective-C face of the shared C++ location duty cycle
+ * (cpp/LocationDutyCycle.h): pauses a view's location manager while the
+ * device is still or the view is hidden, and resumes it on motion. Listens
+ * to MMMotionMonitor only while enabled. Main queue only.
+ */
+@interface MMLocationDutyCycle : NSObject <MMMotionListener>
+
+- (instancetype)initWithHandler:(MMDutyCycleHandler)handler;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, readonly, getter=isRunning) BOOL running;
+
+/// enabled, stillDelayMs, stillPollIntervalMs, pollTimeoutMs and pauseWhenHidden; missing keys keep their defaults.
+- (void)setOptions:(nullable NSDictionary *)options;
+
+/// On screen with the app in the foreground
+- (void)setVisible:(BOOL)visible;
+
+/// A fix from the location manager
+- (void)recordFix;
+
+/// activeMs, pollingMs, pausedMs, fixes, pauses, motionResumes and polls for this view.
+@property (nonatomic, readonly) NSDictionary<NSString *, NSNumber *> *stats;
+
+/// The same counters summed over every duty cycle of the process, including removed views.
++ (NSDictionary<NSString *, NSNumber *> *)totalStats;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,241 @@
+#import "MMLocationDutyCycle.h"
+#import <CoreMotion/CoreMotion.h>
+#import <QuartzCore/QuartzCore.h>
+
+#include <limits>
+
+#include "LocationDutyCycle.h"
+
+using meridianmaps::LocationDutyCycle;
+using meridianmaps::LocationDutyCycleOptions;
+using meridianmaps::LocationDutyCycleStats;
+using meridianmaps::MotionDetector;
+
+// Accelerometer rate; enough to catch someone picking the device up
+static const NSTimeInterval MMMotionSampleInterval = 0.1;
+
+// Counters of duty cycles that have been deallocated
+static LocationDutyCycleStats MMRetiredDutyStats;
+
+static int64_t MMNowMs(void) {
+    return static_cast<int64_t>(CACurrentMediaTime() * 1000.0);
+}
+
+static int64_t MMMilliseconds(NSDictionary *options, NSString *key, int64_t fallback) {
+    id value = options[key];
+    return [value isKindOfClass:[NSNumber class]] ? [value longLongValue] : fallback;
+}
+
+static NSDictionary<NSString *, NSNumber *> *MMDutyStatsDictionary(const LocationDutyCycleStats &stats) {
+    return @{
+        @"activeMs": @(stats.activeMs),
+        @"pollingMs": @(stats.pollingMs),
+        @"pausedMs": @(stats.pausedMs),
+        @"fixes": @(stats.fixes),
+        @"pauses": @(stats.pauses),
+        @"motionResumes": @(stats.motionResumes),
+        @"polls": @(stats.polls)
+    };
+}
+
+@implementation MMMotionMonitor {
+    CMMotionManager *_motionManager;
+    MotionDetector _detector;
+    NSHashTable<id<MMMotionListener>> *_listeners;
+}
+
++ (instancetype)sharedMonitor {
+    static MMMotionMonitor *monitor;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        monitor = [[MMMotionMonitor alloc] init];
+    });
+    return monitor;
+}
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        _motionManager = [[CMMotionManager alloc] init];
+        _motionManager.accelerometerUpdateInterval = MMMotionSampleInterval;
+        _listeners = [NSHashTable weakObjectsHashTable];
+    }
+    return self;
+}
+
+- (BOOL)isMoving {
+    return _detector.moving();
+}
+
+- (void)addListener:(id<MMMotionListener>)listener {
+    [_listeners addObject:listener];
+    if (_motionManager.accelerometerActive || !_motionManager.accelerometerAvailable) {
+        return;
+    }
+    __weak typeof(self) weakSelf = self;
+    [_motionManager startAccelerometerUpdatesToQueue:[NSOperationQueue mainQueue]
+                                         withHandler:^(CMAccelerometerData *data, NSError *error) {
+        if (data) {
+            [weakSelf addSample:data];
+        }
+    }];
+}
+
+- (void)removeListener:(id<MMMotionListener>)listener {
+    [_listeners removeObject:listener];
+    if (_listeners.allObjects.count == 0 && _motionManager.accelerometerActive) {
+        [_motionManager stopAccelerometerUpdates];
+        // Moving until the next listener's samples say otherwise
+        _detector.reset();
+    }
+}
+
+- (void)addSample:(CMAccelerometerData *)data {
+    const CMAcceleration acceleration = data.acceleration;
+    if (!_detector.addSample(acceleration.x, acceleration.y, acceleration.z, MMNowMs())) {
+        return;
+    }
+    const BOOL moving = _detector.moving();
+    for (id<MMMotionListener> listener in _listeners.allObjects) {
+        [listener motionMonitorDidChangeMoving:moving];
+    }
+}
+
+@end
+
+@implementation MMLocationDutyCycle {
+    LocationDutyCycle _cycle;
+    MMDutyCycleHandler _handler;
+    NSTimer *_timer;
+    int64_t _timerDueMs;
+    BOOL _listening;
+}
+
+// Every live duty cycle, for totalStats
++ (NSHashTable<MMLocationDutyCycle *> *)liveCycles {
+    static NSHashTable<MMLocationDutyCycle *> *cycles;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        cycles = [NSHashTable weakObjectsHashTable];
+    });
+    return cycles;
+}
+
+- (instancetype)initWithHandler:(MMDutyCycleHandler)handler {
+    if ((self = [super init])) {
+        _cycle = LocationDutyCycle(MMNowMs());
+        _handler = [handler copy];
+        [[MMLocationDutyCycle liveCycles] addObject:self];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [_timer invalidate];
+    if (_listening) {
+        [[MMMotionMonitor sharedMonitor] removeListener:self];
+    }
+    MMRetiredDutyStats += _cycle.stats(MMNowMs());
+}
+
+- (BOOL)isRunning {
+    return _cycle.running();
+}
+
+- (void)setOptions:(NSDictionary *)options {
+    LocationDutyCycleOptions cycleOptions;
+    id enabled = options[@"enabled"];
+    cycleOptions.enabled = [enabled isKindOfClass:[NSNumber class]] && [enabled boolValue];
+    id pauseWhenHidden = options[@"pauseWhenHidden"];
+    if ([pauseWhenHidden isKindOfClass:[NSNumber class]]) {
+        cycleOptions.pauseWhenHidden = [pauseWhenHidden boolValue];
+    }
+    cycleOptions.stillDelayMs = MMMilliseconds(options, @"stillDelayMs", cycleOptions.stillDelayMs);
+    cycleOptions.stillPollIntervalMs = MMMilliseconds(options, @"stillPollIntervalMs", cycleOptions.stillPollIntervalMs);
+    cycleOptions.pollTimeoutMs = MMMilliseconds(options, @"pollTimeoutMs", cycleOptions.pollTimeoutMs);
+
+    // Only adaptive views keep the accelerometer running
+    MMMotionMonitor *monitor = [MMMotionMonitor sharedMonitor];
+    if (cycleOptions.enabled && !_listening) {
+        [monitor addListener:self];
+        _listening = YES;
+    } else if (!cycleOptions.enabled && _listening) {
+        [monitor removeListener:self];
+        _listening = NO;
+    }
+    const int64_t now = MMNowMs();
+    [self apply:^{
+        self->_cycle.setMoving(monitor.moving, now);
+        self->_cycle.setOptions(cycleOptions, now);
+    }];
+}
+
+- (void)setVisible:(BOOL)visible {
+    [self apply:^{
+        self->_cycle.setVisible(visible, MMNowMs());
+    }];
+}
+
+- (void)recordFix {
+    [self apply:^{
+        self->_cycle.recordFix(MMNowMs());
+    }];
+}
+
+- (void)motionMonitorDidChangeMoving:(BOOL)moving {
+    [self apply:^{
+        self->_cycle.setMoving(moving, MMNowMs());
+    }];
+}
+
+// Runs a change, tells the handler if running flipped and re-arms the timer
+- (void)apply:(void (^)(void))change {
+    const BOOL wasRunning = _cycle.running();
+    change();
+    [self scheduleUpdate];
+    if (_cycle.running() != wasRunning) {
+        _handler(_cycle.running());
+    }
+}
+
+- (void)scheduleUpdate {
+    const int64_t due = _cycle.nextUpdateMs();
+    // Most changes, such as fixes while active, leave the deadline alone
+    if (_timer.valid && due == _timerDueMs) {
+        return;
+    }
+    [_timer invalidate];
+    _timer = nil;
+    if (due == std::numeric_limits<int64_t>::max()) {
+        return;
+    }
+    _timerDueMs = due;
+    __weak typeof(self) weakSelf = self;
+    const NSTimeInterval delay = MAX(due - MMNowMs(), 0) / 1000.0;
+    _timer = [NSTimer scheduledTimerWithTimeInterval:delay repeats:NO block:^(NSTimer *timer) {
+        MMLocationDutyCycle *strongSelf = weakSelf;
+        if (!strongSelf) {
+            return;
+        }
+        strongSelf->_timer = nil;
+        [strongSelf apply:^{
+            strongSelf->_cycle.update(MMNowMs());
+        }];
+    }];
+    // Lets the system batch the wake with others
+    _timer.tolerance = MIN(delay * 0.1, 1.0);
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)stats {
+    return MMDutyStatsDictionary(_cycle.stats(MMNowMs()));
+}
+
++ (NSDictionary<NSString *, NSNumber *> *)totalStats {
+    LocationDutyCycleStats total = MMRetiredDutyStats;
+    const int64_t now = MMNowMs();
+    for (MMLocationDutyCycle *cycle in [self liveCycles].allObjects) {
+        total += cycle->_cycle.stats(now);
+    }
+    return MMDutyStatsDictionary(total);
+}
+
+@end
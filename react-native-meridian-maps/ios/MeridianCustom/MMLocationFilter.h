@@ -0,0 +1,67 @@
+#import <CoreGraphics/CoreGraphics.h>
+#import <Foundation/Foundation.h>
+#import <Meridian/Meridian.h>
+
+#ifdef __cplusplus
+#include "LocationSample.h"
+#endif
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// A location fix on its way to JS, smoothed or as reported.
+@interface MMLocationFix : NSObject
+
+@property (nonatomic, readonly) CGPoint point;
+/// The position the location manager reported
+@property (nonatomic, readonly) CGPoint rawPoint;
+@property (nonatomic, readonly) CGFloat accuracy;
+/// Milliseconds since the epoch
+@property (nonatomic, readonly) int64_t timestamp;
+@property (nonatomic, readonly, copy) NSString *mapKey;
+@property (nonatomic, readonly) NSInteger providerType;
+
+/// Velocity in map units per second; only set on smoothed fixes
+@property (nonatomic, readonly) BOOL hasVelocity;
+@property (nonatomic, readonly) CGVector velocity;
+@property (nonatomic, readonly) CGFloat speed;
+/// Degrees clockwise from map up; only set when hasHeading
+@property (nonatomic, readonly) BOOL hasHeading;
+@property (nonatomic, readonly) CGFloat heading;
+
+/// The fix exactly as reported, without velocity or heading
++ (instancetype)fixWithLocation:(MRLocation *)location;
+
+/// A reported fix from its parts, e.g. one read back from a location trace
+- (instancetype)initWithPoint:(CGPoint)point
+                     accuracy:(CGFloat)accuracy
+                    timestamp:(int64_t)timestamp
+                       mapKey:(NSString *)mapKey
+                 providerType:(NSInteger)providerType NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+/**
+ * Objective-C face of the shared C++ location filter (cpp/LocationFilter.h): a
+ * constant-velocity Kalman filter that smooths fixes and estimates velocity and
+ * heading. Starts over on a floor or provider change. Main queue only.
+ */
+@interface MMLocationFilter : NSObject
+
+/// When NO, fixes pass through unchanged. Defaults to YES.
+@property (nonatomic, assign) BOOL enabled;
+
+/// Smooths a reported fix
+- (MMLocationFix *)filterFix:(MMLocationFix *)fix;
+
+/// Forgets the current track.
+- (void)reset;
+
+@end
+
+#ifdef __cplusplus
+/// The fix as the C++ core sees it, for the Objective-C++ wrappers
+meridianmaps::LocationSample MMLocationSampleFromFix(MMLocationFix *fix);
+#endif
+
+NS_ASSUME_NONNULL_END
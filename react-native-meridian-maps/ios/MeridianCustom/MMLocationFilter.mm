@@ -0,0 +1,95 @@
+#import "MMLocationFilter.h"
+
+#include "LocationFilter.h"
+
+using meridianmaps::LocationEstimate;
+using meridianmaps::LocationFilter;
+using meridianmaps::LocationSample;
+
+LocationSample MMLocationSampleFromFix(MMLocationFix *fix) {
+    LocationSample sample;
+    sample.mapKey = fix.mapKey.UTF8String;
+    sample.x = fix.point.x;
+    sample.y = fix.point.y;
+    sample.accuracy = fix.accuracy;
+    sample.timestampMs = fix.timestamp;
+    sample.providerType = static_cast<int>(fix.providerType);
+    return sample;
+}
+
+@implementation MMLocationFix
+
+- (instancetype)initWithPoint:(CGPoint)point
+                     accuracy:(CGFloat)accuracy
+                    timestamp:(int64_t)timestamp
+                       mapKey:(NSString *)mapKey
+                 providerType:(NSInteger)providerType {
+    if ((self = [super init])) {
+        _point = point;
+        _rawPoint = point;
+        _accuracy = accuracy;
+        _timestamp = timestamp;
+        _mapKey = [mapKey copy];
+        _providerType = providerType;
+    }
+    return self;
+}
+
+- (instancetype)initWithFix:(MMLocationFix *)fix estimate:(const LocationEstimate &)estimate {
+    if ((self = [self initWithPoint:fix.point
+                           accuracy:fix.accuracy
+                          timestamp:fix.timestamp
+                             mapKey:fix.mapKey
+                       providerType:fix.providerType])) {
+        _point = CGPointMake(estimate.sample.x, estimate.sample.y);
+        _accuracy = estimate.sample.accuracy;
+        _hasVelocity = YES;
+        _velocity = CGVectorMake(estimate.vx, estimate.vy);
+        _speed = estimate.speed;
+        _hasHeading = estimate.hasHeading;
+        _heading = estimate.heading;
+    }
+    return self;
+}
+
++ (instancetype)fixWithLocation:(MRLocation *)location {
+    return [[self alloc] initWithPoint:location.point
+                              accuracy:location.accuracy
+                             timestamp:static_cast<int64_t>(location.timestamp.timeIntervalSince1970 * 1000.0)
+                                mapKey:location.mapKey.identifier ?: @""
+                          providerType:location.providerType];
+}
+
+@end
+
+@implementation MMLocationFilter {
+    LocationFilter _filter;
+}
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        _enabled = YES;
+    }
+    return self;
+}
+
+- (void)setEnabled:(BOOL)enabled {
+    if (enabled != _enabled) {
+        _enabled = enabled;
+        _filter.reset();
+    }
+}
+
+- (MMLocationFix *)filterFix:(MMLocationFix *)fix {
+    if (!_enabled) {
+        return fix;
+    }
+    const LocationEstimate estimate = _filter.update(MMLocationSampleFromFix(fix));
+    return [[MMLocationFix alloc] initWithFix:fix estimate:estimate];
+}
+
+- (void)reset {
+    _filter.reset();
+}
+
+@end
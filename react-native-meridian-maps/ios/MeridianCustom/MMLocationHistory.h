@@ -0,0 +1,33 @@
+#import <Foundation/Foundation.h>
+#import "MMLocationFilter.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Objective-C face of the shared C++ location history (cpp/LocationHistory.h):
+ * recent fixes delta-encoded in a fixed-size ring buffer. Main queue only.
+ */
+@interface MMLocationHistory : NSObject
+
+- (instancetype)initWithCapacity:(NSUInteger)capacityBytes NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Bytes of encoded fixes to keep; shrinking keeps the newest fixes.
+@property (nonatomic, assign) NSUInteger capacity;
+/// Fixes held
+@property (nonatomic, readonly) NSUInteger count;
+
+- (void)appendFix:(MMLocationFix *)fix;
+
+/**
+ * Fixes matching since, until (ms since the epoch), mapKey and bbox
+ * ({minX, minY, maxX, maxY}), downsampled to maxPoints; missing keys match
+ * everything. Returns points, oldest first, and how many matched.
+ */
+- (NSDictionary *)queryWithOptions:(nullable NSDictionary *)options;
+
+- (void)clear;
+
+@end
+
+NS_ASSUME_NONNULL_END
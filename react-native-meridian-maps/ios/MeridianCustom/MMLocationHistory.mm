@@ -0,0 +1,94 @@
+#import "MMLocationHistory.h"
+
+#include "LocationHistory.h"
+
+using meridianmaps::LocationHistory;
+using meridianmaps::LocationHistoryQuery;
+using meridianmaps::LocationHistoryResult;
+using meridianmaps::LocationSample;
+
+static NSNumber *_Nullable MMNumber(NSDictionary *options, NSString *key) {
+    id value = options[key];
+    return [value isKindOfClass:[NSNumber class]] ? value : nil;
+}
+
+static LocationHistoryQuery MMHistoryQuery(NSDictionary *options) {
+    LocationHistoryQuery query;
+    if (NSNumber *since = MMNumber(options, @"since")) {
+        query.sinceMs = since.longLongValue;
+    }
+    if (NSNumber *until = MMNumber(options, @"until")) {
+        query.untilMs = until.longLongValue;
+    }
+    id mapKey = options[@"mapKey"];
+    if ([mapKey isKindOfClass:[NSString class]]) {
+        query.mapKey = [mapKey UTF8String];
+    }
+    id bbox = options[@"bbox"];
+    if ([bbox isKindOfClass:[NSDictionary class]]) {
+        query.hasBounds = true;
+        query.minX = [MMNumber(bbox, @"minX") doubleValue];
+        query.minY = [MMNumber(bbox, @"minY") doubleValue];
+        query.maxX = [MMNumber(bbox, @"maxX") doubleValue];
+        query.maxY = [MMNumber(bbox, @"maxY") doubleValue];
+    }
+    if (NSNumber *maxPoints = MMNumber(options, @"maxPoints")) {
+        query.maxPoints = static_cast<size_t>(MAX(maxPoints.longLongValue, 0LL));
+    }
+    return query;
+}
+
+@implementation MMLocationHistory {
+    LocationHistory _history;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacityBytes {
+    if ((self = [super init])) {
+        _history.setCapacity(capacityBytes);
+    }
+    return self;
+}
+
+- (NSUInteger)capacity {
+    return _history.capacityBytes();
+}
+
+- (void)setCapacity:(NSUInteger)capacity {
+    _history.setCapacity(capacity);
+}
+
+- (NSUInteger)count {
+    return _history.size();
+}
+
+- (void)appendFix:(MMLocationFix *)fix {
+    _history.append(MMLocationSampleFromFix(fix));
+}
+
+- (NSDictionary *)queryWithOptions:(NSDictionary *)options {
+    const LocationHistoryResult result = _history.query(MMHistoryQuery(options));
+    NSMutableArray<NSDictionary *> *points = [NSMutableArray arrayWithCapacity:result.points.size()];
+    // Fixes in a row mostly share a map, so reuse the last key's string
+    NSString *mapKey = nil;
+    std::string lastMapKey;
+    for (const LocationSample &sample : result.points) {
+        if (!mapKey || sample.mapKey != lastMapKey) {
+            lastMapKey = sample.mapKey;
+            mapKey = [NSString stringWithUTF8String:sample.mapKey.c_str()] ?: @"";
+        }
+        [points addObject:@{
+            @"x": @(sample.x),
+            @"y": @(sample.y),
+            @"accuracy": @(sample.accuracy),
+            @"timestamp": @(sample.timestampMs),
+            @"mapKey": mapKey
+        }];
+    }
+    return @{@"points": points, @"matched": @(result.matched)};
+}
+
+- (void)clear {
+    _history.clear();
+}
+
+@end
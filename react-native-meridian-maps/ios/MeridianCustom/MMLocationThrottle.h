@@ -0,0 +1,35 @@
+#import <Foundation/Foundation.h>
+#import "MMLocationFilter.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef void (^MMLocationHandler)(MMLocationFix *fix);
+
+/**
+ * Objective-C face of the shared C++ location throttle (cpp/LocationThrottle.h).
+ *
+ * Offered fixes reach the handler only when they are meaningful and the rate
+ * limit allows; a held fix is released from a timer, newest first. Main queue only.
+ */
+@interface MMLocationThrottle : NSObject
+
+- (instancetype)initWithHandler:(MMLocationHandler)handler;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// maxRateHz, minDisplacement, minAccuracyImprovement and coalesceWindowMs; missing keys turn that gate off.
+- (void)setOptions:(nullable NSDictionary *)options;
+
+- (void)offerFix:(MMLocationFix *)fix;
+
+/// Drops the held fix and forgets the last delivered one.
+- (void)reset;
+
+/// received, delivered, dropped and coalesced for this throttle.
+@property (nonatomic, readonly) NSDictionary<NSString *, NSNumber *> *stats;
+
+/// The same counters summed over every throttle of the process.
++ (NSDictionary<NSString *, NSNumber *> *)totalStats;
+
+@end
+
+NS_ASSUME_NONNULL_END
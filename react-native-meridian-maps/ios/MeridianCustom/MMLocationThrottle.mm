@@ -0,0 +1,112 @@
+#import "MMLocationThrottle.h"
+#import <QuartzCore/QuartzCore.h>
+
+#include "LocationThrottle.h"
+
+using meridianmaps::LocationSample;
+using meridianmaps::LocationThrottle;
+using meridianmaps::LocationThrottleOptions;
+using meridianmaps::LocationThrottleStats;
+
+static int64_t MMNowMs(void) {
+    return static_cast<int64_t>(CACurrentMediaTime() * 1000.0);
+}
+
+static double MMOption(NSDictionary *options, NSString *key) {
+    id value = options[key];
+    return [value isKindOfClass:[NSNumber class]] ? MAX([value doubleValue], 0.0) : 0.0;
+}
+
+static NSDictionary<NSString *, NSNumber *> *MMStatsDictionary(const LocationThrottleStats &stats) {
+    return @{
+        @"received": @(stats.received),
+        @"delivered": @(stats.delivered),
+        @"dropped": @(stats.dropped),
+        @"coalesced": @(stats.coalesced)
+    };
+}
+
+@implementation MMLocationThrottle {
+    LocationThrottle _throttle;
+    MMLocationHandler _handler;
+    MMLocationFix *_pendingFix;
+    BOOL _flushScheduled;
+}
+
+- (instancetype)initWithHandler:(MMLocationHandler)handler {
+    if ((self = [super init])) {
+        _handler = [handler copy];
+    }
+    return self;
+}
+
+- (void)setOptions:(NSDictionary *)options {
+    LocationThrottleOptions throttleOptions;
+    throttleOptions.maxRateHz = MMOption(options, @"maxRateHz");
+    throttleOptions.minDisplacement = MMOption(options, @"minDisplacement");
+    throttleOptions.minAccuracyImprovement = MMOption(options, @"minAccuracyImprovement");
+    throttleOptions.coalesceWindowMs = static_cast<int64_t>(MMOption(options, @"coalesceWindowMs"));
+    _throttle.setOptions(throttleOptions);
+}
+
+- (void)offerFix:(MMLocationFix *)fix {
+    const LocationSample sample = MMLocationSampleFromFix(fix);
+    const int64_t now = MMNowMs();
+    const LocationThrottle::Decision decision = _throttle.offer(sample, now);
+    switch (decision.action) {
+        case LocationThrottle::Action::Deliver:
+            _pendingFix = nil;
+            _handler(fix);
+            break;
+        case LocationThrottle::Action::Hold:
+            _pendingFix = fix;
+            [self scheduleFlushAt:decision.dueMs now:now];
+            break;
+        case LocationThrottle::Action::Drop:
+            // Dropping may also have discarded a held fix
+            if (!_throttle.hasPending()) {
+                _pendingFix = nil;
+            }
+            break;
+    }
+}
+
+- (void)scheduleFlushAt:(int64_t)dueMs now:(int64_t)now {
+    if (_flushScheduled) {
+        return;
+    }
+    _flushScheduled = YES;
+    __weak typeof(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, MAX(dueMs - now, 0) * NSEC_PER_MSEC), dispatch_get_main_queue(), ^{
+        [weakSelf flush];
+    });
+}
+
+- (void)flush {
+    _flushScheduled = NO;
+    const int64_t now = MMNowMs();
+    if (_throttle.flush(now)) {
+        MMLocationFix *fix = _pendingFix;
+        _pendingFix = nil;
+        if (fix) {
+            _handler(fix);
+        }
+    } else if (_throttle.hasPending()) {
+        [self scheduleFlushAt:_throttle.pendingDueMs() now:now];
+    }
+}
+
+- (void)reset {
+    _throttle.reset();
+    _pendingFix = nil;
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)stats {
+    return MMStatsDictionary(_throttle.stats());
+}
+
++ (NSDictionary<NSString *, NSNumber *> *)totalStats {
+    return MMStatsDictionary(LocationThrottle::totalStats());
+}
+
+@end
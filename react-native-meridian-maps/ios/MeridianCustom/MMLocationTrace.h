@@ -0,0 +1,61 @@
+#import <Foundation/Foundation.h>
+#import "MMLocationFilter.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+extern NSString *const MMLocationTraceErrorDomain;
+
+/**
+ * Writes the fixes the map views receive to a binary location trace
+ * (cpp/LocationTrace.h). Every view reports the same device fixes, so a fix
+ * equal to the last recorded one is skipped. Main queue only.
+ */
+@interface MMLocationRecorder : NSObject
+
++ (instancetype)sharedRecorder;
+
+@property (nonatomic, readonly, getter=isRecording) BOOL recording;
+@property (nonatomic, readonly, copy, nullable) NSString *path;
+
+/// Starts a new trace at path, ending any recording in progress.
+- (BOOL)startWithPath:(NSString *)path error:(NSError **)error;
+
+/// Ends the recording and returns how many fixes it holds.
+- (NSUInteger)stop;
+
+- (void)recordFix:(MMLocationFix *)fix;
+
+@end
+
+@protocol MMLocationReplayListener <NSObject>
+- (void)locationReplayDidDeliverFix:(MMLocationFix *)fix;
+@end
+
+/// fixes delivered and whether the trace ran to its end rather than being stopped
+typedef void (^MMLocationReplayCompletion)(NSUInteger fixes, BOOL finished);
+
+/**
+ * Plays a recorded trace back to every listening map view, in place of the
+ * location manager, at the recorded pace times speed. A speed of 0 replays as
+ * fast as the main queue allows. Main queue only.
+ */
+@interface MMLocationReplay : NSObject
+
++ (instancetype)sharedReplay;
+
+@property (nonatomic, readonly, getter=isActive) BOOL active;
+
+/// Listeners are held weakly.
+- (void)addListener:(id<MMLocationReplayListener>)listener;
+
+/// Loads path and starts it, stopping any replay in progress.
+- (BOOL)startWithPath:(NSString *)path
+                speed:(double)speed
+           completion:(MMLocationReplayCompletion)completion
+                error:(NSError **)error;
+
+- (void)stop;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,187 @@
+#import "MMLocationTrace.h"
+#import <QuartzCore/QuartzCore.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LocationTrace.h"
+
+using meridianmaps::LocationReplay;
+using meridianmaps::LocationSample;
+using meridianmaps::LocationTrace;
+using meridianmaps::LocationTraceWriter;
+
+NSString *const MMLocationTraceErrorDomain = @"MMLocationTraceErrorDomain";
+
+// Fixes delivered per main queue turn at full speed, so the UI keeps drawing
+static const size_t MMReplayBatchSize = 64;
+
+static int64_t MMNowMs(void) {
+    return static_cast<int64_t>(CACurrentMediaTime() * 1000.0);
+}
+
+static NSError *MMTraceError(const std::string &message) {
+    return [NSError errorWithDomain:MMLocationTraceErrorDomain
+                               code:1
+                           userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithUTF8String:message.c_str()]}];
+}
+
+@implementation MMLocationRecorder {
+    std::unique_ptr<LocationTraceWriter> _writer;
+    MMLocationFix *_lastFix;
+}
+
++ (instancetype)sharedRecorder {
+    static MMLocationRecorder *recorder;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        recorder = [[MMLocationRecorder alloc] init];
+    });
+    return recorder;
+}
+
+- (BOOL)isRecording {
+    return _writer != nullptr;
+}
+
+- (BOOL)startWithPath:(NSString *)path error:(NSError **)error {
+    [self stop];
+    std::string message;
+    _writer = LocationTraceWriter::open(path.UTF8String, &message);
+    if (!_writer) {
+        if (error) {
+            *error = MMTraceError(message);
+        }
+        return NO;
+    }
+    _path = [path copy];
+    return YES;
+}
+
+- (NSUInteger)stop {
+    const NSUInteger count = _writer ? _writer->count() : 0;
+    _writer.reset();
+    _lastFix = nil;
+    return count;
+}
+
+- (void)recordFix:(MMLocationFix *)fix {
+    if (!_writer) {
+        return;
+    }
+    if (_lastFix && _lastFix.timestamp == fix.timestamp && CGPointEqualToPoint(_lastFix.rawPoint, fix.rawPoint) &&
+        [_lastFix.mapKey isEqualToString:fix.mapKey]) {
+        return;
+    }
+    _lastFix = fix;
+    _writer->append(MMLocationSampleFromFix(fix));
+    // A trace should survive the app being killed mid-walk
+    _writer->flush();
+}
+
+@end
+
+@implementation MMLocationReplay {
+    std::unique_ptr<LocationReplay> _replay;
+    NSHashTable<id<MMLocationReplayListener>> *_listeners;
+    MMLocationReplayCompletion _completion;
+    // Invalidates timers scheduled for an earlier replay
+    NSUInteger _generation;
+}
+
++ (instancetype)sharedReplay {
+    static MMLocationReplay *replay;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        replay = [[MMLocationReplay alloc] init];
+    });
+    return replay;
+}
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        _listeners = [NSHashTable weakObjectsHashTable];
+    }
+    return self;
+}
+
+- (BOOL)isActive {
+    return _replay != nullptr;
+}
+
+- (void)addListener:(id<MMLocationReplayListener>)listener {
+    [_listeners addObject:listener];
+}
+
+- (BOOL)startWithPath:(NSString *)path
+                speed:(double)speed
+           completion:(MMLocationReplayCompletion)completion
+                error:(NSError **)error {
+    std::vector<LocationSample> samples;
+    std::string message;
+    if (!LocationTrace::read(path.UTF8String, &samples, &message)) {
+        if (error) {
+            *error = MMTraceError(message);
+        }
+        return NO;
+    }
+    [self stop];
+    _replay = std::make_unique<LocationReplay>(std::move(samples), speed);
+    _replay->start(MMNowMs());
+    _completion = [completion copy];
+    [self deliverDueFixes];
+    return YES;
+}
+
+- (void)stop {
+    [self finish:NO];
+}
+
+- (void)finish:(BOOL)finished {
+    if (!_replay) {
+        return;
+    }
+    const NSUInteger delivered = _replay->position();
+    _replay.reset();
+    _generation++;
+    MMLocationReplayCompletion completion = _completion;
+    _completion = nil;
+    if (completion) {
+        completion(delivered, finished);
+    }
+}
+
+- (void)deliverDueFixes {
+    if (!_replay) {
+        return;
+    }
+    const int64_t now = MMNowMs();
+    for (const LocationSample &sample : _replay->take(now, MMReplayBatchSize)) {
+        MMLocationFix *fix = [[MMLocationFix alloc] initWithPoint:CGPointMake(sample.x, sample.y)
+                                                         accuracy:sample.accuracy
+                                                        timestamp:sample.timestampMs
+                                                           mapKey:[NSString stringWithUTF8String:sample.mapKey.c_str()]
+                                                     providerType:sample.providerType];
+        for (id<MMLocationReplayListener> listener in _listeners.allObjects) {
+            [listener locationReplayDidDeliverFix:fix];
+        }
+    }
+    if (_replay->done()) {
+        [self finish:YES];
+        return;
+    }
+
+    const NSUInteger generation = _generation;
+    __weak typeof(self) weakSelf = self;
+    dispatch_block_t next = ^{
+        typeof(self) strongSelf = weakSelf;
+        if (strongSelf && strongSelf->_generation == generation) {
+            [strongSelf deliverDueFixes];
+        }
+    };
+    const int64_t delayMs = MAX(_replay->nextDueMs() - now, 0);
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, delayMs * NSEC_PER_MSEC), dispatch_get_main_queue(), next);
+}
+
+@end
@@ -0,0 +1,39 @@
+#import <Foundation/Foundation.h>
+
+@class CustomMapViewController;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Bounded pool of detached map controllers (cpp/MapPool.h).
+ *
+ * A MeridianMapContainerView going away parks its controller here instead of
+ * dropping it, and the next view for the same app and map takes it back with
+ * its floor, placemarks and tiles still loaded. The least recently parked
+ * controllers are dropped past maxSize, and all of them on a memory warning.
+ * Main queue only, except stats.
+ */
+@interface MMMapPool : NSObject
+
++ (instancetype)sharedPool;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Controllers kept at most; 0 turns pooling off. Defaults to 2.
+@property (nonatomic, assign) NSUInteger maxSize;
+
+/// Detaches controller from its view hierarchy and keeps it for appId and mapId.
+- (void)parkController:(CustomMapViewController *)controller app:(NSString *)appId map:(NSString *)mapId;
+
+/// The controller parked most recently for appId and mapId, or nil.
+- (nullable CustomMapViewController *)takeControllerForApp:(NSString *)appId map:(NSString *)mapId;
+
+/// Drops every parked controller.
+- (void)trim;
+
+/// size, maxSize, parked, hits, misses, evictions and trims.
+- (NSDictionary<NSString *, NSNumber *> *)stats;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,129 @@
+#import "MMMapPool.h"
+#import "CustomMapViewController.h"
+#import <UIKit/UIKit.h>
+
+#include <string>
+#include <vector>
+
+#include "MapPool.h"
+
+using meridianmaps::MapPool;
+
+@implementation MMMapPool {
+    // Guarded by @synchronized (self), for stats on the JS thread
+    MapPool _pool;
+    NSMutableDictionary<NSNumber *, CustomMapViewController *> *_controllers;
+    uint64_t _nextId;
+}
+
++ (instancetype)sharedPool {
+    static MMMapPool *pool;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        pool = [[MMMapPool alloc] initPrivate];
+    });
+    return pool;
+}
+
+- (instancetype)initPrivate {
+    if ((self = [super init])) {
+        _controllers = [NSMutableDictionary dictionary];
+        _nextId = 1;
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(trim)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+    }
+    return self;
+}
+
+static std::string MMPoolKey(NSString *appId, NSString *mapId) {
+    return std::string(appId.UTF8String ?: "") + "|" + (mapId.UTF8String ?: "");
+}
+
+- (NSUInteger)maxSize {
+    @synchronized (self) {
+        return _pool.capacity();
+    }
+}
+
+- (void)setMaxSize:(NSUInteger)maxSize {
+    std::vector<uint64_t> evicted;
+    @synchronized (self) {
+        _pool.setCapacity(maxSize, &evicted);
+    }
+    [self dropControllers:evicted];
+}
+
+- (void)parkController:(CustomMapViewController *)controller app:(NSString *)appId map:(NSString *)mapId {
+    // A parked map shows nothing and answers to no one
+    controller.eventDelegate = nil;
+    if (controller.presentedViewController) {
+        [controller dismissViewControllerAnimated:NO completion:nil];
+    }
+    [controller.mapView deselectAnnotationAnimated:NO];
+    controller.mapView.route = nil;
+    [controller.view removeFromSuperview];
+
+    std::vector<uint64_t> evicted;
+    @synchronized (self) {
+        const uint64_t controllerId = _nextId++;
+        _controllers[@(controllerId)] = controller;
+        _pool.park(MMPoolKey(appId, mapId), controllerId, &evicted);
+    }
+    [self dropControllers:evicted];
+}
+
+- (CustomMapViewController *)takeControllerForApp:(NSString *)appId map:(NSString *)mapId {
+    @synchronized (self) {
+        const uint64_t controllerId = _pool.take(MMPoolKey(appId, mapId));
+        if (controllerId == 0) {
+            return nil;
+        }
+        CustomMapViewController *controller = _controllers[@(controllerId)];
+        [_controllers removeObjectForKey:@(controllerId)];
+        return controller;
+    }
+}
+
+- (void)trim {
+    std::vector<uint64_t> evicted;
+    @synchronized (self) {
+        _pool.trim(0, &evicted);
+    }
+    if (!evicted.empty()) {
+        NSLog(@"[MMMapPool] Dropping %zu parked maps on memory pressure", evicted.size());
+    }
+    [self dropControllers:evicted];
+}
+
+// Released when dropped goes out of scope, outside the lock; a controller's teardown may take a while
+- (void)dropControllers:(const std::vector<uint64_t> &)ids {
+    NSMutableArray<CustomMapViewController *> *dropped = [NSMutableArray array];
+    @synchronized (self) {
+        for (uint64_t controllerId : ids) {
+            CustomMapViewController *controller = _controllers[@(controllerId)];
+            if (controller) {
+                [dropped addObject:controller];
+                [_controllers removeObjectForKey:@(controllerId)];
+            }
+        }
+    }
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)stats {
+    @synchronized (self) {
+        const meridianmaps::MapPoolStats &stats = _pool.stats();
+        return @{
+            @"size": @(_pool.size()),
+            @"maxSize": @(_pool.capacity()),
+            @"parked": @(stats.parked),
+            @"hits": @(stats.hits),
+            @"misses": @(stats.misses),
+            @"evictions": @(stats.evictions),
+            @"trims": @(stats.trims)
+        };
+    }
+}
+
+@end
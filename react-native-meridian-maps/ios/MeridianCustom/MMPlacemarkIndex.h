@@ -0,0 +1,115 @@
+#import <Foundation/Foundation.h>
+#import <Meridian/Meridian.h>
+
+@class MMAssetBundle;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Lightweight copy of the placemark fields needed to start a route: the
+ * floor it lives on, its position on that floor and its type.
+ */
+@interface MMPlacemarkRecord : NSObject
+
+@property (nonatomic, copy, readonly) NSString *identifier;
+@property (nonatomic, copy, readonly) MREditorKey *mapKey;
+@property (nonatomic, assign, readonly) CGPoint point;
+@property (nonatomic, copy, readonly, nullable) NSString *type;
+@property (nonatomic, copy, readonly, nullable) NSString *name;
+
+- (instancetype)initWithIdentifier:(NSString *)identifier
+                            mapKey:(MREditorKey *)mapKey
+                             point:(CGPoint)point
+                              type:(nullable NSString *)type
+                              name:(nullable NSString *)name NS_DESIGNATED_INITIALIZER;
+- (instancetype)initWithPlacemark:(MRPlacemark *)placemark;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Rebuilds a placemark that can be handed to the directions APIs.
+- (MRPlacemark *)placemark;
+
+@end
+
+typedef void (^MMPlacemarkLookupCompletion)(MMPlacemarkRecord *_Nullable record, NSError *_Nullable error);
+
+/**
+ * Per-app index from placemark ID to MMPlacemarkRecord.
+ *
+ * One instance exists per app ID and is shared by every MeridianMapContainerView.
+ * Records live in an MMPlacemarkStore, which is seeded from the on-disk
+ * snapshot at creation, so IDs seen in a previous session resolve without a
+ * network round trip. The index is then hydrated once through MMPlacemarkLoader;
+ * a lookup that misses while hydration is running is answered by the first
+ * page carrying its ID. All methods must be called on the main queue, except
+ * indexForApp: and searchPlacemarks:limit:, which may be called from any thread.
+ */
+@interface MMPlacemarkIndex : NSObject
+
+@property (nonatomic, copy, readonly) NSString *appId;
+@property (nonatomic, readonly) BOOL isHydrated;
+@property (nonatomic, readonly) NSUInteger count;
+
++ (instancetype)indexForApp:(NSString *)appId;
+
+/**
+ * Frees the app's index; the on-disk snapshot stays, so the next indexForApp:
+ * starts from it. Returns NO and keeps an index that is still hydrating.
+ */
++ (BOOL)releaseIndexForApp:(NSString *)appId;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Returns the record if the index already holds it, without touching the network.
+- (nullable MMPlacemarkRecord *)recordForID:(NSString *)placemarkID;
+
+/// Looks the placemark up, hydrating the index first if this is the first lookup.
+- (void)lookupPlacemarkWithID:(NSString *)placemarkID completion:(MMPlacemarkLookupCompletion)completion;
+
+/// Starts hydration if it has not happened yet. Safe to call repeatedly.
+- (void)hydrateWithCompletion:(nullable void (^)(NSError *_Nullable error))completion;
+
+/**
+ * Runs a batch of nearest/radius/rect queries (see MMPlacemarkStore). If the
+ * index is still empty the queries wait for hydration; otherwise they are
+ * answered immediately from whatever the index holds.
+ */
+- (void)queryPlacemarks:(NSArray<NSDictionary *> *)queries
+             completion:(void (^)(NSArray<NSArray<NSDictionary *> *> *_Nullable results, NSError *_Nullable error))completion;
+
+/**
+ * Typeahead search over the placemarks the index already holds. Never waits
+ * for the network: if hydration has not run it is started in the background
+ * and the current call is answered from the snapshot.
+ */
+- (NSArray<NSDictionary *> *)searchPlacemarks:(NSString *)query limit:(NSUInteger)limit;
+
+/**
+ * Incrementally syncs the index from a placemark sync endpoint on a background
+ * queue (see MMPlacemarkStore). A successful sync marks the index hydrated, so
+ * lookups no longer page every floor through the SDK. completion runs on the
+ * main queue with the sync counters, or nil and the error.
+ */
+- (void)syncFromURL:(NSURL *)baseURL
+              mapIds:(nullable NSArray<NSString *> *)mapIds
+            pageSize:(NSUInteger)pageSize
+             headers:(nullable NSDictionary<NSString *, NSString *> *)headers
+          completion:(void (^)(NSDictionary *_Nullable stats, NSError *_Nullable error))completion;
+
+/**
+ * Fills an empty index from the placemark pages packed into bundle, the same
+ * way as syncFromURL: but offline, so a fresh install has its placemarks
+ * before the network answers. An index that already holds placemarks is left
+ * alone and completion gets neither stats nor error.
+ */
+- (void)seedFromBundle:(MMAssetBundle *)bundle
+            completion:(void (^)(NSDictionary *_Nullable stats, NSError *_Nullable error))completion;
+
+/// Merges placemarks loaded elsewhere (e.g. by the map view) into the index.
+- (void)addPlacemarks:(NSArray<MRPlacemark *> *)placemarks;
+
+/// Drops all records and the snapshot so the next lookup re-hydrates.
+- (void)invalidate;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,307 @@
+#import "MMPlacemarkIndex.h"
+#import "MMPlacemarkLoader.h"
+#import "MMPlacemarkStore.h"
+#import "MMRequestBroker.h"
+
+@implementation MMPlacemarkRecord
+
+- (instancetype)initWithIdentifier:(NSString *)identifier
+                            mapKey:(MREditorKey *)mapKey
+                             point:(CGPoint)point
+                              type:(NSString *)type
+                              name:(NSString *)name {
+    if ((self = [super init])) {
+        _identifier = [identifier copy];
+        _mapKey = [mapKey copy];
+        _point = point;
+        _type = [type copy];
+        _name = [name copy];
+    }
+    return self;
+}
+
+- (instancetype)initWithPlacemark:(MRPlacemark *)placemark {
+    return [self initWithIdentifier:placemark.key.identifier
+                             mapKey:placemark.key.parent
+                              point:placemark.point
+                               type:placemark.type
+                               name:placemark.name];
+}
+
+- (MRPlacemark *)placemark {
+    MRPlacemark *placemark = [[MRPlacemark alloc] initWithMap:self.mapKey point:self.point];
+    placemark.key = [MREditorKey keyForPlacemark:self.identifier map:self.mapKey];
+    placemark.type = self.type;
+    placemark.name = self.name;
+    return placemark;
+}
+
+@end
+
+@interface MMPlacemarkIndex ()
+@property (nonatomic, strong) MMPlacemarkStore *store;
+@property (nonatomic, strong, nullable) MMPlacemarkLoader *loader;
+// IDs delivered by the running hydration, used to drop placemarks deleted since the snapshot
+@property (nonatomic, strong, nullable) NSMutableSet<NSString *> *hydratedIDs;
+@property (nonatomic, strong) NSMutableArray<void (^)(NSError *)> *pendingHydrations;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableArray<MMPlacemarkLookupCompletion> *> *pendingLookups;
+@property (nonatomic, readwrite) BOOL isHydrated;
+@end
+
+static NSMutableDictionary<NSString *, MMPlacemarkIndex *> *MMIndexesByApp(void) {
+    static NSMutableDictionary<NSString *, MMPlacemarkIndex *> *indexes;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        indexes = [NSMutableDictionary dictionary];
+    });
+    return indexes;
+}
+
+@implementation MMPlacemarkIndex
+
++ (instancetype)indexForApp:(NSString *)appId {
+    NSMutableDictionary<NSString *, MMPlacemarkIndex *> *indexes = MMIndexesByApp();
+    // Search is synchronous and arrives on the JS thread, so creation can race the main queue
+    @synchronized (indexes) {
+        MMPlacemarkIndex *index = indexes[appId];
+        if (!index) {
+            index = [[MMPlacemarkIndex alloc] initWithAppId:appId];
+            indexes[appId] = index;
+        }
+        return index;
+    }
+}
+
++ (BOOL)releaseIndexForApp:(NSString *)appId {
+    NSMutableDictionary<NSString *, MMPlacemarkIndex *> *indexes = MMIndexesByApp();
+    @synchronized (indexes) {
+        MMPlacemarkIndex *index = indexes[appId];
+        if (!index || index.loader || index.pendingLookups.count > 0) {
+            return NO;
+        }
+        [indexes removeObjectForKey:appId];
+        return YES;
+    }
+}
+
+- (instancetype)initWithAppId:(NSString *)appId {
+    if ((self = [super init])) {
+        _appId = [appId copy];
+        _store = [[MMPlacemarkStore alloc] initWithAppId:appId];
+        [_store loadSnapshot];
+        _pendingHydrations = [NSMutableArray array];
+        _pendingLookups = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+    return self.store.count;
+}
+
+- (MMPlacemarkRecord *)recordForID:(NSString *)placemarkID {
+    return [self.store recordForID:placemarkID];
+}
+
+- (void)lookupPlacemarkWithID:(NSString *)placemarkID completion:(MMPlacemarkLookupCompletion)completion {
+    MMPlacemarkRecord *record = [self recordForID:placemarkID];
+    if (record || self.isHydrated) {
+        completion(record, nil);
+        return;
+    }
+
+    // Answered by whichever page carries the placemark, or when hydration ends
+    NSMutableArray<MMPlacemarkLookupCompletion> *waiting = self.pendingLookups[placemarkID];
+    if (!waiting) {
+        waiting = [NSMutableArray array];
+        self.pendingLookups[placemarkID] = waiting;
+    }
+    [waiting addObject:[completion copy]];
+    [self hydrateWithCompletion:nil];
+}
+
+- (void)hydrateWithCompletion:(void (^)(NSError *))completion {
+    if (self.isHydrated) {
+        if (completion) {
+            completion(nil);
+        }
+        return;
+    }
+    if (completion) {
+        [self.pendingHydrations addObject:[completion copy]];
+    }
+    if (self.loader) {
+        return;
+    }
+
+    NSLog(@"[MMPlacemarkIndex] Hydrating placemark index for app %@", self.appId);
+    MMPlacemarkLoader *loader = [[MMPlacemarkLoader alloc] initWithAppId:self.appId];
+    self.loader = loader;
+    self.hydratedIDs = [NSMutableSet set];
+
+    __weak typeof(self) weakSelf = self;
+    [loader startWithPageHandler:^(NSArray<MRPlacemark *> *placemarks, MREditorKey *mapKey) {
+        [weakSelf addPlacemarks:placemarks];
+    } completion:^(NSError *error) {
+        // A cancelled load still calls back; only the current one counts.
+        if (weakSelf.loader == loader) {
+            [weakSelf loaderDidFinishWithError:error];
+        }
+    }];
+}
+
+- (void)queryPlacemarks:(NSArray<NSDictionary *> *)queries
+             completion:(void (^)(NSArray<NSArray<NSDictionary *> *> *, NSError *))completion {
+    void (^run)(void) = ^{
+        NSError *error = nil;
+        NSArray *results = [self.store runSpatialQueries:queries error:&error];
+        completion(results, error);
+    };
+
+    if (self.isHydrated || self.store.count > 0) {
+        run();
+        return;
+    }
+    [self hydrateWithCompletion:^(NSError *error) {
+        run();
+    }];
+}
+
+- (NSArray<NSDictionary *> *)searchPlacemarks:(NSString *)query limit:(NSUInteger)limit {
+    if (!self.isHydrated) {
+        // Answer from the snapshot now; later keystrokes see the hydrated placemarks
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self hydrateWithCompletion:nil];
+        });
+    }
+    return [self.store searchPlacemarks:query limit:limit];
+}
+
+- (void)addPlacemarks:(NSArray<MRPlacemark *> *)placemarks {
+    [self.store addPlacemarks:placemarks];
+
+    for (MRPlacemark *placemark in placemarks) {
+        NSString *identifier = placemark.key.identifier;
+        if (identifier.length == 0 || !placemark.key.parent) {
+            continue;
+        }
+        [self.hydratedIDs addObject:identifier];
+
+        NSArray<MMPlacemarkLookupCompletion> *waiting = self.pendingLookups[identifier];
+        if (waiting) {
+            [self.pendingLookups removeObjectForKey:identifier];
+            MMPlacemarkRecord *record = [[MMPlacemarkRecord alloc] initWithPlacemark:placemark];
+            for (MMPlacemarkLookupCompletion completion in waiting) {
+                completion(record, nil);
+            }
+        }
+    }
+}
+
+- (void)syncFromURL:(NSURL *)baseURL
+              mapIds:(NSArray<NSString *> *)mapIds
+            pageSize:(NSUInteger)pageSize
+             headers:(NSDictionary<NSString *, NSString *> *)headers
+          completion:(void (^)(NSDictionary *, NSError *))completion {
+    [self runSync:^NSDictionary *(MMPlacemarkStore *store, NSError **error) {
+        return [store syncFromURL:baseURL mapIds:mapIds pageSize:pageSize headers:headers error:error];
+    } source:@"sync" completion:completion];
+}
+
+- (void)seedFromBundle:(MMAssetBundle *)bundle completion:(void (^)(NSDictionary *, NSError *))completion {
+    // A snapshot or an earlier sync is newer than anything packed at build time
+    if (self.store.count > 0) {
+        completion(nil, nil);
+        return;
+    }
+    [self runSync:^NSDictionary *(MMPlacemarkStore *store, NSError **error) {
+        return [store syncFromBundle:bundle error:error];
+    } source:@"asset bundle" completion:completion];
+}
+
+- (void)runSync:(NSDictionary *(^)(MMPlacemarkStore *, NSError **))sync
+         source:(NSString *)source
+     completion:(void (^)(NSDictionary *, NSError *))completion {
+    static dispatch_queue_t syncQueue;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        syncQueue = dispatch_queue_create("com.meridianmaps.placemark-sync", DISPATCH_QUEUE_SERIAL);
+    });
+
+    MMPlacemarkStore *store = self.store;
+    dispatch_async(syncQueue, ^{
+        NSError *error = nil;
+        NSDictionary *stats = sync(store, &error);
+        dispatch_async(dispatch_get_main_queue(), ^{
+            // A clean sync is as good as a hydration, so the SDK listing is skipped
+            if (stats && !self.isHydrated && !self.loader) {
+                self.isHydrated = YES;
+                NSLog(@"[MMPlacemarkIndex] Indexed %lu placemarks for app %@ from %@", (unsigned long)store.count, self.appId, source);
+                [self finishPendingWithError:nil];
+            }
+            completion(stats, error);
+        });
+    });
+}
+
+- (void)invalidate {
+    MMPlacemarkLoader *loader = self.loader;
+    self.loader = nil;
+    [loader cancel];
+    self.hydratedIDs = nil;
+    [self.store removeAll];
+    self.isHydrated = NO;
+    // Cached map lists and pages would otherwise refill the index with the old data
+    MMRequestBroker *broker = [MMRequestBroker sharedBroker];
+    [broker invalidateKeysWithPrefix:[MMRequestBroker fingerprintWithKind:@"maps" components:@[self.appId, @""]]];
+    [broker invalidateKeysWithPrefix:[MMRequestBroker fingerprintWithKind:@"placemarks" components:@[self.appId, @""]]];
+
+    // Lookups queued behind the cancelled load are answered by a fresh one.
+    if (self.pendingHydrations.count > 0 || self.pendingLookups.count > 0) {
+        [self hydrateWithCompletion:nil];
+    }
+}
+
+#pragma mark - Internal
+
+- (void)loaderDidFinishWithError:(NSError *)error {
+    self.loader = nil;
+    NSSet<NSString *> *hydratedIDs = self.hydratedIDs;
+    self.hydratedIDs = nil;
+
+    if (error && hydratedIDs.count == 0) {
+        NSLog(@"[MMPlacemarkIndex] Hydration failed: %@", error.localizedDescription);
+    } else {
+        // Only a complete load proves that snapshot entries it did not return were deleted
+        if (!error) {
+            [self.store retainPlacemarksWithIDs:hydratedIDs];
+            [self.store persistSnapshot];
+        }
+        // Partial floors still make a usable index; missing IDs resolve to nil
+        self.isHydrated = YES;
+        NSLog(@"[MMPlacemarkIndex] Indexed %lu placemarks for app %@", (unsigned long)self.store.count, self.appId);
+        error = nil;
+    }
+
+    [self finishPendingWithError:error];
+}
+
+// Answers every lookup and hydration waiting on the index
+- (void)finishPendingWithError:(NSError *)error {
+    NSDictionary<NSString *, NSMutableArray<MMPlacemarkLookupCompletion> *> *lookups = [self.pendingLookups copy];
+    [self.pendingLookups removeAllObjects];
+    [lookups enumerateKeysAndObjectsUsingBlock:^(NSString *placemarkID, NSMutableArray<MMPlacemarkLookupCompletion> *waiting, BOOL *stop) {
+        MMPlacemarkRecord *record = [self recordForID:placemarkID];
+        for (MMPlacemarkLookupCompletion completion in waiting) {
+            completion(record, record ? nil : error);
+        }
+    }];
+
+    NSArray<void (^)(NSError *)> *pending = [self.pendingHydrations copy];
+    [self.pendingHydrations removeAllObjects];
+    for (void (^completion)(NSError *) in pending) {
+        completion(error);
+    }
+}
+
+@end
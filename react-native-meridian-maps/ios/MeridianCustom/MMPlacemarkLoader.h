@@ -0,0 +1,45 @@
+#import <Foundation/Foundation.h>
+#import <Meridian/Meridian.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Called on the main queue for every page of placemarks as soon as it lands.
+typedef void (^MMPlacemarkPageHandler)(NSArray<MRPlacemark *> *placemarks, MREditorKey *mapKey);
+
+/// Called once on the main queue after every floor has been fully paged, or after cancel.
+typedef void (^MMPlacemarkLoadCompletion)(NSError *_Nullable error);
+
+/**
+ * Loads every placemark of an app floor by floor.
+ *
+ * The app's maps are enumerated first, then one mapKey-scoped MRPlacemarkRequest
+ * is run per floor, following MRPlacemarkResponse.nextPage until the floor is
+ * exhausted. At most maxConcurrentFloors floors are in flight at once. A failed
+ * floor does not stop the others; the first error is reported on completion.
+ * Map list and placemark pages go through MMRequestBroker, so two loaders
+ * paging the same floor at once share the network requests.
+ */
+@interface MMPlacemarkLoader : NSObject
+
+@property (nonatomic, copy, readonly) NSString *appId;
+@property (nonatomic, assign) NSUInteger maxConcurrentFloors;
+/// Restricts loading to these floors instead of enumerating every map of the app.
+@property (nonatomic, copy, nullable) NSArray<NSString *> *mapIds;
+@property (nonatomic, readonly, getter=isLoading) BOOL loading;
+@property (nonatomic, readonly, getter=isCancelled) BOOL cancelled;
+/// While paused no new page or floor is requested; requests in flight still
+/// deliver their pages. Unpausing continues where the load stopped.
+@property (nonatomic, assign, getter=isPaused) BOOL paused;
+
+- (instancetype)initWithAppId:(NSString *)appId;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (void)startWithPageHandler:(nullable MMPlacemarkPageHandler)pageHandler
+                  completion:(nullable MMPlacemarkLoadCompletion)completion;
+
+/// Cancels every in-flight request; completion is called with a cancellation error.
+- (void)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
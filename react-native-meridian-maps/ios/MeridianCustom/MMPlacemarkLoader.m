@@ -0,0 +1,225 @@
+#import "MMPlacemarkLoader.h"
+#import "MMAssetCache.h"
+#import "MMRequestBroker.h"
+
+static const NSUInteger MMDefaultMaxConcurrentFloors = 4;
+// How long other loaders and views may reuse a fetched map list or placemark page
+static const NSTimeInterval MMMapListTTL = 300.0;
+static const NSTimeInterval MMPlacemarkPageTTL = 60.0;
+
+@interface MMPlacemarkLoader ()
+@property (nonatomic, copy, nullable) MMPlacemarkPageHandler pageHandler;
+@property (nonatomic, copy, nullable) MMPlacemarkLoadCompletion completion;
+@property (nonatomic, strong) NSMutableArray<MREditorKey *> *queuedFloors;
+@property (nonatomic, strong) NSMutableSet<MMRequestSubscription *> *activeRequests;
+// Next pages of floors that landed while paused; each keeps its floor's slot
+@property (nonatomic, strong) NSMutableArray<dispatch_block_t> *pausedPages;
+@property (nonatomic, strong, nullable) MMRequestSubscription *mapListSubscription;
+@property (nonatomic, assign) BOOL enumeratingMaps;
+@property (nonatomic, strong, nullable) NSError *firstError;
+@property (nonatomic, readwrite, getter=isLoading) BOOL loading;
+@property (nonatomic, readwrite, getter=isCancelled) BOOL cancelled;
+@end
+
+@implementation MMPlacemarkLoader
+
+- (instancetype)initWithAppId:(NSString *)appId {
+    if ((self = [super init])) {
+        _appId = [appId copy];
+        _maxConcurrentFloors = MMDefaultMaxConcurrentFloors;
+        _queuedFloors = [NSMutableArray array];
+        _activeRequests = [NSMutableSet set];
+        _pausedPages = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)setPaused:(BOOL)paused {
+    if (_paused == paused) {
+        return;
+    }
+    _paused = paused;
+    if (paused || !self.loading) {
+        return;
+    }
+    NSArray<dispatch_block_t> *pages = [self.pausedPages copy];
+    [self.pausedPages removeAllObjects];
+    for (dispatch_block_t startPage in pages) {
+        startPage();
+    }
+    [self pumpFloors];
+}
+
+- (void)startWithPageHandler:(MMPlacemarkPageHandler)pageHandler completion:(MMPlacemarkLoadCompletion)completion {
+    if (self.loading) {
+        NSLog(@"[MMPlacemarkLoader] Load already in progress for app %@", self.appId);
+        return;
+    }
+
+    self.pageHandler = pageHandler;
+    self.completion = completion;
+    self.firstError = nil;
+    self.cancelled = NO;
+    self.loading = YES;
+
+    MREditorKey *appKey = [MREditorKey keyWithIdentifier:self.appId];
+    if (self.mapIds) {
+        for (NSString *mapId in self.mapIds) {
+            [self.queuedFloors addObject:[MREditorKey keyForMap:mapId app:self.appId]];
+        }
+        [self pumpFloors];
+        return;
+    }
+
+    self.enumeratingMaps = YES;
+    [self loadMapListForApp:appKey pageURL:nil];
+}
+
+- (void)cancel {
+    if (!self.loading) {
+        return;
+    }
+    self.cancelled = YES;
+    [self.mapListSubscription cancel];
+    self.mapListSubscription = nil;
+    self.enumeratingMaps = NO;
+    // Requests shared with another loader keep running for it
+    for (MMRequestSubscription *subscription in self.activeRequests) {
+        [subscription cancel];
+    }
+    [self.activeRequests removeAllObjects];
+    [self.queuedFloors removeAllObjects];
+    [self.pausedPages removeAllObjects];
+
+    [self finishWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil]];
+}
+
+#pragma mark - Internal
+
+- (void)loadMapListForApp:(MREditorKey *)appKey pageURL:(NSURL *)pageURL {
+    NSString *key = [MMRequestBroker fingerprintWithKind:@"maps"
+                                              components:@[self.appId, pageURL.absoluteString ?: @""]];
+    __weak typeof(self) weakSelf = self;
+    self.mapListSubscription = [[MMRequestBroker sharedBroker] requestWithKey:key ttl:MMMapListTTL start:^dispatch_block_t(MMRequestCompletion completion) {
+        NSOperation *operation = [MRMap getMapsForApp:appKey pageURL:pageURL success:^(NSArray<MRMap *> *maps, NSURL *next) {
+            NSMutableDictionary *page = [NSMutableDictionary dictionaryWithObject:maps ?: @[] forKey:@"maps"];
+            page[@"next"] = next;
+            completion(page, nil);
+        } failure:^(NSError *error) {
+            completion(nil, error);
+        }];
+        return ^{
+            [operation cancel];
+        };
+    } completion:^(NSDictionary *page, NSError *error) {
+        typeof(self) strongSelf = weakSelf;
+        if (!strongSelf || strongSelf.cancelled) {
+            return;
+        }
+        if (error) {
+            NSLog(@"[MMPlacemarkLoader] Failed to list maps for app %@: %@", strongSelf.appId, error.localizedDescription);
+            strongSelf.firstError = strongSelf.firstError ?: error;
+            strongSelf.mapListSubscription = nil;
+            strongSelf.enumeratingMaps = NO;
+            [strongSelf pumpFloors];
+            return;
+        }
+        for (MRMap *map in page[@"maps"]) {
+            [strongSelf.queuedFloors addObject:map.key];
+            [[MMAssetCache sharedCache] registerMap:map];
+        }
+        NSURL *next = page[@"next"];
+        if (next) {
+            [strongSelf loadMapListForApp:appKey pageURL:next];
+        } else {
+            strongSelf.mapListSubscription = nil;
+            strongSelf.enumeratingMaps = NO;
+        }
+        [strongSelf pumpFloors];
+    }];
+}
+
+- (void)pumpFloors {
+    while (!self.paused && self.activeRequests.count + self.pausedPages.count < MAX(self.maxConcurrentFloors, 1) &&
+           self.queuedFloors.count > 0) {
+        MREditorKey *mapKey = self.queuedFloors.firstObject;
+        [self.queuedFloors removeObjectAtIndex:0];
+        MRPlacemarkRequest *request = [[MRPlacemarkRequest alloc] initWithApp:[MREditorKey keyWithIdentifier:self.appId]
+                                                          placemarkIdentifier:nil
+                                                                       mapKey:mapKey];
+        [self startRequest:request forFloor:mapKey page:0];
+    }
+
+    if (self.activeRequests.count == 0 && self.pausedPages.count == 0 && self.queuedFloors.count == 0 &&
+        !self.enumeratingMaps) {
+        [self finishWithError:self.firstError];
+    }
+}
+
+- (void)startRequest:(MRPlacemarkRequest *)request forFloor:(MREditorKey *)mapKey page:(NSUInteger)page {
+    // Pages are keyed by position, so another loader paging the same floor shares them
+    NSString *key = [MMRequestBroker fingerprintWithKind:@"placemarks"
+                                              components:@[self.appId, mapKey.identifier ?: @"", @(page).stringValue]];
+    __block MMRequestSubscription *subscription = nil;
+    __weak typeof(self) weakSelf = self;
+    subscription = [[MMRequestBroker sharedBroker] requestWithKey:key ttl:MMPlacemarkPageTTL start:^dispatch_block_t(MMRequestCompletion completion) {
+        [request startWithCompletionHandler:^(MRPlacemarkResponse *response, NSError *error) {
+            completion(response, error);
+        }];
+        return ^{
+            [request cancel];
+        };
+    } completion:^(MRPlacemarkResponse *response, NSError *error) {
+        typeof(self) strongSelf = weakSelf;
+        if (!strongSelf || strongSelf.cancelled || ![strongSelf.activeRequests containsObject:subscription]) {
+            return;
+        }
+        [strongSelf.activeRequests removeObject:subscription];
+
+        if (error) {
+            NSLog(@"[MMPlacemarkLoader] Failed to load placemarks for floor %@: %@", mapKey.identifier, error.localizedDescription);
+            strongSelf.firstError = strongSelf.firstError ?: error;
+        } else {
+            NSArray<MRPlacemark *> *placemarks = [response getPlacemarks];
+            if (placemarks.count > 0 && strongSelf.pageHandler) {
+                [[MMAssetCache sharedCache] registerPlacemarks:placemarks];
+                strongSelf.pageHandler(placemarks, mapKey);
+            }
+            // The page handler may have cancelled the load
+            if (strongSelf.cancelled) {
+                return;
+            }
+            // Keep this floor's slot and continue with its next page
+            if (response.nextPage) {
+                MRPlacemarkRequest *next = response.nextPage;
+                __weak typeof(strongSelf) weakLoader = strongSelf;
+                dispatch_block_t startPage = ^{
+                    [weakLoader startRequest:next forFloor:mapKey page:page + 1];
+                };
+                if (strongSelf.paused) {
+                    [strongSelf.pausedPages addObject:startPage];
+                } else {
+                    startPage();
+                }
+                return;
+            }
+        }
+        [strongSelf pumpFloors];
+    }];
+    [self.activeRequests addObject:subscription];
+}
+
+- (void)finishWithError:(NSError *)error {
+    if (!self.loading) {
+        return;
+    }
+    self.loading = NO;
+    MMPlacemarkLoadCompletion completion = self.completion;
+    self.completion = nil;
+    self.pageHandler = nil;
+    if (completion) {
+        completion(error);
+    }
+}
+
+@end
@@ -0,0 +1,71 @@
+#import <Foundation/Foundation.h>
+#import <Meridian/Meridian.h>
+
+@class MMAssetBundle;
+@class MMPlacemarkRecord;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Objective-C face of the shared C++ placemark store (cpp/PlacemarkStore.h).
+ *
+ * Placemarks are kept in columns rather than as MRPlacemark objects, and the
+ * whole store is persisted as a binary snapshot in the caches directory. At
+ * startup the snapshot is memory-mapped, so lookups work before the network
+ * has answered. Thread-safe; placemarks are normally fed from the main queue
+ * while searches may arrive from the JS thread.
+ */
+@interface MMPlacemarkStore : NSObject
+
+@property (nonatomic, copy, readonly) NSString *appId;
+@property (nonatomic, readonly) NSUInteger count;
+
+- (instancetype)initWithAppId:(NSString *)appId;
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Maps the app's snapshot from disk, replacing the current contents. Returns NO if there is none or it is unreadable.
+- (BOOL)loadSnapshot;
+
+/// Writes the current contents to the snapshot file off the main queue.
+- (void)persistSnapshot;
+
+- (void)addPlacemarks:(NSArray<MRPlacemark *> *)placemarks;
+- (nullable MMPlacemarkRecord *)recordForID:(NSString *)placemarkID;
+
+/**
+ * Runs a batch of spatial queries against the per-floor R-trees. Each query is a
+ * dictionary with kind ("nearest", "radius" or "rect"), mapId, x/y or
+ * minX/minY/maxX/maxY, and optional radius, limit and types. Returns one array
+ * of hit dictionaries per query, or nil with error for a malformed query.
+ */
+- (nullable NSArray<NSArray<NSDictionary *> *> *)runSpatialQueries:(NSArray<NSDictionary *> *)queries
+                                                              error:(NSError **)error;
+
+/// Typeahead search over names, types, categories, descriptions and custom1/custom2, best match first.
+- (NSArray<NSDictionary *> *)searchPlacemarks:(NSString *)query limit:(NSUInteger)limit;
+
+/// Drops every placemark whose ID is not in identifiers.
+- (void)retainPlacemarksWithIDs:(NSSet<NSString *> *)identifiers;
+
+/// Clears the store and deletes its snapshot and sync manifest.
+- (void)removeAll;
+
+/**
+ * Brings the store up to date from a placemark sync endpoint (see
+ * cpp/PlacemarkSync.h), fetching only the floors and placemarks that changed
+ * since the last sync, then persists the snapshot and sync manifest. Blocks on
+ * the network, so never call it on the main queue. Returns the sync counters,
+ * or nil with error if any floor failed; floors that did sync are kept.
+ */
+- (nullable NSDictionary<NSString *, NSNumber *> *)syncFromURL:(NSURL *)baseURL
+                                                        mapIds:(nullable NSArray<NSString *> *)mapIds
+                                                      pageSize:(NSUInteger)pageSize
+                                                       headers:(nullable NSDictionary<NSString *, NSString *> *)headers
+                                                         error:(NSError **)error;
+
+/// syncFromURL: against the placemark pages packed into bundle, without the network.
+- (nullable NSDictionary<NSString *, NSNumber *> *)syncFromBundle:(MMAssetBundle *)bundle error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
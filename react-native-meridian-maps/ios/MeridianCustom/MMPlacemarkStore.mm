@@ -0,0 +1,494 @@
+#import "MMPlacemarkStore.h"
+#import "MMAssetBundle.h"
+#import "MMPlacemarkIndex.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "PlacemarkStore.h"
+#include "PlacemarkSync.h"
+
+using meridianmaps::HttpFetch;
+using meridianmaps::HttpRequest;
+using meridianmaps::HttpResponse;
+using meridianmaps::PlacemarkDiff;
+using meridianmaps::PlacemarkInput;
+using meridianmaps::PlacemarkSnapshot;
+using meridianmaps::PlacemarkStore;
+using meridianmaps::PlacemarkSync;
+using meridianmaps::PlacemarkTable;
+using meridianmaps::Rect;
+using meridianmaps::SearchResult;
+using meridianmaps::SpatialHit;
+using meridianmaps::SpatialQuery;
+using meridianmaps::SyncManifest;
+using meridianmaps::SyncStats;
+
+NSString *const MMPlacemarkStoreErrorDomain = @"MMPlacemarkStoreErrorDomain";
+
+static const uint32_t MMDefaultNearestLimit = 10;
+static const uint32_t MMDefaultAreaLimit = 100;
+
+static std::string MMStdString(NSString *value) {
+    return value ? std::string(value.UTF8String) : std::string();
+}
+
+static NSString *MMNSString(std::string_view value) {
+    return [[NSString alloc] initWithBytes:value.data() length:value.size() encoding:NSUTF8StringEncoding] ?: @"";
+}
+
+static BOOL MMReadFloat(NSDictionary *dictionary, NSString *key, float *value) {
+    id number = dictionary[key];
+    if (![number isKindOfClass:[NSNumber class]]) {
+        return NO;
+    }
+    *value = [number floatValue];
+    return YES;
+}
+
+static NSError *MMQueryError(NSUInteger index, NSString *reason) {
+    NSString *message = [NSString stringWithFormat:@"Query %lu: %@", (unsigned long)index, reason];
+    return [NSError errorWithDomain:MMPlacemarkStoreErrorDomain code:1 userInfo:@{NSLocalizedDescriptionKey: message}];
+}
+
+// Returns NO for a malformed query. *matchesNothing is set when the floor or every requested type is unknown.
+static BOOL MMParseSpatialQuery(NSDictionary *dictionary, const PlacemarkTable &table, SpatialQuery &query,
+                                BOOL *matchesNothing, NSString **reason) {
+    if (![dictionary isKindOfClass:[NSDictionary class]]) {
+        *reason = @"expected an object";
+        return NO;
+    }
+    NSString *kind = dictionary[@"kind"];
+    if ([kind isEqual:@"nearest"]) {
+        query.kind = SpatialQuery::Kind::Nearest;
+    } else if ([kind isEqual:@"radius"]) {
+        query.kind = SpatialQuery::Kind::Radius;
+    } else if ([kind isEqual:@"rect"]) {
+        query.kind = SpatialQuery::Kind::Rect;
+    } else {
+        *reason = @"kind must be nearest, radius or rect";
+        return NO;
+    }
+
+    NSString *mapId = dictionary[@"mapId"];
+    if (![mapId isKindOfClass:[NSString class]] || mapId.length == 0) {
+        *reason = @"mapId is required";
+        return NO;
+    }
+
+    if (query.kind == SpatialQuery::Kind::Rect) {
+        if (!MMReadFloat(dictionary, @"minX", &query.rect.minX) || !MMReadFloat(dictionary, @"minY", &query.rect.minY) ||
+            !MMReadFloat(dictionary, @"maxX", &query.rect.maxX) || !MMReadFloat(dictionary, @"maxY", &query.rect.maxY)) {
+            *reason = @"rect queries need minX, minY, maxX and maxY";
+            return NO;
+        }
+    } else {
+        if (!MMReadFloat(dictionary, @"x", &query.x) || !MMReadFloat(dictionary, @"y", &query.y)) {
+            *reason = @"x and y are required";
+            return NO;
+        }
+        if (!MMReadFloat(dictionary, @"radius", &query.radius) && query.kind == SpatialQuery::Kind::Radius) {
+            *reason = @"radius is required";
+            return NO;
+        }
+    }
+
+    NSNumber *limit = dictionary[@"limit"];
+    if ([limit isKindOfClass:[NSNumber class]] && limit.integerValue >= 0) {
+        query.limit = (uint32_t)MIN(limit.unsignedIntegerValue, (NSUInteger)UINT32_MAX);
+    } else {
+        query.limit = query.kind == SpatialQuery::Kind::Nearest ? MMDefaultNearestLimit : MMDefaultAreaLimit;
+    }
+
+    const uint16_t floor = table.findFloor(MMStdString(mapId));
+    query.floor = floor;
+    *matchesNothing = floor == UINT16_MAX;
+
+    NSArray *types = dictionary[@"types"];
+    if ([types isKindOfClass:[NSArray class]] && types.count > 0) {
+        for (id type in types) {
+            const uint16_t typeId = [type isKindOfClass:[NSString class]] ? table.findType(MMStdString(type)) : UINT16_MAX;
+            if (typeId != UINT16_MAX) {
+                query.types.push_back(typeId);
+            }
+        }
+        *matchesNothing = *matchesNothing || query.types.empty();
+    }
+    return YES;
+}
+
+static NSMutableDictionary *MMDictionaryForRow(const PlacemarkTable &table, uint32_t row) {
+    return [@{
+        @"id": MMNSString(table.id(row)),
+        @"mapId": MMNSString(table.floorKey(table.floorIndex(row))),
+        @"name": MMNSString(table.name(row)),
+        @"type": MMNSString(table.typeName(table.typeId(row))),
+        @"x": @(table.x(row)),
+        @"y": @(table.y(row))
+    } mutableCopy];
+}
+
+@implementation MMPlacemarkStore {
+    // Guards _store; searches arrive on the JS thread while the main queue feeds placemarks
+    std::mutex _lock;
+    std::unique_ptr<PlacemarkStore> _store;
+}
+
+- (instancetype)initWithAppId:(NSString *)appId {
+    if ((self = [super init])) {
+        _appId = [appId copy];
+        _store = std::make_unique<PlacemarkStore>();
+    }
+    return self;
+}
+
++ (dispatch_queue_t)snapshotQueue {
+    static dispatch_queue_t queue;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        queue = dispatch_queue_create("com.meridianmaps.placemark-snapshots", DISPATCH_QUEUE_SERIAL);
+    });
+    return queue;
+}
+
+- (NSString *)cachePathWithExtension:(NSString *)extension {
+    NSString *caches = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+    NSString *directory = [caches stringByAppendingPathComponent:@"MeridianMaps"];
+    [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+    return [directory stringByAppendingPathComponent:[NSString stringWithFormat:@"placemarks-%@.%@", self.appId, extension]];
+}
+
+- (NSString *)snapshotPath {
+    return [self cachePathWithExtension:@"mmps"];
+}
+
+- (NSString *)manifestPath {
+    return [self cachePathWithExtension:@"sync"];
+}
+
+- (NSUInteger)count {
+    std::lock_guard<std::mutex> guard(_lock);
+    return _store->size();
+}
+
+- (BOOL)loadSnapshot {
+    std::string error;
+    // Wait for a pending write so we never map a file that is being replaced
+    dispatch_sync([MMPlacemarkStore snapshotQueue], ^{});
+    std::unique_ptr<PlacemarkStore> store = PlacemarkStore::openSnapshot(MMStdString([self snapshotPath]), &error);
+    if (!store) {
+        NSLog(@"[MMPlacemarkStore] No usable snapshot for app %@: %s", self.appId, error.c_str());
+        return NO;
+    }
+    std::lock_guard<std::mutex> guard(_lock);
+    _store = std::move(store);
+    NSLog(@"[MMPlacemarkStore] Mapped %u placemarks for app %@", _store->size(), self.appId);
+    return YES;
+}
+
+- (void)persistSnapshot {
+    std::lock_guard<std::mutex> guard(_lock);
+    // Encoding touches the store and must stay on this queue; only the file write moves off it
+    auto bytes = std::make_shared<std::string>(PlacemarkSnapshot::serialize(_store->table()));
+    NSString *path = [self snapshotPath];
+    NSString *appId = self.appId;
+    dispatch_async([MMPlacemarkStore snapshotQueue], ^{
+        NSData *data = [NSData dataWithBytesNoCopy:(void *)bytes->data() length:bytes->size() freeWhenDone:NO];
+        NSError *error = nil;
+        if (![data writeToFile:path options:NSDataWritingAtomic error:&error]) {
+            NSLog(@"[MMPlacemarkStore] Failed to write snapshot for app %@: %@", appId, error.localizedDescription);
+        }
+    });
+}
+
+- (void)addPlacemarks:(NSArray<MRPlacemark *> *)placemarks {
+    std::lock_guard<std::mutex> guard(_lock);
+    for (MRPlacemark *placemark in placemarks) {
+        NSString *identifier = placemark.key.identifier;
+        NSString *mapId = placemark.key.parent.identifier;
+        if (identifier.length == 0 || mapId.length == 0) {
+            continue;
+        }
+        const std::string placemarkID = MMStdString(identifier);
+        const std::string mapKey = MMStdString(mapId);
+        const std::string name = MMStdString(placemark.name);
+        const std::string type = MMStdString(placemark.type);
+        const std::string typeName = MMStdString(placemark.typeName);
+        const std::string typeCategory = MMStdString(placemark.typeCategory);
+        const std::string description = MMStdString(placemark.placemarkDescription);
+        const std::string custom1 = MMStdString(placemark.custom1);
+        const std::string custom2 = MMStdString(placemark.custom2);
+
+        PlacemarkInput input;
+        input.id = placemarkID;
+        input.mapKey = mapKey;
+        input.name = name;
+        input.type = type;
+        input.typeName = typeName;
+        input.typeCategory = typeCategory;
+        input.description = description;
+        input.custom1 = custom1;
+        input.custom2 = custom2;
+        input.x = placemark.point.x;
+        input.y = placemark.point.y;
+        if (placemark.area) {
+            CGRect bounds = placemark.area.bounds;
+            input.bounds = Rect{(float)CGRectGetMinX(bounds), (float)CGRectGetMinY(bounds), (float)CGRectGetMaxX(bounds),
+                                (float)CGRectGetMaxY(bounds)};
+        }
+        _store->upsert(input);
+    }
+}
+
+- (MMPlacemarkRecord *)recordForID:(NSString *)placemarkID {
+    std::lock_guard<std::mutex> guard(_lock);
+    if (placemarkID.length == 0) {
+        return nil;
+    }
+    const PlacemarkTable &table = _store->table();
+    const uint32_t row = table.find(MMStdString(placemarkID));
+    if (row == PlacemarkTable::npos) {
+        return nil;
+    }
+    NSString *mapId = MMNSString(table.floorKey(table.floorIndex(row)));
+    std::string_view type = table.typeName(table.typeId(row));
+    std::string_view name = table.name(row);
+    return [[MMPlacemarkRecord alloc] initWithIdentifier:placemarkID
+                                                  mapKey:[MREditorKey keyForMap:mapId app:self.appId]
+                                                   point:CGPointMake(table.x(row), table.y(row))
+                                                    type:type.empty() ? nil : MMNSString(type)
+                                                    name:name.empty() ? nil : MMNSString(name)];
+}
+
+- (NSArray<NSArray<NSDictionary *> *> *)runSpatialQueries:(NSArray<NSDictionary *> *)queries error:(NSError **)error {
+    std::lock_guard<std::mutex> guard(_lock);
+    const PlacemarkTable &table = _store->table();
+    NSMutableArray<NSArray<NSDictionary *> *> *results = [NSMutableArray arrayWithCapacity:queries.count];
+
+    for (NSUInteger i = 0; i < queries.count; i++) {
+        SpatialQuery query;
+        BOOL matchesNothing = NO;
+        NSString *reason = nil;
+        if (!MMParseSpatialQuery(queries[i], table, query, &matchesNothing, &reason)) {
+            if (error) {
+                *error = MMQueryError(i, reason);
+            }
+            return nil;
+        }
+        if (matchesNothing) {
+            [results addObject:@[]];
+            continue;
+        }
+
+        std::vector<SpatialHit> hits = _store->spatialIndex().query(table, query);
+        NSMutableArray<NSDictionary *> *serialized = [NSMutableArray arrayWithCapacity:hits.size()];
+        for (const SpatialHit &hit : hits) {
+            NSMutableDictionary *result = MMDictionaryForRow(table, hit.row);
+            result[@"distance"] = @(hit.distance);
+            [serialized addObject:result];
+        }
+        [results addObject:serialized];
+    }
+    return results;
+}
+
+- (NSArray<NSDictionary *> *)searchPlacemarks:(NSString *)query limit:(NSUInteger)limit {
+    std::lock_guard<std::mutex> guard(_lock);
+    const std::vector<SearchResult> results =
+        _store->searchIndex().search(MMStdString(query), (uint32_t)MIN(limit, (NSUInteger)UINT32_MAX));
+    const PlacemarkTable &table = _store->table();
+    NSMutableArray<NSDictionary *> *serialized = [NSMutableArray arrayWithCapacity:results.size()];
+    for (const SearchResult &result : results) {
+        const uint32_t row = table.find(result.id);
+        if (row == PlacemarkTable::npos) {
+            continue;
+        }
+        NSMutableDictionary *hit = MMDictionaryForRow(table, row);
+        hit[@"score"] = @(result.score);
+        [serialized addObject:hit];
+    }
+    return serialized;
+}
+
+- (void)retainPlacemarksWithIDs:(NSSet<NSString *> *)identifiers {
+    std::lock_guard<std::mutex> guard(_lock);
+    const PlacemarkTable &table = _store->table();
+    std::vector<std::string> stale;
+    for (uint32_t row = 0; row < table.size(); ++row) {
+        NSString *identifier = MMNSString(table.id(row));
+        if (![identifiers containsObject:identifier]) {
+            stale.emplace_back(table.id(row));
+        }
+    }
+    for (const std::string &identifier : stale) {
+        _store->remove(identifier);
+    }
+}
+
+- (void)removeAll {
+    std::lock_guard<std::mutex> guard(_lock);
+    _store->clear();
+    NSString *path = [self snapshotPath];
+    NSString *manifestPath = [self manifestPath];
+    dispatch_async([MMPlacemarkStore snapshotQueue], ^{
+        [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+        [[NSFileManager defaultManager] removeItemAtPath:manifestPath error:nil];
+    });
+}
+
+#pragma mark - Sync
+
++ (NSURLSession *)syncSession {
+    static NSURLSession *session;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        // No URL cache: it would answer conditional requests itself and hide the 304s
+        NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration ephemeralSessionConfiguration];
+        configuration.URLCache = nil;
+        configuration.requestCachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
+        session = [NSURLSession sessionWithConfiguration:configuration];
+    });
+    return session;
+}
+
+- (NSDictionary *)syncFromURL:(NSURL *)baseURL
+                       mapIds:(NSArray<NSString *> *)mapIds
+                     pageSize:(NSUInteger)pageSize
+                      headers:(NSDictionary<NSString *, NSString *> *)headers
+                        error:(NSError **)error {
+    PlacemarkSync::Options options;
+    options.baseUrl = MMStdString(baseURL.absoluteString);
+    while (!options.baseUrl.empty() && options.baseUrl.back() == '/') {
+        options.baseUrl.pop_back();
+    }
+    for (NSString *mapId in mapIds) {
+        options.mapIds.push_back(MMStdString(mapId));
+    }
+    if (pageSize > 0) {
+        options.pageSize = (uint32_t)MIN(pageSize, (NSUInteger)UINT32_MAX);
+    }
+
+    NSURLSession *session = [MMPlacemarkStore syncSession];
+    return [self syncWithOptions:options fetch:[session, headers](const HttpRequest &request) {
+        __block HttpResponse response;
+        NSURL *url = [NSURL URLWithString:MMNSString(request.url)];
+        if (!url) {
+            response.error = "invalid URL " + request.url;
+            return response;
+        }
+        NSMutableURLRequest *urlRequest = [NSMutableURLRequest requestWithURL:url];
+        [headers enumerateKeysAndObjectsUsingBlock:^(NSString *field, NSString *value, BOOL *stop) {
+            [urlRequest setValue:value forHTTPHeaderField:field];
+        }];
+        if (!request.etag.empty()) {
+            [urlRequest setValue:MMNSString(request.etag) forHTTPHeaderField:@"If-None-Match"];
+        }
+
+        dispatch_semaphore_t done = dispatch_semaphore_create(0);
+        [[session dataTaskWithRequest:urlRequest completionHandler:^(NSData *data, NSURLResponse *urlResponse, NSError *taskError) {
+            NSHTTPURLResponse *http = [urlResponse isKindOfClass:[NSHTTPURLResponse class]] ? (NSHTTPURLResponse *)urlResponse : nil;
+            if (taskError || !http) {
+                response.error = MMStdString(taskError.localizedDescription ?: @"not an HTTP response");
+            } else {
+                response.status = (int)http.statusCode;
+                response.body.assign((const char *)data.bytes, data.length);
+                response.etag = MMStdString([http valueForHTTPHeaderField:@"ETag"]);
+            }
+            dispatch_semaphore_signal(done);
+        }] resume];
+        dispatch_semaphore_wait(done, DISPATCH_TIME_FOREVER);
+        return response;
+    } error:error];
+}
+
+- (NSDictionary *)syncFromBundle:(MMAssetBundle *)bundle error:(NSError **)error {
+    PlacemarkSync::Options options;
+    options.baseUrl = MMStdString(bundle.baseURL.absoluteString);
+    for (NSString *mapId in bundle.mapIds) {
+        options.mapIds.push_back(MMStdString(mapId));
+    }
+    // Page URLs are part of the keys, so the pages are asked for as they were packed
+    if (bundle.pageSize > 0) {
+        options.pageSize = (uint32_t)MIN(bundle.pageSize, (NSUInteger)UINT32_MAX);
+    }
+    return [self syncWithOptions:options fetch:[bundle](const HttpRequest &request) {
+        HttpResponse response;
+        NSData *data = [bundle dataForURL:[NSURL URLWithString:MMNSString(request.url)] contentType:nil];
+        if (!data) {
+            response.error = "not in the asset bundle: " + request.url;
+            return response;
+        }
+        response.status = 200;
+        response.body.assign((const char *)data.bytes, data.length);
+        return response;
+    } error:error];
+}
+
+- (NSDictionary *)syncWithOptions:(const PlacemarkSync::Options &)options fetch:(HttpFetch)fetch error:(NSError **)error {
+    const CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    NSString *manifestPath = [self manifestPath];
+
+    SyncManifest manifest;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        // The manifest only describes rows the store still has
+        if (_store->size() == 0 || !manifest.load(MMStdString(manifestPath))) {
+            manifest.maps.clear();
+        }
+    }
+
+    PlacemarkSync sync(options, std::move(fetch));
+
+    SyncStats stats;
+    std::string syncError;
+    const bool synced = sync.run(manifest, [self](const PlacemarkDiff &diff) {
+        std::lock_guard<std::mutex> guard(self->_lock);
+        diff.applyTo(*self->_store);
+    }, &stats, &syncError);
+
+    // Maps that synced are kept even if another one failed. The snapshot goes
+    // first; a manifest newer than its snapshot would skip rows the store lacks.
+    std::string bytes;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        bytes = PlacemarkSnapshot::serialize(_store->table());
+    }
+    NSString *snapshotPath = [self snapshotPath];
+    __block BOOL persisted = NO;
+    dispatch_sync([MMPlacemarkStore snapshotQueue], ^{
+        std::string writeError;
+        persisted = meridianmaps::writeFileAtomically(MMStdString(snapshotPath), bytes, &writeError) &&
+                    manifest.write(MMStdString(manifestPath), &writeError);
+        if (!persisted) {
+            [[NSFileManager defaultManager] removeItemAtPath:manifestPath error:nil];
+            NSLog(@"[MMPlacemarkStore] Failed to persist sync for app %@: %s", self.appId, writeError.c_str());
+        }
+    });
+
+    const double durationMs = (CFAbsoluteTimeGetCurrent() - start) * 1000.0;
+    NSLog(@"[MMPlacemarkStore] Synced app %@ in %.0f ms: %u requests, %llu bytes, %u upserted, %u removed",
+          self.appId, durationMs, stats.requests, (unsigned long long)stats.bytesReceived, stats.upserted, stats.removed);
+    if (!synced) {
+        if (error) {
+            *error = [NSError errorWithDomain:MMPlacemarkStoreErrorDomain
+                                         code:2
+                                     userInfo:@{NSLocalizedDescriptionKey: MMNSString(syncError)}];
+        }
+        return nil;
+    }
+    return @{
+        @"requests": @(stats.requests),
+        @"bytesReceived": @(stats.bytesReceived),
+        @"mapsUnchanged": @(stats.mapsUnchanged),
+        @"mapsDelta": @(stats.mapsDelta),
+        @"mapsFull": @(stats.mapsFull),
+        @"upserted": @(stats.upserted),
+        @"removed": @(stats.removed),
+        @"unchanged": @(stats.unchanged),
+        @"durationMs": @(durationMs)
+    };
+}
+
+@end
@@ -0,0 +1,64 @@
+#import <Foundation/Foundation.h>
+#import <Meridian/Meridian.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Called once on the main queue with the shared result or error.
+typedef void (^MMRequestCompletion)(id _Nullable result, NSError *_Nullable error);
+
+/**
+ * Starts the underlying SDK operation and calls completion exactly once when it
+ * ends. Returns a block that cancels the operation, or nil if it cannot be cancelled.
+ */
+typedef dispatch_block_t _Nullable (^MMRequestStarter)(MMRequestCompletion completion);
+
+/// One caller's interest in a brokered request.
+@interface MMRequestSubscription : NSObject
+
+@property (nonatomic, copy, readonly) NSString *key;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Stops delivery to this subscriber. The shared operation is cancelled only when no subscriber is left.
+- (void)cancel;
+
+@end
+
+/**
+ * Shares placemark, map and directions requests between every view of the app.
+ *
+ * Requests are keyed by a normalized fingerprint (see fingerprintWithKind:).
+ * A request whose key is already in flight joins it instead of hitting the
+ * network again, and every subscriber receives the same result. Successful
+ * results are kept for the TTL given by the request; errors are never cached.
+ * Thread-safe; completions always run on the main queue.
+ */
+@interface MMRequestBroker : NSObject
+
++ (instancetype)sharedBroker;
+
+- (MMRequestSubscription *)requestWithKey:(NSString *)key
+                                      ttl:(NSTimeInterval)ttl
+                                    start:(MMRequestStarter)start
+                               completion:(MMRequestCompletion)completion;
+
+/// Drops cached results whose key starts with prefix, e.g. after the app's data changed.
+- (void)invalidateKeysWithPrefix:(NSString *)prefix;
+
+/// hits, misses, coalesced, cancelled, inFlight and cached.
+- (NSDictionary<NSString *, NSNumber *> *)stats;
+
+/**
+ * Builds a request key from a kind ("maps", "placemarks", "directions") and its
+ * components. The kind is lowercased and components are trimmed, so keys built
+ * from the same request by different callers compare equal; components keep
+ * their case, since placemark, map and app IDs are case-sensitive.
+ */
++ (NSString *)fingerprintWithKind:(NSString *)kind components:(NSArray<NSString *> *)components;
+
+/// A fingerprint component for a point on a floor, snapped to a small grid so jitter does not defeat sharing.
++ (NSString *)componentForPoint:(CGPoint)point mapKey:(MREditorKey *)mapKey;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,278 @@
+#import "MMRequestBroker.h"
+
+// Map units per grid cell when fingerprinting points
+static const CGFloat MMRequestPointGrid = 2.0;
+static const NSUInteger MMRequestCacheLimit = 256;
+
+@class MMRequestBroker;
+
+@interface MMRequestSubscription ()
+@property (nonatomic, weak) MMRequestBroker *broker;
+@property (nonatomic, copy, nullable) MMRequestCompletion completion;
+- (instancetype)initWithKey:(NSString *)key broker:(MMRequestBroker *)broker completion:(MMRequestCompletion)completion;
+- (void)deliverResult:(nullable id)result error:(nullable NSError *)error;
+@end
+
+@interface MMRequestBroker ()
+- (void)unsubscribe:(MMRequestSubscription *)subscription;
+@end
+
+/// A shared operation and the subscribers waiting on it.
+@interface MMRequestEntry : NSObject
+@property (nonatomic, copy) NSString *key;
+@property (nonatomic, assign) NSTimeInterval ttl;
+@property (nonatomic, strong) NSMutableArray<MMRequestSubscription *> *subscribers;
+@property (nonatomic, copy, nullable) dispatch_block_t cancelBlock;
+@property (nonatomic, assign) BOOL finished;
+// Set when the last subscriber left before the operation ended
+@property (nonatomic, assign) BOOL abandoned;
+@end
+
+@implementation MMRequestEntry
+@end
+
+@interface MMRequestCacheItem : NSObject
+@property (nonatomic, strong) id result;
+@property (nonatomic, assign) CFAbsoluteTime expiry;
+@end
+
+@implementation MMRequestCacheItem
+@end
+
+@implementation MMRequestSubscription
+
+- (instancetype)initWithKey:(NSString *)key broker:(MMRequestBroker *)broker completion:(MMRequestCompletion)completion {
+    if ((self = [super init])) {
+        _key = [key copy];
+        _broker = broker;
+        _completion = [completion copy];
+    }
+    return self;
+}
+
+- (void)cancel {
+    @synchronized (self) {
+        if (!self.completion) {
+            return;
+        }
+        self.completion = nil;
+    }
+    [self.broker unsubscribe:self];
+}
+
+- (void)deliverResult:(id)result error:(NSError *)error {
+    MMRequestCompletion completion;
+    @synchronized (self) {
+        completion = self.completion;
+        self.completion = nil;
+    }
+    if (completion) {
+        completion(result, error);
+    }
+}
+
+@end
+
+@implementation MMRequestBroker {
+    NSMutableDictionary<NSString *, MMRequestEntry *> *_inFlight;
+    NSMutableDictionary<NSString *, MMRequestCacheItem *> *_cache;
+    NSUInteger _hits;
+    NSUInteger _misses;
+    NSUInteger _coalesced;
+    NSUInteger _cancelled;
+}
+
++ (instancetype)sharedBroker {
+    static MMRequestBroker *broker;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        broker = [[MMRequestBroker alloc] init];
+    });
+    return broker;
+}
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        _inFlight = [NSMutableDictionary dictionary];
+        _cache = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (MMRequestSubscription *)requestWithKey:(NSString *)key
+                                      ttl:(NSTimeInterval)ttl
+                                    start:(MMRequestStarter)start
+                               completion:(MMRequestCompletion)completion {
+    MMRequestSubscription *subscription = [[MMRequestSubscription alloc] initWithKey:key broker:self completion:completion];
+    MMRequestEntry *entry = nil;
+    id cachedResult = nil;
+
+    @synchronized (self) {
+        MMRequestCacheItem *cached = _cache[key];
+        if (cached && cached.expiry > CFAbsoluteTimeGetCurrent()) {
+            _hits++;
+            cachedResult = cached.result;
+        } else if (_inFlight[key]) {
+            [_cache removeObjectForKey:key];
+            _coalesced++;
+            MMRequestEntry *existing = _inFlight[key];
+            existing.ttl = MAX(existing.ttl, ttl);
+            [existing.subscribers addObject:subscription];
+            return subscription;
+        } else {
+            [_cache removeObjectForKey:key];
+            _misses++;
+            entry = [[MMRequestEntry alloc] init];
+            entry.key = key;
+            entry.ttl = ttl;
+            entry.subscribers = [NSMutableArray arrayWithObject:subscription];
+            _inFlight[key] = entry;
+        }
+    }
+
+    if (cachedResult) {
+        // Stay asynchronous on hits too, so callers see the same ordering either way
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [subscription deliverResult:cachedResult error:nil];
+        });
+        return subscription;
+    }
+
+    __weak typeof(self) weakSelf = self;
+    dispatch_block_t cancelBlock = start(^(id result, NSError *error) {
+        [weakSelf finishEntry:entry result:result error:error];
+    });
+    BOOL cancelNow = NO;
+    @synchronized (self) {
+        entry.cancelBlock = cancelBlock;
+        // Every subscriber may have left while start was running
+        cancelNow = entry.abandoned && cancelBlock;
+    }
+    if (cancelNow) {
+        cancelBlock();
+    }
+    return subscription;
+}
+
+- (void)finishEntry:(MMRequestEntry *)entry result:(id)result error:(NSError *)error {
+    NSArray<MMRequestSubscription *> *subscribers;
+    @synchronized (self) {
+        if (entry.finished) {
+            return;
+        }
+        entry.finished = YES;
+        entry.cancelBlock = nil;
+        if (_inFlight[entry.key] == entry) {
+            [_inFlight removeObjectForKey:entry.key];
+        }
+        if (!error && result && entry.ttl > 0) {
+            MMRequestCacheItem *item = [[MMRequestCacheItem alloc] init];
+            item.result = result;
+            item.expiry = CFAbsoluteTimeGetCurrent() + entry.ttl;
+            _cache[entry.key] = item;
+            [self trimCacheLocked];
+        }
+        subscribers = [entry.subscribers copy];
+        [entry.subscribers removeAllObjects];
+    }
+
+    dispatch_block_t deliver = ^{
+        for (MMRequestSubscription *subscription in subscribers) {
+            [subscription deliverResult:result error:error];
+        }
+    };
+    if ([NSThread isMainThread]) {
+        deliver();
+    } else {
+        dispatch_async(dispatch_get_main_queue(), deliver);
+    }
+}
+
+- (void)unsubscribe:(MMRequestSubscription *)subscription {
+    dispatch_block_t cancelBlock = nil;
+    @synchronized (self) {
+        MMRequestEntry *entry = _inFlight[subscription.key];
+        if (!entry || ![entry.subscribers containsObject:subscription]) {
+            return;
+        }
+        [entry.subscribers removeObjectIdenticalTo:subscription];
+        if (entry.subscribers.count > 0) {
+            return;
+        }
+        [_inFlight removeObjectForKey:entry.key];
+        entry.finished = YES;
+        entry.abandoned = YES;
+        _cancelled++;
+        cancelBlock = entry.cancelBlock;
+        entry.cancelBlock = nil;
+    }
+    if (cancelBlock) {
+        cancelBlock();
+    }
+}
+
+- (void)trimCacheLocked {
+    CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+    for (NSString *key in [_cache allKeys]) {
+        if (_cache[key].expiry <= now) {
+            [_cache removeObjectForKey:key];
+        }
+    }
+    while (_cache.count > MMRequestCacheLimit) {
+        NSString *oldest = nil;
+        CFAbsoluteTime oldestExpiry = DBL_MAX;
+        for (NSString *key in _cache) {
+            if (_cache[key].expiry < oldestExpiry) {
+                oldestExpiry = _cache[key].expiry;
+                oldest = key;
+            }
+        }
+        [_cache removeObjectForKey:oldest];
+    }
+}
+
+- (void)invalidateKeysWithPrefix:(NSString *)prefix {
+    @synchronized (self) {
+        for (NSString *key in [_cache allKeys]) {
+            if ([key hasPrefix:prefix]) {
+                [_cache removeObjectForKey:key];
+            }
+        }
+    }
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)stats {
+    @synchronized (self) {
+        [self trimCacheLocked];
+        return @{
+            @"hits": @(_hits),
+            @"misses": @(_misses),
+            @"coalesced": @(_coalesced),
+            @"cancelled": @(_cancelled),
+            @"inFlight": @(_inFlight.count),
+            @"cached": @(_cache.count),
+        };
+    }
+}
+
+#pragma mark - Fingerprints
+
++ (NSString *)fingerprintWithKind:(NSString *)kind components:(NSArray<NSString *> *)components {
+    NSCharacterSet *whitespace = [NSCharacterSet whitespaceAndNewlineCharacterSet];
+    NSMutableArray<NSString *> *parts =
+        [NSMutableArray arrayWithObject:[[kind stringByTrimmingCharactersInSet:whitespace] lowercaseString]];
+    // Identifiers are case-sensitive, so components keep their case
+    for (NSString *component in components) {
+        NSString *normalized = [component stringByTrimmingCharactersInSet:whitespace];
+        [parts addObject:[normalized stringByReplacingOccurrencesOfString:@"|" withString:@"%7C"]];
+    }
+    return [parts componentsJoinedByString:@"|"];
+}
+
++ (NSString *)componentForPoint:(CGPoint)point mapKey:(MREditorKey *)mapKey {
+    long x = lround(point.x / MMRequestPointGrid);
+    long y = lround(point.y / MMRequestPointGrid);
+    return [NSString stringWithFormat:@"%@@%ld,%ld", mapKey.identifier ?: @"", x, y];
+}
+
+@end
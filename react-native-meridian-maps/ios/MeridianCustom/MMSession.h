@@ -0,0 +1,76 @@
+#import <Foundation/Foundation.h>
+#import <Meridian/Meridian.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Phase timings in milliseconds (configureMs, mapMs, placemarksMs, totalMs), or an error.
+typedef void (^MMPrewarmCompletion)(NSDictionary<NSString *, NSNumber *> *_Nullable timings, NSError *_Nullable error);
+
+/**
+ * Process-wide SDK session shared by every MeridianMapContainerView.
+ *
+ * The SDK and the shared UIKit appearance are configured once rather than by
+ * each view that mounts, and again only when a view or a prewarm switches to a
+ * venue with another token or region. prewarmApp: does the same ahead of the first view and
+ * also creates the app's location manager and fetches the default floor and
+ * its placemarks, so the view that follows starts from warm caches. Views
+ * report how long they took to first render, split by whether a prewarm had
+ * started before they mounted. Main queue only, except stats.
+ */
+@interface MMSession : NSObject
+
++ (instancetype)sharedSession;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Region of the last configuration; views use it when they configure the SDK themselves.
+@property (nonatomic, readonly) MRDomainRegion region;
+/// Whether prewarmApp: has been called.
+@property (nonatomic, readonly, getter=isPrewarmed) BOOL prewarmed;
+
+/// Configures the SDK unless it already runs with this token and region.
+- (void)configureWithToken:(NSString *)token region:(MRDomainRegion)region;
+
+/**
+ * Makes appId the active venue (MMVenueRegistry) and configures the SDK for
+ * its token and region. Venues pushed out of the registry have their
+ * placemark index, warm location manager, prewarm and cached requests released.
+ */
+- (void)activateApp:(NSString *)appId token:(NSString *)token region:(MRDomainRegion)region;
+
+/// activateApp:token:region: in the region the venue was last used with, or the current one.
+- (void)activateApp:(NSString *)appId token:(NSString *)token;
+
+/// How many venues keep their caches; shrinking releases the least recently used.
+- (void)setMaxWarmVenues:(NSUInteger)maxWarmVenues;
+
+/**
+ * Configures the SDK, creates the app's location manager and loads mapId with
+ * its placemarks. A second call for an app that is already warm or warming
+ * joins the first. completion runs once everything has loaded.
+ */
+- (void)prewarmApp:(NSString *)appId
+               map:(NSString *)mapId
+             token:(NSString *)token
+            region:(MRDomainRegion)region
+        completion:(nullable MMPrewarmCompletion)completion;
+
+/// The location manager prewarmApp: created, handed to the first view that asks; otherwise a new one.
+- (MRLocationManager *)takeLocationManagerForApp:(MREditorKey *)appKey;
+
+/// A view finished loading its first floor this many milliseconds after it was created.
+- (void)recordFirstRenderMs:(double)ms prewarmed:(BOOL)prewarmed;
+
+/**
+ * prewarmState ("none", "running", "done" or "failed") and prewarmMs, then count,
+ * meanMs and lastMs of first renders as coldRenders/coldRenderMeanMs/coldRenderLastMs
+ * and warmRenders/warmRenderMeanMs/warmRenderLastMs.
+ */
+- (NSDictionary<NSString *, id> *)stats;
+
+/// Parses "default", "us" or "eu"; returns NO for anything else.
++ (BOOL)region:(MRDomainRegion *)region fromString:(nullable NSString *)string;
+
+@end
+
+NS_ASSUME_NONNULL_END
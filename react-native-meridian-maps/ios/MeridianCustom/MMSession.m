@@ -0,0 +1,268 @@
+#import "MMSession.h"
+#import "MMAssetCache.h"
+#import "MMPlacemarkIndex.h"
+#import "MMPlacemarkLoader.h"
+#import "MMRequestBroker.h"
+#import "MMVenueRegistry.h"
+#import <QuartzCore/QuartzCore.h>
+#import <UIKit/UIKit.h>
+
+typedef NS_ENUM(NSInteger, MMPrewarmState) {
+    MMPrewarmStateNone,
+    MMPrewarmStateRunning,
+    MMPrewarmStateDone,
+    MMPrewarmStateFailed,
+};
+
+// First renders of views created with or without a prewarm before them
+typedef struct {
+    NSUInteger count;
+    double totalMs;
+    double lastMs;
+} MMRenderTimes;
+
+static NSDictionary<NSString *, NSNumber *> *MMRenderTimesDictionary(MMRenderTimes times, NSString *prefix) {
+    return @{
+        [prefix stringByAppendingString:@"Renders"]: @(times.count),
+        [prefix stringByAppendingString:@"RenderMeanMs"]: @(times.count > 0 ? times.totalMs / times.count : 0),
+        [prefix stringByAppendingString:@"RenderLastMs"]: @(times.lastMs),
+    };
+}
+
+@interface MMSession ()
+@property (nonatomic, copy, nullable) NSString *configuredToken;
+@property (nonatomic, readwrite) MRDomainRegion region;
+@property (nonatomic, readwrite, getter=isPrewarmed) BOOL prewarmed;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, MRLocationManager *> *warmLocationManagers;
+// Completions waiting on the prewarm of each app
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableArray<MMPrewarmCompletion> *> *pendingPrewarms;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *prewarmTimings;
+@property (nonatomic, strong) NSMutableDictionary<NSString *, MMPlacemarkLoader *> *floorLoaders;
+@end
+
+@implementation MMSession {
+    // Read by stats on the JS thread; guarded by @synchronized (self)
+    MMPrewarmState _prewarmState;
+    double _prewarmMs;
+    MMRenderTimes _coldRenders;
+    MMRenderTimes _warmRenders;
+}
+
++ (instancetype)sharedSession {
+    static MMSession *session;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        session = [[MMSession alloc] initPrivate];
+    });
+    return session;
+}
+
+- (instancetype)initPrivate {
+    if ((self = [super init])) {
+        _region = MRDomainRegionDefault;
+        _warmLocationManagers = [NSMutableDictionary dictionary];
+        _pendingPrewarms = [NSMutableDictionary dictionary];
+        _prewarmTimings = [NSMutableDictionary dictionary];
+        _floorLoaders = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
++ (BOOL)region:(MRDomainRegion *)region fromString:(NSString *)string {
+    NSDictionary<NSString *, NSNumber *> *regions = @{
+        @"default": @(MRDomainRegionDefault),
+        @"us": @(MRDomainRegionUS),
+        @"eu": @(MRDomainRegionEU),
+    };
+    NSNumber *value = string ? regions[string.lowercaseString] : @(MRDomainRegionDefault);
+    if (!value) {
+        return NO;
+    }
+    *region = (MRDomainRegion)value.unsignedIntegerValue;
+    return YES;
+}
+
+- (void)configureWithToken:(NSString *)token region:(MRDomainRegion)region {
+    static dispatch_once_t appearanceOnce;
+    dispatch_once(&appearanceOnce, ^{
+        [MMSession applyAppearance];
+    });
+
+    if ([self.configuredToken isEqualToString:token] && self.region == region) {
+        return;
+    }
+    NSLog(@"[MMSession] Configuring the Meridian SDK");
+    MRConfig *config = [MRConfig new];
+    [config domainConfig].domainRegion = region;
+    config.applicationToken = token;
+    [Meridian configure:config];
+    self.configuredToken = token;
+    self.region = region;
+}
+
+// The SDK's own screens (search, directions) take their look from the global appearance proxies
++ (void)applyAppearance {
+    UINavigationBarAppearance *appearance = [[UINavigationBarAppearance alloc] init];
+    [appearance configureWithOpaqueBackground];
+    [appearance setBackgroundColor:[UIColor colorWithRed:0.1395 green:0.8678 blue:0.7167 alpha:1.0]];
+    appearance.titleTextAttributes = @{NSForegroundColorAttributeName : [UIColor whiteColor]};
+    [[UINavigationBar appearance] setStandardAppearance:appearance];
+    [[UINavigationBar appearance] setScrollEdgeAppearance:appearance];
+    [UINavigationBar appearance].tintColor = [UIColor whiteColor];
+    [[UITextField appearanceWhenContainedInInstancesOfClasses:@[ UISearchBar.class ]]
+        setTintColor:[[UIView alloc] init].tintColor];
+}
+
+- (void)activateApp:(NSString *)appId token:(NSString *)token region:(MRDomainRegion)region {
+    [self configureWithToken:token region:region];
+    NSArray<NSString *> *evicted = nil;
+    [[MMVenueRegistry sharedRegistry] activateApp:appId token:token region:region evicted:&evicted];
+    [self releaseApps:evicted];
+}
+
+- (void)activateApp:(NSString *)appId token:(NSString *)token {
+    MMVenue *venue = [[MMVenueRegistry sharedRegistry] venueForApp:appId];
+    [self activateApp:appId token:token region:venue ? venue.region : self.region];
+}
+
+- (void)setMaxWarmVenues:(NSUInteger)maxWarmVenues {
+    [self releaseApps:[[MMVenueRegistry sharedRegistry] setMaxWarmVenuesReturningEvicted:maxWarmVenues]];
+}
+
+// What a venue keeps warm; the placemark snapshot on disk stays for its next activation
+- (void)releaseApps:(NSArray<NSString *> *)appIds {
+    MMRequestBroker *broker = [MMRequestBroker sharedBroker];
+    for (NSString *appId in appIds) {
+        [self.warmLocationManagers removeObjectForKey:appId];
+        if (!self.pendingPrewarms[appId]) {
+            [self.prewarmTimings removeObjectForKey:appId];
+        }
+        [MMPlacemarkIndex releaseIndexForApp:appId];
+        for (NSString *kind in @[ @"maps", @"placemarks", @"directions" ]) {
+            [broker invalidateKeysWithPrefix:[MMRequestBroker fingerprintWithKind:kind components:@[ appId, @"" ]]];
+        }
+    }
+}
+
+- (void)prewarmApp:(NSString *)appId
+               map:(NSString *)mapId
+             token:(NSString *)token
+            region:(MRDomainRegion)region
+        completion:(MMPrewarmCompletion)completion {
+    self.prewarmed = YES;
+    NSDictionary *finished = self.prewarmTimings[appId];
+    if (finished) {
+        if (completion) {
+            completion(finished, nil);
+        }
+        return;
+    }
+    NSMutableArray<MMPrewarmCompletion> *pending = self.pendingPrewarms[appId];
+    if (pending) {
+        if (completion) {
+            [pending addObject:[completion copy]];
+        }
+        return;
+    }
+    pending = [NSMutableArray array];
+    if (completion) {
+        [pending addObject:[completion copy]];
+    }
+    self.pendingPrewarms[appId] = pending;
+    @synchronized (self) {
+        _prewarmState = MMPrewarmStateRunning;
+    }
+
+    const CFTimeInterval start = CACurrentMediaTime();
+    [self activateApp:appId token:token region:region];
+    MREditorKey *appKey = [MREditorKey keyWithIdentifier:appId];
+    if (!self.warmLocationManagers[appId]) {
+        self.warmLocationManagers[appId] = [[MRLocationManager alloc] initWithApp:appKey];
+    }
+    NSMutableDictionary<NSString *, NSNumber *> *timings = [NSMutableDictionary dictionary];
+    timings[@"configureMs"] = @((CACurrentMediaTime() - start) * 1000.0);
+
+    // The floor and its placemarks load side by side; the prewarm ends when both have
+    __block NSUInteger remaining = 2;
+    __block NSError *firstError = nil;
+    __weak typeof(self) weakSelf = self;
+    void (^phaseDone)(NSString *, NSError *) = ^(NSString *phase, NSError *error) {
+        timings[phase] = @((CACurrentMediaTime() - start) * 1000.0);
+        firstError = firstError ?: error;
+        if (--remaining == 0) {
+            timings[@"totalMs"] = @((CACurrentMediaTime() - start) * 1000.0);
+            [weakSelf finishPrewarmForApp:appId timings:timings error:firstError];
+        }
+    };
+
+    [MRMap getMap:[MREditorKey keyForMap:mapId app:appId] success:^(MRMap *map) {
+        [[MMAssetCache sharedCache] registerMap:map];
+        phaseDone(@"mapMs", nil);
+    } failure:^(NSError *error) {
+        NSLog(@"[MMSession] Failed to prefetch map %@: %@", mapId, error.localizedDescription);
+        phaseDone(@"mapMs", error);
+    }];
+
+    // The default floor first, then the rest of the app in the background. The
+    // floor's pages go through MMRequestBroker, so hydration reuses them.
+    MMPlacemarkIndex *index = [MMPlacemarkIndex indexForApp:appId];
+    MMPlacemarkLoader *loader = [[MMPlacemarkLoader alloc] initWithAppId:appId];
+    loader.mapIds = @[ mapId ];
+    self.floorLoaders[appId] = loader;
+    [loader startWithPageHandler:^(NSArray<MRPlacemark *> *placemarks, MREditorKey *mapKey) {
+        [index addPlacemarks:placemarks];
+    } completion:^(NSError *error) {
+        [weakSelf.floorLoaders removeObjectForKey:appId];
+        [index hydrateWithCompletion:nil];
+        phaseDone(@"placemarksMs", error);
+    }];
+}
+
+- (void)finishPrewarmForApp:(NSString *)appId timings:(NSDictionary<NSString *, NSNumber *> *)timings error:(NSError *)error {
+    NSArray<MMPrewarmCompletion> *completions = self.pendingPrewarms[appId];
+    [self.pendingPrewarms removeObjectForKey:appId];
+    @synchronized (self) {
+        _prewarmState = error ? MMPrewarmStateFailed : MMPrewarmStateDone;
+        _prewarmMs = timings[@"totalMs"].doubleValue;
+    }
+    // A failed prewarm may be retried; a finished one is answered from its timings
+    if (!error) {
+        self.prewarmTimings[appId] = [timings copy];
+    }
+    NSLog(@"[MMSession] Prewarmed app %@ in %.0f ms%@", appId, timings[@"totalMs"].doubleValue, error ? @" with errors" : @"");
+    for (MMPrewarmCompletion completion in completions) {
+        completion(error ? nil : timings, error);
+    }
+}
+
+- (MRLocationManager *)takeLocationManagerForApp:(MREditorKey *)appKey {
+    MRLocationManager *manager = self.warmLocationManagers[appKey.identifier];
+    if (manager) {
+        [self.warmLocationManagers removeObjectForKey:appKey.identifier];
+        return manager;
+    }
+    return [[MRLocationManager alloc] initWithApp:appKey];
+}
+
+- (void)recordFirstRenderMs:(double)ms prewarmed:(BOOL)prewarmed {
+    @synchronized (self) {
+        MMRenderTimes *times = prewarmed ? &_warmRenders : &_coldRenders;
+        times->count++;
+        times->totalMs += ms;
+        times->lastMs = ms;
+    }
+}
+
+- (NSDictionary<NSString *, id> *)stats {
+    static NSString *const states[] = {@"none", @"running", @"done", @"failed"};
+    NSMutableDictionary<NSString *, id> *stats = [NSMutableDictionary dictionary];
+    @synchronized (self) {
+        stats[@"prewarmState"] = states[_prewarmState];
+        stats[@"prewarmMs"] = @(_prewarmMs);
+        [stats addEntriesFromDictionary:MMRenderTimesDictionary(_coldRenders, @"cold")];
+        [stats addEntriesFromDictionary:MMRenderTimesDictionary(_warmRenders, @"warm")];
+    }
+    return stats;
+}
+
+@end
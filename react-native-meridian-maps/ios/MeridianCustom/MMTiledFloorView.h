@@ -0,0 +1,30 @@
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Shows a floor SVG through a tile pyramid (cpp/TilePyramid.h) instead of
+ * drawing the whole document at once. The CATiledLayer behind the view asks
+ * only for the tiles on screen, at the pyramid level matching the current
+ * scale, and draws them on background threads; tiles drawn once are kept
+ * under Caches/meridianmaps/tiles. The floor is aspect-fit to the bounds.
+ */
+@interface MMTiledFloorView : UIView
+
+/// Parses svgData on a utility queue; completion runs on the main queue, with nil if it is not an SVG.
++ (void)loadWithSVGData:(NSData *)svgData
+                  frame:(CGRect)frame
+             completion:(void (^)(MMTiledFloorView *_Nullable view))completion;
+
+/// Deletes every cached tile; views already shown keep drawing.
++ (void)clearCache;
+
+- (instancetype)initWithFrame:(CGRect)frame NS_UNAVAILABLE;
+- (instancetype)initWithCoder:(NSCoder *)coder NS_UNAVAILABLE;
+
+/// Zoom levels and tiles drawn or read back so far: maxZoom, rendered, renderMicros, diskHits and bytesWritten.
+- (NSDictionary<NSString *, NSNumber *> *)stats;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,138 @@
+#import "MMTiledFloorView.h"
+#import <QuartzCore/QuartzCore.h>
+
+#include <memory>
+#include <string>
+
+#include "TilePyramid.h"
+
+using meridianmaps::Rect;
+using meridianmaps::TileKey;
+using meridianmaps::TilePyramid;
+using meridianmaps::TilePyramidOptions;
+using meridianmaps::TilePyramidStats;
+
+static NSString *MMTileCacheDirectory(void) {
+    NSString *caches = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+    return [caches stringByAppendingPathComponent:@"meridianmaps/tiles"];
+}
+
+@implementation MMTiledFloorView {
+    // Shared with the layer's drawing threads, which may outlive a draw in progress
+    std::shared_ptr<TilePyramid> _pyramid;
+}
+
++ (Class)layerClass {
+    return [CATiledLayer class];
+}
+
++ (void)loadWithSVGData:(NSData *)svgData
+                  frame:(CGRect)frame
+             completion:(void (^)(MMTiledFloorView *_Nullable view))completion {
+    NSData *data = [svgData copy];
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        NSString *directory = MMTileCacheDirectory();
+        [[NSFileManager defaultManager] createDirectoryAtPath:directory.stringByDeletingLastPathComponent
+                                  withIntermediateDirectories:YES
+                                                   attributes:nil
+                                                        error:nil];
+        TilePyramidOptions options;
+        options.cacheDirectory = std::string(directory.UTF8String);
+        std::string error;
+        const CFTimeInterval start = CACurrentMediaTime();
+        std::shared_ptr<TilePyramid> pyramid = TilePyramid::open(
+            std::string_view(static_cast<const char *>(data.bytes), data.length), options, &error);
+        if (pyramid) {
+            NSLog(@"[MMTiledFloorView] Parsed %zu elements in %.1f ms, %d zoom levels",
+                  pyramid->plan().elementCount(), (CACurrentMediaTime() - start) * 1000.0, pyramid->maxZoom() + 1);
+        } else {
+            NSLog(@"[MMTiledFloorView] Not tiling the floor: %s", error.c_str());
+        }
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completion(pyramid ? [[MMTiledFloorView alloc] initWithFrame:frame pyramid:pyramid] : nil);
+        });
+    });
+}
+
++ (void)clearCache {
+    [[NSFileManager defaultManager] removeItemAtPath:MMTileCacheDirectory() error:nil];
+}
+
+- (instancetype)initWithFrame:(CGRect)frame pyramid:(std::shared_ptr<TilePyramid>)pyramid {
+    if ((self = [super initWithFrame:frame])) {
+        _pyramid = std::move(pyramid);
+        self.backgroundColor = [UIColor whiteColor];
+        self.contentMode = UIViewContentModeRedraw;
+        self.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
+        CATiledLayer *layer = (CATiledLayer *)self.layer;
+        const CGFloat tileSize = _pyramid->tileSize();
+        layer.tileSize = CGSizeMake(tileSize, tileSize);
+        // A zooming superview gets sharper tiles down to the deepest level
+        layer.levelsOfDetail = _pyramid->maxZoom() + 1;
+        layer.levelsOfDetailBias = _pyramid->maxZoom();
+    }
+    return self;
+}
+
+// The floor aspect-fit and centered in the bounds, in points
+- (CGRect)floorRectInBounds:(CGRect)bounds {
+    const Rect &document = _pyramid->plan().bounds();
+    const CGFloat width = document.maxX - document.minX;
+    const CGFloat height = document.maxY - document.minY;
+    const CGFloat scale = MIN(bounds.size.width / width, bounds.size.height / height);
+    return CGRectMake(bounds.origin.x + (bounds.size.width - width * scale) / 2,
+                      bounds.origin.y + (bounds.size.height - height * scale) / 2,
+                      width * scale,
+                      height * scale);
+}
+
+// Called by CATiledLayer on its own threads, once per layer tile on screen
+- (void)drawRect:(CGRect)rect {
+    std::shared_ptr<TilePyramid> pyramid = _pyramid;
+    CGContextRef context = UIGraphicsGetCurrentContext();
+    const Rect &document = pyramid->plan().bounds();
+    const CGRect floorRect = [self floorRectInBounds:self.bounds];
+    if (CGRectIsEmpty(floorRect)) {
+        return;
+    }
+    const CGFloat pointsPerUnit = floorRect.size.width / (document.maxX - document.minX);
+    // The context's scale covers the screen and any zoom of the layer
+    const CGFloat pixelsPerPoint = fabs(CGContextGetCTM(context).a);
+    const int zoom = pyramid->zoomForScale(static_cast<float>(pixelsPerPoint * pointsPerUnit));
+
+    auto toDocumentX = [&](CGFloat x) { return static_cast<float>(document.minX + (x - floorRect.origin.x) / pointsPerUnit); };
+    auto toDocumentY = [&](CGFloat y) { return static_cast<float>(document.minY + (y - floorRect.origin.y) / pointsPerUnit); };
+    const Rect visible{toDocumentX(CGRectGetMinX(rect)), toDocumentY(CGRectGetMinY(rect)),
+                       toDocumentX(CGRectGetMaxX(rect)), toDocumentY(CGRectGetMaxY(rect))};
+
+    CGContextSaveGState(context);
+    CGContextClipToRect(context, CGRectIntersection(rect, floorRect));
+    for (const TileKey &key : pyramid->visibleTiles(visible, zoom)) {
+        std::string png;
+        std::string error;
+        if (!pyramid->tile(key, &png, &error)) {
+            NSLog(@"[MMTiledFloorView] Tile %u/%u/%u failed: %s", key.zoom, key.x, key.y, error.c_str());
+            continue;
+        }
+        UIImage *image = [UIImage imageWithData:[NSData dataWithBytesNoCopy:&png[0] length:png.size() freeWhenDone:NO]];
+        const Rect bounds = pyramid->tileBounds(key);
+        [image drawInRect:CGRectMake(floorRect.origin.x + (bounds.minX - document.minX) * pointsPerUnit,
+                                     floorRect.origin.y + (bounds.minY - document.minY) * pointsPerUnit,
+                                     (bounds.maxX - bounds.minX) * pointsPerUnit,
+                                     (bounds.maxY - bounds.minY) * pointsPerUnit)];
+    }
+    CGContextRestoreGState(context);
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)stats {
+    const TilePyramidStats stats = _pyramid->stats();
+    return @{
+        @"maxZoom": @(_pyramid->maxZoom()),
+        @"rendered": @(stats.rendered),
+        @"renderMicros": @(stats.renderMicros),
+        @"diskHits": @(stats.diskHits),
+        @"bytesWritten": @(stats.bytesWritten),
+    };
+}
+
+@end
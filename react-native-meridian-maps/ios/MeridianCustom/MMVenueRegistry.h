@@ -0,0 +1,53 @@
+#import <Foundation/Foundation.h>
+#import <Meridian/Meridian.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The credentials one Meridian app (venue) was last used with.
+@interface MMVenue : NSObject
+@property (nonatomic, copy, readonly) NSString *appId;
+@property (nonatomic, copy, readonly) NSString *token;
+@property (nonatomic, readonly) MRDomainRegion region;
+@end
+
+/**
+ * Venues whose caches stay in memory (cpp/VenueRegistry.h).
+ *
+ * MMSession activates a venue whenever a view or a prewarm uses an app. The
+ * most recently active venues, up to maxWarmVenues, keep their placemark
+ * index, warm location manager and cached requests, so switching back to one
+ * does not start cold. activateApp:token:region:evicted: reports the venues
+ * that fell out so the session can release them. Main queue only, except stats.
+ */
+@interface MMVenueRegistry : NSObject
+
++ (instancetype)sharedRegistry;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/// Venues kept warm, at least 1. Defaults to 3.
+@property (nonatomic, readonly) NSUInteger maxWarmVenues;
+
+@property (nonatomic, readonly, nullable) MMVenue *activeVenue;
+
+/// The venue as last activated, or nil once it has been evicted.
+- (nullable MMVenue *)venueForApp:(NSString *)appId;
+
+/**
+ * Makes appId the active venue with these credentials. Returns YES when it was
+ * still warm; the app IDs of venues released to make room go to evicted.
+ */
+- (BOOL)activateApp:(NSString *)appId
+              token:(NSString *)token
+             region:(MRDomainRegion)region
+            evicted:(NSArray<NSString *> *_Nullable *_Nullable)evicted;
+
+/// Shrinks to maxWarmVenues; returns the app IDs of the venues released.
+- (NSArray<NSString *> *)setMaxWarmVenuesReturningEvicted:(NSUInteger)maxWarmVenues;
+
+/// activeAppId, warmAppIds (most recent first), maxWarmVenues, switches, warmSwitches, coldSwitches and evictions.
+- (NSDictionary<NSString *, id> *)stats;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,126 @@
+#import "MMVenueRegistry.h"
+
+#include <string>
+#include <vector>
+
+#include "VenueRegistry.h"
+
+using meridianmaps::VenueRegistry;
+
+@interface MMVenue ()
+- (instancetype)initWithAppId:(NSString *)appId token:(NSString *)token region:(MRDomainRegion)region;
+@end
+
+@implementation MMVenue
+
+- (instancetype)initWithAppId:(NSString *)appId token:(NSString *)token region:(MRDomainRegion)region {
+    if ((self = [super init])) {
+        _appId = [appId copy];
+        _token = [token copy];
+        _region = region;
+    }
+    return self;
+}
+
+@end
+
+static NSArray<NSString *> *MMStringArray(const std::vector<std::string> &values) {
+    NSMutableArray<NSString *> *result = [NSMutableArray arrayWithCapacity:values.size()];
+    for (const std::string &value : values) {
+        [result addObject:@(value.c_str())];
+    }
+    return result;
+}
+
+@implementation MMVenueRegistry {
+    // Guarded by @synchronized (self), for stats on the JS thread
+    VenueRegistry _registry;
+    NSMutableDictionary<NSString *, MMVenue *> *_venues;
+}
+
++ (instancetype)sharedRegistry {
+    static MMVenueRegistry *registry;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        registry = [[MMVenueRegistry alloc] initPrivate];
+    });
+    return registry;
+}
+
+- (instancetype)initPrivate {
+    if ((self = [super init])) {
+        _venues = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (NSUInteger)maxWarmVenues {
+    @synchronized (self) {
+        return _registry.capacity();
+    }
+}
+
+- (NSArray<NSString *> *)setMaxWarmVenuesReturningEvicted:(NSUInteger)maxWarmVenues {
+    std::vector<std::string> evicted;
+    @synchronized (self) {
+        _registry.setCapacity(maxWarmVenues, &evicted);
+        return [self forgetVenues:evicted];
+    }
+}
+
+- (MMVenue *)activeVenue {
+    @synchronized (self) {
+        const std::string &active = _registry.active();
+        return active.empty() ? nil : _venues[@(active.c_str())];
+    }
+}
+
+- (MMVenue *)venueForApp:(NSString *)appId {
+    @synchronized (self) {
+        return _venues[appId];
+    }
+}
+
+- (BOOL)activateApp:(NSString *)appId
+              token:(NSString *)token
+             region:(MRDomainRegion)region
+            evicted:(NSArray<NSString *> **)evicted {
+    std::vector<std::string> evictedIds;
+    @synchronized (self) {
+        const BOOL warm = _registry.activate(appId.UTF8String, &evictedIds);
+        _venues[appId] = [[MMVenue alloc] initWithAppId:appId token:token region:region];
+        NSArray<NSString *> *released = [self forgetVenues:evictedIds];
+        if (evicted) {
+            *evicted = released;
+        }
+        if (!warm) {
+            NSLog(@"[MMVenueRegistry] Venue %@ is cold%@", appId,
+                  released.count > 0 ? [NSString stringWithFormat:@", releasing %@", [released componentsJoinedByString:@", "]] : @"");
+        }
+        return warm;
+    }
+}
+
+// Called under the lock
+- (NSArray<NSString *> *)forgetVenues:(const std::vector<std::string> &)appIds {
+    NSArray<NSString *> *released = MMStringArray(appIds);
+    [_venues removeObjectsForKeys:released];
+    return released;
+}
+
+- (NSDictionary<NSString *, id> *)stats {
+    @synchronized (self) {
+        const meridianmaps::VenueRegistryStats &stats = _registry.stats();
+        return @{
+            @"activeAppId": @(_registry.active().c_str()),
+            @"warmAppIds": MMStringArray(_registry.venues()),
+            @"maxWarmVenues": @(_registry.capacity()),
+            @"switches": @(stats.switches),
+            @"warmSwitches": @(stats.warmSwitches),
+            @"coldSwitches": @(stats.coldSwitches),
+            @"evictions": @(stats.evictions)
+        };
+    }
+}
+
+@end
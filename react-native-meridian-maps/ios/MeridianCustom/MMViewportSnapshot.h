@@ -0,0 +1,36 @@
+#import <UIKit/UIKit.h>
+#import <Meridian/Meridian.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * What a map view showed when the app last went to the background: its
+ * floor, visible map rect, rotation and a JPEG of the rendered map, kept per
+ * floor under Caches/meridianmaps/viewports (cpp/ViewportSnapshot.h). A view
+ * mounting on relaunch shows the image at once and moves the live map to the
+ * same viewport when it has loaded.
+ */
+@interface MMViewportSnapshot : NSObject
+
+/// Draws the map view on the calling (main) thread, then encodes and writes it in a background task.
++ (void)captureMapView:(MRMapView *)mapView app:(NSString *)appId;
+
+/// The floor's snapshot if one was saved in the last week; reads the file on the calling thread.
++ (nullable MMViewportSnapshot *)snapshotForApp:(NSString *)appId map:(NSString *)mapId;
+
+/// Deletes every snapshot.
++ (void)clear;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, readonly, copy) NSString *mapId;
+@property (nonatomic, readonly) CGRect visibleMapRect;
+/// In radians, as MRMapView reports it
+@property (nonatomic, readonly) CGFloat rotationAngle;
+/// The map view's size in points when it was drawn
+@property (nonatomic, readonly) CGSize viewSize;
+@property (nonatomic, readonly, strong) UIImage *image;
+
+@end
+
+NS_ASSUME_NONNULL_END
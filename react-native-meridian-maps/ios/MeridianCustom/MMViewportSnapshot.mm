@@ -0,0 +1,124 @@
+#import "MMViewportSnapshot.h"
+
+#include <string>
+
+#include "ViewportSnapshot.h"
+
+using meridianmaps::ViewportSnapshot;
+using meridianmaps::ViewportSnapshotStore;
+
+// Older snapshots may show a venue that has changed since
+static const int64_t MMViewportSnapshotMaxAgeMs = 7ll * 24 * 60 * 60 * 1000;
+// Good enough for the quarter second it is on screen, at a fraction of the PNG size
+static const CGFloat MMViewportSnapshotQuality = 0.6;
+
+static std::string MMStdString(NSString *value) {
+    return value ? std::string(value.UTF8String) : std::string();
+}
+
+static int64_t MMNowMs(void) {
+    return static_cast<int64_t>([NSDate date].timeIntervalSince1970 * 1000.0);
+}
+
+static ViewportSnapshotStore &MMViewportSnapshotStore(void) {
+    static ViewportSnapshotStore *store;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        NSString *caches = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+        NSString *directory = [caches stringByAppendingPathComponent:@"meridianmaps/viewports"];
+        [[NSFileManager defaultManager] createDirectoryAtPath:directory.stringByDeletingLastPathComponent
+                                  withIntermediateDirectories:YES
+                                                   attributes:nil
+                                                        error:nil];
+        store = new ViewportSnapshotStore(std::string(directory.UTF8String));
+    });
+    return *store;
+}
+
+@interface MMViewportSnapshot ()
+- (instancetype)initWithSnapshot:(const ViewportSnapshot &)snapshot image:(UIImage *)image;
+@end
+
+@implementation MMViewportSnapshot
+
++ (void)captureMapView:(MRMapView *)mapView app:(NSString *)appId {
+    NSString *mapId = mapView.mapKey.identifier;
+    const CGSize size = mapView.bounds.size;
+    if (appId.length == 0 || mapId.length == 0 || size.width <= 0 || size.height <= 0) {
+        return;
+    }
+    UIGraphicsImageRendererFormat *format = [UIGraphicsImageRendererFormat preferredFormat];
+    // Past 2x the file grows without the fade looking any sharper
+    format.scale = MIN(format.scale, 2.0);
+    format.opaque = YES;
+    UIGraphicsImageRenderer *renderer = [[UIGraphicsImageRenderer alloc] initWithSize:size format:format];
+    UIImage *image = [renderer imageWithActions:^(UIGraphicsImageRendererContext *context) {
+        [mapView drawViewHierarchyInRect:mapView.bounds afterScreenUpdates:NO];
+    }];
+
+    ViewportSnapshot snapshot;
+    snapshot.appId = MMStdString(appId);
+    snapshot.mapId = MMStdString(mapId);
+    const CGRect rect = mapView.visibleMapRect;
+    snapshot.visibleRect = {static_cast<float>(CGRectGetMinX(rect)), static_cast<float>(CGRectGetMinY(rect)),
+                            static_cast<float>(CGRectGetMaxX(rect)), static_cast<float>(CGRectGetMaxY(rect))};
+    snapshot.rotation = static_cast<float>(mapView.rotationAngle);
+    snapshot.viewWidth = static_cast<float>(size.width);
+    snapshot.viewHeight = static_cast<float>(size.height);
+    snapshot.savedAtMs = MMNowMs();
+
+    // The app may be suspended soon after entering the background
+    UIApplication *application = [UIApplication sharedApplication];
+    __block UIBackgroundTaskIdentifier task = [application beginBackgroundTaskWithName:@"MMViewportSnapshot"
+                                                                     expirationHandler:^{
+        [application endBackgroundTask:task];
+        task = UIBackgroundTaskInvalid;
+    }];
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        ViewportSnapshot encoded = snapshot;
+        NSData *jpeg = UIImageJPEGRepresentation(image, MMViewportSnapshotQuality);
+        encoded.image.assign(static_cast<const char *>(jpeg.bytes), jpeg.length);
+        std::string error;
+        if (!MMViewportSnapshotStore().save(encoded, &error)) {
+            NSLog(@"[MMViewportSnapshot] Not saving %@: %s", mapId, error.c_str());
+        }
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (task != UIBackgroundTaskInvalid) {
+                [application endBackgroundTask:task];
+                task = UIBackgroundTaskInvalid;
+            }
+        });
+    });
+}
+
++ (MMViewportSnapshot *)snapshotForApp:(NSString *)appId map:(NSString *)mapId {
+    if (appId.length == 0 || mapId.length == 0) {
+        return nil;
+    }
+    ViewportSnapshot snapshot;
+    if (!MMViewportSnapshotStore().load(MMStdString(appId), MMStdString(mapId), MMNowMs(), MMViewportSnapshotMaxAgeMs,
+                                        &snapshot)) {
+        return nil;
+    }
+    NSData *jpeg = [NSData dataWithBytes:snapshot.image.data() length:snapshot.image.size()];
+    UIImage *image = [UIImage imageWithData:jpeg];
+    return image ? [[MMViewportSnapshot alloc] initWithSnapshot:snapshot image:image] : nil;
+}
+
++ (void)clear {
+    MMViewportSnapshotStore().clear();
+}
+
+- (instancetype)initWithSnapshot:(const ViewportSnapshot &)snapshot image:(UIImage *)image {
+    if ((self = [super init])) {
+        _mapId = [NSString stringWithUTF8String:snapshot.mapId.c_str()];
+        const meridianmaps::Rect &rect = snapshot.visibleRect;
+        _visibleMapRect = CGRectMake(rect.minX, rect.minY, rect.maxX - rect.minX, rect.maxY - rect.minY);
+        _rotationAngle = snapshot.rotation;
+        _viewSize = CGSizeMake(snapshot.viewWidth, snapshot.viewHeight);
+        _image = image;
+    }
+    return self;
+}
+
+@end
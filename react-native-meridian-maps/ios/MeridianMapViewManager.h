@@ -3,8 +3,52 @@
 #import <Meridian/Meridian.h>
 #import "MMHost.h"
 
+extern NSErrorDomain const MMRouteErrorDomain;
+
+typedef NS_ERROR_ENUM(MMRouteErrorDomain, MMRouteError) {
+    MMRouteErrorMapNotReady = 1,
+    MMRouteErrorPlacemarkNotFound,
+    MMRouteErrorFloorLoadFailed,
+    MMRouteErrorTimedOut,
+    MMRouteErrorSuperseded,
+};
+
+/// Bit positions of the view's events in eventMask. The order is shared with
+/// MAP_VIEW_EVENTS in src/MeridianMapView.tsx and MapViewEvent.NAMES on Android.
+typedef NS_ENUM(NSUInteger, MMMapViewEvent) {
+    MMMapViewEventMapLoadStart,
+    MMMapViewEventMapLoadFinish,
+    MMMapViewEventMapLoadFail,
+    MMMapViewEventMapRenderFinish,
+    MMMapViewEventMapTransformChange,
+    MMMapViewEventLocationUpdated,
+    MMMapViewEventOrientationUpdated,
+    MMMapViewEventMarkerSelect,
+    MMMapViewEventMarkerDeselect,
+    MMMapViewEventCalloutClick,
+    MMMapViewEventSearchActivityStarted,
+    MMMapViewEventDirectionsReroute,
+    MMMapViewEventDirectionsClick,
+    MMMapViewEventDirectionsStart,
+    MMMapViewEventRouteStepIndexChange,
+    MMMapViewEventDirectionsClosed,
+    MMMapViewEventDirectionsError,
+    MMMapViewEventUseAccessiblePathsChange,
+    MMMapViewEventDirectionsCalculated,
+    MMMapViewEventDirectionsRequestComplete,
+    MMMapViewEventDirectionsRequestError,
+    MMMapViewEventDirectionsRequestCanceled,
+    MMMapViewEventGeofenceTransition,
+    MMMapViewEventCount
+};
+
+/// Phase timings in milliseconds (placemarkLookupMs, floorLoadMs, routeCalcMs, totalMs) and floorSwitched, or an error.
+typedef void (^MMRouteCompletion)(NSDictionary *timings, NSError *error);
+
 @interface MeridianMapContainerView : UIView <MRMapViewDelegate, MRLocationManagerDelegate>
 
+// Per-view events; payloads match src/MeridianMapViewNativeComponent.ts.
+// A block is nil while JS has no handler for it, so unobserved events are never sent.
 @property (nonatomic, copy) RCTDirectEventBlock onMapLoadStart;
 @property (nonatomic, copy) RCTDirectEventBlock onMapLoadFinish;
 @property (nonatomic, copy) RCTDirectEventBlock onMapLoadFail;
@@ -12,7 +56,25 @@
 @property (nonatomic, copy) RCTDirectEventBlock onMapTransformChange;
 @property (nonatomic, copy) RCTDirectEventBlock onLocationUpdated;
 @property (nonatomic, copy) RCTDirectEventBlock onOrientationUpdated;
+@property (nonatomic, copy) RCTDirectEventBlock onMarkerSelect;
+@property (nonatomic, copy) RCTDirectEventBlock onMarkerDeselect;
+@property (nonatomic, copy) RCTDirectEventBlock onCalloutClick;
+@property (nonatomic, copy) RCTDirectEventBlock onSearchActivityStarted;
 @property (nonatomic, copy) RCTDirectEventBlock onDirectionsReroute;
+@property (nonatomic, copy) RCTDirectEventBlock onDirectionsClick;
+@property (nonatomic, copy) RCTDirectEventBlock onDirectionsStart;
+@property (nonatomic, copy) RCTDirectEventBlock onRouteStepIndexChange;
+@property (nonatomic, copy) RCTDirectEventBlock onDirectionsClosed;
+@property (nonatomic, copy) RCTDirectEventBlock onDirectionsError;
+@property (nonatomic, copy) RCTDirectEventBlock onUseAccessiblePathsChange;
+@property (nonatomic, copy) RCTDirectEventBlock onDirectionsCalculated;
+@property (nonatomic, copy) RCTDirectEventBlock onDirectionsRequestComplete;
+@property (nonatomic, copy) RCTDirectEventBlock onDirectionsRequestError;
+@property (nonatomic, copy) RCTDirectEventBlock onDirectionsRequestCanceled;
+@property (nonatomic, copy) RCTDirectEventBlock onGeofenceTransition;
+/// One bit per MMMapViewEvent that JS has a handler for; masked-out events are
+/// dropped before their payload is built. Defaults to all bits set.
+@property (nonatomic, assign) NSInteger eventMask;
 @property (nonatomic, strong) MRMapViewController *mapViewController;
 
 // Settings
@@ -20,6 +82,41 @@
 @property (nonatomic, copy) NSString *mapId;
 @property (nonatomic, copy) NSString *appToken;
 @property (nonatomic, assign) BOOL showLocationUpdates;
+/// smoothing, maxRateHz, minDisplacement, minAccuracyImprovement and coalesceWindowMs
+/// for onLocationUpdated; fixes that fail them never reach JS.
+@property (nonatomic, copy) NSDictionary *locationUpdateOptions;
+/// Bytes of recent fixes to keep for locationHistoryWithOptions:; 0 keeps none.
+@property (nonatomic, assign) NSInteger locationHistoryBytes;
+/// enabled, stillDelayMs, stillPollIntervalMs, pollTimeoutMs and pauseWhenHidden:
+/// pauses the location manager while the device is still or the view is hidden.
+@property (nonatomic, copy) NSDictionary *locationDutyCycle;
+/// While a floor loads, show it from a tile pyramid of its cached SVG (MMTiledFloorView). Off by default.
+@property (nonatomic, assign) BOOL tiledFloorPreview;
+/// Save what the map shows when the app goes to the background, and show it at once on the
+/// next mount of the same floor until the map has loaded and moved to the same viewport. On by default.
+@property (nonatomic, assign) BOOL viewportSnapshot;
+
+/**
+ * Looks the placemark up, switches to its floor and shows a route to it from
+ * the current location. Each step waits on the SDK callback that ends it, so
+ * completion runs once the route is on screen. A newer call supersedes this one.
+ */
+- (void)startRouteToPlacemarkWithID:(NSString *)placemarkID completion:(MMRouteCompletion)completion;
+
+/// Recent fixes of this view; see -[MMLocationHistory queryWithOptions:].
+- (NSDictionary *)locationHistoryWithOptions:(NSDictionary *)options;
+
+/// Registers geofences checked against every fix; see MMGeofenceEngine.
+- (BOOL)addGeofences:(NSArray<NSDictionary *> *)geofences error:(NSError **)error;
+
+/// Forgets the geofences without reporting exits; nil forgets all of them.
+- (void)removeGeofencesWithIDs:(NSArray<NSString *> *)ids;
+
+/// Time spent running and paused by every view's duty cycle, and the fixes received.
++ (NSDictionary *)locationPowerStats;
+
+/// Events sent and dropped by event masks since launch: dispatched, suppressed and byEvent.
++ (NSDictionary *)eventStats;
 
 @end
 
@@ -1,7 +1,18 @@
 #import "MeridianMapViewManager.h"
+#import "MMAssetCache.h"
+#import "MMFloorPrefetcher.h"
+#import "MMGeofenceEngine.h"
 #import "MMHost.h"
-#import "MMEventEmitter.h"
-#import "MMEventNames.h"
+#import "MMLocationDutyCycle.h"
+#import "MMLocationHistory.h"
+#import "MMLocationThrottle.h"
+#import "MMLocationTrace.h"
+#import "MMMapPool.h"
+#import "MMPlacemarkIndex.h"
+#import "MMRequestBroker.h"
+#import "MMSession.h"
+#import "MMTiledFloorView.h"
+#import "MMViewportSnapshot.h"
 #import "CustomMapViewController.h"
 #import <CoreGraphics/CoreGraphics.h>
 #import <Meridian/Meridian.h>
@@ -14,7 +25,31 @@
 // For NSString methods
 #import <Foundation/Foundation.h>
 
-@interface MeridianMapContainerView () <MRMapViewDelegate, CLLocationManagerDelegate> {
+NSErrorDomain const MMRouteErrorDomain = @"MeridianMapViewRoute";
+
+// Watchdogs for SDK callbacks that may never arrive, e.g. a floor that never finishes loading
+static const NSTimeInterval MMRouteFloorLoadTimeout = 15.0;
+// The SDK directions flow may wait on the user to pick a start point
+static const NSTimeInterval MMRouteFallbackTimeout = 120.0;
+// Until JS sets locationHistoryBytes; about 10,000 walking fixes
+static const NSInteger MMDefaultLocationHistoryBytes = 64 * 1024;
+
+// Handler prop names in MMMapViewEvent order, for eventStats
+static NSString *const MMMapViewEventNames[MMMapViewEventCount] = {
+    @"onMapLoadStart", @"onMapLoadFinish", @"onMapLoadFail", @"onMapRenderFinish",
+    @"onMapTransformChange", @"onLocationUpdated", @"onOrientationUpdated", @"onMarkerSelect",
+    @"onMarkerDeselect", @"onCalloutClick", @"onSearchActivityStarted", @"onDirectionsReroute",
+    @"onDirectionsClick", @"onDirectionsStart", @"onRouteStepIndexChange", @"onDirectionsClosed",
+    @"onDirectionsError", @"onUseAccessiblePathsChange", @"onDirectionsCalculated",
+    @"onDirectionsRequestComplete", @"onDirectionsRequestError", @"onDirectionsRequestCanceled",
+    @"onGeofenceTransition",
+};
+
+// Event counters; events are only raised on the main thread
+static uint64_t MMEventsDispatched[MMMapViewEventCount];
+static uint64_t MMEventsSuppressed[MMMapViewEventCount];
+
+@interface MeridianMapContainerView () <MRMapViewDelegate, CLLocationManagerDelegate, CustomMapViewControllerDelegate, MMLocationReplayListener> {
   NSString *_appToken;
   NSString *_appId;
   NSString *_mapId;
@@ -26,8 +61,42 @@
 @property(nonatomic, strong) UIView *loadingOverlay;
 @property(nonatomic, assign) BOOL isWaitingForDirections;
 @property(nonatomic, strong) MRLocationManager *locationManager;
+@property(nonatomic, strong) MMLocationFilter *locationFilter;
+@property(nonatomic, strong) MMLocationThrottle *locationThrottle;
+@property(nonatomic, strong) MMLocationHistory *locationHistory;
+@property(nonatomic, strong) MMGeofenceEngine *geofenceEngine;
+@property(nonatomic, strong) MMLocationDutyCycle *dutyCycle;
 @property(nonatomic, strong) MREditorKey *appKey;
 @property(nonatomic, strong) CLLocationManager *permissionLocationManager;
+@property(nonatomic, strong) MMRequestSubscription *routeSubscription;
+
+// Route start in progress; routeTimings is nil when there is none
+@property(nonatomic, assign) NSUInteger routeGeneration;
+@property(nonatomic, copy) MMRouteCompletion routeCompletion;
+@property(nonatomic, strong) NSMutableDictionary<NSString *, id> *routeTimings;
+@property(nonatomic, assign) CFTimeInterval routeStartTime;
+@property(nonatomic, assign) CFTimeInterval routePhaseStartTime;
+@property(nonatomic, strong) MRPlacemark *routeTarget;
+// Floor whose mapViewControllerDidFinishLoadingMap: starts the directions
+@property(nonatomic, copy) NSString *routeAwaitedFloor;
+// Set while the SDK directions flow is expected to report the route
+@property(nonatomic, assign) BOOL routeAwaitingDisplay;
+
+// For the session's time-to-first-render stats
+@property(nonatomic, assign) CFTimeInterval createdTime;
+@property(nonatomic, assign) BOOL createdPrewarmed;
+@property(nonatomic, assign) BOOL firstRenderRecorded;
+
+// Map the controller was created for, which keys it in MMMapPool
+@property(nonatomic, copy) NSString *controllerMapId;
+
+// Tiles of the loading floor shown over the map until the SDK has drawn it
+@property(nonatomic, strong) MMTiledFloorView *floorPreview;
+@property(nonatomic, copy) NSString *floorPreviewMapId;
+
+// What the map showed when the app last left it, shown until the floor has loaded
+@property(nonatomic, strong) MMViewportSnapshot *viewportSnapshotShown;
+@property(nonatomic, strong) UIImageView *viewportSnapshotView;
 
 @end
 
@@ -41,6 +110,38 @@
     _appId = nil;
     _mapId = nil;
     _appToken = nil;
+    _eventMask = -1;
+    _viewportSnapshot = YES;
+    _createdTime = CACurrentMediaTime();
+    _createdPrewarmed = [MMSession sharedSession].isPrewarmed;
+    // Floors cached on an earlier launch are served from the first load on
+    [MMAssetCache sharedCache];
+    [[MMFloorPrefetcher sharedPrefetcher] addClient];
+    __weak typeof(self) weakSelf = self;
+    _locationFilter = [[MMLocationFilter alloc] init];
+    _locationHistoryBytes = MMDefaultLocationHistoryBytes;
+    _locationHistory = [[MMLocationHistory alloc] initWithCapacity:MMDefaultLocationHistoryBytes];
+    _geofenceEngine = [[MMGeofenceEngine alloc] init];
+    _locationThrottle = [[MMLocationThrottle alloc] initWithHandler:^(MMLocationFix *fix) {
+        [weakSelf sendLocationFix:fix];
+    }];
+    _dutyCycle = [[MMLocationDutyCycle alloc] initWithHandler:^(BOOL running) {
+        [weakSelf updateLocationUpdates];
+    }];
+    [[MMLocationReplay sharedReplay] addListener:self];
+    NSNotificationCenter *center = [NSNotificationCenter defaultCenter];
+    [center addObserver:self
+               selector:@selector(updateVisibility)
+                   name:UIApplicationDidEnterBackgroundNotification
+                 object:nil];
+    [center addObserver:self
+               selector:@selector(captureViewportSnapshot)
+                   name:UIApplicationDidEnterBackgroundNotification
+                 object:nil];
+    [center addObserver:self
+               selector:@selector(updateVisibility)
+                   name:UIApplicationWillEnterForegroundNotification
+                 object:nil];
     _permissionLocationManager = [[CLLocationManager alloc] init];
     _permissionLocationManager.delegate = self;
   }
@@ -49,6 +150,7 @@
 
 - (void)dealloc {
     NSLog(@"[MeridianMapView] Deallocating MeridianMapContainerView");
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
 
     // Stop location updates
     if (self.locationManager) {
@@ -62,13 +164,40 @@
         self.permissionLocationManager = nil;
     }
 
-    // Clean up map view controller
-    if (self.mapViewController) {
-        [self.mapViewController.view removeFromSuperview];
+    // Leaves a shared directions request running for the other views
+    [self finishRouteWithError:[self routeErrorWithCode:MMRouteErrorMapNotReady description:@"The map view was removed"]];
+    [self.routeSubscription cancel];
+    // Likewise the prefetch plan, until the last view goes
+    [[MMFloorPrefetcher sharedPrefetcher] removeClient];
+
+    // Keep the loaded map for the next view of the same app and map
+    CustomMapViewController *mapViewController = self.mapViewController;
+    if (mapViewController) {
         self.mapViewController = nil;
+        [[MMMapPool sharedPool] parkController:mapViewController app:self.appId map:self.controllerMapId];
     }
 }
 
+- (void)didMoveToWindow {
+  [super didMoveToWindow];
+  [self updateVisibility];
+}
+
+// Hidden views may pause location; see MMLocationDutyCycle
+- (void)updateVisibility {
+  const BOOL foreground = [UIApplication sharedApplication].applicationState != UIApplicationStateBackground;
+  [self.dutyCycle setVisible:self.window != nil && foreground];
+}
+
+- (void)setLocationDutyCycle:(NSDictionary *)locationDutyCycle {
+  _locationDutyCycle = [locationDutyCycle copy];
+  [self.dutyCycle setOptions:locationDutyCycle];
+}
+
++ (NSDictionary *)locationPowerStats {
+  return [MMLocationDutyCycle totalStats];
+}
+
 - (void)layoutSubviews {
   [super layoutSubviews];
 
@@ -76,6 +205,13 @@
   if (self.mapViewController) {
     self.mapViewController.view.frame = self.bounds;
   }
+  // Stretched to another aspect, the snapshot would not line up with the map
+  const CGSize snapshotSize = self.viewportSnapshotShown.viewSize;
+  const CGSize size = self.bounds.size;
+  if (self.viewportSnapshotView && size.width > 0 && size.height > 0 &&
+      fabs(snapshotSize.width / snapshotSize.height - size.width / size.height) > 0.02) {
+    [self hideViewportSnapshotAnimated:NO];
+  }
 }
 
 - (void)setAppId:(NSString *)appId {
@@ -100,8 +236,6 @@
         [appToken substringToIndex:MIN(10, appToken.length)] ?: @"(nil)");
   if (![_appToken isEqualToString:appToken]) {
     [self updateMapIfNeeded];
-    MMEventEmitter *emitter = [self.bridge moduleForClass:[MMEventEmitter class]];
-    [emitter emitCustomEvent:MMEventMarkerSelect body:@{@"message": @"app token has been set"}];
     _appToken = [appToken copy];
   }
 }
@@ -120,67 +254,61 @@
 
   @try {
     [self layoutSubviews];
-    // Configure the Meridian SDK
-    MRConfig *config = [MRConfig new];
-    [config domainConfig].domainRegion = MRDomainRegionDefault;
-    config.applicationToken = self.appToken ?: [MMHost applicationToken];
-    [Meridian configure:config];
-
-    // Set up navigation bar appearance
-    UINavigationBarAppearance *appearance =
-        [[UINavigationBarAppearance alloc] init];
-    [appearance configureWithOpaqueBackground];
-    [appearance setBackgroundColor:[UIColor colorWithRed:0.1395
-                                                   green:0.8678
-                                                    blue:0.7167
-                                                   alpha:1.0]];
-    appearance.titleTextAttributes =
-        @{NSForegroundColorAttributeName : [UIColor whiteColor]};
-    [[UINavigationBar appearance] setStandardAppearance:appearance];
-    [[UINavigationBar appearance] setScrollEdgeAppearance:appearance];
-    [UINavigationBar appearance].tintColor = [UIColor whiteColor];
-    [[UITextField
-        appearanceWhenContainedInInstancesOfClasses:@[ UISearchBar.class ]]
-        setTintColor:[[UIView alloc] init].tintColor];
-
-    // Create the map view controller
-    MREditorKey *mapId = [MREditorKey keyForMap:self.mapId app:self.appId];
+    // A no-op when prewarm or an earlier view already configured the SDK for this venue
+    MMSession *session = [MMSession sharedSession];
+    [session activateApp:self.appId token:self.appToken ?: [MMHost applicationToken]];
+
+    // Reuse a map an earlier view left loaded, or create the map view controller
     CustomMapViewController *mapViewController =
-        [[CustomMapViewController alloc] initWithEditorKey:mapId];
+        [[MMMapPool sharedPool] takeControllerForApp:self.appId map:self.mapId];
+    const BOOL reused = mapViewController != nil;
+    if (!mapViewController) {
+      MREditorKey *mapId = [MREditorKey keyForMap:self.mapId app:self.appId];
+      mapViewController = [[CustomMapViewController alloc] initWithEditorKey:mapId];
+    }
 
     if (!mapViewController) {
       [NSException raise:@"MapViewControllerCreationFailed" format:@"Failed to create map view controller"];
     }
 
     mapViewController.displaysSearchSheet = YES;
+    mapViewController.eventDelegate = self;
 
+    self.controllerMapId = self.mapId;
     self.mapViewController = mapViewController;
+    if (!reused) {
+      [self showViewportSnapshot];
+    }
 
     // Set up location manager
     self.appKey = [MREditorKey keyWithIdentifier:self.appId];
-    self.locationManager = [[MRLocationManager alloc] initWithApp:self.appKey];
+    self.locationManager = [session takeLocationManagerForApp:self.appKey];
     self.locationManager.delegate = self;
 
     // Start location updates if enabled
     [self updateLocationUpdates];
 
-    MMEventEmitter *emitter = [self.bridge moduleForClass:[MMEventEmitter class]];
-    [emitter emitCustomEvent:MMEventMapLoadFinish body:@{@"message": @"map load finished"}];
+    // Warm the shared placemark index so the first route start is a local lookup
+    [[MMPlacemarkIndex indexForApp:self.appId] hydrateWithCompletion:nil];
+
     self.isMapInitialized = YES;
 
+    // A reused map will not load again; report it once the handler props of this batch are set
+    if (reused && mapViewController.isMapLoaded) {
+      __weak typeof(self) weakSelf = self;
+      dispatch_async(dispatch_get_main_queue(), ^{
+        [weakSelf mapViewControllerDidReuseLoadedMap:mapViewController];
+      });
+    }
+
   } @catch (NSException *exception) {
     NSLog(@"[MeridianMapView] Error setting up map: %@", exception.reason);
 
-    MMEventEmitter *emitter = [self.bridge moduleForClass:[MMEventEmitter class]];
-    NSDictionary *errorData = @{
-        @"error": exception.reason ?: @"Unknown error setting up map",
-        @"name": exception.name ?: @"UnknownException"
-    };
-    [emitter emitCustomEvent:MMEventMapLoadFail body:errorData];
-
-    // Also emit via the RCT event if available
-    if (self.onMapLoadFail) {
-        self.onMapLoadFail(errorData);
+    if ([self shouldSendEvent:MMMapViewEventMapLoadFail handler:self.onMapLoadFail]) {
+        self.onMapLoadFail(@{
+            @"error": exception.reason ?: @"Unknown error setting up map",
+            @"domain": exception.name ?: @"UnknownException"
+        });
     }
   }
 }
@@ -210,36 +338,11 @@
 
       // Update location updates based on current setting
       [self updateLocationUpdates];
-
-      // Trigger loading event
-      if (self.onMapLoadStart) {
-        self.onMapLoadStart(@{});
-      }
-
-      // Set up success/failure handling
-      dispatch_after(
-          dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.5 * NSEC_PER_SEC)),
-          dispatch_get_main_queue(), ^{
-            if (self.onMapLoadFinish) {
-              self.onMapLoadFinish(@{});
-            }
-          });
     }
 
   }
 }
 
-- (void)mapView:(MRMapView *)mapView didSelectAnnotationView:(MRAnnotationView *)view {
-    id<MRAnnotation> annotation = view.annotation;
-    if (![annotation isKindOfClass:[MRPlacemark class]]) {
-        return;
-    }
-    MRPlacemark *placemark = (MRPlacemark *)annotation;
-    NSString *placemarkID = placemark.key.identifier;
-    NSLog(@"Selected placemark ID: %@", placemarkID);
-    // Additional handling code here
-}
-
 - (void)mapPickerDidPickMap:(nonnull MRMap *)map {
   NSLog(@"mapPickerDidPickMap");
 }
@@ -315,7 +418,7 @@
         return;
     }
 
-    if (self.showLocationUpdates) {
+    if (self.showLocationUpdates && self.dutyCycle.running) {
         CLAuthorizationStatus status;
         if (@available(iOS 14.0, *)) {
             status = self.permissionLocationManager.authorizationStatus;
@@ -331,18 +434,15 @@
             [self.locationManager startUpdatingLocation];
         } else {
             NSLog(@"[MeridianMapView] Location permission is denied or restricted. Status: %d", status);
-            MMEventEmitter *emitter = [self.bridge moduleForClass:[MMEventEmitter class]];
-            NSDictionary *errorData = @{
-                @"error": @"Location permission denied or restricted.",
-                @"code": @(status)
-            };
-            [emitter emitCustomEvent:MMEventMapLoadFail body:errorData];
-            if (self.onMapLoadFail) {
-                self.onMapLoadFail(errorData);
+            if ([self shouldSendEvent:MMMapViewEventMapLoadFail handler:self.onMapLoadFail]) {
+                self.onMapLoadFail(@{
+                    @"error": @"Location permission denied or restricted.",
+                    @"code": @(status)
+                });
             }
         }
     } else {
-        NSLog(@"[MeridianMapView] Stopping location updates");
+        NSLog(@"[MeridianMapView] Stopping location updates%@", self.showLocationUpdates ? @" while the device is still or the view is hidden" : @"");
         [self.locationManager stopUpdatingLocation];
     }
 }
@@ -361,46 +461,124 @@
 #pragma mark - MRLocationManagerDelegate
 
 - (void)locationManager:(MRLocationManager *)manager didUpdateToLocation:(MRLocation *)location {
-    NSLog(@"[MeridianMapView] New location received: %@", location);
+    [self.dutyCycle recordFix];
+    // A trace replay stands in for the location manager until it ends
+    if ([MMLocationReplay sharedReplay].isActive) {
+        return;
+    }
+    MMLocationFix *fix = [MMLocationFix fixWithLocation:location];
+    [[MMLocationRecorder sharedRecorder] recordFix:fix];
+    [self receiveLocationFix:fix];
+}
 
-    MMEventEmitter *emitter = [self.bridge moduleForClass:[MMEventEmitter class]];
+- (void)locationReplayDidDeliverFix:(MMLocationFix *)fix {
+    [self receiveLocationFix:fix];
+}
 
-    // Convert location to dictionary for React Native
-    NSDictionary *locationData = @{
-        @"point": @{
-            @"x": @(location.point.x),
-            @"y": @(location.point.y)
-        },
-        @"accuracy": @(location.accuracy),
-        @"timestamp": @([location.timestamp timeIntervalSince1970] * 1000), // Convert to milliseconds
-        @"mapKey": location.mapKey.identifier ?: @"",
-        @"providerType": @(location.providerType)
-    };
+- (void)receiveLocationFix:(MMLocationFix *)fix {
+    // Smooth first so the history, the geofences and the throttle see the
+    // filtered track. The history and the geofences see every fix, whether or
+    // not JS listens for them.
+    MMLocationFix *filtered = [self.locationFilter filterFix:fix];
+    if (self.locationHistoryBytes > 0) {
+        [self.locationHistory appendFix:filtered];
+    }
+    for (NSDictionary *transition in [self.geofenceEngine transitionsForFix:filtered]) {
+        if ([self shouldSendEvent:MMMapViewEventGeofenceTransition handler:self.onGeofenceTransition]) {
+            self.onGeofenceTransition(transition);
+        }
+    }
+    // Nobody listens: count it as suppressed without running it through the throttle
+    if (!self.onLocationUpdated || !(self.eventMask & (1 << MMMapViewEventLocationUpdated))) {
+        MMEventsSuppressed[MMMapViewEventLocationUpdated]++;
+        return;
+    }
+    [self.locationThrottle offerFix:filtered];
+}
+
+- (void)setLocationHistoryBytes:(NSInteger)locationHistoryBytes {
+    _locationHistoryBytes = MAX(locationHistoryBytes, 0);
+    if (_locationHistoryBytes == 0) {
+        [self.locationHistory clear];
+    } else {
+        self.locationHistory.capacity = (NSUInteger)_locationHistoryBytes;
+    }
+}
 
-    [emitter emitCustomEvent:MMEventLocationUpdated body:locationData];
+- (NSDictionary *)locationHistoryWithOptions:(NSDictionary *)options {
+    return [self.locationHistory queryWithOptions:options];
+}
 
-    // Also emit via the RCT event if available
-    if (self.onLocationUpdated) {
-        self.onLocationUpdated(locationData);
+- (BOOL)addGeofences:(NSArray<NSDictionary *> *)geofences error:(NSError **)error {
+    if (![self.geofenceEngine addGeofences:geofences error:error]) {
+        return NO;
     }
+    // Placemark geofences on the floor already shown resolve right away
+    [self.geofenceEngine resolvePlacemarks:[self shownPlacemarks]];
+    return YES;
 }
 
-- (void)locationManager:(MRLocationManager *)manager didFailWithError:(NSError *)error {
-    NSLog(@"[MeridianMapView] Location error: %@", error.localizedDescription);
+- (NSArray<MRPlacemark *> *)shownPlacemarks {
+    NSMutableArray<MRPlacemark *> *placemarks = [NSMutableArray array];
+    for (id<MRAnnotation> annotation in self.mapViewController.mapView.placemarks) {
+        if ([(id)annotation isKindOfClass:[MRPlacemark class]]) {
+            [placemarks addObject:(MRPlacemark *)annotation];
+        }
+    }
+    return placemarks;
+}
 
-    MMEventEmitter *emitter = [self.bridge moduleForClass:[MMEventEmitter class]];
+- (void)removeGeofencesWithIDs:(NSArray<NSString *> *)ids {
+    [self.geofenceEngine removeGeofencesWithIDs:ids];
+}
 
-    NSDictionary *errorData = @{
-        @"error": error.localizedDescription ?: @"Unknown location error",
-        @"code": @(error.code),
-        @"domain": error.domain ?: @"Unknown"
-    };
+- (void)setLocationUpdateOptions:(NSDictionary *)locationUpdateOptions {
+    _locationUpdateOptions = [locationUpdateOptions copy];
+    [self.locationThrottle setOptions:locationUpdateOptions];
+    id smoothing = locationUpdateOptions[@"smoothing"];
+    self.locationFilter.enabled = [smoothing isKindOfClass:[NSNumber class]] ? [smoothing boolValue] : YES;
+}
 
-    [emitter emitCustomEvent:MMEventMapLoadFail body:errorData];
+// Called by the throttle for the fixes that are worth sending
+- (void)sendLocationFix:(MMLocationFix *)fix {
+    if (![self shouldSendEvent:MMMapViewEventLocationUpdated handler:self.onLocationUpdated]) {
+        return;
+    }
 
-    // Also emit via the RCT event if available
-    if (self.onMapLoadFail) {
-        self.onMapLoadFail(errorData);
+    // Convert location to dictionary for React Native
+    NSMutableDictionary *event = [@{
+        @"point": @{
+            @"x": @(fix.point.x),
+            @"y": @(fix.point.y)
+        },
+        @"rawPoint": @{
+            @"x": @(fix.rawPoint.x),
+            @"y": @(fix.rawPoint.y)
+        },
+        @"accuracy": @(fix.accuracy),
+        @"timestamp": @(fix.timestamp),
+        @"mapKey": fix.mapKey,
+        @"providerType": @(fix.providerType)
+    } mutableCopy];
+    if (fix.hasVelocity) {
+        event[@"velocity"] = @{@"x": @(fix.velocity.dx), @"y": @(fix.velocity.dy)};
+        event[@"speed"] = @(fix.speed);
+    }
+    if (fix.hasHeading) {
+        event[@"heading"] = @(fix.heading);
+    }
+    self.onLocationUpdated(event);
+}
+
+- (void)locationManager:(MRLocationManager *)manager didFailWithError:(NSError *)error {
+    NSLog(@"[MeridianMapView] Location error: %@", error.localizedDescription);
+
+    if ([self shouldSendEvent:MMMapViewEventMapLoadFail handler:self.onMapLoadFail]) {
+        self.onMapLoadFail(@{
+            @"error": error.localizedDescription ?: @"Unknown location error",
+            @"code": @(error.code),
+            @"domain": error.domain ?: @"Unknown"
+        });
     }
 }
 
@@ -447,13 +625,11 @@
     }
 }
 
-- (void)hideLoadingAfterDelay:(NSTimeInterval)delay {
-    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
-        [self hideLoading];
-    });
+- (void)startRouteToPlacemarkWithID:(NSString *)placemarkID {
+    [self startRouteToPlacemarkWithID:placemarkID completion:nil];
 }
 
-- (void)startRouteToPlacemarkWithID:(NSString *)placemarkID {
+- (void)startRouteToPlacemarkWithID:(NSString *)placemarkID completion:(MMRouteCompletion)completion {
     NSLog(@"[MeridianMapView] *** START ROUTE CALLED ***");
     NSLog(@"[MeridianMapView] Target placemark ID: %@", placemarkID);
     NSLog(@"[MeridianMapView] Current map key: %@", self.mapViewController.mapView.mapKey.identifier);
@@ -461,114 +637,443 @@
     // Ensure the mapView is available
     if (!self.mapViewController.mapView) {
         NSLog(@"[MeridianMapView] ERROR: Map view is not initialized.");
+        if (completion) {
+            completion(nil, [self routeErrorWithCode:MMRouteErrorMapNotReady description:@"Map view is not initialized"]);
+        }
         return;
     }
 
+    // A newer route start wins; the previous caller is told it was superseded
+    [self finishRouteWithError:[self routeErrorWithCode:MMRouteErrorSuperseded description:@"Superseded by a newer route"]];
+    NSUInteger generation = ++self.routeGeneration;
+    self.routeCompletion = completion;
+    self.routeTimings = [NSMutableDictionary dictionary];
+    self.routeStartTime = CACurrentMediaTime();
+    self.routePhaseStartTime = self.routeStartTime;
+
     // Show loading indicator
     [self showLoading];
 
-    // Use the smart approach: find the placemark from our all-floors search and use the built-in method
-    [self getAllPlacemarksFromAllFloors:^(NSArray<MRPlacemark *> *placemarks, NSError *error) {
+    // Resolve the placemark through the shared per-app index; only the first lookup hits the network
+    MMPlacemarkIndex *placemarkIndex = [MMPlacemarkIndex indexForApp:self.appId];
+    [placemarkIndex lookupPlacemarkWithID:placemarkID completion:^(MMPlacemarkRecord *record, NSError *error) {
+        if (generation != self.routeGeneration) {
+            return;
+        }
         if (error) {
             NSLog(@"[MeridianMapView] Error finding placemark: %@", error.localizedDescription);
-            // [self hideLoading];
+            [self finishRouteWithError:error];
             return;
         }
 
-        // Find the target placemark
-        MRPlacemark *targetPlacemark = nil;
-        for (MRPlacemark *placemark in placemarks) {
-            if ([placemark.key.identifier isEqualToString:placemarkID]) {
-                targetPlacemark = placemark;
-                NSLog(@"[MeridianMapView] Found target placemark: %@ (%@) on floor: %@",
-                      placemark.key.identifier,
-                      placemark.name ?: @"no name",
-                      placemark.key.parent.identifier);
-                break;
-            }
-        }
-
-        if (!targetPlacemark) {
+        if (!record) {
             NSLog(@"[MeridianMapView] ERROR: Could not find placemark with ID: %@", placemarkID);
-            // [self hideLoading];
+            [self finishRouteWithError:[self routeErrorWithCode:MMRouteErrorPlacemarkNotFound
+                                                    description:[NSString stringWithFormat:@"No placemark with ID %@", placemarkID]]];
             return;
         }
 
-        dispatch_async(dispatch_get_main_queue(), ^{
-            // Switch to the correct floor if needed
-            NSString *currentFloor = self.mapViewController.mapView.mapKey.identifier;
-            NSString *targetFloor = targetPlacemark.key.parent.identifier;
-
-                        if (![currentFloor isEqualToString:targetFloor]) {
-                NSLog(@"[MeridianMapView] Switching from floor %@ to floor %@", currentFloor, targetFloor);
-                // Switch floor immediately and start directions with minimal delay
-                self.mapViewController.mapView.mapKey = targetPlacemark.key.parent;
-
-                // Start directions with a very short delay to allow floor switch
-                dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.3 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
-                    NSLog(@"[MeridianMapView] Floor switched, starting directions to placemark");
-                    [self.mapViewController startDirectionsToPlacemark:targetPlacemark];
-                    [self hideLoadingAfterDelay:5.0];
-                });
-            } else {
-                NSLog(@"[MeridianMapView] Already on correct floor, starting directions immediately");
-                [self.mapViewController startDirectionsToPlacemark:targetPlacemark];
-                [self hideLoadingAfterDelay:1.0];
-            }
-        });
+        NSLog(@"[MeridianMapView] Found target placemark: %@ (%@) on floor: %@",
+              record.identifier,
+              record.name ?: @"no name",
+              record.mapKey.identifier);
+        [self endRoutePhase:@"placemarkLookupMs"];
+        self.routeTarget = [record placemark];
+
+        // Switch to the correct floor if needed
+        NSString *currentFloor = self.mapViewController.mapView.mapKey.identifier;
+        NSString *targetFloor = record.mapKey.identifier;
+
+        if (![currentFloor isEqualToString:targetFloor]) {
+            NSLog(@"[MeridianMapView] Switching from floor %@ to floor %@", currentFloor, targetFloor);
+            // Directions start from mapViewControllerDidFinishLoadingMap: once the floor is on screen
+            self.routeAwaitedFloor = targetFloor;
+            self.routeTimings[@"floorSwitched"] = @YES;
+            self.mapViewController.mapView.mapKey = record.mapKey;
+            [self failRouteGeneration:generation
+                           afterDelay:MMRouteFloorLoadTimeout
+                                 code:MMRouteErrorTimedOut
+                          description:@"Timed out waiting for the floor to load"];
+        } else {
+            NSLog(@"[MeridianMapView] Already on correct floor, starting directions immediately");
+            self.routeTimings[@"floorSwitched"] = @NO;
+            [self endRoutePhase:@"floorLoadMs"];
+            [self requestDirectionsToPlacemark:self.routeTarget];
+        }
     }];
 }
 
-- (void)getAllPlacemarksFromAllFloors:(void (^)(NSArray<MRPlacemark *> *placemarks, NSError *error))completion {
-    NSLog(@"[MeridianMapView] === SEARCHING ALL FLOORS FOR PLACEMARKS ===");
-    NSLog(@"[MeridianMapView] Using App ID: %@", self.appId);
+- (void)requestDirectionsToPlacemark:(MRPlacemark *)targetPlacemark {
+    // Replaces this view's previous route without cancelling it for other views sharing it
+    [self.routeSubscription cancel];
 
-    // Create a placemark request to search across all maps in the app
+    // Routes from the current location go stale as the user moves, so they are
+    // shared while in flight but never cached
     MREditorKey *appKey = [MREditorKey keyWithIdentifier:self.appId];
-    MRPlacemarkRequest *request = [[MRPlacemarkRequest alloc] initWithApp:appKey placemarkIdentifier:nil mapKey:nil];
-
-    [request startWithCompletionHandler:^(MRPlacemarkResponse *response, NSError *error) {
-        if (error) {
-            NSLog(@"[MeridianMapView] Error getting all placemarks: %@", error.localizedDescription);
-            completion(nil, error);
+    NSString *key = [MMRequestBroker fingerprintWithKind:@"directions"
+                                              components:@[self.appId, @"current-location", targetPlacemark.key.identifier ?: @""]];
+    NSUInteger generation = self.routeGeneration;
+    __weak typeof(self) weakSelf = self;
+    self.routeSubscription = [[MMRequestBroker sharedBroker] requestWithKey:key ttl:0 start:^dispatch_block_t(MMRequestCompletion completion) {
+        MRDirectionsRequest *request = [MRDirectionsRequest new];
+        request.app = appKey;
+        request.source = [MRDirectionsSource sourceWithCurrentLocation];
+        request.destination = [MRDirectionsDestination destinationWithPlacemarkKey:targetPlacemark.key];
+        MRDirections *directions = [[MRDirections alloc] initWithRequest:request presentingViewController:nil];
+        directions.showsLoadingHUD = NO;
+        [directions calculateDirectionsWithCompletionHandler:^(MRDirectionsResponse *response, NSError *error) {
+            completion(response, error);
+        }];
+        return ^{
+            [directions cancel];
+        };
+    } completion:^(MRDirectionsResponse *response, NSError *error) {
+        typeof(self) strongSelf = weakSelf;
+        if (!strongSelf) {
             return;
         }
+        strongSelf.routeSubscription = nil;
+        MRRoute *route = response.routes.firstObject;
+        if (route && [strongSelf shouldSendEvent:MMMapViewEventDirectionsRequestComplete
+                                          handler:strongSelf.onDirectionsRequestComplete]) {
+            strongSelf.onDirectionsRequestComplete(@{});
+        } else if (!route && [strongSelf shouldSendEvent:MMMapViewEventDirectionsRequestError
+                                                 handler:strongSelf.onDirectionsRequestError]) {
+            strongSelf.onDirectionsRequestError(@{@"error": error.localizedDescription ?: @"No route found"});
+        }
+        if (!route) {
+            // Let the SDK's own flow handle it; it can ask the user for a start point.
+            // The route is done when mapViewController:routeDidChange: reports one.
+            NSLog(@"[MeridianMapView] Shared directions failed (%@), falling back to the map's directions flow",
+                  error.localizedDescription ?: @"no route");
+            strongSelf.routeAwaitingDisplay = YES;
+            [strongSelf hideLoading];
+            [strongSelf.mapViewController startDirectionsToPlacemark:targetPlacemark];
+            [strongSelf failRouteGeneration:generation
+                                 afterDelay:MMRouteFallbackTimeout
+                                       code:MMRouteErrorTimedOut
+                                description:@"No route was shown by the directions flow"];
+            return;
+        }
+        [strongSelf endRoutePhase:@"routeCalcMs"];
+        [strongSelf.mapViewController.mapView setRoute:route animated:YES];
+        [strongSelf finishRouteWithError:nil];
+    }];
+}
 
-        NSArray<MRPlacemark *> *allPlacemarks = [response getPlacemarks];
-        NSLog(@"[MeridianMapView] === FOUND %ld PLACEMARKS ACROSS ALL FLOORS ===", (long)allPlacemarks.count);
+#pragma mark - Events
 
-        // Group by floor for better organization
-        NSMutableDictionary *placemarksByFloor = [NSMutableDictionary dictionary];
+// Whether to raise an event: JS must have a handler and must not have masked it out.
+// Payloads are only built after this returns YES.
+- (BOOL)shouldSendEvent:(MMMapViewEvent)event handler:(RCTDirectEventBlock)handler {
+    if (!handler || !(self.eventMask & (1 << event))) {
+        MMEventsSuppressed[event]++;
+        return NO;
+    }
+    MMEventsDispatched[event]++;
+    return YES;
+}
 
-        for (MRPlacemark *placemark in allPlacemarks) {
-            NSString *floorID = placemark.key.parent.identifier ?: @"Unknown Floor";
++ (NSDictionary *)eventStats {
+    uint64_t dispatched = 0;
+    uint64_t suppressed = 0;
+    NSMutableDictionary *byEvent = [NSMutableDictionary dictionaryWithCapacity:MMMapViewEventCount];
+    for (NSUInteger event = 0; event < MMMapViewEventCount; event++) {
+        dispatched += MMEventsDispatched[event];
+        suppressed += MMEventsSuppressed[event];
+        byEvent[MMMapViewEventNames[event]] = @{
+            @"dispatched": @(MMEventsDispatched[event]),
+            @"suppressed": @(MMEventsSuppressed[event])
+        };
+    }
+    return @{@"dispatched": @(dispatched), @"suppressed": @(suppressed), @"byEvent": byEvent};
+}
 
-            if (!placemarksByFloor[floorID]) {
-                placemarksByFloor[floorID] = [NSMutableArray array];
-            }
-            [placemarksByFloor[floorID] addObject:placemark];
-        }
+#pragma mark - Route start state
 
-        // Log organized by floor
-        for (NSString *floorID in placemarksByFloor.allKeys) {
-            NSArray *floorPlacemarks = placemarksByFloor[floorID];
-            NSLog(@"[MeridianMapView] --- FLOOR %@ (%ld placemarks) ---", floorID, (long)floorPlacemarks.count);
-
-            for (NSInteger i = 0; i < floorPlacemarks.count; i++) {
-                MRPlacemark *placemark = floorPlacemarks[i];
-                NSLog(@"[MeridianMapView]   %ld. ID: %@", (long)(i + 1), placemark.key.identifier);
-                NSLog(@"[MeridianMapView]      Name: %@", placemark.name ?: @"(no name)");
-                NSLog(@"[MeridianMapView]      Type: %@", placemark.type ?: @"(no type)");
-                NSLog(@"[MeridianMapView]      Floor: %@", placemark.key.parent.identifier ?: @"(no parent)");
-                NSLog(@"[MeridianMapView]      ---");
-            }
+- (NSError *)routeErrorWithCode:(MMRouteError)code description:(NSString *)description {
+    return [NSError errorWithDomain:MMRouteErrorDomain code:code userInfo:@{NSLocalizedDescriptionKey: description}];
+}
+
+- (void)endRoutePhase:(NSString *)phase {
+    CFTimeInterval now = CACurrentMediaTime();
+    self.routeTimings[phase] = @((now - self.routePhaseStartTime) * 1000.0);
+    self.routePhaseStartTime = now;
+}
+
+// Watchdog for steps that wait on SDK callbacks which may never come; the normal path does not wait on it
+- (void)failRouteGeneration:(NSUInteger)generation
+                 afterDelay:(NSTimeInterval)delay
+                       code:(MMRouteError)code
+                description:(NSString *)description {
+    __weak typeof(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        typeof(self) strongSelf = weakSelf;
+        if (strongSelf && strongSelf.routeGeneration == generation && strongSelf.routeTimings) {
+            [strongSelf finishRouteWithError:[strongSelf routeErrorWithCode:code description:description]];
         }
+    });
+}
 
-        NSLog(@"[MeridianMapView] === END ALL FLOORS SEARCH ===");
-        completion(allPlacemarks, nil);
+- (void)finishRouteWithError:(NSError *)error {
+    if (!self.routeTimings) {
+        return;
+    }
+    MMRouteCompletion completion = self.routeCompletion;
+    NSMutableDictionary *timings = self.routeTimings;
+    timings[@"totalMs"] = @((CACurrentMediaTime() - self.routeStartTime) * 1000.0);
+
+    self.routeCompletion = nil;
+    self.routeTimings = nil;
+    self.routeAwaitedFloor = nil;
+    self.routeAwaitingDisplay = NO;
+    self.routeTarget = nil;
+    if (error) {
+        // Bump the generation so late callbacks of the abandoned start are ignored
+        self.routeGeneration++;
+        [self.routeSubscription cancel];
+        self.routeSubscription = nil;
+    }
+    [self hideLoading];
+
+    if (error) {
+        NSLog(@"[MeridianMapView] Route start failed: %@", error.localizedDescription);
+    } else {
+        NSLog(@"[MeridianMapView] Route shown: %@", timings);
+    }
+    if (completion) {
+        completion(error ? nil : [timings copy], error);
+    }
+}
+
+#pragma mark - Floor preview
+
+// Large floors take a while for the SDK to draw; their tiles come up first,
+// from the SVG an earlier visit left in the asset cache
+- (void)showFloorPreviewForMap:(MRMap *)map {
+    [self hideFloorPreview];
+    NSString *mapId = map.key.identifier;
+    NSData *svg = map.svgURL ? [[MMAssetCache sharedCache] dataForURL:map.svgURL contentType:nil] : nil;
+    // The snapshot already shows the floor, as the user left it
+    if (!self.tiledFloorPreview || !mapId || !svg || self.viewportSnapshotView) {
+        return;
+    }
+    self.floorPreviewMapId = mapId;
+    __weak typeof(self) weakSelf = self;
+    [MMTiledFloorView loadWithSVGData:svg frame:self.bounds completion:^(MMTiledFloorView *view) {
+        typeof(self) strongSelf = weakSelf;
+        // The floor finished loading or another one started while it parsed
+        if (!strongSelf || !view || ![strongSelf.floorPreviewMapId isEqualToString:mapId]) {
+            return;
+        }
+        strongSelf.floorPreview = view;
+        if (strongSelf.loadingOverlay) {
+            [strongSelf insertSubview:view belowSubview:strongSelf.loadingOverlay];
+        } else {
+            [strongSelf addSubview:view];
+        }
     }];
 }
 
+- (void)hideFloorPreview {
+    self.floorPreviewMapId = nil;
+    MMTiledFloorView *preview = self.floorPreview;
+    if (!preview) {
+        return;
+    }
+    self.floorPreview = nil;
+    NSLog(@"[MeridianMapView] Floor preview tiles: %@", [preview stats]);
+    [UIView animateWithDuration:0.2
+        animations:^{
+            preview.alpha = 0;
+        }
+        completion:^(BOOL finished) {
+            [preview removeFromSuperview];
+        }];
+}
+
+#pragma mark - Viewport snapshot
+
+- (void)captureViewportSnapshot {
+    CustomMapViewController *controller = (CustomMapViewController *)self.mapViewController;
+    if (!self.viewportSnapshot || !self.window || !controller.isMapLoaded || self.viewportSnapshotView) {
+        return;
+    }
+    [MMViewportSnapshot captureMapView:controller.mapView app:self.appId];
+}
+
+// Covers the map while a new controller loads; it has not drawn anything yet
+- (void)showViewportSnapshot {
+    if (!self.viewportSnapshot) {
+        return;
+    }
+    MMViewportSnapshot *snapshot = [MMViewportSnapshot snapshotForApp:self.appId map:self.mapId];
+    if (!snapshot) {
+        return;
+    }
+    UIImageView *view = [[UIImageView alloc] initWithImage:snapshot.image];
+    view.frame = self.bounds;
+    view.contentMode = UIViewContentModeScaleAspectFill;
+    view.clipsToBounds = YES;
+    view.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
+    self.viewportSnapshotShown = snapshot;
+    self.viewportSnapshotView = view;
+    if (self.loadingOverlay) {
+        [self insertSubview:view belowSubview:self.loadingOverlay];
+    } else {
+        [self addSubview:view];
+    }
+    NSLog(@"[MeridianMapView] Showing the viewport snapshot of %@", snapshot.mapId);
+}
+
+// Puts the loaded floor where the snapshot left it, then fades the snapshot out over it
+- (void)revealMapFromViewportSnapshot:(CustomMapViewController *)controller {
+    MMViewportSnapshot *snapshot = self.viewportSnapshotShown;
+    if (!snapshot) {
+        return;
+    }
+    if ([controller.mapView.mapKey.identifier isEqualToString:snapshot.mapId] && !self.routeAwaitedFloor) {
+        [controller.mapView setVisibleMapRect:snapshot.visibleMapRect
+                                rotationAngle:snapshot.rotationAngle
+                                     animated:NO
+                                   completion:nil];
+    }
+    [self hideViewportSnapshotAnimated:YES];
+}
+
+- (void)hideViewportSnapshotAnimated:(BOOL)animated {
+    UIImageView *view = self.viewportSnapshotView;
+    self.viewportSnapshotShown = nil;
+    self.viewportSnapshotView = nil;
+    if (!animated) {
+        [view removeFromSuperview];
+        return;
+    }
+    [UIView animateWithDuration:0.25
+        animations:^{
+            view.alpha = 0;
+        }
+        completion:^(BOOL finished) {
+            [view removeFromSuperview];
+        }];
+}
+
+#pragma mark - CustomMapViewControllerDelegate
+
+- (void)mapViewControllerWillStartLoadingMap:(CustomMapViewController *)controller {
+    // The floor's SVG and image load after this; from here they are kept on disk
+    if (controller.mapView.map) {
+        [[MMAssetCache sharedCache] registerMap:controller.mapView.map];
+        [self showFloorPreviewForMap:controller.mapView.map];
+    }
+    if ([self shouldSendEvent:MMMapViewEventMapLoadStart handler:self.onMapLoadStart]) {
+        self.onMapLoadStart(@{});
+    }
+}
+
+- (void)mapViewControllerDidFinishLoadingMap:(CustomMapViewController *)controller {
+    [self hideFloorPreview];
+    [self revealMapFromViewportSnapshot:controller];
+    if (!self.firstRenderRecorded) {
+        self.firstRenderRecorded = YES;
+        [[MMSession sharedSession] recordFirstRenderMs:(CACurrentMediaTime() - self.createdTime) * 1000.0
+                                             prewarmed:self.createdPrewarmed];
+    }
+    if ([self shouldSendEvent:MMMapViewEventMapLoadFinish handler:self.onMapLoadFinish]) {
+        self.onMapLoadFinish(@{});
+    }
+    // With this floor on screen, the floors above and below download behind it
+    if (controller.mapView.map) {
+        [[MMFloorPrefetcher sharedPrefetcher] prefetchAroundMap:controller.mapView.map];
+    }
+    NSString *loadedFloor = controller.mapView.mapKey.identifier;
+    if (!self.routeAwaitedFloor || ![self.routeAwaitedFloor isEqualToString:loadedFloor]) {
+        return;
+    }
+    NSLog(@"[MeridianMapView] Floor %@ loaded, starting directions to placemark", loadedFloor);
+    self.routeAwaitedFloor = nil;
+    [self endRoutePhase:@"floorLoadMs"];
+    [self requestDirectionsToPlacemark:self.routeTarget];
+}
+
+// A pooled map arrives loaded, so this view sees its placemarks and load finish without a load
+- (void)mapViewControllerDidReuseLoadedMap:(CustomMapViewController *)controller {
+    if (controller != self.mapViewController) {
+        return;
+    }
+    [self.geofenceEngine resolvePlacemarks:[self shownPlacemarks]];
+    [self mapViewControllerDidFinishLoadingMap:controller];
+}
+
+- (void)mapViewController:(CustomMapViewController *)controller didFailLoadingMapWithError:(NSError *)error {
+    [self hideFloorPreview];
+    [self hideViewportSnapshotAnimated:NO];
+    if ([self shouldSendEvent:MMMapViewEventMapLoadFail handler:self.onMapLoadFail]) {
+        self.onMapLoadFail(@{
+            @"error": error.localizedDescription ?: @"The map failed to load",
+            @"code": @(error.code),
+            @"domain": error.domain ?: @"Unknown"
+        });
+    }
+    if (!self.routeAwaitedFloor) {
+        return;
+    }
+    [self finishRouteWithError:error ?: [self routeErrorWithCode:MMRouteErrorFloorLoadFailed
+                                                    description:@"The destination floor failed to load"]];
+}
+
+- (void)mapViewController:(CustomMapViewController *)controller didLoadPlacemarks:(NSArray<MRPlacemark *> *)placemarks {
+    [[MMAssetCache sharedCache] registerPlacemarks:placemarks];
+    [self.geofenceEngine resolvePlacemarks:placemarks];
+}
+
+- (void)mapViewController:(CustomMapViewController *)controller routeDidChange:(MRRoute *)route {
+    // Each floor switch along the route then renders from the disk cache
+    if (route) {
+        [[MMFloorPrefetcher sharedPrefetcher] prefetchRoute:route];
+    }
+    if (!self.routeAwaitingDisplay || !route) {
+        return;
+    }
+    [self endRoutePhase:@"routeCalcMs"];
+    [self finishRouteWithError:nil];
+}
+
+- (void)mapViewController:(CustomMapViewController *)controller willScrollToStepAtIndex:(NSUInteger)index {
+    if ([self shouldSendEvent:MMMapViewEventRouteStepIndexChange handler:self.onRouteStepIndexChange]) {
+        self.onRouteStepIndexChange(@{@"index": @(index)});
+    }
+}
+
+- (void)mapViewControllerVisibleMapRectDidChange:(CustomMapViewController *)controller {
+    if ([self shouldSendEvent:MMMapViewEventMapTransformChange handler:self.onMapTransformChange]) {
+        self.onMapTransformChange(@{});
+    }
+}
+
+- (void)mapViewControllerDidChangeUseAccessiblePaths:(CustomMapViewController *)controller {
+    if ([self shouldSendEvent:MMMapViewEventUseAccessiblePathsChange handler:self.onUseAccessiblePathsChange]) {
+        self.onUseAccessiblePathsChange(@{});
+    }
+}
+
+- (void)mapViewController:(CustomMapViewController *)controller didSelectPlacemark:(MRPlacemark *)placemark {
+    if ([self shouldSendEvent:MMMapViewEventMarkerSelect handler:self.onMarkerSelect]) {
+        NSString *placemarkID = placemark.key.identifier ?: @"";
+        self.onMarkerSelect(@{
+            @"markerId": placemarkID,
+            @"placemarkId": placemarkID,
+            @"name": placemark.name ?: @""
+        });
+    }
+}
+
+- (void)mapViewControllerDidDeselectAnnotation:(CustomMapViewController *)controller {
+    if ([self shouldSendEvent:MMMapViewEventMarkerDeselect handler:self.onMarkerDeselect]) {
+        self.onMarkerDeselect(@{});
+    }
+}
+
 - (UIViewController *)findRootViewController {
     // Get the key window
     UIWindow *window = nil;
@@ -635,6 +1140,12 @@ RCT_EXPORT_VIEW_PROPERTY(appId, NSString)
 RCT_EXPORT_VIEW_PROPERTY(appToken, NSString)
 RCT_EXPORT_VIEW_PROPERTY(mapId, NSString)
 RCT_EXPORT_VIEW_PROPERTY(showLocationUpdates, BOOL)
+RCT_EXPORT_VIEW_PROPERTY(eventMask, NSInteger)
+RCT_EXPORT_VIEW_PROPERTY(locationUpdateOptions, NSDictionary)
+RCT_EXPORT_VIEW_PROPERTY(locationHistoryBytes, NSInteger)
+RCT_EXPORT_VIEW_PROPERTY(locationDutyCycle, NSDictionary)
+RCT_EXPORT_VIEW_PROPERTY(tiledFloorPreview, BOOL)
+RCT_EXPORT_VIEW_PROPERTY(viewportSnapshot, BOOL)
 
 - (UIView *)view {
   MeridianMapContainerView *containerView =
@@ -646,7 +1157,26 @@ RCT_EXPORT_VIEW_PROPERTY(showLocationUpdates, BOOL)
 RCT_EXPORT_VIEW_PROPERTY(onMapLoadStart, RCTDirectEventBlock)
 RCT_EXPORT_VIEW_PROPERTY(onMapLoadFinish, RCTDirectEventBlock)
 RCT_EXPORT_VIEW_PROPERTY(onMapLoadFail, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onMapRenderFinish, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onMapTransformChange, RCTDirectEventBlock)
 RCT_EXPORT_VIEW_PROPERTY(onLocationUpdated, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onOrientationUpdated, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onMarkerSelect, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onMarkerDeselect, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onCalloutClick, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onSearchActivityStarted, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onDirectionsReroute, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onDirectionsClick, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onDirectionsStart, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onRouteStepIndexChange, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onDirectionsClosed, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onDirectionsError, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onUseAccessiblePathsChange, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onDirectionsCalculated, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onDirectionsRequestComplete, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onDirectionsRequestError, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onDirectionsRequestCanceled, RCTDirectEventBlock)
+RCT_EXPORT_VIEW_PROPERTY(onGeofenceTransition, RCTDirectEventBlock)
 
 
 /**
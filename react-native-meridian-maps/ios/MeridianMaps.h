@@ -0,0 +1,5 @@
+#import <React/RCTBridgeModule.h>
+
+@interface MeridianMaps : NSObject <RCTBridgeModule>
+
+@end
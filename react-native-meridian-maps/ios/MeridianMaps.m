@@ -0,0 +1,594 @@
+#import "MeridianMaps.h"
+#import "MeridianMapViewManager.h"
+#import "MMAssetCache.h"
+#import "MMFloorPrefetcher.h"
+#import "MMAssetBundle.h"
+#import "MMLocationThrottle.h"
+#import "MMLocationTrace.h"
+#import "MMMapPool.h"
+#import "MMPlacemarkIndex.h"
+#import "MMPlacemarkLoader.h"
+#import "MMRequestBroker.h"
+#import "MMSession.h"
+#import "MMTiledFloorView.h"
+#import "MMVenueRegistry.h"
+#import "MMViewportSnapshot.h"
+#import <Meridian/Meridian.h>
+#import <QuartzCore/QuartzCore.h>
+#import <React/RCTLog.h>
+#import <React/RCTUIManager.h>
+
+static NSDictionary *MMDictionaryForPlacemark(MRPlacemark *placemark) {
+    return @{
+        @"id": placemark.key.identifier ?: @"",
+        @"mapId": placemark.key.parent.identifier ?: @"",
+        @"name": placemark.name ?: @"",
+        @"type": placemark.type ?: @"",
+        @"typeName": placemark.typeName ?: @"",
+        @"x": @(placemark.point.x),
+        @"y": @(placemark.point.y)
+    };
+}
+
+// Pages buffered before the loader pauses; requests in flight may add up to
+// maxConcurrentFloors more
+static const NSUInteger MMPlacemarkStreamMaxBufferedPages = 4;
+
+/**
+ * Buffers pages from an MMPlacemarkLoader until JS pulls them with nextPlacemarkPage.
+ * A full buffer pauses the loader and pulling resumes it, so a consumer that
+ * stops iterating holds a few pages, not the whole venue.
+ */
+@interface MMPlacemarkStream : NSObject
+@property (nonatomic, strong) MMPlacemarkLoader *loader;
+@property (nonatomic, strong) NSMutableArray<NSDictionary *> *pages;
+@property (nonatomic, assign) BOOL finished;
+@property (nonatomic, strong) NSError *error;
+@property (nonatomic, copy) RCTPromiseResolveBlock pendingResolve;
+@property (nonatomic, copy) RCTPromiseRejectBlock pendingReject;
+@end
+
+@implementation MMPlacemarkStream
+
+- (instancetype)initWithLoader:(MMPlacemarkLoader *)loader {
+    if ((self = [super init])) {
+        _loader = loader;
+        _pages = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)start {
+    __weak typeof(self) weakSelf = self;
+    [self.loader startWithPageHandler:^(NSArray<MRPlacemark *> *placemarks, MREditorKey *mapKey) {
+        NSMutableArray *serialized = [NSMutableArray arrayWithCapacity:placemarks.count];
+        for (MRPlacemark *placemark in placemarks) {
+            [serialized addObject:MMDictionaryForPlacemark(placemark)];
+        }
+        [weakSelf.pages addObject:@{@"done": @NO, @"mapId": mapKey.identifier ?: @"", @"placemarks": serialized}];
+        [weakSelf flush];
+        if (weakSelf.pages.count >= MMPlacemarkStreamMaxBufferedPages) {
+            weakSelf.loader.paused = YES;
+        }
+    } completion:^(NSError *error) {
+        weakSelf.finished = YES;
+        weakSelf.error = weakSelf.loader.cancelled ? nil : error;
+        [weakSelf flush];
+    }];
+}
+
+- (void)pullWithResolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject {
+    if (self.pendingResolve) {
+        reject(@"STREAM_BUSY", @"nextPlacemarkPage called before the previous page resolved", nil);
+        return;
+    }
+    self.pendingResolve = resolve;
+    self.pendingReject = reject;
+    [self flush];
+}
+
+- (void)flush {
+    if (!self.pendingResolve) {
+        return;
+    }
+    RCTPromiseResolveBlock resolve = self.pendingResolve;
+    RCTPromiseRejectBlock reject = self.pendingReject;
+
+    if (self.pages.count > 0) {
+        NSDictionary *page = self.pages.firstObject;
+        [self.pages removeObjectAtIndex:0];
+        self.pendingResolve = nil;
+        self.pendingReject = nil;
+        resolve(page);
+        if (self.pages.count < MMPlacemarkStreamMaxBufferedPages) {
+            self.loader.paused = NO;
+        }
+    } else if (self.finished) {
+        self.pendingResolve = nil;
+        self.pendingReject = nil;
+        // Floors that loaded are still delivered; the error only surfaces when nothing did
+        if (self.error) {
+            reject(@"PLACEMARK_LOAD_ERROR", self.error.localizedDescription, self.error);
+        } else {
+            resolve(@{@"done": @YES});
+        }
+    }
+}
+
+- (void)close {
+    [self.loader cancel];
+    [self.pages removeAllObjects];
+    [self flush];
+}
+
+@end
+
+@interface MeridianMaps ()
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, MMPlacemarkStream *> *placemarkStreams;
+@property (nonatomic, assign) NSInteger nextStreamId;
+@end
+
+@implementation MeridianMaps
+
+RCT_EXPORT_MODULE(MeridianMaps)
+
+@synthesize bridge = _bridge;
+
++ (BOOL)requiresMainQueueSetup {
+    return YES;
+}
+
+- (dispatch_queue_t)methodQueue {
+    // The Meridian SDK request APIs are driven from the main queue
+    return dispatch_get_main_queue();
+}
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        _placemarkStreams = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (void)invalidate {
+    for (MMPlacemarkStream *stream in self.placemarkStreams.allValues) {
+        [stream close];
+    }
+    [self.placemarkStreams removeAllObjects];
+}
+
+#pragma mark - Session
+
+RCT_EXPORT_METHOD(prewarm:(NSDictionary *)options
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    NSString *appId = [options[@"appId"] isKindOfClass:[NSString class]] ? options[@"appId"] : nil;
+    NSString *mapId = [options[@"mapId"] isKindOfClass:[NSString class]] ? options[@"mapId"] : nil;
+    NSString *token = [options[@"token"] isKindOfClass:[NSString class]] ? options[@"token"] : nil;
+    if (appId.length == 0 || mapId.length == 0 || token.length == 0) {
+        reject(@"INVALID_ARGUMENT", @"appId, mapId and token are required", nil);
+        return;
+    }
+    NSString *regionName = [options[@"region"] isKindOfClass:[NSString class]] ? options[@"region"] : nil;
+    MRDomainRegion region;
+    if (![MMSession region:&region fromString:regionName]) {
+        reject(@"INVALID_ARGUMENT", [NSString stringWithFormat:@"Unknown region %@", regionName], nil);
+        return;
+    }
+
+    [[MMSession sharedSession] prewarmApp:appId map:mapId token:token region:region
+                               completion:^(NSDictionary *timings, NSError *error) {
+        if (!timings) {
+            reject(@"PREWARM_ERROR", error.localizedDescription, error);
+            return;
+        }
+        resolve(timings);
+    }];
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(getStartupStats)
+{
+    return [[MMSession sharedSession] stats];
+}
+
+#pragma mark - Venues
+
+RCT_EXPORT_METHOD(setVenueOptions:(NSDictionary *)options)
+{
+    id maxWarmVenues = options[@"maxWarmVenues"];
+    if ([maxWarmVenues isKindOfClass:[NSNumber class]] && [maxWarmVenues integerValue] >= 1) {
+        [[MMSession sharedSession] setMaxWarmVenues:[maxWarmVenues unsignedIntegerValue]];
+    }
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(getVenueStats)
+{
+    return [[MMVenueRegistry sharedRegistry] stats];
+}
+
+#pragma mark - Map pool
+
+RCT_EXPORT_METHOD(setMapPoolOptions:(NSDictionary *)options)
+{
+    id maxSize = options[@"maxSize"];
+    if ([maxSize isKindOfClass:[NSNumber class]] && [maxSize integerValue] >= 0) {
+        [MMMapPool sharedPool].maxSize = [maxSize unsignedIntegerValue];
+    }
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(getMapPoolStats)
+{
+    return [[MMMapPool sharedPool] stats];
+}
+
+#pragma mark - Placemark streaming
+
+RCT_EXPORT_METHOD(openPlacemarkStream:(NSString *)appId
+                  options:(NSDictionary *)options
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    if (appId.length == 0) {
+        reject(@"INVALID_ARGUMENT", @"appId is required", nil);
+        return;
+    }
+
+    MMPlacemarkLoader *loader = [[MMPlacemarkLoader alloc] initWithAppId:appId];
+    NSNumber *maxConcurrentFloors = options[@"maxConcurrentFloors"];
+    if ([maxConcurrentFloors isKindOfClass:[NSNumber class]] && maxConcurrentFloors.integerValue > 0) {
+        loader.maxConcurrentFloors = maxConcurrentFloors.unsignedIntegerValue;
+    }
+    NSArray *mapIds = options[@"mapIds"];
+    if ([mapIds isKindOfClass:[NSArray class]] && mapIds.count > 0) {
+        loader.mapIds = mapIds;
+    }
+
+    NSNumber *streamId = @(++self.nextStreamId);
+    MMPlacemarkStream *stream = [[MMPlacemarkStream alloc] initWithLoader:loader];
+    self.placemarkStreams[streamId] = stream;
+    [stream start];
+    resolve(streamId);
+}
+
+RCT_EXPORT_METHOD(nextPlacemarkPage:(nonnull NSNumber *)streamId
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    MMPlacemarkStream *stream = self.placemarkStreams[streamId];
+    if (!stream) {
+        resolve(@{@"done": @YES});
+        return;
+    }
+
+    [stream pullWithResolver:^(id result) {
+        if ([result[@"done"] boolValue]) {
+            [self.placemarkStreams removeObjectForKey:streamId];
+        }
+        resolve(result);
+    } rejecter:^(NSString *code, NSString *message, NSError *error) {
+        [self.placemarkStreams removeObjectForKey:streamId];
+        reject(code, message, error);
+    }];
+}
+
+RCT_EXPORT_METHOD(closePlacemarkStream:(nonnull NSNumber *)streamId)
+{
+    MMPlacemarkStream *stream = self.placemarkStreams[streamId];
+    [self.placemarkStreams removeObjectForKey:streamId];
+    [stream close];
+}
+
+#pragma mark - Spatial queries
+
+RCT_EXPORT_METHOD(queryPlacemarks:(NSString *)appId
+                  queries:(NSArray<NSDictionary *> *)queries
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    if (appId.length == 0) {
+        reject(@"INVALID_ARGUMENT", @"appId is required", nil);
+        return;
+    }
+
+    [[MMPlacemarkIndex indexForApp:appId] queryPlacemarks:queries completion:^(NSArray *results, NSError *error) {
+        if (!results) {
+            reject(@"INVALID_QUERY", error.localizedDescription, error);
+            return;
+        }
+        resolve(results);
+    }];
+}
+
+#pragma mark - Sync
+
+RCT_EXPORT_METHOD(syncPlacemarks:(NSString *)appId
+                  options:(NSDictionary *)options
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    NSString *urlString = options[@"url"];
+    NSURL *url = [urlString isKindOfClass:[NSString class]] ? [NSURL URLWithString:urlString] : nil;
+    if (appId.length == 0 || !url) {
+        reject(@"INVALID_ARGUMENT", @"appId and options.url are required", nil);
+        return;
+    }
+    NSArray *mapIds = [options[@"mapIds"] isKindOfClass:[NSArray class]] ? options[@"mapIds"] : nil;
+    NSDictionary *headers = [options[@"headers"] isKindOfClass:[NSDictionary class]] ? options[@"headers"] : nil;
+    NSNumber *pageSize = [options[@"pageSize"] isKindOfClass:[NSNumber class]] ? options[@"pageSize"] : nil;
+
+    [[MMPlacemarkIndex indexForApp:appId] syncFromURL:url
+                                               mapIds:mapIds
+                                             pageSize:MAX(pageSize.integerValue, 0)
+                                              headers:headers
+                                           completion:^(NSDictionary *stats, NSError *error) {
+        if (!stats) {
+            reject(@"SYNC_ERROR", error.localizedDescription, error);
+            return;
+        }
+        resolve(stats);
+    }];
+}
+
+#pragma mark - Asset bundles
+
+RCT_EXPORT_METHOD(loadAssetBundle:(NSString *)path
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    // A relative path names a resource shipped in the app bundle
+    NSString *resolved = path.isAbsolutePath ? path : [[NSBundle mainBundle] pathForResource:path ofType:nil];
+    if (path.length == 0 || !resolved) {
+        reject(@"INVALID_ARGUMENT", [NSString stringWithFormat:@"No asset bundle at %@", path], nil);
+        return;
+    }
+    NSError *error = nil;
+    MMAssetBundle *bundle = [MMAssetBundle bundleWithPath:resolved error:&error];
+    if (!bundle) {
+        reject(@"BUNDLE_ERROR", error.localizedDescription, error);
+        return;
+    }
+    [MMAssetBundle setActiveBundle:bundle];
+
+    [[MMPlacemarkIndex indexForApp:bundle.appId] seedFromBundle:bundle completion:^(NSDictionary *stats, NSError *seedError) {
+        // Floors are served either way; the placemarks then come from the SDK as usual
+        if (seedError) {
+            NSLog(@"[MeridianMaps] Failed to seed placemarks from %@: %@", path, seedError.localizedDescription);
+        }
+        resolve(@{
+            @"appId": bundle.appId,
+            @"baseUrl": bundle.baseURL.absoluteString,
+            @"maps": @(bundle.mapIds.count),
+            @"assets": @(bundle.assetCount),
+            @"bytes": @(bundle.byteSize),
+            @"placemarksSeeded": stats[@"upserted"] ?: @0,
+        });
+    }];
+}
+
+RCT_EXPORT_METHOD(unloadAssetBundle)
+{
+    [MMAssetBundle setActiveBundle:nil];
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(getAssetBundleStats)
+{
+    MMAssetBundle *bundle = [MMAssetBundle activeBundle];
+    if (!bundle) {
+        return @{@"loaded": @NO, @"served": @0, @"bytesServed": @0, @"failures": @0};
+    }
+    NSMutableDictionary *stats = [[bundle stats] mutableCopy];
+    stats[@"loaded"] = @YES;
+    stats[@"appId"] = bundle.appId;
+    stats[@"assets"] = @(bundle.assetCount);
+    stats[@"bytes"] = @(bundle.byteSize);
+    return stats;
+}
+
+#pragma mark - Asset cache
+
+RCT_EXPORT_METHOD(setCacheOptions:(NSDictionary *)options)
+{
+    NSNumber *maxBytes = [options[@"maxBytes"] isKindOfClass:[NSNumber class]] ? options[@"maxBytes"] : nil;
+    if (maxBytes) {
+        [MMAssetCache sharedCache].maxBytes = MAX(maxBytes.longLongValue, 0);
+    }
+}
+
+RCT_EXPORT_METHOD(clearCache)
+{
+    [[MMAssetCache sharedCache] clear];
+    [MMTiledFloorView clearCache];
+    [MMViewportSnapshot clear];
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(getCacheStats)
+{
+    return [[MMAssetCache sharedCache] stats];
+}
+
+RCT_EXPORT_METHOD(cancelPrefetch)
+{
+    [[MMFloorPrefetcher sharedPrefetcher] cancel];
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(getPrefetchStats)
+{
+    return [[MMFloorPrefetcher sharedPrefetcher] stats];
+}
+
+#pragma mark - Search
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(searchPlacemarks:(NSString *)appId
+                                       query:(NSString *)query
+                                       limit:(nonnull NSNumber *)limit)
+{
+    // Synchronous so typeahead never waits on a bridge round trip; the index is local
+    if (appId.length == 0 || query.length == 0) {
+        return @[];
+    }
+    NSUInteger resultLimit = limit.integerValue > 0 ? limit.unsignedIntegerValue : 20;
+    return [[MMPlacemarkIndex indexForApp:appId] searchPlacemarks:query limit:resultLimit];
+}
+
+#pragma mark - Routing
+
+RCT_EXPORT_METHOD(startRoute:(nonnull NSNumber *)reactTag
+                  placemarkID:(NSString *)placemarkID
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    // methodQueue is the main queue, so the view can be resolved directly
+    UIView *view = [self.bridge.uiManager viewForReactTag:reactTag];
+    if (![view isKindOfClass:[MeridianMapContainerView class]]) {
+        reject(@"INVALID_ARGUMENT", [NSString stringWithFormat:@"No MeridianMapView with tag #%@", reactTag], nil);
+        return;
+    }
+    if (placemarkID.length == 0) {
+        reject(@"INVALID_ARGUMENT", @"placemarkID is required", nil);
+        return;
+    }
+    [(MeridianMapContainerView *)view startRouteToPlacemarkWithID:placemarkID completion:^(NSDictionary *timings, NSError *error) {
+        if (!timings) {
+            reject(@"ROUTE_ERROR", error.localizedDescription, error);
+            return;
+        }
+        resolve(timings);
+    }];
+}
+
+#pragma mark - Request broker
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(getRequestStats)
+{
+    return [[MMRequestBroker sharedBroker] stats];
+}
+
+#pragma mark - Map view events
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(getEventStats)
+{
+    return [MeridianMapContainerView eventStats];
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(getLocationUpdateStats)
+{
+    return [MMLocationThrottle totalStats];
+}
+
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(getLocationPowerStats)
+{
+    return [MeridianMapContainerView locationPowerStats];
+}
+
+#pragma mark - Location history
+
+RCT_EXPORT_METHOD(getLocationHistory:(nonnull NSNumber *)reactTag
+                  options:(NSDictionary *)options
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    UIView *view = [self.bridge.uiManager viewForReactTag:reactTag];
+    if (![view isKindOfClass:[MeridianMapContainerView class]]) {
+        reject(@"INVALID_ARGUMENT", [NSString stringWithFormat:@"No MeridianMapView with tag #%@", reactTag], nil);
+        return;
+    }
+    resolve([(MeridianMapContainerView *)view locationHistoryWithOptions:options]);
+}
+
+#pragma mark - Geofences
+
+RCT_EXPORT_METHOD(addGeofences:(nonnull NSNumber *)reactTag
+                  geofences:(NSArray *)geofences
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    UIView *view = [self.bridge.uiManager viewForReactTag:reactTag];
+    if (![view isKindOfClass:[MeridianMapContainerView class]]) {
+        reject(@"INVALID_ARGUMENT", [NSString stringWithFormat:@"No MeridianMapView with tag #%@", reactTag], nil);
+        return;
+    }
+    NSError *error = nil;
+    if (![(MeridianMapContainerView *)view addGeofences:geofences ?: @[] error:&error]) {
+        reject(@"INVALID_ARGUMENT", error.localizedDescription, error);
+        return;
+    }
+    resolve(nil);
+}
+
+RCT_EXPORT_METHOD(removeGeofences:(nonnull NSNumber *)reactTag
+                  ids:(NSArray *)ids
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    UIView *view = [self.bridge.uiManager viewForReactTag:reactTag];
+    if (![view isKindOfClass:[MeridianMapContainerView class]]) {
+        reject(@"INVALID_ARGUMENT", [NSString stringWithFormat:@"No MeridianMapView with tag #%@", reactTag], nil);
+        return;
+    }
+    [(MeridianMapContainerView *)view removeGeofencesWithIDs:ids];
+    resolve(nil);
+}
+
+#pragma mark - Location traces
+
+RCT_EXPORT_METHOD(startLocationRecording:(NSString *)path
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    if (path.length == 0) {
+        NSString *caches = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES).firstObject;
+        NSString *directory = [caches stringByAppendingPathComponent:@"location-traces"];
+        [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+        NSString *name = [NSString stringWithFormat:@"%lld.mmlt", (long long)([NSDate date].timeIntervalSince1970 * 1000)];
+        path = [directory stringByAppendingPathComponent:name];
+    }
+    NSError *error = nil;
+    if (![[MMLocationRecorder sharedRecorder] startWithPath:path error:&error]) {
+        reject(@"TRACE_ERROR", error.localizedDescription, error);
+        return;
+    }
+    resolve(path);
+}
+
+RCT_EXPORT_METHOD(stopLocationRecording:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    MMLocationRecorder *recorder = [MMLocationRecorder sharedRecorder];
+    NSString *path = recorder.path;
+    if (!recorder.isRecording || !path) {
+        reject(@"TRACE_ERROR", @"No location recording in progress", nil);
+        return;
+    }
+    const NSUInteger fixes = [recorder stop];
+    resolve(@{@"path": path, @"fixes": @(fixes)});
+}
+
+RCT_EXPORT_METHOD(replayLocationTrace:(NSString *)path
+                  speed:(double)speed
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    const CFTimeInterval start = CACurrentMediaTime();
+    NSError *error = nil;
+    BOOL started = [[MMLocationReplay sharedReplay] startWithPath:path
+                                                            speed:speed
+                                                       completion:^(NSUInteger fixes, BOOL finished) {
+        resolve(@{
+            @"fixes": @(fixes),
+            @"finished": @(finished),
+            @"durationMs": @((CACurrentMediaTime() - start) * 1000.0)
+        });
+    }
+                                                            error:&error];
+    if (!started) {
+        reject(@"TRACE_ERROR", error.localizedDescription, error);
+    }
+}
+
+RCT_EXPORT_METHOD(stopLocationReplay)
+{
+    [[MMLocationReplay sharedReplay] stop];
+}
+
+@end
@@ -0,0 +1,381 @@
+#!/usr/bin/env node
+/**
+ * Packs a venue's floors, placemarks and route data into an asset bundle
+ * (cpp/AssetBundle.h) that ships with the app, so the first floor renders
+ * without the network:
+ *
+ *   node scripts/pack-venue.js --url https://api.example.com/apps/APP_ID \
+ *     --app APP_ID --out ios/venue.mmab [--map MAP_ID ...] \
+ *     [--header "Authorization: Token ..."] [--asset URL ...]
+ *
+ * The endpoint is the placemark sync endpoint (cpp/PlacemarkSync.h). Every
+ * map in GET {url}/maps, or each --map, is packed with:
+ *   - its floor, from the map's "svg_url" or "image_url"
+ *   - every page of {url}/maps/{id}/placemarks?page_size=N, so loading the
+ *     bundle can seed the placemark index with an offline sync
+ *   - {url}/maps/{id}/routes, when the endpoint has one
+ * plus any --asset URL. Assets are keyed by the URL they were fetched from.
+ */
+'use strict';
+
+const fs = require('fs');
+const http = require('http');
+const https = require('https');
+const path = require('path');
+const zlib = require('zlib');
+
+const VERSION = 1;
+const ENDIAN_TAG = 0x01020304;
+const HEADER_SIZE = 32;
+const ENTRY_SIZE = 48;
+const COMPRESSED = 1;
+const MANIFEST_KEY = 'meridian:manifest';
+
+const CRC_TABLE = (() => {
+  const table = new Uint32Array(256);
+  for (let n = 0; n < 256; n++) {
+    let c = n;
+    for (let k = 0; k < 8; k++) {
+      c = c & 1 ? 0xedb88320 ^ (c >>> 1) : c >>> 1;
+    }
+    table[n] = c >>> 0;
+  }
+  return table;
+})();
+
+function crc32(bytes) {
+  let crc = 0xffffffff;
+  for (let i = 0; i < bytes.length; i++) {
+    crc = CRC_TABLE[(crc ^ bytes[i]) & 0xff] ^ (crc >>> 8);
+  }
+  return (crc ^ 0xffffffff) >>> 0;
+}
+
+// Same encoding as percentEncode in cpp/PlacemarkSync.cpp, so keys match the URLs a sync asks for
+function percentEncode(value) {
+  return Array.from(Buffer.from(String(value), 'utf8'))
+    .map((byte) => {
+      const c = String.fromCharCode(byte);
+      return /[A-Za-z0-9\-_.~]/.test(c)
+        ? c
+        : '%' + byte.toString(16).toUpperCase().padStart(2, '0');
+    })
+    .join('');
+}
+
+// Like PlacemarkSync::resolve: absolute URLs as is, path-absolute ones on the base's origin
+function resolve(baseUrl, url) {
+  if (/^https?:\/\//.test(url)) {
+    return url;
+  }
+  if (url.startsWith('/')) {
+    return new URL(baseUrl).origin + url;
+  }
+  return baseUrl + '/' + url;
+}
+
+function parseArgs(argv) {
+  const options = {
+    url: null,
+    app: null,
+    out: null,
+    maps: [],
+    assets: [],
+    headers: {},
+    pageSize: 500,
+    concurrency: 4,
+  };
+  for (let i = 0; i < argv.length; i++) {
+    const value = argv[i + 1];
+    switch (argv[i]) {
+      case '--url':
+        options.url = value.replace(/\/+$/, '');
+        break;
+      case '--app':
+        options.app = value;
+        break;
+      case '--out':
+        options.out = value;
+        break;
+      case '--map':
+        options.maps.push(value);
+        break;
+      case '--asset':
+        options.assets.push(value);
+        break;
+      case '--header': {
+        const colon = value.indexOf(':');
+        if (colon <= 0) {
+          throw new Error(`--header expects "Name: value", got "${value}"`);
+        }
+        options.headers[value.slice(0, colon).trim()] = value
+          .slice(colon + 1)
+          .trim();
+        break;
+      }
+      case '--page-size':
+        options.pageSize = parseInt(value, 10);
+        break;
+      case '--concurrency':
+        options.concurrency = parseInt(value, 10);
+        break;
+      default:
+        throw new Error(`Unknown argument ${argv[i]}`);
+    }
+    i++;
+  }
+  if (!options.url || !options.app || !options.out) {
+    throw new Error('--url, --app and --out are required');
+  }
+  if (!(options.pageSize > 0) || !(options.concurrency > 0)) {
+    throw new Error('--page-size and --concurrency must be positive');
+  }
+  return options;
+}
+
+function get(url, headers, redirects = 5) {
+  return new Promise((resolvePromise, reject) => {
+    const client = url.startsWith('https:') ? https : http;
+    const request = client.get(url, { headers }, (response) => {
+      const { statusCode, headers: responseHeaders } = response;
+      if (
+        statusCode >= 300 &&
+        statusCode < 400 &&
+        responseHeaders.location &&
+        redirects > 0
+      ) {
+        response.resume();
+        resolvePromise(
+          get(
+            new URL(responseHeaders.location, url).toString(),
+            headers,
+            redirects - 1
+          )
+        );
+        return;
+      }
+      const chunks = [];
+      response.on('data', (chunk) => chunks.push(chunk));
+      response.on('end', () =>
+        resolvePromise({
+          status: statusCode,
+          contentType: responseHeaders['content-type'] || '',
+          body: Buffer.concat(chunks),
+        })
+      );
+      response.on('error', reject);
+    });
+    request.setTimeout(60000, () =>
+      request.destroy(new Error(`Timed out fetching ${url}`))
+    );
+    request.on('error', reject);
+  });
+}
+
+const CONTENT_TYPES = {
+  '.svg': 'image/svg+xml',
+  '.png': 'image/png',
+  '.jpg': 'image/jpeg',
+  '.jpeg': 'image/jpeg',
+  '.json': 'application/json',
+};
+
+function contentTypeFor(url, reported) {
+  const extension = path.extname(new URL(url).pathname).toLowerCase();
+  return CONTENT_TYPES[extension] || reported || 'application/octet-stream';
+}
+
+class Packer {
+  constructor(options) {
+    this.options = options;
+    this.assets = new Map();
+    this.bytesFetched = 0;
+  }
+
+  async fetch(url, { optional = false } = {}) {
+    const response = await get(url, this.options.headers);
+    this.bytesFetched += response.body.length;
+    if (response.status === 404 && optional) {
+      return null;
+    }
+    if (response.status !== 200) {
+      throw new Error(`GET ${url} answered ${response.status}`);
+    }
+    return response;
+  }
+
+  async add(url, options) {
+    const response = await this.fetch(url, options);
+    if (response) {
+      this.assets.set(url, {
+        contentType: contentTypeFor(url, response.contentType),
+        bytes: response.body,
+      });
+    }
+    return response;
+  }
+
+  async packMap(map) {
+    const { url, pageSize } = this.options;
+    const mapId = String(map.id);
+    const packed = { id: mapId };
+    for (const [field, name] of [
+      ['svg_url', 'svgUrl'],
+      ['image_url', 'imageUrl'],
+    ]) {
+      if (map[field]) {
+        packed[name] = resolve(url, map[field]);
+        await this.add(packed[name]);
+      }
+    }
+
+    let page = `${url}/maps/${percentEncode(mapId)}/placemarks?page_size=${pageSize}`;
+    packed.placemarks = 0;
+    while (page) {
+      const response = await this.add(page);
+      const body = JSON.parse(response.body.toString('utf8'));
+      packed.placemarks += (body.results || []).length;
+      page = body.next ? resolve(url, body.next) : null;
+    }
+
+    const routes = `${url}/maps/${percentEncode(mapId)}/routes`;
+    if (await this.add(routes, { optional: true })) {
+      packed.routesUrl = routes;
+    }
+    return packed;
+  }
+
+  async run() {
+    const { url, app, maps: mapIds, assets, concurrency } = this.options;
+    const listing = await this.add(`${url}/maps`);
+    const listed = JSON.parse(listing.body.toString('utf8')).results || [];
+    const maps = mapIds.length
+      ? mapIds.map(
+          (id) =>
+            listed.find((map) => String(map.id) === id) || {
+              id,
+            }
+        )
+      : listed;
+
+    const packed = new Array(maps.length);
+    let next = 0;
+    const worker = async () => {
+      while (next < maps.length) {
+        const i = next++;
+        packed[i] = await this.packMap(maps[i]);
+      }
+    };
+    await Promise.all(
+      Array.from({ length: Math.min(concurrency, maps.length) }, worker)
+    );
+    for (const asset of assets) {
+      await this.add(asset);
+    }
+
+    const manifest = {
+      version: VERSION,
+      appId: app,
+      baseUrl: url,
+      pageSize: this.options.pageSize,
+      createdAt: new Date().toISOString(),
+      maps: packed,
+    };
+    this.assets.set(MANIFEST_KEY, {
+      contentType: 'application/json',
+      bytes: Buffer.from(JSON.stringify(manifest), 'utf8'),
+    });
+    return manifest;
+  }
+}
+
+// The layout AssetBundle::open reads, see cpp/AssetBundle.h
+function encodeBundle(assets) {
+  const keys = Array.from(assets.keys())
+    .map((key) => Buffer.from(key, 'utf8'))
+    .sort(Buffer.compare);
+
+  const strings = [];
+  let stringsLength = 0;
+  const addString = (bytes) => {
+    strings.push(bytes);
+    stringsLength += bytes.length;
+    return stringsLength - bytes.length;
+  };
+
+  const entries = keys.map((key) => {
+    const asset = assets.get(key.toString('utf8'));
+    const type = Buffer.from(asset.contentType, 'utf8');
+    const deflated = zlib.deflateSync(asset.bytes, { level: 9 });
+    const compressed = deflated.length < asset.bytes.length;
+    return {
+      keyOffset: addString(key),
+      keyLength: key.length,
+      typeOffset: addString(type),
+      typeLength: type.length,
+      length: asset.bytes.length,
+      crc: crc32(asset.bytes),
+      flags: compressed ? COMPRESSED : 0,
+      stored: compressed ? deflated : asset.bytes,
+    };
+  });
+
+  const stringsOffset = HEADER_SIZE + entries.length * ENTRY_SIZE;
+  let size = stringsOffset + stringsLength;
+  for (const entry of entries) {
+    size = (size + 7) & ~7;
+    entry.offset = size;
+    size += entry.stored.length;
+  }
+
+  const buffer = Buffer.alloc(size);
+  buffer.write('MMAB', 0, 'latin1');
+  buffer.writeUInt32LE(VERSION, 4);
+  buffer.writeUInt32LE(ENDIAN_TAG, 8);
+  buffer.writeUInt32LE(entries.length, 12);
+  buffer.writeBigUInt64LE(BigInt(stringsOffset), 16);
+  buffer.writeBigUInt64LE(BigInt(stringsLength), 24);
+  entries.forEach((entry, i) => {
+    const at = HEADER_SIZE + i * ENTRY_SIZE;
+    buffer.writeBigUInt64LE(BigInt(entry.offset), at);
+    buffer.writeBigUInt64LE(BigInt(entry.stored.length), at + 8);
+    buffer.writeBigUInt64LE(BigInt(entry.length), at + 16);
+    buffer.writeUInt32LE(entry.keyOffset, at + 24);
+    buffer.writeUInt32LE(entry.keyLength, at + 28);
+    buffer.writeUInt32LE(entry.typeOffset, at + 32);
+    buffer.writeUInt32LE(entry.typeLength, at + 36);
+    buffer.writeUInt32LE(entry.crc, at + 40);
+    buffer.writeUInt32LE(entry.flags, at + 44);
+    entry.stored.copy(buffer, entry.offset);
+  });
+  Buffer.concat(strings).copy(buffer, stringsOffset);
+  return buffer;
+}
+
+async function main() {
+  const options = parseArgs(process.argv.slice(2));
+  const started = Date.now();
+  const packer = new Packer(options);
+  const manifest = await packer.run();
+  const bundle = encodeBundle(packer.assets);
+
+  // Renamed into place so a build never picks up a half-written bundle
+  const temporary = `${options.out}.tmp`;
+  fs.mkdirSync(path.dirname(path.resolve(options.out)), { recursive: true });
+  fs.writeFileSync(temporary, bundle);
+  fs.renameSync(temporary, options.out);
+  console.log(
+    `Packed ${manifest.maps.length} maps, ${packer.assets.size} assets, ` +
+      `${packer.bytesFetched} bytes into ${bundle.length} bytes at ${options.out} ` +
+      `in ${Date.now() - started} ms`
+  );
+}
+
+if (require.main === module) {
+  main().catch((error) => {
+    console.error(error.message);
+    process.exit(1);
+  });
+}
+
+module.exports = { crc32, encodeBundle, percentEncode };
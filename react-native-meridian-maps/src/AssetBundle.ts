@@ -0,0 +1,83 @@
+import { NativeModules } from 'react-native';
+
+export interface AssetBundleInfo {
+  // The venue the bundle was packed for, and its placemark sync endpoint
+  appId: string;
+  baseUrl: string;
+  // Floors packed, files in the bundle and its size on disk
+  maps: number;
+  assets: number;
+  bytes: number;
+  // Placemarks added to an empty index; 0 when the index already had some
+  placemarksSeeded: number;
+}
+
+export interface AssetBundleStats {
+  loaded: boolean;
+  appId?: string;
+  assets?: number;
+  bytes?: number;
+  // Assets answered from the bundle, their inflated size, and failed reads
+  served: number;
+  bytesServed: number;
+  failures: number;
+}
+
+interface AssetBundleModule {
+  loadAssetBundle(path: string): Promise<AssetBundleInfo>;
+  unloadAssetBundle(): void;
+  getAssetBundleStats(): AssetBundleStats;
+}
+
+function assetBundleModule(): AssetBundleModule | undefined {
+  return NativeModules.MeridianMaps as AssetBundleModule | undefined;
+}
+
+/**
+ * Loads a venue bundle packed at build time with scripts/pack-venue.js, so a
+ * fresh install renders its first floor without the network:
+ *
+ *   node node_modules/react-native-meridian-maps/scripts/pack-venue.js \
+ *     --url SYNC_URL --app APP_ID --out venue.mmab
+ *
+ *   await loadAssetBundle('venue.mmab');
+ *
+ * A relative path names a resource in the iOS app bundle or an Android asset.
+ * The packed placemarks fill the app's placemark index if it is empty. On iOS
+ * requests for packed floors are then answered from the bundle; the Android
+ * SDK loads floors through its own HTTP stack, so there only the placemarks
+ * are served from it.
+ */
+export function loadAssetBundle(path: string): Promise<AssetBundleInfo> {
+  const native = assetBundleModule();
+  if (!native || typeof native.loadAssetBundle !== 'function') {
+    return Promise.reject(
+      new Error('Asset bundles are not supported on this platform')
+    );
+  }
+  return native.loadAssetBundle(path);
+}
+
+/**
+ * Stops answering requests from the loaded bundle.
+ */
+export function unloadAssetBundle(): void {
+  const native = assetBundleModule();
+  if (!native || typeof native.unloadAssetBundle !== 'function') {
+    throw new Error('Asset bundles are not supported on this platform');
+  }
+  native.unloadAssetBundle();
+}
+
+/**
+ * How much of the loaded bundle has been served:
+ *
+ *   const { served, bytesServed } = getAssetBundleStats();
+ */
+export function getAssetBundleStats(): AssetBundleStats {
+  const native = assetBundleModule();
+  if (!native || typeof native.getAssetBundleStats !== 'function') {
+    throw new Error('Asset bundle stats are not supported on this platform');
+  }
+  return native.getAssetBundleStats();
+}
@@ -0,0 +1,85 @@
+import { NativeModules } from 'react-native';
+
+export interface CacheOptions {
+  // Bytes of floor assets kept on disk at most (default 100 MB)
+  maxBytes?: number;
+}
+
+export interface CacheStats {
+  // Assets on disk now, their size, and the budget
+  assets: number;
+  bytes: number;
+  maxBytes: number;
+  // Lookups answered from disk, the network bytes that saved, and lookups
+  // that went to the network; hitRate is hits / (hits + misses)
+  hits: number;
+  bytesServed: number;
+  misses: number;
+  hitRate: number;
+  // Assets stored, and how many reused a file holding the same bytes
+  stores: number;
+  dedupStores: number;
+  // Assets dropped to stay within maxBytes, and the bytes that freed
+  evictions: number;
+  bytesEvicted: number;
+}
+
+interface AssetCacheModule {
+  setCacheOptions(options: CacheOptions): void;
+  clearCache(): void;
+  getCacheStats(): CacheStats;
+}
+
+function assetCacheModule(): AssetCacheModule | undefined {
+  return NativeModules.MeridianMaps as AssetCacheModule | undefined;
+}
+
+/**
+ * Floor SVGs and images and placemark images are kept in a disk cache that
+ * survives restarts, so a venue visited before opens without downloading
+ * its floors again. The least recently used assets are evicted past
+ * maxBytes; assets with the same bytes are stored once. On Android the SDK
+ * downloads floors itself, so there the cache holds what this library
+ * fetches.
+ *
+ *   setCacheOptions({ maxBytes: 50 * 1024 * 1024 });
+ */
+export function setCacheOptions(options: CacheOptions): void {
+  const { maxBytes } = options;
+  if (
+    maxBytes !== undefined &&
+    !(Number.isInteger(maxBytes) && maxBytes >= 0)
+  ) {
+    throw new Error('maxBytes must be a non-negative integer');
+  }
+  const native = assetCacheModule();
+  if (!native || typeof native.setCacheOptions !== 'function') {
+    throw new Error('The asset cache is not supported on this platform');
+  }
+  native.setCacheOptions(options);
+}
+
+/**
+ * Deletes every cached asset and viewportSnapshot image, and on iOS the floor
+ * tiles drawn for tiledFloorPreview.
+ */
+export function clearCache(): void {
+  const native = assetCacheModule();
+  if (!native || typeof native.clearCache !== 'function') {
+    throw new Error('The asset cache is not supported on this platform');
+  }
+  native.clearCache();
+}
+
+/**
+ * How much of the floor traffic the cache answered:
+ *
+ *   const { hitRate, bytesServed } = getCacheStats();
+ */
+export function getCacheStats(): CacheStats {
+  const native = assetCacheModule();
+  if (!native || typeof native.getCacheStats !== 'function') {
+    throw new Error('Asset cache stats are not supported on this platform');
+  }
+  return native.getCacheStats();
+}
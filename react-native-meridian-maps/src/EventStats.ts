@@ -0,0 +1,34 @@
+import { NativeModules } from 'react-native';
+
+export interface EventCounts {
+  // Sent to a map view's JS handler
+  dispatched: number;
+  // Dropped natively because no handler was registered for it
+  suppressed: number;
+}
+
+export interface EventStats extends EventCounts {
+  // Keyed by handler prop, e.g. onMapTransformChange
+  byEvent: Record<string, EventCounts>;
+}
+
+interface EventStatsModule {
+  getEventStats(): EventStats;
+}
+
+/**
+ * Counters of map view events since launch, across every map view. Compare two
+ * snapshots to see how much bridge traffic a gesture caused and how much the
+ * event masks kept off the bridge:
+ *
+ *   const before = getEventStats();
+ *   // pinch-zoom
+ *   const sent = getEventStats().dispatched - before.dispatched;
+ */
+export function getEventStats(): EventStats {
+  const native = NativeModules.MeridianMaps as EventStatsModule | undefined;
+  if (!native || typeof native.getEventStats !== 'function') {
+    throw new Error('Event stats are not supported on this platform');
+  }
+  return native.getEventStats();
+}
@@ -0,0 +1,30 @@
+export interface GeofencePoint {
+  x: number;
+  y: number;
+}
+
+// Either a polygon on a floor or a placemark. A placemark geofence waits until
+// the map view loads the placemark's floor; it then covers the placemark's area
+// (iOS) or a circle of radius around its point.
+export type Geofence = {
+  // Reported in transitions; defaults to placemarkId. Adding a geofence with
+  // an id already in use replaces it.
+  id?: string;
+  // An inside geofence is only exited once a fix is this far outside its
+  // edge, in map units, so fixes jittering on the boundary do not flap
+  hysteresis?: number;
+  // Time inside after which one dwell transition fires
+  dwellMs?: number;
+} & (
+  | {
+      id: string;
+      mapKey: string;
+      // Vertices in map units; the last one connects back to the first
+      polygon: GeofencePoint[];
+    }
+  | {
+      placemarkId: string;
+      // Map units, for placemarks without an area (default 10)
+      radius?: number;
+    }
+);
@@ -0,0 +1,36 @@
+export interface LocationHistoryBounds {
+  minX: number;
+  minY: number;
+  maxX: number;
+  maxY: number;
+}
+
+export interface LocationHistoryOptions {
+  // Inclusive range in milliseconds since the epoch
+  since?: number;
+  until?: number;
+  // Only fixes on this map
+  mapKey?: string;
+  // Only fixes inside this box, in map units
+  bbox?: LocationHistoryBounds;
+  // Downsample to at most this many points, keeping the first, the last and
+  // the ones that best preserve the shape of the track
+  maxPoints?: number;
+}
+
+export interface LocationHistoryPoint {
+  // Smoothed position, or the reported one when smoothing is off
+  x: number;
+  y: number;
+  accuracy: number;
+  // Milliseconds since the epoch
+  timestamp: number;
+  mapKey: string;
+}
+
+export interface LocationHistory {
+  // Oldest first
+  points: LocationHistoryPoint[];
+  // Fixes that matched before downsampling
+  matched: number;
+}
@@ -0,0 +1,62 @@
+import { NativeModules } from 'react-native';
+
+export interface LocationUpdateStats {
+  // Fixes the location manager reported to views with an onLocationUpdated handler
+  received: number;
+  // Sent to JS as onLocationUpdated
+  delivered: number;
+  // Did not move or get more accurate enough per locationUpdateOptions
+  dropped: number;
+  // Replaced by a newer fix during the rate limit or coalescing window
+  coalesced: number;
+}
+
+export interface LocationPowerStats {
+  // Milliseconds location ran at full rate, woke for a fix while the device
+  // was still, and stayed paused, summed over every map view
+  activeMs: number;
+  pollingMs: number;
+  pausedMs: number;
+  // Fixes the location manager reported
+  fixes: number;
+  // Times location paused, and resumed because the device moved
+  pauses: number;
+  motionResumes: number;
+  // Wakes for a single fix while still
+  polls: number;
+}
+
+interface LocationStatsModule {
+  getLocationUpdateStats(): LocationUpdateStats;
+  getLocationPowerStats(): LocationPowerStats;
+}
+
+/**
+ * Counters of location fixes since launch, across every map view. Shows how
+ * much of the location stream locationUpdateOptions keeps off the bridge:
+ *
+ *   const { received, delivered } = getLocationUpdateStats();
+ *   const ratio = delivered / Math.max(received, 1);
+ */
+export function getLocationUpdateStats(): LocationUpdateStats {
+  const native = NativeModules.MeridianMaps as LocationStatsModule | undefined;
+  if (!native || typeof native.getLocationUpdateStats !== 'function') {
+    throw new Error('Location update stats are not supported on this platform');
+  }
+  return native.getLocationUpdateStats();
+}
+
+/**
+ * Where location time went since launch under locationDutyCycle. The share of
+ * time paused approximates the positioning power saved:
+ *
+ *   const { activeMs, pollingMs, pausedMs } = getLocationPowerStats();
+ *   const saved = pausedMs / Math.max(activeMs + pollingMs + pausedMs, 1);
+ */
+export function getLocationPowerStats(): LocationPowerStats {
+  const native = NativeModules.MeridianMaps as LocationStatsModule | undefined;
+  if (!native || typeof native.getLocationPowerStats !== 'function') {
+    throw new Error('Location power stats are not supported on this platform');
+  }
+  return native.getLocationPowerStats();
+}
@@ -0,0 +1,79 @@
+import { NativeModules } from 'react-native';
+
+export interface LocationRecording {
+  path: string;
+  // Fixes written to the trace
+  fixes: number;
+}
+
+export interface LocationReplayOptions {
+  // Multiple of the recorded pace, e.g. 1 or 10; 'max' replays as fast as the
+  // UI thread allows (default 1)
+  speed?: number | 'max';
+}
+
+export interface LocationReplayResult {
+  // Fixes fed to the map views
+  fixes: number;
+  // False when stopLocationReplay or another replay ended it early
+  finished: boolean;
+  durationMs: number;
+}
+
+interface LocationTraceModule {
+  startLocationRecording(path: string | null): Promise<string>;
+  stopLocationRecording(): Promise<LocationRecording>;
+  replayLocationTrace(
+    path: string,
+    speed: number
+  ): Promise<LocationReplayResult>;
+  stopLocationReplay(): void;
+}
+
+const unsupported = () =>
+  new Error('Location traces are not supported on this platform');
+
+const traceModule = (): LocationTraceModule | undefined => {
+  const native = NativeModules.MeridianMaps as LocationTraceModule | undefined;
+  return native && typeof native.replayLocationTrace === 'function'
+    ? native
+    : undefined;
+};
+
+/**
+ * Starts writing every location fix the map views receive to a compact binary
+ * trace (cpp/LocationTrace.h). Without a path the trace goes to a new file in
+ * the app's cache directory. Resolves with the path.
+ */
+export function startLocationRecording(path?: string): Promise<string> {
+  const native = traceModule();
+  if (!native) return Promise.reject(unsupported());
+  return native.startLocationRecording(path ?? null);
+}
+
+export function stopLocationRecording(): Promise<LocationRecording> {
+  const native = traceModule();
+  if (!native) return Promise.reject(unsupported());
+  return native.stopLocationRecording();
+}
+
+/**
+ * Feeds a recorded trace to every map view in place of the location provider,
+ * through the same smoothing, throttling and events as live fixes. Fixes keep
+ * their recorded timestamps, so a replay behaves the same on every run:
+ *
+ *   const { durationMs } = await replayLocationTrace(path, { speed: 'max' });
+ */
+export function replayLocationTrace(
+  path: string,
+  options: LocationReplayOptions = {}
+): Promise<LocationReplayResult> {
+  const native = traceModule();
+  if (!native) return Promise.reject(unsupported());
+  const speed = options.speed ?? 1;
+  return native.replayLocationTrace(path, speed === 'max' ? 0 : speed);
+}
+
+export function stopLocationReplay(): void {
+  traceModule()?.stopLocationReplay();
+}
@@ -0,0 +1,62 @@
+import { NativeModules } from 'react-native';
+
+export interface MapPoolOptions {
+  // Unmounted maps kept loaded at most; 0 turns pooling off (default 2)
+  maxSize?: number;
+}
+
+export interface MapPoolStats {
+  // Maps parked now, and the limit
+  size: number;
+  maxSize: number;
+  // Map views that left their map to the pool on unmount
+  parked: number;
+  // Mounts that took a parked map, and mounts that loaded a new one
+  hits: number;
+  misses: number;
+  // Parked maps dropped to stay within maxSize, and on memory warnings
+  evictions: number;
+  trims: number;
+}
+
+interface MapPoolModule {
+  setMapPoolOptions(options: MapPoolOptions): void;
+  getMapPoolStats(): MapPoolStats;
+}
+
+function mapPoolModule(): MapPoolModule | undefined {
+  return NativeModules.MeridianMaps as MapPoolModule | undefined;
+}
+
+/**
+ * A MeridianMapView that unmounts leaves its native map to a pool, and the
+ * next view for the same appId and mapId takes it back already loaded, so
+ * switching tabs does not reload the floor. The least recently used maps are
+ * dropped past maxSize, and all of them when the system is low on memory.
+ *
+ *   setMapPoolOptions({ maxSize: 3 });
+ */
+export function setMapPoolOptions(options: MapPoolOptions): void {
+  const { maxSize } = options;
+  if (maxSize !== undefined && !(Number.isInteger(maxSize) && maxSize >= 0)) {
+    throw new Error('maxSize must be a non-negative integer');
+  }
+  const native = mapPoolModule();
+  if (!native || typeof native.setMapPoolOptions !== 'function') {
+    throw new Error('The map pool is not supported on this platform');
+  }
+  native.setMapPoolOptions(options);
+}
+
+/**
+ * How often mounts found their map in the pool:
+ *
+ *   const { hits, misses } = getMapPoolStats();
+ */
+export function getMapPoolStats(): MapPoolStats {
+  const native = mapPoolModule();
+  if (!native || typeof native.getMapPoolStats !== 'function') {
+    throw new Error('Map pool stats are not supported on this platform');
+  }
+  return native.getMapPoolStats();
+}
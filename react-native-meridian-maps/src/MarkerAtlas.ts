@@ -0,0 +1,39 @@
+import { NativeModules } from 'react-native';
+
+export interface MarkerAtlasStats {
+  // Marker bitmaps held now, their bytes, and the bytes of those no marker shows
+  bitmaps: number;
+  bytes: number;
+  unusedBytes: number;
+  // Markers that got a bitmap already drawn, and bitmaps drawn
+  hits: number;
+  draws: number;
+  // References markers gave back when their floor changed or their map closed
+  releases: number;
+  // Unused bitmaps dropped to stay within the budget, and on memory warnings
+  evictions: number;
+  trims: number;
+}
+
+interface MarkerAtlasModule {
+  getMarkerAtlasStats(): MarkerAtlasStats;
+}
+
+function markerAtlasModule(): MarkerAtlasModule | undefined {
+  return NativeModules.MeridianMaps as MarkerAtlasModule | undefined;
+}
+
+/**
+ * How well the markerIcons of every MeridianMapView share their bitmaps on
+ * Android. Each look (icon, size, color, selected) is drawn once and shown by
+ * every marker that uses it:
+ *
+ *   const { hits, draws } = getMarkerAtlasStats();
+ */
+export function getMarkerAtlasStats(): MarkerAtlasStats {
+  const native = markerAtlasModule();
+  if (!native || typeof native.getMarkerAtlasStats !== 'function') {
+    throw new Error('Marker atlas stats are not supported on this platform');
+  }
+  return native.getMarkerAtlasStats();
+}
@@ -4,9 +4,9 @@ import {
   useRef,
   useImperativeHandle,
   forwardRef,
+  useMemo,
 } from 'react';
 import {
-  requireNativeComponent,
   UIManager,
   Platform,
   type ViewStyle,
@@ -15,8 +15,27 @@ import {
   View,
   Text,
   findNodeHandle,
-  NativeEventEmitter,
+  processColor,
+  type ColorValue,
+  type NativeSyntheticEvent,
 } from 'react-native';
+import MeridianMapViewNativeComponent, {
+  type DirectionsErrorEvent,
+  type GeofenceTransitionEvent,
+  type LocationDutyCycleOptions,
+  type LocationUpdatedEvent,
+  type LocationUpdateOptions,
+  type MapLoadFailEvent,
+  type MarkerIconSpec,
+  type MarkerSelectEvent,
+  type NativeProps,
+  type RouteStepIndexChangeEvent,
+} from './MeridianMapViewNativeComponent';
+import type { Geofence } from './Geofence';
+import type {
+  LocationHistory,
+  LocationHistoryOptions,
+} from './LocationHistory';
 
 // Get the MeridianMaps module for SDK checks
 const MeridianMapsModule = NativeModules.MeridianMaps;
@@ -38,6 +57,20 @@ const LINKING_ERROR = `The package 'MeridianMapView' doesn't seem to be linked.
 - You rebuilt the app after installing the package
 - The native module is properly registered`;
 
+export type MarkerIcon = {
+  // Image URL, drawn aspect-fit. Remote images are read from the floor asset
+  // cache; one not cached yet is fetched, and shows from the next floor load.
+  uri?: string;
+  // Built-in shape drawn when there is no uri (default 'circle')
+  shape?: 'circle' | 'square' | 'pin';
+  // Edge in dp (default 24); selected markers are drawn 25% larger
+  size?: number;
+  // Fills the shape, or tints the image
+  color?: ColorValue;
+  // Color while the marker is selected (default color)
+  selectedColor?: ColorValue;
+};
+
 type MeridianMapViewProps = {
   style?: ViewStyle;
   // Direct props
@@ -45,32 +78,103 @@ type MeridianMapViewProps = {
   mapId: string;
   appToken: string;
   showLocationUpdates?: boolean;
-  // Event handlers
+  // Smoothing plus rate limit, displacement and accuracy gates for onLocationUpdated
+  locationUpdateOptions?: LocationUpdateOptions;
+  // Pause location while the device is still or the view is hidden; see
+  // getLocationPowerStats for what it saves
+  locationDutyCycle?: LocationDutyCycleOptions;
+  // Memory for the native location history behind getLocationHistory, in
+  // bytes (default 64 KB, about 10,000 walking fixes); 0 keeps no history
+  locationHistoryBytes?: number;
+  // iOS: while a floor loads, show it from 256-px tiles of its cached SVG,
+  // drawn on background threads for just the visible area, until the SDK has
+  // drawn it (default false). Helps floors large enough to stall first paint.
+  tiledFloorPreview?: boolean;
+  // Save what the map shows when the app goes to the background, and on the
+  // next mount of the same floor show that image at once, cross-fading to the
+  // live map once it has loaded (default true). iOS also restores the visible
+  // rect and rotation.
+  viewportSnapshot?: boolean;
+  // Android: custom marker icons by placemark type, in place of the SDK's
+  // markers. Markers with the same look share one bitmap; see getMarkerAtlasStats.
+  markerIcons?: { [placemarkType: string]: MarkerIcon };
+  // Event handlers receive the event payload. Events are per view: a handler
+  // only sees the events of the map it is attached to.
   onMapLoadStart?: () => void;
   onMapLoadFinish?: () => void;
-  onMapLoadFail?: (error: any) => void;
-  onLocationUpdated?: (location: any) => void;
-  onMarkerSelect?: (marker: any) => void;
-  onMapTransformChange?: (marker: any) => void;
-  onMarkerDeselect?: (marker: any) => void;
-  onOrientationUpdated?: (marker: any) => void;
-  onSearchActivityStarted?: (marker: any) => void;
-  onDirectionsReroute?: (marker: any) => void;
-  onDirectionsClick?: (marker: any) => void;
-  onDirectionsStart?: (marker: any) => void;
-  onRouteStepIndexChange?: (marker: any) => void;
-  onDirectionsClosed?: (marker: any) => void;
-  onDirectionsError?: (marker: any) => void;
-  onUseAccessiblePathsChange?: (marker: any) => void;
-  onDirectionsCalculated?: (marker: any) => void;
-  onDirectionsRequestComplete?: (marker: any) => void;
-  onDirectionsRequestError?: (marker: any) => void;
-  onDirectionsRequestCanceled?: (marker: any) => void;
-  markerForSelectedMarker?: (marker: any) => void;
-  onCalloutClick?: (marker: any) => void;
-  onError?: (error: any) => void;
+  onMapLoadFail?: (error: MapLoadFailEvent) => void;
+  onMapRenderFinish?: () => void;
+  onLocationUpdated?: (location: LocationUpdatedEvent) => void;
+  onMarkerSelect?: (marker: MarkerSelectEvent) => void;
+  onMapTransformChange?: () => void;
+  onMarkerDeselect?: () => void;
+  onOrientationUpdated?: () => void;
+  onSearchActivityStarted?: () => void;
+  onDirectionsReroute?: () => void;
+  onDirectionsClick?: () => void;
+  onDirectionsStart?: () => void;
+  onRouteStepIndexChange?: (step: RouteStepIndexChangeEvent) => void;
+  onDirectionsClosed?: () => void;
+  onDirectionsError?: (error: DirectionsErrorEvent) => void;
+  onUseAccessiblePathsChange?: () => void;
+  onDirectionsCalculated?: () => void;
+  onDirectionsRequestComplete?: () => void;
+  onDirectionsRequestError?: (error: DirectionsErrorEvent) => void;
+  onDirectionsRequestCanceled?: () => void;
+  onCalloutClick?: () => void;
+  // Geofences added through the ref entering, exiting or being dwelled in
+  onGeofenceTransition?: (transition: GeofenceTransitionEvent) => void;
 };
 
+type MapViewEventName = Extract<keyof NativeProps, `on${string}`>;
+
+function toMarkerIconSpecs(icons: {
+  [placemarkType: string]: MarkerIcon;
+}): MarkerIconSpec[] {
+  return Object.keys(icons).map((type) => {
+    const { uri, shape, size, color, selectedColor } = icons[type]!;
+    return {
+      type,
+      uri,
+      shape,
+      size,
+      color: color !== undefined ? (processColor(color) as number) : undefined,
+      selectedColor:
+        selectedColor !== undefined
+          ? (processColor(selectedColor) as number)
+          : undefined,
+    };
+  });
+}
+
+// Index i is bit i of the native event mask; iOS (MMMapViewEvent) and Android
+// (MapViewEvent.NAMES) use the same order, so only append to this list.
+const MAP_VIEW_EVENTS: ReadonlyArray<MapViewEventName> = [
+  'onMapLoadStart',
+  'onMapLoadFinish',
+  'onMapLoadFail',
+  'onMapRenderFinish',
+  'onMapTransformChange',
+  'onLocationUpdated',
+  'onOrientationUpdated',
+  'onMarkerSelect',
+  'onMarkerDeselect',
+  'onCalloutClick',
+  'onSearchActivityStarted',
+  'onDirectionsReroute',
+  'onDirectionsClick',
+  'onDirectionsStart',
+  'onRouteStepIndexChange',
+  'onDirectionsClosed',
+  'onDirectionsError',
+  'onUseAccessiblePathsChange',
+  'onDirectionsCalculated',
+  'onDirectionsRequestComplete',
+  'onDirectionsRequestError',
+  'onDirectionsRequestCanceled',
+  'onGeofenceTransition',
+];
+
 export const ComponentName = 'MeridianMapView';
 
 // Check if the native component is available
@@ -88,7 +192,7 @@ if (!isComponentAvailable) {
 }
 
 const NativeMeridianMapView = isComponentAvailable
-  ? requireNativeComponent<MeridianMapViewProps>(ComponentName)
+  ? MeridianMapViewNativeComponent
   : () => {
       console.error(LINKING_ERROR);
       return (
@@ -98,10 +202,31 @@ const NativeMeridianMapView = isComponentAvailable
       );
     };
 
+// Phase timings of a route start, in milliseconds
+export interface RouteTimings {
+  placemarkLookupMs: number;
+  floorLoadMs: number;
+  routeCalcMs: number;
+  totalMs: number;
+  // Whether the map had to load another floor for the route
+  floorSwitched: boolean;
+}
+
 // Create a wrapper component with event handling and proper mounting behavior
 export interface MeridianMapViewComponentRef {
   triggerUpdate: () => void;
-  startRoute: (placemarkID: string) => void;
+  // Resolves once the route is on screen; rejects if a newer startRoute replaces it
+  startRoute: (placemarkID: string) => Promise<RouteTimings>;
+  // Recent fixes this map received, kept natively whether or not
+  // onLocationUpdated is set
+  getLocationHistory: (
+    options?: LocationHistoryOptions
+  ) => Promise<LocationHistory>;
+  // Checked natively against every fix this map receives; transitions arrive
+  // through onGeofenceTransition. Rejects, adding none, if one is invalid.
+  addGeofences: (geofences: Geofence[]) => Promise<void>;
+  // Forgets geofences without reporting exits; all of them when ids is omitted
+  removeGeofences: (ids?: string[]) => Promise<void>;
 }
 
 export const MeridianMapView = forwardRef<
@@ -133,20 +258,66 @@ export const MeridianMapView = forwardRef<
     }
   };
 
-  const startRoute = (placemarkID: string) => {
+  const startRoute = (placemarkID: string): Promise<RouteTimings> => {
     const reactTag = findNodeHandle(nativeMapRef.current);
     if (!reactTag) {
-      console.warn('Cannot start route, nativeMapRef is not set.');
-      return;
+      return Promise.reject(
+        new Error('Cannot start route, nativeMapRef is not set.')
+      );
     }
+    if (typeof MeridianMapsModule?.startRoute !== 'function') {
+      return Promise.reject(
+        new Error('startRoute is not supported on this platform')
+      );
+    }
+    return MeridianMapsModule.startRoute(reactTag, placemarkID);
+  };
 
-    const commandId = UIManager.getViewManagerConfig(ComponentName)?.Commands?.startRouteToPlacemark;
-    if (commandId === undefined) {
-      console.warn('startRouteToPlacemark command not found');
-      return;
+  const getLocationHistory = (
+    options: LocationHistoryOptions = {}
+  ): Promise<LocationHistory> => {
+    const reactTag = findNodeHandle(nativeMapRef.current);
+    if (!reactTag) {
+      return Promise.reject(
+        new Error('Cannot read location history, nativeMapRef is not set.')
+      );
+    }
+    if (typeof MeridianMapsModule?.getLocationHistory !== 'function') {
+      return Promise.reject(
+        new Error('getLocationHistory is not supported on this platform')
+      );
+    }
+    return MeridianMapsModule.getLocationHistory(reactTag, options);
+  };
+
+  const addGeofences = (geofences: Geofence[]): Promise<void> => {
+    const reactTag = findNodeHandle(nativeMapRef.current);
+    if (!reactTag) {
+      return Promise.reject(
+        new Error('Cannot add geofences, nativeMapRef is not set.')
+      );
     }
+    if (typeof MeridianMapsModule?.addGeofences !== 'function') {
+      return Promise.reject(
+        new Error('addGeofences is not supported on this platform')
+      );
+    }
+    return MeridianMapsModule.addGeofences(reactTag, geofences);
+  };
 
-    UIManager.dispatchViewManagerCommand(reactTag, commandId, [placemarkID]);
+  const removeGeofences = (ids?: string[]): Promise<void> => {
+    const reactTag = findNodeHandle(nativeMapRef.current);
+    if (!reactTag) {
+      return Promise.reject(
+        new Error('Cannot remove geofences, nativeMapRef is not set.')
+      );
+    }
+    if (typeof MeridianMapsModule?.removeGeofences !== 'function') {
+      return Promise.reject(
+        new Error('removeGeofences is not supported on this platform')
+      );
+    }
+    return MeridianMapsModule.removeGeofences(reactTag, ids ?? null);
   };
 
   // Validate required props
@@ -165,132 +336,26 @@ export const MeridianMapView = forwardRef<
     }
   }, [props.appId, props.mapId, props.appToken]);
 
-  // Set up event handlers
-  useEffect(() => {
-    if (!isComponentAvailable || !nativeMapRef.current) return;
-
-    // Try to create event emitter for this component
-    try {
-      const nodeId = findNodeHandle(nativeMapRef.current);
-      console.log('MeridianMapView node handle ID:', nodeId);
-
-      // Listen for events from native side
-      const eventEmitter =
-        Platform.OS === 'ios'
-          ? new NativeEventEmitter(NativeModules.MMEventEmitter)
-          : new NativeEventEmitter(NativeModules.MeridianMaps);
-
-      // Map event listeners
-      const subscriptions = [
-        eventEmitter.addListener('onMapLoadStart', () => {
-          console.log('Map load started');
-          // setActiveKey('mapLoadStart');
-          props.onMapLoadStart?.();
-        }),
-        eventEmitter.addListener('onMapLoadFinish', () => {
-          console.log('Map load finished');
-          props.onMapLoadFinish?.();
-        }),
-        eventEmitter.addListener('onMapLoadFail', (event) => {
-          console.error('Map load failed:', event);
-          props.onMapLoadFail?.(event);
-        }),
-        eventEmitter.addListener('onLocationUpdated', (event) => {
-          console.log('Location updated:', event);
-          props.onLocationUpdated?.(event);
-        }),
-        eventEmitter.addListener('onMarkerSelect', (event) => {
-          console.log('Marker selected:', event);
-          props.onMarkerSelect?.(event);
-        }),
-        eventEmitter.addListener('onMarkerDeselect', (event) => {
-          console.log('Marker deselected:', event);
-          props.onMarkerDeselect?.(event);
-        }),
-        eventEmitter.addListener('onError', (event) => {
-          console.error('Map error:', event);
-          // setActiveKey('error');
-          props.onError?.(event);
-        }),
-        eventEmitter.addListener('onMapTransformChange', (event) => {
-          console.log('Map onMapTransformChange:', event);
-
-          props.onMapTransformChange?.(event);
-        }),
-        eventEmitter.addListener('onOrientationUpdated', (event) => {
-          console.log('Map onOrientationUpdated:', event);
-
-          props.onOrientationUpdated?.(event);
-        }),
-        eventEmitter.addListener('onDirectionsReroute', (event) => {
-          console.log('Map onDirectionsReroute:', event);
-
-          props.onDirectionsReroute?.(event);
-        }),
-        eventEmitter.addListener('onDirectionsClick', (event) => {
-          console.log('Map onDirectionsClick:', event);
-
-          props.onDirectionsClick?.(event);
-        }),
-        eventEmitter.addListener('onDirectionsStart', (event) => {
-          console.log('Map onDirectionsStart:', event);
-          props.onDirectionsStart?.(event);
-        }),
-        eventEmitter.addListener('onRouteStepIndexChange', (event) => {
-          console.log('Map onRouteStepIndexChange:', event);
-          props.onRouteStepIndexChange?.(event);
-        }),
-        eventEmitter.addListener('onDirectionsClosed', (event) => {
-          console.log('Map onDirectionsClosed:', event);
-          props.onDirectionsClosed?.(event);
-        }),
-        eventEmitter.addListener('onDirectionsError', (event) => {
-          console.log('Map onDirectionsError:', event);
-          props.onDirectionsError?.(event);
-        }),
-        eventEmitter.addListener('onUseAccessiblePathsChange', (event) => {
-          console.log('Map onUseAccessiblePathsChange:', event);
-          props.onUseAccessiblePathsChange?.(event);
-        }),
-        eventEmitter.addListener('markerForSelectedMarker', (event) => {
-          console.log('Map markerForSelectedMarker:', event);
-          props.markerForSelectedMarker?.(event);
-        }),
-        eventEmitter.addListener('onCalloutClick', (event) => {
-          console.log('Map onCalloutClick:', event);
-          props.onCalloutClick?.(event);
-        }),
-        eventEmitter.addListener('onDirectionsCalculated', (event) => {
-          console.log('Map onDirectionsCalculated:', event);
-          props.onDirectionsCalculated?.(event);
-        }),
-        eventEmitter.addListener('onDirectionsRequestComplete', (event) => {
-          console.log('Map onDirectionsRequestComplete:', event);
-          props.onDirectionsRequestComplete?.(event);
-        }),
-        eventEmitter.addListener('onDirectionsRequestError', (event) => {
-          console.log('Map onDirectionsRequestError:', event);
-          props.onDirectionsRequestError?.(event);
-        }),
-        eventEmitter.addListener('onDirectionsRequestCanceled', (event) => {
-          console.log('Map onDirectionsRequestCanceled:', event);
-          props.onDirectionsRequestCanceled?.(event);
-        }),
-        eventEmitter.addListener('onSearchActivityStarted', (event) => {
-          console.log('Map onSearchActivityStarted:', event);
-          props.onSearchActivityStarted?.(event);
-        }),
-      ];
-
-      return () => {
-        // Clean up subscriptions
-        subscriptions.forEach((subscription) => subscription.remove());
-      };
-    } catch (e) {
-      console.error('Error setting up event listeners:', e);
-      return () => {}; // Return empty cleanup function to handle all code paths
+  // Only handlers that are set are passed down, and the event mask tells native
+  // to skip every other event before it builds a payload. The payload is
+  // unwrapped from the synthetic event.
+  const eventHandlers: Partial<
+    Record<MapViewEventName, (event: NativeSyntheticEvent<any>) => void>
+  > = {};
+  let eventMask = 0;
+  MAP_VIEW_EVENTS.forEach((name, bit) => {
+    const handler = props[name] as ((payload: any) => void) | undefined;
+    if (handler) {
+      eventHandlers[name] = (event) => handler(event.nativeEvent);
+      eventMask |= 1 << bit;
     }
-  }, [nativeMapRef.current, isComponentAvailable, props]);
+  });
+
+  const markerIcons = useMemo(
+    () =>
+      props.markerIcons ? toMarkerIconSpecs(props.markerIcons) : undefined,
+    [props.markerIcons]
+  );
 
   // Expose triggerUpdate method via ref
   useImperativeHandle(ref, () => ({
@@ -299,6 +364,9 @@ export const MeridianMapView = forwardRef<
       executeNativeUpdateCommand();
     },
     startRoute: startRoute,
+    getLocationHistory: getLocationHistory,
+    addGeofences: addGeofences,
+    removeGeofences: removeGeofences,
   }));
 
   // --- Effect to trigger update when internal activeKey changes ---
@@ -371,13 +439,20 @@ export const MeridianMapView = forwardRef<
         <NativeMeridianMapView
           // @ts-ignore - The native component accepts a ref prop
           ref={nativeMapRef}
-          {...props}
+          {...eventHandlers}
+          eventMask={eventMask}
           style={combinedStyle}
           // Pass direct props
           appId={props.appId}
           mapId={props.mapId}
           appToken={props.appToken}
           showLocationUpdates={props.showLocationUpdates ?? true}
+          locationUpdateOptions={props.locationUpdateOptions}
+          locationDutyCycle={props.locationDutyCycle}
+          locationHistoryBytes={props.locationHistoryBytes}
+          tiledFloorPreview={props.tiledFloorPreview}
+          viewportSnapshot={props.viewportSnapshot ?? true}
+          markerIcons={markerIcons}
         />
       ) : (
         <View
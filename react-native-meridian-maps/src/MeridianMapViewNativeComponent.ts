@@ -0,0 +1,153 @@
+import type { HostComponent, ViewProps } from 'react-native';
+import type {
+  DirectEventHandler,
+  Double,
+  Int32,
+  WithDefault,
+} from 'react-native/Libraries/Types/CodegenTypes';
+import codegenNativeComponent from 'react-native/Libraries/Utilities/codegenNativeComponent';
+
+// Payloads of the map view's events. Each event is dispatched to the view that
+// raised it only; there is no global broadcast.
+
+export type MapLoadFailEvent = Readonly<{
+  error: string;
+  code?: Int32;
+  domain?: string;
+}>;
+
+export type LocationUpdatedEvent = Readonly<{
+  // Smoothed position, or the reported one when smoothing is off
+  point: Readonly<{ x: Double; y: Double }>;
+  // Position as reported by the location manager
+  rawPoint: Readonly<{ x: Double; y: Double }>;
+  mapKey: string;
+  // Milliseconds since the epoch
+  timestamp: Double;
+  // Reported by iOS only
+  accuracy?: Double;
+  providerType?: Int32;
+  // Estimated by the smoothing filter, in map units per second
+  velocity?: Readonly<{ x: Double; y: Double }>;
+  speed?: Double;
+  // Degrees clockwise from map up; missing until the device has moved
+  heading?: Double;
+}>;
+
+export type MarkerSelectEvent = Readonly<{
+  markerId: string;
+  placemarkId?: string;
+  name?: string;
+}>;
+
+export type RouteStepIndexChangeEvent = Readonly<{
+  index: Int32;
+}>;
+
+export type DirectionsErrorEvent = Readonly<{
+  error: string;
+  cause?: string;
+}>;
+
+export type GeofenceTransitionEvent = Readonly<{
+  type: string; // 'enter' | 'exit' | 'dwell'
+  // Id the geofence was added with
+  id: string;
+  // Timestamp of the fix that caused it, in milliseconds since the epoch
+  timestamp: Double;
+}>;
+
+// Gates for onLocationUpdated; a gate left at 0 is off. Fixes that fail them
+// are dropped natively and never cross the bridge.
+export type LocationUpdateOptions = Readonly<{
+  // Smooth fixes with a constant-velocity Kalman filter before the gates below
+  smoothing?: WithDefault<boolean, true>;
+  // At most this many updates per second
+  maxRateHz?: WithDefault<Double, 0>;
+  // Map units a fix must move from the last delivered one
+  minDisplacement?: WithDefault<Double, 0>;
+  // How much the accuracy radius must shrink for a fix that did not move (iOS)
+  minAccuracyImprovement?: WithDefault<Double, 0>;
+  // Hold a fix this long and deliver only the latest one that arrived meanwhile
+  coalesceWindowMs?: WithDefault<Int32, 0>;
+}>;
+
+// When the location manager pauses to save power. Motion comes from the
+// accelerometer, which only runs while enabled.
+export type LocationDutyCycleOptions = Readonly<{
+  // Off by default: location runs whenever showLocationUpdates is set
+  enabled?: WithDefault<boolean, false>;
+  // Still this long before location pauses
+  stillDelayMs?: WithDefault<Int32, 30000>;
+  // While still, wake this often for a single fix; 0 stays paused until motion
+  stillPollIntervalMs?: WithDefault<Int32, 120000>;
+  // A wake ends at its first fix or after this long
+  pollTimeoutMs?: WithDefault<Int32, 10000>;
+  // Pause while the view is off screen or the app is in the background
+  pauseWhenHidden?: WithDefault<boolean, true>;
+}>;
+
+// How the markers of one placemark type are drawn (Android). Each look is drawn
+// once and the bitmap shared by every marker showing it; see MarkerAtlas.kt.
+export type MarkerIconSpec = Readonly<{
+  type: string;
+  // Image to draw, aspect-fit; without one the icon is a built-in shape
+  uri?: string;
+  shape?: WithDefault<'circle' | 'square' | 'pin', 'circle'>;
+  // Edge in dp
+  size?: WithDefault<Double, 24>;
+  // Processed colors (processColor); color fills a shape and tints an image
+  color?: Int32;
+  selectedColor?: Int32;
+}>;
+
+// Events that carry nothing beyond the fact that they happened
+export type MapViewEvent = Readonly<{}>;
+
+export interface NativeProps extends ViewProps {
+  appId: string;
+  mapId: string;
+  appToken: string;
+  showLocationUpdates?: WithDefault<boolean, true>;
+  // One bit per event the JS side has a handler for, in MAP_VIEW_EVENTS order
+  // (src/MeridianMapView.tsx). Native drops masked-out events before building them.
+  eventMask?: WithDefault<Int32, -1>;
+  locationUpdateOptions?: LocationUpdateOptions;
+  locationDutyCycle?: LocationDutyCycleOptions;
+  // Bytes of recent fixes kept for getLocationHistory; 0 keeps none
+  locationHistoryBytes?: WithDefault<Int32, 65536>;
+  // Show a loading floor from tiles of its cached SVG; iOS only
+  tiledFloorPreview?: WithDefault<boolean, false>;
+  // Show the map as it was left in the background until it has loaded
+  viewportSnapshot?: WithDefault<boolean, true>;
+  // Custom marker icons, one per placemark type; Android only
+  markerIcons?: ReadonlyArray<MarkerIconSpec>;
+
+  onMapLoadStart?: DirectEventHandler<MapViewEvent>;
+  onMapLoadFinish?: DirectEventHandler<MapViewEvent>;
+  onMapLoadFail?: DirectEventHandler<MapLoadFailEvent>;
+  onMapRenderFinish?: DirectEventHandler<MapViewEvent>;
+  onMapTransformChange?: DirectEventHandler<MapViewEvent>;
+  onLocationUpdated?: DirectEventHandler<LocationUpdatedEvent>;
+  onOrientationUpdated?: DirectEventHandler<MapViewEvent>;
+  onMarkerSelect?: DirectEventHandler<MarkerSelectEvent>;
+  onMarkerDeselect?: DirectEventHandler<MapViewEvent>;
+  onCalloutClick?: DirectEventHandler<MapViewEvent>;
+  onSearchActivityStarted?: DirectEventHandler<MapViewEvent>;
+  onDirectionsReroute?: DirectEventHandler<MapViewEvent>;
+  onDirectionsClick?: DirectEventHandler<MapViewEvent>;
+  onDirectionsStart?: DirectEventHandler<MapViewEvent>;
+  onRouteStepIndexChange?: DirectEventHandler<RouteStepIndexChangeEvent>;
+  onDirectionsClosed?: DirectEventHandler<MapViewEvent>;
+  onDirectionsError?: DirectEventHandler<DirectionsErrorEvent>;
+  onUseAccessiblePathsChange?: DirectEventHandler<MapViewEvent>;
+  onDirectionsCalculated?: DirectEventHandler<MapViewEvent>;
+  onDirectionsRequestComplete?: DirectEventHandler<MapViewEvent>;
+  onDirectionsRequestError?: DirectEventHandler<DirectionsErrorEvent>;
+  onDirectionsRequestCanceled?: DirectEventHandler<MapViewEvent>;
+  onGeofenceTransition?: DirectEventHandler<GeofenceTransitionEvent>;
+}
+
+export default codegenNativeComponent<NativeProps>(
+  'MeridianMapView'
+) as HostComponent<NativeProps>;
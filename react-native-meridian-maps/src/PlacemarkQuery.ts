@@ -0,0 +1,83 @@
+import { NativeModules } from 'react-native';
+
+interface QueryBase {
+  // Floor to search
+  mapId: string;
+  // Maximum hits (default 10 for nearest, 100 for radius and rect)
+  limit?: number;
+  // Only return placemarks of these types, e.g. ['restroom', 'exit']
+  types?: string[];
+}
+
+export interface NearestQuery extends QueryBase {
+  kind: 'nearest';
+  x: number;
+  y: number;
+  // Ignore placemarks further away than this
+  radius?: number;
+}
+
+export interface RadiusQuery extends QueryBase {
+  kind: 'radius';
+  x: number;
+  y: number;
+  radius: number;
+}
+
+export interface RectQuery extends QueryBase {
+  kind: 'rect';
+  minX: number;
+  minY: number;
+  maxX: number;
+  maxY: number;
+}
+
+export type PlacemarkQuery = NearestQuery | RadiusQuery | RectQuery;
+
+export interface PlacemarkHit {
+  id: string;
+  mapId: string;
+  name: string;
+  type: string;
+  x: number;
+  y: number;
+  // Distance from the query point to the placemark area; 0 for rect queries
+  distance: number;
+}
+
+interface PlacemarkQueryModule {
+  queryPlacemarks(
+    appId: string,
+    queries: PlacemarkQuery[]
+  ): Promise<PlacemarkHit[][]>;
+}
+
+/**
+ * Runs several spatial queries against the native per-floor index in one
+ * bridge call. Nearest and radius hits are sorted by distance.
+ *
+ * What the index holds differs by platform. iOS waits for the app's
+ * placemarks to finish loading before answering. Android answers right away
+ * from what it already has: the floors a map view has loaded, the placemark
+ * snapshot on disk (see prewarm) and anything synced or seeded, so floors
+ * not loaded yet can come back empty.
+ *
+ *   const [restrooms, exits] = await queryPlacemarks(appId, [
+ *     { kind: 'nearest', mapId, x, y, types: ['restroom'], limit: 1 },
+ *     { kind: 'nearest', mapId, x, y, types: ['exit'], limit: 1 },
+ *   ]);
+ */
+export function queryPlacemarks(
+  appId: string,
+  queries: PlacemarkQuery[]
+): Promise<PlacemarkHit[][]> {
+  const native = NativeModules.MeridianMaps as
+    | PlacemarkQueryModule
+    | undefined;
+  if (!native || typeof native.queryPlacemarks !== 'function') {
+    return Promise.reject(
+      new Error('Placemark queries are not supported on this platform')
+    );
+  }
+  return native.queryPlacemarks(appId, queries);
+}
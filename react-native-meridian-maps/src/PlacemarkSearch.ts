@@ -0,0 +1,45 @@
+import { NativeModules } from 'react-native';
+
+export interface PlacemarkSearchResult {
+  id: string;
+  mapId: string;
+  name: string;
+  type: string;
+  x: number;
+  y: number;
+  // Relevance, higher is better; only comparable within one search
+  score: number;
+}
+
+interface PlacemarkSearchModule {
+  searchPlacemarks(
+    appId: string,
+    query: string,
+    limit: number
+  ): PlacemarkSearchResult[];
+}
+
+/**
+ * Typeahead search over the placemarks already indexed on the device, best
+ * match first. Matches whole words, word prefixes and small typos.
+ * The call is synchronous and never hits the network, so it can run on every
+ * keystroke:
+ *
+ *   const results = searchPlacemarks(appId, text, 10);
+ */
+export function searchPlacemarks(
+  appId: string,
+  query: string,
+  limit: number = 20
+): PlacemarkSearchResult[] {
+  const native = NativeModules.MeridianMaps as
+    | PlacemarkSearchModule
+    | undefined;
+  if (!native || typeof native.searchPlacemarks !== 'function') {
+    throw new Error('Placemark search is not supported on this platform');
+  }
+  if (query.trim().length === 0) {
+    return [];
+  }
+  return native.searchPlacemarks(appId, query, limit);
+}
@@ -0,0 +1,101 @@
+import { NativeModules } from 'react-native';
+
+export interface Placemark {
+  id: string;
+  mapId: string;
+  name: string;
+  type: string;
+  typeName: string;
+  x: number;
+  y: number;
+}
+
+export interface PlacemarkPage {
+  mapId: string;
+  placemarks: Placemark[];
+}
+
+export interface PlacemarkStreamOptions {
+  // How many floors are paged at the same time (default 4)
+  maxConcurrentFloors?: number;
+  // Only load these floors instead of every map in the app
+  mapIds?: string[];
+}
+
+interface PlacemarkStreamModule {
+  openPlacemarkStream(
+    appId: string,
+    options: PlacemarkStreamOptions
+  ): Promise<number>;
+  nextPlacemarkPage(
+    streamId: number
+  ): Promise<({ done: false } & PlacemarkPage) | { done: true }>;
+  closePlacemarkStream(streamId: number): void;
+}
+
+/**
+ * Streams every placemark of an app, one page at a time, as the native loader
+ * receives them. Breaking out of a `for await` loop cancels the remaining requests.
+ *
+ *   for await (const page of streamPlacemarks(appId)) {
+ *     render(page.placemarks);
+ *   }
+ */
+export function streamPlacemarks(
+  appId: string,
+  options: PlacemarkStreamOptions = {}
+): AsyncIterableIterator<PlacemarkPage> {
+  const native = NativeModules.MeridianMaps as
+    | PlacemarkStreamModule
+    | undefined;
+  let streamId: Promise<number> | null = null;
+  let finished = false;
+
+  const open = () => {
+    if (!native || typeof native.openPlacemarkStream !== 'function') {
+      return Promise.reject(
+        new Error('Placemark streaming is not supported on this platform')
+      );
+    }
+    if (!streamId) {
+      streamId = native.openPlacemarkStream(appId, options);
+    }
+    return streamId;
+  };
+
+  const iterator: AsyncIterableIterator<PlacemarkPage> = {
+    [Symbol.asyncIterator]() {
+      return iterator;
+    },
+    async next() {
+      if (finished) {
+        return { done: true, value: undefined };
+      }
+      try {
+        const id = await open();
+        const page = await native!.nextPlacemarkPage(id);
+        if (page.done) {
+          finished = true;
+          return { done: true, value: undefined };
+        }
+        return {
+          done: false,
+          value: { mapId: page.mapId, placemarks: page.placemarks },
+        };
+      } catch (e) {
+        finished = true;
+        throw e;
+      }
+    },
+    async return() {
+      if (!finished) {
+        finished = true;
+        if (streamId) {
+          native?.closePlacemarkStream(await streamId);
+        }
+      }
+      return { done: true, value: undefined };
+    },
+  };
+  return iterator;
+}
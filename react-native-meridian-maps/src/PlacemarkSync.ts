@@ -0,0 +1,57 @@
+import { NativeModules } from 'react-native';
+
+export interface PlacemarkSyncOptions {
+  // Base URL of the placemark sync endpoint, see cpp/PlacemarkSync.h
+  url: string;
+  // Only sync these floors instead of every map the endpoint lists
+  mapIds?: string[];
+  // Placemarks per page (default 500)
+  pageSize?: number;
+  // Extra request headers, e.g. Authorization
+  headers?: Record<string, string>;
+}
+
+export interface PlacemarkSyncStats {
+  requests: number;
+  bytesReceived: number;
+  // Floors answered with 304, synced from a cursor, or listed in full
+  mapsUnchanged: number;
+  mapsDelta: number;
+  mapsFull: number;
+  upserted: number;
+  removed: number;
+  // Placemarks a full listing returned unchanged
+  unchanged: number;
+  durationMs: number;
+}
+
+interface PlacemarkSyncModule {
+  syncPlacemarks(
+    appId: string,
+    options: PlacemarkSyncOptions
+  ): Promise<PlacemarkSyncStats>;
+}
+
+/**
+ * Brings the on-device placemark cache of an app up to date. The first call
+ * downloads every floor; later calls, including after a restart, only fetch
+ * the floors and placemarks that changed. A successful sync also satisfies the
+ * map view's placemark lookups, so they no longer page every floor through the
+ * SDK.
+ *
+ *   const stats = await syncPlacemarks(appId, { url: SYNC_URL });
+ */
+export function syncPlacemarks(
+  appId: string,
+  options: PlacemarkSyncOptions
+): Promise<PlacemarkSyncStats> {
+  const native = NativeModules.MeridianMaps as
+    | PlacemarkSyncModule
+    | undefined;
+  if (!native || typeof native.syncPlacemarks !== 'function') {
+    return Promise.reject(
+      new Error('Placemark sync is not supported on this platform')
+    );
+  }
+  return native.syncPlacemarks(appId, options);
+}
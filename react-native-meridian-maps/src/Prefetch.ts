@@ -0,0 +1,53 @@
+import { NativeModules } from 'react-native';
+
+export interface PrefetchStats {
+  // Asset URLs waiting to download
+  queued: number;
+  // Downloaded into the cache and their size, found there already, and failed
+  fetched: number;
+  bytesFetched: number;
+  alreadyCached: number;
+  failures: number;
+  // Queued URLs dropped by cancelPrefetch or a newer floor, and downloads
+  // stopped at half the cache budget
+  cancelled: number;
+  budgetStops: number;
+}
+
+interface PrefetchModule {
+  cancelPrefetch(): void;
+  getPrefetchStats(): PrefetchStats;
+}
+
+function prefetchModule(): PrefetchModule | undefined {
+  return NativeModules.MeridianMaps as PrefetchModule | undefined;
+}
+
+/**
+ * Once a floor has loaded, the floors a level above and below it in the
+ * same building download into the asset cache in the background, and once
+ * a route is shown every floor it crosses does, so floor switches while
+ * navigating render from disk (see setCacheOptions). This stops the
+ * downloads not yet started; unmounting a map view does the same. iOS only:
+ * the Android SDK loads floors through its own HTTP stack.
+ */
+export function cancelPrefetch(): void {
+  const native = prefetchModule();
+  if (!native || typeof native.cancelPrefetch !== 'function') {
+    throw new Error('Floor prefetching is not supported on this platform');
+  }
+  native.cancelPrefetch();
+}
+
+/**
+ * How much the prefetcher has downloaded ahead of the user:
+ *
+ *   const { fetched, bytesFetched } = getPrefetchStats();
+ */
+export function getPrefetchStats(): PrefetchStats {
+  const native = prefetchModule();
+  if (!native || typeof native.getPrefetchStats !== 'function') {
+    throw new Error('Prefetch stats are not supported on this platform');
+  }
+  return native.getPrefetchStats();
+}
@@ -0,0 +1,33 @@
+import { NativeModules } from 'react-native';
+
+export interface RequestStats {
+  // Answered from a cached result without touching the network
+  hits: number;
+  // Started a new SDK request
+  misses: number;
+  // Joined a request another view already had in flight
+  coalesced: number;
+  // Shared requests cancelled because their last subscriber left
+  cancelled: number;
+  inFlight: number;
+  cached: number;
+}
+
+interface RequestStatsModule {
+  getRequestStats(): RequestStats;
+}
+
+/**
+ * Counters of the native request broker that shares placemark, map and
+ * directions requests between every map view of the app. Useful to check that
+ * several components routing to the same place hit the network once:
+ *
+ *   const { misses, coalesced } = getRequestStats();
+ */
+export function getRequestStats(): RequestStats {
+  const native = NativeModules.MeridianMaps as RequestStatsModule | undefined;
+  if (!native || typeof native.getRequestStats !== 'function') {
+    throw new Error('Request stats are not supported on this platform');
+  }
+  return native.getRequestStats();
+}
@@ -0,0 +1,75 @@
+import { NativeModules } from 'react-native';
+
+export interface PrewarmOptions {
+  appId: string;
+  // The floor the first map view opens
+  mapId: string;
+  token: string;
+  // Where the app's data is hosted (default 'default')
+  region?: 'default' | 'us' | 'eu';
+}
+
+// Milliseconds from the start of the prewarm until each phase finished
+export interface PrewarmTimings {
+  configureMs: number;
+  // The default floor's placemarks; on Android, mapping the cached snapshot
+  placemarksMs: number;
+  mapMs: number;
+  totalMs: number;
+}
+
+export interface StartupStats {
+  prewarmState: 'none' | 'running' | 'done' | 'failed';
+  prewarmMs: number;
+  // Map views created before any prewarm, and how long they took from
+  // creation to their first floor on screen
+  coldRenders: number;
+  coldRenderMeanMs: number;
+  coldRenderLastMs: number;
+  // The same for map views created after prewarm was called
+  warmRenders: number;
+  warmRenderMeanMs: number;
+  warmRenderLastMs: number;
+}
+
+interface SessionModule {
+  prewarm(options: PrewarmOptions): Promise<PrewarmTimings>;
+  getStartupStats(): StartupStats;
+}
+
+function sessionModule(): SessionModule | undefined {
+  return NativeModules.MeridianMaps as SessionModule | undefined;
+}
+
+/**
+ * Configures the Meridian SDK once for the whole app and warms what the first
+ * map view needs: positioning, the default floor and its placemarks. Call it
+ * at startup, before any map view mounts; without it the first view
+ * configures the SDK when it mounts. Calling it again for the same app returns
+ * the first call's timings.
+ *
+ *   prewarm({ appId, mapId, token }).catch(() => {});
+ */
+export function prewarm(options: PrewarmOptions): Promise<PrewarmTimings> {
+  const native = sessionModule();
+  if (!native || typeof native.prewarm !== 'function') {
+    return Promise.reject(
+      new Error('Prewarm is not supported on this platform')
+    );
+  }
+  return native.prewarm(options);
+}
+
+/**
+ * Time to first render of the map views since launch, split by whether a
+ * prewarm came before them:
+ *
+ *   const { coldRenderMeanMs, warmRenderMeanMs } = getStartupStats();
+ */
+export function getStartupStats(): StartupStats {
+  const native = sessionModule();
+  if (!native || typeof native.getStartupStats !== 'function') {
+    throw new Error('Startup stats are not supported on this platform');
+  }
+  return native.getStartupStats();
+}
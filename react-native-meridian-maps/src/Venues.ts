@@ -0,0 +1,71 @@
+import { NativeModules } from 'react-native';
+
+export interface VenueOptions {
+  // Venues (Meridian apps) whose caches stay in memory, at least 1 (default 3)
+  maxWarmVenues?: number;
+}
+
+export interface VenueStats {
+  // The app the SDK is set up for, and every app still warm, most recent first
+  activeAppId: string;
+  warmAppIds: string[];
+  maxWarmVenues: number;
+  // Changes of the active venue, to one still warm or to one loaded from scratch
+  switches: number;
+  warmSwitches: number;
+  coldSwitches: number;
+  // Venues whose caches were released to stay within maxWarmVenues
+  evictions: number;
+  // Android: apps mounted or prewarmed with a token other than the first one.
+  // The SDK keeps the token it was configured with for the whole process, so
+  // their requests go out with that token and fail if it does not cover them.
+  tokenMismatchAppIds?: string[];
+}
+
+interface VenueModule {
+  setVenueOptions(options: VenueOptions): void;
+  getVenueStats(): VenueStats;
+}
+
+function venueModule(): VenueModule | undefined {
+  return NativeModules.MeridianMaps as VenueModule | undefined;
+}
+
+/**
+ * A map view or prewarm for another appId switches the SDK to that venue.
+ * The most recently used venues keep their placemark index, prewarm and
+ * cached requests (on iOS also their location manager), so switching back to
+ * one is warm; older ones are released, keeping only their placemark snapshot
+ * on disk. Each venue keeps the domain region it was prewarmed with, which
+ * is set again whenever it becomes active; a venue never prewarmed uses the
+ * region of the latest prewarm.
+ *
+ *   setVenueOptions({ maxWarmVenues: 2 });
+ */
+export function setVenueOptions(options: VenueOptions): void {
+  const { maxWarmVenues } = options;
+  if (
+    maxWarmVenues !== undefined &&
+    !(Number.isInteger(maxWarmVenues) && maxWarmVenues >= 1)
+  ) {
+    throw new Error('maxWarmVenues must be a positive integer');
+  }
+  const native = venueModule();
+  if (!native || typeof native.setVenueOptions !== 'function') {
+    throw new Error('Venue options are not supported on this platform');
+  }
+  native.setVenueOptions(options);
+}
+
+/**
+ * Which venues are warm and how often switching found the venue warm:
+ *
+ *   const { activeAppId, warmSwitches, coldSwitches } = getVenueStats();
+ */
+export function getVenueStats(): VenueStats {
+  const native = venueModule();
+  if (!native || typeof native.getVenueStats !== 'function') {
+    throw new Error('Venue stats are not supported on this platform');
+  }
+  return native.getVenueStats();
+}
@@ -1,7 +1,106 @@
 import { NativeModules, Platform } from 'react-native';
 import MeridianMapView, {
+  type MarkerIcon,
   type MeridianMapViewComponentRef,
+  type RouteTimings,
 } from './MeridianMapView'; // Import component as default, and type
+import type {
+  DirectionsErrorEvent,
+  GeofenceTransitionEvent,
+  LocationDutyCycleOptions,
+  LocationUpdatedEvent,
+  LocationUpdateOptions,
+  MapLoadFailEvent,
+  MarkerSelectEvent,
+  RouteStepIndexChangeEvent,
+} from './MeridianMapViewNativeComponent';
+import {
+  streamPlacemarks,
+  type Placemark,
+  type PlacemarkPage,
+  type PlacemarkStreamOptions,
+} from './PlacemarkStream';
+import {
+  queryPlacemarks,
+  type PlacemarkHit,
+  type PlacemarkQuery,
+} from './PlacemarkQuery';
+import {
+  searchPlacemarks,
+  type PlacemarkSearchResult,
+} from './PlacemarkSearch';
+import {
+  syncPlacemarks,
+  type PlacemarkSyncOptions,
+  type PlacemarkSyncStats,
+} from './PlacemarkSync';
+import { getRequestStats, type RequestStats } from './RequestStats';
+import {
+  getEventStats,
+  type EventCounts,
+  type EventStats,
+} from './EventStats';
+import {
+  getLocationPowerStats,
+  getLocationUpdateStats,
+  type LocationPowerStats,
+  type LocationUpdateStats,
+} from './LocationStats';
+import type {
+  LocationHistory,
+  LocationHistoryBounds,
+  LocationHistoryOptions,
+  LocationHistoryPoint,
+} from './LocationHistory';
+import type { Geofence, GeofencePoint } from './Geofence';
+import {
+  replayLocationTrace,
+  startLocationRecording,
+  stopLocationRecording,
+  stopLocationReplay,
+  type LocationRecording,
+  type LocationReplayOptions,
+  type LocationReplayResult,
+} from './LocationTrace';
+import {
+  getStartupStats,
+  prewarm,
+  type PrewarmOptions,
+  type PrewarmTimings,
+  type StartupStats,
+} from './Session';
+import {
+  getMapPoolStats,
+  setMapPoolOptions,
+  type MapPoolOptions,
+  type MapPoolStats,
+} from './MapPool';
+import {
+  getVenueStats,
+  setVenueOptions,
+  type VenueOptions,
+  type VenueStats,
+} from './Venues';
+import {
+  getAssetBundleStats,
+  loadAssetBundle,
+  unloadAssetBundle,
+  type AssetBundleInfo,
+  type AssetBundleStats,
+} from './AssetBundle';
+import {
+  clearCache,
+  getCacheStats,
+  setCacheOptions,
+  type CacheOptions,
+  type CacheStats,
+} from './AssetCache';
+import {
+  cancelPrefetch,
+  getPrefetchStats,
+  type PrefetchStats,
+} from './Prefetch';
+import { getMarkerAtlasStats, type MarkerAtlasStats } from './MarkerAtlas';
 
 // const LINKING_ERROR = ... (rest of the file remains the same until the exports section)
 
@@ -30,10 +129,74 @@ const MeridianMaps = NativeModules.MeridianMaps
 export interface MeridianMapsInterface {
   openMap(appId?: string, mapId?: string): Promise<string>;
   openTestActivity(): Promise<string>;
+  prewarm(options: PrewarmOptions): Promise<PrewarmTimings>;
 }
 
 // Cast native module to our interface
 const MeridianMapsModule = MeridianMaps as MeridianMapsInterface;
 
-export { MeridianMapView, MeridianMapsModule as MeridianMaps };
-export type { MeridianMapViewComponentRef }; // Correctly export the type
+export {
+  MeridianMapView,
+  MeridianMapsModule as MeridianMaps,
+  prewarm,
+  getStartupStats,
+  setMapPoolOptions,
+  getMapPoolStats,
+  setVenueOptions,
+  getVenueStats,
+  loadAssetBundle,
+  unloadAssetBundle,
+  getAssetBundleStats,
+  setCacheOptions,
+  clearCache,
+  getCacheStats,
+  cancelPrefetch,
+  getPrefetchStats,
+  getMarkerAtlasStats,
+  streamPlacemarks,
+  queryPlacemarks,
+  searchPlacemarks,
+  syncPlacemarks,
+  getRequestStats,
+  getEventStats,
+  getLocationUpdateStats,
+  getLocationPowerStats,
+  startLocationRecording,
+  stopLocationRecording,
+  replayLocationTrace,
+  stopLocationReplay,
+};
+export type { MeridianMapViewComponentRef, RouteTimings }; // Correctly export the type
+export type { MarkerIcon };
+export type {
+  DirectionsErrorEvent,
+  GeofenceTransitionEvent,
+  LocationDutyCycleOptions,
+  LocationUpdatedEvent,
+  LocationUpdateOptions,
+  MapLoadFailEvent,
+  MarkerSelectEvent,
+  RouteStepIndexChangeEvent,
+};
+export type { Placemark, PlacemarkPage, PlacemarkStreamOptions };
+export type { PlacemarkHit, PlacemarkQuery };
+export type { PlacemarkSearchResult };
+export type { PlacemarkSyncOptions, PlacemarkSyncStats };
+export type { RequestStats };
+export type { EventCounts, EventStats };
+export type { LocationPowerStats, LocationUpdateStats };
+export type { LocationRecording, LocationReplayOptions, LocationReplayResult };
+export type {
+  LocationHistory,
+  LocationHistoryBounds,
+  LocationHistoryOptions,
+  LocationHistoryPoint,
+};
+export type { Geofence, GeofencePoint };
+export type { PrewarmOptions, PrewarmTimings, StartupStats };
+export type { MapPoolOptions, MapPoolStats };
+export type { VenueOptions, VenueStats };
+export type { AssetBundleInfo, AssetBundleStats };
+export type { CacheOptions, CacheStats };
+export type { PrefetchStats };
+export type { MarkerAtlasStats };